@@ -1,5 +1,6 @@
 #include <QApplication>
 #include <QDebug>
+#include <QMessageBox>
 
 #include "MainWindowDelegate.h"
 #include "SystemSettingPageBuilder.h"
@@ -40,6 +41,13 @@ namespace Etrek::Application::Delegate
         return;
       }
 
+      // The configuration pages read device and scan protocol tables the store does not have
+      if (m_params.embeddedStore) {
+        QMessageBox::information(m_mainWindow, "System Settings",
+                                 "System settings are not available while running on the local store.");
+        return;
+      }
+
       m_mainWindow->prepareLoadingPage();
 
       if (m_systemSettingPageDelegate) {
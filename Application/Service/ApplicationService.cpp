@@ -19,6 +19,14 @@
 #include "LoggerProvider.h"
 #include "AppLoggerFactory.h"
 #include "DatabaseSetupManager.h"
+#include "DatabaseConnectionPool.h"
+#include "OfflineStoreSync.h"
+#include "WriteJournal.h"
+#include "JournalApplier.h"
+#include "QueryStatistics.h"
+#include "DicomRepository.h"
+#include "DicomWriteJournal.h"
+#include "MaintenanceScheduler.h"
 #include "UserManagerLaunchStrategy.h"
 #include "SettingManagerLaunchStrategy.h"
 #include "DemoLaunchStrategy.h"
@@ -26,10 +34,16 @@
 #include "MainAppLaunchStrategy.h"
 #include "WorklistRepository.h"
 #include "WorklistFieldConfigurationRepository.h"
+#include "DeviceRegistry.h"
+#include "DeviceRepository.h"
 #include "MainWindowBuilder.h"
 #include "DelegateParameter.h"
 
 #include <QTimer>
+#include <QShortcut>
+#include <QKeySequence>
+#include <QDebug>
+#include <QThread>
 #include <QApplication>
 #include <QCoreApplication>
 
@@ -41,6 +55,7 @@ namespace Etrek::Application::Service
     using Etrek::Core::Data::Entity::User;
     using Etrek::Core::Data::Entity::Role;
     using Etrek::Core::Data::Model::DatabaseConnectionSetting;
+    using Etrek::Core::Data::Model::StorageBackend;
     using Etrek::Core::Data::Model::FileLoggerSetting;
     using Etrek::Core::Data::Model::RisConnectionSetting;
     using Etrek::Core::Log::AppLogger;
@@ -52,12 +67,40 @@ namespace Etrek::Application::Service
     using Etrek::Application::Authentication::AuthenticationService;
     using Etrek::Core::Repository::AuthenticationRepository;
     using Etrek::Core::Repository::DatabaseSetupManager;
+    using Etrek::Core::Repository::DatabaseConnectionPool;
+    using Etrek::Core::Repository::OfflineStoreSync;
+    using Etrek::Core::Repository::WriteJournal;
+    using Etrek::Core::Repository::JournalApplier;
+    using Etrek::Core::Repository::QueryStatistics;
+    using Etrek::Dicom::Repository::DicomRepository;
+    using Etrek::Dicom::Repository::DicomWriteJournal;
     using Etrek::Worklist::Connectivity::ModalityWorklistManager;
+    using Etrek::Worklist::Connectivity::RisHealthPolicy;
     using Etrek::Worklist::Repository::WorklistRepository;
     using Etrek::Worklist::Repository::WorklistFieldConfigurationRepository;
+    using Etrek::Device::Repository::DeviceRegistry;
     using Etrek::Application::Delegate::MainWindowDelegate;
     using Etrek::Application::Delegate::MainWindowBuilder;
 
+    namespace {
+        // How often the offline store is synchronized with the database server
+        constexpr int OFFLINE_SYNC_INTERVAL_MS = 60 * 1000;
+
+        // Database of the Demo and Developer launch modes when no SQLite database is configured
+        constexpr auto STANDALONE_STORE_PATH = "./data/etrek_demo.db";
+
+        // Acquisition writes journaled for the database, and how often the applier looks for them
+        constexpr auto WRITE_JOURNAL_PATH = "./data/write_journal.etj";
+        constexpr int JOURNAL_APPLY_INTERVAL_MS = 250;
+
+        // Maintenance purge of expired worklist entries, status history and log files: first
+        // pass once startup has settled, then a few times a day
+        constexpr int MAINTENANCE_FIRST_RUN_DELAY_MS = 5 * 60 * 1000;
+        constexpr int MAINTENANCE_INTERVAL_MS = 6 * 60 * 60 * 1000;
+
+        // Developer mode: logs the query statistics
+        constexpr auto QUERY_STATISTICS_SHORTCUT = "Ctrl+Shift+F12";
+    }
 
     ApplicationService::ApplicationService(QObject* parent)
         : QObject(parent)
@@ -178,6 +221,35 @@ namespace Etrek::Application::Service
             m_mainWindow.reset();
         }
 
+        if (m_dumpQueryStatisticsOnClose)
+            dumpQueryStatistics();
+
+        if (m_offlineSyncTimer)
+            m_offlineSyncTimer->stop();
+        if (m_offlineSyncThread) {
+            m_offlineSyncThread->quit();
+            m_offlineSyncThread->wait();
+        }
+
+        // Unapplied records stay in the journal and are applied on the next start
+        if (m_journalApplierTimer)
+            m_journalApplierTimer->stop();
+        if (m_journalApplierThread) {
+            m_journalApplierThread->quit();
+            m_journalApplierThread->wait();
+        }
+        if (m_writeJournal)
+            m_writeJournal->close();
+
+        // A running maintenance pass stops after its current chunk
+        if (m_maintenanceTimer)
+            m_maintenanceTimer->stop();
+        if (m_maintenanceThread) {
+            m_maintenanceThread->quit();
+            m_maintenanceThread->wait();
+        }
+
+        DatabaseConnectionPool::Instance().shutdown();
         LoggerProvider::Instance().Shutdown();
 
         // Defer quit until event loop starts
@@ -213,6 +285,7 @@ namespace Etrek::Application::Service
 
         DelegateParameter params;
         params.dbConnection = m_databaseConnectionSetting;
+        params.embeddedStore = isOnEmbeddedStore();
 
         MainWindowBuilder builder;
         auto result = builder.build(params, nullptr, this);
@@ -256,26 +329,46 @@ namespace Etrek::Application::Service
             return;
         }
 
-        const auto risQ = m_risConnectionSettingList.first();
-        if (!risQ || !risQ->getActiveFlag()) {
+        // Worklist profiles live on the database server only
+        if (isOnEmbeddedStore()) {
+            logger->LogWarning(translator->getWarningMessage(OFFLINE_STORE_SERVICE_SKIPPED_WARNING)
+                .arg("RIS worklist query", m_databaseConnectionSetting->getDatabaseName()));
+            return;
+        }
+
+        // Every active connection is queried; a site may run one RIS per department
+        QVector<std::shared_ptr<RisConnectionSetting>> activeConnections;
+        for (const auto& risQ : m_risConnectionSettingList) {
+            if (!risQ || !risQ->getActiveFlag())
+                continue;
+
+            // Bridge QSharedPointer -> std::shared_ptr while keeping the Qt ref alive
+            activeConnections.append(std::shared_ptr<RisConnectionSetting>(
+                risQ.data(),
+                [keepAlive = risQ](RisConnectionSetting*) mutable { keepAlive.clear(); }
+            ));
+        }
+
+        if (activeConnections.isEmpty()) {
             logger->LogInfo("RIS connection is not active.");
             return;
         }
 
         auto worklistRepository = std::make_shared<WorklistRepository>(m_databaseConnectionSetting);
 
-        // Bridge QSharedPointer -> std::shared_ptr while keeping the Qt ref alive
-        std::shared_ptr<RisConnectionSetting> risStd(
-            risQ.data(),
-            [keepAlive = risQ](RisConnectionSetting*) mutable { keepAlive.clear(); }
-        );
-
         m_modalityWorklistManager = new ModalityWorklistManager(
             worklistRepository,
-            risStd,
+            activeConnections,
             this  // Qt parent manages lifetime
         );
 
+        // Whether a RIS that stopped answering echoes is still queried is a site setting
+        RisHealthPolicy healthPolicy;
+        const auto environment = Etrek::Device::Repository::DeviceRepository(m_databaseConnectionSetting).getEnvironmentSettings();
+        if (environment.isSuccess)
+            healthPolicy.ContinueOnEchoFail = environment.value.ContinueOnEchoFail;
+        m_modalityWorklistManager->setHealthPolicy(healthPolicy);
+
         const auto profiles = worklistRepository->getProfiles();
         if (profiles.isSuccess && !profiles.value.isEmpty()) {
             const auto defaultProfile = profiles.value.first();
@@ -312,6 +405,24 @@ namespace Etrek::Application::Service
         std::function<void(const QString&, int)> progressCallback)
     {
         logger->LogInfo(translator->getInfoMessage(DEV_START_INIT_DEVICE_MSG));
+
+        if (progressCallback) {
+            progressCallback("Loading device configuration...", 40);
+        }
+
+        // Device tables live on the database server only
+        if (isOnEmbeddedStore()) {
+            logger->LogWarning(translator->getWarningMessage(OFFLINE_STORE_SERVICE_SKIPPED_WARNING)
+                .arg("Device configuration", m_databaseConnectionSetting->getDatabaseName()));
+            return;
+        }
+
+        // Load the device configuration once; pages and drivers read it from memory afterwards
+        auto devices = DeviceRegistry::forDatabase(m_databaseConnectionSetting)->reload();
+        if (!devices.isSuccess) {
+            logger->LogError(devices.message);
+        }
+
         // TODO: device drivers should be controlled here!
         logger->LogInfo(translator->getInfoMessage(DEV_INIT_DEVICE_SUCCEED));
     }
@@ -325,13 +436,40 @@ namespace Etrek::Application::Service
             progressCallback("Initializing database...", 15);
         }
 
+        QueryStatistics::Instance().setSlowQueryThresholdMs(m_databaseConnectionSetting->getSlowQueryThresholdMs());
+
         DatabaseSetupManager initializer(m_databaseConnectionSetting);
         Result<QString> result = initializer.initializeDatabase();
 
+        if (m_offlineStoreSetting) {
+            DatabaseSetupManager storeInitializer(m_offlineStoreSetting);
+            Result<QString> storeResult = storeInitializer.initializeDatabase();
+
+            if (!storeResult.isSuccess) {
+                logger->LogWarning(translator->getWarningMessage(DB_OFFLINE_STORE_UNAVAILABLE_WARNING)
+                    .arg(m_offlineStoreSetting->getDatabaseName(), storeResult.message));
+                m_offlineStoreSetting.reset();
+            }
+            else {
+                m_primaryDatabaseSetting = m_databaseConnectionSetting;
+            }
+        }
+
         if (!result.isSuccess) {
-            return false;
+            if (!m_offlineStoreSetting) {
+                return false;
+            }
+
+            // Everything created from here on works on the store until the next start;
+            // the offline sync sends local changes to the server once it is back.
+            logger->LogWarning(translator->getWarningMessage(DB_USING_OFFLINE_STORE_WARNING)
+                .arg(result.message, m_offlineStoreSetting->getDatabaseName()));
+            m_databaseConnectionSetting = m_offlineStoreSetting;
         }
 
+        // Open the GUI-thread connections up front so the first screens do not pay the connect cost
+        DatabaseConnectionPool::Instance().warmUp(m_databaseConnectionSetting, 2);
+
         logger->LogInfo(translator->getInfoMessage(DB_INIT_SUCCESS_MSG));
         return true;
     }
@@ -353,8 +491,155 @@ namespace Etrek::Application::Service
         m_databaseConnectionSetting = settingProvider->getDatabaseConnectionSettings();
         m_risConnectionSettingList = settingProvider->getRisSettings();
         m_fileLoggerSetting = settingProvider->getFileLoggerSettings();
+        m_offlineStoreSetting = settingProvider->getOfflineStoreSettings();
+        m_queryStatisticsDumpConfigured = m_databaseConnectionSetting && m_databaseConnectionSetting->getDumpQueryStatistics();
 
         return true;
     }
 
+    bool ApplicationService::hasDatabaseServer() const
+    {
+        return m_databaseConnectionSetting
+            && m_databaseConnectionSetting->getStorageBackend() == StorageBackend::MySql
+            && !m_databaseConnectionSetting->getHostName().isEmpty();
+    }
+
+    bool ApplicationService::isOnEmbeddedStore() const
+    {
+        return m_databaseConnectionSetting
+            && m_databaseConnectionSetting->getStorageBackend() == StorageBackend::Sqlite;
+    }
+
+    void ApplicationService::useStandaloneStore()
+    {
+        m_offlineStoreSetting.reset();
+
+        if (isOnEmbeddedStore()) {
+            return;
+        }
+
+        auto store = std::make_shared<DatabaseConnectionSetting>();
+        store->setStorageBackend(StorageBackend::Sqlite);
+        store->setDatabaseName(STANDALONE_STORE_PATH);
+        m_databaseConnectionSetting = store;
+    }
+
+    void ApplicationService::startOfflineSync()
+    {
+        if (!m_offlineStoreSetting || !m_primaryDatabaseSetting || m_offlineSyncThread) {
+            return;
+        }
+
+        // The worker takes its leases on the sync thread; the timer only posts requests to it
+        auto* sync = new OfflineStoreSync(m_primaryDatabaseSetting, m_offlineStoreSetting);
+        m_offlineSyncThread = new QThread(this);
+        sync->moveToThread(m_offlineSyncThread);
+
+        connect(m_offlineSyncThread, &QThread::started, sync, &OfflineStoreSync::synchronizeNow);
+        connect(m_offlineSyncThread, &QThread::finished, sync, &QObject::deleteLater);
+
+        m_offlineSyncTimer = new QTimer(this);
+        m_offlineSyncTimer->setInterval(OFFLINE_SYNC_INTERVAL_MS);
+        connect(m_offlineSyncTimer, &QTimer::timeout, sync, &OfflineStoreSync::synchronizeNow);
+
+        m_offlineSyncThread->start();
+        m_offlineSyncTimer->start();
+    }
+
+    void ApplicationService::startWriteJournal()
+    {
+        if (m_journalApplierThread || !m_databaseConnectionSetting) {
+            return;
+        }
+
+        // Journaled writes go to the patient, study and image tables of the database server;
+        // without one there is nowhere to apply them
+        if (isOnEmbeddedStore() && !m_primaryDatabaseSetting) {
+            return;
+        }
+
+        auto journal = std::make_shared<WriteJournal>(WRITE_JOURNAL_PATH);
+        if (!journal->open().isSuccess) {
+            // Logged by the journal; acquisition writes then go to the repositories directly
+            return;
+        }
+        m_writeJournal = journal;
+
+        // Records go to the database server even while the application runs on the offline
+        // store; the applier retries until the server is back. Records left by the previous
+        // run are applied first.
+        const auto target = m_primaryDatabaseSetting ? m_primaryDatabaseSetting : m_databaseConnectionSetting;
+        auto* applier = new JournalApplier(journal);
+        DicomWriteJournal::registerHandlers(*applier, std::make_shared<DicomRepository>(target));
+
+        m_journalApplierThread = new QThread(this);
+        applier->moveToThread(m_journalApplierThread);
+
+        connect(m_journalApplierThread, &QThread::started, applier, &JournalApplier::applyNow);
+        connect(m_journalApplierThread, &QThread::finished, applier, &QObject::deleteLater);
+
+        m_journalApplierTimer = new QTimer(this);
+        m_journalApplierTimer->setInterval(JOURNAL_APPLY_INTERVAL_MS);
+        connect(m_journalApplierTimer, &QTimer::timeout, applier, &JournalApplier::applyNow);
+
+        m_journalApplierThread->start();
+        m_journalApplierTimer->start();
+    }
+
+    void ApplicationService::startMaintenance()
+    {
+        if (m_maintenanceThread || !m_databaseConnectionSetting) {
+            return;
+        }
+
+        // The offline store has no environment settings to take retention periods from and
+        // holds local changes the server has not received yet; it is never purged
+        if (isOnEmbeddedStore()) {
+            logger->LogWarning(translator->getWarningMessage(MAINTENANCE_SKIPPED_OFFLINE_WARNING)
+                .arg(m_databaseConnectionSetting->getDatabaseName()));
+            return;
+        }
+
+        // Chunks run on the maintenance thread; the timer only posts passes to it
+        auto* scheduler = new MaintenanceScheduler(m_databaseConnectionSetting);
+        m_maintenanceThread = new QThread(this);
+        scheduler->moveToThread(m_maintenanceThread);
+
+        connect(m_maintenanceThread, &QThread::finished, scheduler, &QObject::deleteLater);
+
+        m_maintenanceTimer = new QTimer(this);
+        m_maintenanceTimer->setInterval(MAINTENANCE_INTERVAL_MS);
+        connect(m_maintenanceTimer, &QTimer::timeout, scheduler, &MaintenanceScheduler::runNow);
+
+        m_maintenanceThread->start();
+        m_maintenanceTimer->start();
+        QTimer::singleShot(MAINTENANCE_FIRST_RUN_DELAY_MS, scheduler, &MaintenanceScheduler::runNow);
+    }
+
+    void ApplicationService::enableQueryStatisticsDump()
+    {
+        m_dumpQueryStatisticsOnClose = true;
+        if (!m_mainWindow) {
+            return;
+        }
+
+        auto* shortcut = new QShortcut(QKeySequence(QUERY_STATISTICS_SHORTCUT), m_mainWindow.get());
+        shortcut->setContext(Qt::ApplicationShortcut);
+        connect(shortcut, &QShortcut::activated, this, &ApplicationService::dumpQueryStatistics);
+    }
+
+    bool ApplicationService::isQueryStatisticsDumpConfigured() const
+    {
+        return m_queryStatisticsDumpConfigured;
+    }
+
+    void ApplicationService::dumpQueryStatistics()
+    {
+        const QString report = QueryStatistics::Instance().report();
+        if (logger) {
+            logger->LogInfo(report);
+        }
+        qInfo().noquote() << report;
+    }
+
 } // namespace Etrek::Application::Service
\ No newline at end of file
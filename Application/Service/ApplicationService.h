@@ -47,12 +47,16 @@ namespace Etrek::Application::Delegate {
 
 namespace Etrek::Core::Repository {
     class AuthenticationRepository;
+    class WriteJournal;
 }
 
 namespace Etrek::Worklist::Connectivity {
     class ModalityWorklistManager;
 }
 
+class QThread;
+class QTimer;
+
 namespace Etrek::Application::Service
 {
     class ILaunchStrategy;
@@ -73,6 +77,30 @@ namespace Etrek::Application::Service
         std::optional<Etrek::Core::Data::Entity::User> authenticateUser();
         void loadMainWindow(std::function<void(const QString&, int)> progressCallback);
         bool loadSettings(std::function<void(const QString&, int)> progressCallback);
+        /**
+         * @brief True when the settings point at a database server rather than an embedded store.
+         */
+        bool hasDatabaseServer() const;
+
+        /**
+         * @brief True when the application runs on the embedded SQLite store, either as the
+         *        whole database or after falling back from the server.
+         *
+         * The store only holds what registration and the worklist need (see sqlite_store.sql);
+         * RIS queries, device configuration and the system settings pages are skipped on it.
+         */
+        bool isOnEmbeddedStore() const;
+        void useStandaloneStore();
+        void startOfflineSync();
+        void startWriteJournal();
+        void startMaintenance();
+        void enableQueryStatisticsDump();
+
+        /**
+         * @brief True when the settings ask for the query statistics dump in every launch mode.
+         */
+        bool isQueryStatisticsDumpConfigured() const;
+        void dumpQueryStatistics();
         void setupLogger(std::function<void(const QString&, int)> progressCallback);
         void connectSignalsAndSlots();
         void closeApplication();
@@ -89,10 +117,21 @@ namespace Etrek::Application::Service
         Etrek::Core::Globalization::TranslationProvider* translator = nullptr;
         std::shared_ptr<Etrek::Core::Repository::AuthenticationRepository> m_authRepository;
         Etrek::Application::Authentication::AuthenticationService* m_authService = nullptr;
-        std::shared_ptr<Etrek::Core::Data::Model::DatabaseConnectionSetting> m_databaseConnectionSetting;
+        std::shared_ptr<Etrek::Core::Data::Model::DatabaseConnectionSetting> m_databaseConnectionSetting;  // the database in use
+        std::shared_ptr<Etrek::Core::Data::Model::DatabaseConnectionSetting> m_primaryDatabaseSetting;     // MySQL, when an offline store is in play
+        std::shared_ptr<Etrek::Core::Data::Model::DatabaseConnectionSetting> m_offlineStoreSetting;
         std::shared_ptr<Etrek::Core::Data::Model::FileLoggerSetting> m_fileLoggerSetting;
         QVector<QSharedPointer<Etrek::Core::Data::Model::RisConnectionSetting>> m_risConnectionSettingList;
         Etrek::Worklist::Connectivity::ModalityWorklistManager* m_modalityWorklistManager = nullptr;
+        QThread* m_offlineSyncThread = nullptr;
+        QTimer* m_offlineSyncTimer = nullptr;
+        std::shared_ptr<Etrek::Core::Repository::WriteJournal> m_writeJournal;    // acquisition writes waiting for the database
+        QThread* m_journalApplierThread = nullptr;
+        QTimer* m_journalApplierTimer = nullptr;
+        QThread* m_maintenanceThread = nullptr;
+        QTimer* m_maintenanceTimer = nullptr;
+        bool m_dumpQueryStatisticsOnClose = false;
+        bool m_queryStatisticsDumpConfigured = false;  // read before a fallback replaces the setting
 
         // Value members - MUST include headers
         Etrek::Core::Setting::SettingProvider m_settingProvider;
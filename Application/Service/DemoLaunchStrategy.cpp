@@ -16,8 +16,31 @@ namespace Etrek::Application::Service
 			return;
 		}
 
+		if (!service->loadSettings(nullptr)) {
+			qWarning() << "Unable to load settings file in DemoLaunchStrategy::launch";
+			service->closeApplication();
+			return;
+		}
+		service->setupLogger(nullptr);
+
+		// Demo runs on the embedded store, no database server is needed. The store has no
+		// device or scan protocol tables; those services skip themselves on it
+		service->useStandaloneStore();
+		if (!service->initializeDatabase(nullptr)) {
+			qWarning() << "Unable to initialize the demo database in DemoLaunchStrategy::launch";
+			service->closeApplication();
+			return;
+		}
+		service->startWriteJournal();
+		service->startMaintenance();
+		service->intializeDevices(nullptr);
+
 		// Display the main screen
-		//service->loadMainWindow(); // the signeture changed.
+		service->loadMainWindow(nullptr);
+		service->showMainWindow();
+
+		if (service->isQueryStatisticsDumpConfigured())
+			service->enableQueryStatisticsDump();
 
 		qInfo() << "Demo mode launched successfully.";
 	}
@@ -1,4 +1,6 @@
+#include <QDebug>
 #include "DeveloperLaunchStrategy.h"
+#include "ApplicationService.h"
 
 namespace Etrek::Application::Service
 {
@@ -9,6 +11,39 @@ namespace Etrek::Application::Service
 
 	void DeveloperLaunchStrategy::launch(ApplicationService* service)
 	{
+		if (!service) {
+			qWarning() << "ApplicationService is null in DeveloperLaunchStrategy::launch";
+			return;
+		}
+
+		if (!service->loadSettings(nullptr)) {
+			qWarning() << "Unable to load settings file in DeveloperLaunchStrategy::launch";
+			service->closeApplication();
+			return;
+		}
+		service->setupLogger(nullptr);
+
+		// Developer mode runs on the configured database server; without one it runs on the
+		// embedded store, where devices and the system settings pages are not available
+		if (!service->hasDatabaseServer())
+			service->useStandaloneStore();
+		if (!service->initializeDatabase(nullptr)) {
+			qWarning() << "Unable to initialize the database in DeveloperLaunchStrategy::launch";
+			service->closeApplication();
+			return;
+		}
+		service->startOfflineSync();
+		service->startWriteJournal();
+		service->startMaintenance();
+		service->intializeDevices(nullptr);
+
+		service->loadMainWindow(nullptr);
+		service->showMainWindow();
+
+		// Query timings are logged on Ctrl+Shift+F12 and when the application closes
+		service->enableQueryStatisticsDump();
+
+		qInfo() << "Developer mode launched successfully.";
 	}
 
 	DeveloperLaunchStrategy::~DeveloperLaunchStrategy()
@@ -72,11 +72,24 @@ void MainAppLaunchStrategy::launch(ApplicationService* service)
 		service->closeApplication();
 		return;
 	}
+
+	// Keeps the offline store in step with the database server, if one is configured
+	service->startOfflineSync();
+
+	// Applies acquisition writes journaled while the database was slow or unreachable
+	service->startWriteJournal();
+
+	// Purges expired worklist entries, status history and log files in the background
+	service->startMaintenance();
 	
 	service->intializeAuthentication([this](const QString& message, int progress) {
 		m_splashScreenManager->updateSplashScreenMessage(message, progress);
 		});
 
+	service->intializeDevices([this](const QString& message, int progress) {
+		m_splashScreenManager->updateSplashScreenMessage(message, progress);
+		});
+
 	service->initializeRisConnections([this](const QString& message, int progress) {
 		m_splashScreenManager->updateSplashScreenMessage(message, progress);
 		});
@@ -85,6 +98,10 @@ void MainAppLaunchStrategy::launch(ApplicationService* service)
 		m_splashScreenManager->updateSplashScreenMessage(message, progress);
 		});
 
+	// Profiles the repositories against the production database when the settings ask for it
+	if (service->isQueryStatisticsDumpConfigured())
+		service->enableQueryStatisticsDump();
+
 
 	m_splashScreenManager->closeSplashScreen();
 
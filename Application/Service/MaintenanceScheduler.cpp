@@ -0,0 +1,186 @@
+#include "MaintenanceScheduler.h"
+#include <QTimer>
+#include "WorklistRepository.h"
+#include "DicomRepository.h"
+#include "DeviceRepository.h"
+#include "LoggerProvider.h"
+#include "MessageKey.h"
+#include "AppLoggerFactory.h"
+
+namespace Etrek::Application::Service
+{
+    using Etrek::Specification::Result;
+    using Etrek::Core::Data::Model::DatabaseConnectionSetting;
+    using Etrek::Core::Globalization::TranslationProvider;
+    using Etrek::Core::Log::AppLoggerFactory;
+    using Etrek::Core::Log::LoggerProvider;
+    using Etrek::Worklist::Repository::WorklistRepository;
+    using Etrek::Dicom::Repository::DicomRepository;
+    using Etrek::Device::Repository::DeviceRepository;
+    using Etrek::Device::Data::Entity::EnvironmentSetting;
+
+    MaintenanceScheduler::MaintenanceScheduler(std::shared_ptr<DatabaseConnectionSetting> connectionSetting,
+        const MaintenancePolicy& policy, QObject* parent)
+        : QObject(parent)
+        , m_connectionSetting(std::move(connectionSetting))
+        , m_policy(policy)
+    {
+        translator = &TranslationProvider::Instance();
+        AppLoggerFactory factory(LoggerProvider::Instance(), translator);
+        logger = factory.CreateLogger("MaintenanceScheduler");
+
+        // Parented, so it follows the scheduler to the worker thread
+        m_chunkTimer = new QTimer(this);
+        m_chunkTimer->setSingleShot(true);
+        connect(m_chunkTimer, &QTimer::timeout, this, &MaintenanceScheduler::runChunk);
+    }
+
+    MaintenanceScheduler::~MaintenanceScheduler() = default;
+
+    bool MaintenanceScheduler::isRunning() const
+    {
+        return m_stage != Stage::Idle;
+    }
+
+    void MaintenanceScheduler::runNow()
+    {
+        if (isRunning())
+            return;
+
+        // Created on the worker thread, where the repositories are used
+        if (!m_worklistRepository)
+            m_worklistRepository = std::make_unique<WorklistRepository>(m_connectionSetting);
+        if (!m_dicomRepository)
+            m_dicomRepository = std::make_unique<DicomRepository>(m_connectionSetting, translator);
+
+        loadSettings();
+        m_worklistEntries = 0;
+        m_statusRows = 0;
+        m_logFiles = 0;
+        m_passTimer.start();
+
+        logger->LogInfo(translator->getInfoMessage(MAINTENANCE_PASS_STARTED_MSG)
+            .arg(m_worklistCutoff.isValid() ? m_worklistCutoff.toString(Qt::ISODate) : QString("-"))
+            .arg(m_historyCutoff.isValid() ? m_historyCutoff.toString(Qt::ISODate) : QString("-")));
+
+        m_stage = Stage::WorklistEntries;
+        m_chunkSize = m_policy.InitialChunkSize;
+        if (!m_worklistCutoff.isValid())
+            advance();
+        if (isRunning())
+            m_chunkTimer->start(0);
+    }
+
+    void MaintenanceScheduler::cancel()
+    {
+        if (!isRunning())
+            return;
+        m_chunkTimer->stop();
+        finish();
+    }
+
+    void MaintenanceScheduler::loadSettings()
+    {
+        EnvironmentSetting settings;
+        DeviceRepository repository(m_connectionSetting, translator);
+        auto loaded = repository.getEnvironmentSettings();
+        if (loaded.isSuccess)
+            settings = loaded.value;
+        else
+            logger->LogWarning(translator->getWarningMessage(MAINTENANCE_SETTINGS_UNAVAILABLE_WARNING).arg(loaded.message));
+
+        const QDateTime now = QDateTime::currentDateTime();
+        m_worklistCutoff = settings.WorklistClearPeriodDays > 0 ? now.addDays(-settings.WorklistClearPeriodDays) : QDateTime();
+        m_historyCutoff = settings.DeleteLogPeriodDays > 0 ? now.addDays(-settings.DeleteLogPeriodDays) : QDateTime();
+    }
+
+    void MaintenanceScheduler::runChunk()
+    {
+        if (!isRunning())
+            return;
+
+        QElapsedTimer timer;
+        timer.start();
+
+        Result<int> removed = Result<int>::Success(0);
+        QString purge;
+        switch (m_stage) {
+        case Stage::WorklistEntries:
+            purge = "worklist entries";
+            removed = m_worklistRepository->purgeWorklistEntries(m_worklistCutoff, m_chunkSize);
+            if (removed.isSuccess)
+                m_worklistEntries += removed.value;
+            break;
+        case Stage::StatusHistory:
+            purge = "status history";
+            removed = m_dicomRepository->purgeStatusHistory(m_historyCutoff, m_chunkSize);
+            if (removed.isSuccess)
+                m_statusRows += removed.value;
+            break;
+        case Stage::LogFiles:
+            purge = "log files";
+            removed = LoggerProvider::Instance().DeleteRotatedLogFiles(m_historyCutoff, m_chunkSize);
+            if (removed.isSuccess)
+                m_logFiles += removed.value;
+            break;
+        case Stage::Idle:
+            return;
+        }
+
+        if (!removed.isSuccess) {
+            const QString error = translator->getErrorMessage(MAINTENANCE_PURGE_FAILED_ERROR).arg(purge, removed.message);
+            logger->LogError(error);
+            m_stage = Stage::Idle;
+            emit failed(error);
+            return;
+        }
+
+        emit progress(m_worklistEntries, m_statusRows, m_logFiles);
+
+        // A short chunk means nothing is left to purge
+        if (removed.value < m_chunkSize)
+            advance();
+        else
+            adaptChunkSize(timer.elapsed());
+
+        if (isRunning())
+            m_chunkTimer->start(m_policy.PauseBetweenChunksMs);
+    }
+
+    void MaintenanceScheduler::advance()
+    {
+        m_chunkSize = m_policy.InitialChunkSize;
+        for (;;) {
+            switch (m_stage) {
+            case Stage::WorklistEntries:
+                m_stage = Stage::StatusHistory;
+                break;
+            case Stage::StatusHistory:
+                m_stage = Stage::LogFiles;
+                break;
+            default:
+                finish();
+                return;
+            }
+            if (m_historyCutoff.isValid())
+                return;
+        }
+    }
+
+    void MaintenanceScheduler::adaptChunkSize(qint64 elapsedMs)
+    {
+        if (elapsedMs > m_policy.ChunkBudgetMs)
+            m_chunkSize = qMax(m_policy.MinChunkSize, m_chunkSize / 2);
+        else if (elapsedMs < m_policy.ChunkBudgetMs / 2)
+            m_chunkSize = qMin(m_policy.MaxChunkSize, m_chunkSize * 2);
+    }
+
+    void MaintenanceScheduler::finish()
+    {
+        m_stage = Stage::Idle;
+        logger->LogInfo(translator->getInfoMessage(MAINTENANCE_PASS_FINISHED_MSG)
+            .arg(m_passTimer.elapsed()).arg(m_worklistEntries).arg(m_statusRows).arg(m_logFiles));
+        emit finished(m_worklistEntries, m_statusRows, m_logFiles);
+    }
+
+} // namespace Etrek::Application::Service
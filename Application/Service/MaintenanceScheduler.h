@@ -0,0 +1,118 @@
+#ifndef MAINTENANCESCHEDULER_H
+#define MAINTENANCESCHEDULER_H
+
+#include <memory>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include "Result.h"
+#include "DatabaseConnectionSetting.h"
+#include "TranslationProvider.h"
+#include "AppLogger.h"
+
+class QTimer;
+
+namespace Etrek::Worklist::Repository {
+    class WorklistRepository;
+}
+
+namespace Etrek::Dicom::Repository {
+    class DicomRepository;
+}
+
+namespace Etrek::Application::Service
+{
+    /**
+     * @brief Chunk sizing and throttling of a maintenance pass.
+     */
+    struct MaintenancePolicy {
+        int InitialChunkSize = 200;         ///< Rows deleted by the first chunk of each purge
+        int MinChunkSize = 20;
+        int MaxChunkSize = 2000;
+        int ChunkBudgetMs = 100;            ///< Target duration of one chunk; the chunk size follows it
+        int PauseBetweenChunksMs = 500;     ///< Idle time after each chunk, for worklist refresh and acquisition
+    };
+
+    /**
+     * @class MaintenanceScheduler
+     * @brief Purges expired data in small, throttled chunks on a worker thread.
+     *
+     * A pass reads EnvironmentSetting and deletes, one purge after the other:
+     *  - worklist entries created more than WorklistClearPeriodDays ago, with their attributes,
+     *  - status history rows older than DeleteLogPeriodDays that are no entity's current status,
+     *  - rotated log files last written more than DeleteLogPeriodDays ago.
+     * A period of 0 or less turns its purge off.
+     *
+     * Every chunk is its own short transaction, followed by a pause; chunks are run from the
+     * event loop, so the thread can stop between any two of them. The chunk size is halved
+     * when a chunk takes longer than the budget and doubled when it takes less than half of it,
+     * which keeps row locks short on a busy server without crawling through an idle one.
+     *
+     * runNow() is called by a timer and reports through signals; a call while a pass is running
+     * is ignored. A failed chunk ends the pass; the next pass starts over from the settings.
+     */
+    class MaintenanceScheduler : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        explicit MaintenanceScheduler(std::shared_ptr<Etrek::Core::Data::Model::DatabaseConnectionSetting> connectionSetting,
+            const MaintenancePolicy& policy = MaintenancePolicy(),
+            QObject* parent = nullptr);
+        ~MaintenanceScheduler() override;
+
+        bool isRunning() const;
+
+    public slots:
+        /**
+         * @brief Starts a maintenance pass unless one is running.
+         */
+        void runNow();
+
+        /**
+         * @brief Stops the running pass after its current chunk.
+         */
+        void cancel();
+
+    signals:
+        /**
+         * @brief Totals of the running pass, emitted after every chunk.
+         */
+        void progress(int worklistEntries, int statusRows, int logFiles);
+        void finished(int worklistEntries, int statusRows, int logFiles);
+        void failed(const QString& message);
+
+    private slots:
+        void runChunk();
+
+    private:
+        enum class Stage { Idle, WorklistEntries, StatusHistory, LogFiles };
+
+        void loadSettings();
+        void advance();
+        void adaptChunkSize(qint64 elapsedMs);
+        void finish();
+
+        std::shared_ptr<Etrek::Core::Data::Model::DatabaseConnectionSetting> m_connectionSetting;
+        MaintenancePolicy m_policy;
+        std::unique_ptr<Etrek::Worklist::Repository::WorklistRepository> m_worklistRepository;
+        std::unique_ptr<Etrek::Dicom::Repository::DicomRepository> m_dicomRepository;
+        QTimer* m_chunkTimer = nullptr;
+
+        Stage m_stage = Stage::Idle;
+        int m_chunkSize = 0;
+        QDateTime m_worklistCutoff;     // invalid: purge off
+        QDateTime m_historyCutoff;
+        int m_worklistEntries = 0;
+        int m_statusRows = 0;
+        int m_logFiles = 0;
+        QElapsedTimer m_passTimer;
+
+        Etrek::Core::Globalization::TranslationProvider* translator;
+        std::shared_ptr<Etrek::Core::Log::AppLogger> logger;
+    };
+
+} // namespace Etrek::Application::Service
+
+#endif // MAINTENANCESCHEDULER_H
@@ -56,6 +56,34 @@ static constexpr auto SQL_SCRIPT_EXECUTION_FAILED_ERROR_MSG = "SqlScriptExecutio
 static constexpr auto SQL_SCRIPT_EXECUTION_SUCCEED_MSG = "SqlScriptExecutionSucceed";
 static constexpr auto SQL_SCRIPT_NO_TABLES_FOUND_MSG = "NoTablesFoundRunningSetupScript";
 static constexpr auto SQL_SCRIPT_FAILED_TO_OPEN_MSG = "FailedToOpenSetupMySQLScript";
+static constexpr auto DB_MIGRATION_APPLIED_MSG = "DatabaseMigrationApplied";
+static constexpr auto DB_MIGRATION_BASELINED_MSG = "DatabaseMigrationBaselined";
+static constexpr auto DB_MIGRATIONS_UP_TO_DATE_MSG = "DatabaseMigrationsUpToDate";
+static constexpr auto DB_MIGRATION_FAILED_ERROR = "DatabaseMigrationFailed";
+static constexpr auto DB_MIGRATION_CHECKSUM_MISMATCH_WARNING = "DatabaseMigrationChecksumMismatch";
+static constexpr auto SEED_TABLE_LOADED_MSG = "SeedTableLoaded";
+static constexpr auto SEED_DATA_LOADED_MSG = "SeedDataLoaded";
+static constexpr auto SEED_DATA_LOAD_FAILED_ERROR = "SeedDataLoadFailed";
+static constexpr auto DB_USING_OFFLINE_STORE_WARNING = "DatabaseUsingOfflineStore";
+static constexpr auto DB_OFFLINE_STORE_UNAVAILABLE_WARNING = "DatabaseOfflineStoreUnavailable";
+static constexpr auto OFFLINE_STORE_SERVICE_SKIPPED_WARNING = "OfflineStoreServiceSkipped";
+static constexpr auto OFFLINE_SYNC_COMPLETED_MSG = "OfflineSyncCompleted";
+static constexpr auto OFFLINE_SYNC_FAILED_ERROR = "OfflineSyncFailed";
+static constexpr auto WRITE_JOURNAL_OPEN_FAILED_ERROR = "WriteJournalOpenFailed";
+static constexpr auto WRITE_JOURNAL_APPEND_FAILED_ERROR = "WriteJournalAppendFailed";
+static constexpr auto WRITE_JOURNAL_SYNC_FAILED_ERROR = "WriteJournalSyncFailed";
+static constexpr auto WRITE_JOURNAL_CHECKPOINT_FAILED_ERROR = "WriteJournalCheckpointFailed";
+static constexpr auto WRITE_JOURNAL_CORRUPT_ERROR = "WriteJournalCorrupt";
+static constexpr auto WRITE_JOURNAL_TORN_RECORD_WARNING = "WriteJournalTornRecord";
+static constexpr auto WRITE_JOURNAL_RECORDS_PENDING_MSG = "WriteJournalRecordsPending";
+static constexpr auto JOURNAL_APPLY_FAILED_ERROR = "JournalApplyFailed";
+static constexpr auto JOURNAL_RECORD_REJECTED_ERROR = "JournalRecordRejected";
+static constexpr auto JOURNAL_APPLIED_MSG = "JournalApplied";
+static constexpr auto MAINTENANCE_PASS_STARTED_MSG = "MaintenancePassStarted";
+static constexpr auto MAINTENANCE_PASS_FINISHED_MSG = "MaintenancePassFinished";
+static constexpr auto MAINTENANCE_PURGE_FAILED_ERROR = "MaintenancePurgeFailed";
+static constexpr auto MAINTENANCE_SETTINGS_UNAVAILABLE_WARNING = "MaintenanceSettingsUnavailable";
+static constexpr auto MAINTENANCE_SKIPPED_OFFLINE_WARNING = "MaintenanceSkippedOffline";
 
 static constexpr auto DB_START_INIT_MSG = "StartDatabaseInit";
 static constexpr auto DB_INIT_SUCCESS_MSG = "DatabaseInitSuccess";
@@ -77,6 +105,14 @@ static constexpr auto RIS_C_ECHO_SUCCEED = "RisCEchoSucceed";
 static constexpr auto RIS_RELEASE_CONNECTION_FAILED = "RisReleaseConnectionFailed";
 static constexpr auto RIS_RELEASE_CONNECTION_SUCCEED = "RisReleaseConnectionSucceed";
 static constexpr auto RIS_C_FIND_FAILED = "RisCFindFailed";
+static constexpr auto RIS_C_FIND_STREAMED_MSG = "RisCFindStreamed";
+static constexpr auto RIS_C_FIND_CANCELLED_MSG = "RisCFindCancelled";
+static constexpr auto RIS_C_FIND_FINAL_STATUS_ERROR = "RisCFindFinalStatus";
+static constexpr auto RIS_ASSOCIATION_LOST_MSG = "RisAssociationLost";
+static constexpr auto RIS_ASSOCIATION_IDLE_EXPIRED_MSG = "RisAssociationIdleExpired";
+static constexpr auto RIS_ASSOCIATION_BACKOFF_MSG = "RisAssociationBackoff";
+static constexpr auto RIS_ASSOCIATION_WAITING_MSG = "RisAssociationWaiting";
+static constexpr auto RIS_PRESENTATION_CONTEXT_REJECTED_MSG = "RisPresentationContextRejected";
 static constexpr auto RIS_CONNECTION_PARAMETERS_CHANGE_MSG = "RisConnectionParameterChange";
 static constexpr auto RIS_PRESENTATION_CONTEXT_NOT_SET_MSG = "PresentationContextNotSet";
 static constexpr auto RIS_INVALID_OPERATION_SPECIFIED = "InvalidOperationSpecified";
@@ -99,6 +135,7 @@ static constexpr auto MWL_FAILED_TO_GET_ACTIVE_IDENTIFIERS_MSG = "MwlFailedToGet
 static constexpr auto MWL_FAILED_TO_FIND_ENTRY_MSG = "MwlFailedToFindEntry";
 static constexpr auto MWL_NO_ACTIVE_IDENTIFIER_FOUND_FOR_ENTRY_MSG = "MwlNoActiveIdentifierFoundForEntry";
 static constexpr auto MWL_ENTRY_UPDATE_SUCCEED_MSG = "MwlEntryUpdateSucceed";
+static constexpr auto MWL_INGEST_COMPLETED_MSG = "MwlIngestCompleted";
 
 static constexpr auto MWL_FAILED_TO_RETRIEVE_IDENTIFIER_ERROR = "MwlFailedToRetrieveIdentifierList";
 
@@ -114,6 +151,7 @@ static constexpr auto LOG_FILE_LOGGER_INIT_SUCCEED_MSG = "FileLoggerInitSucceed"
 
 static constexpr auto DEV_START_INIT_DEVICE_MSG = "StartDeviceInit";
 static constexpr auto DEV_INIT_DEVICE_SUCCEED = "DeviceInitSucceed";
+static constexpr auto DEV_REGISTRY_LOADED_MSG = "DeviceRegistryLoaded";
 
 // Database Operations - Additional Keys
 static constexpr auto DB_FETCH_IDS_BEFORE_DELETE_FAILED_ERROR = "FetchIdsBeforeDeleteFailed";
@@ -122,6 +160,15 @@ static constexpr auto DB_INSERT_FAILED_ERROR = "InsertFailed";
 static constexpr auto DB_INSERT_ATTRIBUTE_FAILED_ERROR = "InsertAttributeFailed";
 static constexpr auto DB_NO_IDENTIFIERS_PROVIDED_ERROR = "NoIdentifiersProvided";
 
+// Database Connection Pool
+static constexpr auto DB_POOL_NO_CONNECTION_SETTING_ERROR = "DbPoolNoConnectionSetting";
+static constexpr auto DB_POOL_ACQUIRE_TIMEOUT_ERROR = "DbPoolAcquireTimeout";
+static constexpr auto DB_POOL_CONNECTION_REOPENED_WARNING = "DbPoolConnectionReopened";
+static constexpr auto DB_POOL_UNFINISHED_TRANSACTION_WARNING = "DbPoolUnfinishedTransaction";
+static constexpr auto DB_POOL_THREAD_DRAINED_DEBUG = "DbPoolThreadDrained";
+static constexpr auto DB_POOL_STATEMENT_CACHE_STATS_DEBUG = "DbPoolStatementCacheStats";
+static constexpr auto DB_SLOW_QUERY_WARNING = "DbSlowQuery";
+
 // PACS Node Management
 static constexpr auto PACS_HOSTNAME_REQUIRED_ERROR = "PacsHostnameRequired";
 static constexpr auto PACS_HOST_IP_REQUIRED_ERROR = "PacsHostIpRequired";
@@ -11,6 +11,7 @@ struct DelegateParameter
 {
     std::shared_ptr<Etrek::Core::Data::Model::DatabaseConnectionSetting> dbConnection;
     QMap<QString, QWeakPointer<IDelegate>> delegates;
+    bool embeddedStore = false;  // dbConnection is the SQLite store: registration and worklist only
 };
 
 #endif // DELEGATEPARAMETERS_H
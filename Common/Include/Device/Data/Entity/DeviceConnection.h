@@ -18,6 +18,7 @@ namespace Etrek::Device::Data::Entity {
     public:
         int Id = -1;                          ///< Primary key
         int GeneratorId = -1;                 ///< Foreign key to generator
+        int DetectorId = -1;                  ///< Foreign key to detector
         int TubeId = -1;                      ///< Foreign key to x-ray tube
         int PosinionerId = -1;                ///< Foreign key to positioner
         dev::Connector Connector;             ///< Connector
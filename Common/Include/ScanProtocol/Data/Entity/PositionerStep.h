@@ -0,0 +1,57 @@
+#ifndef POSITIONERSTEP_H
+#define POSITIONERSTEP_H
+
+/**
+ * @file PositionerStep.h
+ * @brief Declares the PositionerStep entity, one device motion of a positioner.
+ *
+ * A positioner (e.g., "Chest PA") is reached by one or more motions of the
+ * table, stand or tube, executed in @ref PositionerStep::StepOrder.
+ */
+
+#include <QString>
+#include <QMetaType>
+
+namespace Etrek::ScanProtocol::Data::Entity {
+
+    /**
+     * @class PositionerStep
+     * @brief Persistable entity for a row of `positioner_steps`.
+     *
+     * Equality compares only the surrogate key (@ref Id).
+     */
+    class PositionerStep {
+    public:
+        /** @brief Primary key (`positioner_steps.id`). `-1` indicates not yet persisted. */
+        int Id = -1;
+
+        /** @brief Foreign key to `positioners.id`. */
+        int PositionerId = -1;
+
+        /**
+         * @brief Device that performs the motion, as stored in the database.
+         * @example "TableDetector", "StandDetector", "PrimaryTube"
+         */
+        QString Role;
+
+        /** @brief Device specific motion code (e.g., "X-2331"). */
+        QString MotionCode;
+
+        /** @brief Execution order within the positioner (1..n). */
+        int StepOrder = 1;
+
+        /** @brief Default constructor. */
+        PositionerStep() = default;
+
+        /** @brief Equality by primary key. */
+        bool operator==(const PositionerStep& other) const noexcept { return Id == other.Id; }
+    };
+
+} // namespace Etrek::ScanProtocol::Data::Entity
+
+/**
+ * @brief Enables PositionerStep for use with Qt's meta-object system (e.g., QVariant).
+ */
+Q_DECLARE_METATYPE(Etrek::ScanProtocol::Data::Entity::PositionerStep)
+
+#endif // POSITIONERSTEP_H
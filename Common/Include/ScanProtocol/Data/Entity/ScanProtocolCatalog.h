@@ -0,0 +1,134 @@
+#ifndef SCANPROTOCOLCATALOG_H
+#define SCANPROTOCOLCATALOG_H
+
+/**
+ * @file ScanProtocolCatalog.h
+ * @brief Declares the ScanProtocolCatalog aggregate, the whole scan protocol tree in memory.
+ *
+ * Procedures with their views, the techniques bound to each view (PRIMARY/LOW/HIGH),
+ * the technique parameters, and the positioners with their motion steps. Loaded at once by
+ * ScanProtocolRepository::loadCatalog() so UI code can walk the tree without further queries.
+ */
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+#include "Positioner.h"
+#include "PositionerStep.h"
+#include "Procedure.h"
+#include "TechniqueParameter.h"
+#include "View.h"
+#include "ViewTechnique.h"
+
+namespace Etrek::ScanProtocol::Data::Entity {
+
+    /**
+     * @class ScanProtocolCatalog
+     * @brief In-memory object graph of the scan protocol configuration.
+     *
+     * The public containers hold the data; the find/for helpers resolve references through
+     * hash indexes built by @ref reindex(). Call reindex() after modifying the containers.
+     */
+    class ScanProtocolCatalog {
+    public:
+        /** @brief All procedures, ordered by name, with @ref Procedure::Views hydrated. */
+        QVector<Procedure> Procedures;
+
+        /** @brief All views, ordered by body part and name. */
+        QVector<View> Views;
+
+        /** @brief All technique parameters, ordered by body part, size and profile. */
+        QVector<TechniqueParameter> TechniqueParameters;
+
+        /** @brief All positioners, ordered by name. */
+        QVector<Positioner> Positioners;
+
+        /** @brief Techniques bound to each view, keyed by view id and ordered by seq. */
+        QHash<int, QVector<ViewTechnique>> ViewTechniques;
+
+        /** @brief Motion steps of each positioner, keyed by positioner id and ordered by step order. */
+        QHash<int, QVector<PositionerStep>> PositionerSteps;
+
+        /** @brief Default constructor. */
+        ScanProtocolCatalog() = default;
+
+        /** @brief Rebuilds the lookup indexes from the containers. */
+        void reindex()
+        {
+            m_viewIndex.clear();
+            m_techniqueIndex.clear();
+            m_positionerIndex.clear();
+
+            m_viewIndex.reserve(Views.size());
+            for (int i = 0; i < Views.size(); ++i)
+                m_viewIndex.insert(Views[i].Id, i);
+
+            m_techniqueIndex.reserve(TechniqueParameters.size());
+            for (int i = 0; i < TechniqueParameters.size(); ++i)
+                m_techniqueIndex.insert(TechniqueParameters[i].Id, i);
+
+            m_positionerIndex.reserve(Positioners.size());
+            for (int i = 0; i < Positioners.size(); ++i)
+                m_positionerIndex.insert(Positioners[i].PositionName, i);
+        }
+
+        /** @brief Returns the view with @p viewId, or nullptr. */
+        const View* findView(int viewId) const
+        {
+            const auto it = m_viewIndex.constFind(viewId);
+            return it == m_viewIndex.constEnd() ? nullptr : &Views[it.value()];
+        }
+
+        /** @brief Returns the technique parameter with @p techniqueParameterId, or nullptr. */
+        const TechniqueParameter* findTechniqueParameter(int techniqueParameterId) const
+        {
+            const auto it = m_techniqueIndex.constFind(techniqueParameterId);
+            return it == m_techniqueIndex.constEnd() ? nullptr : &TechniqueParameters[it.value()];
+        }
+
+        /** @brief Returns the positioner named @p positionName, or nullptr. */
+        const Positioner* findPositioner(const QString& positionName) const
+        {
+            const auto it = m_positionerIndex.constFind(positionName);
+            return it == m_positionerIndex.constEnd() ? nullptr : &Positioners[it.value()];
+        }
+
+        /** @brief Returns the techniques bound to @p viewId, ordered by seq. */
+        QVector<ViewTechnique> techniquesForView(int viewId) const
+        {
+            return ViewTechniques.value(viewId);
+        }
+
+        /** @brief Returns the technique parameter bound to @p viewId with @p role, or nullptr. */
+        const TechniqueParameter* techniqueForView(int viewId, sp::TechniqueParameterRole role) const
+        {
+            const auto it = ViewTechniques.constFind(viewId);
+            if (it == ViewTechniques.constEnd())
+                return nullptr;
+            for (const ViewTechnique& vt : it.value()) {
+                if (vt.role == role)
+                    return findTechniqueParameter(vt.technique_parameter_id);
+            }
+            return nullptr;
+        }
+
+        /** @brief Returns the motion steps of the positioner used by @p viewId, ordered by step order. */
+        QVector<PositionerStep> stepsForView(int viewId) const
+        {
+            const View* view = findView(viewId);
+            if (!view || view->PositionName.isEmpty())
+                return {};
+            const Positioner* positioner = findPositioner(view->PositionName);
+            return positioner ? PositionerSteps.value(positioner->Id) : QVector<PositionerStep>();
+        }
+
+    private:
+        QHash<int, int> m_viewIndex;            // view id -> index in Views
+        QHash<int, int> m_techniqueIndex;       // technique parameter id -> index in TechniqueParameters
+        QHash<QString, int> m_positionerIndex;  // position name -> index in Positioners
+    };
+
+} // namespace Etrek::ScanProtocol::Data::Entity
+
+#endif // SCANPROTOCOLCATALOG_H
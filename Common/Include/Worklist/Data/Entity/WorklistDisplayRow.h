@@ -0,0 +1,46 @@
+#ifndef WORKLISTDISPLAYROW_H
+#define WORKLISTDISPLAYROW_H
+#include <QList>
+#include <QString>
+#include <QDateTime>
+#include "WorklistEntryPage.h"
+#include "WorklistEnum.h"
+
+namespace Etrek::Worklist::Data::Entity {
+
+/**
+ * @brief One worklist grid row, read from the display projection of mwl_entries.
+ */
+class WorklistDisplayRow {
+public:
+    int EntryId = -1;
+    ProcedureStepStatus Status = ProcedureStepStatus::PENDING;
+    Source Source = ::Source::LOCAL;
+    QString SourceConnection;   // RIS connection the entry came from, empty if local
+    QDateTime CreatedAt;
+
+    QString PatientName;
+    QString PatientId;
+    QString StudyName;          // StudyDescription, StudyID when empty
+    QString PatientSex;
+    QString PatientBirthDate;   // DICOM DA (YYYYMMDD) as received
+    QString AccessionNumber;
+    QString AdmissionId;
+
+    WorklistDisplayRow() = default;
+};
+
+/**
+ * @brief One page of worklist grid rows, newest first.
+ */
+class WorklistDisplayPage {
+public:
+    QList<WorklistDisplayRow> Rows;
+    WorklistPageCursor Next;   // Cursor of the last row in this page
+    bool HasMore = false;      // True if at least one more row follows Next
+
+    WorklistDisplayPage() = default;
+};
+}
+
+#endif // WORKLISTDISPLAYROW_H
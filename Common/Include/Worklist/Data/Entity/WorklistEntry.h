@@ -14,6 +14,7 @@ class WorklistEntry {
 public:
     int Id = -1;
     Source Source;
+    QString SourceConnection;  // RIS connection the entry was first received from, empty if local
     WorklistProfile Profile;
     ProcedureStepStatus Status;
     QDateTime CreatedAt;
@@ -0,0 +1,38 @@
+#ifndef WORKLISTENTRYPAGE_H
+#define WORKLISTENTRYPAGE_H
+#include <QList>
+#include <QDateTime>
+#include "WorklistEntry.h"
+
+namespace Etrek::Worklist::Data::Entity {
+
+/**
+ * @brief Position in the (created_at, id) ordering of worklist entries.
+ *
+ * A default cursor points before the newest entry; pass WorklistEntryPage::Next
+ * back to the repository to read the following page.
+ */
+class WorklistPageCursor {
+public:
+    QDateTime CreatedAt;       // created_at of the last entry seen, may be null
+    int Id = -1;               // id of the last entry seen, -1 for the first page
+
+    WorklistPageCursor() = default;
+
+    bool isStart() const { return Id < 0; }
+};
+
+/**
+ * @brief One page of worklist entries, newest first, with their attributes loaded.
+ */
+class WorklistEntryPage {
+public:
+    QList<WorklistEntry> Entries;
+    WorklistPageCursor Next;   // Cursor of the last entry in this page
+    bool HasMore = false;      // True if at least one more entry follows Next
+
+    WorklistEntryPage() = default;
+};
+}
+
+#endif // WORKLISTENTRYPAGE_H
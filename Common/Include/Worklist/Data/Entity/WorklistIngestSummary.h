@@ -0,0 +1,26 @@
+#ifndef WORKLISTINGESTSUMMARY_H
+#define WORKLISTINGESTSUMMARY_H
+#include <QList>
+
+namespace Etrek::Worklist::Data::Entity {
+
+/**
+ * @brief Outcome of a batch ingest of worklist entries received from a RIS.
+ */
+class WorklistIngestSummary {
+public:
+    int Received = 0;          // Entries passed to the ingest call
+    int Created = 0;           // New entries inserted
+    int Updated = 0;           // Existing entries whose attribute values changed
+    int Unchanged = 0;         // Existing entries already up to date
+    qint64 ElapsedMs = 0;      // Wall time spent in the repository
+
+    QList<int> CreatedIds;
+    QList<int> UpdatedIds;
+    QList<int> UnchangedIds;
+
+    WorklistIngestSummary() = default;
+};
+}
+
+#endif // WORKLISTINGESTSUMMARY_H
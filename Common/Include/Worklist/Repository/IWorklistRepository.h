@@ -10,6 +10,8 @@
 #include "Worklist/Data/Entity/WorklistEntry.h"
 #include "Worklist/Data/Entity/WorklistAttribute.h"
 #include "Worklist/Data/Entity/WorklistProfile.h"
+#include "Worklist/Data/Entity/WorklistEntryPage.h"
+#include "Worklist/Data/Entity/WorklistDisplayRow.h"
 #include "Worklist/Specification/WorklistEnum.h"
 
 class DatabaseConnectionSetting;
@@ -65,6 +67,29 @@ namespace Etrek::Worklist::Repository {
          */
         virtual Etrek::Specification::Result<QList<Etrek::Worklist::Data::Entity::WorklistEntry>> getWorklistEntries(const QDateTime* from, const QDateTime* to) const = 0;
 
+        /**
+         * @brief Reads one page of worklist entries, newest first, with their attributes.
+         *
+         * Pages are addressed by the (created_at, id) of the last entry seen rather than an offset,
+         * so every page costs the same regardless of its position and memory stays bounded by @p pageSize.
+         * @param after Cursor returned as WorklistEntryPage::Next by the previous call; default for the first page.
+         * @param pageSize Maximum number of entries in the page (clamped to 1..500).
+         * @param from Start date/time (optional).
+         * @param to End date/time (optional).
+         * @return Result containing the page and the cursor for the next one.
+         */
+        virtual Etrek::Specification::Result<Etrek::Worklist::Data::Entity::WorklistEntryPage> getWorklistEntriesPage(const Etrek::Worklist::Data::Entity::WorklistPageCursor& after, int pageSize, const QDateTime* from = nullptr, const QDateTime* to = nullptr) const = 0;
+
+        /**
+         * @brief Reads one page of worklist grid rows, newest first, from the display projection.
+         * @param after Cursor returned as WorklistDisplayPage::Next by the previous call; default for the first page.
+         * @param pageSize Maximum number of rows in the page.
+         * @param from Start date/time (optional).
+         * @param to End date/time (optional).
+         * @return Result containing the page and the cursor for the next one.
+         */
+        virtual Etrek::Specification::Result<Etrek::Worklist::Data::Entity::WorklistDisplayPage> getWorklistDisplayPage(const Etrek::Worklist::Data::Entity::WorklistPageCursor& after, int pageSize, const QDateTime* from = nullptr, const QDateTime* to = nullptr) const = 0;
+
         /**
          * @brief Retrieves worklist entries by source.
          * @param source The source (e.g., LOCAL, RIS).
@@ -94,6 +119,17 @@ namespace Etrek::Worklist::Repository {
          */
         virtual Etrek::Specification::Result<bool> deleteWorklistEntries(const QDateTime& beforeDate) = 0;
 
+        /**
+         * @brief Deletes at most @p maxEntries of the oldest worklist entries created before a date.
+         *
+         * The entries and their attributes are deleted in one short transaction; call again until
+         * fewer than @p maxEntries are reported to purge everything.
+         * @param beforeDate The cutoff date.
+         * @param maxEntries Maximum number of entries to delete.
+         * @return Result containing the number of entries deleted.
+         */
+        virtual Etrek::Specification::Result<int> purgeWorklistEntries(const QDateTime& beforeDate, int maxEntries) = 0;
+
         /**
          * @brief Deletes worklist entries by their IDs.
          * @param entryIds List of entry IDs to delete.
@@ -0,0 +1,159 @@
+#ifndef WORKLISTDISPLAYPROJECTION_H
+#define WORKLISTDISPLAYPROJECTION_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include "SqlDialect.h"
+
+namespace Etrek::Worklist::Repository {
+
+    /**
+     * @brief Maintenance of the display_* columns of mwl_entries.
+     *
+     * The worklist grid shows a fixed set of attributes per entry. They are materialized on
+     * mwl_entries from the active mwl_attributes of the entry so the grid can read a page with
+     * one narrow query instead of joining mwl_attributes and dicom_tags. Every code path that
+     * writes attributes, or changes which tags are active, refreshes the affected entries.
+     *
+     * Keep the column mapping in sync with Script/Migration/0003_mwl_entries_display_columns.sql.
+     * SQLite has no UPDATE ... JOIN, so it gets an equivalent correlated-subquery statement.
+     */
+    namespace WorklistDisplayProjection {
+
+        // Entry ids per refresh statement
+        constexpr int REFRESH_BATCH_SIZE = 500;
+
+        /**
+         * @brief Builds the refresh statement for the entries whose ids are produced by @p entryIds.
+         * @param entryIds SQL usable inside IN (...): a placeholder list or a subquery. It appears
+         *        bindPasses() times, so its parameters must be bound that many times.
+         */
+        inline QString refreshSql(const QString& entryIds, const Etrek::Core::Repository::SqlDialect& dialect)
+        {
+            if (dialect.isSqlite()) {
+                return QString(R"(
+                    UPDATE mwl_entries
+                    SET (display_patient_name, display_patient_id, display_study_name, display_patient_sex,
+                         display_birth_date, display_accession_number, display_admission_id) = (
+                        SELECT MAX(CASE WHEN t.name = 'PatientName' THEN a.tag_value END),
+                               MAX(CASE WHEN t.name = 'PatientID' THEN a.tag_value END),
+                               COALESCE(NULLIF(MAX(CASE WHEN t.name = 'StudyDescription' THEN a.tag_value END), ''),
+                                        MAX(CASE WHEN t.name = 'StudyID' THEN a.tag_value END)),
+                               MAX(CASE WHEN t.name = 'PatientSex' THEN a.tag_value END),
+                               MAX(CASE WHEN t.name = 'PatientBirthDate' THEN a.tag_value END),
+                               MAX(CASE WHEN t.name = 'AccessionNumber' THEN a.tag_value END),
+                               MAX(CASE WHEN t.name = 'AdmissionID' THEN a.tag_value END)
+                        FROM mwl_attributes a
+                        JOIN dicom_tags t ON t.id = a.dicom_tag_id AND t.is_active = TRUE
+                        WHERE a.mwl_entry_id = mwl_entries.id
+                    )
+                    WHERE id IN (%1)
+                )").arg(entryIds);
+            }
+
+            return QString(R"(
+                UPDATE mwl_entries e
+                LEFT JOIN (
+                    SELECT a.mwl_entry_id,
+                           MAX(CASE WHEN t.name = 'PatientName' THEN a.tag_value END) AS patient_name,
+                           MAX(CASE WHEN t.name = 'PatientID' THEN a.tag_value END) AS patient_id,
+                           MAX(CASE WHEN t.name = 'StudyDescription' THEN a.tag_value END) AS study_description,
+                           MAX(CASE WHEN t.name = 'StudyID' THEN a.tag_value END) AS study_id,
+                           MAX(CASE WHEN t.name = 'PatientSex' THEN a.tag_value END) AS patient_sex,
+                           MAX(CASE WHEN t.name = 'PatientBirthDate' THEN a.tag_value END) AS birth_date,
+                           MAX(CASE WHEN t.name = 'AccessionNumber' THEN a.tag_value END) AS accession_number,
+                           MAX(CASE WHEN t.name = 'AdmissionID' THEN a.tag_value END) AS admission_id
+                    FROM mwl_attributes a
+                    JOIN dicom_tags t ON t.id = a.dicom_tag_id AND t.is_active = TRUE
+                    WHERE a.mwl_entry_id IN (%1)
+                    GROUP BY a.mwl_entry_id
+                ) d ON d.mwl_entry_id = e.id
+                SET e.display_patient_name = d.patient_name,
+                    e.display_patient_id = d.patient_id,
+                    e.display_study_name = COALESCE(NULLIF(d.study_description, ''), d.study_id),
+                    e.display_patient_sex = d.patient_sex,
+                    e.display_birth_date = d.birth_date,
+                    e.display_accession_number = d.accession_number,
+                    e.display_admission_id = d.admission_id
+                WHERE e.id IN (%1)
+            )").arg(entryIds);
+        }
+
+        /**
+         * @brief Number of times the parameters of the id list are bound in refreshSql().
+         */
+        inline int bindPasses(const Etrek::Core::Repository::SqlDialect& dialect)
+        {
+            return dialect.isSqlite() ? 1 : 2;
+        }
+
+        /**
+         * @brief Recomputes the display columns of the given entries.
+         * @param db Open connection; run inside the transaction that wrote the attributes.
+         * @param entryIds Entries to refresh.
+         * @param error Receives the driver error on failure (optional).
+         * @return True on success.
+         */
+        inline bool refreshEntries(QSqlDatabase& db, const QList<int>& entryIds, QString* error = nullptr)
+        {
+            const auto dialect = Etrek::Core::Repository::SqlDialect::of(db);
+            for (int offset = 0; offset < entryIds.size(); offset += REFRESH_BATCH_SIZE) {
+                const int count = qMin(REFRESH_BATCH_SIZE, int(entryIds.size()) - offset);
+
+                QStringList placeholders;
+                for (int i = 0; i < count; ++i)
+                    placeholders << "?";
+
+                QSqlQuery query(db);
+                query.prepare(refreshSql(placeholders.join(","), dialect));
+                for (int pass = 0; pass < bindPasses(dialect); ++pass) {
+                    for (int i = 0; i < count; ++i)
+                        query.addBindValue(entryIds[offset + i]);
+                }
+
+                if (!query.exec()) {
+                    if (error)
+                        *error = query.lastError().text();
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * @brief Recomputes the display columns of every entry carrying @p tagId, if it is a display tag.
+         *
+         * Used when a tag is activated or deactivated, which adds or removes its values from the grid.
+         */
+        inline bool refreshEntriesWithTag(QSqlDatabase& db, int tagId, QString* error = nullptr)
+        {
+            const QString entriesWithTag = R"(
+                SELECT x.mwl_entry_id FROM mwl_attributes x
+                JOIN dicom_tags xt ON xt.id = x.dicom_tag_id
+                WHERE x.dicom_tag_id = ?
+                  AND xt.name IN ('PatientName', 'PatientID', 'StudyDescription', 'StudyID', 'PatientSex',
+                                  'PatientBirthDate', 'AccessionNumber', 'AdmissionID')
+            )";
+
+            const auto dialect = Etrek::Core::Repository::SqlDialect::of(db);
+            QSqlQuery query(db);
+            query.prepare(refreshSql(entriesWithTag, dialect));
+            for (int pass = 0; pass < bindPasses(dialect); ++pass)
+                query.addBindValue(tagId);
+
+            if (!query.exec()) {
+                if (error)
+                    *error = query.lastError().text();
+                return false;
+            }
+            return true;
+        }
+    }
+
+} // namespace Etrek::Worklist::Repository
+
+#endif // WORKLISTDISPLAYPROJECTION_H
@@ -1,5 +1,6 @@
 #include "DatabaseConnectionSetting.h"
 #include "DatabaseConnectionSetting.h"
+#include <QFileInfo>
 
 
 namespace Etrek::Core::Data::Model
@@ -21,6 +22,9 @@ void DatabaseConnectionSetting::setEtrektUserName(const QString& username) { m_u
 void DatabaseConnectionSetting::setPassword(const QString& password) { m_password = password; }
 void DatabaseConnectionSetting::setPort(int port) { m_port = port; }
 void DatabaseConnectionSetting::setIsPasswordEncrypted(bool encrypted) { m_isPasswordEncrypted = encrypted; }
+void DatabaseConnectionSetting::setStorageBackend(StorageBackend backend) { m_storageBackend = backend; }
+void DatabaseConnectionSetting::setSlowQueryThresholdMs(int thresholdMs) { m_slowQueryThresholdMs = thresholdMs; }
+void DatabaseConnectionSetting::setDumpQueryStatistics(bool dump) { m_dumpQueryStatistics = dump; }
 
 QString DatabaseConnectionSetting::getHostName() const { return m_hostName; }
 QString DatabaseConnectionSetting::getDatabaseName() const { return m_databaseName; }
@@ -28,4 +32,18 @@ QString DatabaseConnectionSetting::getEtrekUserName() const { return m_userName;
 QString DatabaseConnectionSetting::getPassword() const { return m_password; }
 int DatabaseConnectionSetting::getPort() const { return m_port; }
 bool DatabaseConnectionSetting::getIsPasswordEncrypted() const { return m_isPasswordEncrypted; }
+StorageBackend DatabaseConnectionSetting::getStorageBackend() const { return m_storageBackend; }
+int DatabaseConnectionSetting::getSlowQueryThresholdMs() const { return m_slowQueryThresholdMs; }
+bool DatabaseConnectionSetting::getDumpQueryStatistics() const { return m_dumpQueryStatistics; }
+
+QString DatabaseConnectionSetting::connectionKey() const
+{
+    if (m_storageBackend == StorageBackend::Sqlite)
+        return QString("sqlite:%1").arg(QFileInfo(m_databaseName).absoluteFilePath());
+
+    return QString("%1@%2:%3/%4")
+        .arg(m_userName, m_hostName)
+        .arg(m_port)
+        .arg(m_databaseName);
+}
 }
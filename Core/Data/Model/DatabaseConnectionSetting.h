@@ -6,12 +6,28 @@
 
 namespace Etrek::Core::Data::Model
 {
+    /**
+     * @brief Storage engine behind a connection setting.
+     *
+     * MySql is the clinical database. Sqlite is an embedded single-file store, used as
+     * the standalone database of the Demo launch mode, of Developer mode without a database
+     * server and of the tests, and as the local offline store that keeps the worklist
+     * available while MySQL is down.
+     */
+    enum class StorageBackend
+    {
+        MySql,
+        Sqlite
+    };
+
     /**
      * @class DatabaseConnectionSetting
      * @brief Stores configuration parameters for a database connection.
      *
      * Encapsulates details such as host name, database name, user credentials,
      * port number, and a flag indicating whether the password is encrypted.
+     * For the Sqlite backend the database name is the path of the database file and
+     * the server fields are ignored.
      * Designed to provide convenient getters and setters for these parameters.
      *
      * Inherits from QObject to support signal-slot connections and enable
@@ -37,6 +53,9 @@ namespace Etrek::Core::Data::Model
         void setPassword(const QString& password);
         void setPort(int port);
         void setIsPasswordEncrypted(bool encrypted);
+        void setStorageBackend(StorageBackend backend);
+        void setSlowQueryThresholdMs(int thresholdMs);
+        void setDumpQueryStatistics(bool dump);
 
         QString getHostName() const;
         QString getDatabaseName() const;
@@ -44,6 +63,17 @@ namespace Etrek::Core::Data::Model
         QString getPassword() const;
         int getPort() const;
         bool getIsPasswordEncrypted() const;
+        StorageBackend getStorageBackend() const;
+        int getSlowQueryThresholdMs() const;
+        bool getDumpQueryStatistics() const;
+
+        /**
+         * @brief Identity of the database this setting points at.
+         *
+         * Settings with the same key share pooled connections and process-wide caches.
+         * "user@host:port/db" for MySQL, "sqlite:<absolute file path>" for SQLite.
+         */
+        QString connectionKey() const;
 
     private:
         QString m_hostName;
@@ -52,6 +82,9 @@ namespace Etrek::Core::Data::Model
         QString m_password;
         int m_port;
         bool m_isPasswordEncrypted = false;
+        StorageBackend m_storageBackend = StorageBackend::MySql;
+        int m_slowQueryThresholdMs = 200;  // statements slower than this are logged; 0 = off
+        bool m_dumpQueryStatistics = false; // query timings on Ctrl+Shift+F12 and at exit, in any launch mode
     };
 }
 
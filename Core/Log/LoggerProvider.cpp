@@ -1,4 +1,5 @@
 #include <QDir>
+#include <QFile>
 #include <QFileInfo>
 #include <QStorageInfo>
 #include <QDebug>
@@ -102,6 +103,28 @@ namespace Etrek::Core::Log {
     }
 
 
+    Result<int> LoggerProvider::DeleteRotatedLogFiles(const QDateTime& olderThan, int maxFiles)
+    {
+        QReadLocker locker(&lock);
+        if (m_logDirectory.isEmpty())
+            return Result<int>::Success(0);
+
+        // spdlog's rotating sink renames logs.log to logs.1.log, logs.1.log to logs.2.log, ...
+        QDir dir(m_logDirectory);
+        const QFileInfoList rotated = dir.entryInfoList(QStringList() << "logs.*.log", QDir::Files, QDir::Time | QDir::Reversed);
+
+        int deleted = 0;
+        for (const QFileInfo& file : rotated) {
+            if (deleted >= maxFiles || file.lastModified() >= olderThan)
+                break;
+            if (QFile::remove(file.absoluteFilePath()))
+                ++deleted;
+            else
+                qWarning() << "Failed to delete rotated log file" << file.absoluteFilePath();
+        }
+        return Result<int>::Success(deleted);
+    }
+
     void LoggerProvider::Shutdown()
     {
         QWriteLocker locker(&lock);
@@ -50,6 +50,16 @@ namespace Etrek::Core::Log {
          */
         std::shared_ptr<spdlog::logger> GetFileLogger(const std::string& serviceName, LogLevel level = LogLevel::Debug);
 
+        /**
+         * @brief Deletes rotated log files (logs.1.log, logs.2.log, ...) last written before @p olderThan.
+         *
+         * The active logs.log is never deleted. Files that cannot be removed are skipped.
+         * @param olderThan Cutoff for the file's last modification time.
+         * @param maxFiles Maximum number of files to delete in this call.
+         * @return Result containing the number of files deleted.
+         */
+        Etrek::Specification::Result<int> DeleteRotatedLogFiles(const QDateTime& olderThan, int maxFiles);
+
         /**
          * @brief Shuts down all managed loggers and releases resources.
          */
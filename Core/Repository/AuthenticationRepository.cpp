@@ -6,6 +6,9 @@
 #include "DatabaseConnectionSetting.h"
 #include "AuthenticationRepository.h"
 #include "AppLoggerFactory.h"
+#include "DatabaseConnectionPool.h"
+#include "QueryStatistics.h"
+#include "SqlDialect.h"
 #include "MessageKey.h"
 
 namespace Etrek::Core::Repository {
@@ -30,25 +33,15 @@ namespace Etrek::Core::Repository {
         //logger = factory.CreateLogger("WorklistRepository");
     }
 
-    QSqlDatabase AuthenticationRepository::createConnection(const QString& connectionName) const {
-        QSqlDatabase db = QSqlDatabase::addDatabase("QMYSQL", connectionName);
-        db.setHostName(m_connectionSetting->getHostName());
-        db.setDatabaseName(m_connectionSetting->getDatabaseName());
-        db.setUserName(m_connectionSetting->getEtrekUserName());
-        db.setPassword(m_connectionSetting->getPassword());
-        db.setPort(m_connectionSetting->getPort());
-        return db;
-    }
-
     Result<User> AuthenticationRepository::createUser(User& user)
     {
         int newId = -1;
-        QString connectionName = "auth_connection_create_user";
 
         {
-            QSqlDatabase db = createConnection(connectionName);
-            if (!db.open()) {
-                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(error);
                 qDebug() << error;				
                 return Result<User>::Failure(error);
@@ -57,7 +50,7 @@ namespace Etrek::Core::Repository {
             QSqlQuery checkQuery(db);
             checkQuery.prepare("SELECT COUNT(*) FROM users WHERE user_name = ?");
             checkQuery.addBindValue(user.Username);
-            if (!checkQuery.exec()) {
+            if (!QueryStatistics::exec(checkQuery)) {
 				QString error = translator->getErrorMessage(AUTH_CHECK_USER_EXISTS_FAILED_MSG).arg(checkQuery.lastError().text());
                 logger->LogError(error);
                 qDebug() << error;
@@ -81,7 +74,7 @@ namespace Etrek::Core::Repository {
             insertQuery.addBindValue(user.Surname);
             insertQuery.addBindValue(user.PasswordHash);
 
-            if (!insertQuery.exec()) {
+            if (!QueryStatistics::exec(insertQuery)) {
                 QString error = translator->getErrorMessage(AUTH_FAILED_TO_CREATE_USER_ERROR_MSG).arg(insertQuery.lastError().text());
                 logger->LogError(error);
                 qDebug() << error;
@@ -102,7 +95,7 @@ namespace Etrek::Core::Repository {
                 roleQuery.prepare("INSERT INTO user_roles (user_id, role_id) VALUES (?, ?)");
                 roleQuery.addBindValue(newId);
                 roleQuery.addBindValue(role.Id);
-                if (!roleQuery.exec()) {
+                if (!QueryStatistics::exec(roleQuery)) {
                     QString error = translator->getErrorMessage(AUTH_ROLE_ASSIGNMENT_FAILED_ERROR_MSG).arg(roleQuery.lastError().text());
                     logger->LogError(error);
                     qDebug() << error;
@@ -111,8 +104,6 @@ namespace Etrek::Core::Repository {
             }
         }
 
-        QSqlDatabase::removeDatabase(connectionName);
-
         user.Id = newId;
 
         return Result<User>::Success(user);
@@ -120,12 +111,11 @@ namespace Etrek::Core::Repository {
 
     Result<User> AuthenticationRepository::updateUser(User& user)
     {
-        QString connectionName = "auth_connection_update_user";
-
         {
-            QSqlDatabase db = createConnection(connectionName);
-            if (!db.open()) {
-                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(error);
                 qDebug() << error;
 				return Result<User>::Failure(error);            
@@ -136,7 +126,7 @@ namespace Etrek::Core::Repository {
             checkIdQuery.prepare("SELECT COUNT(*) FROM users WHERE id = ?");
             checkIdQuery.addBindValue(user.Id);
             
-            if (!checkIdQuery.exec() || !checkIdQuery.next() || checkIdQuery.value(0).toInt() == 0) {
+            if (!QueryStatistics::exec(checkIdQuery) || !checkIdQuery.next() || checkIdQuery.value(0).toInt() == 0) {
 
                 QString error = translator->getErrorMessage(AUTH_USER_NOT_EXISTS_ERROR);
                 logger->LogError(error);
@@ -151,7 +141,7 @@ namespace Etrek::Core::Repository {
             checkUsernameQuery.addBindValue(user.Username);
             checkUsernameQuery.addBindValue(user.Id);
             
-            if (!checkUsernameQuery.exec()) {
+            if (!QueryStatistics::exec(checkUsernameQuery)) {
 
                 QString error = translator->getErrorMessage(AUTH_CHECK_USERNAME_FAILED_ERROR).arg(checkUsernameQuery.lastError().text());
                 logger->LogError(error);
@@ -169,11 +159,11 @@ namespace Etrek::Core::Repository {
 
             // 3. Perform the update
             QSqlQuery updateQuery(db);
-            updateQuery.prepare(R"(
+            updateQuery.prepare(QString(R"(
             UPDATE users
-            SET user_name = ?, name = ?, surname = ?, password_hash = ?, is_active = ?, update_date = NOW()
+            SET user_name = ?, name = ?, surname = ?, password_hash = ?, is_active = ?, update_date = %1
             WHERE id = ?
-            )");
+            )").arg(SqlDialect::of(db).currentTimestamp()));
             updateQuery.addBindValue(user.Username);
             updateQuery.addBindValue(user.Name);
             updateQuery.addBindValue(user.Surname);
@@ -181,7 +171,7 @@ namespace Etrek::Core::Repository {
             updateQuery.addBindValue(user.IsActive);
             updateQuery.addBindValue(user.Id);
 
-            if (!updateQuery.exec()) {
+            if (!QueryStatistics::exec(updateQuery)) {
 
                 QString error = translator->getErrorMessage(AUTH_FAILED_TO_UPDATE_USER_ERROR_MSG).arg(updateQuery.lastError().text());
                 logger->LogError(error);
@@ -195,7 +185,7 @@ namespace Etrek::Core::Repository {
             deleteRolesQuery.prepare("DELETE FROM user_roles WHERE user_id = ?");
             deleteRolesQuery.addBindValue(user.Id);
             
-            if (!deleteRolesQuery.exec()) {
+            if (!QueryStatistics::exec(deleteRolesQuery)) {
                 QString error = translator->getErrorMessage(AUTH_CLEAR_EXISTING_ROLES_FAILED_ERROR_MSG).arg(deleteRolesQuery.lastError().text());
                 logger->LogError(error);
                 qDebug() << error;
@@ -215,7 +205,7 @@ namespace Etrek::Core::Repository {
                 insertRoleQuery.addBindValue(user.Id);
                 insertRoleQuery.addBindValue(role.Id);
 
-                if (!insertRoleQuery.exec()) {
+                if (!QueryStatistics::exec(insertRoleQuery)) {
                     QString error = translator->getErrorMessage(AUTH_ROLE_ASSIGNMENT_FAILED_ERROR_MSG).arg(insertRoleQuery.lastError().text());
                     logger->LogError(error);
                     qDebug() << error;
@@ -224,18 +214,16 @@ namespace Etrek::Core::Repository {
             }
         }
 
-        QSqlDatabase::removeDatabase(connectionName);
         return Result<User>::Success(user);
     }
 
     Result<User> AuthenticationRepository::deleteUser(User& user)
     {
-        QString connectionName = "auth_connection_delete_user";
-
         {
-            QSqlDatabase db = createConnection(connectionName);
-            if (!db.open()) {
-                return Result<User>::Failure("Failed to open DB: " + db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                return Result<User>::Failure("Failed to open DB: " + lease.lastError());
             }
 
             // 1. Check if user exists
@@ -243,20 +231,20 @@ namespace Etrek::Core::Repository {
             checkQuery.prepare("SELECT COUNT(*) FROM users WHERE id = ?");
             checkQuery.addBindValue(user.Id);
 
-            if (!checkQuery.exec() || !checkQuery.next() || checkQuery.value(0).toInt() == 0) {
+            if (!QueryStatistics::exec(checkQuery) || !checkQuery.next() || checkQuery.value(0).toInt() == 0) {
                 return Result<User>::Failure("User does not exist.");
             }
 
             // 2. Mark user as deleted
             QSqlQuery deleteQuery(db);
-            deleteQuery.prepare(R"(
+            deleteQuery.prepare(QString(R"(
             UPDATE users
-            SET is_deleted = TRUE, update_date = NOW()
+            SET is_deleted = TRUE, update_date = %1
             WHERE id = ?
-            )");
+            )").arg(SqlDialect::of(db).currentTimestamp()));
             deleteQuery.addBindValue(user.Id);
 
-            if (!deleteQuery.exec()) {
+            if (!QueryStatistics::exec(deleteQuery)) {
                 return Result<User>::Failure("Delete user failed: " + deleteQuery.lastError().text());
             }
 
@@ -265,7 +253,6 @@ namespace Etrek::Core::Repository {
             user.UpdateDate = QDateTime::currentDateTime();
         }
 
-        QSqlDatabase::removeDatabase(connectionName);
         return Result<User>::Success(user);
     }
 
@@ -273,13 +260,13 @@ namespace Etrek::Core::Repository {
 
 
     Result<int> AuthenticationRepository::createRole(const QString& roleName) {
-        QString connectionName = "auth_connection_create_role";
         int newId = -1;
 
         {
-            QSqlDatabase db = createConnection(connectionName);
-            if (!db.open()) {
-                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(error);
                 qDebug() << error;
                 return Result<int>::Failure(error);
@@ -289,7 +276,7 @@ namespace Etrek::Core::Repository {
             query.prepare("INSERT INTO roles (name) VALUES (?)");
             query.addBindValue(roleName);
 
-            if (!query.exec()) {
+            if (!QueryStatistics::exec(query)) {
                 QString error = translator->getErrorMessage(AUTH_FAILED_TO_CREATE_ROLE_ERROR_MSG).arg(query.lastError().text());
                 logger->LogError(error);
                 qDebug() << error;
@@ -299,17 +286,15 @@ namespace Etrek::Core::Repository {
             newId = query.lastInsertId().toInt();
         }
 
-        QSqlDatabase::removeDatabase(connectionName);
         return Result<int>::Success(newId);
     }
 
     Result<QString> AuthenticationRepository::assignRoleToUser(int userId, int roleId) {
-        QString connectionName = "auth_connection_assign_role";
-
         {
-            QSqlDatabase db = createConnection(connectionName);
-            if (!db.open()) {
-                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(error);
                 qDebug() << error;
                 return Result<QString>::Failure(error);
@@ -320,7 +305,7 @@ namespace Etrek::Core::Repository {
             query.addBindValue(userId);
             query.addBindValue(roleId);
 
-            if (!query.exec()) {
+            if (!QueryStatistics::exec(query)) {
                 QString error = translator->getErrorMessage(AUTH_ROLE_ASSIGNMENT_FAILED_ERROR_MSG).arg(query.lastError().text());
                 logger->LogError(error);
                 qDebug() << error;
@@ -329,20 +314,17 @@ namespace Etrek::Core::Repository {
 
         }
 
-        QSqlDatabase::removeDatabase(connectionName);
-
         QString info = translator->getInfoMessage(AUTH_ROLE_ASSIGNMENT_SUCCEED_MSG);
 
         return Result<QString>::Success(info);
     }
 
     Result<QString> AuthenticationRepository::removeRoleFromUser(int userId, int roleId) {
-        QString connectionName = "auth_connection_remove_role";
-
         {
-            QSqlDatabase db = createConnection(connectionName);
-            if (!db.open()) {
-                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(error);
                 qDebug() << error;
                 return Result<QString>::Failure(error);                
@@ -353,7 +335,7 @@ namespace Etrek::Core::Repository {
             query.addBindValue(userId);
             query.addBindValue(roleId);
 
-            if (!query.exec()) {
+            if (!QueryStatistics::exec(query)) {
 				QString error = translator->getErrorMessage(AUTH_FAILED_TO_REMOVE_ROLE_ERROR_MSG).arg(query.lastError().text());
                 logger->LogError(error);
                 qDebug() << error;
@@ -361,21 +343,19 @@ namespace Etrek::Core::Repository {
             }
         }
 
-        QSqlDatabase::removeDatabase(connectionName);
         return Result<QString>::Success("Role removed successfully.");
     }
 
     Result<bool> AuthenticationRepository::checkUserHasRole(int userId, const QString& roleName) {
-        QString connectionName = "auth_connection_check_role";
-
         bool ok = false;
         bool hasRole = false;
         QString err;
 
         {
-            QSqlDatabase db = createConnection(connectionName);
-            if (!db.open()) {
-                err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
             }
             else {
                 QSqlQuery query(db);
@@ -388,7 +368,7 @@ namespace Etrek::Core::Repository {
                 query.addBindValue(userId);
                 query.addBindValue(roleName);
 
-                if (!query.exec()) {
+                if (!QueryStatistics::exec(query)) {
                     err = translator->getErrorMessage(AUTH_CHECK_ROLE_FAILED_ERROR_MSG).arg(query.lastError().text());
                 }
                 else if (query.next()) {
@@ -398,7 +378,6 @@ namespace Etrek::Core::Repository {
             }
         }
 
-        QSqlDatabase::removeDatabase(connectionName);
         if (!ok) return Result<bool>::Failure(err.isEmpty()
             ? translator->getCriticalMessage(UNEXPECTED_ERROR_OCCURED_ERROR_MSG) : err);
         return Result<bool>::Success(hasRole);
@@ -408,12 +387,12 @@ namespace Etrek::Core::Repository {
 
     Result<QVector<User>> AuthenticationRepository::getAllActiveUsers() const {
         QVector<User> users;
-        QString connectionName = "auth_connection_list_active_users";
 
         {
-            QSqlDatabase db = createConnection(connectionName);
-            if (!db.open()) {
-                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(error);
                 qDebug() << error;
                 return Result<QVector<User>>::Failure(error);
@@ -426,7 +405,7 @@ namespace Etrek::Core::Repository {
             WHERE is_active = TRUE AND (is_deleted IS NULL OR is_deleted = FALSE)
             )");
 
-            if (!query.exec()) {
+            if (!QueryStatistics::exec(query)) {
 				QString error = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(query.lastError().text());
                 logger->LogError(error);
                 qDebug() << error;
@@ -455,7 +434,6 @@ namespace Etrek::Core::Repository {
             }
         }
 
-        QSqlDatabase::removeDatabase(connectionName);
         return Result<QVector<User>>::Success(users);
     }
 
@@ -480,7 +458,7 @@ namespace Etrek::Core::Repository {
 
         query.addBindValue(userId);
 
-        if (!query.exec()) {
+        if (!QueryStatistics::exec(query)) {
             QString error = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(query.lastError().text());
             logger->LogError(error);
             qDebug() << error;
@@ -501,12 +479,12 @@ namespace Etrek::Core::Repository {
 
     Result<QVector<User>> AuthenticationRepository::getAllInactiveUsers() const {
         QVector<User> users;
-        QString connectionName = "auth_connection_list_inactive_users";
 
         {
-            QSqlDatabase db = createConnection(connectionName);
-            if (!db.open()) {
-                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(error);
                 qDebug() << error;
                 return Result<QVector<User>>::Failure(error);
@@ -519,7 +497,7 @@ namespace Etrek::Core::Repository {
             WHERE is_active = FALSE OR is_deleted = TRUE
             )");
 
-            if (!query.exec()) {
+            if (!QueryStatistics::exec(query)) {
                 QString error = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(query.lastError().text());
                 logger->LogError(error);
                 qDebug() << error;
@@ -548,25 +526,24 @@ namespace Etrek::Core::Repository {
             }
         }
 
-        QSqlDatabase::removeDatabase(connectionName);
         return Result<QVector<User>>::Success(users);
     }
 
     Result<QVector<Role>> AuthenticationRepository::getAllRoles() const {
         QVector<Role> roles;
-        QString connectionName = "auth_connection_get_all_roles";
 
         QString err;
         bool ok = false;
 
         {
-            QSqlDatabase db = createConnection(connectionName);
-            if (!db.open()) {
-                err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
             }
             else {
                 QSqlQuery query(db);
-                if (!query.exec("SELECT id, name FROM roles")) {
+                if (!QueryStatistics::exec(query, "SELECT id, name FROM roles")) {
                     err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(query.lastError().text());
                 }
                 else {
@@ -581,7 +558,6 @@ namespace Etrek::Core::Repository {
             }
         }
 
-        QSqlDatabase::removeDatabase(connectionName);
         if (!ok) return Result<QVector<Role>>::Failure(err);
         return Result<QVector<Role>>::Success(roles);
     }
@@ -589,16 +565,15 @@ namespace Etrek::Core::Repository {
 
 
     Result<User> AuthenticationRepository::getUser(const QString& username) const {
-        QString connectionName = "auth_connection_get_user";
-
         QString err;
         bool ok = false;
         User user;
 
         {
-            QSqlDatabase db = createConnection(connectionName);
-            if (!db.open()) {
-                err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
             }
             else {
                 QSqlQuery query(db);
@@ -609,7 +584,7 @@ namespace Etrek::Core::Repository {
             )");
                 query.addBindValue(username);
 
-                if (!query.exec()) {
+                if (!QueryStatistics::exec(query)) {
                     err = translator->getErrorMessage(AUTH_GET_USER_FAILED_ERROR_MSG).arg(query.lastError().text());
                 }
                 else if (query.next()) {
@@ -630,7 +605,7 @@ namespace Etrek::Core::Repository {
                     WHERE ur.user_id = ?
                 )");
                     roleQuery.addBindValue(user.Id);
-                    if (roleQuery.exec()) {
+                    if (QueryStatistics::exec(roleQuery)) {
                         while (roleQuery.next()) {
                             Role role;
                             role.Id = roleQuery.value("id").toInt();
@@ -646,7 +621,6 @@ namespace Etrek::Core::Repository {
             }
         }
 
-        QSqlDatabase::removeDatabase(connectionName);
         if (!ok) return Result<User>::Failure(err);
         return Result<User>::Success(user);
     }
@@ -656,7 +630,7 @@ namespace Etrek::Core::Repository {
         QSqlQuery checkQuery(db);
         checkQuery.prepare("SELECT COUNT(*) FROM roles WHERE id = ?");
         checkQuery.addBindValue(roleId);
-        return checkQuery.exec() && checkQuery.next() && checkQuery.value(0).toInt() > 0;
+        return QueryStatistics::exec(checkQuery) && checkQuery.next() && checkQuery.value(0).toInt() > 0;
     }
 
 } // namespace Etrek::Repository
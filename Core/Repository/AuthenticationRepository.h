@@ -111,13 +111,6 @@ namespace Etrek::Core::Repository {
         Etrek::Specification::Result<bool> checkUserHasRole(int userId, const QString& roleName);
 
     private:
-        /**
-         * @brief Creates a new database connection with the specified name.
-         * @param connectionName The name for the database connection.
-         * @return The QSqlDatabase object for the connection.
-         */
-        QSqlDatabase createConnection(const QString& connectionName) const;
-
         /**
          * @brief Retrieves all roles assigned to a user.
          * @param userId The ID of the user.
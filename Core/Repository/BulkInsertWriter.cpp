@@ -0,0 +1,235 @@
+#include "BulkInsertWriter.h"
+#include <QSqlError>
+#include <QSqlQuery>
+#include "QueryStatistics.h"
+
+namespace Etrek::Core::Repository {
+
+    namespace {
+        // Headroom for the statement header and protocol framing.
+        constexpr qint64 PACKET_RESERVE_BYTES = 4096;
+        // Used when the server limit cannot be read; the MySQL 5.7 default.
+        constexpr qint64 DEFAULT_MAX_PACKET_BYTES = 4 * 1024 * 1024;
+        // SQLite has no packet; this only bounds the memory of one statement's parameters.
+        constexpr qint64 SQLITE_STATEMENT_BYTES = 64 * 1024 * 1024;
+    }
+
+    BulkInsertWriter::BulkInsertWriter(ConnectionLease& lease, QString table, QStringList columns)
+        : m_lease(lease)
+        , m_dialect(SqlDialect::of(lease.database()))
+        , m_table(std::move(table))
+        , m_columns(std::move(columns))
+    {
+    }
+
+    void BulkInsertWriter::setUpdateOnDuplicate(const QStringList& columns, const QString& guardColumn)
+    {
+        m_updateColumns = columns;
+        m_updateGuardColumn = guardColumn;
+    }
+
+    void BulkInsertWriter::setCollectGeneratedIds(bool collect)
+    {
+        m_collectIds = collect;
+    }
+
+    void BulkInsertWriter::addRow(const QVariantList& values)
+    {
+        Q_ASSERT(values.size() == m_columns.size());
+        m_rows.append(values);
+    }
+
+    int BulkInsertWriter::pendingRowCount() const
+    {
+        return m_rows.size();
+    }
+
+    QList<qint64> BulkInsertWriter::generatedIds() const
+    {
+        return m_generatedIds;
+    }
+
+    int BulkInsertWriter::rowsWritten() const
+    {
+        return m_rowsWritten;
+    }
+
+    int BulkInsertWriter::statementsExecuted() const
+    {
+        return m_statementsExecuted;
+    }
+
+    QString BulkInsertWriter::lastError() const
+    {
+        return m_lastError;
+    }
+
+    bool BulkInsertWriter::flush()
+    {
+        if (m_rows.isEmpty())
+            return true;
+
+        if (m_columns.isEmpty()) {
+            m_lastError = QStringLiteral("No columns given for bulk insert into %1").arg(m_table);
+            return false;
+        }
+
+        if (!loadServerSettings())
+            return false;
+
+        const int maxRows = qMax(1, m_dialect.maxPlaceholders() / int(m_columns.size()));
+        const qint64 budget = qMax<qint64>(m_maxPacketBytes - PACKET_RESERVE_BYTES, 1);
+        const bool rowByRow = m_collectIds && !m_consecutiveIds;
+        const int writtenBefore = m_rowsWritten;
+
+        int begin = 0;
+        while (begin < m_rows.size()) {
+            int end = begin;
+            qint64 bytes = statementFor(0).toUtf8().size();
+            while (end < m_rows.size() && end - begin < maxRows) {
+                const qint64 rowBytes = estimateRowBytes(m_rows[end]);
+                // A single oversized row is still sent on its own so the server reports the error.
+                if (end > begin && bytes + rowBytes > budget)
+                    break;
+                bytes += rowBytes;
+                ++end;
+            }
+
+            const bool ok = rowByRow ? writeRowByRow(begin, end) : writeChunk(begin, end);
+            if (!ok) {
+                // Keep only the rows that did not reach the server.
+                m_rows.remove(0, m_rowsWritten - writtenBefore);
+                return false;
+            }
+            begin = end;
+        }
+
+        m_rows.clear();
+        return true;
+    }
+
+    bool BulkInsertWriter::loadServerSettings()
+    {
+        if (m_settingsLoaded)
+            return true;
+
+        if (!m_lease.isValid()) {
+            m_lastError = m_lease.lastError();
+            return false;
+        }
+
+        m_maxPacketBytes = DEFAULT_MAX_PACKET_BYTES;
+        m_consecutiveIds = false;
+        m_autoIncrementStep = 1;
+
+        if (m_dialect.isSqlite()) {
+            m_maxPacketBytes = SQLITE_STATEMENT_BYTES;
+            m_consecutiveIds = true;
+            m_settingsLoaded = true;
+            return true;
+        }
+
+        QSqlQuery& query = m_lease.prepare("SELECT @@max_allowed_packet, @@innodb_autoinc_lock_mode, @@auto_increment_increment");
+        if (QueryStatistics::exec(query) && query.next()) {
+            m_maxPacketBytes = qMax<qint64>(query.value(0).toLongLong(), PACKET_RESERVE_BYTES * 2);
+            m_consecutiveIds = query.value(1).toInt() <= 1;
+            m_autoIncrementStep = qMax(1, query.value(2).toInt());
+        }
+
+        m_settingsLoaded = true;
+        return true;
+    }
+
+    qint64 BulkInsertWriter::estimateRowBytes(const QVariantList& row) const
+    {
+        // "(?, ?, ?), " in the statement text plus the binary parameters of the execute packet.
+        qint64 bytes = 4;
+        for (const QVariant& value : row) {
+            bytes += 3;
+            if (value.isNull())
+                bytes += 1;
+            else if (value.userType() == QMetaType::QString)
+                bytes += value.toString().toUtf8().size() + 9;
+            else if (value.userType() == QMetaType::QByteArray)
+                bytes += value.toByteArray().size() + 9;
+            else
+                bytes += 9;
+        }
+        return bytes;
+    }
+
+    QString BulkInsertWriter::statementFor(int rowCount) const
+    {
+        QStringList placeholders;
+        for (int i = 0; i < m_columns.size(); ++i)
+            placeholders << "?";
+        const QString row = "(" + placeholders.join(", ") + ")";
+
+        QStringList rows;
+        rows.reserve(rowCount);
+        for (int i = 0; i < rowCount; ++i)
+            rows << row;
+
+        QString sql = QString("INSERT INTO %1 (%2) VALUES %3").arg(m_table, m_columns.join(", "), rows.join(", "));
+
+        if (!m_updateColumns.isEmpty()) {
+            sql += m_updateGuardColumn.isEmpty()
+                ? m_dialect.upsertClause(m_updateColumns)
+                : m_dialect.upsertIfGreaterClause(m_updateGuardColumn, m_updateColumns);
+        }
+        return sql;
+    }
+
+    bool BulkInsertWriter::writeChunk(int begin, int end)
+    {
+        QSqlQuery query(m_lease.database());
+        if (!query.prepare(statementFor(end - begin))) {
+            m_lastError = query.lastError().text();
+            return false;
+        }
+
+        for (int i = begin; i < end; ++i) {
+            for (const QVariant& value : m_rows[i])
+                query.addBindValue(value);
+        }
+
+        if (!QueryStatistics::exec(query)) {
+            m_lastError = query.lastError().text();
+            return false;
+        }
+
+        ++m_statementsExecuted;
+        m_rowsWritten += end - begin;
+
+        if (m_collectIds) {
+            // MySQL reports the id of the first row of a multi-row INSERT, SQLite that of the last.
+            const qint64 reportedId = query.lastInsertId().toLongLong();
+            const qint64 firstId = m_dialect.isSqlite() ? reportedId - (end - begin - 1) : reportedId;
+            for (int i = 0; i < end - begin; ++i)
+                m_generatedIds.append(firstId + qint64(i) * m_autoIncrementStep);
+        }
+        return true;
+    }
+
+    bool BulkInsertWriter::writeRowByRow(int begin, int end)
+    {
+        QSqlQuery& query = m_lease.prepare(statementFor(1));
+
+        for (int i = begin; i < end; ++i) {
+            const QVariantList& row = m_rows[i];
+            for (int column = 0; column < row.size(); ++column)
+                query.bindValue(column, row[column]);
+
+            if (!QueryStatistics::exec(query)) {
+                m_lastError = query.lastError().text();
+                return false;
+            }
+
+            ++m_statementsExecuted;
+            ++m_rowsWritten;
+            m_generatedIds.append(query.lastInsertId().toLongLong());
+        }
+        return true;
+    }
+
+} // namespace Etrek::Core::Repository
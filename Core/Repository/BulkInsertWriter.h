@@ -0,0 +1,129 @@
+#ifndef BULKINSERTWRITER_H
+#define BULKINSERTWRITER_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+#include "DatabaseConnectionPool.h"
+#include "SqlDialect.h"
+
+namespace Etrek::Core::Repository {
+
+    /**
+     * @class BulkInsertWriter
+     * @brief Writes buffered rows to one table with multi-row INSERT statements.
+     *
+     * Rows are collected with addRow() and written by flush() as
+     * `INSERT INTO table (...) VALUES (...),(...),...`. Each statement holds as many
+     * rows as fit in the server's max_allowed_packet and in the placeholder limit of a
+     * prepared statement (65535 on MySQL, 32766 on SQLite), so a typical batch costs one
+     * round trip instead of one per row.
+     *
+     * With setUpdateOnDuplicate() the statement becomes an upsert (see SqlDialect::upsertClause()),
+     * which lets callers overwrite rows by primary or unique key and insert new ones in the
+     * same statement.
+     *
+     * @note The writer runs on the lease it was created with and does not start a transaction;
+     *       callers wrap flush() in ConnectionLease::transaction() when atomicity is needed.
+     */
+    class BulkInsertWriter
+    {
+    public:
+        /**
+         * @brief Creates a writer for @p table.
+         * @param lease Open connection lease; must outlive the writer.
+         * @param table Target table name.
+         * @param columns Column names, in the order values are passed to addRow().
+         */
+        BulkInsertWriter(ConnectionLease& lease, QString table, QStringList columns);
+
+        BulkInsertWriter(const BulkInsertWriter&) = delete;
+        BulkInsertWriter& operator=(const BulkInsertWriter&) = delete;
+
+        /**
+         * @brief Turns the INSERT into an upsert that overwrites @p columns on a key conflict.
+         *
+         * With a @p guardColumn the stored row is only overwritten when the new row's value of
+         * that column is greater (see SqlDialect::upsertIfGreaterClause()).
+         */
+        void setUpdateOnDuplicate(const QStringList& columns, const QString& guardColumn = QString());
+
+        /**
+         * @brief Records the AUTO_INCREMENT id generated for every row written.
+         *
+         * Ids of a multi-row INSERT are derived from the reported one when the server allocates
+         * them consecutively (innodb_autoinc_lock_mode <= 1, and always on SQLite, where the
+         * statement holds the write lock). Otherwise the writer falls back to one execution per
+         * row of a single cached statement to get exact ids.
+         */
+        void setCollectGeneratedIds(bool collect);
+
+        /**
+         * @brief Buffers one row. @p values must match the column list.
+         */
+        void addRow(const QVariantList& values);
+
+        /**
+         * @brief Returns the number of rows buffered and not yet written.
+         */
+        int pendingRowCount() const;
+
+        /**
+         * @brief Writes all buffered rows.
+         * @return True on success. On failure lastError() holds the driver error and the
+         *         remaining rows stay buffered.
+         */
+        bool flush();
+
+        /**
+         * @brief Returns the generated ids of all rows written so far, in insertion order.
+         */
+        QList<qint64> generatedIds() const;
+
+        /**
+         * @brief Returns the number of rows written so far.
+         */
+        int rowsWritten() const;
+
+        /**
+         * @brief Returns the number of statements executed so far.
+         */
+        int statementsExecuted() const;
+
+        /**
+         * @brief Returns the last driver error.
+         */
+        QString lastError() const;
+
+    private:
+        bool loadServerSettings();
+        qint64 estimateRowBytes(const QVariantList& row) const;
+        QString statementFor(int rowCount) const;
+        bool writeChunk(int begin, int end);
+        bool writeRowByRow(int begin, int end);
+
+        ConnectionLease& m_lease;
+        SqlDialect m_dialect;
+        QString m_table;
+        QStringList m_columns;
+        QStringList m_updateColumns;
+        QString m_updateGuardColumn;
+        bool m_collectIds = false;
+
+        QVector<QVariantList> m_rows;
+        QList<qint64> m_generatedIds;
+        int m_rowsWritten = 0;
+        int m_statementsExecuted = 0;
+        QString m_lastError;
+
+        bool m_settingsLoaded = false;
+        qint64 m_maxPacketBytes = 0;
+        bool m_consecutiveIds = false;
+        int m_autoIncrementStep = 1;
+    };
+
+} // namespace Etrek::Core::Repository
+
+#endif // BULKINSERTWRITER_H
@@ -0,0 +1,554 @@
+#include "DatabaseConnectionPool.h"
+#include <vector>
+#include <QDeadlineTimer>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QDebug>
+#include "MessageKey.h"
+#include "AppLoggerFactory.h"
+#include "SqlDialect.h"
+#include "QueryStatistics.h"
+
+namespace Etrek::Core::Repository {
+
+    using Etrek::Core::Data::Model::DatabaseConnectionSetting;
+    using Etrek::Core::Data::Model::StorageBackend;
+    using Etrek::Core::Globalization::TranslationProvider;
+    using Etrek::Core::Log::AppLoggerFactory;
+    using Etrek::Core::Log::LoggerProvider;
+
+    // ---------------------------------------------------------------------
+    // ConnectionLease
+    // ---------------------------------------------------------------------
+
+    ConnectionLease::ConnectionLease(DatabaseConnectionPool* pool, QString poolKey, QString connectionName, QString error)
+        : m_pool(pool)
+        , m_poolKey(std::move(poolKey))
+        , m_connectionName(std::move(connectionName))
+        , m_error(std::move(error))
+    {
+        if (!m_connectionName.isEmpty()) {
+            m_db = QSqlDatabase::database(m_connectionName, false);
+        }
+        if (m_pool && !m_connectionName.isEmpty()) {
+            m_statements = m_pool->statementCacheFor(m_connectionName);
+        }
+    }
+
+    ConnectionLease::~ConnectionLease()
+    {
+        release();
+    }
+
+    ConnectionLease::ConnectionLease(ConnectionLease&& other) noexcept
+        : m_pool(other.m_pool)
+        , m_poolKey(std::move(other.m_poolKey))
+        , m_connectionName(std::move(other.m_connectionName))
+        , m_error(std::move(other.m_error))
+        , m_db(std::move(other.m_db))
+        , m_inTransaction(other.m_inTransaction)
+        , m_statements(std::move(other.m_statements))
+        , m_adHocStatements(std::move(other.m_adHocStatements))
+    {
+        other.m_pool = nullptr;
+        other.m_connectionName.clear();
+        other.m_db = QSqlDatabase();
+        other.m_inTransaction = false;
+    }
+
+    ConnectionLease& ConnectionLease::operator=(ConnectionLease&& other) noexcept
+    {
+        if (this != &other) {
+            release();
+            m_pool = other.m_pool;
+            m_poolKey = std::move(other.m_poolKey);
+            m_connectionName = std::move(other.m_connectionName);
+            m_error = std::move(other.m_error);
+            m_db = std::move(other.m_db);
+            m_inTransaction = other.m_inTransaction;
+            m_statements = std::move(other.m_statements);
+            m_adHocStatements = std::move(other.m_adHocStatements);
+
+            other.m_pool = nullptr;
+            other.m_connectionName.clear();
+            other.m_db = QSqlDatabase();
+            other.m_inTransaction = false;
+        }
+        return *this;
+    }
+
+    bool ConnectionLease::isValid() const
+    {
+        return m_db.isValid() && m_db.isOpen();
+    }
+
+    QSqlDatabase& ConnectionLease::database()
+    {
+        return m_db;
+    }
+
+    QString ConnectionLease::lastError() const
+    {
+        if (!m_error.isEmpty())
+            return m_error;
+        return m_db.lastError().text();
+    }
+
+    QSqlQuery& ConnectionLease::prepare(const QString& sql)
+    {
+        if (m_statements && isValid()) {
+            if (QSqlQuery* cached = m_statements->acquire(sql))
+                return *cached;
+        }
+
+        // Cache disabled, the cached statement is still being read, or the statement failed to
+        // prepare: hand out a lease-owned query, which also reports the driver error.
+        m_adHocStatements.emplace_back(m_db);
+        m_adHocStatements.back().prepare(sql);
+        return m_adHocStatements.back();
+    }
+
+    bool ConnectionLease::transaction()
+    {
+        if (!isValid())
+            return false;
+
+        if (SqlDialect::of(m_db).isSqlite()) {
+            // Take the write lock up front: a deferred transaction that reads and then writes
+            // fails with SQLITE_BUSY when another connection wrote in between.
+            QSqlQuery begin(m_db);
+            m_inTransaction = begin.exec("BEGIN IMMEDIATE");
+            return m_inTransaction;
+        }
+
+        m_inTransaction = m_db.transaction();
+        return m_inTransaction;
+    }
+
+    bool ConnectionLease::commit()
+    {
+        const bool ok = m_db.commit();
+        if (ok)
+            m_inTransaction = false;
+        return ok;
+    }
+
+    bool ConnectionLease::rollback()
+    {
+        const bool ok = m_db.rollback();
+        m_inTransaction = false;
+        return ok;
+    }
+
+    void ConnectionLease::release()
+    {
+        m_adHocStatements.clear();
+        if (m_statements) {
+            m_statements->releasePinned();
+            m_statements.reset();
+        }
+        if (m_pool && !m_connectionName.isEmpty()) {
+            m_pool->release(*this);
+        }
+        m_pool = nullptr;
+        m_connectionName.clear();
+        m_db = QSqlDatabase();
+        m_inTransaction = false;
+    }
+
+    // ---------------------------------------------------------------------
+    // DatabaseConnectionPool
+    // ---------------------------------------------------------------------
+
+    DatabaseConnectionPool& DatabaseConnectionPool::Instance()
+    {
+        static DatabaseConnectionPool instance;
+        return instance;
+    }
+
+    DatabaseConnectionPool::DatabaseConnectionPool()
+    {
+        translator = &TranslationProvider::Instance();
+        AppLoggerFactory factory(LoggerProvider::Instance(), translator);
+        logger = factory.CreateLogger("DatabaseConnectionPool");
+        m_clock.start();
+    }
+
+    void DatabaseConnectionPool::setOptions(const Options& options)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_options = options;
+        if (m_options.maxSize < 1)
+            m_options.maxSize = 1;
+        if (m_options.minIdle < 0)
+            m_options.minIdle = 0;
+        m_slotFreed.wakeAll();
+    }
+
+    DatabaseConnectionPool::Options DatabaseConnectionPool::options() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_options;
+    }
+
+    QString DatabaseConnectionPool::poolKeyFor(const DatabaseConnectionSetting& setting)
+    {
+        return setting.connectionKey();
+    }
+
+    QSqlDatabase DatabaseConnectionPool::addConnection(const QString& connectionName, const DatabaseConnectionSetting& setting) const
+    {
+        if (setting.getStorageBackend() == StorageBackend::Sqlite) {
+            // The driver creates the file but not its directory
+            const QFileInfo file(setting.getDatabaseName());
+            QDir().mkpath(file.absolutePath());
+
+            QSqlDatabase db = QSqlDatabase::addDatabase(SqlDialect::driverName(StorageBackend::Sqlite), connectionName);
+            db.setDatabaseName(file.absoluteFilePath());
+            db.setConnectOptions(QString("QSQLITE_BUSY_TIMEOUT=%1").arg(SQLITE_BUSY_TIMEOUT_MS));
+            return db;
+        }
+
+        QSqlDatabase db = QSqlDatabase::addDatabase(SqlDialect::driverName(StorageBackend::MySql), connectionName);
+        db.setHostName(setting.getHostName());
+        db.setDatabaseName(setting.getDatabaseName());
+        db.setUserName(setting.getEtrekUserName());
+        db.setPassword(setting.getPassword());
+        db.setPort(setting.getPort());
+        return db;
+    }
+
+    bool DatabaseConnectionPool::openSession(QSqlDatabase& db) const
+    {
+        if (!db.open())
+            return false;
+        if (!SqlDialect::of(db).isSqlite())
+            return true;
+
+        // SQLite keeps these per connection. WAL lets the GUI read while a writer holds the lock.
+        QString error;
+        {
+            QSqlQuery pragma(db);
+            for (const char* statement : { "PRAGMA foreign_keys = ON", "PRAGMA journal_mode = WAL", "PRAGMA synchronous = NORMAL" }) {
+                if (!pragma.exec(statement)) {
+                    error = pragma.lastError().text();
+                    break;
+                }
+            }
+        }
+        if (error.isEmpty())
+            return true;
+
+        logger->LogError(translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(error));
+        db.close();
+        return false;
+    }
+
+    bool DatabaseConnectionPool::validate(QSqlDatabase& db) const
+    {
+        QSqlQuery ping(db);
+        return ping.exec("SELECT 1");
+    }
+
+    ConnectionLease DatabaseConnectionPool::acquire(const std::shared_ptr<DatabaseConnectionSetting>& setting)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        ConnectionLease lease = acquireConnection(setting);
+        QueryStatistics::Instance().recordAcquireWait(timer.nsecsElapsed());
+        return lease;
+    }
+
+    ConnectionLease DatabaseConnectionPool::acquireConnection(const std::shared_ptr<DatabaseConnectionSetting>& setting)
+    {
+        if (!setting) {
+            QString error = translator->getErrorMessage(DB_POOL_NO_CONNECTION_SETTING_ERROR);
+            logger->LogError(error);
+            return ConnectionLease(nullptr, QString(), QString(), error);
+        }
+
+        const QString poolKey = poolKeyFor(*setting);
+        QThread* thread = QThread::currentThread();
+        const BucketKey bucketKey(thread, poolKey);
+
+        closeReclaimed(thread);
+
+        QMutexLocker locker(&m_mutex);
+        const Options options = m_options;
+        watchThread(thread);
+
+        // Reuse the most recently returned connection of this thread first; it is the
+        // one least likely to have been dropped by the server.
+        while (!m_idle.value(bucketKey).isEmpty()) {
+            IdleConnection idle = m_idle[bucketKey].takeLast();
+            locker.unlock();
+
+            bool usable = false;
+            {
+                QSqlDatabase db = QSqlDatabase::database(idle.name, false);
+                usable = db.isValid() && db.isOpen();
+                if (usable && m_clock.elapsed() - idle.idleSinceMs >= options.healthCheckIntervalMs && !validate(db)) {
+                    if (auto statements = statementCacheFor(idle.name))
+                        statements->clear();
+                    db.close();
+                    usable = openSession(db);
+                    if (usable)
+                        logger->LogWarning(translator->getWarningMessage(DB_POOL_CONNECTION_REOPENED_WARNING).arg(idle.name));
+                }
+            }
+
+            if (usable)
+                return ConnectionLease(this, poolKey, idle.name, QString());
+
+            discard(poolKey, idle.name);
+            locker.relock();
+        }
+
+        QDeadlineTimer deadline(options.acquireTimeoutMs);
+        while (m_openCount.value(poolKey) >= options.maxSize) {
+            // Slots held by idle connections of other threads are taken over before waiting;
+            // otherwise they would only come free when their own thread releases again
+            if (reclaimIdleSlot(poolKey, thread))
+                continue;
+            if (!m_slotFreed.wait(&m_mutex, deadline)) {
+                QString error = translator->getErrorMessage(DB_POOL_ACQUIRE_TIMEOUT_ERROR)
+                    .arg(options.acquireTimeoutMs)
+                    .arg(m_openCount.value(poolKey));
+                locker.unlock();
+                logger->LogError(error);
+                return ConnectionLease(nullptr, QString(), QString(), error);
+            }
+        }
+
+        m_openCount[poolKey] += 1;
+        const QString connectionName = QString("etrek_pool_%1").arg(++m_sequence);
+        m_statementCaches.insert(connectionName,
+            std::make_shared<PreparedStatementCache>(connectionName, options.statementCacheCapacity));
+        locker.unlock();
+
+        // Opening is the expensive part; do it outside the lock. A failed connection is
+        // still handed out so callers can report the driver error, and is discarded on release.
+        {
+            QSqlDatabase db = addConnection(connectionName, *setting);
+            if (!openSession(db)) {
+                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+                logger->LogError(error);
+                qDebug() << error;
+            }
+        }
+
+        return ConnectionLease(this, poolKey, connectionName, QString());
+    }
+
+    int DatabaseConnectionPool::warmUp(const std::shared_ptr<DatabaseConnectionSetting>& setting, int count)
+    {
+        if (!setting || count <= 0)
+            return 0;
+
+        {
+            std::vector<ConnectionLease> leases;
+            leases.reserve(static_cast<size_t>(count));
+            for (int i = 0; i < count; ++i) {
+                ConnectionLease lease = acquire(setting);
+                if (!lease.isValid())
+                    break;
+                leases.push_back(std::move(lease));
+            }
+        }
+
+        QMutexLocker locker(&m_mutex);
+        return m_idle.value(BucketKey(QThread::currentThread(), poolKeyFor(*setting))).size();
+    }
+
+    void DatabaseConnectionPool::release(ConnectionLease& lease)
+    {
+        const QString poolKey = lease.m_poolKey;
+        const QString connectionName = lease.m_connectionName;
+
+        if (lease.m_inTransaction) {
+            lease.m_db.rollback();
+            lease.m_inTransaction = false;
+            logger->LogWarning(translator->getWarningMessage(DB_POOL_UNFINISHED_TRANSACTION_WARNING).arg(connectionName));
+        }
+
+        const bool reusable = lease.m_db.isValid() && lease.m_db.isOpen();
+        lease.m_db = QSqlDatabase();
+
+        if (!reusable) {
+            discard(poolKey, connectionName);
+            return;
+        }
+
+        QThread* thread = QThread::currentThread();
+        closeReclaimed(thread);
+
+        QStringList evicted;
+        {
+            QMutexLocker locker(&m_mutex);
+            if (!m_watchedThreads.contains(thread)) {
+                // The owning thread has already been drained; do not re-populate its bucket.
+                locker.unlock();
+                discard(poolKey, connectionName);
+                return;
+            }
+
+            const qint64 now = m_clock.elapsed();
+            auto& bucket = m_idle[BucketKey(thread, poolKey)];
+            bucket.append(IdleConnection{ connectionName, now });
+            evicted = evictIdle(bucket, now);
+        }
+
+        for (const QString& name : evicted)
+            discard(poolKey, name);
+    }
+
+    QStringList DatabaseConnectionPool::evictIdle(QVector<IdleConnection>& bucket, qint64 nowMs) const
+    {
+        // Buckets are ordered oldest first, so expired entries are at the front.
+        QStringList evicted;
+        while (bucket.size() > m_options.minIdle
+            && nowMs - bucket.first().idleSinceMs >= m_options.idleTimeoutMs) {
+            evicted.append(bucket.takeFirst().name);
+        }
+        return evicted;
+    }
+
+    bool DatabaseConnectionPool::reclaimIdleSlot(const QString& poolKey, QThread* thread)
+    {
+        // The connection idle for longest on any other thread gives up its slot
+        auto oldest = m_idle.end();
+        for (auto it = m_idle.begin(); it != m_idle.end(); ++it) {
+            if (it.key().first == thread || it.key().second != poolKey || it.value().isEmpty())
+                continue;
+            if (oldest == m_idle.end() || it.value().first().idleSinceMs < oldest.value().first().idleSinceMs)
+                oldest = it;
+        }
+        if (oldest == m_idle.end())
+            return false;
+
+        // Only its own thread may close it; that happens the next time the thread uses the pool
+        m_reclaimed[oldest.key().first].append({ poolKey, oldest.value().takeFirst().name });
+        m_openCount[poolKey] -= 1;
+        return true;
+    }
+
+    void DatabaseConnectionPool::closeReclaimed(QThread* thread)
+    {
+        QVector<QPair<QString, QString>> reclaimed;
+        {
+            QMutexLocker locker(&m_mutex);
+            reclaimed = m_reclaimed.take(thread);
+        }
+
+        for (const auto& entry : reclaimed)
+            discard(entry.first, entry.second, false);
+    }
+
+    void DatabaseConnectionPool::discard(const QString& poolKey, const QString& connectionName, bool freeSlot)
+    {
+        // Prepared statements must be destroyed before the connection they belong to.
+        std::shared_ptr<PreparedStatementCache> statements;
+        {
+            QMutexLocker locker(&m_mutex);
+            statements = m_statementCaches.take(connectionName);
+            if (statements) {
+                const auto stats = statements->stats();
+                m_retiredStatementStats.hits += stats.hits;
+                m_retiredStatementStats.misses += stats.misses;
+                m_retiredStatementStats.evictions += stats.evictions;
+            }
+        }
+        statements.reset();
+
+        {
+            QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+            if (db.isOpen())
+                db.close();
+        }
+        QSqlDatabase::removeDatabase(connectionName);
+
+        if (!freeSlot)
+            return;
+
+        QMutexLocker locker(&m_mutex);
+        if (m_openCount.value(poolKey) > 0)
+            m_openCount[poolKey] -= 1;
+        m_slotFreed.wakeAll();
+    }
+
+    void DatabaseConnectionPool::watchThread(QThread* thread)
+    {
+        if (m_watchedThreads.contains(thread))
+            return;
+
+        m_watchedThreads.insert(thread);
+
+        // finished() is emitted from the ending thread itself, which is the only thread
+        // allowed to close its connections.
+        QObject::connect(thread, &QThread::finished, thread, [this, thread]() {
+            drainThread(thread);
+        }, Qt::DirectConnection);
+    }
+
+    void DatabaseConnectionPool::drainThread(QThread* thread)
+    {
+        QVector<QPair<QString, QString>> toClose;
+        {
+            QMutexLocker locker(&m_mutex);
+            for (auto it = m_idle.begin(); it != m_idle.end();) {
+                if (it.key().first == thread) {
+                    for (const auto& idle : it.value())
+                        toClose.append({ it.key().second, idle.name });
+                    it = m_idle.erase(it);
+                }
+                else {
+                    ++it;
+                }
+            }
+            m_watchedThreads.remove(thread);
+        }
+
+        for (const auto& entry : toClose)
+            discard(entry.first, entry.second);
+        closeReclaimed(thread);
+
+        if (!toClose.isEmpty())
+            logger->LogDebug(translator->getDebugMessage(DB_POOL_THREAD_DRAINED_DEBUG).arg(toClose.size()));
+    }
+
+    void DatabaseConnectionPool::shutdown()
+    {
+        const auto stats = statementCacheStats();
+        logger->LogDebug(translator->getDebugMessage(DB_POOL_STATEMENT_CACHE_STATS_DEBUG)
+            .arg(stats.hits)
+            .arg(stats.misses)
+            .arg(stats.evictions)
+            .arg(stats.size));
+
+        drainThread(QThread::currentThread());
+    }
+
+    std::shared_ptr<PreparedStatementCache> DatabaseConnectionPool::statementCacheFor(const QString& connectionName) const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_statementCaches.value(connectionName);
+    }
+
+    PreparedStatementCache::Stats DatabaseConnectionPool::statementCacheStats() const
+    {
+        QMutexLocker locker(&m_mutex);
+        PreparedStatementCache::Stats total = m_retiredStatementStats;
+        for (const auto& cache : m_statementCaches) {
+            const auto stats = cache->stats();
+            total.hits += stats.hits;
+            total.misses += stats.misses;
+            total.evictions += stats.evictions;
+            total.size += stats.size;
+        }
+        return total;
+    }
+
+} // namespace Etrek::Core::Repository
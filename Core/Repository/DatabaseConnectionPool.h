@@ -0,0 +1,246 @@
+#ifndef DATABASECONNECTIONPOOL_H
+#define DATABASECONNECTIONPOOL_H
+
+#include <list>
+#include <memory>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QSet>
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+#include "DatabaseConnectionSetting.h"
+#include "PreparedStatementCache.h"
+#include "TranslationProvider.h"
+#include "AppLogger.h"
+
+namespace Etrek::Core::Repository {
+
+    class DatabaseConnectionPool;
+
+    /**
+     * @class ConnectionLease
+     * @brief RAII handle to a pooled database connection.
+     *
+     * A lease is obtained from DatabaseConnectionPool::acquire() and gives exclusive
+     * use of one open QSqlDatabase to the calling thread for the lifetime of the lease.
+     * The connection is handed back to the pool when the lease is destroyed. A transaction
+     * started through the lease and not finished is rolled back before the connection
+     * is reused. Statements obtained with prepare() come from the connection's
+     * PreparedStatementCache and stay valid until the lease is released.
+     *
+     * @note Leases are thread-bound, as QSqlDatabase connections are. Never pass a lease
+     *       to another thread.
+     */
+    class ConnectionLease
+    {
+    public:
+        ConnectionLease() = default;
+        ~ConnectionLease();
+
+        ConnectionLease(const ConnectionLease&) = delete;
+        ConnectionLease& operator=(const ConnectionLease&) = delete;
+        ConnectionLease(ConnectionLease&& other) noexcept;
+        ConnectionLease& operator=(ConnectionLease&& other) noexcept;
+
+        /**
+         * @brief Returns true when the lease holds an open connection.
+         */
+        bool isValid() const;
+
+        /**
+         * @brief Returns the leased connection. Check isValid() / isOpen() before use.
+         */
+        QSqlDatabase& database();
+
+        /**
+         * @brief Returns the reason the lease could not be opened, or the last driver error.
+         */
+        QString lastError() const;
+
+        /**
+         * @brief Returns a statement prepared for @p sql on the leased connection.
+         *
+         * Hot statements are prepared once per pooled connection and reused by later leases;
+         * callers only bind values and execute. Use it for fixed SQL text; statements built
+         * with a variable number of placeholders should use a plain QSqlQuery instead.
+         * Preparing the same SQL again while the rows of its SELECT are still being read
+         * returns a separate query and leaves the first one untouched.
+         *
+         * @param sql SQL text with named or positional placeholders.
+         * @return A prepared query owned by the lease or the cache. Check lastError() on failure.
+         */
+        QSqlQuery& prepare(const QString& sql);
+
+        /**
+         * @brief Starts a transaction on the leased connection.
+         *
+         * On SQLite the transaction takes the database write lock immediately (BEGIN IMMEDIATE),
+         * which stands in for the row locks MySQL takes with SELECT ... FOR UPDATE.
+         * @return True if the driver accepted the transaction.
+         */
+        bool transaction();
+
+        /**
+         * @brief Commits the transaction started with transaction().
+         * @return True on success.
+         */
+        bool commit();
+
+        /**
+         * @brief Rolls back the transaction started with transaction().
+         * @return True on success.
+         */
+        bool rollback();
+
+        /**
+         * @brief Returns the connection back to the pool before the lease goes out of scope.
+         */
+        void release();
+
+    private:
+        friend class DatabaseConnectionPool;
+
+        ConnectionLease(DatabaseConnectionPool* pool, QString poolKey, QString connectionName, QString error);
+
+        DatabaseConnectionPool* m_pool = nullptr;
+        QString m_poolKey;
+        QString m_connectionName;
+        QString m_error;
+        QSqlDatabase m_db;
+        bool m_inTransaction = false;
+        std::shared_ptr<PreparedStatementCache> m_statements;
+        std::list<QSqlQuery> m_adHocStatements;
+    };
+
+    /**
+     * @class DatabaseConnectionPool
+     * @brief Process-wide pool of database connections shared by all repositories.
+     *
+     * Repositories used to register, open and remove a uniquely named QSqlDatabase for
+     * every call. The pool keeps opened connections alive instead and hands them out as
+     * ConnectionLease objects. Because Qt connections may only be used from the thread
+     * that created them, idle connections are kept per thread and per connection setting;
+     * the overall number of open connections per setting is bounded by Options::maxSize.
+     * When acquire() finds the limit reached it first takes over the slot of the connection
+     * idle for longest on another thread, and only waits when no thread has one idle. The
+     * connection itself is closed by its own thread the next time that thread uses the pool
+     * or when it finishes.
+     *
+     * Idle connections are validated with a cheap round trip when they have not been used
+     * for Options::healthCheckIntervalMs and are reopened transparently when the server has
+     * dropped them. Connections idle for longer than Options::idleTimeoutMs are closed, keeping
+     * at least Options::minIdle per thread. All connections of a thread are removed when that
+     * thread finishes.
+     *
+     * Connections use the backend of their setting. SQLite connections are opened with
+     * foreign keys enabled, WAL journaling and a busy timeout, so several threads can share
+     * one database file.
+     */
+    class DatabaseConnectionPool
+    {
+    public:
+        /**
+         * @brief Pool sizing and maintenance parameters.
+         */
+        struct Options {
+            int minIdle = 1;                    ///< Idle connections kept per thread after eviction.
+            int maxSize = 16;                   ///< Maximum open connections per setting, all threads together.
+            int idleTimeoutMs = 5 * 60 * 1000;  ///< Idle time after which a connection is closed.
+            int healthCheckIntervalMs = 30 * 1000; ///< Idle time after which a connection is validated before reuse.
+            int acquireTimeoutMs = 10 * 1000;   ///< Maximum time acquire() waits for a free slot.
+            int statementCacheCapacity = 64;    ///< Prepared statements kept per connection; 0 disables the cache.
+        };
+
+        /**
+         * @brief Returns the singleton instance of DatabaseConnectionPool.
+         */
+        static DatabaseConnectionPool& Instance();
+
+        /**
+         * @brief Replaces the pool options. Applies to subsequent acquire/release calls.
+         */
+        void setOptions(const Options& options);
+
+        /**
+         * @brief Returns the current pool options.
+         */
+        Options options() const;
+
+        /**
+         * @brief Leases an open connection for the given setting on the calling thread.
+         * @param setting Connection parameters; connections are pooled per DatabaseConnectionSetting::connectionKey().
+         * @return A lease; check ConnectionLease::isValid() before using it.
+         */
+        ConnectionLease acquire(const std::shared_ptr<Etrek::Core::Data::Model::DatabaseConnectionSetting>& setting);
+
+        /**
+         * @brief Opens up to @p count idle connections on the calling thread ahead of first use.
+         * @return Number of idle connections available on this thread afterwards.
+         */
+        int warmUp(const std::shared_ptr<Etrek::Core::Data::Model::DatabaseConnectionSetting>& setting, int count);
+
+        /**
+         * @brief Closes and removes all idle connections owned by the calling thread.
+         */
+        void shutdown();
+
+        /**
+         * @brief Returns the prepared-statement cache counters summed over all open connections.
+         */
+        PreparedStatementCache::Stats statementCacheStats() const;
+
+    private:
+        friend class ConnectionLease;
+
+        struct IdleConnection {
+            QString name;
+            qint64 idleSinceMs = 0;
+        };
+
+        using BucketKey = QPair<QThread*, QString>;
+
+        // Time a SQLite statement waits for another connection's write lock.
+        static constexpr int SQLITE_BUSY_TIMEOUT_MS = 5000;
+
+        DatabaseConnectionPool();
+
+        ConnectionLease acquireConnection(const std::shared_ptr<Etrek::Core::Data::Model::DatabaseConnectionSetting>& setting);
+        static QString poolKeyFor(const Etrek::Core::Data::Model::DatabaseConnectionSetting& setting);
+        QSqlDatabase addConnection(const QString& connectionName,
+            const Etrek::Core::Data::Model::DatabaseConnectionSetting& setting) const;
+        bool openSession(QSqlDatabase& db) const;
+        bool validate(QSqlDatabase& db) const;
+        void release(ConnectionLease& lease);
+        void discard(const QString& poolKey, const QString& connectionName, bool freeSlot = true);
+        bool reclaimIdleSlot(const QString& poolKey, QThread* thread);
+        void closeReclaimed(QThread* thread);
+        QStringList evictIdle(QVector<IdleConnection>& bucket, qint64 nowMs) const;
+        void watchThread(QThread* thread);
+        void drainThread(QThread* thread);
+        std::shared_ptr<PreparedStatementCache> statementCacheFor(const QString& connectionName) const;
+
+        mutable QMutex m_mutex;
+        QWaitCondition m_slotFreed;
+        Options m_options;
+        QHash<BucketKey, QVector<IdleConnection>> m_idle;
+        QHash<QString, int> m_openCount;
+        QHash<QString, std::shared_ptr<PreparedStatementCache>> m_statementCaches;
+        PreparedStatementCache::Stats m_retiredStatementStats;
+        QHash<QThread*, QVector<QPair<QString, QString>>> m_reclaimed;  // (pool key, name) whose slot was taken over, closed by their thread
+        QSet<QThread*> m_watchedThreads;
+        quint64 m_sequence = 0;
+        QElapsedTimer m_clock;
+
+        Etrek::Core::Globalization::TranslationProvider* translator;
+        std::shared_ptr<Etrek::Core::Log::AppLogger> logger;
+    };
+
+} // namespace Etrek::Core::Repository
+
+#endif // DATABASECONNECTIONPOOL_H
@@ -4,15 +4,23 @@
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QSet>
 #include <QTextStream>
 #include <QDebug>
 #include "MessageKey.h"
 #include "AppLoggerFactory.h"
+#include "SchemaMigrationRunner.h"
+#include "SeedDataLoader.h"
+#include "SqlScriptParser.h"
+#include "SqlDialect.h"
 
 namespace Etrek::Core::Repository {
 
     using Etrek::Specification::Result;
     using Etrek::Core::Data::Model::DatabaseConnectionSetting;
+    using Etrek::Core::Data::Model::StorageBackend;
 	using Etrek::Core::Globalization::TranslationProvider;
 	using Etrek::Core::Log::AppLoggerFactory;
 	using Etrek::Core::Log::LoggerProvider;
@@ -28,6 +36,8 @@ namespace Etrek::Core::Repository {
 
     Result<QString> DatabaseSetupManager::initializeDatabase(std::unique_ptr<QFile> setupScript)
     {
+        if (m_connectionSetting->getStorageBackend() == StorageBackend::Sqlite)
+            return initializeSqliteStore(std::move(setupScript));
 
         if (!createDatabaseIfMissing())
         {
@@ -43,7 +53,7 @@ namespace Etrek::Core::Repository {
             return Result<QString>::Failure(errMsg);
         }
 
-        QSqlQuery checkQuery("SHOW TABLES", db);
+        QSqlQuery checkQuery(SqlDialect::of(db).listTablesStatement(), db);
         if (!checkQuery.next()) {
             QString message = translator->getErrorMessage(SQL_SCRIPT_NO_TABLES_FOUND_MSG);
             logger->LogInfo(message);
@@ -55,6 +65,50 @@ namespace Etrek::Core::Repository {
             }
         }
 
+        auto upgradeResult = applyMigrations(db);
+        if (!upgradeResult.isSuccess)
+        {
+            logger->LogError(upgradeResult.message);
+            return Result<QString>::Failure(upgradeResult.message);
+        }
+
+        QString message =translator->getInfoMessage(DB_INIT_SUCCESS_MSG);
+        logger->LogInfo(message);
+        return Result<QString>::Success(message);
+    }
+
+    Result<QString> DatabaseSetupManager::initializeSqliteStore(std::unique_ptr<QFile> setupScript)
+    {
+        const QString path = QFileInfo(m_connectionSetting->getDatabaseName()).absoluteFilePath();
+        QDir().mkpath(QFileInfo(path).absolutePath());
+
+        QSqlDatabase db = createConnection(path, "etrek_store_connection");
+        if (!db.open()) {
+            QString errMsg = QString(translator->getErrorMessage(DB_FAILED_TO_OPEN_AFTER_CREATION_MSG)).arg(db.lastError().text());
+            logger->LogError(errMsg);
+            return Result<QString>::Failure(errMsg);
+        }
+
+        // The store is created in one go and has no migrations; an existing file is used as is
+        QSqlQuery checkQuery(SqlDialect::of(db).listTablesStatement(), db);
+        if (!checkQuery.next()) {
+            checkQuery.finish();
+            QString message = translator->getErrorMessage(SQL_SCRIPT_NO_TABLES_FOUND_MSG);
+            logger->LogInfo(message);
+
+            if (!setupScript)
+                setupScript = std::make_unique<QFile>(":/sql/Script/sqlite_store.sql");
+
+            auto scriptResult = runSetupScript(db, std::move(setupScript));
+            if (scriptResult.isSuccess)
+                scriptResult = seedSqliteStore(db);
+            if (!scriptResult.isSuccess)
+            {
+                logger->LogError(scriptResult.message);
+                return Result<QString>::Failure(scriptResult.message);
+            }
+        }
+
         QString message =translator->getInfoMessage(DB_INIT_SUCCESS_MSG);
         logger->LogInfo(message);
         return Result<QString>::Success(message);
@@ -104,11 +158,25 @@ namespace Etrek::Core::Repository {
         return true;
     }
 
+    Result<QString> DatabaseSetupManager::applyMigrations(QSqlDatabase& db)
+    {
+        SchemaMigrationRunner runner(db);
+        auto migrationResult = runner.run();
+        if (!migrationResult.isSuccess)
+            return Result<QString>::Failure(migrationResult.message);
+
+        return Result<QString>::Success(QString());
+    }
+
     QSqlDatabase DatabaseSetupManager::createConnection(const QString& dbName, const QString& connectionName)
     {
-        QSqlDatabase db = QSqlDatabase::addDatabase("QMYSQL", connectionName);
-        db.setHostName(m_connectionSetting->getHostName());
+        const StorageBackend backend = m_connectionSetting->getStorageBackend();
+        QSqlDatabase db = QSqlDatabase::addDatabase(SqlDialect::driverName(backend), connectionName);
         db.setDatabaseName(dbName);
+        if (backend == StorageBackend::Sqlite)
+            return db;
+
+        db.setHostName(m_connectionSetting->getHostName());
         db.setUserName(m_connectionSetting->getEtrekUserName());
         db.setPassword(m_connectionSetting->getPassword());
         int port = m_connectionSetting->getPort();
@@ -130,19 +198,35 @@ namespace Etrek::Core::Repository {
         }
 
         QTextStream stream(setupScript.get());
-        QString sql = stream.readAll();
-        const QStringList& commands = sql.split(';', Qt::SkipEmptyParts);
-
-        for (const QString& command : commands) {
-            QString trimmed = command.trimmed();
-            if (!trimmed.isEmpty()) {
-                QSqlQuery q(db);
-                if (!q.exec(trimmed)) {
-                    QString message = QString(translator->getErrorMessage(SQL_SCRIPT_EXECUTION_FAILED_ERROR_MSG)).arg(trimmed, q.lastError().text());
-                    qDebug() << message;
-                    logger->LogError(message);
-                    return Result<QString>::Failure(message);
-                }
+        const QStringList statements = SqlScriptParser::splitStatements(stream.readAll());
+
+        // Schema statements run one by one; each run of INSERTs is handed to the seed loader,
+        // which loads it as batched multi-row statements in a single transaction.
+        SeedDataLoader seedLoader(db);
+        QStringList seedStatements;
+
+        for (int i = 0; i <= statements.size(); ++i) {
+            if (i < statements.size() && !SqlScriptParser::insertTable(statements[i]).isEmpty()) {
+                seedStatements << statements[i];
+                continue;
+            }
+
+            if (!seedStatements.isEmpty()) {
+                auto seedResult = seedLoader.load(seedStatements);
+                if (!seedResult.isSuccess)
+                    return Result<QString>::Failure(seedResult.message);
+                seedStatements.clear();
+            }
+
+            if (i == statements.size())
+                break;
+
+            QSqlQuery q(db);
+            if (!q.exec(statements[i])) {
+                QString message = QString(translator->getErrorMessage(SQL_SCRIPT_EXECUTION_FAILED_ERROR_MSG)).arg(statements[i], q.lastError().text());
+                qDebug() << message;
+                logger->LogError(message);
+                return Result<QString>::Failure(message);
             }
         }
 
@@ -150,4 +234,36 @@ namespace Etrek::Core::Repository {
         logger->LogInfo(message);
         return Result<QString>::Success(message);
     }
+
+    Result<QString> DatabaseSetupManager::seedSqliteStore(QSqlDatabase& db)
+    {
+        QFile seedScript(":/sql/Script/setup_database.sql");
+        if (!seedScript.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            QString message = QString(translator->getErrorMessage(SQL_SCRIPT_FAILED_TO_OPEN_MSG)).arg(seedScript.fileName());
+            logger->LogError(message);
+            return Result<QString>::Failure(message);
+        }
+
+        QSet<QString> storeTables;
+        {
+            QSqlQuery tables(SqlDialect::of(db).listTablesStatement(), db);
+            while (tables.next())
+                storeTables.insert(tables.value(0).toString());
+        }
+
+        // Same seed data as the MySQL database, limited to the tables the store has
+        QTextStream stream(&seedScript);
+        QStringList seedStatements;
+        for (const QString& statement : SqlScriptParser::splitStatements(stream.readAll())) {
+            if (storeTables.contains(SqlScriptParser::insertTable(statement)))
+                seedStatements << statement;
+        }
+
+        SeedDataLoader seedLoader(db);
+        auto seedResult = seedLoader.load(seedStatements);
+        if (!seedResult.isSuccess)
+            return Result<QString>::Failure(seedResult.message);
+
+        return Result<QString>::Success(QString());
+    }
 }
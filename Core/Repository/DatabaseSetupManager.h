@@ -18,6 +18,10 @@ namespace Etrek::Core::Repository {
      * This class is responsible for creating the database if it does not exist,
      * running the setup script to initialize the database schema, and providing
      * methods to handle database setup operations.
+     *
+     * For the SQLite backend the database name is the path of the store file. A new store
+     * is created from sqlite_store.sql and seeded with the rows of setup_database.sql that
+     * belong to its tables.
      */
     class DatabaseSetupManager
     {
@@ -44,6 +48,20 @@ namespace Etrek::Core::Repository {
         Etrek::Specification::Result<QString> initializeDatabase(const QString& setupScriptPath);
 
     private:
+        /**
+         * @brief Creates and seeds the SQLite store file if it has no tables yet.
+         * @param setupScript Schema script; if nullptr, the sqlite_store.sql resource is used.
+         * @return Result containing a success or error message.
+         */
+        Etrek::Specification::Result<QString> initializeSqliteStore(std::unique_ptr<QFile> setupScript);
+
+        /**
+         * @brief Loads the seed INSERTs of setup_database.sql that target tables of the SQLite store.
+         * @param db Reference to an open connection to the store.
+         * @return Result containing a success or error message.
+         */
+        Etrek::Specification::Result<QString> seedSqliteStore(QSqlDatabase& db);
+
         /**
          * @brief Creates the database if it does not already exist.
          * @return True if the database exists or was created successfully, false otherwise.
@@ -52,6 +70,9 @@ namespace Etrek::Core::Repository {
 
         /**
          * @brief Executes the setup script to initialize the database schema.
+         *
+         * Schema statements are executed one by one; the seed data INSERTs are loaded through
+         * SeedDataLoader, which batches them into one transaction and logs the time per table.
          * @param db Reference to an open QSqlDatabase connection.
          * @param setupScript Unique pointer to a QFile containing the SQL setup script.
          *        If nullptr, a default resource script will be used.
@@ -59,9 +80,19 @@ namespace Etrek::Core::Repository {
          */
         Etrek::Specification::Result<QString> runSetupScript(QSqlDatabase& db, std::unique_ptr<QFile> setupScript = nullptr);
 
+        /**
+         * @brief Brings the schema of an existing database up to date with the setup script.
+         *
+         * Runs the pending versioned migrations (see SchemaMigrationRunner). Once every
+         * migration is recorded in schema_migrations this costs a single lookup.
+         * @param db Reference to an open QSqlDatabase connection.
+         * @return Result containing a success or error message.
+         */
+        Etrek::Specification::Result<QString> applyMigrations(QSqlDatabase& db);
+
         /**
          * @brief Creates a new database connection with the specified database and connection name.
-         * @param dbName The name of the database to connect to.
+         * @param dbName The name of the database to connect to (the file path for SQLite).
          * @param connectionName The name for the database connection.
          * @return The QSqlDatabase object for the connection.
          */
@@ -0,0 +1,164 @@
+#include "JournalApplier.h"
+#include <QElapsedTimer>
+#include <QSqlError>
+#include <QSqlQuery>
+#include "QueryStatistics.h"
+#include "MessageKey.h"
+#include "AppLoggerFactory.h"
+
+namespace Etrek::Core::Repository {
+
+    using Etrek::Specification::Result;
+    using Etrek::Core::Globalization::TranslationProvider;
+    using Etrek::Core::Log::AppLoggerFactory;
+    using Etrek::Core::Log::LoggerProvider;
+
+    namespace {
+        constexpr int READ_BATCH_SIZE = 256;
+        constexpr int FIRST_RETRY_DELAY_MS = 1000;
+        constexpr int MAX_RETRY_DELAY_MS = 60 * 1000;
+    }
+
+    JournalApplier::JournalApplier(std::shared_ptr<WriteJournal> journal, QObject* parent)
+        : QObject(parent)
+        , m_journal(std::move(journal))
+    {
+        translator = &TranslationProvider::Instance();
+        AppLoggerFactory factory(LoggerProvider::Instance(), translator);
+        logger = factory.CreateLogger("JournalApplier");
+    }
+
+    void JournalApplier::registerHandler(const QString& kind, Handler handler)
+    {
+        m_handlers.insert(kind, std::move(handler));
+    }
+
+    void JournalApplier::setCheckpointInterval(int records)
+    {
+        m_checkpointInterval = qMax(1, records);
+    }
+
+    void JournalApplier::applyNow()
+    {
+        m_journal->syncIfDue();
+
+        if (m_nextAttempt.isValid() && QDateTime::currentDateTime() < m_nextAttempt)
+            return;
+
+        auto result = applyPending();
+        if (!result.isSuccess) {
+            m_retryDelayMs = m_retryDelayMs == 0 ? FIRST_RETRY_DELAY_MS : qMin(2 * m_retryDelayMs, MAX_RETRY_DELAY_MS);
+            m_nextAttempt = QDateTime::currentDateTime().addMSecs(m_retryDelayMs);
+            emit applyFailed(result.message);
+            return;
+        }
+
+        m_retryDelayMs = 0;
+        m_nextAttempt = QDateTime();
+        if (result.value > 0)
+            emit applied(result.value);
+    }
+
+    Result<int> JournalApplier::applyPending(int maxRecords)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        QString journalId = m_journal->journalId();
+        qint64 applied = m_journal->appliedSequence();
+        int handled = 0;
+        int skipped = 0;
+        int rejected = 0;
+        int sinceCheckpoint = 0;
+
+        // A checkpoint that compacts the journal starts a new journal id
+        auto checkpoint = [&]() {
+            sinceCheckpoint = 0;
+            auto saved = m_journal->markApplied(applied);
+            journalId = m_journal->journalId();
+            return saved;
+        };
+
+        while (maxRecords < 0 || handled < maxRecords) {
+            const int wanted = maxRecords < 0 ? READ_BATCH_SIZE : qMin(READ_BATCH_SIZE, maxRecords - handled);
+            auto batch = m_journal->readAfter(applied, wanted);
+            if (!batch.isSuccess)
+                return Result<int>::Failure(batch.message);
+            if (batch.value.isEmpty())
+                break;
+
+            for (const JournalRecord& record : batch.value) {
+                auto handler = m_handlers.constFind(record.Kind);
+                auto result = handler != m_handlers.constEnd()
+                    ? handler.value()({ journalId, record.Sequence }, record.Payload)
+                    : Result<JournalApplyOutcome>::Success(JournalApplyOutcome::Rejected,
+                        QString("no handler for '%1'").arg(record.Kind));
+
+                if (!result.isSuccess) {
+                    const QString error = translator->getErrorMessage(JOURNAL_APPLY_FAILED_ERROR)
+                        .arg(record.Sequence).arg(record.Kind, result.message);
+                    logger->LogError(error);
+                    checkpoint();
+                    return Result<int>::Failure(error);
+                }
+
+                if (result.value == JournalApplyOutcome::Rejected) {
+                    auto kept = m_journal->reject(record, result.message);
+                    if (!kept.isSuccess) {
+                        checkpoint();
+                        return Result<int>::Failure(kept.message);
+                    }
+                    logger->LogError(translator->getErrorMessage(JOURNAL_RECORD_REJECTED_ERROR)
+                        .arg(record.Sequence).arg(record.Kind, m_journal->rejectedFilePath(), result.message));
+                    ++rejected;
+                }
+                else if (result.value == JournalApplyOutcome::AlreadyApplied) {
+                    ++skipped;
+                }
+
+                applied = record.Sequence;
+                ++handled;
+                if (++sinceCheckpoint >= m_checkpointInterval) {
+                    auto saved = checkpoint();
+                    if (!saved.isSuccess)
+                        return Result<int>::Failure(saved.message);
+                }
+            }
+        }
+
+        // Caught up: checkpoint, which also compacts the journal
+        if (applied == m_journal->lastSequence() && sinceCheckpoint > 0) {
+            auto saved = checkpoint();
+            if (!saved.isSuccess)
+                return Result<int>::Failure(saved.message);
+        }
+
+        if (handled > 0)
+            logger->LogInfo(translator->getInfoMessage(JOURNAL_APPLIED_MSG)
+                .arg(handled).arg(skipped).arg(rejected).arg(timer.elapsed()));
+        return Result<int>::Success(handled);
+    }
+
+    Result<bool> JournalApplier::claimEntry(ConnectionLease& lease, const JournalEntryKey& key)
+    {
+        QSqlQuery& find = lease.prepare("SELECT COUNT(*) FROM journal_applied_entries WHERE journal_id = ? AND sequence = ?");
+        find.addBindValue(key.JournalId);
+        find.addBindValue(key.Sequence);
+        if (!QueryStatistics::exec(find) || !find.next())
+            return Result<bool>::Failure(QString("Failed to read applied journal entries: %1").arg(find.lastError().text()));
+        const bool appliedBefore = find.value(0).toInt() > 0;
+        find.finish();
+        if (appliedBefore)
+            return Result<bool>::Success(false);
+
+        // A concurrent applier that claimed the key first makes this insert fail; the record is
+        // retried and then found above.
+        QSqlQuery& insert = lease.prepare("INSERT INTO journal_applied_entries (journal_id, sequence) VALUES (?, ?)");
+        insert.addBindValue(key.JournalId);
+        insert.addBindValue(key.Sequence);
+        if (!QueryStatistics::exec(insert))
+            return Result<bool>::Failure(QString("Failed to record applied journal entry: %1").arg(insert.lastError().text()));
+        return Result<bool>::Success(true);
+    }
+
+} // namespace Etrek::Core::Repository
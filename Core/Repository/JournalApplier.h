@@ -0,0 +1,122 @@
+#ifndef JOURNALAPPLIER_H
+#define JOURNALAPPLIER_H
+
+#include <functional>
+#include <memory>
+#include <QDateTime>
+#include <QHash>
+#include <QJsonObject>
+#include <QObject>
+#include <QString>
+#include "Result.h"
+#include "DatabaseConnectionPool.h"
+#include "WriteJournal.h"
+#include "TranslationProvider.h"
+#include "AppLogger.h"
+
+namespace Etrek::Core::Repository {
+
+    /**
+     * @brief Identifies one journal record in journal_applied_entries.
+     */
+    struct JournalEntryKey {
+        QString JournalId;
+        qint64 Sequence = 0;
+    };
+
+    /**
+     * @brief What a JournalApplier handler did with a record.
+     */
+    enum class JournalApplyOutcome {
+        Applied,        ///< Written
+        AlreadyApplied, ///< The key was claimed before; nothing written
+        Rejected        ///< Can never be written (e.g. a disallowed transition); nothing written
+    };
+
+    /**
+     * @class JournalApplier
+     * @brief Replays the records of a WriteJournal into the repositories.
+     *
+     * Each record kind has a handler, registered by the module that owns the repository. A
+     * handler writes the record and, in the same transaction, claims its key in
+     * journal_applied_entries with claimEntry(); a record whose key is already there was
+     * applied before and is skipped. Together with the checkpoint of the journal this makes
+     * every record take effect exactly once, even when the application stops between the
+     * database commit and the checkpoint.
+     *
+     * Records are applied in order. A handler failure is taken as transient (e.g. the
+     * connection was lost): the records before it are checkpointed and the run stops; applyNow()
+     * retries after a delay that doubles with every failure, from one second up to a minute.
+     * A record that can never be written, because its handler rejects it or no handler is
+     * registered for its kind, is logged, moved to the journal's rejected file (see
+     * WriteJournal::reject()) and passed over, so it does not hold up the records after it.
+     *
+     * The object runs on a worker thread; applyNow() is called by a timer and reports through
+     * signals. Leases are taken on the calling thread.
+     */
+    class JournalApplier : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        /**
+         * @brief Writes one record. A Failure is retried; a Rejected outcome carries the reason
+         *        in its message.
+         */
+        using Handler = std::function<Etrek::Specification::Result<JournalApplyOutcome>(const JournalEntryKey&, const QJsonObject&)>;
+
+        explicit JournalApplier(std::shared_ptr<WriteJournal> journal, QObject* parent = nullptr);
+
+        void registerHandler(const QString& kind, Handler handler);
+
+        /**
+         * @brief Sets how many records are applied between two checkpoints. Default 64.
+         */
+        void setCheckpointInterval(int records);
+
+        /**
+         * @brief Applies the records not yet applied, in order.
+         * @param maxRecords Stop after this many records; -1 for all.
+         * @return Result containing the number of records handled, including skipped and rejected ones.
+         */
+        Etrek::Specification::Result<int> applyPending(int maxRecords = -1);
+
+        /**
+         * @brief Records @p key as applied on @p lease, inside the caller's transaction.
+         * @return Result containing false when the key was applied before; the caller then
+         *         rolls back and skips the record.
+         */
+        static Etrek::Specification::Result<bool> claimEntry(ConnectionLease& lease, const JournalEntryKey& key);
+
+    public slots:
+        /**
+         * @brief Syncs the journal and, unless a retry is still waiting, runs applyPending().
+         */
+        void applyNow();
+
+    signals:
+        void applied(int records);
+        void applyFailed(const QString& message);
+
+    private:
+        std::shared_ptr<WriteJournal> m_journal;
+        QHash<QString, Handler> m_handlers;
+        int m_checkpointInterval = 64;
+
+        int m_retryDelayMs = 0;
+        QDateTime m_nextAttempt;
+
+        /**
+         * @brief Pointer to the translation provider for localized messages (non-owning).
+         */
+        Etrek::Core::Globalization::TranslationProvider* translator;
+
+        /**
+         * @brief Shared pointer to the application logger.
+         */
+        std::shared_ptr<Etrek::Core::Log::AppLogger> logger;
+    };
+
+} // namespace Etrek::Core::Repository
+
+#endif // JOURNALAPPLIER_H
@@ -0,0 +1,421 @@
+#include "OfflineStoreSync.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVector>
+#include "BulkInsertWriter.h"
+#include "QueryStatistics.h"
+#include "WorklistDisplayProjection.h"
+#include "MessageKey.h"
+#include "AppLoggerFactory.h"
+
+namespace Etrek::Core::Repository {
+
+    using Etrek::Specification::Result;
+    using Etrek::Core::Data::Model::DatabaseConnectionSetting;
+    using Etrek::Core::Globalization::TranslationProvider;
+    using Etrek::Core::Log::AppLoggerFactory;
+    using Etrek::Core::Log::LoggerProvider;
+    namespace WorklistDisplayProjection = Etrek::Worklist::Repository::WorklistDisplayProjection;
+
+    namespace {
+
+        // pending_sync values of mwl_entries in the store (see sqlite_store.sql)
+        constexpr int SYNCED = 0;
+        constexpr int CREATED_OFFLINE = 1;
+        constexpr int STATUS_CHANGED = 2;
+
+        struct CopiedTable {
+            QString Name;
+            QStringList Columns;    // Key columns first
+            int KeyColumns;
+        };
+
+        // SQLite files of a store: the database and its journals
+        const QStringList STORE_FILE_SUFFIXES = { QString(), "-journal", "-wal", "-shm" };
+
+        // Reference data copied on every run, parents before children. users.password_hash is
+        // needed for offline login; the store file is restricted to its owner before it is copied.
+        const QList<CopiedTable>& referenceTables()
+        {
+            static const QList<CopiedTable> tables = {
+                { "roles", { "id", "name" }, 1 },
+                { "users", { "id", "user_name", "name", "surname", "is_active", "is_deleted", "create_date", "update_date", "password_hash" }, 1 },
+                { "user_roles", { "user_id", "role_id" }, 2 },
+                { "anatomic_regions", { "id", "name", "code_value", "coding_scheme", "code_meaning", "description", "display_order" }, 1 },
+                { "body_parts", { "id", "name", "code_value", "coding_scheme", "description", "anatomic_region_id", "is_active" }, 1 },
+                { "dicom_tags", { "id", "name", "display_name", "group_hex", "element_hex", "pgroup_hex", "pelement_hex", "is_active", "is_retired" }, 1 },
+                { "profile_tag_association", { "profile_id", "tag_id", "is_identifier", "is_mandatory", "matching_value" }, 2 },
+            };
+            return tables;
+        }
+
+        const QStringList ENTRY_COLUMNS = {
+            "source", "profile_id", "status", "study_instance_uid", "identity_fingerprint", "created_at", "updated_at",
+            "source_connection"
+        };
+
+        const QStringList DISPLAY_COLUMNS = {
+            "display_patient_name", "display_patient_id", "display_study_name", "display_patient_sex",
+            "display_birth_date", "display_accession_number", "display_admission_id"
+        };
+
+        // SQLite returns date-times as text; MySQL gets them back as QDateTime
+        QVariant dateTimeValue(const QVariant& value)
+        {
+            return value.isNull() ? QVariant(QVariant::DateTime) : QVariant(value.toDateTime());
+        }
+
+        QVariantList rowValues(const QSqlQuery& query, int count)
+        {
+            QVariantList values;
+            values.reserve(count);
+            for (int i = 0; i < count; ++i)
+                values << query.value(i);
+            return values;
+        }
+    }
+
+    OfflineStoreSync::OfflineStoreSync(std::shared_ptr<DatabaseConnectionSetting> primary,
+        std::shared_ptr<DatabaseConnectionSetting> store,
+        QObject* parent)
+        : QObject(parent)
+        , m_primary(std::move(primary))
+        , m_store(std::move(store))
+    {
+        translator = &TranslationProvider::Instance();
+        AppLoggerFactory factory(LoggerProvider::Instance(), translator);
+        logger = factory.CreateLogger("OfflineStoreSync");
+    }
+
+    void OfflineStoreSync::synchronizeNow()
+    {
+        auto result = synchronize(QDateTime(QDate::currentDate(), QTime(0, 0)));
+        if (!result.isSuccess) {
+            emit synchronizationFailed(result.message);
+            return;
+        }
+        emit synchronized(result.value.EntriesPushed, result.value.StatusesPushed, result.value.EntriesMirrored);
+    }
+
+    Result<OfflineSyncReport> OfflineStoreSync::synchronize(const QDateTime& mirrorFrom)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        auto fail = [this](const QString& reason) {
+            const QString error = translator->getErrorMessage(OFFLINE_SYNC_FAILED_ERROR).arg(reason);
+            logger->LogError(error);
+            return Result<OfflineSyncReport>::Failure(error);
+        };
+
+        OfflineSyncReport report;
+        {
+            auto primary = DatabaseConnectionPool::Instance().acquire(m_primary);
+            if (!primary.isValid() || !primary.database().isOpen())
+                return fail(primary.lastError());
+
+            auto store = DatabaseConnectionPool::Instance().acquire(m_store);
+            if (!store.isValid() || !store.database().isOpen())
+                return fail(store.lastError());
+
+            auto created = pushCreatedEntries(primary, store);
+            if (!created.isSuccess)
+                return fail(created.message);
+            report.EntriesPushed = created.value;
+
+            auto statuses = pushStatusChanges(primary, store);
+            if (!statuses.isSuccess)
+                return fail(statuses.message);
+            report.StatusesPushed = statuses.value;
+
+            auto mirrored = refreshMirror(primary, store, mirrorFrom);
+            if (!mirrored.isSuccess)
+                return fail(mirrored.message);
+            report.EntriesMirrored = mirrored.value;
+        }
+        report.ElapsedMs = timer.elapsed();
+
+        logger->LogInfo(translator->getInfoMessage(OFFLINE_SYNC_COMPLETED_MSG)
+            .arg(report.EntriesPushed).arg(report.StatusesPushed).arg(report.EntriesMirrored).arg(report.ElapsedMs));
+        return Result<OfflineSyncReport>::Success(report);
+    }
+
+    Result<int> OfflineStoreSync::pushCreatedEntries(ConnectionLease& primary, ConnectionLease& store)
+    {
+        QSqlQuery entries(store.database());
+        entries.setForwardOnly(true);
+        entries.prepare(QString("SELECT id, %1 FROM mwl_entries WHERE pending_sync = :pending ORDER BY id").arg(ENTRY_COLUMNS.join(", ")));
+        entries.bindValue(":pending", CREATED_OFFLINE);
+        if (!QueryStatistics::exec(entries))
+            return Result<int>::Failure(QString("Failed to read offline entries: %1").arg(entries.lastError().text()));
+
+        QList<int> localIds;
+        QVector<QVariantList> entryRows;
+        while (entries.next()) {
+            localIds << entries.value(0).toInt();
+            QVariantList row;
+            for (int i = 0; i < ENTRY_COLUMNS.size(); ++i)
+                row << entries.value(i + 1);
+            row[5] = dateTimeValue(row[5]);
+            row[6] = dateTimeValue(row[6]);
+            entryRows << row;
+        }
+        entries.finish();
+        if (localIds.isEmpty())
+            return Result<int>::Success(0);
+
+        // Tag ids are matched by keyword, the store may have been seeded on its own
+        auto tagIds = loadTagIds(primary);
+        if (!tagIds.isSuccess)
+            return Result<int>::Failure(tagIds.message);
+
+        QHash<int, QVector<QPair<int, QVariant>>> attributes;  // local entry id -> (MySQL tag id, value)
+        {
+            QSqlQuery query(store.database());
+            query.setForwardOnly(true);
+            query.prepare(R"(
+                SELECT a.mwl_entry_id, t.name, a.tag_value
+                FROM mwl_attributes a
+                JOIN mwl_entries e ON e.id = a.mwl_entry_id
+                JOIN dicom_tags t ON t.id = a.dicom_tag_id
+                WHERE e.pending_sync = :pending AND e.id <= :lastId
+                ORDER BY a.id
+            )");
+            query.bindValue(":pending", CREATED_OFFLINE);
+            query.bindValue(":lastId", localIds.last());
+            if (!QueryStatistics::exec(query))
+                return Result<int>::Failure(QString("Failed to read offline attributes: %1").arg(query.lastError().text()));
+
+            while (query.next()) {
+                const QString keyword = query.value(1).toString();
+                if (!tagIds.value.contains(keyword))
+                    return Result<int>::Failure(QString("DICOM tag %1 of an offline entry is not known to the database").arg(keyword));
+                attributes[query.value(0).toInt()].push_back({ tagIds.value.value(keyword), query.value(2) });
+            }
+        }
+
+        if (!primary.transaction())
+            return Result<int>::Failure(QString("Failed to start transaction: %1").arg(primary.database().lastError().text()));
+
+        BulkInsertWriter entryWriter(primary, "mwl_entries", ENTRY_COLUMNS);
+        entryWriter.setCollectGeneratedIds(true);
+        for (const QVariantList& row : entryRows)
+            entryWriter.addRow(row);
+        if (!entryWriter.flush()) {
+            primary.rollback();
+            return Result<int>::Failure(QString("Failed to send offline entries: %1").arg(entryWriter.lastError()));
+        }
+
+        const QList<qint64> newIds = entryWriter.generatedIds();
+        QList<int> entryIds;
+        BulkInsertWriter attributeWriter(primary, "mwl_attributes", { "mwl_entry_id", "dicom_tag_id", "tag_value" });
+        for (int i = 0; i < localIds.size(); ++i) {
+            entryIds << int(newIds[i]);
+            for (const auto& attribute : attributes.value(localIds[i]))
+                attributeWriter.addRow({ newIds[i], attribute.first, attribute.second });
+        }
+        if (!attributeWriter.flush()) {
+            primary.rollback();
+            return Result<int>::Failure(QString("Failed to send offline attributes: %1").arg(attributeWriter.lastError()));
+        }
+
+        QString projectionError;
+        if (!WorklistDisplayProjection::refreshEntries(primary.database(), entryIds, &projectionError)) {
+            primary.rollback();
+            return Result<int>::Failure(QString("Failed to refresh MWL display columns: %1").arg(projectionError));
+        }
+
+        if (!primary.commit())
+            return Result<int>::Failure(QString("Failed to commit offline entries: %1").arg(primary.database().lastError().text()));
+
+        // The entries come back with their MySQL ids when the worklist is copied. Entries
+        // registered meanwhile have larger ids and stay pending; attributes follow by cascade.
+        QSqlQuery& drop = store.prepare("DELETE FROM mwl_entries WHERE pending_sync = :pending AND id <= :lastId");
+        drop.bindValue(":pending", CREATED_OFFLINE);
+        drop.bindValue(":lastId", localIds.last());
+        if (!QueryStatistics::exec(drop))
+            return Result<int>::Failure(QString("Failed to clear sent offline entries: %1").arg(drop.lastError().text()));
+
+        return Result<int>::Success(localIds.size());
+    }
+
+    Result<int> OfflineStoreSync::pushStatusChanges(ConnectionLease& primary, ConnectionLease& store)
+    {
+        QVector<QPair<int, QVariant>> changes;
+        {
+            QSqlQuery& query = store.prepare("SELECT id, status FROM mwl_entries WHERE pending_sync = :pending");
+            query.bindValue(":pending", STATUS_CHANGED);
+            if (!QueryStatistics::exec(query))
+                return Result<int>::Failure(QString("Failed to read offline status changes: %1").arg(query.lastError().text()));
+            while (query.next())
+                changes.push_back({ query.value(0).toInt(), query.value(1) });
+            query.finish();
+        }
+
+        QSqlQuery& update = primary.prepare("UPDATE mwl_entries SET status = :status WHERE id = :id");
+        QSqlQuery& clear = store.prepare("UPDATE mwl_entries SET pending_sync = :synced WHERE id = :id AND status = :status");
+
+        for (const auto& change : changes) {
+            update.bindValue(":status", change.second);
+            update.bindValue(":id", change.first);
+            if (!QueryStatistics::exec(update))
+                return Result<int>::Failure(QString("Failed to send status of MWL entry %1: %2").arg(change.first).arg(update.lastError().text()));
+
+            // A status changed again since it was read stays pending for the next run
+            clear.bindValue(":synced", SYNCED);
+            clear.bindValue(":id", change.first);
+            clear.bindValue(":status", change.second);
+            if (!QueryStatistics::exec(clear))
+                return Result<int>::Failure(QString("Failed to clear status change of MWL entry %1: %2").arg(change.first).arg(clear.lastError().text()));
+        }
+        return Result<int>::Success(changes.size());
+    }
+
+    Result<int> OfflineStoreSync::refreshMirror(ConnectionLease& primary, ConnectionLease& store, const QDateTime& mirrorFrom)
+    {
+        // Takes the store's write lock, so nothing new becomes pending until the commit
+        if (!store.transaction())
+            return Result<int>::Failure(QString("Failed to start transaction: %1").arg(store.database().lastError().text()));
+
+        auto copied = copyReferenceTables(primary, store);
+        if (!copied.isSuccess) {
+            store.rollback();
+            return Result<int>::Failure(copied.message);
+        }
+
+        QSqlQuery& pending = store.prepare("SELECT COUNT(*) FROM mwl_entries WHERE pending_sync <> :synced");
+        pending.bindValue(":synced", SYNCED);
+        if (!QueryStatistics::exec(pending) || !pending.next()) {
+            store.rollback();
+            return Result<int>::Failure(QString("Failed to count pending offline entries: %1").arg(pending.lastError().text()));
+        }
+        const bool hasPending = pending.value(0).toInt() > 0;
+        pending.finish();
+
+        // Copied ids could collide with entries still waiting to be sent; retry on the next run
+        int mirrored = 0;
+        if (!hasPending) {
+            auto worklist = copyWorklist(primary, store, mirrorFrom);
+            if (!worklist.isSuccess) {
+                store.rollback();
+                return Result<int>::Failure(worklist.message);
+            }
+            mirrored = worklist.value;
+        }
+
+        if (!store.commit())
+            return Result<int>::Failure(QString("Failed to commit offline store: %1").arg(store.database().lastError().text()));
+
+        return Result<int>::Success(mirrored);
+    }
+
+    Result<bool> OfflineStoreSync::copyReferenceTables(ConnectionLease& primary, ConnectionLease& store)
+    {
+        auto restricted = restrictStoreFiles();
+        if (!restricted.isSuccess)
+            return restricted;
+
+        for (const CopiedTable& table : referenceTables()) {
+            QSqlQuery source(primary.database());
+            source.setForwardOnly(true);
+            if (!QueryStatistics::exec(source, QString("SELECT %1 FROM %2").arg(table.Columns.join(", "), table.Name)))
+                return Result<bool>::Failure(QString("Failed to read %1: %2").arg(table.Name, source.lastError().text()));
+
+            BulkInsertWriter writer(store, table.Name, table.Columns);
+            const QStringList valueColumns = table.Columns.mid(table.KeyColumns);
+            if (valueColumns.isEmpty()) {
+                // Pure link table: replace it
+                QSqlQuery clear(store.database());
+                if (!QueryStatistics::exec(clear, QString("DELETE FROM %1").arg(table.Name)))
+                    return Result<bool>::Failure(QString("Failed to clear %1: %2").arg(table.Name, clear.lastError().text()));
+            }
+            else {
+                writer.setUpdateOnDuplicate(valueColumns);
+            }
+
+            while (source.next())
+                writer.addRow(rowValues(source, table.Columns.size()));
+            if (!writer.flush())
+                return Result<bool>::Failure(QString("Failed to copy %1: %2").arg(table.Name, writer.lastError()));
+        }
+        return Result<bool>::Success(true);
+    }
+
+    Result<bool> OfflineStoreSync::restrictStoreFiles() const
+    {
+        const QString path = m_store->getDatabaseName();
+        for (const QString& suffix : STORE_FILE_SUFFIXES) {
+            const QString file = path + suffix;
+            if (!QFile::exists(file))
+                continue;
+            if (!QFile::setPermissions(file, QFileDevice::ReadOwner | QFileDevice::WriteOwner))
+                return Result<bool>::Failure(QString("Failed to restrict access to %1").arg(file));
+        }
+        return Result<bool>::Success(true);
+    }
+
+    Result<int> OfflineStoreSync::copyWorklist(ConnectionLease& primary, ConnectionLease& store, const QDateTime& mirrorFrom)
+    {
+        QSqlQuery& clear = store.prepare("DELETE FROM mwl_entries WHERE pending_sync = :synced");
+        clear.bindValue(":synced", SYNCED);
+        if (!QueryStatistics::exec(clear))
+            return Result<int>::Failure(QString("Failed to clear copied worklist: %1").arg(clear.lastError().text()));
+
+        const QStringList columns = QStringList{ "id" } + ENTRY_COLUMNS + DISPLAY_COLUMNS;
+
+        QSqlQuery entries(primary.database());
+        entries.setForwardOnly(true);
+        entries.prepare(QString("SELECT %1 FROM mwl_entries WHERE created_at >= :from ORDER BY id").arg(columns.join(", ")));
+        entries.bindValue(":from", mirrorFrom);
+        if (!QueryStatistics::exec(entries))
+            return Result<int>::Failure(QString("Failed to read worklist: %1").arg(entries.lastError().text()));
+
+        BulkInsertWriter entryWriter(store, "mwl_entries", columns + QStringList{ "pending_sync" });
+        int lastId = 0;
+        while (entries.next()) {
+            entryWriter.addRow(rowValues(entries, columns.size()) << SYNCED);
+            lastId = entries.value(0).toInt();
+        }
+        entries.finish();
+        const int count = entryWriter.pendingRowCount();
+        if (!entryWriter.flush())
+            return Result<int>::Failure(QString("Failed to copy worklist: %1").arg(entryWriter.lastError()));
+
+        // Bounded by the last entry read, entries created since are copied on the next run
+        QSqlQuery attributes(primary.database());
+        attributes.setForwardOnly(true);
+        attributes.prepare(R"(
+            SELECT a.id, a.mwl_entry_id, a.dicom_tag_id, a.tag_value
+            FROM mwl_attributes a
+            JOIN mwl_entries e ON e.id = a.mwl_entry_id
+            WHERE e.created_at >= :from AND e.id <= :lastId
+        )");
+        attributes.bindValue(":from", mirrorFrom);
+        attributes.bindValue(":lastId", lastId);
+        if (!QueryStatistics::exec(attributes))
+            return Result<int>::Failure(QString("Failed to read worklist attributes: %1").arg(attributes.lastError().text()));
+
+        BulkInsertWriter attributeWriter(store, "mwl_attributes", { "id", "mwl_entry_id", "dicom_tag_id", "tag_value" });
+        while (attributes.next())
+            attributeWriter.addRow(rowValues(attributes, 4));
+        if (!attributeWriter.flush())
+            return Result<int>::Failure(QString("Failed to copy worklist attributes: %1").arg(attributeWriter.lastError()));
+
+        return Result<int>::Success(count);
+    }
+
+    Result<QHash<QString, int>> OfflineStoreSync::loadTagIds(ConnectionLease& lease) const
+    {
+        QHash<QString, int> ids;
+        QSqlQuery query(lease.database());
+        query.setForwardOnly(true);
+        if (!QueryStatistics::exec(query, "SELECT id, name FROM dicom_tags"))
+            return Result<QHash<QString, int>>::Failure(QString("Failed to read DICOM tags: %1").arg(query.lastError().text()));
+        while (query.next())
+            ids.insert(query.value(1).toString(), query.value(0).toInt());
+        return Result<QHash<QString, int>>::Success(ids);
+    }
+
+} // namespace Etrek::Core::Repository
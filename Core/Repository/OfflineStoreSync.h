@@ -0,0 +1,106 @@
+#ifndef OFFLINESTORESYNC_H
+#define OFFLINESTORESYNC_H
+
+#include <memory>
+#include <QDateTime>
+#include <QHash>
+#include <QObject>
+#include <QString>
+#include "Result.h"
+#include "DatabaseConnectionPool.h"
+#include "DatabaseConnectionSetting.h"
+#include "TranslationProvider.h"
+#include "AppLogger.h"
+
+namespace Etrek::Core::Repository {
+
+    /**
+     * @brief Counts of one synchronization run.
+     */
+    struct OfflineSyncReport {
+        int EntriesPushed = 0;      ///< Worklist entries created offline and written to MySQL
+        int StatusesPushed = 0;     ///< Status changes of copied entries written to MySQL
+        int EntriesMirrored = 0;    ///< Worklist entries copied from MySQL into the store
+        qint64 ElapsedMs = 0;
+    };
+
+    /**
+     * @class OfflineStoreSync
+     * @brief Keeps the local SQLite offline store and the MySQL database in step.
+     *
+     * While MySQL is unreachable the application runs on the offline store (see
+     * sqlite_store.sql). Rows the store has to send back are marked in mwl_entries.pending_sync:
+     * 1 for entries registered locally, 2 for copied entries whose status changed locally.
+     *
+     * A run first sends those rows to MySQL: new entries and their attributes are inserted with
+     * MySQL ids, the display columns are refreshed and the local rows are dropped; status changes
+     * are written by id. It then copies the users, roles, anatomy and DICOM tag dictionary, and,
+     * once nothing is left to send, replaces the copied worklist with MySQL's entries created
+     * since the given time, keeping their ids. The users are copied with their encrypted
+     * passwords for offline login, so the store file and its journals are first made readable
+     * by their owner only; the copy fails if that is not possible.
+     *
+     * Sending is at least once: if the application stops after MySQL committed the new entries
+     * but before the local rows were dropped, they are sent again on the next run. Entity
+     * statuses are not synchronized; the patients, studies and images they refer to live on
+     * MySQL only.
+     *
+     * The object runs on a worker thread; synchronizeNow() is called by a timer and reports
+     * through signals. Leases are taken on the calling thread.
+     */
+    class OfflineStoreSync : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        /**
+         * @param primary MySQL connection settings.
+         * @param store Settings of the SQLite offline store; its schema must already exist.
+         */
+        OfflineStoreSync(std::shared_ptr<Etrek::Core::Data::Model::DatabaseConnectionSetting> primary,
+            std::shared_ptr<Etrek::Core::Data::Model::DatabaseConnectionSetting> store,
+            QObject* parent = nullptr);
+
+        /**
+         * @brief Runs one synchronization.
+         * @param mirrorFrom Worklist entries created at or after this time are copied into the store.
+         * @return Result containing the counts of the run.
+         */
+        Etrek::Specification::Result<OfflineSyncReport> synchronize(const QDateTime& mirrorFrom);
+
+    public slots:
+        /**
+         * @brief Runs synchronize() for today's worklist and emits the outcome.
+         */
+        void synchronizeNow();
+
+    signals:
+        void synchronized(int entriesPushed, int statusesPushed, int entriesMirrored);
+        void synchronizationFailed(const QString& message);
+
+    private:
+        Etrek::Specification::Result<int> pushCreatedEntries(ConnectionLease& primary, ConnectionLease& store);
+        Etrek::Specification::Result<int> pushStatusChanges(ConnectionLease& primary, ConnectionLease& store);
+        Etrek::Specification::Result<int> refreshMirror(ConnectionLease& primary, ConnectionLease& store, const QDateTime& mirrorFrom);
+        Etrek::Specification::Result<bool> copyReferenceTables(ConnectionLease& primary, ConnectionLease& store);
+        Etrek::Specification::Result<bool> restrictStoreFiles() const;
+        Etrek::Specification::Result<int> copyWorklist(ConnectionLease& primary, ConnectionLease& store, const QDateTime& mirrorFrom);
+        Etrek::Specification::Result<QHash<QString, int>> loadTagIds(ConnectionLease& lease) const;
+
+        std::shared_ptr<Etrek::Core::Data::Model::DatabaseConnectionSetting> m_primary;
+        std::shared_ptr<Etrek::Core::Data::Model::DatabaseConnectionSetting> m_store;
+
+        /**
+         * @brief Pointer to the translation provider for localized messages (non-owning).
+         */
+        Etrek::Core::Globalization::TranslationProvider* translator;
+
+        /**
+         * @brief Shared pointer to the application logger.
+         */
+        std::shared_ptr<Etrek::Core::Log::AppLogger> logger;
+    };
+
+} // namespace Etrek::Core::Repository
+
+#endif // OFFLINESTORESYNC_H
@@ -0,0 +1,50 @@
+#ifndef PERCONNECTIONREGISTRY_H
+#define PERCONNECTIONREGISTRY_H
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QString>
+#include <memory>
+#include "DatabaseConnectionSetting.h"
+
+namespace Etrek::Core::Repository {
+
+    /**
+     * @class PerConnectionRegistry
+     * @brief Hands out one shared instance of @p T per database.
+     *
+     * Caches that outlive a single repository (tag metadata, catalog snapshots, device lists)
+     * are shared by every repository working on the same database and kept apart for different
+     * ones. Databases are told apart by DatabaseConnectionSetting::connectionKey(), the identity
+     * DatabaseConnectionPool uses for its buckets. Instances live for the rest of the process.
+     *
+     * Thread-safe; typically held as a function-local static of the owning type's forDatabase().
+     */
+    template <typename T>
+    class PerConnectionRegistry
+    {
+    public:
+        /**
+         * @brief Returns the instance for the database of @p setting, creating it with @p create on first use.
+         * @param create Callable returning std::shared_ptr<T>; runs under the registry lock.
+         */
+        template <typename Factory>
+        std::shared_ptr<T> instanceFor(const Etrek::Core::Data::Model::DatabaseConnectionSetting& setting, Factory create)
+        {
+            const QString key = setting.connectionKey();
+
+            QMutexLocker locker(&m_mutex);
+            auto& instance = m_instances[key];
+            if (!instance)
+                instance = create();
+            return instance;
+        }
+
+    private:
+        QMutex m_mutex;
+        QHash<QString, std::shared_ptr<T>> m_instances;
+    };
+}
+
+#endif // PERCONNECTIONREGISTRY_H
@@ -0,0 +1,110 @@
+#include "PreparedStatementCache.h"
+
+namespace Etrek::Core::Repository {
+
+    PreparedStatementCache::PreparedStatementCache(QString connectionName, int capacity)
+        : m_connectionName(std::move(connectionName))
+        , m_capacity(capacity < 0 ? 0 : capacity)
+    {
+    }
+
+    QSqlQuery* PreparedStatementCache::acquire(const QString& sql, bool* ok)
+    {
+        if (ok)
+            *ok = true;
+
+        if (m_capacity == 0)
+            return nullptr;
+
+        auto found = m_index.find(sql);
+        if (found != m_index.end()) {
+            auto it = found.value();
+            if (isBeingRead(it->query, it->pinned)) {
+                // Handed out earlier in this lease and its rows are still being read, e.g. an
+                // outer loop over the same statement; finishing it would end that loop early
+                ++m_misses;
+                return nullptr;
+            }
+            m_entries.splice(m_entries.begin(), m_entries, it);
+            it->query.finish();
+            it->pinned = true;
+            ++m_hits;
+            return &it->query;
+        }
+
+        ++m_misses;
+
+        QSqlDatabase db = QSqlDatabase::database(m_connectionName, false);
+        m_entries.push_front(Entry{ sql, QSqlQuery(db), true });
+        auto it = m_entries.begin();
+
+        if (!it->query.prepare(sql)) {
+            // Keep failed statements out of the cache; the caller falls back to an ad-hoc query
+            // that reports the driver error.
+            m_entries.erase(it);
+            if (ok)
+                *ok = false;
+            return nullptr;
+        }
+
+        m_index.insert(sql, it);
+        m_size = static_cast<int>(m_entries.size());
+        trim();
+        return &it->query;
+    }
+
+    bool PreparedStatementCache::isBeingRead(const QSqlQuery& query, bool pinned)
+    {
+        return pinned && query.isActive() && query.isSelect() && query.at() != QSql::AfterLastRow;
+    }
+
+    void PreparedStatementCache::releasePinned()
+    {
+        for (auto& entry : m_entries) {
+            if (entry.pinned) {
+                entry.query.finish();
+                entry.pinned = false;
+            }
+        }
+        trim();
+    }
+
+    void PreparedStatementCache::clear()
+    {
+        m_index.clear();
+        m_entries.clear();
+        m_size = 0;
+    }
+
+    void PreparedStatementCache::setCapacity(int capacity)
+    {
+        m_capacity = capacity < 0 ? 0 : capacity;
+        trim();
+    }
+
+    PreparedStatementCache::Stats PreparedStatementCache::stats() const
+    {
+        Stats s;
+        s.hits = m_hits.load();
+        s.misses = m_misses.load();
+        s.evictions = m_evictions.load();
+        s.size = m_size.load();
+        return s;
+    }
+
+    void PreparedStatementCache::trim()
+    {
+        // Walk from the least recently used end, skipping statements still pinned by a lease.
+        auto it = m_entries.end();
+        while (static_cast<int>(m_entries.size()) > m_capacity && it != m_entries.begin()) {
+            --it;
+            if (it->pinned)
+                continue;
+            m_index.remove(it->sql);
+            it = m_entries.erase(it);
+            ++m_evictions;
+        }
+        m_size = static_cast<int>(m_entries.size());
+    }
+
+} // namespace Etrek::Core::Repository
@@ -0,0 +1,100 @@
+#ifndef PREPAREDSTATEMENTCACHE_H
+#define PREPAREDSTATEMENTCACHE_H
+
+#include <atomic>
+#include <list>
+#include <QHash>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+
+namespace Etrek::Core::Repository {
+
+    /**
+     * @class PreparedStatementCache
+     * @brief LRU cache of prepared QSqlQuery objects for one pooled connection.
+     *
+     * Statements are keyed by their SQL text. The first request prepares the statement on the
+     * server; later requests on the same connection get the same QSqlQuery back so callers only
+     * bind new values and execute. Statements handed out during a lease are pinned and are not
+     * evicted until the lease is released. A pinned SELECT whose rows have not all been read
+     * is not handed out again; the caller prepares a separate query instead.
+     *
+     * @note A cache belongs to a single connection and is used only from the thread owning that
+     *       connection. The counters may be read from any thread.
+     */
+    class PreparedStatementCache
+    {
+    public:
+        /**
+         * @brief Snapshot of cache counters.
+         */
+        struct Stats {
+            quint64 hits = 0;
+            quint64 misses = 0;
+            quint64 evictions = 0;
+            int size = 0;
+        };
+
+        /**
+         * @brief Creates a cache bound to the given connection.
+         * @param connectionName Name of the QSqlDatabase connection the statements are prepared on.
+         * @param capacity Maximum number of unpinned statements kept; 0 disables caching.
+         */
+        PreparedStatementCache(QString connectionName, int capacity);
+
+        PreparedStatementCache(const PreparedStatementCache&) = delete;
+        PreparedStatementCache& operator=(const PreparedStatementCache&) = delete;
+
+        /**
+         * @brief Returns a prepared statement for @p sql, preparing it on a miss.
+         * @param sql SQL text; used verbatim as the cache key.
+         * @param ok Set to false if the statement could not be prepared.
+         * @return Pointer to the cached statement, or nullptr when it failed to prepare, caching is
+         *         disabled or the cached statement is still being read.
+         */
+        QSqlQuery* acquire(const QString& sql, bool* ok = nullptr);
+
+        /**
+         * @brief Finishes and unpins every statement handed out since the last call.
+         */
+        void releasePinned();
+
+        /**
+         * @brief Drops every cached statement, e.g. after the connection was reopened.
+         */
+        void clear();
+
+        /**
+         * @brief Changes the capacity; excess unpinned statements are evicted immediately.
+         */
+        void setCapacity(int capacity);
+
+        /**
+         * @brief Returns the current counters.
+         */
+        Stats stats() const;
+
+    private:
+        struct Entry {
+            QString sql;
+            QSqlQuery query;
+            bool pinned = false;
+        };
+
+        void trim();
+        static bool isBeingRead(const QSqlQuery& query, bool pinned);
+
+        QString m_connectionName;
+        int m_capacity;
+        std::list<Entry> m_entries;                                 ///< Most recently used first.
+        QHash<QString, std::list<Entry>::iterator> m_index;
+        std::atomic<quint64> m_hits{ 0 };
+        std::atomic<quint64> m_misses{ 0 };
+        std::atomic<quint64> m_evictions{ 0 };
+        std::atomic<int> m_size{ 0 };
+    };
+
+} // namespace Etrek::Core::Repository
+
+#endif // PREPAREDSTATEMENTCACHE_H
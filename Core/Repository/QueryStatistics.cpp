@@ -0,0 +1,317 @@
+#include "QueryStatistics.h"
+#include <algorithm>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QSqlError>
+#include <QTextStream>
+#include "MessageKey.h"
+#include "AppLoggerFactory.h"
+
+namespace Etrek::Core::Repository {
+
+    using Etrek::Core::Globalization::TranslationProvider;
+    using Etrek::Core::Log::AppLoggerFactory;
+    using Etrek::Core::Log::LoggerProvider;
+
+    namespace {
+        constexpr std::array<qint64, LatencyHistogram::BUCKET_COUNT - 1> BUCKET_BOUNDS_US = {
+            50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000,
+            100000, 250000, 500000, 1000000, 2500000, 5000000
+        };
+
+        // Fingerprints of distinct SQL texts kept; statements built with literals are folded
+        // to few fingerprints but may have many texts
+        constexpr int FINGERPRINT_CACHE_CAPACITY = 4096;
+        constexpr int REPORT_FINGERPRINT_WIDTH = 160;
+
+        QString milliseconds(qint64 ns)
+        {
+            return QString::number(double(ns) / 1e6, 'f', 2);
+        }
+    }
+
+    qint64 LatencyHistogram::bucketUpperBoundUs(int index)
+    {
+        return index < int(BUCKET_BOUNDS_US.size()) ? BUCKET_BOUNDS_US[index] : -1;
+    }
+
+    void LatencyHistogram::add(qint64 elapsedNs)
+    {
+        const qint64 us = elapsedNs / 1000;
+        const auto bound = std::lower_bound(BUCKET_BOUNDS_US.begin(), BUCKET_BOUNDS_US.end(), us);
+        ++m_buckets[bound - BUCKET_BOUNDS_US.begin()];
+        ++m_count;
+        m_totalNs += elapsedNs;
+        m_maxNs = qMax(m_maxNs, elapsedNs);
+    }
+
+    void LatencyHistogram::merge(const LatencyHistogram& other)
+    {
+        for (int i = 0; i < BUCKET_COUNT; ++i)
+            m_buckets[i] += other.m_buckets[i];
+        m_count += other.m_count;
+        m_totalNs += other.m_totalNs;
+        m_maxNs = qMax(m_maxNs, other.m_maxNs);
+    }
+
+    qint64 LatencyHistogram::quantileNs(double fraction) const
+    {
+        if (m_count == 0)
+            return 0;
+
+        const quint64 rank = qMax<quint64>(1, quint64(fraction * double(m_count) + 0.5));
+        quint64 seen = 0;
+        for (int i = 0; i < BUCKET_COUNT; ++i) {
+            seen += m_buckets[i];
+            if (seen >= rank) {
+                const qint64 bound = bucketUpperBoundUs(i);
+                return bound < 0 ? m_maxNs : qMin(bound * 1000, m_maxNs);
+            }
+        }
+        return m_maxNs;
+    }
+
+    QueryStatistics& QueryStatistics::Instance()
+    {
+        static QueryStatistics instance;
+        return instance;
+    }
+
+    QueryStatistics::QueryStatistics()
+    {
+        translator = &TranslationProvider::Instance();
+        AppLoggerFactory factory(LoggerProvider::Instance(), translator);
+        logger = factory.CreateLogger("QueryStatistics");
+    }
+
+    bool QueryStatistics::exec(QSqlQuery& query)
+    {
+        QueryStatistics& statistics = Instance();
+        if (!statistics.isEnabled())
+            return query.exec();
+
+        QElapsedTimer timer;
+        timer.start();
+        const bool succeeded = query.exec();
+        statistics.recordExecution(query, query.lastQuery(), timer.nsecsElapsed(), succeeded);
+        return succeeded;
+    }
+
+    bool QueryStatistics::exec(QSqlQuery& query, const QString& sql)
+    {
+        QueryStatistics& statistics = Instance();
+        if (!statistics.isEnabled())
+            return query.exec(sql);
+
+        QElapsedTimer timer;
+        timer.start();
+        const bool succeeded = query.exec(sql);
+        statistics.recordExecution(query, sql, timer.nsecsElapsed(), succeeded);
+        return succeeded;
+    }
+
+    void QueryStatistics::setSlowQueryThresholdMs(int thresholdMs)
+    {
+        m_slowQueryThresholdMs = qMax(0, thresholdMs);
+    }
+
+    int QueryStatistics::slowQueryThresholdMs() const
+    {
+        return m_slowQueryThresholdMs;
+    }
+
+    void QueryStatistics::setEnabled(bool enabled)
+    {
+        m_enabled = enabled;
+    }
+
+    bool QueryStatistics::isEnabled() const
+    {
+        return m_enabled;
+    }
+
+    void QueryStatistics::recordExecution(const QSqlQuery& query, const QString& sql, qint64 elapsedNs, bool succeeded)
+    {
+        // Drivers that cannot report a result size (SQLite, forward-only MySQL) return -1
+        int rows = -1;
+        if (succeeded)
+            rows = query.isSelect() ? query.size() : query.numRowsAffected();
+
+        recordStatement(sql, elapsedNs, rows, int(query.boundValues().size()), succeeded,
+            succeeded ? QString() : query.lastError().text());
+    }
+
+    void QueryStatistics::recordStatement(const QString& sql, qint64 elapsedNs, int rows, int boundValues,
+                                          bool succeeded, const QString& error)
+    {
+        QString statementFingerprint;
+        {
+            QMutexLocker locker(&m_mutex);
+            auto cached = m_fingerprints.constFind(sql);
+            if (cached != m_fingerprints.constEnd()) {
+                statementFingerprint = cached.value();
+            } else {
+                if (m_fingerprints.size() >= FINGERPRINT_CACHE_CAPACITY)
+                    m_fingerprints.clear();
+                statementFingerprint = fingerprint(sql);
+                m_fingerprints.insert(sql, statementFingerprint);
+            }
+
+            StatementStatistics& statistics = m_statements[statementFingerprint];
+            if (statistics.Fingerprint.isEmpty())
+                statistics.Fingerprint = statementFingerprint;
+            statistics.Latency.add(elapsedNs);
+            if (rows > 0)
+                statistics.Rows += rows;
+            if (!succeeded) {
+                ++statistics.Failures;
+                statistics.LastError = error;
+            }
+        }
+
+        const int threshold = m_slowQueryThresholdMs;
+        if (threshold > 0 && elapsedNs >= qint64(threshold) * 1000000) {
+            logger->LogWarning(translator->getWarningMessage(DB_SLOW_QUERY_WARNING)
+                .arg(milliseconds(elapsedNs))
+                .arg(boundValues)
+                .arg(rows)
+                .arg(statementFingerprint));
+        }
+    }
+
+    void QueryStatistics::recordAcquireWait(qint64 elapsedNs)
+    {
+        if (!isEnabled())
+            return;
+
+        QMutexLocker locker(&m_mutex);
+        m_acquireWait.add(elapsedNs);
+    }
+
+    QVector<StatementStatistics> QueryStatistics::statements() const
+    {
+        QVector<StatementStatistics> result;
+        {
+            QMutexLocker locker(&m_mutex);
+            result.reserve(m_statements.size());
+            for (const auto& statistics : m_statements)
+                result.push_back(statistics);
+        }
+
+        std::sort(result.begin(), result.end(), [](const StatementStatistics& a, const StatementStatistics& b) {
+            return a.Latency.totalNs() > b.Latency.totalNs();
+        });
+        return result;
+    }
+
+    LatencyHistogram QueryStatistics::acquireWait() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_acquireWait;
+    }
+
+    QString QueryStatistics::report(int maxStatements) const
+    {
+        const QVector<StatementStatistics> all = statements();
+        const LatencyHistogram wait = acquireWait();
+
+        quint64 executions = 0;
+        for (const auto& statistics : all)
+            executions += statistics.Latency.count();
+
+        QString text;
+        QTextStream out(&text);
+        out << "Query statistics: " << executions << " executions of " << all.size()
+            << " statements, slow-query threshold " << slowQueryThresholdMs() << " ms\n";
+        out << "Connection acquire wait: " << wait.count() << " leases, mean " << milliseconds(wait.meanNs())
+            << " ms, p50 " << milliseconds(wait.quantileNs(0.50))
+            << " ms, p95 " << milliseconds(wait.quantileNs(0.95))
+            << " ms, p99 " << milliseconds(wait.quantileNs(0.99))
+            << " ms, max " << milliseconds(wait.maxNs()) << " ms\n";
+        out << QString("%1 %2 %3 %4 %5 %6 %7 %8 %9  %10\n")
+            .arg("count", 8).arg("failed", 6).arg("total ms", 10).arg("mean ms", 8)
+            .arg("p50 ms", 8).arg("p95 ms", 8).arg("p99 ms", 8).arg("max ms", 9).arg("rows", 9)
+            .arg("statement");
+
+        for (int i = 0; i < all.size() && i < maxStatements; ++i) {
+            const StatementStatistics& statistics = all[i];
+            const LatencyHistogram& latency = statistics.Latency;
+            out << QString("%1 %2 %3 %4 %5 %6 %7 %8 %9  %10\n")
+                .arg(latency.count(), 8).arg(statistics.Failures, 6)
+                .arg(milliseconds(latency.totalNs()), 10).arg(milliseconds(latency.meanNs()), 8)
+                .arg(milliseconds(latency.quantileNs(0.50)), 8).arg(milliseconds(latency.quantileNs(0.95)), 8)
+                .arg(milliseconds(latency.quantileNs(0.99)), 8).arg(milliseconds(latency.maxNs()), 9)
+                .arg(statistics.Rows, 9)
+                .arg(statistics.Fingerprint.left(REPORT_FINGERPRINT_WIDTH));
+            if (statistics.Failures > 0)
+                out << QString(" ").repeated(73) << "last error: " << statistics.LastError << "\n";
+        }
+        if (all.size() > maxStatements)
+            out << "... " << all.size() - maxStatements << " more statements\n";
+
+        out.flush();
+        return text;
+    }
+
+    void QueryStatistics::reset()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_statements.clear();
+        m_acquireWait = LatencyHistogram();
+    }
+
+    QString QueryStatistics::fingerprint(const QString& sql)
+    {
+        QString result;
+        result.reserve(sql.size());
+
+        bool pendingSpace = false;
+        for (int i = 0; i < sql.size(); ++i) {
+            const QChar c = sql.at(i);
+            if (c.isSpace()) {
+                pendingSpace = !result.isEmpty();
+                continue;
+            }
+            if (pendingSpace) {
+                result += ' ';
+                pendingSpace = false;
+            }
+
+            // String literal, with '' and \' escapes
+            if (c == '\'') {
+                for (++i; i < sql.size(); ++i) {
+                    if (sql.at(i) == '\\') {
+                        ++i;
+                    } else if (sql.at(i) == '\'') {
+                        if (i + 1 < sql.size() && sql.at(i + 1) == '\'')
+                            ++i;
+                        else
+                            break;
+                    }
+                }
+                result += '?';
+                continue;
+            }
+
+            // Number, unless it is part of an identifier such as table2 or idx_1
+            const bool startsWord = result.isEmpty()
+                || !(result.back().isLetterOrNumber() || result.back() == '_' || result.back() == '`');
+            if (c.isDigit() && startsWord) {
+                while (i + 1 < sql.size() && (sql.at(i + 1).isDigit() || sql.at(i + 1) == '.'))
+                    ++i;
+                result += '?';
+                continue;
+            }
+
+            result += c;
+        }
+
+        // Fold placeholder lists, IN (?, ?, ?) and VALUES (?, ?), (?, ?), of any length
+        static const QRegularExpression placeholderList(R"(\?(?:\s*,\s*\?)+)");
+        static const QRegularExpression rowList(R"(\((?:\?|\?, \.\.\.)\)(?:\s*,\s*\((?:\?|\?, \.\.\.)\))+)");
+        result.replace(placeholderList, "?, ...");
+        result.replace(rowList, "(?, ...), ...");
+        return result;
+    }
+
+} // namespace Etrek::Core::Repository
@@ -0,0 +1,146 @@
+#ifndef QUERYSTATISTICS_H
+#define QUERYSTATISTICS_H
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <QHash>
+#include <QMutex>
+#include <QSqlQuery>
+#include <QString>
+#include <QVector>
+#include "TranslationProvider.h"
+#include "AppLogger.h"
+
+namespace Etrek::Core::Repository {
+
+    /**
+     * @brief Latency histogram with fixed buckets from 50 us to 5 s.
+     */
+    class LatencyHistogram
+    {
+    public:
+        static constexpr int BUCKET_COUNT = 17;
+
+        /**
+         * @brief Upper bound of bucket @p index in microseconds; the last bucket is open.
+         */
+        static qint64 bucketUpperBoundUs(int index);
+
+        void add(qint64 elapsedNs);
+        void merge(const LatencyHistogram& other);
+
+        quint64 count() const { return m_count; }
+        qint64 totalNs() const { return m_totalNs; }
+        qint64 maxNs() const { return m_maxNs; }
+        qint64 meanNs() const { return m_count ? m_totalNs / qint64(m_count) : 0; }
+
+        /**
+         * @brief Upper bound of the bucket holding the @p fraction quantile (e.g. 0.95), in
+         *        nanoseconds, capped at the largest value seen.
+         */
+        qint64 quantileNs(double fraction) const;
+
+        const std::array<quint64, BUCKET_COUNT>& buckets() const { return m_buckets; }
+
+    private:
+        std::array<quint64, BUCKET_COUNT> m_buckets{};
+        quint64 m_count = 0;
+        qint64 m_totalNs = 0;
+        qint64 m_maxNs = 0;
+    };
+
+    /**
+     * @brief Statistics of one statement fingerprint.
+     */
+    struct StatementStatistics {
+        QString Fingerprint;
+        quint64 Failures = 0;
+        qint64 Rows = 0;                ///< Rows returned or affected, where the driver reports them
+        LatencyHistogram Latency;
+        QString LastError;
+    };
+
+    /**
+     * @class QueryStatistics
+     * @brief Process-wide timing of repository statements and connection acquisition.
+     *
+     * Repositories run their statements through exec(), which times the call and records it
+     * under the statement's fingerprint: the SQL with literals replaced by `?`, whitespace
+     * collapsed and placeholder lists folded, so that e.g. every chunk of a multi-row INSERT
+     * counts as one statement. DatabaseConnectionPool::acquire() records how long callers
+     * waited for a connection.
+     *
+     * A statement slower than the slow-query threshold is logged as a warning with its
+     * fingerprint, duration and number of bound values; bound values themselves are never
+     * logged, as they may hold patient data. report() formats everything recorded so far; the
+     * Developer launch mode shows it on demand.
+     *
+     * All methods are thread-safe. Recording costs a timer read, a mutex and a hash lookup.
+     */
+    class QueryStatistics
+    {
+    public:
+        static constexpr int DEFAULT_SLOW_QUERY_THRESHOLD_MS = 200;
+
+        static QueryStatistics& Instance();
+
+        /**
+         * @brief Executes the prepared @p query and records it.
+         */
+        static bool exec(QSqlQuery& query);
+
+        /**
+         * @brief Executes @p sql on @p query and records it.
+         */
+        static bool exec(QSqlQuery& query, const QString& sql);
+
+        /**
+         * @brief Sets the duration above which a statement is logged; 0 disables the log.
+         */
+        void setSlowQueryThresholdMs(int thresholdMs);
+        int slowQueryThresholdMs() const;
+
+        /**
+         * @brief Turns recording on or off. On by default; exec() still executes when off.
+         */
+        void setEnabled(bool enabled);
+        bool isEnabled() const;
+
+        void recordStatement(const QString& sql, qint64 elapsedNs, int rows, int boundValues,
+                             bool succeeded, const QString& error = QString());
+        void recordAcquireWait(qint64 elapsedNs);
+
+        /**
+         * @brief Returns the statistics of every fingerprint, by total time, highest first.
+         */
+        QVector<StatementStatistics> statements() const;
+        LatencyHistogram acquireWait() const;
+
+        /**
+         * @brief Formats the @p maxStatements most expensive fingerprints and the acquisition wait.
+         */
+        QString report(int maxStatements = 25) const;
+
+        void reset();
+
+        static QString fingerprint(const QString& sql);
+
+    private:
+        QueryStatistics();
+        void recordExecution(const QSqlQuery& query, const QString& sql, qint64 elapsedNs, bool succeeded);
+
+        mutable QMutex m_mutex;
+        std::atomic<bool> m_enabled{ true };
+        std::atomic<int> m_slowQueryThresholdMs{ DEFAULT_SLOW_QUERY_THRESHOLD_MS };
+        QHash<QString, StatementStatistics> m_statements;
+        QHash<QString, QString> m_fingerprints;     // SQL text -> fingerprint
+        LatencyHistogram m_acquireWait;
+
+        Etrek::Core::Globalization::TranslationProvider* translator;
+        std::shared_ptr<Etrek::Core::Log::AppLogger> logger;
+    };
+
+} // namespace Etrek::Core::Repository
+
+#endif // QUERYSTATISTICS_H
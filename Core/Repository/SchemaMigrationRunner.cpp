@@ -0,0 +1,258 @@
+#include "SchemaMigrationRunner.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QDebug>
+#include "SqlScriptParser.h"
+#include "MessageKey.h"
+#include "AppLoggerFactory.h"
+
+namespace Etrek::Core::Repository {
+
+    using Etrek::Specification::Result;
+    using Etrek::Core::Globalization::TranslationProvider;
+    using Etrek::Core::Log::AppLoggerFactory;
+    using Etrek::Core::Log::LoggerProvider;
+
+    SchemaMigrationRunner::SchemaMigrationRunner(QSqlDatabase& db)
+        : m_db(db)
+    {
+        translator = &TranslationProvider::Instance();
+        AppLoggerFactory factory(LoggerProvider::Instance(), translator);
+        logger = factory.CreateLogger("SchemaMigrationRunner");
+    }
+
+    QList<SchemaMigration> SchemaMigrationRunner::migrations()
+    {
+        // Append only. A shipped migration is never edited; later changes get a new version.
+        // A presence query checks the last change its script makes, so that a run interrupted
+        // half way is not taken as applied. Scripts that end in a data backfill have no such
+        // artifact; they are written to be repeatable and always run once.
+        return {
+            { 1, "mwl_entries identity fingerprint", ":/sql/Script/Migration/0001_mwl_identity_fingerprint.sql", R"(
+                SELECT COUNT(*) FROM information_schema.STATISTICS
+                WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'mwl_entries' AND INDEX_NAME = 'uq_mwl_entries_profile_fingerprint'
+            )" },
+            { 2, "mwl_entries keyset pagination index", ":/sql/Script/Migration/0002_mwl_entries_created_at_index.sql", R"(
+                SELECT COUNT(*) FROM information_schema.STATISTICS
+                WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'mwl_entries' AND INDEX_NAME = 'idx_mwl_entries_created_at_id'
+            )" },
+            { 3, "mwl_entries worklist display columns", ":/sql/Script/Migration/0003_mwl_entries_display_columns.sql", QString() },
+            { 4, "mwl_attributes lookup indexes", ":/sql/Script/Migration/0004_mwl_attributes_indexes.sql", R"(
+                SELECT COUNT(*) FROM information_schema.STATISTICS
+                WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'mwl_attributes' AND INDEX_NAME = 'idx_mwl_attributes_entry_tag'
+            )" },
+            { 5, "mwl_entries filter indexes", ":/sql/Script/Migration/0005_mwl_entries_filter_indexes.sql", R"(
+                SELECT COUNT(*) FROM information_schema.STATISTICS
+                WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'mwl_entries' AND INDEX_NAME = 'idx_mwl_entries_profile_status'
+            )" },
+            { 6, "entity_status materialized current status", ":/sql/Script/Migration/0006_entity_current_status.sql", QString() },
+            { 7, "write journal applied entries", ":/sql/Script/Migration/0007_journal_applied_entries.sql", R"(
+                SELECT COUNT(*) FROM information_schema.TABLES
+                WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'journal_applied_entries'
+            )" },
+            { 8, "patients, studies and series unique keys", ":/sql/Script/Migration/0008_dicom_hierarchy_unique_keys.sql", R"(
+                SELECT COUNT(*) FROM information_schema.STATISTICS
+                WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'series' AND INDEX_NAME = 'uq_series_series_instance_uid'
+            )" },
+            { 9, "entity_status purge index", ":/sql/Script/Migration/0009_entity_status_transitioned_at_index.sql", R"(
+                SELECT COUNT(*) FROM information_schema.STATISTICS
+                WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'entity_status' AND INDEX_NAME = 'idx_entity_status_transitioned_at'
+            )" },
+            { 10, "mwl_entries source connection", ":/sql/Script/Migration/0010_mwl_entries_source_connection.sql", R"(
+                SELECT COUNT(*) FROM information_schema.COLUMNS
+                WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'mwl_entries' AND COLUMN_NAME = 'source_connection'
+            )" },
+            { 11, "profile tag matching values", ":/sql/Script/Migration/0011_profile_tag_matching_values.sql", R"(
+                SELECT COUNT(*) FROM information_schema.COLUMNS
+                WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'profile_tag_association' AND COLUMN_NAME = 'matching_value'
+            )" },
+            { 12, "mwl_entries RIS connections", ":/sql/Script/Migration/0012_mwl_entry_sources.sql", R"(
+                SELECT COUNT(*) FROM information_schema.TABLES
+                WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'mwl_entry_sources'
+            )" },
+        };
+    }
+
+    Result<int> SchemaMigrationRunner::run()
+    {
+        return run(migrations());
+    }
+
+    Result<int> SchemaMigrationRunner::run(const QList<SchemaMigration>& migrations)
+    {
+        auto tableResult = ensureMigrationTable();
+        if (!tableResult.isSuccess)
+            return Result<int>::Failure(tableResult.message);
+
+        auto appliedResult = appliedChecksums();
+        if (!appliedResult.isSuccess)
+            return Result<int>::Failure(appliedResult.message);
+        const QMap<int, QString>& applied = appliedResult.value;
+
+        int executed = 0;
+        int latest = 0;
+        for (const SchemaMigration& migration : migrations) {
+            latest = qMax(latest, migration.Version);
+
+            QFile file(migration.ScriptPath);
+            if (!file.open(QIODevice::ReadOnly)) {
+                QString message = QString(translator->getErrorMessage(SQL_SCRIPT_FAILED_TO_OPEN_MSG)).arg(migration.ScriptPath);
+                qDebug() << message;
+                logger->LogError(message);
+                return Result<int>::Failure(message);
+            }
+            const QByteArray script = file.readAll();
+            const QString checksum = checksumOf(script);
+
+            auto appliedIt = applied.constFind(migration.Version);
+            if (appliedIt != applied.constEnd()) {
+                if (appliedIt.value() != checksum) {
+                    logger->LogWarning(translator->getWarningMessage(DB_MIGRATION_CHECKSUM_MISMATCH_WARNING)
+                        .arg(migration.Version).arg(migration.Name, appliedIt.value(), checksum));
+                }
+                continue;
+            }
+
+            auto presentResult = isPresent(migration);
+            if (!presentResult.isSuccess)
+                return Result<int>::Failure(presentResult.message);
+
+            if (presentResult.value) {
+                auto recordResult = record(migration, checksum, 0, true);
+                if (!recordResult.isSuccess)
+                    return Result<int>::Failure(recordResult.message);
+
+                logger->LogInfo(translator->getInfoMessage(DB_MIGRATION_BASELINED_MSG).arg(migration.Version).arg(migration.Name));
+                continue;
+            }
+
+            QElapsedTimer timer;
+            timer.start();
+
+            auto executeResult = executeScript(migration, script);
+            if (!executeResult.isSuccess)
+                return Result<int>::Failure(executeResult.message);
+
+            auto recordResult = record(migration, checksum, timer.elapsed(), false);
+            if (!recordResult.isSuccess)
+                return Result<int>::Failure(recordResult.message);
+
+            ++executed;
+            logger->LogInfo(translator->getInfoMessage(DB_MIGRATION_APPLIED_MSG)
+                .arg(migration.Version).arg(migration.Name).arg(timer.elapsed()));
+        }
+
+        if (executed == 0)
+            logger->LogInfo(translator->getInfoMessage(DB_MIGRATIONS_UP_TO_DATE_MSG).arg(latest));
+
+        return Result<int>::Success(executed);
+    }
+
+    QString SchemaMigrationRunner::checksumOf(const QByteArray& script)
+    {
+        return QString::fromLatin1(QCryptographicHash::hash(script, QCryptographicHash::Sha256).toHex());
+    }
+
+    Result<bool> SchemaMigrationRunner::ensureMigrationTable()
+    {
+        QSqlQuery query(m_db);
+        if (!query.exec(R"(
+            CREATE TABLE IF NOT EXISTS schema_migrations (
+                version INT PRIMARY KEY,                    -- SchemaMigration::Version
+                name VARCHAR(255) NOT NULL,
+                checksum CHAR(64) NOT NULL,                 -- SHA-256 of the script when it was applied
+                applied_at DATETIME NOT NULL,
+                execution_ms INT NOT NULL DEFAULT 0,
+                baselined BOOLEAN NOT NULL DEFAULT FALSE    -- Found already present, script not executed
+            )
+        )")) {
+            QString message = QString(translator->getErrorMessage(SQL_SCRIPT_EXECUTION_FAILED_ERROR_MSG)).arg(query.lastQuery(), query.lastError().text());
+            qDebug() << message;
+            logger->LogError(message);
+            return Result<bool>::Failure(message);
+        }
+        return Result<bool>::Success(true);
+    }
+
+    Result<QMap<int, QString>> SchemaMigrationRunner::appliedChecksums()
+    {
+        QMap<int, QString> applied;
+
+        QSqlQuery query(m_db);
+        if (!query.exec("SELECT version, checksum FROM schema_migrations")) {
+            QString message = QString(translator->getErrorMessage(SQL_SCRIPT_EXECUTION_FAILED_ERROR_MSG)).arg(query.lastQuery(), query.lastError().text());
+            qDebug() << message;
+            logger->LogError(message);
+            return Result<QMap<int, QString>>::Failure(message);
+        }
+
+        while (query.next())
+            applied.insert(query.value(0).toInt(), query.value(1).toString());
+
+        return Result<QMap<int, QString>>::Success(applied);
+    }
+
+    Result<bool> SchemaMigrationRunner::isPresent(const SchemaMigration& migration)
+    {
+        if (migration.PresenceQuery.isEmpty())
+            return Result<bool>::Success(false);
+
+        QSqlQuery query(m_db);
+        if (!query.exec(migration.PresenceQuery) || !query.next()) {
+            QString message = failure(migration, query.lastError().text());
+            qDebug() << message;
+            logger->LogError(message);
+            return Result<bool>::Failure(message);
+        }
+        return Result<bool>::Success(query.value(0).toInt() > 0);
+    }
+
+    Result<bool> SchemaMigrationRunner::executeScript(const SchemaMigration& migration, const QByteArray& script)
+    {
+        const QStringList statements = SqlScriptParser::splitStatements(QString::fromUtf8(script));
+
+        for (const QString& statement : statements) {
+            QSqlQuery query(m_db);
+            if (!query.exec(statement)) {
+                QString message = failure(migration, query.lastError().text());
+                qDebug() << message;
+                logger->LogError(message);
+                return Result<bool>::Failure(message);
+            }
+        }
+        return Result<bool>::Success(true);
+    }
+
+    Result<bool> SchemaMigrationRunner::record(const SchemaMigration& migration, const QString& checksum, qint64 elapsedMs, bool baselined)
+    {
+        QSqlQuery query(m_db);
+        query.prepare(R"(
+            INSERT INTO schema_migrations (version, name, checksum, applied_at, execution_ms, baselined)
+            VALUES (:version, :name, :checksum, :appliedAt, :executionMs, :baselined)
+        )");
+        query.bindValue(":version", migration.Version);
+        query.bindValue(":name", migration.Name);
+        query.bindValue(":checksum", checksum);
+        query.bindValue(":appliedAt", QDateTime::currentDateTime());
+        query.bindValue(":executionMs", static_cast<int>(elapsedMs));
+        query.bindValue(":baselined", baselined);
+
+        if (!query.exec()) {
+            QString message = failure(migration, query.lastError().text());
+            qDebug() << message;
+            logger->LogError(message);
+            return Result<bool>::Failure(message);
+        }
+        return Result<bool>::Success(true);
+    }
+
+    QString SchemaMigrationRunner::failure(const SchemaMigration& migration, const QString& reason) const
+    {
+        return translator->getErrorMessage(DB_MIGRATION_FAILED_ERROR).arg(migration.Version).arg(migration.Name, reason);
+    }
+
+} // namespace Etrek::Core::Repository
@@ -0,0 +1,95 @@
+#ifndef SCHEMAMIGRATIONRUNNER_H
+#define SCHEMAMIGRATIONRUNNER_H
+
+#include <memory>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QSqlDatabase>
+#include "Result.h"
+#include "TranslationProvider.h"
+#include "AppLogger.h"
+
+namespace Etrek::Core::Repository {
+
+    /**
+     * @brief One versioned schema change.
+     */
+    struct SchemaMigration {
+        int Version = 0;            ///< Applied in ascending order; never reused.
+        QString Name;               ///< Short description, stored with the applied version.
+        QString ScriptPath;         ///< Script resource; statements separated by ';'.
+        QString PresenceQuery;      ///< Returns a non-zero count when the change is already in the schema, e.g.
+                                    ///< because setup_database.sql created it. Empty if the migration must always run.
+    };
+
+    /**
+     * @class SchemaMigrationRunner
+     * @brief Brings an existing database up to the current schema with versioned migrations.
+     *
+     * Applied migrations are recorded in the schema_migrations table together with the SHA-256
+     * of their script. At startup the runner reads that table once; when every registered
+     * migration is recorded with a matching checksum nothing else is executed.
+     *
+     * A pending migration whose PresenceQuery reports the change as present is recorded as
+     * baselined instead of being run. This is the case on fresh databases, where
+     * setup_database.sql already contains the latest schema.
+     *
+     * A recorded migration whose script changed afterwards is reported and not re-run;
+     * schema changes always go into a new migration.
+     */
+    class SchemaMigrationRunner
+    {
+    public:
+        /**
+         * @brief Creates a runner working on @p db.
+         * @param db Open connection to the application database; must outlive the runner.
+         */
+        explicit SchemaMigrationRunner(QSqlDatabase& db);
+
+        /**
+         * @brief Returns the migrations shipped with the application, in version order.
+         */
+        static QList<SchemaMigration> migrations();
+
+        /**
+         * @brief Applies all pending shipped migrations.
+         * @return Result containing the number of migrations executed (baselined ones excluded).
+         */
+        Etrek::Specification::Result<int> run();
+
+        /**
+         * @brief Applies all pending migrations of @p migrations, which must be in version order.
+         * @return Result containing the number of migrations executed (baselined ones excluded).
+         */
+        Etrek::Specification::Result<int> run(const QList<SchemaMigration>& migrations);
+
+        /**
+         * @brief Returns the SHA-256 (hex) of a migration script.
+         */
+        static QString checksumOf(const QByteArray& script);
+
+    private:
+        Etrek::Specification::Result<bool> ensureMigrationTable();
+        Etrek::Specification::Result<QMap<int, QString>> appliedChecksums();
+        Etrek::Specification::Result<bool> isPresent(const SchemaMigration& migration);
+        Etrek::Specification::Result<bool> executeScript(const SchemaMigration& migration, const QByteArray& script);
+        Etrek::Specification::Result<bool> record(const SchemaMigration& migration, const QString& checksum, qint64 elapsedMs, bool baselined);
+        QString failure(const SchemaMigration& migration, const QString& reason) const;
+
+        QSqlDatabase& m_db;
+
+        /**
+         * @brief Pointer to the translation provider for localized messages (non-owning).
+         */
+        Etrek::Core::Globalization::TranslationProvider* translator;
+
+        /**
+         * @brief Shared pointer to the application logger.
+         */
+        std::shared_ptr<Etrek::Core::Log::AppLogger> logger;
+    };
+
+} // namespace Etrek::Core::Repository
+
+#endif // SCHEMAMIGRATIONRUNNER_H
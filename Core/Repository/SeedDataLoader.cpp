@@ -0,0 +1,167 @@
+#include "SeedDataLoader.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QDebug>
+#include "SqlScriptParser.h"
+#include "SqlDialect.h"
+#include "MessageKey.h"
+#include "AppLoggerFactory.h"
+
+namespace Etrek::Core::Repository {
+
+    using Etrek::Specification::Result;
+    using Etrek::Core::Globalization::TranslationProvider;
+    using Etrek::Core::Log::AppLoggerFactory;
+    using Etrek::Core::Log::LoggerProvider;
+
+    SeedDataLoader::SeedDataLoader(QSqlDatabase& db)
+        : m_db(db)
+    {
+        translator = &TranslationProvider::Instance();
+        AppLoggerFactory factory(LoggerProvider::Instance(), translator);
+        logger = factory.CreateLogger("SeedDataLoader");
+    }
+
+    void SeedDataLoader::setMaxStatementBytes(int bytes)
+    {
+        m_maxStatementBytes = qMax(1024, bytes);
+    }
+
+    int SeedDataLoader::maxStatementBytes() const
+    {
+        return m_maxStatementBytes;
+    }
+
+    QStringList SeedDataLoader::batchStatements(const QStringList& statements) const
+    {
+        QStringList batches;
+
+        QString pendingKey;     // Normalized head of the statement being built
+        QString pending;
+
+        auto flush = [&]() {
+            if (!pending.isEmpty())
+                batches << pending;
+            pending.clear();
+            pendingKey.clear();
+        };
+
+        for (const QString& statement : statements) {
+            QString head;
+            QString rows;
+            if (!SqlScriptParser::splitValuesInsert(statement, &head, &rows)) {
+                flush();
+                batches << statement;
+                continue;
+            }
+
+            const QString key = head.simplified().toUpper();
+            const bool fits = pending.size() + rows.size() + 2 <= m_maxStatementBytes;
+            if (!pending.isEmpty() && key == pendingKey && fits) {
+                pending += ",\n";
+                pending += rows;
+                continue;
+            }
+
+            flush();
+            pendingKey = key;
+            pending = head + "\n" + rows;
+        }
+        flush();
+
+        return batches;
+    }
+
+    Result<SeedLoadReport> SeedDataLoader::load(const QStringList& statements)
+    {
+        SeedLoadReport report;
+        if (statements.isEmpty())
+            return Result<SeedLoadReport>::Success(report);
+
+        const QStringList batches = batchStatements(statements);
+
+        if (!setForeignKeyChecks(false)) {
+            QString message = failure(QString(), m_db.lastError().text());
+            qDebug() << message;
+            logger->LogError(message);
+            return Result<SeedLoadReport>::Failure(message);
+        }
+
+        QElapsedTimer total;
+        total.start();
+
+        if (!m_db.transaction()) {
+            QString message = failure(QString(), m_db.lastError().text());
+            setForeignKeyChecks(true);
+            qDebug() << message;
+            logger->LogError(message);
+            return Result<SeedLoadReport>::Failure(message);
+        }
+
+        QHash<QString, int> tableIndex;
+        QSqlQuery query(m_db);
+        QElapsedTimer timer;
+
+        for (const QString& batch : batches) {
+            const QString table = SqlScriptParser::insertTable(batch);
+
+            timer.start();
+            if (!query.exec(batch)) {
+                QString message = failure(table, query.lastError().text());
+                m_db.rollback();
+                setForeignKeyChecks(true);
+                qDebug() << message;
+                logger->LogError(message);
+                return Result<SeedLoadReport>::Failure(message);
+            }
+            const qint64 elapsed = timer.elapsed();
+
+            auto it = tableIndex.constFind(table);
+            if (it == tableIndex.constEnd()) {
+                it = tableIndex.insert(table, report.Tables.size());
+                report.Tables.append(SeedTableTiming{ table });
+            }
+
+            SeedTableTiming& timing = report.Tables[it.value()];
+            ++timing.Statements;
+            timing.Rows += qMax(0, query.numRowsAffected());
+            timing.ElapsedMs += elapsed;
+            report.Rows += qMax(0, query.numRowsAffected());
+        }
+
+        if (!m_db.commit()) {
+            QString message = failure(QString(), m_db.lastError().text());
+            m_db.rollback();
+            setForeignKeyChecks(true);
+            qDebug() << message;
+            logger->LogError(message);
+            return Result<SeedLoadReport>::Failure(message);
+        }
+
+        setForeignKeyChecks(true);
+        report.ElapsedMs = total.elapsed();
+
+        for (const SeedTableTiming& timing : report.Tables) {
+            logger->LogInfo(translator->getInfoMessage(SEED_TABLE_LOADED_MSG)
+                .arg(timing.Table).arg(timing.Rows).arg(timing.Statements).arg(timing.ElapsedMs));
+        }
+        logger->LogInfo(translator->getInfoMessage(SEED_DATA_LOADED_MSG)
+            .arg(report.Rows).arg(report.Tables.size()).arg(report.ElapsedMs));
+
+        return Result<SeedLoadReport>::Success(report);
+    }
+
+    bool SeedDataLoader::setForeignKeyChecks(bool enabled)
+    {
+        QSqlQuery query(m_db);
+        return query.exec(SqlDialect::of(m_db).foreignKeyChecksStatement(enabled));
+    }
+
+    QString SeedDataLoader::failure(const QString& table, const QString& reason) const
+    {
+        return translator->getErrorMessage(SEED_DATA_LOAD_FAILED_ERROR).arg(table, reason);
+    }
+
+} // namespace Etrek::Core::Repository
@@ -0,0 +1,97 @@
+#ifndef SEEDDATALOADER_H
+#define SEEDDATALOADER_H
+
+#include <memory>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QSqlDatabase>
+#include "Result.h"
+#include "TranslationProvider.h"
+#include "AppLogger.h"
+
+namespace Etrek::Core::Repository {
+
+    /**
+     * @brief Load statistics of one seeded table.
+     */
+    struct SeedTableTiming {
+        QString Table;
+        int Statements = 0;     ///< Statements executed after merging
+        qint64 Rows = 0;        ///< Rows reported by the server
+        qint64 ElapsedMs = 0;
+    };
+
+    /**
+     * @brief Load statistics of one seed run, tables in first-seen order.
+     */
+    struct SeedLoadReport {
+        QList<SeedTableTiming> Tables;
+        qint64 Rows = 0;
+        qint64 ElapsedMs = 0;
+    };
+
+    /**
+     * @class SeedDataLoader
+     * @brief Loads the INSERT statements of the setup script (body parts, positioners, views,
+     *        procedures, technique parameters, ...) as one batched transaction.
+     *
+     * Consecutive "INSERT ... VALUES" statements that target the same table with the same column
+     * list are merged into multi-row statements of at most maxStatementBytes(). The whole load runs
+     * in a single transaction with foreign key checks switched off for the session, so rows
+     * are written without a commit or a parent lookup per statement. MySQL cannot defer
+     * constraints to commit, and the seed data is ordered parents first, so this is the
+     * equivalent. Unique checks stay on, so duplicate seed rows still fail the load.
+     *
+     * On failure the transaction is rolled back and the session setting restored.
+     */
+    class SeedDataLoader
+    {
+    public:
+        // Upper bound for a merged statement; well below the default max_allowed_packet
+        static constexpr int DEFAULT_MAX_STATEMENT_BYTES = 512 * 1024;
+
+        /**
+         * @brief Creates a loader working on @p db.
+         * @param db Open connection to the application database; must outlive the loader.
+         */
+        explicit SeedDataLoader(QSqlDatabase& db);
+
+        void setMaxStatementBytes(int bytes);
+        int maxStatementBytes() const;
+
+        /**
+         * @brief Merges @p statements into multi-row inserts where possible.
+         *
+         * Statement order is preserved; statements that cannot be merged are returned unchanged.
+         */
+        QStringList batchStatements(const QStringList& statements) const;
+
+        /**
+         * @brief Executes @p statements, in order, in one transaction and logs the time spent per table.
+         * @param statements INSERT statements as produced by SqlScriptParser::splitStatements().
+         * @return Result containing the per-table report.
+         */
+        Etrek::Specification::Result<SeedLoadReport> load(const QStringList& statements);
+
+    private:
+        bool setForeignKeyChecks(bool enabled);
+        QString failure(const QString& table, const QString& reason) const;
+
+        QSqlDatabase& m_db;
+        int m_maxStatementBytes = DEFAULT_MAX_STATEMENT_BYTES;
+
+        /**
+         * @brief Pointer to the translation provider for localized messages (non-owning).
+         */
+        Etrek::Core::Globalization::TranslationProvider* translator;
+
+        /**
+         * @brief Shared pointer to the application logger.
+         */
+        std::shared_ptr<Etrek::Core::Log::AppLogger> logger;
+    };
+
+} // namespace Etrek::Core::Repository
+
+#endif // SEEDDATALOADER_H
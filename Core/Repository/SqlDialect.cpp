@@ -0,0 +1,125 @@
+#include "SqlDialect.h"
+
+namespace Etrek::Core::Repository {
+
+    using Etrek::Core::Data::Model::StorageBackend;
+
+    namespace {
+        // MySQL prepared statements are limited to 65535 placeholders; SQLite builds since 3.32
+        // default SQLITE_MAX_VARIABLE_NUMBER to 32766.
+        constexpr int MYSQL_MAX_PLACEHOLDERS = 65535;
+        constexpr int SQLITE_MAX_PLACEHOLDERS = 32766;
+    }
+
+    SqlDialect::SqlDialect(StorageBackend backend)
+        : m_backend(backend)
+    {
+    }
+
+    SqlDialect SqlDialect::of(const QSqlDatabase& db)
+    {
+        return SqlDialect(db.driverName() == driverName(StorageBackend::Sqlite)
+            ? StorageBackend::Sqlite
+            : StorageBackend::MySql);
+    }
+
+    QString SqlDialect::driverName(StorageBackend backend)
+    {
+        return backend == StorageBackend::Sqlite ? QStringLiteral("QSQLITE") : QStringLiteral("QMYSQL");
+    }
+
+    QString SqlDialect::upsertClause(const QStringList& columns) const
+    {
+        QStringList assignments;
+        assignments.reserve(columns.size());
+
+        if (isSqlite()) {
+            for (const QString& column : columns)
+                assignments << QString("%1 = excluded.%1").arg(column);
+            return " ON CONFLICT DO UPDATE SET " + assignments.join(", ");
+        }
+
+        for (const QString& column : columns)
+            assignments << QString("%1 = VALUES(%1)").arg(column);
+        return " ON DUPLICATE KEY UPDATE " + assignments.join(", ");
+    }
+
+    QString SqlDialect::upsertIfGreaterClause(const QString& guardColumn, const QStringList& columns) const
+    {
+        QStringList ordered;
+        for (const QString& column : columns) {
+            if (column != guardColumn)
+                ordered << column;
+        }
+        if (columns.contains(guardColumn))
+            ordered << guardColumn;
+
+        QStringList assignments;
+        assignments.reserve(ordered.size());
+
+        if (isSqlite()) {
+            for (const QString& column : ordered)
+                assignments << QString("%1 = excluded.%1").arg(column);
+            return QString(" ON CONFLICT DO UPDATE SET %1 WHERE excluded.%2 > %2").arg(assignments.join(", "), guardColumn);
+        }
+
+        for (const QString& column : ordered)
+            assignments << QString("%1 = IF(VALUES(%2) > %2, VALUES(%1), %1)").arg(column, guardColumn);
+        return " ON DUPLICATE KEY UPDATE " + assignments.join(", ");
+    }
+
+    QString SqlDialect::upsertReturningIdClause(const QString& idColumn, const QStringList& columns) const
+    {
+        if (isSqlite())
+            return upsertClause(columns) + " RETURNING " + idColumn;
+
+        // LAST_INSERT_ID(expr) makes an update report the existing row's id like an insert does
+        QStringList assignments{ QString("%1 = LAST_INSERT_ID(%1)").arg(idColumn) };
+        for (const QString& column : columns)
+            assignments << QString("%1 = VALUES(%1)").arg(column);
+        return " ON DUPLICATE KEY UPDATE " + assignments.join(", ");
+    }
+
+    int SqlDialect::upsertedId(QSqlQuery& query)
+    {
+        int id = -1;
+        if (query.isSelect() && query.next())
+            id = query.value(0).toInt();
+        else if (query.lastInsertId().isValid())
+            id = query.lastInsertId().toInt();
+        query.finish();
+        return id;
+    }
+
+    QString SqlDialect::lockRowsClause() const
+    {
+        return isSqlite() ? QString() : QStringLiteral(" FOR UPDATE");
+    }
+
+    QString SqlDialect::currentTimestamp() const
+    {
+        // SQLite stores date-times as text; use the format Qt binds QDateTime values with so
+        // that stored values compare and sort correctly.
+        return isSqlite() ? QStringLiteral("strftime('%Y-%m-%dT%H:%M:%f', 'now', 'localtime')") : QStringLiteral("NOW()");
+    }
+
+    QString SqlDialect::foreignKeyChecksStatement(bool enabled) const
+    {
+        if (isSqlite())
+            return QString("PRAGMA foreign_keys = %1").arg(enabled ? "ON" : "OFF");
+        return QString("SET SESSION foreign_key_checks = %1").arg(enabled ? 1 : 0);
+    }
+
+    QString SqlDialect::listTablesStatement() const
+    {
+        if (isSqlite())
+            return QStringLiteral("SELECT name FROM sqlite_master WHERE type = 'table' AND name NOT LIKE 'sqlite_%'");
+        return QStringLiteral("SHOW TABLES");
+    }
+
+    int SqlDialect::maxPlaceholders() const
+    {
+        return isSqlite() ? SQLITE_MAX_PLACEHOLDERS : MYSQL_MAX_PLACEHOLDERS;
+    }
+
+} // namespace Etrek::Core::Repository
@@ -0,0 +1,108 @@
+#ifndef SQLDIALECT_H
+#define SQLDIALECT_H
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QString>
+#include <QStringList>
+#include "DatabaseConnectionSetting.h"
+
+namespace Etrek::Core::Repository {
+
+    /**
+     * @class SqlDialect
+     * @brief The few SQL constructs that differ between the MySQL and SQLite backends.
+     *
+     * Repositories write portable SQL and ask the dialect of their connection only for the
+     * pieces that have no common spelling: upserts, row locks, the current time and the
+     * server limits used to size batched statements.
+     *
+     * SQLite upserts use `ON CONFLICT DO UPDATE` without a conflict target, which needs
+     * SQLite 3.35 or later (Qt 6.5 ships 3.41).
+     */
+    class SqlDialect
+    {
+    public:
+        explicit SqlDialect(Etrek::Core::Data::Model::StorageBackend backend);
+
+        /**
+         * @brief Returns the dialect of an open or configured connection, by its driver.
+         */
+        static SqlDialect of(const QSqlDatabase& db);
+
+        /**
+         * @brief Returns the Qt SQL driver name for @p backend ("QMYSQL" or "QSQLITE").
+         */
+        static QString driverName(Etrek::Core::Data::Model::StorageBackend backend);
+
+        Etrek::Core::Data::Model::StorageBackend backend() const { return m_backend; }
+        bool isSqlite() const { return m_backend == Etrek::Core::Data::Model::StorageBackend::Sqlite; }
+
+        /**
+         * @brief Clause appended to an INSERT so that a key conflict overwrites @p columns.
+         *
+         * MySQL: `ON DUPLICATE KEY UPDATE c = VALUES(c)`. SQLite: `ON CONFLICT DO UPDATE SET c = excluded.c`.
+         */
+        QString upsertClause(const QStringList& columns) const;
+
+        /**
+         * @brief Like upsertClause(), but a key conflict only overwrites the stored row when the
+         *        new value of @p guardColumn is greater than the stored one.
+         *
+         * Keeps a row that tracks the latest of something (e.g. the highest history id) from being
+         * set back by a write that commits later but carries an older value. @p guardColumn may be
+         * one of @p columns.
+         *
+         * MySQL: `c = IF(VALUES(g) > g, VALUES(c), c)`, with @p guardColumn assigned last because
+         * MySQL evaluates the assignments in order. SQLite: `DO UPDATE SET c = excluded.c WHERE excluded.g > g`.
+         */
+        QString upsertIfGreaterClause(const QString& guardColumn, const QStringList& columns) const;
+
+        /**
+         * @brief Like upsertClause(), but the statement also reports the id of the row it wrote,
+         *        whether inserted or updated.
+         *
+         * MySQL sets the row's @p idColumn as LAST_INSERT_ID(), read with QSqlQuery::lastInsertId().
+         * SQLite appends `RETURNING`, so the id is the single result row. Read it with upsertedId().
+         */
+        QString upsertReturningIdClause(const QString& idColumn, const QStringList& columns) const;
+
+        /**
+         * @brief Id reported by a statement built with upsertReturningIdClause(), or -1.
+         */
+        static int upsertedId(QSqlQuery& query);
+
+        /**
+         * @brief Suffix of a SELECT that locks the rows it reads until the transaction ends.
+         *
+         * Empty on SQLite, where ConnectionLease::transaction() takes the database write lock up front.
+         */
+        QString lockRowsClause() const;
+
+        /**
+         * @brief Expression for the current local date and time.
+         */
+        QString currentTimestamp() const;
+
+        /**
+         * @brief Statement that disables or re-enables foreign key enforcement for the session.
+         */
+        QString foreignKeyChecksStatement(bool enabled) const;
+
+        /**
+         * @brief Query returning one row per user table of the connected database.
+         */
+        QString listTablesStatement() const;
+
+        /**
+         * @brief Maximum number of placeholders in one prepared statement.
+         */
+        int maxPlaceholders() const;
+
+    private:
+        Etrek::Core::Data::Model::StorageBackend m_backend;
+    };
+
+} // namespace Etrek::Core::Repository
+
+#endif // SQLDIALECT_H
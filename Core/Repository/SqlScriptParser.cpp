@@ -0,0 +1,199 @@
+#include "SqlScriptParser.h"
+#include <QRegularExpression>
+
+namespace Etrek::Core::Repository {
+
+    namespace {
+
+        bool isQuote(QChar c)
+        {
+            return c == '\'' || c == '"' || c == '`';
+        }
+
+        // Returns the index just past the quoted token starting at @p start
+        int skipQuoted(const QString& text, int start)
+        {
+            const QChar quote = text[start];
+            int i = start + 1;
+            while (i < text.size()) {
+                const QChar c = text[i];
+                if (c == '\\' && quote != '`') {
+                    i += 2;
+                    continue;
+                }
+                if (c == quote) {
+                    if (i + 1 < text.size() && text[i + 1] == quote) {
+                        i += 2;
+                        continue;
+                    }
+                    return i + 1;
+                }
+                ++i;
+            }
+            return text.size();
+        }
+
+        bool startsLineComment(const QString& text, int i)
+        {
+            if (text[i] == '#')
+                return true;
+            // MySQL requires whitespace (or the end) after "--"
+            return text[i] == '-' && i + 1 < text.size() && text[i + 1] == '-'
+                && (i + 2 >= text.size() || text[i + 2].isSpace());
+        }
+
+        bool isWordAt(const QString& text, int i, const QString& word)
+        {
+            if (text.mid(i, word.size()).compare(word, Qt::CaseInsensitive) != 0)
+                return false;
+            const bool startBoundary = i == 0 || !(text[i - 1].isLetterOrNumber() || text[i - 1] == '_');
+            const int end = i + word.size();
+            const bool endBoundary = end >= text.size() || !(text[end].isLetterOrNumber() || text[end] == '_');
+            return startBoundary && endBoundary;
+        }
+
+        // True while @p statement is a CREATE TRIGGER whose BEGIN ... END body is still open,
+        // so that the ';' ending each statement of the body does not end the trigger
+        bool isInsideTriggerBody(const QString& statement)
+        {
+            static const QRegularExpression createTrigger(
+                R"(^\s*CREATE\s+(?:TEMP\s+|TEMPORARY\s+)?TRIGGER\b)",
+                QRegularExpression::CaseInsensitiveOption);
+            static const QRegularExpression bodyBegin(R"(\bBEGIN\b)", QRegularExpression::CaseInsensitiveOption);
+            static const QRegularExpression bodyEnd(R"(\bEND\s*$)", QRegularExpression::CaseInsensitiveOption);
+
+            return createTrigger.match(statement).hasMatch()
+                && bodyBegin.match(statement).hasMatch()
+                && !bodyEnd.match(statement).hasMatch();
+        }
+    }
+
+    QStringList SqlScriptParser::splitStatements(const QString& script)
+    {
+        QStringList statements;
+        QString current;
+
+        auto finishStatement = [&]() {
+            const QString trimmed = current.trimmed();
+            if (!trimmed.isEmpty())
+                statements << trimmed;
+            current.clear();
+        };
+
+        int i = 0;
+        while (i < script.size()) {
+            const QChar c = script[i];
+
+            if (isQuote(c)) {
+                const int end = skipQuoted(script, i);
+                current += script.mid(i, end - i);
+                i = end;
+            }
+            else if (startsLineComment(script, i)) {
+                const int end = script.indexOf('\n', i);
+                i = end < 0 ? script.size() : end;
+            }
+            else if (c == '/' && i + 1 < script.size() && script[i + 1] == '*') {
+                const int end = script.indexOf("*/", i + 2);
+                i = end < 0 ? script.size() : end + 2;
+                current += ' ';
+            }
+            else if (c == ';' && isInsideTriggerBody(current)) {
+                current += c;
+                ++i;
+            }
+            else if (c == ';') {
+                finishStatement();
+                ++i;
+            }
+            else if (c == QChar(0xFEFF)) {
+                ++i;  // Byte order mark
+            }
+            else {
+                current += c;
+                ++i;
+            }
+        }
+        finishStatement();
+
+        return statements;
+    }
+
+    QString SqlScriptParser::insertTable(const QString& statement)
+    {
+        static const QRegularExpression insertInto(
+            R"(^INSERT\s+(?:IGNORE\s+)?INTO\s+`?([A-Za-z0-9_$.]+)`?)",
+            QRegularExpression::CaseInsensitiveOption);
+
+        const QRegularExpressionMatch match = insertInto.match(statement);
+        return match.hasMatch() ? match.captured(1) : QString();
+    }
+
+    bool SqlScriptParser::splitValuesInsert(const QString& statement, QString* head, QString* rows)
+    {
+        if (insertTable(statement).isEmpty())
+            return false;
+
+        // Locate VALUES outside quotes and parentheses
+        int depth = 0;
+        int valuesAt = -1;
+        for (int i = 0; i < statement.size() && valuesAt < 0;) {
+            const QChar c = statement[i];
+            if (isQuote(c)) {
+                i = skipQuoted(statement, i);
+                continue;
+            }
+            if (c == '(')
+                ++depth;
+            else if (c == ')')
+                --depth;
+            else if (depth == 0 && isWordAt(statement, i, "VALUES"))
+                valuesAt = i;
+            ++i;
+        }
+        if (valuesAt < 0)
+            return false;
+
+        const int rowsAt = valuesAt + 6;
+
+        // The rest must be "(...)" tuples separated by commas and nothing else
+        bool expectTuple = true;
+        depth = 0;
+        for (int i = rowsAt; i < statement.size();) {
+            const QChar c = statement[i];
+            if (depth > 0) {
+                if (isQuote(c)) {
+                    i = skipQuoted(statement, i);
+                    continue;
+                }
+                if (c == '(')
+                    ++depth;
+                else if (c == ')')
+                    --depth;
+            }
+            else if (c.isSpace()) {
+                // Between tuples
+            }
+            else if (c == '(' && expectTuple) {
+                depth = 1;
+                expectTuple = false;
+            }
+            else if (c == ',' && !expectTuple) {
+                expectTuple = true;
+            }
+            else {
+                return false;
+            }
+            ++i;
+        }
+        if (expectTuple || depth != 0)
+            return false;
+
+        if (head)
+            *head = statement.left(rowsAt);
+        if (rows)
+            *rows = statement.mid(rowsAt).trimmed();
+        return true;
+    }
+
+} // namespace Etrek::Core::Repository
@@ -0,0 +1,45 @@
+#ifndef SQLSCRIPTPARSER_H
+#define SQLSCRIPTPARSER_H
+
+#include <QString>
+#include <QStringList>
+
+namespace Etrek::Core::Repository {
+
+    /**
+     * @class SqlScriptParser
+     * @brief Splits MySQL and SQLite scripts into statements and inspects INSERT statements.
+     *
+     * Quoted strings and identifiers are honored, so a ';' inside a value does not end a
+     * statement. Comments ("-- ", "#" and block comments) are removed. A SQLite
+     * CREATE TRIGGER ... BEGIN ... END is kept as one statement; the body must not contain
+     * a CASE expression ending a statement. DELIMITER blocks are not supported; the shipped
+     * scripts do not use them.
+     */
+    class SqlScriptParser
+    {
+    public:
+        /**
+         * @brief Splits @p script into trimmed statements without their terminating ';'.
+         */
+        static QStringList splitStatements(const QString& script);
+
+        /**
+         * @brief Returns the target table of an INSERT statement, or an empty string for other statements.
+         */
+        static QString insertTable(const QString& statement);
+
+        /**
+         * @brief Splits "INSERT ... VALUES (..), (..)" into its head and row tuples.
+         * @param statement Statement as returned by splitStatements().
+         * @param head Receives everything up to and including VALUES.
+         * @param rows Receives the comma separated tuples.
+         * @return False if the statement is not a plain VALUES insert (INSERT ... SELECT,
+         *         ON DUPLICATE KEY UPDATE, ...), in which case it cannot be merged with others.
+         */
+        static bool splitValuesInsert(const QString& statement, QString* head, QString* rows);
+    };
+
+} // namespace Etrek::Core::Repository
+
+#endif // SQLSCRIPTPARSER_H
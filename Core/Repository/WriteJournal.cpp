@@ -0,0 +1,450 @@
+#include "WriteJournal.h"
+#include <array>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QDir>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QUuid>
+#include "MessageKey.h"
+#include "AppLoggerFactory.h"
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace Etrek::Core::Repository {
+
+    using Etrek::Specification::Result;
+    using Etrek::Core::Globalization::TranslationProvider;
+    using Etrek::Core::Log::AppLoggerFactory;
+    using Etrek::Core::Log::LoggerProvider;
+
+    namespace {
+
+        // Header: magic, format version, journal id (RFC 4122 bytes)
+        constexpr quint32 JOURNAL_MAGIC = 0x45544A4C;     // "ETJL"
+        constexpr quint32 JOURNAL_VERSION = 1;
+        constexpr qint64 HEADER_SIZE = 4 + 4 + 16;
+
+        // Record frame: marker, payload length, sequence, CRC-32 of sequence and payload
+        constexpr quint32 RECORD_MARKER = 0x52454331;     // "REC1"
+        constexpr qint64 FRAME_HEADER_SIZE = 4 + 4 + 8 + 4;
+        constexpr quint32 MAX_PAYLOAD_BYTES = 16 * 1024 * 1024;
+
+        enum class Frame { Complete, End, Torn };
+
+        quint32 crc32(qint64 sequence, const QByteArray& payload)
+        {
+            static const std::array<quint32, 256> table = [] {
+                std::array<quint32, 256> t{};
+                for (quint32 i = 0; i < 256; ++i) {
+                    quint32 c = i;
+                    for (int k = 0; k < 8; ++k)
+                        c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                    t[i] = c;
+                }
+                return t;
+            }();
+
+            quint32 crc = 0xFFFFFFFFu;
+            auto feed = [&crc](const char* data, qint64 size) {
+                for (qint64 i = 0; i < size; ++i)
+                    crc = table[(crc ^ quint8(data[i])) & 0xFF] ^ (crc >> 8);
+            };
+
+            QByteArray sequenceBytes;
+            QDataStream(&sequenceBytes, QIODevice::WriteOnly) << sequence;
+            feed(sequenceBytes.constData(), sequenceBytes.size());
+            feed(payload.constData(), payload.size());
+            return crc ^ 0xFFFFFFFFu;
+        }
+
+        Frame readFrame(QFile& file, qint64 offset, JournalRecord& record, qint64& next)
+        {
+            if (!file.seek(offset))
+                return Frame::Torn;
+
+            const QByteArray head = file.read(FRAME_HEADER_SIZE);
+            if (head.isEmpty())
+                return Frame::End;
+            if (head.size() < FRAME_HEADER_SIZE)
+                return Frame::Torn;
+
+            quint32 marker = 0;
+            quint32 length = 0;
+            qint64 sequence = 0;
+            quint32 checksum = 0;
+            QDataStream in(head);
+            in >> marker >> length >> sequence >> checksum;
+            if (marker != RECORD_MARKER || length > MAX_PAYLOAD_BYTES)
+                return Frame::Torn;
+
+            const QByteArray body = file.read(length);
+            if (body.size() != int(length) || crc32(sequence, body) != checksum)
+                return Frame::Torn;
+
+            const QJsonDocument document = QJsonDocument::fromJson(body);
+            if (!document.isObject())
+                return Frame::Torn;
+
+            record.Sequence = sequence;
+            record.Kind = document.object().value("kind").toString();
+            record.Payload = document.object().value("payload").toObject();
+            next = offset + FRAME_HEADER_SIZE + length;
+            return Frame::Complete;
+        }
+
+        bool syncToDisk(QFile& file)
+        {
+            if (!file.flush())
+                return false;
+#ifdef Q_OS_WIN
+            return _commit(file.handle()) == 0;
+#else
+            return ::fsync(file.handle()) == 0;
+#endif
+        }
+    }
+
+    WriteJournal::WriteJournal(QString filePath)
+        : m_filePath(std::move(filePath))
+        , m_file(m_filePath)
+    {
+        translator = &TranslationProvider::Instance();
+        AppLoggerFactory factory(LoggerProvider::Instance(), translator);
+        logger = factory.CreateLogger("WriteJournal");
+    }
+
+    WriteJournal::~WriteJournal()
+    {
+        close();
+    }
+
+    Result<int> WriteJournal::open()
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_file.isOpen())
+            return Result<int>::Success(int(m_lastSequence - m_appliedSequence));
+
+        QDir().mkpath(QFileInfo(m_filePath).absolutePath());
+        if (!m_file.open(QIODevice::ReadWrite | QIODevice::Unbuffered)) {
+            const QString error = translator->getErrorMessage(WRITE_JOURNAL_OPEN_FAILED_ERROR)
+                .arg(m_filePath, m_file.errorString());
+            logger->LogError(error);
+            return Result<int>::Failure(error);
+        }
+
+        auto recovered = recover();
+        if (!recovered.isSuccess) {
+            m_file.close();
+            logger->LogError(recovered.message);
+            return Result<int>::Failure(recovered.message);
+        }
+
+        auto checkpoint = readCheckpoint();
+        if (!checkpoint.isSuccess)
+            logger->LogWarning(checkpoint.message);
+
+        // A compacted journal holds no records; numbering carries on after the checkpoint
+        m_lastSequence = qMax(m_lastSequence, m_appliedSequence);
+        m_cursorSequence = -1;
+        m_pendingRecords = 0;
+
+        const int unapplied = int(m_lastSequence - m_appliedSequence);
+        if (unapplied > 0)
+            logger->LogInfo(translator->getInfoMessage(WRITE_JOURNAL_RECORDS_PENDING_MSG).arg(m_filePath).arg(unapplied));
+        return Result<int>::Success(unapplied);
+    }
+
+    void WriteJournal::close()
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_file.isOpen())
+            return;
+        syncLocked();
+        m_file.close();
+    }
+
+    bool WriteJournal::isOpen() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_file.isOpen();
+    }
+
+    void WriteJournal::setSyncPolicy(int maxPendingRecords, int maxDelayMs)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_maxPendingRecords = qMax(1, maxPendingRecords);
+        m_maxDelayMs = qMax(0, maxDelayMs);
+    }
+
+    Result<qint64> WriteJournal::append(const QString& kind, const QJsonObject& payload)
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_file.isOpen()) {
+            const QString error = translator->getErrorMessage(WRITE_JOURNAL_APPEND_FAILED_ERROR).arg(m_filePath, "journal is not open");
+            logger->LogError(error);
+            return Result<qint64>::Failure(error);
+        }
+
+        const qint64 sequence = m_lastSequence + 1;
+        const QByteArray body = QJsonDocument(QJsonObject{ { "kind", kind }, { "payload", payload } })
+            .toJson(QJsonDocument::Compact);
+
+        QByteArray frame;
+        frame.reserve(int(FRAME_HEADER_SIZE) + body.size());
+        {
+            QDataStream out(&frame, QIODevice::WriteOnly);
+            out << RECORD_MARKER << quint32(body.size()) << sequence << crc32(sequence, body);
+        }
+        frame.append(body);
+
+        const qint64 end = m_file.size();
+        if (!m_file.seek(end) || m_file.write(frame) != frame.size()) {
+            const QString error = translator->getErrorMessage(WRITE_JOURNAL_APPEND_FAILED_ERROR).arg(m_filePath, m_file.errorString());
+            m_file.resize(end);
+            logger->LogError(error);
+            return Result<qint64>::Failure(error);
+        }
+        m_lastSequence = sequence;
+
+        if (m_pendingRecords++ == 0)
+            m_oldestPending.start();
+        // The record is with the operating system already; a failed sync is logged and retried
+        // with the next batch rather than reported as a lost write.
+        if (m_pendingRecords >= m_maxPendingRecords || m_oldestPending.elapsed() >= m_maxDelayMs)
+            syncLocked();
+
+        return Result<qint64>::Success(sequence);
+    }
+
+    Result<bool> WriteJournal::sync()
+    {
+        QMutexLocker locker(&m_mutex);
+        return syncLocked();
+    }
+
+    void WriteJournal::syncIfDue()
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_pendingRecords > 0 && m_oldestPending.elapsed() >= m_maxDelayMs)
+            syncLocked();
+    }
+
+    Result<QVector<JournalRecord>> WriteJournal::readAfter(qint64 sequence, int maxRecords)
+    {
+        QMutexLocker locker(&m_mutex);
+        QVector<JournalRecord> records;
+        if (!m_file.isOpen() || sequence >= m_lastSequence)
+            return Result<QVector<JournalRecord>>::Success(records);
+
+        qint64 offset = sequence == m_cursorSequence ? m_cursorOffset : HEADER_SIZE;
+        while (records.size() < maxRecords) {
+            JournalRecord record;
+            qint64 next = 0;
+            const Frame frame = readFrame(m_file, offset, record, next);
+            if (frame == Frame::End)
+                break;
+            if (frame == Frame::Torn) {
+                const QString error = translator->getErrorMessage(WRITE_JOURNAL_CORRUPT_ERROR).arg(m_filePath).arg(offset);
+                logger->LogError(error);
+                return Result<QVector<JournalRecord>>::Failure(error);
+            }
+
+            offset = next;
+            if (record.Sequence > sequence)
+                records.push_back(std::move(record));
+        }
+
+        m_cursorSequence = records.isEmpty() ? sequence : records.last().Sequence;
+        m_cursorOffset = offset;
+        return Result<QVector<JournalRecord>>::Success(records);
+    }
+
+    Result<bool> WriteJournal::markApplied(qint64 sequence)
+    {
+        QMutexLocker locker(&m_mutex);
+        if (sequence <= m_appliedSequence)
+            return Result<bool>::Success(true);
+
+        auto saved = writeCheckpoint(sequence);
+        if (!saved.isSuccess)
+            return saved;
+        m_appliedSequence = sequence;
+
+        // Everything applied: cut the journal back to a header with a new id. A crash between
+        // the two leaves a checkpoint of the old id, which open() ignores for the empty journal.
+        if (m_appliedSequence == m_lastSequence && m_file.isOpen() && m_file.size() > HEADER_SIZE) {
+            auto header = writeHeader();
+            if (!header.isSuccess) {
+                logger->LogError(header.message);
+                return header;
+            }
+            m_cursorSequence = -1;
+            m_pendingRecords = 0;
+            return writeCheckpoint(m_appliedSequence);
+        }
+        return Result<bool>::Success(true);
+    }
+
+    Result<bool> WriteJournal::reject(const JournalRecord& record, const QString& reason)
+    {
+        QMutexLocker locker(&m_mutex);
+        QFile rejected(rejectedFilePath());
+        const QByteArray line = QJsonDocument(QJsonObject{
+            { "journalId", m_journalId },
+            { "sequence", record.Sequence },
+            { "kind", record.Kind },
+            { "payload", record.Payload },
+            { "reason", reason },
+            { "rejectedAt", QDateTime::currentDateTime().toString(Qt::ISODateWithMs) } })
+            .toJson(QJsonDocument::Compact) + '\n';
+
+        if (!rejected.open(QIODevice::WriteOnly | QIODevice::Append) || rejected.write(line) != line.size() || !syncToDisk(rejected)) {
+            const QString error = translator->getErrorMessage(WRITE_JOURNAL_APPEND_FAILED_ERROR)
+                .arg(rejectedFilePath(), rejected.errorString());
+            logger->LogError(error);
+            return Result<bool>::Failure(error);
+        }
+        return Result<bool>::Success(true);
+    }
+
+    QString WriteJournal::journalId() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_journalId;
+    }
+
+    QString WriteJournal::filePath() const
+    {
+        return m_filePath;
+    }
+
+    QString WriteJournal::rejectedFilePath() const
+    {
+        return m_filePath + ".rejected";
+    }
+
+    qint64 WriteJournal::lastSequence() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_lastSequence;
+    }
+
+    qint64 WriteJournal::appliedSequence() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_appliedSequence;
+    }
+
+    Result<bool> WriteJournal::syncLocked()
+    {
+        if (m_pendingRecords == 0 || !m_file.isOpen())
+            return Result<bool>::Success(true);
+
+        if (!syncToDisk(m_file)) {
+            const QString error = translator->getErrorMessage(WRITE_JOURNAL_SYNC_FAILED_ERROR).arg(m_filePath, m_file.errorString());
+            logger->LogError(error);
+            return Result<bool>::Failure(error);
+        }
+        m_pendingRecords = 0;
+        return Result<bool>::Success(true);
+    }
+
+    Result<bool> WriteJournal::writeHeader()
+    {
+        m_journalId = QUuid::createUuid().toString(QUuid::WithoutBraces);
+
+        QByteArray header;
+        {
+            QDataStream out(&header, QIODevice::WriteOnly);
+            out << JOURNAL_MAGIC << JOURNAL_VERSION;
+        }
+        header.append(QUuid(m_journalId).toRfc4122());
+
+        if (!m_file.resize(0) || !m_file.seek(0) || m_file.write(header) != header.size() || !syncToDisk(m_file))
+            return Result<bool>::Failure(translator->getErrorMessage(WRITE_JOURNAL_OPEN_FAILED_ERROR).arg(m_filePath, m_file.errorString()));
+        return Result<bool>::Success(true);
+    }
+
+    Result<bool> WriteJournal::recover()
+    {
+        m_lastSequence = 0;
+
+        // A new file, or one cut short while its header was written
+        const QByteArray header = m_file.read(HEADER_SIZE);
+        if (header.size() < HEADER_SIZE)
+            return writeHeader();
+
+        quint32 magic = 0;
+        quint32 version = 0;
+        QDataStream(header) >> magic >> version;
+        if (magic != JOURNAL_MAGIC || version != JOURNAL_VERSION)
+            return Result<bool>::Failure(translator->getErrorMessage(WRITE_JOURNAL_OPEN_FAILED_ERROR)
+                .arg(m_filePath, "not a write journal of this version"));
+        m_journalId = QUuid::fromRfc4122(header.mid(8, 16)).toString(QUuid::WithoutBraces);
+
+        qint64 offset = HEADER_SIZE;
+        for (;;) {
+            JournalRecord record;
+            qint64 next = 0;
+            if (readFrame(m_file, offset, record, next) != Frame::Complete)
+                break;
+            m_lastSequence = record.Sequence;
+            offset = next;
+        }
+
+        // Whatever follows the last complete record is a write cut short by a crash
+        const qint64 size = m_file.size();
+        if (offset < size) {
+            logger->LogWarning(translator->getWarningMessage(WRITE_JOURNAL_TORN_RECORD_WARNING)
+                .arg(m_filePath).arg(size - offset).arg(offset));
+            if (!m_file.resize(offset) || !syncToDisk(m_file))
+                return Result<bool>::Failure(translator->getErrorMessage(WRITE_JOURNAL_OPEN_FAILED_ERROR).arg(m_filePath, m_file.errorString()));
+        }
+        return Result<bool>::Success(true);
+    }
+
+    Result<bool> WriteJournal::readCheckpoint()
+    {
+        m_appliedSequence = 0;
+
+        QFile checkpoint(checkpointPath());
+        if (!checkpoint.exists())
+            return Result<bool>::Success(true);
+        if (!checkpoint.open(QIODevice::ReadOnly))
+            return Result<bool>::Failure(translator->getErrorMessage(WRITE_JOURNAL_CHECKPOINT_FAILED_ERROR)
+                .arg(checkpointPath(), checkpoint.errorString()));
+
+        // A checkpoint of another journal (e.g. the journal file was replaced) does not apply
+        const QJsonObject content = QJsonDocument::fromJson(checkpoint.readAll()).object();
+        if (content.value("journalId").toString() == m_journalId)
+            m_appliedSequence = qint64(content.value("appliedSequence").toDouble());
+        return Result<bool>::Success(true);
+    }
+
+    Result<bool> WriteJournal::writeCheckpoint(qint64 sequence)
+    {
+        QSaveFile checkpoint(checkpointPath());
+        const QByteArray content = QJsonDocument(QJsonObject{
+            { "journalId", m_journalId },
+            { "appliedSequence", sequence } }).toJson(QJsonDocument::Compact);
+        if (!checkpoint.open(QIODevice::WriteOnly) || checkpoint.write(content) != content.size() || !checkpoint.commit()) {
+            const QString error = translator->getErrorMessage(WRITE_JOURNAL_CHECKPOINT_FAILED_ERROR)
+                .arg(checkpointPath(), checkpoint.errorString());
+            logger->LogError(error);
+            return Result<bool>::Failure(error);
+        }
+        return Result<bool>::Success(true);
+    }
+
+    QString WriteJournal::checkpointPath() const
+    {
+        return m_filePath + ".checkpoint";
+    }
+
+} // namespace Etrek::Core::Repository
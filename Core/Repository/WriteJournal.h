@@ -0,0 +1,157 @@
+#ifndef WRITEJOURNAL_H
+#define WRITEJOURNAL_H
+
+#include <memory>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonObject>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include "Result.h"
+#include "TranslationProvider.h"
+#include "AppLogger.h"
+
+namespace Etrek::Core::Repository {
+
+    /**
+     * @brief One write recorded in the journal.
+     */
+    struct JournalRecord {
+        qint64 Sequence = 0;    ///< Position in the journal, starting at 1 and never reused
+        QString Kind;           ///< Operation name a JournalApplier handler is registered for
+        QJsonObject Payload;    ///< Operation arguments
+    };
+
+    /**
+     * @class WriteJournal
+     * @brief Append-only local file of repository writes waiting to be applied to the database.
+     *
+     * The acquisition path appends a record instead of waiting for a database round trip;
+     * JournalApplier replays the records into the repositories in the background.
+     *
+     * The file starts with a header holding a random journal id, followed by records framed as
+     * marker, payload length, sequence number and CRC-32. A record is handed to the operating
+     * system before append() returns, so it survives a crash of the application. It reaches
+     * the disk with the next fsync, which is batched: append() syncs once maxPendingRecords
+     * records are waiting or the oldest of them is maxDelayMs old, and syncIfDue() covers the
+     * time between appends. open() drops a torn record left at the end by a power loss.
+     *
+     * The sequence of the last applied record is kept in a checkpoint file next to the journal
+     * (`<journal>.checkpoint`). Once everything is applied the journal is cut back to a new
+     * header with a new journal id; sequence numbers carry on from the checkpoint. The new id
+     * keeps the keys of later records apart from those already in journal_applied_entries,
+     * even when the checkpoint is lost. Records that can never be applied are moved to
+     * `<journal>.rejected`, one JSON object per line.
+     *
+     * All methods are thread-safe.
+     */
+    class WriteJournal
+    {
+    public:
+        explicit WriteJournal(QString filePath);
+        ~WriteJournal();
+
+        WriteJournal(const WriteJournal&) = delete;
+        WriteJournal& operator=(const WriteJournal&) = delete;
+
+        /**
+         * @brief Opens the journal, creating it if needed, and reads its checkpoint.
+         * @return Result containing the number of records not yet applied.
+         */
+        Etrek::Specification::Result<int> open();
+
+        /**
+         * @brief Syncs pending records and closes the file.
+         */
+        void close();
+
+        bool isOpen() const;
+
+        /**
+         * @brief Sets when append() syncs: after @p maxPendingRecords records or @p maxDelayMs
+         *        milliseconds, whichever comes first. Defaults are 64 records and 50 ms.
+         */
+        void setSyncPolicy(int maxPendingRecords, int maxDelayMs);
+
+        /**
+         * @brief Appends one record.
+         * @return Result containing the sequence number of the record.
+         */
+        Etrek::Specification::Result<qint64> append(const QString& kind, const QJsonObject& payload);
+
+        /**
+         * @brief Syncs all appended records to disk.
+         */
+        Etrek::Specification::Result<bool> sync();
+
+        /**
+         * @brief Syncs if records have been waiting for longer than the sync policy allows.
+         */
+        void syncIfDue();
+
+        /**
+         * @brief Reads up to @p maxRecords records following @p sequence, in order.
+         */
+        Etrek::Specification::Result<QVector<JournalRecord>> readAfter(qint64 sequence, int maxRecords);
+
+        /**
+         * @brief Records that every record up to @p sequence has been applied.
+         *
+         * Writes the checkpoint file and, when @p sequence is the last record, cuts the journal
+         * back to a header with a new journal id.
+         */
+        Etrek::Specification::Result<bool> markApplied(qint64 sequence);
+
+        /**
+         * @brief Keeps a record that can never be applied in the rejected file, with @p reason.
+         *
+         * The record stays in the journal until it is checkpointed like any other.
+         */
+        Etrek::Specification::Result<bool> reject(const JournalRecord& record, const QString& reason);
+
+        QString journalId() const;
+        QString filePath() const;
+        QString rejectedFilePath() const;
+        qint64 lastSequence() const;
+        qint64 appliedSequence() const;
+
+    private:
+        Etrek::Specification::Result<bool> syncLocked();
+        Etrek::Specification::Result<bool> writeHeader();
+        Etrek::Specification::Result<bool> recover();
+        Etrek::Specification::Result<bool> readCheckpoint();
+        Etrek::Specification::Result<bool> writeCheckpoint(qint64 sequence);
+        QString checkpointPath() const;
+
+        mutable QMutex m_mutex;
+        QString m_filePath;
+        QFile m_file;
+        QString m_journalId;
+
+        qint64 m_lastSequence = 0;
+        qint64 m_appliedSequence = 0;
+
+        // Where readAfter() stopped, so a following call does not scan from the header again
+        qint64 m_cursorSequence = -1;
+        qint64 m_cursorOffset = 0;
+
+        int m_maxPendingRecords = 64;
+        int m_maxDelayMs = 50;
+        int m_pendingRecords = 0;
+        QElapsedTimer m_oldestPending;
+
+        /**
+         * @brief Pointer to the translation provider for localized messages (non-owning).
+         */
+        Etrek::Core::Globalization::TranslationProvider* translator;
+
+        /**
+         * @brief Shared pointer to the application logger.
+         */
+        std::shared_ptr<Etrek::Core::Log::AppLogger> logger;
+    };
+
+} // namespace Etrek::Core::Repository
+
+#endif // WRITEJOURNAL_H
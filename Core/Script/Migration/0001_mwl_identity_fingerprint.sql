@@ -0,0 +1,42 @@
+-- Adds the identity fingerprint to mwl_entries on databases created before it existed.
+-- The fingerprint is the SHA-256 of the entry's active identifier values (see
+-- profile_tag_association.is_identifier), normalized as "tag_id=lower(trim(value))" and
+-- joined with '|' in tag id order. It must stay in sync with WorklistRepository.
+-- When several existing entries share an identity only the oldest one keeps the fingerprint.
+-- MySQL DDL is not transactional, so each ALTER checks whether an interrupted earlier run
+-- already made it and the script can simply run again.
+
+SET @ddl = IF((SELECT COUNT(*) FROM information_schema.COLUMNS
+               WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'mwl_entries' AND COLUMN_NAME = 'identity_fingerprint') = 0,
+              'ALTER TABLE mwl_entries ADD COLUMN identity_fingerprint CHAR(64) NULL AFTER study_instance_uid',
+              'DO 0');
+PREPARE migration_ddl FROM @ddl;
+EXECUTE migration_ddl;
+DEALLOCATE PREPARE migration_ddl;
+
+SET SESSION group_concat_max_len = 65535;
+
+UPDATE mwl_entries e
+JOIN (
+    SELECT MIN(f.mwl_entry_id) AS mwl_entry_id, f.fingerprint
+    FROM (
+        SELECT a.mwl_entry_id, me.profile_id,
+               SHA2(GROUP_CONCAT(CONCAT(a.dicom_tag_id, '=', LOWER(TRIM(COALESCE(a.tag_value, ''))))
+                                 ORDER BY a.dicom_tag_id SEPARATOR '|'), 256) AS fingerprint
+        FROM mwl_attributes a
+        JOIN mwl_entries me ON me.id = a.mwl_entry_id
+        JOIN profile_tag_association pta ON pta.profile_id = me.profile_id AND pta.tag_id = a.dicom_tag_id AND pta.is_identifier = TRUE
+        JOIN dicom_tags t ON t.id = a.dicom_tag_id AND t.is_active = TRUE
+        GROUP BY a.mwl_entry_id, me.profile_id
+    ) f
+    GROUP BY f.profile_id, f.fingerprint
+) k ON k.mwl_entry_id = e.id
+SET e.identity_fingerprint = k.fingerprint;
+
+SET @ddl = IF((SELECT COUNT(*) FROM information_schema.STATISTICS
+               WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'mwl_entries' AND INDEX_NAME = 'uq_mwl_entries_profile_fingerprint') = 0,
+              'ALTER TABLE mwl_entries ADD UNIQUE KEY uq_mwl_entries_profile_fingerprint (profile_id, identity_fingerprint)',
+              'DO 0');
+PREPARE migration_ddl FROM @ddl;
+EXECUTE migration_ddl;
+DEALLOCATE PREPARE migration_ddl;
@@ -0,0 +1,4 @@
+-- Adds the (created_at, id) index used by the keyset-paginated worklist reader
+-- on databases created before it existed.
+
+ALTER TABLE mwl_entries ADD KEY idx_mwl_entries_created_at_id (created_at, id);
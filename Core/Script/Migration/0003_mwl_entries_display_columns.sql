@@ -0,0 +1,45 @@
+-- Adds the worklist grid projection to mwl_entries on databases created before it existed
+-- and fills it from the active attributes of every entry.
+-- The column mapping must stay in sync with WorklistDisplayProjection::refreshSql.
+-- The columns are only added when missing, so a run interrupted before the backfill can
+-- simply run again; the backfill itself can be repeated.
+
+SET @ddl = IF((SELECT COUNT(*) FROM information_schema.COLUMNS
+               WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'mwl_entries' AND COLUMN_NAME = 'display_patient_name') = 0,
+              'ALTER TABLE mwl_entries
+                   ADD COLUMN display_patient_name VARCHAR(512) DEFAULT NULL,
+                   ADD COLUMN display_patient_id VARCHAR(512) DEFAULT NULL,
+                   ADD COLUMN display_study_name VARCHAR(512) DEFAULT NULL,
+                   ADD COLUMN display_patient_sex VARCHAR(512) DEFAULT NULL,
+                   ADD COLUMN display_birth_date VARCHAR(512) DEFAULT NULL,
+                   ADD COLUMN display_accession_number VARCHAR(512) DEFAULT NULL,
+                   ADD COLUMN display_admission_id VARCHAR(512) DEFAULT NULL,
+                   ADD KEY idx_mwl_entries_display_patient_id (display_patient_id),
+                   ADD KEY idx_mwl_entries_display_accession_number (display_accession_number)',
+              'DO 0');
+PREPARE migration_ddl FROM @ddl;
+EXECUTE migration_ddl;
+DEALLOCATE PREPARE migration_ddl;
+
+UPDATE mwl_entries e
+JOIN (
+    SELECT a.mwl_entry_id,
+           MAX(CASE WHEN t.name = 'PatientName' THEN a.tag_value END) AS patient_name,
+           MAX(CASE WHEN t.name = 'PatientID' THEN a.tag_value END) AS patient_id,
+           MAX(CASE WHEN t.name = 'StudyDescription' THEN a.tag_value END) AS study_description,
+           MAX(CASE WHEN t.name = 'StudyID' THEN a.tag_value END) AS study_id,
+           MAX(CASE WHEN t.name = 'PatientSex' THEN a.tag_value END) AS patient_sex,
+           MAX(CASE WHEN t.name = 'PatientBirthDate' THEN a.tag_value END) AS birth_date,
+           MAX(CASE WHEN t.name = 'AccessionNumber' THEN a.tag_value END) AS accession_number,
+           MAX(CASE WHEN t.name = 'AdmissionID' THEN a.tag_value END) AS admission_id
+    FROM mwl_attributes a
+    JOIN dicom_tags t ON t.id = a.dicom_tag_id AND t.is_active = TRUE
+    GROUP BY a.mwl_entry_id
+) d ON d.mwl_entry_id = e.id
+SET e.display_patient_name = d.patient_name,
+    e.display_patient_id = d.patient_id,
+    e.display_study_name = COALESCE(NULLIF(d.study_description, ''), d.study_id),
+    e.display_patient_sex = d.patient_sex,
+    e.display_birth_date = d.birth_date,
+    e.display_accession_number = d.accession_number,
+    e.display_admission_id = d.admission_id;
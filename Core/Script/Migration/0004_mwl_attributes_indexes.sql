@@ -0,0 +1,8 @@
+-- Indexes for the attribute lookups of the worklist repositories.
+-- (mwl_entry_id, dicom_tag_id): attribute loads and diffs per entry, covering the tag join.
+-- (dicom_tag_id, tag_value): identifier matching and tag-wide refreshes by value.
+-- Both also serve the foreign keys, so InnoDB drops its implicit single-column indexes.
+
+ALTER TABLE mwl_attributes
+    ADD KEY idx_mwl_attributes_entry_tag (mwl_entry_id, dicom_tag_id),
+    ADD KEY idx_mwl_attributes_tag_value (dicom_tag_id, tag_value);
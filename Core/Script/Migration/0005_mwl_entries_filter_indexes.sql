@@ -0,0 +1,5 @@
+-- Indexes for the worklist filters by profile and status, and by source.
+
+ALTER TABLE mwl_entries
+    ADD KEY idx_mwl_entries_profile_status (profile_id, status),
+    ADD KEY idx_mwl_entries_source_created_at (source, created_at);
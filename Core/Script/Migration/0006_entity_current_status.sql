@@ -0,0 +1,37 @@
+-- Adds the materialized current status of each DICOM entity on databases created before it
+-- existed and fills it from the latest entity_status row of every entity.
+-- DicomRepository::insertEntityStatus keeps it up to date from here on.
+-- Both statements can be repeated, so a run interrupted before the backfill can simply run again.
+
+CREATE TABLE IF NOT EXISTS entity_current_status (
+    entity_type ENUM('PATIENT', 'STUDY', 'SERIES', 'IMAGE') NOT NULL,
+    entity_id INT NOT NULL,
+    status_id INT NOT NULL,
+    status ENUM('SCHEDULED', 'PENDING', 'COMPLETED', 'CANCELLED', 'IN_PROGRESS', 'ABORTED') NOT NULL,
+    priority ENUM('URGENT', 'HIGH', 'NORMAL', 'LOW') DEFAULT 'NORMAL',
+    assigned_to INT DEFAULT NULL,
+    transitioned_at DATETIME(6) NOT NULL,
+
+    PRIMARY KEY (entity_type, entity_id),
+    INDEX idx_current_status_type (entity_type, status, transitioned_at),
+    INDEX idx_current_status_assigned (assigned_to, status, priority, transitioned_at),
+
+    FOREIGN KEY (status_id) REFERENCES entity_status(id) ON DELETE CASCADE,
+    FOREIGN KEY (assigned_to) REFERENCES users(id) ON DELETE SET NULL
+);
+
+INSERT INTO entity_current_status
+    (entity_type, entity_id, status_id, status, priority, assigned_to, transitioned_at)
+SELECT es.entity_type, es.entity_id, es.id, es.status, es.priority, es.assigned_to, es.transitioned_at
+FROM entity_status es
+JOIN (
+    SELECT entity_type, entity_id, MAX(id) AS max_id
+    FROM entity_status
+    GROUP BY entity_type, entity_id
+) latest ON latest.max_id = es.id
+ON DUPLICATE KEY UPDATE
+    status_id = VALUES(status_id),
+    status = VALUES(status),
+    priority = VALUES(priority),
+    assigned_to = VALUES(assigned_to),
+    transitioned_at = VALUES(transitioned_at);
@@ -0,0 +1,11 @@
+-- Adds the record of applied write-journal entries on databases created before it existed.
+-- JournalApplier writes a row here in the same transaction as the journaled write, so an entry
+-- replayed after a crash is recognized and skipped.
+
+CREATE TABLE IF NOT EXISTS journal_applied_entries (
+    journal_id CHAR(36) NOT NULL,
+    sequence BIGINT NOT NULL,
+    applied_at DATETIME(6) NOT NULL DEFAULT CURRENT_TIMESTAMP(6),
+
+    PRIMARY KEY (journal_id, sequence)
+);
@@ -0,0 +1,121 @@
+-- Adds the keys DicomRepository upserts patients, studies and series on:
+--   patients (patient_id, issuer_key), where issuer_key is the issuer with NULL folded to ''
+--     so that patients without an issuer are unique as well,
+--   studies (study_instance_uid) and series (series_instance_uid).
+-- Duplicates created before the keys existed are merged into the oldest row: rows that
+-- reference a duplicate are moved to the kept row and the duplicate is deleted. The status
+-- history of a duplicate moves with it, and the current status of the kept row is taken
+-- again from its latest entity_status row.
+
+CREATE TEMPORARY TABLE patient_merge AS
+SELECT p.id AS duplicate_id, k.kept_id
+FROM patients p
+JOIN (
+    SELECT patient_id, COALESCE(issuer_of_patient_id, '') AS issuer_key, MIN(id) AS kept_id
+    FROM patients
+    GROUP BY patient_id, COALESCE(issuer_of_patient_id, '')
+    HAVING COUNT(*) > 1
+) k ON k.patient_id = p.patient_id AND k.issuer_key = COALESCE(p.issuer_of_patient_id, '') AND p.id <> k.kept_id;
+
+UPDATE studies s JOIN patient_merge m ON m.duplicate_id = s.patient_id SET s.patient_id = m.kept_id;
+UPDATE entity_status es JOIN patient_merge m ON m.duplicate_id = es.entity_id SET es.entity_id = m.kept_id WHERE es.entity_type = 'PATIENT';
+DELETE c FROM entity_current_status c JOIN patient_merge m ON m.duplicate_id = c.entity_id WHERE c.entity_type = 'PATIENT';
+INSERT INTO entity_current_status
+    (entity_type, entity_id, status_id, status, priority, assigned_to, transitioned_at)
+SELECT es.entity_type, es.entity_id, es.id, es.status, es.priority, es.assigned_to, es.transitioned_at
+FROM entity_status es
+JOIN (
+    SELECT MAX(s.id) AS max_id
+    FROM entity_status s
+    JOIN (SELECT DISTINCT kept_id FROM patient_merge) k ON k.kept_id = s.entity_id
+    WHERE s.entity_type = 'PATIENT'
+    GROUP BY s.entity_id
+) latest ON latest.max_id = es.id
+ON DUPLICATE KEY UPDATE
+    status_id = VALUES(status_id),
+    status = VALUES(status),
+    priority = VALUES(priority),
+    assigned_to = VALUES(assigned_to),
+    transitioned_at = VALUES(transitioned_at);
+DELETE p FROM patients p JOIN patient_merge m ON m.duplicate_id = p.id;
+DROP TEMPORARY TABLE patient_merge;
+
+ALTER TABLE patients
+    ADD COLUMN issuer_key VARCHAR(64) AS (COALESCE(issuer_of_patient_id, '')) STORED NOT NULL AFTER issuer_of_patient_id,
+    DROP INDEX idx_patients_patient_id_issuer,
+    ADD UNIQUE KEY uq_patients_patient_id_issuer (patient_id, issuer_key);
+
+CREATE TEMPORARY TABLE study_merge AS
+SELECT s.id AS duplicate_id, k.kept_id
+FROM studies s
+JOIN (
+    SELECT study_instance_uid, MIN(id) AS kept_id
+    FROM studies
+    GROUP BY study_instance_uid
+    HAVING COUNT(*) > 1
+) k ON k.study_instance_uid = s.study_instance_uid AND s.id <> k.kept_id;
+
+UPDATE series x JOIN study_merge m ON m.duplicate_id = x.study_id SET x.study_id = m.kept_id;
+UPDATE images x JOIN study_merge m ON m.duplicate_id = x.study_id SET x.study_id = m.kept_id;
+UPDATE acquisitions x JOIN study_merge m ON m.duplicate_id = x.study_id SET x.study_id = m.kept_id;
+UPDATE mwl_task_mapping x JOIN study_merge m ON m.duplicate_id = x.study_id SET x.study_id = m.kept_id;
+UPDATE entity_status es JOIN study_merge m ON m.duplicate_id = es.entity_id SET es.entity_id = m.kept_id WHERE es.entity_type = 'STUDY';
+DELETE c FROM entity_current_status c JOIN study_merge m ON m.duplicate_id = c.entity_id WHERE c.entity_type = 'STUDY';
+INSERT INTO entity_current_status
+    (entity_type, entity_id, status_id, status, priority, assigned_to, transitioned_at)
+SELECT es.entity_type, es.entity_id, es.id, es.status, es.priority, es.assigned_to, es.transitioned_at
+FROM entity_status es
+JOIN (
+    SELECT MAX(s.id) AS max_id
+    FROM entity_status s
+    JOIN (SELECT DISTINCT kept_id FROM study_merge) k ON k.kept_id = s.entity_id
+    WHERE s.entity_type = 'STUDY'
+    GROUP BY s.entity_id
+) latest ON latest.max_id = es.id
+ON DUPLICATE KEY UPDATE
+    status_id = VALUES(status_id),
+    status = VALUES(status),
+    priority = VALUES(priority),
+    assigned_to = VALUES(assigned_to),
+    transitioned_at = VALUES(transitioned_at);
+DELETE s FROM studies s JOIN study_merge m ON m.duplicate_id = s.id;
+DROP TEMPORARY TABLE study_merge;
+
+ALTER TABLE studies ADD UNIQUE KEY uq_studies_study_instance_uid (study_instance_uid);
+
+CREATE TEMPORARY TABLE series_merge AS
+SELECT s.id AS duplicate_id, k.kept_id
+FROM series s
+JOIN (
+    SELECT series_instance_uid, MIN(id) AS kept_id
+    FROM series
+    GROUP BY series_instance_uid
+    HAVING COUNT(*) > 1
+) k ON k.series_instance_uid = s.series_instance_uid AND s.id <> k.kept_id;
+
+UPDATE images x JOIN series_merge m ON m.duplicate_id = x.series_id SET x.series_id = m.kept_id;
+UPDATE acquisitions x JOIN series_merge m ON m.duplicate_id = x.series_id SET x.series_id = m.kept_id;
+UPDATE mwl_task_mapping x JOIN series_merge m ON m.duplicate_id = x.series_id SET x.series_id = m.kept_id;
+UPDATE entity_status es JOIN series_merge m ON m.duplicate_id = es.entity_id SET es.entity_id = m.kept_id WHERE es.entity_type = 'SERIES';
+DELETE c FROM entity_current_status c JOIN series_merge m ON m.duplicate_id = c.entity_id WHERE c.entity_type = 'SERIES';
+INSERT INTO entity_current_status
+    (entity_type, entity_id, status_id, status, priority, assigned_to, transitioned_at)
+SELECT es.entity_type, es.entity_id, es.id, es.status, es.priority, es.assigned_to, es.transitioned_at
+FROM entity_status es
+JOIN (
+    SELECT MAX(s.id) AS max_id
+    FROM entity_status s
+    JOIN (SELECT DISTINCT kept_id FROM series_merge) k ON k.kept_id = s.entity_id
+    WHERE s.entity_type = 'SERIES'
+    GROUP BY s.entity_id
+) latest ON latest.max_id = es.id
+ON DUPLICATE KEY UPDATE
+    status_id = VALUES(status_id),
+    status = VALUES(status),
+    priority = VALUES(priority),
+    assigned_to = VALUES(assigned_to),
+    transitioned_at = VALUES(transitioned_at);
+DELETE s FROM series s JOIN series_merge m ON m.duplicate_id = s.id;
+DROP TEMPORARY TABLE series_merge;
+
+ALTER TABLE series ADD UNIQUE KEY uq_series_series_instance_uid (series_instance_uid);
@@ -0,0 +1,4 @@
+-- Index for the maintenance purge of superseded status history, which deletes the oldest
+-- entity_status rows in small batches by transition time.
+
+ALTER TABLE entity_status ADD KEY idx_entity_status_transitioned_at (transitioned_at);
@@ -0,0 +1,4 @@
+-- Name of the RIS connection a worklist entry was first received from, for sites that query
+-- several RIS instances. NULL for local entries and for entries received before this column.
+
+ALTER TABLE mwl_entries ADD COLUMN source_connection VARCHAR(64) NULL AFTER source;
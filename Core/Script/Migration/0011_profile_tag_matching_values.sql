@@ -0,0 +1,4 @@
+-- Matching value of a profile tag in the worklist C-FIND, e.g. a requested procedure code or
+-- a scheduled performing physician. NULL keeps universal matching (the tag is only returned).
+
+ALTER TABLE profile_tag_association ADD COLUMN matching_value VARCHAR(255) NULL AFTER is_mandatory;
@@ -0,0 +1,14 @@
+-- RIS connections that return each worklist entry. An entry merged across connections is only
+-- cancelled by a reconcile once none of them returns it any more. Entries without rows here
+-- fall back to mwl_entries.source_connection.
+
+CREATE TABLE IF NOT EXISTS mwl_entry_sources (
+    mwl_entry_id INT NOT NULL,
+    connection_name VARCHAR(64) NOT NULL,
+    last_seen_at DATETIME DEFAULT NULL,
+
+    PRIMARY KEY (mwl_entry_id, connection_name),
+    KEY idx_mwl_entry_sources_connection (connection_name),
+
+    FOREIGN KEY (mwl_entry_id) REFERENCES mwl_entries(id) ON DELETE CASCADE
+);
@@ -7,12 +7,14 @@ DROP TABLE IF EXISTS `detector_setup`;
 DROP TABLE IF EXISTS `detectors`;
 DROP TABLE IF EXISTS `device_connections`;
 DROP TABLE IF EXISTS `dicom_tags`;
+DROP TABLE IF EXISTS `entity_current_status`;
 DROP TABLE IF EXISTS `environment_settings`;
 DROP TABLE IF EXISTS `general_equipments`;
 DROP TABLE IF EXISTS `generators`;
 DROP TABLE IF EXISTS `image_comments`;
 DROP TABLE IF EXISTS `images`;
 DROP TABLE IF EXISTS `institutions`;
+DROP TABLE IF EXISTS `journal_applied_entries`;
 DROP TABLE IF EXISTS `mwl_attributes`;
 DROP TABLE IF EXISTS `mwl_entries`;
 DROP TABLE IF EXISTS `mwl_presentation_contexts`;
@@ -388,6 +390,7 @@ CREATE TABLE profile_tag_association (
     tag_id INT NOT NULL,                    -- Foreign key to dicom_tags.id
     is_identifier BOOLEAN DEFAULT FALSE,    -- This tag is being used for identification (active)
     is_mandatory BOOLEAN DEFAULT FALSE,     -- If true, must be in is_identifier = true
+    matching_value VARCHAR(255) NULL,       -- C-FIND matching value of the tag, NULL for universal matching
     PRIMARY KEY (profile_id, tag_id),
     FOREIGN KEY (profile_id) REFERENCES mwl_profiles(id) ON DELETE CASCADE,  -- Profile deletion removes associations
     FOREIGN KEY (tag_id) REFERENCES dicom_tags(id) ON DELETE RESTRICT        -- Prevent deletion of globally managed DICOM tags
@@ -397,20 +400,49 @@ CREATE TABLE profile_tag_association (
 CREATE TABLE mwl_entries (
     id INT AUTO_INCREMENT PRIMARY KEY,                  -- Unique worklist entry ID
     source ENUM('LOCAL', 'RIS') NOT NULL,               -- Source system of the worklist entry
+    source_connection VARCHAR(64) NULL,                  -- RIS connection the entry was first received from, NULL if local
     profile_id INT NULL,                                 -- Foreign key to the profile used for this entry
     status ENUM('SCHEDULED', 'PENDING', 'COMPLETED', 'CANCELLED', 'IN_PROGRESS', 'ABORTED') DEFAULT 'PENDING', -- Status of the scheduled procedure
     study_instance_uid VARCHAR(64),
+    identity_fingerprint CHAR(64) NULL,                  -- SHA-256 of the normalized active identifier values, NULL if none
     created_at DATETIME DEFAULT NULL,                    -- Entry creation time, default is NULL
     updated_at DATETIME DEFAULT NULL,                    -- Entry update time, default is NULL, will be updated explicitly
+    -- Worklist grid projection of the active attributes, maintained by the repositories (WorklistDisplayProjection.h)
+    display_patient_name VARCHAR(512) DEFAULT NULL,
+    display_patient_id VARCHAR(512) DEFAULT NULL,
+    display_study_name VARCHAR(512) DEFAULT NULL,        -- StudyDescription, StudyID when empty
+    display_patient_sex VARCHAR(512) DEFAULT NULL,
+    display_birth_date VARCHAR(512) DEFAULT NULL,        -- DICOM DA as stored (YYYYMMDD)
+    display_accession_number VARCHAR(512) DEFAULT NULL,
+    display_admission_id VARCHAR(512) DEFAULT NULL,
+    UNIQUE KEY uq_mwl_entries_profile_fingerprint (profile_id, identity_fingerprint), -- Point lookup for RIS de-duplication
+    KEY idx_mwl_entries_created_at_id (created_at, id),   -- Keyset pagination of the worklist, newest first
+    KEY idx_mwl_entries_display_patient_id (display_patient_id),             -- Worklist search by patient ID
+    KEY idx_mwl_entries_display_accession_number (display_accession_number), -- Worklist search by accession number
+    KEY idx_mwl_entries_profile_status (profile_id, status),                 -- Worklist filter by profile and status
+    KEY idx_mwl_entries_source_created_at (source, created_at),              -- Worklist filter by source
     FOREIGN KEY (profile_id) REFERENCES mwl_profiles(id) ON DELETE SET NULL
 );
 
+-- RIS connections that return each worklist entry; a reconcile cancels a merged entry only
+-- once none of them returns it. Entries without rows fall back to mwl_entries.source_connection.
+CREATE TABLE mwl_entry_sources (
+    mwl_entry_id INT NOT NULL,                  -- Foreign key to mwl_entries.id
+    connection_name VARCHAR(64) NOT NULL,       -- RIS connection that returned the entry
+    last_seen_at DATETIME DEFAULT NULL,         -- Last ingest of the entry from this connection
+    PRIMARY KEY (mwl_entry_id, connection_name),
+    KEY idx_mwl_entry_sources_connection (connection_name),
+    FOREIGN KEY (mwl_entry_id) REFERENCES mwl_entries(id) ON DELETE CASCADE
+);
+
 -- Stores actual tag values from DICOM MWL responses for each entry.
 CREATE TABLE mwl_attributes (
     id INT AUTO_INCREMENT PRIMARY KEY,
     mwl_entry_id INT NOT NULL,               -- Foreign key to mwl_entries.id (worklist entry)
     dicom_tag_id INT NOT NULL,               -- Foreign key to dicom_tags.id (the actual DICOM tag)
     tag_value VARCHAR(512) DEFAULT NULL,       -- Value of the tag (as a string)
+    KEY idx_mwl_attributes_entry_tag (mwl_entry_id, dicom_tag_id),   -- Attribute loads and diffs per entry
+    KEY idx_mwl_attributes_tag_value (dicom_tag_id, tag_value),      -- Identifier matching by value
     FOREIGN KEY (mwl_entry_id) REFERENCES mwl_entries(id) ON DELETE CASCADE,  -- Cascade deletes with worklist entry
     FOREIGN KEY (dicom_tag_id) REFERENCES dicom_tags(id) ON DELETE RESTRICT  -- Prevent deletion of globally managed DICOM tags
 );
@@ -424,6 +456,7 @@ CREATE TABLE patients (
     patient_name VARCHAR(255) DEFAULT NULL,  -- (0010,0010): Patient's Name
     patient_id VARCHAR(64) NOT NULL,  -- (0010,0020): Primary identifier for the patient
     issuer_of_patient_id VARCHAR(64) DEFAULT NULL,  -- (0010,0021): Organization that issued the Patient ID
+    issuer_key VARCHAR(64) AS (COALESCE(issuer_of_patient_id, '')) STORED NOT NULL,  -- Issuer with NULL as '', for the unique key below
     type_of_patient_id VARCHAR(64) DEFAULT NULL,  -- (0010,0022): Type of identifier (e.g., text, barcode, RFID)
     issuer_of_patient_id_qualifiers JSON DEFAULT NULL,  -- (0010,0024): Sequence of issuer qualifiers (Universal Entity ID, etc.)
     other_patient_id JSON DEFAULT NULL,  -- (0010,1000): Array of other patient identifiers
@@ -438,8 +471,9 @@ CREATE TABLE patients (
 );
 
 -- Composite unique index: A patient is uniquely identified by patient_id + issuer combination
--- Allows same patient_id from different issuers to coexist
-CREATE UNIQUE INDEX idx_patients_patient_id_issuer ON patients (patient_id, issuer_of_patient_id);
+-- Allows same patient_id from different issuers to coexist; patients without an issuer share issuer_key ''
+-- DicomRepository::upsertPatient inserts or updates on this key
+CREATE UNIQUE INDEX uq_patients_patient_id_issuer ON patients (patient_id, issuer_key);
 
 -- Index for efficient patient lookup by ID alone
 CREATE INDEX idx_patients_patient_id ON patients (patient_id);
@@ -466,6 +500,9 @@ CREATE TABLE studies (
     FOREIGN KEY (patient_id) REFERENCES patients(id) ON DELETE RESTRICT  -- Protect study integrity; patient cannot be deleted if studies exist
 );
 
+-- A study is identified by its Study Instance UID; DicomRepository::upsertStudy inserts or updates on it
+CREATE UNIQUE INDEX uq_studies_study_instance_uid ON studies (study_instance_uid);
+
 -- Index to support efficient filtering by Admission ID (non-unique)
 CREATE INDEX idx_studies_admission_id ON studies (admission_id);
 
@@ -491,6 +528,9 @@ CREATE TABLE series (
     FOREIGN KEY (study_id) REFERENCES studies(id) ON DELETE CASCADE
 );
 
+-- A series is identified by its Series Instance UID; DicomRepository::upsertSeries inserts or updates on it
+CREATE UNIQUE INDEX uq_series_series_instance_uid ON series (series_instance_uid);
+
 -- Stores dynamic settings and processing information for each image, such as patient orientation, contrast agents, image compression, and processing steps.
 CREATE TABLE images (
     id INT AUTO_INCREMENT PRIMARY KEY,
@@ -556,12 +596,42 @@ CREATE TABLE entity_status (
     INDEX idx_status_assigned (assigned_to, status),  -- Find all tasks assigned to a user by status
     INDEX idx_status_priority (priority, status, transitioned_at),  -- Priority-based workflow queries
     INDEX idx_status_type (entity_type, status),  -- Status queries by entity type (e.g., all pending studies)
+    INDEX idx_entity_status_transitioned_at (transitioned_at),  -- Maintenance purge of old history, oldest first
 
     -- Foreign keys
     FOREIGN KEY (assigned_to) REFERENCES users(id) ON DELETE SET NULL,
     FOREIGN KEY (transitioned_by) REFERENCES users(id) ON DELETE SET NULL
 );
 
+-- Latest entity_status row of each entity, written in the same transaction as the history row.
+-- Status lists filter here by index instead of searching the history for each entity's latest row.
+CREATE TABLE entity_current_status (
+    entity_type ENUM('PATIENT', 'STUDY', 'SERIES', 'IMAGE') NOT NULL,
+    entity_id INT NOT NULL,
+    status_id INT NOT NULL,  -- FK to the current entity_status row
+    status ENUM('SCHEDULED', 'PENDING', 'COMPLETED', 'CANCELLED', 'IN_PROGRESS', 'ABORTED') NOT NULL,
+    priority ENUM('URGENT', 'HIGH', 'NORMAL', 'LOW') DEFAULT 'NORMAL',
+    assigned_to INT DEFAULT NULL,
+    transitioned_at DATETIME(6) NOT NULL,
+
+    PRIMARY KEY (entity_type, entity_id),
+    INDEX idx_current_status_type (entity_type, status, transitioned_at),  -- e.g., all pending studies, newest first
+    INDEX idx_current_status_assigned (assigned_to, status, priority, transitioned_at),  -- work list of a user
+
+    FOREIGN KEY (status_id) REFERENCES entity_status(id) ON DELETE CASCADE,
+    FOREIGN KEY (assigned_to) REFERENCES users(id) ON DELETE SET NULL
+);
+
+-- Write-journal entries already applied, one row per journal and sequence number.
+-- Written in the same transaction as the journaled write so that replays are skipped.
+CREATE TABLE journal_applied_entries (
+    journal_id CHAR(36) NOT NULL,  -- Id of the local journal file the entry came from
+    sequence BIGINT NOT NULL,  -- Sequence number of the entry within that journal
+    applied_at DATETIME(6) NOT NULL DEFAULT CURRENT_TIMESTAMP(6),
+
+    PRIMARY KEY (journal_id, sequence)
+);
+
 -- SOP common module
 CREATE TABLE sop_commons (
     id INT AUTO_INCREMENT PRIMARY KEY,
@@ -0,0 +1,202 @@
+-- Schema of the embedded SQLite store.
+--
+-- The store holds the subset of setup_database.sql needed to log in, register patients
+-- locally and work through today's worklist: users and roles, the anatomy used by the
+-- registration dialog, the DICOM tag dictionary with the identifier flags of the worklist
+-- profiles, the worklist and the entity statuses.
+-- It is used as the whole database in the Demo launch mode, in Developer mode without a
+-- database server and in tests, and as the local offline store that OfflineStoreSync keeps
+-- in step with MySQL. Worklist profiles, devices and scan protocols are not part of it;
+-- ApplicationService skips RIS queries, device loading and the system settings pages while
+-- running on the store.
+--
+-- Column names and meanings follow setup_database.sql; keep both in sync.
+-- ENUM columns become TEXT with a CHECK, AUTO_INCREMENT keys become INTEGER PRIMARY KEY.
+-- Date-times are stored as ISO 8601 text ('YYYY-MM-DDTHH:MM:SS.SSS'), the format Qt binds
+-- QDateTime values with, so they compare and sort as text.
+
+-- ******************[section: authentication and authorization]******************
+
+CREATE TABLE users (
+    id INTEGER PRIMARY KEY,
+    user_name VARCHAR(255) NOT NULL UNIQUE,
+    name VARCHAR(255) NOT NULL,
+    surname VARCHAR(255) NOT NULL,
+    is_active BOOLEAN NOT NULL DEFAULT TRUE,
+    is_deleted BOOLEAN DEFAULT NULL,
+    create_date TEXT DEFAULT (strftime('%Y-%m-%dT%H:%M:%f', 'now', 'localtime')),
+    update_date TEXT DEFAULT NULL,
+    password_hash VARCHAR(255) NOT NULL
+);
+
+CREATE TABLE roles (
+    id INTEGER PRIMARY KEY,
+    name VARCHAR(255) NOT NULL UNIQUE
+);
+
+CREATE TABLE user_roles (
+    user_id INT,
+    role_id INT,
+    PRIMARY KEY(user_id, role_id),
+    FOREIGN KEY(user_id) REFERENCES users(id),
+    FOREIGN KEY(role_id) REFERENCES roles(id)
+);
+
+-- ******************[section: anatomy used by local registration]******************
+
+CREATE TABLE anatomic_regions (
+    id INTEGER PRIMARY KEY,
+    name VARCHAR(64) NOT NULL UNIQUE,
+    code_value VARCHAR(32) NOT NULL,
+    coding_scheme VARCHAR(16) NOT NULL DEFAULT 'SRT',
+    code_meaning VARCHAR(128) NOT NULL,
+    description VARCHAR(255) NULL,
+    display_order INT NOT NULL DEFAULT 0,
+    UNIQUE (code_value, coding_scheme)
+);
+
+CREATE TABLE body_parts (
+    id INTEGER PRIMARY KEY,
+    name VARCHAR(50) NOT NULL UNIQUE,
+    code_value VARCHAR(50),
+    coding_scheme VARCHAR(20) DEFAULT 'SRT',
+    description VARCHAR(255),
+    anatomic_region_id INT NOT NULL,
+    is_active BOOLEAN DEFAULT TRUE,
+    FOREIGN KEY (anatomic_region_id) REFERENCES anatomic_regions(id)
+);
+
+-- ******************[section: worklist]******************
+
+CREATE TABLE dicom_tags (
+    id INTEGER PRIMARY KEY,
+    name VARCHAR(255) NOT NULL UNIQUE,
+    display_name VARCHAR(255) NOT NULL,
+    group_hex INT NOT NULL,
+    element_hex INT NOT NULL,
+    pgroup_hex INT NOT NULL,
+    pelement_hex INT NOT NULL,
+    is_active BOOLEAN DEFAULT TRUE,
+    is_retired BOOLEAN DEFAULT FALSE
+);
+
+-- Identifier flags of the worklist profiles, so that entries get the same identity
+-- fingerprint here as on MySQL. profile_id is kept as a plain value: the profiles
+-- themselves live on MySQL only.
+CREATE TABLE profile_tag_association (
+    profile_id INT NOT NULL,
+    tag_id INT NOT NULL,
+    is_identifier BOOLEAN DEFAULT FALSE,
+    is_mandatory BOOLEAN DEFAULT FALSE,
+    matching_value VARCHAR(255) NULL,
+    PRIMARY KEY (profile_id, tag_id),
+    FOREIGN KEY (tag_id) REFERENCES dicom_tags(id) ON DELETE RESTRICT
+);
+
+-- profile_id is kept as a plain value: worklist profiles live on MySQL only.
+CREATE TABLE mwl_entries (
+    id INTEGER PRIMARY KEY,
+    source TEXT NOT NULL CHECK (source IN ('LOCAL', 'RIS')),
+    source_connection VARCHAR(64) NULL,
+    profile_id INT NULL,
+    status TEXT DEFAULT 'PENDING' CHECK (status IN ('SCHEDULED', 'PENDING', 'COMPLETED', 'CANCELLED', 'IN_PROGRESS', 'ABORTED')),
+    study_instance_uid VARCHAR(64),
+    identity_fingerprint CHAR(64) NULL,
+    created_at TEXT DEFAULT NULL,
+    updated_at TEXT DEFAULT NULL,
+    display_patient_name VARCHAR(512) DEFAULT NULL,
+    display_patient_id VARCHAR(512) DEFAULT NULL,
+    display_study_name VARCHAR(512) DEFAULT NULL,
+    display_patient_sex VARCHAR(512) DEFAULT NULL,
+    display_birth_date VARCHAR(512) DEFAULT NULL,
+    display_accession_number VARCHAR(512) DEFAULT NULL,
+    display_admission_id VARCHAR(512) DEFAULT NULL,
+    -- Offline store only: 0 = same as on MySQL, 1 = created here and not yet on MySQL,
+    -- 2 = copied from MySQL and its status changed here since
+    pending_sync INT NOT NULL DEFAULT 1,
+    UNIQUE (profile_id, identity_fingerprint)
+);
+
+CREATE INDEX idx_mwl_entries_created_at_id ON mwl_entries (created_at, id);
+CREATE INDEX idx_mwl_entries_display_patient_id ON mwl_entries (display_patient_id);
+CREATE INDEX idx_mwl_entries_display_accession_number ON mwl_entries (display_accession_number);
+CREATE INDEX idx_mwl_entries_profile_status ON mwl_entries (profile_id, status);
+CREATE INDEX idx_mwl_entries_source_created_at ON mwl_entries (source, created_at);
+CREATE INDEX idx_mwl_entries_pending_sync ON mwl_entries (pending_sync);
+
+-- Marks status changes of entries copied from MySQL so they are sent back
+CREATE TRIGGER trg_mwl_entries_status_changed
+AFTER UPDATE OF status ON mwl_entries
+WHEN OLD.pending_sync = 0 AND NEW.status IS NOT OLD.status
+BEGIN
+    UPDATE mwl_entries SET pending_sync = 2 WHERE id = NEW.id;
+END;
+
+CREATE TABLE mwl_attributes (
+    id INTEGER PRIMARY KEY,
+    mwl_entry_id INT NOT NULL,
+    dicom_tag_id INT NOT NULL,
+    tag_value VARCHAR(512) DEFAULT NULL,
+    FOREIGN KEY (mwl_entry_id) REFERENCES mwl_entries(id) ON DELETE CASCADE,
+    FOREIGN KEY (dicom_tag_id) REFERENCES dicom_tags(id) ON DELETE RESTRICT
+);
+
+CREATE INDEX idx_mwl_attributes_entry_tag ON mwl_attributes (mwl_entry_id, dicom_tag_id);
+CREATE INDEX idx_mwl_attributes_tag_value ON mwl_attributes (dicom_tag_id, tag_value);
+
+CREATE TABLE mwl_entry_sources (
+    mwl_entry_id INT NOT NULL,
+    connection_name VARCHAR(64) NOT NULL,
+    last_seen_at TEXT DEFAULT NULL,
+    PRIMARY KEY (mwl_entry_id, connection_name),
+    FOREIGN KEY (mwl_entry_id) REFERENCES mwl_entries(id) ON DELETE CASCADE
+);
+
+CREATE INDEX idx_mwl_entry_sources_connection ON mwl_entry_sources (connection_name);
+
+-- ******************[section: workflow status]******************
+
+CREATE TABLE entity_status (
+    id INTEGER PRIMARY KEY,
+    entity_type TEXT NOT NULL CHECK (entity_type IN ('PATIENT', 'STUDY', 'SERIES', 'IMAGE')),
+    entity_id INT NOT NULL,
+    status TEXT NOT NULL CHECK (status IN ('SCHEDULED', 'PENDING', 'COMPLETED', 'CANCELLED', 'IN_PROGRESS', 'ABORTED')),
+    status_reason TEXT DEFAULT NULL,
+    priority TEXT DEFAULT 'NORMAL' CHECK (priority IN ('URGENT', 'HIGH', 'NORMAL', 'LOW')),
+    assigned_to INT DEFAULT NULL,
+    transitioned_by INT DEFAULT NULL,
+    transitioned_at TEXT NOT NULL DEFAULT (strftime('%Y-%m-%dT%H:%M:%f', 'now', 'localtime')),
+    notes TEXT DEFAULT NULL,
+    FOREIGN KEY (assigned_to) REFERENCES users(id) ON DELETE SET NULL,
+    FOREIGN KEY (transitioned_by) REFERENCES users(id) ON DELETE SET NULL
+);
+
+CREATE INDEX idx_entity_status_lookup ON entity_status (entity_type, entity_id, transitioned_at DESC);
+CREATE INDEX idx_entity_status_current ON entity_status (entity_type, entity_id, id DESC);
+CREATE INDEX idx_status_assigned ON entity_status (assigned_to, status);
+CREATE INDEX idx_status_priority ON entity_status (priority, status, transitioned_at);
+CREATE INDEX idx_status_type ON entity_status (entity_type, status);
+CREATE INDEX idx_entity_status_transitioned_at ON entity_status (transitioned_at);
+
+CREATE TABLE entity_current_status (
+    entity_type TEXT NOT NULL CHECK (entity_type IN ('PATIENT', 'STUDY', 'SERIES', 'IMAGE')),
+    entity_id INT NOT NULL,
+    status_id INT NOT NULL,
+    status TEXT NOT NULL CHECK (status IN ('SCHEDULED', 'PENDING', 'COMPLETED', 'CANCELLED', 'IN_PROGRESS', 'ABORTED')),
+    priority TEXT DEFAULT 'NORMAL' CHECK (priority IN ('URGENT', 'HIGH', 'NORMAL', 'LOW')),
+    assigned_to INT DEFAULT NULL,
+    transitioned_at TEXT NOT NULL,
+    PRIMARY KEY (entity_type, entity_id),
+    FOREIGN KEY (status_id) REFERENCES entity_status(id) ON DELETE CASCADE,
+    FOREIGN KEY (assigned_to) REFERENCES users(id) ON DELETE SET NULL
+);
+
+CREATE INDEX idx_current_status_type ON entity_current_status (entity_type, status, transitioned_at);
+CREATE INDEX idx_current_status_assigned ON entity_current_status (assigned_to, status, priority, transitioned_at);
+
+CREATE TABLE journal_applied_entries (
+    journal_id CHAR(36) NOT NULL,
+    sequence BIGINT NOT NULL,
+    applied_at TEXT NOT NULL DEFAULT (strftime('%Y-%m-%dT%H:%M:%f', 'now', 'localtime')),
+    PRIMARY KEY (journal_id, sequence)
+);
@@ -12,6 +12,7 @@ namespace Etrek::Core::Setting {
 
 	using Etrek::Core::Security::CryptoManager;
 	using Etrek::Core::Data::Model::DatabaseConnectionSetting;
+	using Etrek::Core::Data::Model::StorageBackend;
 	using Etrek::Core::Data::Model::FileLoggerSetting;
 	using Etrek::Core::Data::Model::RisConnectionSetting;
 
@@ -46,8 +47,21 @@ namespace Etrek::Core::Setting {
             m_databaseSetting->setIsPasswordEncrypted(dbObj["IsPasswordEncrypted"].toBool());
             m_databaseSetting->setPassword(dbObj["Password"].toString());
             m_databaseSetting->setEtrektUserName(dbObj["UserName"].toString());
-
-
+            m_databaseSetting->setPort(dbObj["Port"].toInt(3306));
+            m_databaseSetting->setSlowQueryThresholdMs(dbObj["SlowQueryThresholdMs"].toInt(200));
+            m_databaseSetting->setDumpQueryStatistics(dbObj["DumpQueryStatistics"].toBool(false));
+
+            // "SQLite" runs on an embedded store; DatabaseName is then the path of the store file
+            const bool isSqlite = dbObj["Backend"].toString().compare("SQLite", Qt::CaseInsensitive) == 0;
+            m_databaseSetting->setStorageBackend(isSqlite ? StorageBackend::Sqlite : StorageBackend::MySql);
+
+            // Local copy of the worklist used while the MySQL server is unreachable
+            const QString offlineStorePath = dbObj["OfflineStorePath"].toString();
+            if (!isSqlite && !offlineStorePath.isEmpty()) {
+                m_offlineStoreSetting = std::make_shared<DatabaseConnectionSetting>();
+                m_offlineStoreSetting->setStorageBackend(StorageBackend::Sqlite);
+                m_offlineStoreSetting->setDatabaseName(offlineStorePath);
+            }
 
             if (m_databaseSetting->getIsPasswordEncrypted()) {
                 QString decryptedPassword = securityServiceProvider.decryptPassword(m_databaseSetting->getPassword());
@@ -106,6 +120,11 @@ namespace Etrek::Core::Setting {
         return m_databaseSetting;
     }
 
+    std::shared_ptr<DatabaseConnectionSetting> SettingProvider::getOfflineStoreSettings() const
+    {
+        return m_offlineStoreSetting;
+    }
+
     std::shared_ptr<FileLoggerSetting> SettingProvider::getFileLoggerSettings() const
     {
         return m_fileLoggerSetting;
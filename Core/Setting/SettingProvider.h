@@ -54,6 +54,13 @@ namespace Etrek::Core::Setting {
         */
         std::shared_ptr<Etrek::Core::Data::Model::DatabaseConnectionSetting> getDatabaseConnectionSettings() const;
 
+        /**
+        *   @brief Retrieves the settings of the local SQLite offline store.
+        *   @return The store settings, or nullptr if no "OfflineStorePath" is configured
+        *           or the database itself is SQLite.
+        */
+        std::shared_ptr<Etrek::Core::Data::Model::DatabaseConnectionSetting> getOfflineStoreSettings() const;
+
         /**
         *  @brief Retrieves the current file logger settings.
         *  @return A shared pointer to the current FileLoggerSetting.
@@ -68,6 +75,7 @@ namespace Etrek::Core::Setting {
 
     private:
         std::shared_ptr<Etrek::Core::Data::Model::DatabaseConnectionSetting> m_databaseSetting; ///< Database connection settings
+        std::shared_ptr<Etrek::Core::Data::Model::DatabaseConnectionSetting> m_offlineStoreSetting; ///< Offline store settings, may be null
         std::shared_ptr<Etrek::Core::Data::Model::FileLoggerSetting> m_fileLoggerSetting; ///< File logger settings
         QVector<QSharedPointer<Etrek::Core::Data::Model::RisConnectionSetting>> m_risSetting; ///< RIS connection settings
     };
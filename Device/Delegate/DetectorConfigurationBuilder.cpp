@@ -1,11 +1,11 @@
 #include "DetectorConfigurationBuilder.h"
-#include "DeviceRepository.h"
+#include "DeviceRegistry.h"
 #include "Result.h"
 
 
 namespace Etrek::Device::Delegate
 {
-    using Etrek::Device::Repository::DeviceRepository;
+    using Etrek::Device::Repository::DeviceRegistry;
 
     DetectorConfigurationBuilder::DetectorConfigurationBuilder()
     {
@@ -20,11 +20,17 @@ namespace Etrek::Device::Delegate
             QWidget* parentWidget,
             QObject* parentDelegate)
     {
-        auto repository = std::make_shared<DeviceRepository>(params.dbConnection);
-		const auto nodes = repository->getDetectorList();
-        auto widget = new DetectorConfigurationWidget(nodes.value, parentWidget);
+        auto registry = DeviceRegistry::forDatabase(params.dbConnection);
+		const auto nodes = registry->getDetectorList();
+        auto widget = new DetectorConfigurationWidget(nodes, parentWidget);
         auto delegate = new DetectorConfigurationDelegate(widget, parentDelegate);
 
+        // Row-level refresh instead of rebuilding the table on every edit
+        QObject::connect(registry.get(), &DeviceRegistry::detectorChanged, widget, &DetectorConfigurationWidget::onDetectorChanged);
+        QObject::connect(registry.get(), &DeviceRegistry::reloaded, widget, [widget, registry = registry.get()]() {
+            widget->setDetectors(registry->getDetectorList());
+        });
+
         // If you need to attach other delegates:
         // if (delegate) delegate->AttachDelegates(params.delegates.values());
 
@@ -15,21 +15,20 @@ namespace Etrek::Device::Delegate
             QWidget* parentWidget,
             QObject* parentDelegate)
     {
-		auto repository = std::make_shared<Etrek::Device::Repository::DeviceRepository>(
-			params.dbConnection, nullptr);
+		auto registry = Etrek::Device::Repository::DeviceRegistry::forDatabase(params.dbConnection);
         //auto generatorManufactures = repository->getManufacturersList(DeviceType::GENERATOR);
         //auto tubeManufactures = repository->getManufacturersList(DeviceType::TUBE);
-		auto generators = repository->getGeneratorList();
-		auto xRayTubes = repository->getXRayTubesList();
+		auto generators = registry->getGeneratorList();
+		auto xRayTubes = registry->getXRayTubesList();
 		//auto generatorTubeConnections = repository->getActiveGeneratorTubes();
 
         auto widget = new GeneratorConfigurationWidget( 
-                                                       generators.value, 
+                                                       generators, 
                                                        
-                                                       xRayTubes.value,
+                                                       xRayTubes,
                                                        
                                                        parentWidget);
-        auto delegate = new GeneratorConfigurationDelegate(widget, repository, parentDelegate);
+        auto delegate = new GeneratorConfigurationDelegate(widget, registry, parentDelegate);
 
         // If you need to attach other delegates:
         // if (delegate) delegate->AttachDelegates(params.delegates.values());
@@ -5,7 +5,7 @@
 #include "GeneratorConfigurationDelegate.h"
 #include "GeneratorConfigurationWidget.h"
 #include "DelegateParameter.h"
-#include "DeviceRepository.h"
+#include "DeviceRegistry.h"
 #include <memory>
 
 namespace Etrek::Device::Delegate
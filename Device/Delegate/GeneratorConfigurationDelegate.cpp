@@ -2,11 +2,17 @@
 
 namespace Etrek::Device::Delegate
 {
-	using Etrek::Device::Repository::DeviceRepository;
+	using Etrek::Device::Repository::DeviceRegistry;
 
-	GeneratorConfigurationDelegate::GeneratorConfigurationDelegate(GeneratorConfigurationWidget* widget, std::shared_ptr<DeviceRepository> repository, QObject* parent)
-		: QObject(parent), m_widget(widget), m_repository(repository)
+	GeneratorConfigurationDelegate::GeneratorConfigurationDelegate(GeneratorConfigurationWidget* widget, std::shared_ptr<DeviceRegistry> registry, QObject* parent)
+		: QObject(parent), m_widget(widget), m_registry(registry)
 	{
+		// Keep the tables in step with the registry, one row at a time
+		connect(m_registry.get(), &DeviceRegistry::generatorChanged, m_widget, &GeneratorConfigurationWidget::onGeneratorChanged);
+		connect(m_registry.get(), &DeviceRegistry::xRayTubeChanged, m_widget, &GeneratorConfigurationWidget::onXRayTubeChanged);
+		connect(m_registry.get(), &DeviceRegistry::reloaded, m_widget, [this]() {
+			m_widget->setDevices(m_registry->getGeneratorList(), m_registry->getXRayTubesList());
+		});
 	}
 
 	GeneratorConfigurationDelegate::~GeneratorConfigurationDelegate()
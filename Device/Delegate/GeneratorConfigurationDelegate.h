@@ -4,7 +4,7 @@
 #include <QWidget>
 #include "IDelegate.h"
 #include "IPageAction.h"
-#include "DeviceRepository.h"
+#include "DeviceRegistry.h"
 #include "GeneratorConfigurationWidget.h"
 
 namespace Etrek::Device::Delegate
@@ -20,7 +20,7 @@ namespace Etrek::Device::Delegate
 		Q_INTERFACES(IDelegate IPageAction)
 
 	public:
-		GeneratorConfigurationDelegate(GeneratorConfigurationWidget* widget, std::shared_ptr<rpo::DeviceRepository> repository,QObject* parent);
+		GeneratorConfigurationDelegate(GeneratorConfigurationWidget* widget, std::shared_ptr<rpo::DeviceRegistry> registry, QObject* parent);
 
 		QString name() const override;
 		void attachDelegates(const QVector<QObject*>& delegates) override;
@@ -28,7 +28,7 @@ namespace Etrek::Device::Delegate
 		~GeneratorConfigurationDelegate();
 	private:
 		GeneratorConfigurationWidget* m_widget;
-		std::shared_ptr<rpo::DeviceRepository> m_repository;
+		std::shared_ptr<rpo::DeviceRegistry> m_registry;
 
 		// Inherited via IPageAction
 		void apply() override;
@@ -0,0 +1,307 @@
+#include "DeviceRegistry.h"
+#include <QMutexLocker>
+#include <QDebug>
+#include <atomic>
+#include "AppLoggerFactory.h"
+#include "MessageKey.h"
+#include "PerConnectionRegistry.h"
+
+namespace Etrek::Device::Repository
+{
+    using Etrek::Core::Data::Model::DatabaseConnectionSetting;
+    using Etrek::Core::Repository::PerConnectionRegistry;
+    using Etrek::Core::Globalization::TranslationProvider;
+    using Etrek::Core::Log::LoggerProvider;
+    using Etrek::Core::Log::AppLoggerFactory;
+    using Etrek::Device::Data::Entity::Generator;
+    using Etrek::Device::Data::Entity::XRayTube;
+    using Etrek::Device::Data::Entity::Detector;
+    using Etrek::Device::Data::Entity::DeviceConnection;
+    using Etrek::Specification::Result;
+
+    namespace {
+
+        template <typename T>
+        void buildIndex(const QVector<T>& rows, QHash<int, int>& index)
+        {
+            index.clear();
+            index.reserve(rows.size());
+            for (int i = 0; i < rows.size(); ++i)
+                index.insert(rows[i].Id, i);
+        }
+
+        // Replaces the row with the same Id, or appends it
+        template <typename T>
+        void putRow(QVector<T>& rows, QHash<int, int>& index, const T& row)
+        {
+            const auto it = index.constFind(row.Id);
+            if (it != index.constEnd()) {
+                rows[it.value()] = row;
+                return;
+            }
+            index.insert(row.Id, rows.size());
+            rows.push_back(row);
+        }
+
+        template <typename Pred>
+        QVector<DeviceConnection> filterConnections(const QVector<DeviceConnection>& connections, Pred pred)
+        {
+            QVector<DeviceConnection> result;
+            for (const auto& c : connections) {
+                if (pred(c))
+                    result.push_back(c);
+            }
+            return result;
+        }
+    }
+
+    void DeviceRegistry::Snapshot::reindex()
+    {
+        buildIndex(Generators, GeneratorIndex);
+        buildIndex(XRayTubes, XRayTubeIndex);
+        buildIndex(Detectors, DetectorIndex);
+    }
+
+    std::shared_ptr<DeviceRegistry> DeviceRegistry::forDatabase(std::shared_ptr<DatabaseConnectionSetting> connectionSetting)
+    {
+        static PerConnectionRegistry<DeviceRegistry> registries;
+        return registries.instanceFor(*connectionSetting, [&connectionSetting] {
+            return std::make_shared<DeviceRegistry>(std::make_shared<DeviceRepository>(connectionSetting));
+        });
+    }
+
+    DeviceRegistry::DeviceRegistry(std::shared_ptr<DeviceRepository> repository, QObject* parent)
+        : QObject(parent)
+        , m_repository(std::move(repository))
+        , translator(&TranslationProvider::Instance())
+    {
+        AppLoggerFactory factory(LoggerProvider::Instance(), translator);
+        logger = factory.CreateLogger("DeviceRegistry");
+    }
+
+    DeviceRegistry::~DeviceRegistry() = default;
+
+    Result<std::shared_ptr<const DeviceRegistry::Snapshot>> DeviceRegistry::loadSnapshot() const
+    {
+        auto snapshot = std::make_shared<Snapshot>();
+
+        auto generators = m_repository->getGeneratorList();
+        if (!generators.isSuccess)
+            return Result<std::shared_ptr<const Snapshot>>::Failure(generators.message);
+        auto tubes = m_repository->getXRayTubesList();
+        if (!tubes.isSuccess)
+            return Result<std::shared_ptr<const Snapshot>>::Failure(tubes.message);
+        auto detectors = m_repository->getDetectorList();
+        if (!detectors.isSuccess)
+            return Result<std::shared_ptr<const Snapshot>>::Failure(detectors.message);
+        auto connections = m_repository->getDeviceConnectionList();
+        if (!connections.isSuccess)
+            return Result<std::shared_ptr<const Snapshot>>::Failure(connections.message);
+
+        snapshot->Generators = std::move(generators.value);
+        snapshot->XRayTubes = std::move(tubes.value);
+        snapshot->Detectors = std::move(detectors.value);
+        snapshot->Connections = std::move(connections.value);
+        snapshot->reindex();
+
+        logger->LogInfo(translator->getInfoMessage(DEV_REGISTRY_LOADED_MSG)
+            .arg(snapshot->Generators.size())
+            .arg(snapshot->XRayTubes.size())
+            .arg(snapshot->Detectors.size())
+            .arg(snapshot->Connections.size()));
+
+        return Result<std::shared_ptr<const Snapshot>>::Success(snapshot);
+    }
+
+    Result<void> DeviceRegistry::reload()
+    {
+        {
+            QMutexLocker locker(&m_writeMutex);
+            auto loaded = loadSnapshot();
+            if (!loaded.isSuccess)
+                return Result<void>::Failure(loaded.message);
+            std::atomic_store(&m_snapshot, loaded.value);
+        }
+
+        emit reloaded();
+        return Result<void>::Success();
+    }
+
+    bool DeviceRegistry::isLoaded() const
+    {
+        return std::atomic_load(&m_snapshot) != nullptr;
+    }
+
+    std::shared_ptr<const DeviceRegistry::Snapshot> DeviceRegistry::current() const
+    {
+        auto snapshot = std::atomic_load(&m_snapshot);
+        if (snapshot)
+            return snapshot;
+
+        QMutexLocker locker(&m_writeMutex);
+        return currentLocked();
+    }
+
+    std::shared_ptr<const DeviceRegistry::Snapshot> DeviceRegistry::currentLocked() const
+    {
+        auto snapshot = std::atomic_load(&m_snapshot);
+        if (snapshot)
+            return snapshot;
+
+        auto loaded = loadSnapshot();
+        if (!loaded.isSuccess) {
+            // Not published, so the next call retries the load
+            qDebug() << loaded.message;
+            static const auto empty = std::make_shared<const Snapshot>();
+            return empty;
+        }
+
+        std::atomic_store(&m_snapshot, loaded.value);
+        return loaded.value;
+    }
+
+    // -------- generators --------
+
+    QVector<Generator> DeviceRegistry::getGeneratorList() const
+    {
+        return current()->Generators;
+    }
+
+    Result<Generator> DeviceRegistry::getGeneratorById(int id) const
+    {
+        const auto snapshot = current();
+        const auto it = snapshot->GeneratorIndex.constFind(id);
+        if (it == snapshot->GeneratorIndex.constEnd())
+            return Result<Generator>::Failure(translator->getErrorMessage(DEV_GENERATOR_NOT_FOUND_ERROR).arg(id));
+        return Result<Generator>::Success(snapshot->Generators[it.value()]);
+    }
+
+    Result<Generator> DeviceRegistry::updateGenerator(const Generator& generator)
+    {
+        QVector<Generator> changed;
+        {
+            QMutexLocker locker(&m_writeMutex);
+            auto written = m_repository->updateGenerator(generator);
+            if (!written.isSuccess)
+                return written;
+
+            auto next = std::make_shared<Snapshot>(*currentLocked());
+            putRow(next->Generators, next->GeneratorIndex, written.value);
+            changed.push_back(written.value);
+
+            // The repository cleared the same output flag on every other generator
+            const bool output1 = written.value.IsOutput1Active && written.value.Output1 != -1;
+            const bool output2 = written.value.IsOutput2Active && written.value.Output2 != -1;
+            for (auto& other : next->Generators) {
+                if (other.Id == written.value.Id)
+                    continue;
+                const bool clear1 = output1 && other.IsOutput1Active;
+                const bool clear2 = output2 && other.IsOutput2Active;
+                if (!clear1 && !clear2)
+                    continue;
+                if (clear1) other.IsOutput1Active = false;
+                if (clear2) other.IsOutput2Active = false;
+                changed.push_back(other);
+            }
+
+            std::atomic_store(&m_snapshot, std::shared_ptr<const Snapshot>(std::move(next)));
+        }
+
+        for (const auto& g : changed)
+            emit generatorChanged(g);
+        return Result<Generator>::Success(changed.first());
+    }
+
+    // -------- tubes --------
+
+    QVector<XRayTube> DeviceRegistry::getXRayTubesList() const
+    {
+        return current()->XRayTubes;
+    }
+
+    Result<XRayTube> DeviceRegistry::getXRayTube(int tubeId) const
+    {
+        const auto snapshot = current();
+        const auto it = snapshot->XRayTubeIndex.constFind(tubeId);
+        if (it == snapshot->XRayTubeIndex.constEnd())
+            return Result<XRayTube>::Failure(translator->getErrorMessage(DEV_XRAY_TUBE_NOT_FOUND_ERROR).arg(tubeId));
+        return Result<XRayTube>::Success(snapshot->XRayTubes[it.value()]);
+    }
+
+    Result<XRayTube> DeviceRegistry::updateXRayTube(const XRayTube& tube)
+    {
+        Result<XRayTube> written = Result<XRayTube>::Failure(QString());
+        {
+            QMutexLocker locker(&m_writeMutex);
+            written = m_repository->updateXRayTube(tube);
+            if (!written.isSuccess)
+                return written;
+
+            auto next = std::make_shared<Snapshot>(*currentLocked());
+            putRow(next->XRayTubes, next->XRayTubeIndex, written.value);
+            std::atomic_store(&m_snapshot, std::shared_ptr<const Snapshot>(std::move(next)));
+        }
+
+        emit xRayTubeChanged(written.value);
+        return written;
+    }
+
+    // -------- detectors --------
+
+    QVector<Detector> DeviceRegistry::getDetectorList() const
+    {
+        return current()->Detectors;
+    }
+
+    Result<Detector> DeviceRegistry::getDetectorById(int detectorId) const
+    {
+        const auto snapshot = current();
+        const auto it = snapshot->DetectorIndex.constFind(detectorId);
+        if (it == snapshot->DetectorIndex.constEnd())
+            return Result<Detector>::Failure(translator->getErrorMessage(DEV_DETECTOR_NOT_FOUND_ERROR).arg(detectorId));
+        return Result<Detector>::Success(snapshot->Detectors[it.value()]);
+    }
+
+    Result<Detector> DeviceRegistry::updateDetector(const Detector& detector)
+    {
+        Result<Detector> written = Result<Detector>::Failure(QString());
+        {
+            QMutexLocker locker(&m_writeMutex);
+            written = m_repository->updateDetector(detector);
+            if (!written.isSuccess)
+                return written;
+
+            auto next = std::make_shared<Snapshot>(*currentLocked());
+            putRow(next->Detectors, next->DetectorIndex, written.value);
+            std::atomic_store(&m_snapshot, std::shared_ptr<const Snapshot>(std::move(next)));
+        }
+
+        emit detectorChanged(written.value);
+        return written;
+    }
+
+    // -------- device connections --------
+
+    QVector<DeviceConnection> DeviceRegistry::getDeviceConnectionList() const
+    {
+        return current()->Connections;
+    }
+
+    QVector<DeviceConnection> DeviceRegistry::getConnectionsForGenerator(int generatorId) const
+    {
+        return filterConnections(current()->Connections,
+            [generatorId](const DeviceConnection& c) { return c.GeneratorId == generatorId; });
+    }
+
+    QVector<DeviceConnection> DeviceRegistry::getConnectionsForXRayTube(int tubeId) const
+    {
+        return filterConnections(current()->Connections,
+            [tubeId](const DeviceConnection& c) { return c.TubeId == tubeId; });
+    }
+
+    QVector<DeviceConnection> DeviceRegistry::getConnectionsForDetector(int detectorId) const
+    {
+        return filterConnections(current()->Connections,
+            [detectorId](const DeviceConnection& c) { return c.DetectorId == detectorId; });
+    }
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <memory>
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QVector>
+
+#include "Result.h"
+#include "DeviceRepository.h"
+
+namespace Etrek::Device::Repository
+{
+    /**
+     * @class DeviceRegistry
+     * @brief In-memory copy of the device configuration, shared by everything connected to one database.
+     *
+     * Generators, X-ray tubes, detectors and their device connections are loaded once and
+     * served from memory afterwards. Lookups read an immutable snapshot with a single atomic
+     * load, so they never block and are safe from any thread.
+     *
+     * Updates write through to DeviceRepository first and only then replace the affected rows
+     * in a new snapshot. Each changed row is announced with its own signal, so table models can
+     * refresh that row instead of resetting.
+     */
+    class DeviceRegistry : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        /**
+         * @brief Returns the registry shared by all callers connected to the same database.
+         * The registry loads itself on first use.
+         */
+        static std::shared_ptr<DeviceRegistry> forDatabase(
+            std::shared_ptr<Etrek::Core::Data::Model::DatabaseConnectionSetting> connectionSetting);
+
+        explicit DeviceRegistry(std::shared_ptr<DeviceRepository> repository, QObject* parent = nullptr);
+        ~DeviceRegistry() override;
+
+        /**
+         * @brief Loads all devices from the database and replaces the in-memory copy.
+         * Emits @ref reloaded() on success.
+         */
+        Etrek::Specification::Result<void> reload();
+
+        /** @brief True once the registry holds data. */
+        bool isLoaded() const;
+
+        // Generators
+        QVector<Etrek::Device::Data::Entity::Generator> getGeneratorList() const;
+        Etrek::Specification::Result<Etrek::Device::Data::Entity::Generator> getGeneratorById(int id) const;
+        Etrek::Specification::Result<Etrek::Device::Data::Entity::Generator> updateGenerator(const Etrek::Device::Data::Entity::Generator& generator);
+
+        // X-ray tubes
+        QVector<Etrek::Device::Data::Entity::XRayTube> getXRayTubesList() const;
+        Etrek::Specification::Result<Etrek::Device::Data::Entity::XRayTube> getXRayTube(int tubeId) const;
+        Etrek::Specification::Result<Etrek::Device::Data::Entity::XRayTube> updateXRayTube(const Etrek::Device::Data::Entity::XRayTube& tube);
+
+        // Detectors
+        QVector<Etrek::Device::Data::Entity::Detector> getDetectorList() const;
+        Etrek::Specification::Result<Etrek::Device::Data::Entity::Detector> getDetectorById(int detectorId) const;
+        Etrek::Specification::Result<Etrek::Device::Data::Entity::Detector> updateDetector(const Etrek::Device::Data::Entity::Detector& detector);
+
+        // Device connections
+        QVector<Etrek::Device::Data::Entity::DeviceConnection> getDeviceConnectionList() const;
+        QVector<Etrek::Device::Data::Entity::DeviceConnection> getConnectionsForGenerator(int generatorId) const;
+        QVector<Etrek::Device::Data::Entity::DeviceConnection> getConnectionsForXRayTube(int tubeId) const;
+        QVector<Etrek::Device::Data::Entity::DeviceConnection> getConnectionsForDetector(int detectorId) const;
+
+    signals:
+        /** @brief A generator row changed (also emitted for rows whose output was deactivated). */
+        void generatorChanged(const Etrek::Device::Data::Entity::Generator& generator);
+
+        /** @brief An X-ray tube row changed. */
+        void xRayTubeChanged(const Etrek::Device::Data::Entity::XRayTube& tube);
+
+        /** @brief A detector row changed. */
+        void detectorChanged(const Etrek::Device::Data::Entity::Detector& detector);
+
+        /** @brief The whole registry was reloaded; models should reset. */
+        void reloaded();
+
+    private:
+        struct Snapshot
+        {
+            QVector<Etrek::Device::Data::Entity::Generator> Generators;
+            QVector<Etrek::Device::Data::Entity::XRayTube> XRayTubes;
+            QVector<Etrek::Device::Data::Entity::Detector> Detectors;
+            QVector<Etrek::Device::Data::Entity::DeviceConnection> Connections;
+
+            QHash<int, int> GeneratorIndex;   // generator id -> index in Generators
+            QHash<int, int> XRayTubeIndex;    // tube id -> index in XRayTubes
+            QHash<int, int> DetectorIndex;    // detector id -> index in Detectors
+
+            void reindex();
+        };
+
+        Etrek::Specification::Result<std::shared_ptr<const Snapshot>> loadSnapshot() const;
+
+        // Loads on first use; returns the current snapshot (empty if the load failed)
+        std::shared_ptr<const Snapshot> current() const;
+        std::shared_ptr<const Snapshot> currentLocked() const; // caller holds m_writeMutex
+
+        std::shared_ptr<DeviceRepository> m_repository;
+        mutable std::shared_ptr<const Snapshot> m_snapshot;
+        mutable QMutex m_writeMutex; // serializes loads and write-throughs; readers never take it
+        Etrek::Core::Globalization::TranslationProvider* translator; // non-owning
+        std::shared_ptr<Etrek::Core::Log::AppLogger> logger;
+    };
+}
@@ -2,9 +2,12 @@
 #include <QSqlError>
 #include <QVariant>
 #include <QSet>
-#include <QRandomGenerator>
+#include <QJsonDocument>
+#include <QHash>
 #include "DeviceRepository.h"
 #include "AppLoggerFactory.h"
+#include "DatabaseConnectionPool.h"
+#include "QueryStatistics.h"
 #include "MessageKey.h"
 #include "DetectorUtils.h"
 
@@ -22,9 +25,30 @@ namespace Etrek::Device::Repository
 	using Etrek::Device::Data::Entity::Institution;
 	using Etrek::Device::Data::Entity::GeneralEquipment;
     using Etrek::Device::Data::Entity::EnvironmentSetting;
+    using Etrek::Device::Data::Entity::DeviceConnection;
+    using Etrek::Core::Repository::DatabaseConnectionPool;
+    using Etrek::Core::Repository::QueryStatistics;
 
     static inline QString kRepoName() { return "DeviceRepository"; }
 
+    // device_connections.protocol stores the enum names (RS_232, MODBUS_TCP, ...), not the UI strings
+    static Etrek::Device::ConnectionProtocol protocolFromColumn(const QString& value)
+    {
+        using Etrek::Device::ConnectionProtocol;
+        static const QHash<QString, ConnectionProtocol> protocols = {
+            { "RS_232", ConnectionProtocol::RS_232 },
+            { "RS_485", ConnectionProtocol::RS_485 },
+            { "CAN", ConnectionProtocol::CAN },
+            { "LAN", ConnectionProtocol::LAN },
+            { "MODBUS_RTU", ConnectionProtocol::MODBUS_RTU },
+            { "MODBUS_TCP", ConnectionProtocol::MODBUS_TCP },
+            { "WIFI", ConnectionProtocol::WIFI },
+            { "USB", ConnectionProtocol::USB },
+            { "ANALOG", ConnectionProtocol::ANALOG }
+        };
+        return protocols.value(value.toUpper(), Etrek::Device::ConnectionProtocolUtils::parse(value));
+    }
+
     DeviceRepository::DeviceRepository(std::shared_ptr<DatabaseConnectionSetting> connectionSetting,
         TranslationProvider* tr)
         : m_connectionSetting(std::move(connectionSetting)),
@@ -36,30 +60,19 @@ namespace Etrek::Device::Repository
 
     DeviceRepository::~DeviceRepository() = default;
 
-    QSqlDatabase DeviceRepository::createConnection(const QString& connectionName) const
-    {
-        QSqlDatabase db = QSqlDatabase::addDatabase("QMYSQL", connectionName);
-        db.setHostName(m_connectionSetting->getHostName());
-        db.setDatabaseName(m_connectionSetting->getDatabaseName());
-        db.setUserName(m_connectionSetting->getEtrekUserName());
-        db.setPassword(m_connectionSetting->getPassword());
-        db.setPort(m_connectionSetting->getPort());
-        return db;
-    }
-
     // -------- generators --------
 
     Etrek::Specification::Result<QVector<Generator>> DeviceRepository::getGeneratorList() const
     {
         QVector<Generator> generators;
-        const QString connectionName = "dev_conn_gen_list_" + QString::number(QRandomGenerator::global()->generate());
 
         {
             // Scoped connection
-            QSqlDatabase db = createConnection(connectionName);
-            if (!db.open()) {
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
                 const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG)
-                    .arg(db.lastError().text());
+                    .arg(lease.lastError());
                 logger->LogError(err);
                 return Etrek::Specification::Result<QVector<Generator>>::Failure(err);
             }
@@ -89,7 +102,7 @@ namespace Etrek::Device::Repository
             ORDER BY id
         )");
 
-            if (!query.exec()) {
+            if (!QueryStatistics::exec(query)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG)
                     .arg(query.lastError().text());
                 logger->LogError(err);
@@ -125,17 +138,16 @@ namespace Etrek::Device::Repository
             }
         } // <--- Scoped connection ends here, db will be destroyed
 
-        QSqlDatabase::removeDatabase(connectionName);
         return Etrek::Specification::Result<QVector<Generator>>::Success(generators);
     }
 
     Etrek::Specification::Result<Generator> DeviceRepository::getGeneratorById(int id) const
     {
-        const QString connectionName = QString("dev_conn_gen_%1").arg(id);
-        QSqlDatabase db = createConnection(connectionName);
-        if (!db.open()) {
+        auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+        QSqlDatabase& db = lease.database();
+        if (!db.isOpen()) {
             const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG)
-                .arg(db.lastError().text());
+                .arg(lease.lastError());
             logger->LogError(err);
             return Etrek::Specification::Result<Generator>::Failure(err);
         }
@@ -167,16 +179,14 @@ namespace Etrek::Device::Repository
 
         query.bindValue(":id", id);
 
-        if (!query.exec()) {
+        if (!QueryStatistics::exec(query)) {
             const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG)
                 .arg(query.lastError().text());
             logger->LogError(err);
-            QSqlDatabase::removeDatabase(connectionName);
             return Etrek::Specification::Result<Generator>::Failure(err);
         }
 
         if (!query.next()) {
-            QSqlDatabase::removeDatabase(connectionName);
             return Etrek::Specification::Result<Generator>::Failure(QString("Generator with id %1 not found").arg(id));
         }
 
@@ -202,7 +212,6 @@ namespace Etrek::Device::Repository
         gen.CreateDate = query.value("create_date").toDateTime();
         gen.UpdateDate = query.value("update_date").toDateTime();
 
-        QSqlDatabase::removeDatabase(connectionName);
         return Etrek::Specification::Result<Generator>::Success(gen);
     }
 
@@ -212,12 +221,12 @@ namespace Etrek::Device::Repository
             return Etrek::Specification::Result<Generator>::Failure("Cannot update generator: invalid Id (-1).");
         }
 
-        const QString connectionName = QString("dev_conn_update_gen_%1").arg(generator.Id);
         {
-            QSqlDatabase db = createConnection(connectionName);
-            if (!db.open()) {
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
                 const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG)
-                    .arg(db.lastError().text());
+                    .arg(lease.lastError());
                 logger->LogError(err);
                 return Etrek::Specification::Result<Generator>::Failure(err);
             }
@@ -274,15 +283,13 @@ namespace Etrek::Device::Repository
             query.bindValue(":update_date", QDateTime::currentDateTime());
             query.bindValue(":id", generator.Id);
 
-            if (!query.exec()) {
+            if (!QueryStatistics::exec(query)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG)
                     .arg(query.lastError().text());
                 logger->LogError(err);
-                QSqlDatabase::removeDatabase(connectionName);
                 return Etrek::Specification::Result<Generator>::Failure(err);
             }
         }
-        QSqlDatabase::removeDatabase(connectionName);
         return Etrek::Specification::Result<Generator>::Success(generator);
     }
 
@@ -299,7 +306,7 @@ namespace Etrek::Device::Repository
         query.prepare(QString("UPDATE generators SET %1 = 0 WHERE id != ? AND %2 != 0").arg(field, field));
         query.addBindValue(excludeGeneratorId);
 
-        if (!query.exec()) {
+        if (!QueryStatistics::exec(query)) {
             errorMessage = QString("Failed to deactivate other generators on output%1: %2").arg(outputNumber).arg(query.lastError().text());
             logger->LogError(errorMessage);
             return false;
@@ -313,16 +320,15 @@ namespace Etrek::Device::Repository
 
     Etrek::Specification::Result<XRayTube> DeviceRepository::getXRayTube(int tubeId) const
     {
-        const QString connectionName = "dev_conn_xray_single_" + QString::number(QRandomGenerator::global()->generate());
-
         XRayTube tube;
 
         {
             // Scoped connection
-            QSqlDatabase db = createConnection(connectionName);
-            if (!db.open()) {
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
                 const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG)
-                    .arg(db.lastError().text());
+                    .arg(lease.lastError());
                 logger->LogError(err);
                 return Etrek::Specification::Result<XRayTube>::Failure(err);
             }
@@ -353,7 +359,7 @@ namespace Etrek::Device::Repository
         )");
             query.bindValue(":tubeId", tubeId);
 
-            if (!query.exec()) {
+            if (!QueryStatistics::exec(query)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG)
                     .arg(query.lastError().text());
                 logger->LogError(err);
@@ -388,21 +394,20 @@ namespace Etrek::Device::Repository
             tube.UpdateDate = query.value("update_date").toDateTime();
         }
 
-        QSqlDatabase::removeDatabase(connectionName);
         return Etrek::Specification::Result<XRayTube>::Success(tube);
     }
 
     Etrek::Specification::Result<QVector<XRayTube>> DeviceRepository::getXRayTubesList() const
     {
         QVector<XRayTube> tubes;
-        const QString connectionName = "dev_conn_xray_list_" + QString::number(QRandomGenerator::global()->generate());
 
         {
             // Scoped DB connection
-            QSqlDatabase db = createConnection(connectionName);
-            if (!db.open()) {
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
                 const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG)
-                    .arg(db.lastError().text());
+                    .arg(lease.lastError());
                 logger->LogError(err);
                 return Etrek::Specification::Result<QVector<XRayTube>>::Failure(err);
             }
@@ -431,7 +436,7 @@ namespace Etrek::Device::Repository
             ORDER BY manufacturer, model_number
         )");
 
-            if (!query.exec()) {
+            if (!QueryStatistics::exec(query)) {
                 QString err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG)
                     .arg(query.lastError().text());
                 logger->LogError(err);
@@ -467,19 +472,17 @@ namespace Etrek::Device::Repository
             }
         } // Scoped connection ends here
 
-        QSqlDatabase::removeDatabase(connectionName);
         return Etrek::Specification::Result<QVector<XRayTube>>::Success(tubes);
     }
 
     Etrek::Specification::Result<XRayTube> DeviceRepository::updateXRayTube(const XRayTube& tube)
     {
-        const QString connectionName = "dev_conn_update_xray_" + QString::number(QRandomGenerator::global()->generate());
-
         {
-            QSqlDatabase db = createConnection(connectionName);
-            if (!db.open()) {
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
                 const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG)
-                    .arg(db.lastError().text());
+                    .arg(lease.lastError());
                 logger->LogError(err);
                 return Etrek::Specification::Result<XRayTube>::Failure(err);
             }
@@ -533,7 +536,7 @@ namespace Etrek::Device::Repository
             query.bindValue(":installationDate", tube.InstallationDate.isValid() ? tube.InstallationDate : QVariant(QVariant::Date));
             query.bindValue(":calibrationDate", tube.CalibrationDate.isValid() ? tube.CalibrationDate : QVariant(QVariant::Date));
 
-            if (!query.exec()) {
+            if (!QueryStatistics::exec(query)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG)
                     .arg(query.lastError().text());
                 logger->LogError(err);
@@ -551,13 +554,13 @@ namespace Etrek::Device::Repository
     {
         QVector<Detector> detectors;
 
-        const QString connectionName = "detector_list_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(connectionName);
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
 
-            if (!db.open()) {
+            if (!db.isOpen()) {
                 const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG)
-                    .arg(db.lastError().text());
+                    .arg(lease.lastError());
                 logger->LogError(err);
                 return Etrek::Specification::Result<QVector<Detector>>::Failure(err);
             }
@@ -589,11 +592,10 @@ namespace Etrek::Device::Repository
         ORDER BY manufacturer, model_name
     )");
 
-            if (!query.exec()) {
+            if (!QueryStatistics::exec(query)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG)
                     .arg(query.lastError().text());
                 logger->LogError(err);
-                QSqlDatabase::removeDatabase(connectionName);
                 return Etrek::Specification::Result<QVector<Etrek::Device::Data::Entity::Detector>>::Failure(err);
             }
 
@@ -628,22 +630,21 @@ namespace Etrek::Device::Repository
 
         }
 
-        QSqlDatabase::removeDatabase(connectionName);
         return Etrek::Specification::Result<QVector<Detector>>::Success(detectors);
     }
 
     Etrek::Specification::Result<Detector> DeviceRepository::getDetectorById(int detectorId) const
     {
-        const QString connectionName = "detector_by_id_" + QString::number(QRandomGenerator::global()->generate());
         Detector d;
 
         {
             // Scoped database connection
-            QSqlDatabase db = createConnection(connectionName);
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
 
-            if (!db.open()) {
+            if (!db.isOpen()) {
                 const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG)
-                    .arg(db.lastError().text());
+                    .arg(lease.lastError());
                 logger->LogError(err);
                 return Etrek::Specification::Result<Detector>::Failure(err);
             }
@@ -681,7 +682,7 @@ namespace Etrek::Device::Repository
         )");
             query.addBindValue(detectorId);
 
-            if (!query.exec()) {
+            if (!QueryStatistics::exec(query)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG)
                     .arg(query.lastError().text());
                 logger->LogError(err);
@@ -716,17 +717,16 @@ namespace Etrek::Device::Repository
             }
         } // <- db goes out of scope here
 
-        QSqlDatabase::removeDatabase(connectionName);
         return Etrek::Specification::Result<Detector>::Failure("Detector not found");
     }
 
     Etrek::Specification::Result<Detector> DeviceRepository::updateDetector(const Detector& detector)
     {
-        const QString cx = "update_detector_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                auto err = QString("Failed to open database: %1").arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                auto err = QString("Failed to open database: %1").arg(lease.lastError());
                 logger->LogError(err);
                 return Etrek::Specification::Result<Detector>::Failure(err);
             }
@@ -784,28 +784,91 @@ namespace Etrek::Device::Repository
 
             query.addBindValue(detector.Id);
 
-            if (!query.exec()) {
+            if (!QueryStatistics::exec(query)) {
                 auto err = QString("Failed to update detector: %1").arg(query.lastError().text());
                 logger->LogError(err);
                 return Etrek::Specification::Result<Detector>::Failure(err);
             }
         } // db goes out of scope
 
-        QSqlDatabase::removeDatabase(cx);
         return Etrek::Specification::Result<Detector>::Success(detector);
     }
 
 
+    // -------- device connections --------
+
+    Etrek::Specification::Result<QVector<DeviceConnection>> DeviceRepository::getDeviceConnectionList() const
+    {
+        QVector<DeviceConnection> connections;
+
+        {
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG)
+                    .arg(lease.lastError());
+                logger->LogError(err);
+                return Etrek::Specification::Result<QVector<DeviceConnection>>::Failure(err);
+            }
+
+            QSqlQuery query(db);
+            query.prepare(R"(
+            SELECT id,
+                   generator_id,
+                   detector_id,
+                   tube_id,
+                   positioner_id,
+                   connector,
+                   protocol,
+                   interface_name,
+                   parameters
+            FROM device_connections
+            ORDER BY id
+        )");
+
+            if (!QueryStatistics::exec(query)) {
+                const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG)
+                    .arg(query.lastError().text());
+                logger->LogError(err);
+                return Etrek::Specification::Result<QVector<DeviceConnection>>::Failure(err);
+            }
+
+            auto optionalId = [&query](const char* column) {
+                const QVariant v = query.value(column);
+                return v.isNull() ? -1 : v.toInt();
+            };
+
+            while (query.next()) {
+                DeviceConnection c;
+
+                c.Id = query.value("id").toInt();
+                c.GeneratorId = optionalId("generator_id");
+                c.DetectorId = optionalId("detector_id");
+                c.TubeId = optionalId("tube_id");
+                c.PosinionerId = optionalId("positioner_id");
+                c.Connector = Etrek::Device::ConnectorUtils::parse(query.value("connector").toString());
+                c.Protocol = protocolFromColumn(query.value("protocol").toString());
+                c.InterfaceName = query.value("interface_name").toString();
+                c.Parameters = QJsonDocument::fromJson(query.value("parameters").toByteArray()).object();
+
+                connections.append(c);
+            }
+        }
+
+        return Etrek::Specification::Result<QVector<DeviceConnection>>::Success(connections);
+    }
+
+
     // -------------------- Institutions --------------------
 
     Etrek::Specification::Result<QVector<Institution>> DeviceRepository::getInstitutionList() const
     {
         QVector<Institution> vec;
-        const QString cx = "inst_list_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(err);
                 return Etrek::Specification::Result<QVector<Institution>>::Failure(err);
             }
@@ -818,7 +881,7 @@ namespace Etrek::Device::Repository
             ORDER BY name
         )");
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
                 return Etrek::Specification::Result<QVector<Institution>>::Failure(err);
@@ -837,17 +900,16 @@ namespace Etrek::Device::Repository
                 vec.append(inst);
             }
         }
-        QSqlDatabase::removeDatabase(cx);
         return Etrek::Specification::Result<QVector<Institution>>::Success(vec);
     }
 
     Etrek::Specification::Result<Institution> DeviceRepository::getInstitutionById(int id) const
     {
-        const QString cx = "inst_by_id_" + QString::number(id);
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(err);
                 return Etrek::Specification::Result<Institution>::Failure(err);
             }
@@ -860,7 +922,7 @@ namespace Etrek::Device::Repository
         )");
             q.bindValue(":id", id);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
                 return Etrek::Specification::Result<Institution>::Failure(err);
@@ -880,19 +942,18 @@ namespace Etrek::Device::Repository
             inst.ContactInformation = q.value("contact_information").toString();
             inst.IsActive = q.value("is_active").toBool();
 
-            QSqlDatabase::removeDatabase(cx);
             return Etrek::Specification::Result<Institution>::Success(inst);
         }
     }
 
     Etrek::Specification::Result<Institution> DeviceRepository::createInstitution(const Institution& inst)
     {
-        const QString cx = "inst_create_" + QString::number(QRandomGenerator::global()->generate());
         int newId = -1;
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(err);
                 return Etrek::Specification::Result<Institution>::Failure(err);
             }
@@ -912,14 +973,13 @@ namespace Etrek::Device::Repository
             q.bindValue(":contact", inst.ContactInformation);
             q.bindValue(":active", inst.IsActive);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
                 return Etrek::Specification::Result<Institution>::Failure(err);
             }
             newId = q.lastInsertId().toInt();
         }
-        QSqlDatabase::removeDatabase(cx);
         return getInstitutionById(newId);
     }
 
@@ -927,11 +987,11 @@ namespace Etrek::Device::Repository
     {
         if (inst.Id <= 0) return Etrek::Specification::Result<Institution>::Failure("Invalid institution Id.");
 
-        const QString cx = "inst_update_" + QString::number(inst.Id);
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(err);
                 return Etrek::Specification::Result<Institution>::Failure(err);
             }
@@ -958,23 +1018,22 @@ namespace Etrek::Device::Repository
             q.bindValue(":active", inst.IsActive);
             q.bindValue(":id", inst.Id);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
                 return Etrek::Specification::Result<Institution>::Failure(err);
             }
         }
-        QSqlDatabase::removeDatabase(cx);
         return getInstitutionById(inst.Id);
     }
 
     Etrek::Specification::Result<bool> DeviceRepository::deleteInstitution(int id)
     {
-        const QString cx = "inst_delete_" + QString::number(id);
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(err);
                 return Etrek::Specification::Result<bool>::Failure(err);
             }
@@ -983,23 +1042,22 @@ namespace Etrek::Device::Repository
             q.prepare("DELETE FROM institutions WHERE id = :id");
             q.bindValue(":id", id);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
                 return Etrek::Specification::Result<bool>::Failure(err);
             }
         }
-        QSqlDatabase::removeDatabase(cx);
         return Etrek::Specification::Result<bool>::Success(true);
     }
 
     Etrek::Specification::Result<bool> DeviceRepository::deactivateInstitution(int id)
     {
-        const QString cx = "inst_deactivate_" + QString::number(id);
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(err);
                 return Etrek::Specification::Result<bool>::Failure(err);
             }
@@ -1008,13 +1066,12 @@ namespace Etrek::Device::Repository
             q.prepare(R"(UPDATE institutions SET is_active = 0, update_date = CURRENT_TIMESTAMP WHERE id = :id)");
             q.bindValue(":id", id);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
                 return Etrek::Specification::Result<bool>::Failure(err);
             }
         }
-        QSqlDatabase::removeDatabase(cx);
         return Etrek::Specification::Result<bool>::Success(true);
     }
 
@@ -1024,11 +1081,11 @@ namespace Etrek::Device::Repository
     Etrek::Specification::Result<QVector<GeneralEquipment>> DeviceRepository::getGeneralEquipmentList() const
     {
         QVector<GeneralEquipment> vec;
-        const QString cx = "ge_list_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(err);
                 return Etrek::Specification::Result<QVector<GeneralEquipment>>::Failure(err);
             }
@@ -1061,7 +1118,7 @@ namespace Etrek::Device::Repository
             ORDER BY ge.manufacturer, ge.model_name, ge.device_serial_number
         )");
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
                 return Etrek::Specification::Result<QVector<GeneralEquipment>>::Failure(err);
@@ -1096,17 +1153,16 @@ namespace Etrek::Device::Repository
                 vec.append(ge);
             }
         }
-        QSqlDatabase::removeDatabase(cx);
         return Etrek::Specification::Result<QVector<GeneralEquipment>>::Success(vec);
     }
 
     Etrek::Specification::Result<GeneralEquipment> DeviceRepository::getGeneralEquipmentById(int id) const
     {
-        const QString cx = "ge_by_id_" + QString::number(id);
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(err);
                 return Etrek::Specification::Result<GeneralEquipment>::Failure(err);
             }
@@ -1141,7 +1197,7 @@ namespace Etrek::Device::Repository
         )");
             q.bindValue(":id", id);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
                 return Etrek::Specification::Result<GeneralEquipment>::Failure(err);
@@ -1175,19 +1231,18 @@ namespace Etrek::Device::Repository
             ge.Institution.ContactInformation = q.value("inst_contact").toString();
             ge.Institution.IsActive = q.value("inst_is_active").toBool();
 
-            QSqlDatabase::removeDatabase(cx);
             return Etrek::Specification::Result<GeneralEquipment>::Success(ge);
         }
     }
 
     Etrek::Specification::Result<GeneralEquipment> DeviceRepository::createGeneralEquipment(const GeneralEquipment& ge)
     {
-        const QString cx = "ge_create_" + QString::number(QRandomGenerator::global()->generate());
         int newId = -1;
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(err);
                 return Etrek::Specification::Result<GeneralEquipment>::Failure(err);
             }
@@ -1222,14 +1277,13 @@ namespace Etrek::Device::Repository
             q.bindValue(":gantry", ge.GantryId);
             q.bindValue(":active", ge.IsActive);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
                 return Etrek::Specification::Result<GeneralEquipment>::Failure(err);
             }
             newId = q.lastInsertId().toInt();
         }
-        QSqlDatabase::removeDatabase(cx);
         return getGeneralEquipmentById(newId);
     }
 
@@ -1237,11 +1291,11 @@ namespace Etrek::Device::Repository
     {
         if (ge.Id <= 0) return Etrek::Specification::Result<GeneralEquipment>::Failure("Invalid GeneralEquipment Id.");
 
-        const QString cx = "ge_update_" + QString::number(ge.Id);
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(err);
                 return Etrek::Specification::Result<GeneralEquipment>::Failure(err);
             }
@@ -1283,23 +1337,22 @@ namespace Etrek::Device::Repository
             q.bindValue(":gantry", ge.GantryId);
             q.bindValue(":active", ge.IsActive);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
                 return Etrek::Specification::Result<GeneralEquipment>::Failure(err);
             }
         }
-        QSqlDatabase::removeDatabase(cx);
         return getGeneralEquipmentById(ge.Id);
     }
 
     Etrek::Specification::Result<bool> DeviceRepository::deleteGeneralEquipment(int id)
     {
-        const QString cx = "ge_delete_" + QString::number(id);
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(err);
                 return Etrek::Specification::Result<bool>::Failure(err);
             }
@@ -1308,23 +1361,22 @@ namespace Etrek::Device::Repository
             q.prepare("DELETE FROM general_equipments WHERE id = :id");
             q.bindValue(":id", id);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
                 return Etrek::Specification::Result<bool>::Failure(err);
             }
         }
-        QSqlDatabase::removeDatabase(cx);
         return Etrek::Specification::Result<bool>::Success(true);
     }
 
     Etrek::Specification::Result<bool> DeviceRepository::deactivateGeneralEquipment(int id)
     {
-        const QString cx = "ge_deactivate_" + QString::number(id);
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(err);
                 return Etrek::Specification::Result<bool>::Failure(err);
             }
@@ -1333,23 +1385,22 @@ namespace Etrek::Device::Repository
             q.prepare(R"(UPDATE general_equipments SET is_active = 0, update_date = CURRENT_TIMESTAMP WHERE id = :id)");
             q.bindValue(":id", id);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
                 return Etrek::Specification::Result<bool>::Failure(err);
             }
         }
-        QSqlDatabase::removeDatabase(cx);
         return Etrek::Specification::Result<bool>::Success(true);
     }
 
     Etrek::Specification::Result<EnvironmentSetting> DeviceRepository::getEnvironmentSettings() const
     {
-        const QString cx = "env_settings_get_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(err);
                 return Etrek::Specification::Result<EnvironmentSetting>::Failure(err);
             }
@@ -1373,7 +1424,7 @@ namespace Etrek::Device::Repository
             LIMIT 1
         )");
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
                 return Etrek::Specification::Result<EnvironmentSetting>::Failure(err);
@@ -1394,7 +1445,6 @@ namespace Etrek::Device::Repository
                 s.CreateDate = q.value("create_date").toDateTime();
                 s.UpdateDate = q.value("update_date").toDateTime();
 
-                QSqlDatabase::removeDatabase(cx);
                 return Etrek::Specification::Result<EnvironmentSetting>::Success(s);
             }
 
@@ -1421,13 +1471,12 @@ namespace Etrek::Device::Repository
             ins.bindValue(":mpps", true);
             ins.bindValue(":echo_fail", true);
 
-            if (!ins.exec()) {
+            if (!QueryStatistics::exec(ins)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(ins.lastError().text());
                 logger->LogError(err);
                 return Etrek::Specification::Result<EnvironmentSetting>::Failure(err);
             }
         }
-        QSqlDatabase::removeDatabase(cx);
         // Re-read and return the inserted defaults
         return getEnvironmentSettings();
     }
@@ -1437,11 +1486,11 @@ namespace Etrek::Device::Repository
         // Always keep a single row. Default to id=1 if not provided.
         const int targetId = (s.Id > 0) ? s.Id : 1;
 
-        const QString cx = "env_update_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(err);
                 return Etrek::Specification::Result<EnvironmentSetting>::Failure(err);
             }
@@ -1475,7 +1524,7 @@ namespace Etrek::Device::Repository
                 q.bindValue(":cont_echo", s.ContinueOnEchoFail);
                 q.bindValue(":id", targetId);
 
-                if (!q.exec()) {
+                if (!QueryStatistics::exec(q)) {
                     const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                     logger->LogError(err);
                     return Etrek::Specification::Result<EnvironmentSetting>::Failure(err);
@@ -1508,7 +1557,7 @@ namespace Etrek::Device::Repository
                     qi.bindValue(":enable_mpps", s.EnableMPPS);
                     qi.bindValue(":cont_echo", s.ContinueOnEchoFail);
 
-                    if (!qi.exec()) {
+                    if (!QueryStatistics::exec(qi)) {
                         const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(qi.lastError().text());
                         logger->LogError(err);
                         return Etrek::Specification::Result<EnvironmentSetting>::Failure(err);
@@ -1516,7 +1565,6 @@ namespace Etrek::Device::Repository
                 }
             }
         }
-        QSqlDatabase::removeDatabase(cx);
 
         // Return the fresh row (assumes you also have getEnvironmentSettings())
         return getEnvironmentSettings();
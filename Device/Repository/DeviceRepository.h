@@ -14,6 +14,7 @@
 #include "Device/Data/Entity/GeneralEquipment.h"
 #include "Device/Data/Entity/Institution.h"
 #include "Device/Data/Entity/EnvironmentSetting.h"
+#include "Device/Data/Entity/DeviceConnection.h"
 #include "Device/EnvironmentSettingUtils.h"
 
 
@@ -46,6 +47,9 @@ namespace Etrek::Device::Repository
         Etrek::Specification::Result<QVector<Etrek::Device::Data::Entity::Detector>> getDetectorList() const;
         Etrek::Specification::Result<Etrek::Device::Data::Entity::Detector> getDetectorById(int detectorId) const;
 
+        // Device connections (communication channel of each device)
+        Etrek::Specification::Result<QVector<Etrek::Device::Data::Entity::DeviceConnection>> getDeviceConnectionList() const;
+
         // Institutions
         Etrek::Specification::Result<QVector<Etrek::Device::Data::Entity::Institution>> getInstitutionList() const;
         Etrek::Specification::Result<Etrek::Device::Data::Entity::Institution>          getInstitutionById(int id) const;
@@ -72,8 +76,6 @@ namespace Etrek::Device::Repository
         ~DeviceRepository();
 
     private:
-        QSqlDatabase createConnection(const QString& connectionName) const;
-
         //bool deactivateOtherActiveDetectors(const QString& detectorOrder, int excludeId, QSqlDatabase& db, QString& errorMessage) const;
         bool deactivateOtherActiveGenerators(int outputNumber, int excludeGeneratorId, QSqlDatabase& db, QString& errorMessage) const;
 
@@ -3,6 +3,7 @@
 
 #include <QString>
 #include <QDateTime>
+#include <QVector>
 
 namespace Etrek::Dicom::Data::Entity {
 
@@ -120,6 +121,26 @@ namespace Etrek::Dicom::Data::Entity {
             return WorkflowStatus::PENDING; // Default fallback
         }
 
+        /**
+         * @brief Checks whether an entity may move from @p from to @p to.
+         *
+         * COMPLETED, CANCELLED and ABORTED are final. An entity without any status yet
+         * may start in any status; callers handle that case before asking.
+         */
+        static bool IsTransitionAllowed(WorkflowStatus from, WorkflowStatus to) {
+            switch (from) {
+                case WorkflowStatus::SCHEDULED:
+                case WorkflowStatus::PENDING:
+                    return to == WorkflowStatus::SCHEDULED || to == WorkflowStatus::PENDING
+                        || to == WorkflowStatus::IN_PROGRESS || to == WorkflowStatus::CANCELLED;
+                case WorkflowStatus::IN_PROGRESS:
+                    return to == WorkflowStatus::PENDING || to == WorkflowStatus::COMPLETED
+                        || to == WorkflowStatus::ABORTED;
+                default:
+                    return false;
+            }
+        }
+
         /**
          * @brief Convert Priority enum to database string representation
          */
@@ -145,6 +166,17 @@ namespace Etrek::Dicom::Data::Entity {
         }
     };
 
+    /**
+     * @brief One set of a batch status transition: every listed entity of one type moves to the same status
+     */
+    class StatusTransitionSet {
+    public:
+        EntityType Type = EntityType::IMAGE;      // Type of the listed entities
+        QVector<int> EntityIds;                   // IDs of the entities to transition
+        WorkflowStatus NewStatus = WorkflowStatus::COMPLETED; // Target status
+        QString Reason;                           // Optional reason stored with every history row
+    };
+
 } // namespace Etrek::Dicom::Data::Entity
 
 #endif // ETREK_DICOM_DATA_ENTITY_ENTITYSTATUS_H
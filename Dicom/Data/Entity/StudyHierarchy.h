@@ -0,0 +1,25 @@
+#ifndef ETREK_DICOM_DATA_ENTITY_STUDYHIERARCHY_H
+#define ETREK_DICOM_DATA_ENTITY_STUDYHIERARCHY_H
+
+#include <QVector>
+#include "Patient.h"
+#include "Study.h"
+#include "Series.h"
+
+namespace Etrek::Dicom::Data::Entity {
+
+    /**
+     * @brief A patient with one of their studies and that study's series, registered together
+     *        by DicomRepository::registerHierarchies.
+     *
+     * The foreign keys (Study.PatientId, Series.StudyId) are filled in on registration.
+     */
+    struct StudyHierarchy {
+        Patient PatientRecord;
+        Study StudyRecord;
+        QVector<Series> SeriesRecords;
+    };
+
+} // namespace Etrek::Dicom::Data::Entity
+
+#endif // ETREK_DICOM_DATA_ENTITY_STUDYHIERARCHY_H
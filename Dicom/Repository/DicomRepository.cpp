@@ -2,24 +2,43 @@
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QVariant>
-#include <QRandomGenerator>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
 #include "AppLoggerFactory.h"
+#include "DatabaseConnectionPool.h"
+#include "QueryStatistics.h"
+#include "BulkInsertWriter.h"
+#include "SqlDialect.h"
+#include "WorklistDisplayProjection.h"
 
 namespace Etrek::Dicom::Repository {
 
     using Etrek::Specification::Result;
     using Etrek::Dicom::Data::Entity::Study;
     using Etrek::Dicom::Data::Entity::Patient;
+    using Etrek::Dicom::Data::Entity::Series;
+    using Etrek::Dicom::Data::Entity::StudyHierarchy;
     using Etrek::Dicom::Data::Entity::EntityStatus;
     using Etrek::Dicom::Data::Entity::EntityType;
     using Etrek::Dicom::Data::Entity::WorkflowStatus;
     using Etrek::Dicom::Data::Entity::Priority;
+    using Etrek::Dicom::Data::Entity::StatusTransitionSet;
     using Etrek::Worklist::Data::Entity::WorklistEntry;
     using Etrek::Worklist::Data::Entity::WorklistAttribute;
     using Etrek::Core::Data::Model::DatabaseConnectionSetting;
     using Etrek::Core::Globalization::TranslationProvider;
     using Etrek::Core::Log::AppLoggerFactory;
     using Etrek::Core::Log::LoggerProvider;
+    using Etrek::Core::Repository::DatabaseConnectionPool;
+    using Etrek::Core::Repository::ConnectionLease;
+    using Etrek::Core::Repository::QueryStatistics;
+    using Etrek::Core::Repository::BulkInsertWriter;
+    using Etrek::Core::Repository::SqlDialect;
+    using Etrek::Core::Repository::JournalApplier;
+    using Etrek::Core::Repository::JournalEntryKey;
+    using Etrek::Core::Repository::JournalApplyOutcome;
+    namespace WorklistDisplayProjection = Etrek::Worklist::Repository::WorklistDisplayProjection;
 
     static inline QString kRepoName() { return "DicomRepository"; }
 
@@ -34,31 +53,19 @@ namespace Etrek::Dicom::Repository {
 
     DicomRepository::~DicomRepository() = default;
 
-    QSqlDatabase DicomRepository::createConnection(const QString& connectionName) const
-    {
-        QSqlDatabase db = QSqlDatabase::addDatabase("QMYSQL", connectionName);
-        db.setHostName(m_connectionSetting->getHostName());
-        db.setDatabaseName(m_connectionSetting->getDatabaseName());
-        db.setUserName(m_connectionSetting->getEtrekUserName());
-        db.setPassword(m_connectionSetting->getPassword());
-        db.setPort(m_connectionSetting->getPort());
-        return db;
-    }
-
     Result<QVector<Study>> DicomRepository::getStudiesByAdmissionId(const QString& admissionId) const
     {
         QVector<Study> rows;
-        const QString cx = "dicom_conn_studies_by_adm_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = QString("Failed to open database: %1").arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = QString("Failed to open database: %1").arg(lease.lastError());
                 logger->LogError(err);
                 return Result<QVector<Study>>::Failure(err);
             }
 
-            QSqlQuery q(db);
-            q.prepare(R"(
+            QSqlQuery& q = lease.prepare(R"(
                 SELECT id, patient_id, study_instance_uid, study_id, admission_id, accession_number,
                        issuer_of_accession_number, referring_physician_name,
                        study_date, study_time, study_description,
@@ -69,7 +76,7 @@ namespace Etrek::Dicom::Repository {
             )");
             const QString trimmed = admissionId.trimmed();
             q.bindValue(":adm", trimmed.isEmpty() ? QVariant(QVariant::String) : QVariant(trimmed));
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = QString("Query failed: %1").arg(q.lastError().text());
                 logger->LogError(err);
                 return Result<QVector<Study>>::Failure(err);
@@ -98,17 +105,16 @@ namespace Etrek::Dicom::Repository {
 
     Result<Patient> DicomRepository::insertPatient(Patient& patient)
     {
-        const QString cx = "dicom_conn_insert_patient_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = QString("Failed to open database: %1").arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = QString("Failed to open database: %1").arg(lease.lastError());
                 logger->LogError(err);
                 return Result<Patient>::Failure(err);
             }
 
-            QSqlQuery q(db);
-            q.prepare(R"(
+            QSqlQuery& q = lease.prepare(R"(
                 INSERT INTO patients (
                     patient_name, patient_id, issuer_of_patient_id, type_of_patient_id,
                     issuer_of_patient_id_qualifiers, other_patient_id, patient_sex,
@@ -135,16 +141,14 @@ namespace Etrek::Dicom::Repository {
             q.bindValue(":requesting_physician", patient.RequestingPhysician.isEmpty() ? QVariant(QVariant::String) : patient.RequestingPhysician);
             q.bindValue(":patient_address", patient.PatientAddress.isEmpty() ? QVariant(QVariant::String) : patient.PatientAddress);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = QString("Failed to insert patient: %1").arg(q.lastError().text());
                 logger->LogError(err);
                 return Result<Patient>::Failure(err);
             }
 
             patient.Id = q.lastInsertId().toInt();
-            db.close();
         }
-        QSqlDatabase::removeDatabase(cx);
         return Result<Patient>::Success(patient);
     }
 
@@ -156,17 +160,16 @@ namespace Etrek::Dicom::Repository {
             return Result<bool>::Failure(err);
         }
 
-        const QString cx = "dicom_conn_update_patient_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = QString("Failed to open database: %1").arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = QString("Failed to open database: %1").arg(lease.lastError());
                 logger->LogError(err);
                 return Result<bool>::Failure(err);
             }
 
-            QSqlQuery q(db);
-            q.prepare(R"(
+            QSqlQuery& q = lease.prepare(R"(
                 UPDATE patients SET
                     patient_name = :patient_name,
                     patient_id = :patient_id,
@@ -197,46 +200,42 @@ namespace Etrek::Dicom::Repository {
             q.bindValue(":requesting_physician", patient.RequestingPhysician.isEmpty() ? QVariant(QVariant::String) : patient.RequestingPhysician);
             q.bindValue(":patient_address", patient.PatientAddress.isEmpty() ? QVariant(QVariant::String) : patient.PatientAddress);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = QString("Failed to update patient: %1").arg(q.lastError().text());
                 logger->LogError(err);
                 return Result<bool>::Failure(err);
             }
 
-            db.close();
         }
-        QSqlDatabase::removeDatabase(cx);
         return Result<bool>::Success(true);
     }
 
     Result<std::optional<Patient>> DicomRepository::findPatientByIdAndIssuer(
         const QString& patientId, const QString& issuerOfPatientId) const
     {
-        const QString cx = "dicom_conn_find_patient_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = QString("Failed to open database: %1").arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = QString("Failed to open database: %1").arg(lease.lastError());
                 logger->LogError(err);
                 return Result<std::optional<Patient>>::Failure(err);
             }
 
-            QSqlQuery q(db);
-            q.prepare(R"(
+            QSqlQuery& q = lease.prepare(R"(
                 SELECT id, patient_name, patient_id, issuer_of_patient_id, type_of_patient_id,
                        issuer_of_patient_id_qualifiers, other_patient_id, patient_sex,
                        patient_birth_date, patient_comments, patient_allergies,
                        requesting_physician, patient_address
                 FROM patients
-                WHERE patient_id = :patient_id
-                  AND ((:issuer IS NULL AND issuer_of_patient_id IS NULL) OR issuer_of_patient_id = :issuer)
-                LIMIT 1
+                WHERE patient_id = :patient_id AND issuer_key = :issuer_key
             )");
 
+            // issuer_key is the issuer with NULL stored as ''
             q.bindValue(":patient_id", patientId);
-            q.bindValue(":issuer", issuerOfPatientId.isEmpty() ? QVariant(QVariant::String) : issuerOfPatientId);
+            q.bindValue(":issuer_key", issuerOfPatientId.isNull() ? QString("") : issuerOfPatientId);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = QString("Failed to find patient: %1").arg(q.lastError().text());
                 logger->LogError(err);
                 return Result<std::optional<Patient>>::Failure(err);
@@ -258,53 +257,395 @@ namespace Etrek::Dicom::Repository {
                 patient.RequestingPhysician = q.value("requesting_physician").toString();
                 patient.PatientAddress = q.value("patient_address").toString();
 
-                db.close();
-                QSqlDatabase::removeDatabase(cx);
                 return Result<std::optional<Patient>>::Success(patient);
             }
 
-            db.close();
         }
-        QSqlDatabase::removeDatabase(cx);
         return Result<std::optional<Patient>>::Success(std::nullopt);
     }
 
     Result<Patient> DicomRepository::upsertPatient(Patient& patient)
     {
-        // First, try to find existing patient
-        auto findResult = findPatientByIdAndIssuer(patient.PatientId, patient.IssuerOfPatientId);
-        if (!findResult.isSuccess) {
-            return Result<Patient>::Failure(findResult.message);
+        {
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = QString("Failed to open database: %1").arg(lease.lastError());
+                logger->LogError(err);
+                return Result<Patient>::Failure(err);
+            }
+
+            auto written = upsertPatientRow(lease, patient);
+            if (!written.isSuccess)
+                return Result<Patient>::Failure(written.message);
+            patient.Id = written.value;
+        }
+        return Result<Patient>::Success(patient);
+    }
+
+    Result<Study> DicomRepository::upsertStudy(Study& study)
+    {
+        {
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = QString("Failed to open database: %1").arg(lease.lastError());
+                logger->LogError(err);
+                return Result<Study>::Failure(err);
+            }
+
+            // The check of the stored parent holds its row lock until the upsert commits
+            if (!lease.transaction()) {
+                const auto err = QString("Failed to start transaction: %1").arg(db.lastError().text());
+                logger->LogError(err);
+                return Result<Study>::Failure(err);
+            }
+
+            auto written = upsertStudyRow(lease, study);
+            if (!written.isSuccess) {
+                lease.rollback();
+                return Result<Study>::Failure(written.message);
+            }
+
+            if (!lease.commit()) {
+                const auto err = QString("Failed to commit study: %1").arg(db.lastError().text());
+                logger->LogError(err);
+                lease.rollback();
+                return Result<Study>::Failure(err);
+            }
+            study.Id = written.value;
+        }
+        return Result<Study>::Success(study);
+    }
+
+    Result<Series> DicomRepository::upsertSeries(Series& series)
+    {
+        {
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = QString("Failed to open database: %1").arg(lease.lastError());
+                logger->LogError(err);
+                return Result<Series>::Failure(err);
+            }
+
+            // The check of the stored parent holds its row lock until the upsert commits
+            if (!lease.transaction()) {
+                const auto err = QString("Failed to start transaction: %1").arg(db.lastError().text());
+                logger->LogError(err);
+                return Result<Series>::Failure(err);
+            }
+
+            auto written = upsertSeriesRow(lease, series);
+            if (!written.isSuccess) {
+                lease.rollback();
+                return Result<Series>::Failure(written.message);
+            }
+
+            if (!lease.commit()) {
+                const auto err = QString("Failed to commit series: %1").arg(db.lastError().text());
+                logger->LogError(err);
+                lease.rollback();
+                return Result<Series>::Failure(err);
+            }
+            series.Id = written.value;
+        }
+        return Result<Series>::Success(series);
+    }
+
+    Result<int> DicomRepository::registerHierarchies(QVector<StudyHierarchy>& hierarchies)
+    {
+        if (hierarchies.isEmpty())
+            return Result<int>::Success(0);
+
+        // Ids are collected here and copied to the hierarchies after the commit, so a rolled
+        // back batch leaves them untouched
+        QVector<int> patientIds, studyIds;
+        QVector<QVector<int>> seriesIds;
+        patientIds.reserve(hierarchies.size());
+        studyIds.reserve(hierarchies.size());
+        seriesIds.reserve(hierarchies.size());
+        int written = 0;
+
+        {
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = QString("Failed to open database: %1").arg(lease.lastError());
+                logger->LogError(err);
+                return Result<int>::Failure(err);
+            }
+
+            if (!lease.transaction()) {
+                const auto err = QString("Failed to start transaction: %1").arg(db.lastError().text());
+                logger->LogError(err);
+                return Result<int>::Failure(err);
+            }
+
+            for (const StudyHierarchy& hierarchy : hierarchies) {
+                auto patientId = upsertPatientRow(lease, hierarchy.PatientRecord);
+                if (!patientId.isSuccess) {
+                    lease.rollback();
+                    return Result<int>::Failure(patientId.message);
+                }
+
+                Study study = hierarchy.StudyRecord;
+                study.PatientId = patientId.value;
+                auto studyId = upsertStudyRow(lease, study);
+                if (!studyId.isSuccess) {
+                    lease.rollback();
+                    return Result<int>::Failure(studyId.message);
+                }
+
+                QVector<int> ids;
+                ids.reserve(hierarchy.SeriesRecords.size());
+                for (Series series : hierarchy.SeriesRecords) {
+                    series.StudyId = studyId.value;
+                    auto seriesId = upsertSeriesRow(lease, series);
+                    if (!seriesId.isSuccess) {
+                        lease.rollback();
+                        return Result<int>::Failure(seriesId.message);
+                    }
+                    ids.push_back(seriesId.value);
+                }
+
+                written += 2 + ids.size();
+                patientIds.push_back(patientId.value);
+                studyIds.push_back(studyId.value);
+                seriesIds.push_back(std::move(ids));
+            }
+
+            if (!lease.commit()) {
+                const auto err = QString("Failed to commit patient, study and series hierarchy: %1").arg(db.lastError().text());
+                logger->LogError(err);
+                lease.rollback();
+                return Result<int>::Failure(err);
+            }
         }
 
-        auto existingPatient = findResult.value;
-        if (existingPatient.has_value()) {
-            // Patient exists - update it
-            patient.Id = existingPatient->Id;
-            auto updateResult = updatePatient(patient);
-            if (!updateResult.isSuccess) {
-                return Result<Patient>::Failure(updateResult.message);
+        for (int i = 0; i < hierarchies.size(); ++i) {
+            StudyHierarchy& hierarchy = hierarchies[i];
+            hierarchy.PatientRecord.Id = patientIds[i];
+            hierarchy.StudyRecord.Id = studyIds[i];
+            hierarchy.StudyRecord.PatientId = patientIds[i];
+            for (int j = 0; j < hierarchy.SeriesRecords.size(); ++j) {
+                hierarchy.SeriesRecords[j].Id = seriesIds[i][j];
+                hierarchy.SeriesRecords[j].StudyId = studyIds[i];
             }
-            return Result<Patient>::Success(patient);
-        } else {
-            // Patient doesn't exist - insert new
-            return insertPatient(patient);
         }
+        return Result<int>::Success(written);
+    }
+
+    Result<int> DicomRepository::upsertPatientRow(ConnectionLease& lease, const Patient& patient) const
+    {
+        const SqlDialect dialect = SqlDialect::of(lease.database());
+        QSqlQuery& q = lease.prepare(QString(R"(
+            INSERT INTO patients (
+                patient_name, patient_id, issuer_of_patient_id, type_of_patient_id,
+                issuer_of_patient_id_qualifiers, other_patient_id, patient_sex,
+                patient_birth_date, patient_comments, patient_allergies,
+                requesting_physician, patient_address
+            ) VALUES (
+                :patient_name, :patient_id, :issuer_of_patient_id, :type_of_patient_id,
+                :issuer_of_patient_id_qualifiers, :other_patient_id, :patient_sex,
+                :patient_birth_date, :patient_comments, :patient_allergies,
+                :requesting_physician, :patient_address
+            )
+        )") + dialect.upsertReturningIdClause("id", {
+            "patient_name", "type_of_patient_id", "issuer_of_patient_id_qualifiers", "other_patient_id",
+            "patient_sex", "patient_birth_date", "patient_comments", "patient_allergies",
+            "requesting_physician", "patient_address" }));
+
+        q.bindValue(":patient_name", patient.PatientName.isEmpty() ? QVariant(QVariant::String) : patient.PatientName);
+        q.bindValue(":patient_id", patient.PatientId);
+        q.bindValue(":issuer_of_patient_id", patient.IssuerOfPatientId.isEmpty() ? QVariant(QVariant::String) : patient.IssuerOfPatientId);
+        q.bindValue(":type_of_patient_id", patient.TypeOfPatientId.isEmpty() ? QVariant(QVariant::String) : patient.TypeOfPatientId);
+        q.bindValue(":issuer_of_patient_id_qualifiers", patient.IssuerOfPatientIdQualifiers.isEmpty() ? QVariant(QVariant::String) : patient.IssuerOfPatientIdQualifiers);
+        q.bindValue(":other_patient_id", patient.OtherPatientId.isEmpty() ? QVariant(QVariant::String) : patient.OtherPatientId);
+        q.bindValue(":patient_sex", patient.PatientSex.isEmpty() ? QVariant(QVariant::String) : patient.PatientSex);
+        q.bindValue(":patient_birth_date", patient.PatientBirthDate.isValid() ? patient.PatientBirthDate : QVariant(QVariant::Date));
+        q.bindValue(":patient_comments", patient.PatientComments.isEmpty() ? QVariant(QVariant::String) : patient.PatientComments);
+        q.bindValue(":patient_allergies", patient.PatientAllergies.isEmpty() ? QVariant(QVariant::String) : patient.PatientAllergies);
+        q.bindValue(":requesting_physician", patient.RequestingPhysician.isEmpty() ? QVariant(QVariant::String) : patient.RequestingPhysician);
+        q.bindValue(":patient_address", patient.PatientAddress.isEmpty() ? QVariant(QVariant::String) : patient.PatientAddress);
+
+        if (!QueryStatistics::exec(q)) {
+            const auto err = QString("Failed to upsert patient: %1").arg(q.lastError().text());
+            logger->LogError(err);
+            return Result<int>::Failure(err);
+        }
+
+        const int id = SqlDialect::upsertedId(q);
+        if (id < 0) {
+            const auto err = QString("Failed to upsert patient: no id reported for patient %1").arg(patient.PatientId);
+            logger->LogError(err);
+            return Result<int>::Failure(err);
+        }
+        return Result<int>::Success(id);
+    }
+
+    Result<int> DicomRepository::upsertStudyRow(ConnectionLease& lease, const Study& study) const
+    {
+        if (study.PatientId < 0) {
+            const auto err = QString("Cannot upsert study %1: no patient").arg(study.StudyInstanceUID);
+            logger->LogError(err);
+            return Result<int>::Failure(err);
+        }
+
+        // A study never moves to another patient; an update would silently re-parent it.
+        // Locked so that no concurrent writer stores the study between this check and the upsert.
+        const SqlDialect dialect = SqlDialect::of(lease.database());
+        QSqlQuery& existing = lease.prepare(QString("SELECT patient_id FROM studies WHERE study_instance_uid = :study_instance_uid")
+                                            + dialect.lockRowsClause());
+        existing.bindValue(":study_instance_uid", study.StudyInstanceUID);
+        if (!QueryStatistics::exec(existing)) {
+            const auto err = QString("Failed to upsert study: %1").arg(existing.lastError().text());
+            logger->LogError(err);
+            return Result<int>::Failure(err);
+        }
+        const int storedPatientId = existing.next() ? existing.value(0).toInt() : -1;
+        existing.finish();
+        if (storedPatientId >= 0 && storedPatientId != study.PatientId) {
+            const auto err = QString("Cannot upsert study %1: it belongs to patient %2, not %3")
+                .arg(study.StudyInstanceUID).arg(storedPatientId).arg(study.PatientId);
+            logger->LogError(err);
+            return Result<int>::Failure(err);
+        }
+
+        QSqlQuery& q = lease.prepare(QString(R"(
+            INSERT INTO studies (
+                patient_id, study_instance_uid, study_id, admission_id, accession_number,
+                issuer_of_accession_number, referring_physician_name,
+                study_date, study_time, study_description,
+                patient_age, patient_size, allergy
+            ) VALUES (
+                :patient_id, :study_instance_uid, :study_id, :admission_id, :accession_number,
+                :issuer_of_accession_number, :referring_physician_name,
+                :study_date, :study_time, :study_description,
+                :patient_age, :patient_size, :allergy
+            )
+        )") + dialect.upsertReturningIdClause("id", {
+            "study_id", "admission_id", "accession_number", "issuer_of_accession_number",
+            "referring_physician_name", "study_date", "study_time", "study_description",
+            "patient_age", "patient_size", "allergy" }));
+
+        q.bindValue(":patient_id", study.PatientId);
+        q.bindValue(":study_instance_uid", study.StudyInstanceUID);
+        q.bindValue(":study_id", study.StudyId.isEmpty() ? QVariant(QVariant::String) : study.StudyId);
+        q.bindValue(":admission_id", study.AdmissionId.isEmpty() ? QVariant(QVariant::String) : study.AdmissionId);
+        q.bindValue(":accession_number", study.AccessionNumber.isEmpty() ? QVariant(QVariant::String) : study.AccessionNumber);
+        q.bindValue(":issuer_of_accession_number", study.IssuerOfAccessionNumber.isEmpty() ? QVariant(QVariant::String) : study.IssuerOfAccessionNumber);
+        q.bindValue(":referring_physician_name", study.ReferringPhysicianName.isEmpty() ? QVariant(QVariant::String) : study.ReferringPhysicianName);
+        q.bindValue(":study_date", study.StudyDate.isEmpty() ? QVariant(QVariant::String) : study.StudyDate);
+        q.bindValue(":study_time", study.StudyTime.isEmpty() ? QVariant(QVariant::String) : study.StudyTime);
+        q.bindValue(":study_description", study.StudyDescription.isEmpty() ? QVariant(QVariant::String) : study.StudyDescription);
+        q.bindValue(":patient_age", study.PatientAge > 0 ? study.PatientAge : QVariant(QVariant::Int));
+        q.bindValue(":patient_size", study.PatientSize > 0 ? study.PatientSize : QVariant(QVariant::Int));
+        q.bindValue(":allergy", study.Allergy.isEmpty() ? QVariant(QVariant::String) : study.Allergy);
+
+        if (!QueryStatistics::exec(q)) {
+            const auto err = QString("Failed to upsert study: %1").arg(q.lastError().text());
+            logger->LogError(err);
+            return Result<int>::Failure(err);
+        }
+
+        const int id = SqlDialect::upsertedId(q);
+        if (id < 0) {
+            const auto err = QString("Failed to upsert study: no id reported for study %1").arg(study.StudyInstanceUID);
+            logger->LogError(err);
+            return Result<int>::Failure(err);
+        }
+        return Result<int>::Success(id);
+    }
+
+    Result<int> DicomRepository::upsertSeriesRow(ConnectionLease& lease, const Series& series) const
+    {
+        if (series.StudyId < 0) {
+            const auto err = QString("Cannot upsert series %1: no study").arg(series.SeriesInstanceUID);
+            logger->LogError(err);
+            return Result<int>::Failure(err);
+        }
+
+        // Likewise a series never moves to another study, checked under the same lock
+        const SqlDialect dialect = SqlDialect::of(lease.database());
+        QSqlQuery& existing = lease.prepare(QString("SELECT study_id FROM series WHERE series_instance_uid = :series_instance_uid")
+                                            + dialect.lockRowsClause());
+        existing.bindValue(":series_instance_uid", series.SeriesInstanceUID);
+        if (!QueryStatistics::exec(existing)) {
+            const auto err = QString("Failed to upsert series: %1").arg(existing.lastError().text());
+            logger->LogError(err);
+            return Result<int>::Failure(err);
+        }
+        const int storedStudyId = existing.next() ? existing.value(0).toInt() : -1;
+        existing.finish();
+        if (storedStudyId >= 0 && storedStudyId != series.StudyId) {
+            const auto err = QString("Cannot upsert series %1: it belongs to study %2, not %3")
+                .arg(series.SeriesInstanceUID).arg(storedStudyId).arg(series.StudyId);
+            logger->LogError(err);
+            return Result<int>::Failure(err);
+        }
+
+        QSqlQuery& q = lease.prepare(QString(R"(
+            INSERT INTO series (
+                study_id, series_instance_uid, series_number, modality, series_description,
+                operator_name, body_part_examined, patient_position, view_position,
+                image_laterality, acquisition_device_id, presentation_intent_type
+            ) VALUES (
+                :study_id, :series_instance_uid, :series_number, :modality, :series_description,
+                :operator_name, :body_part_examined, :patient_position, :view_position,
+                :image_laterality, :acquisition_device_id, :presentation_intent_type
+            )
+        )") + dialect.upsertReturningIdClause("id", {
+            "series_number", "modality", "series_description", "operator_name",
+            "body_part_examined", "patient_position", "view_position", "image_laterality",
+            "acquisition_device_id", "presentation_intent_type" }));
+
+        q.bindValue(":study_id", series.StudyId);
+        q.bindValue(":series_instance_uid", series.SeriesInstanceUID);
+        q.bindValue(":series_number", series.SeriesNumber > 0 ? series.SeriesNumber : QVariant(QVariant::Int));
+        q.bindValue(":modality", series.Modality.isEmpty() ? QVariant(QVariant::String) : series.Modality);
+        q.bindValue(":series_description", series.SeriesDescription.isEmpty() ? QVariant(QVariant::String) : series.SeriesDescription);
+        q.bindValue(":operator_name", series.OperatorName.isEmpty() ? QVariant(QVariant::String) : series.OperatorName);
+        q.bindValue(":body_part_examined", series.BodyPartExamined.isEmpty() ? QVariant(QVariant::String) : series.BodyPartExamined);
+        q.bindValue(":patient_position", series.PatientPosition.isEmpty() ? QVariant(QVariant::String) : series.PatientPosition);
+        q.bindValue(":view_position", series.ViewPosition.isEmpty() ? QVariant(QVariant::String) : series.ViewPosition);
+        q.bindValue(":image_laterality", series.ImageLaterality.isEmpty() ? QVariant(QVariant::String) : series.ImageLaterality);
+        q.bindValue(":acquisition_device_id", series.AcquisitionDeviceId >= 0 ? series.AcquisitionDeviceId : QVariant(QVariant::Int));
+        q.bindValue(":presentation_intent_type", series.PresentationIntentType.isEmpty() ? QVariant(QVariant::String) : series.PresentationIntentType);
+
+        if (!QueryStatistics::exec(q)) {
+            const auto err = QString("Failed to upsert series: %1").arg(q.lastError().text());
+            logger->LogError(err);
+            return Result<int>::Failure(err);
+        }
+
+        const int id = SqlDialect::upsertedId(q);
+        if (id < 0) {
+            const auto err = QString("Failed to upsert series: no id reported for series %1").arg(series.SeriesInstanceUID);
+            logger->LogError(err);
+            return Result<int>::Failure(err);
+        }
+        return Result<int>::Success(id);
     }
 
     Result<EntityStatus> DicomRepository::insertEntityStatus(EntityStatus& status)
     {
-        const QString cx = "dicom_conn_insert_status_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = QString("Failed to open database: %1").arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = QString("Failed to open database: %1").arg(lease.lastError());
+                logger->LogError(err);
+                return Result<EntityStatus>::Failure(err);
+            }
+
+            if (!lease.transaction()) {
+                const auto err = QString("Failed to start transaction: %1").arg(db.lastError().text());
                 logger->LogError(err);
                 return Result<EntityStatus>::Failure(err);
             }
 
-            QSqlQuery q(db);
-            q.prepare(R"(
+            QSqlQuery& q = lease.prepare(R"(
                 INSERT INTO entity_status (
                     entity_type, entity_id, status, status_reason, priority,
                     assigned_to, transitioned_by, transitioned_at, notes
@@ -321,47 +662,80 @@ namespace Etrek::Dicom::Repository {
             q.bindValue(":priority", EntityStatus::PriorityToString(status.PriorityLevel));
             q.bindValue(":assigned_to", status.AssignedTo >= 0 ? status.AssignedTo : QVariant(QVariant::Int));
             q.bindValue(":transitioned_by", status.TransitionedBy >= 0 ? status.TransitionedBy : QVariant(QVariant::Int));
-            q.bindValue(":transitioned_at", status.TransitionedAt.isValid() ? status.TransitionedAt : QDateTime::currentDateTime());
+            if (!status.TransitionedAt.isValid())
+                status.TransitionedAt = QDateTime::currentDateTime();
+            q.bindValue(":transitioned_at", status.TransitionedAt);
             q.bindValue(":notes", status.Notes.isEmpty() ? QVariant(QVariant::String) : status.Notes);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = QString("Failed to insert entity status: %1").arg(q.lastError().text());
                 logger->LogError(err);
+                lease.rollback();
                 return Result<EntityStatus>::Failure(err);
             }
 
             status.Id = q.lastInsertId().toInt();
-            db.close();
+
+            // The newest history row is the current status; a concurrent writer that committed a
+            // newer row first is not overwritten
+            QSqlQuery& current = lease.prepare(QString(R"(
+                INSERT INTO entity_current_status (
+                    entity_type, entity_id, status_id, status, priority, assigned_to, transitioned_at
+                ) VALUES (
+                    :entity_type, :entity_id, :status_id, :status, :priority, :assigned_to, :transitioned_at
+                )
+            )") + SqlDialect::of(db).upsertIfGreaterClause("status_id", { "status_id", "status", "priority", "assigned_to", "transitioned_at" }));
+
+            current.bindValue(":entity_type", EntityStatus::EntityTypeToString(status.Type));
+            current.bindValue(":entity_id", status.EntityId);
+            current.bindValue(":status_id", status.Id);
+            current.bindValue(":status", EntityStatus::WorkflowStatusToString(status.Status));
+            current.bindValue(":priority", EntityStatus::PriorityToString(status.PriorityLevel));
+            current.bindValue(":assigned_to", status.AssignedTo >= 0 ? status.AssignedTo : QVariant(QVariant::Int));
+            current.bindValue(":transitioned_at", status.TransitionedAt);
+
+            if (!QueryStatistics::exec(current)) {
+                const auto err = QString("Failed to update current entity status: %1").arg(current.lastError().text());
+                logger->LogError(err);
+                lease.rollback();
+                status.Id = -1;
+                return Result<EntityStatus>::Failure(err);
+            }
+
+            if (!lease.commit()) {
+                const auto err = QString("Failed to commit entity status: %1").arg(db.lastError().text());
+                logger->LogError(err);
+                lease.rollback();
+                status.Id = -1;
+                return Result<EntityStatus>::Failure(err);
+            }
         }
-        QSqlDatabase::removeDatabase(cx);
         return Result<EntityStatus>::Success(status);
     }
 
     Result<std::optional<EntityStatus>> DicomRepository::getCurrentStatus(EntityType entityType, int entityId) const
     {
-        const QString cx = "dicom_conn_get_current_status_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = QString("Failed to open database: %1").arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = QString("Failed to open database: %1").arg(lease.lastError());
                 logger->LogError(err);
                 return Result<std::optional<EntityStatus>>::Failure(err);
             }
 
-            QSqlQuery q(db);
-            q.prepare(R"(
-                SELECT id, entity_type, entity_id, status, status_reason, priority,
-                       assigned_to, transitioned_by, transitioned_at, notes
-                FROM entity_status
-                WHERE entity_type = :entity_type AND entity_id = :entity_id
-                ORDER BY id DESC
-                LIMIT 1
+            QSqlQuery& q = lease.prepare(R"(
+                SELECT es.id, es.entity_type, es.entity_id, es.status, es.status_reason, es.priority,
+                       es.assigned_to, es.transitioned_by, es.transitioned_at, es.notes
+                FROM entity_current_status cs
+                INNER JOIN entity_status es ON es.id = cs.status_id
+                WHERE cs.entity_type = :entity_type AND cs.entity_id = :entity_id
             )");
 
             q.bindValue(":entity_type", EntityStatus::EntityTypeToString(entityType));
             q.bindValue(":entity_id", entityId);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = QString("Failed to get current status: %1").arg(q.lastError().text());
                 logger->LogError(err);
                 return Result<std::optional<EntityStatus>>::Failure(err);
@@ -380,31 +754,26 @@ namespace Etrek::Dicom::Repository {
                 status.TransitionedAt = q.value("transitioned_at").toDateTime();
                 status.Notes = q.value("notes").toString();
 
-                db.close();
-                QSqlDatabase::removeDatabase(cx);
                 return Result<std::optional<EntityStatus>>::Success(status);
             }
 
-            db.close();
         }
-        QSqlDatabase::removeDatabase(cx);
         return Result<std::optional<EntityStatus>>::Success(std::nullopt);
     }
 
     Result<QVector<EntityStatus>> DicomRepository::getStatusHistory(EntityType entityType, int entityId) const
     {
         QVector<EntityStatus> history;
-        const QString cx = "dicom_conn_status_history_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = QString("Failed to open database: %1").arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = QString("Failed to open database: %1").arg(lease.lastError());
                 logger->LogError(err);
                 return Result<QVector<EntityStatus>>::Failure(err);
             }
 
-            QSqlQuery q(db);
-            q.prepare(R"(
+            QSqlQuery& q = lease.prepare(R"(
                 SELECT id, entity_type, entity_id, status, status_reason, priority,
                        assigned_to, transitioned_by, transitioned_at, notes
                 FROM entity_status
@@ -415,7 +784,7 @@ namespace Etrek::Dicom::Repository {
             q.bindValue(":entity_type", EntityStatus::EntityTypeToString(entityType));
             q.bindValue(":entity_id", entityId);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = QString("Failed to get status history: %1").arg(q.lastError().text());
                 logger->LogError(err);
                 return Result<QVector<EntityStatus>>::Failure(err);
@@ -436,45 +805,35 @@ namespace Etrek::Dicom::Repository {
                 history.push_back(std::move(status));
             }
 
-            db.close();
         }
-        QSqlDatabase::removeDatabase(cx);
         return Result<QVector<EntityStatus>>::Success(history);
     }
 
     Result<QVector<EntityStatus>> DicomRepository::getEntitiesByStatus(EntityType entityType, WorkflowStatus status) const
     {
         QVector<EntityStatus> entities;
-        const QString cx = "dicom_conn_entities_by_status_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = QString("Failed to open database: %1").arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = QString("Failed to open database: %1").arg(lease.lastError());
                 logger->LogError(err);
                 return Result<QVector<EntityStatus>>::Failure(err);
             }
 
-            QSqlQuery q(db);
-            q.prepare(R"(
+            QSqlQuery& q = lease.prepare(R"(
                 SELECT es.id, es.entity_type, es.entity_id, es.status, es.status_reason, es.priority,
                        es.assigned_to, es.transitioned_by, es.transitioned_at, es.notes
-                FROM entity_status es
-                INNER JOIN (
-                    SELECT entity_type, entity_id, MAX(id) as max_id
-                    FROM entity_status
-                    WHERE entity_type = :entity_type
-                    GROUP BY entity_type, entity_id
-                ) latest ON es.entity_type = latest.entity_type
-                        AND es.entity_id = latest.entity_id
-                        AND es.id = latest.max_id
-                WHERE es.status = :status
-                ORDER BY es.transitioned_at DESC
+                FROM entity_current_status cs
+                INNER JOIN entity_status es ON es.id = cs.status_id
+                WHERE cs.entity_type = :entity_type AND cs.status = :status
+                ORDER BY cs.transitioned_at DESC
             )");
 
             q.bindValue(":entity_type", EntityStatus::EntityTypeToString(entityType));
             q.bindValue(":status", EntityStatus::WorkflowStatusToString(status));
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = QString("Failed to get entities by status: %1").arg(q.lastError().text());
                 logger->LogError(err);
                 return Result<QVector<EntityStatus>>::Failure(err);
@@ -495,44 +854,35 @@ namespace Etrek::Dicom::Repository {
                 entities.push_back(std::move(entityStatus));
             }
 
-            db.close();
         }
-        QSqlDatabase::removeDatabase(cx);
         return Result<QVector<EntityStatus>>::Success(entities);
     }
 
     Result<QVector<EntityStatus>> DicomRepository::getAssignedEntities(int userId, WorkflowStatus status) const
     {
         QVector<EntityStatus> entities;
-        const QString cx = "dicom_conn_assigned_entities_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = QString("Failed to open database: %1").arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = QString("Failed to open database: %1").arg(lease.lastError());
                 logger->LogError(err);
                 return Result<QVector<EntityStatus>>::Failure(err);
             }
 
-            QSqlQuery q(db);
-            q.prepare(R"(
+            QSqlQuery& q = lease.prepare(R"(
                 SELECT es.id, es.entity_type, es.entity_id, es.status, es.status_reason, es.priority,
                        es.assigned_to, es.transitioned_by, es.transitioned_at, es.notes
-                FROM entity_status es
-                INNER JOIN (
-                    SELECT entity_type, entity_id, MAX(id) as max_id
-                    FROM entity_status
-                    GROUP BY entity_type, entity_id
-                ) latest ON es.entity_type = latest.entity_type
-                        AND es.entity_id = latest.entity_id
-                        AND es.id = latest.max_id
-                WHERE es.assigned_to = :user_id AND es.status = :status
-                ORDER BY es.priority DESC, es.transitioned_at ASC
+                FROM entity_current_status cs
+                INNER JOIN entity_status es ON es.id = cs.status_id
+                WHERE cs.assigned_to = :user_id AND cs.status = :status
+                ORDER BY cs.priority DESC, cs.transitioned_at ASC
             )");
 
             q.bindValue(":user_id", userId);
             q.bindValue(":status", EntityStatus::WorkflowStatusToString(status));
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = QString("Failed to get assigned entities: %1").arg(q.lastError().text());
                 logger->LogError(err);
                 return Result<QVector<EntityStatus>>::Failure(err);
@@ -553,25 +903,267 @@ namespace Etrek::Dicom::Repository {
                 entities.push_back(std::move(entityStatus));
             }
 
-            db.close();
         }
-        QSqlDatabase::removeDatabase(cx);
         return Result<QVector<EntityStatus>>::Success(entities);
     }
 
+    Result<int> DicomRepository::transitionStatuses(const QVector<StatusTransitionSet>& sets, int transitionedBy,
+        const std::optional<JournalEntryKey>& journalKey, JournalApplyOutcome* outcome)
+    {
+        // Keeps the IN (...) lists of the lock query well below the placeholder limit
+        constexpr int LOCK_CHUNK_SIZE = 1000;
+
+        struct CurrentStatus {
+            WorkflowStatus Status;
+            QString Priority;
+            QVariant AssignedTo;
+        };
+
+        auto report = [outcome](JournalApplyOutcome value) {
+            if (outcome)
+                *outcome = value;
+        };
+        report(JournalApplyOutcome::Applied);
+
+        int written = 0;
+        {
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = QString("Failed to open database: %1").arg(lease.lastError());
+                logger->LogError(err);
+                return Result<int>::Failure(err);
+            }
+
+            auto entityKey = [](EntityType type, int id) {
+                return (qint64(type) << 32) | quint32(id);
+            };
+
+            // Distinct ids per entity type, in first-seen order
+            QHash<int, QVector<int>> idsByType;
+            QSet<qint64> seen;
+            for (const auto& set : sets) {
+                for (int id : set.EntityIds) {
+                    if (!seen.contains(entityKey(set.Type, id))) {
+                        seen.insert(entityKey(set.Type, id));
+                        idsByType[int(set.Type)].push_back(id);
+                    }
+                }
+            }
+            if (idsByType.isEmpty())
+                return Result<int>::Success(0);
+
+            if (!lease.transaction()) {
+                const auto err = QString("Failed to start transaction: %1").arg(db.lastError().text());
+                logger->LogError(err);
+                return Result<int>::Failure(err);
+            }
+
+            auto fail = [&](const QString& err) {
+                logger->LogError(err);
+                lease.rollback();
+                return Result<int>::Failure(err);
+            };
+
+            if (journalKey) {
+                auto claimed = JournalApplier::claimEntry(lease, *journalKey);
+                if (!claimed.isSuccess)
+                    return fail(claimed.message);
+                if (!claimed.value) {
+                    lease.rollback();
+                    report(JournalApplyOutcome::AlreadyApplied);
+                    return Result<int>::Success(0);
+                }
+            }
+
+            // 1) Read and lock the current status of every listed entity
+            QHash<qint64, CurrentStatus> current;
+            for (auto it = idsByType.constBegin(); it != idsByType.constEnd(); ++it) {
+                const QVector<int>& ids = it.value();
+                for (int begin = 0; begin < ids.size(); begin += LOCK_CHUNK_SIZE) {
+                    const int count = qMin(LOCK_CHUNK_SIZE, int(ids.size()) - begin);
+
+                    QStringList placeholders;
+                    placeholders.reserve(count);
+                    for (int i = 0; i < count; ++i)
+                        placeholders << "?";
+
+                    QSqlQuery q(db);
+                    q.prepare(QString(R"(
+                        SELECT entity_id, status, priority, assigned_to
+                        FROM entity_current_status
+                        WHERE entity_type = ? AND entity_id IN (%1)
+                    )").arg(placeholders.join(',')) + SqlDialect::of(db).lockRowsClause());
+
+                    const EntityType type = EntityType(it.key());
+                    q.addBindValue(EntityStatus::EntityTypeToString(type));
+                    for (int i = 0; i < count; ++i)
+                        q.addBindValue(ids[begin + i]);
+
+                    if (!QueryStatistics::exec(q))
+                        return fail(QString("Failed to read current statuses: %1").arg(q.lastError().text()));
+
+                    while (q.next()) {
+                        current.insert(entityKey(type, q.value(0).toInt()),
+                            { EntityStatus::StringToWorkflowStatus(q.value(1).toString()),
+                              q.value(2).toString(), q.value(3) });
+                    }
+                }
+            }
+
+            // 2) Validate in memory and build the rows; sets apply in order
+            const QDateTime now = QDateTime::currentDateTime();
+            const QVariant by = transitionedBy >= 0 ? QVariant(transitionedBy) : QVariant(QVariant::Int);
+            const QString normal = EntityStatus::PriorityToString(Priority::NORMAL);
+
+            BulkInsertWriter history(lease, "entity_status",
+                { "entity_type", "entity_id", "status", "status_reason", "priority",
+                  "assigned_to", "transitioned_by", "transitioned_at" });
+            history.setCollectGeneratedIds(true);
+
+            QVector<QVariantList> currentRows;
+            for (const auto& set : sets) {
+                const QString type = EntityStatus::EntityTypeToString(set.Type);
+                const QString status = EntityStatus::WorkflowStatusToString(set.NewStatus);
+                const QVariant reason = set.Reason.isEmpty() ? QVariant(QVariant::String) : QVariant(set.Reason);
+
+                for (int id : set.EntityIds) {
+                    auto found = current.find(entityKey(set.Type, id));
+                    if (found != current.end()) {
+                        if (found->Status == set.NewStatus)
+                            continue;
+                        if (!EntityStatus::IsTransitionAllowed(found->Status, set.NewStatus)) {
+                            report(JournalApplyOutcome::Rejected);
+                            return fail(QString("Status transition %1 -> %2 is not allowed for %3 %4")
+                                .arg(EntityStatus::WorkflowStatusToString(found->Status), status, type)
+                                .arg(id));
+                        }
+                        found->Status = set.NewStatus;
+                    } else {
+                        found = current.insert(entityKey(set.Type, id), { set.NewStatus, normal, QVariant(QVariant::Int) });
+                    }
+
+                    history.addRow({ type, id, status, reason, found->Priority, found->AssignedTo, by, now });
+                    currentRows.push_back({ type, id, QVariant(), status, found->Priority, found->AssignedTo, now });
+                }
+            }
+
+            if (currentRows.isEmpty()) {
+                // A replayed record still keeps its claim, so a later replay does not
+                // re-evaluate it against newer statuses
+                if (journalKey && !lease.commit())
+                    return fail(QString("Failed to commit entity statuses: %1").arg(db.lastError().text()));
+                if (!journalKey)
+                    lease.rollback();
+                return Result<int>::Success(0);
+            }
+
+            // 3) History rows, then the current-status rows pointing at them
+            if (!history.flush())
+                return fail(QString("Failed to insert entity statuses: %1").arg(history.lastError()));
+
+            const QList<qint64> statusIds = history.generatedIds();
+            if (statusIds.size() != currentRows.size())
+                return fail(QString("Failed to insert entity statuses: %1 ids for %2 rows")
+                    .arg(statusIds.size()).arg(currentRows.size()));
+
+            BulkInsertWriter currentWriter(lease, "entity_current_status",
+                { "entity_type", "entity_id", "status_id", "status", "priority", "assigned_to", "transitioned_at" });
+            currentWriter.setUpdateOnDuplicate({ "status_id", "status", "priority", "assigned_to", "transitioned_at" }, "status_id");
+            for (int i = 0; i < currentRows.size(); ++i) {
+                currentRows[i][2] = statusIds[i];
+                currentWriter.addRow(currentRows[i]);
+            }
+
+            if (!currentWriter.flush())
+                return fail(QString("Failed to update current entity statuses: %1").arg(currentWriter.lastError()));
+
+            if (!lease.commit())
+                return fail(QString("Failed to commit entity statuses: %1").arg(db.lastError().text()));
+
+            written = history.rowsWritten();
+        }
+        return Result<int>::Success(written);
+    }
+
+    Result<int> DicomRepository::purgeStatusHistory(const QDateTime& before, int maxRows)
+    {
+        QVector<int> ids;
+        {
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = QString("Failed to open database: %1").arg(lease.lastError());
+                logger->LogError(err);
+                return Result<int>::Failure(err);
+            }
+
+            // Oldest first by transition time; current statuses are referenced by entity_current_status
+            QSqlQuery& select = lease.prepare(R"(
+                SELECT es.id
+                FROM entity_status es
+                WHERE es.transitioned_at < :before
+                  AND NOT EXISTS (SELECT 1 FROM entity_current_status cs WHERE cs.status_id = es.id)
+                ORDER BY es.transitioned_at
+                LIMIT :limit
+            )");
+            select.bindValue(":before", before);
+            select.bindValue(":limit", qMax(1, maxRows));
+
+            if (!QueryStatistics::exec(select)) {
+                const auto err = QString("Failed to read expired status history: %1").arg(select.lastError().text());
+                logger->LogError(err);
+                return Result<int>::Failure(err);
+            }
+            while (select.next())
+                ids.push_back(select.value(0).toInt());
+            select.finish();
+
+            if (ids.isEmpty())
+                return Result<int>::Success(0);
+
+            if (!lease.transaction()) {
+                const auto err = QString("Failed to start transaction: %1").arg(db.lastError().text());
+                logger->LogError(err);
+                return Result<int>::Failure(err);
+            }
+
+            // A row read above stays superseded: new transitions only add newer current rows
+            QSqlQuery remove(db);
+            remove.prepare(QString("DELETE FROM entity_status WHERE id IN (%1)")
+                .arg(QStringList(ids.size(), "?").join(", ")));
+            for (int i = 0; i < ids.size(); ++i)
+                remove.bindValue(i, ids[i]);
+
+            if (!QueryStatistics::exec(remove)) {
+                const auto err = QString("Failed to delete expired status history: %1").arg(remove.lastError().text());
+                logger->LogError(err);
+                lease.rollback();
+                return Result<int>::Failure(err);
+            }
+
+            if (!lease.commit()) {
+                const auto err = QString("Failed to commit status history purge: %1").arg(db.lastError().text());
+                logger->LogError(err);
+                lease.rollback();
+                return Result<int>::Failure(err);
+            }
+        }
+        return Result<int>::Success(ids.size());
+    }
+
     Result<WorklistEntry> DicomRepository::insertWorklistEntry(WorklistEntry& entry)
     {
-        const QString cx = "dicom_conn_insert_mwl_entry_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = QString("Failed to open database: %1").arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = QString("Failed to open database: %1").arg(lease.lastError());
                 logger->LogError(err);
                 return Result<WorklistEntry>::Failure(err);
             }
 
-            QSqlQuery q(db);
-            q.prepare(R"(
+            QSqlQuery& q = lease.prepare(R"(
                 INSERT INTO mwl_entries (
                     source, profile_id, status, created_at, updated_at
                 ) VALUES (
@@ -585,18 +1177,14 @@ namespace Etrek::Dicom::Repository {
             q.bindValue(":created_at", entry.CreatedAt.isValid() ? entry.CreatedAt : QDateTime::currentDateTime());
             q.bindValue(":updated_at", entry.UpdatedAt.isValid() ? entry.UpdatedAt : QVariant(QVariant::DateTime));
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = QString("Failed to insert MWL entry: %1").arg(q.lastError().text());
                 logger->LogError(err);
-                db.close();
-                QSqlDatabase::removeDatabase(cx);
                 return Result<WorklistEntry>::Failure(err);
             }
 
             entry.Id = q.lastInsertId().toInt();
-            db.close();
         }
-        QSqlDatabase::removeDatabase(cx);
         return Result<WorklistEntry>::Success(entry);
     }
 
@@ -609,17 +1197,16 @@ namespace Etrek::Dicom::Repository {
             return Result<WorklistAttribute>::Failure(err);
         }
 
-        const QString cx = "dicom_conn_insert_mwl_attr_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = QString("Failed to open database: %1").arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = QString("Failed to open database: %1").arg(lease.lastError());
                 logger->LogError(err);
                 return Result<WorklistAttribute>::Failure(err);
             }
 
-            QSqlQuery q(db);
-            q.prepare(R"(
+            QSqlQuery& q = lease.prepare(R"(
                 INSERT INTO mwl_attributes (
                     mwl_entry_id, dicom_tag_id, tag_value
                 ) VALUES (
@@ -631,18 +1218,22 @@ namespace Etrek::Dicom::Repository {
             q.bindValue(":dicom_tag_id", attribute.Tag.Id);
             q.bindValue(":tag_value", attribute.TagValue.isEmpty() ? QVariant(QVariant::String) : attribute.TagValue);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = QString("Failed to insert MWL attribute: %1").arg(q.lastError().text());
                 logger->LogError(err);
-                db.close();
-                QSqlDatabase::removeDatabase(cx);
                 return Result<WorklistAttribute>::Failure(err);
             }
 
             attribute.id = q.lastInsertId().toInt();
-            db.close();
+
+            QString projectionError;
+            if (!WorklistDisplayProjection::refreshEntries(db, { attribute.EntryId }, &projectionError)) {
+                const auto err = QString("Failed to refresh MWL display columns (entry_id=%1): %2")
+                    .arg(attribute.EntryId).arg(projectionError);
+                logger->LogError(err);
+                return Result<WorklistAttribute>::Failure(err);
+            }
         }
-        QSqlDatabase::removeDatabase(cx);
         return Result<WorklistAttribute>::Success(attribute);
     }
 
@@ -651,24 +1242,18 @@ namespace Etrek::Dicom::Repository {
     {
         QVector<WorklistAttribute> insertedAttributes;
 
-        const QString cx = "dicom_conn_insert_mwl_attrs_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = QString("Failed to open database: %1").arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = QString("Failed to open database: %1").arg(lease.lastError());
                 logger->LogError(err);
                 return Result<QVector<WorklistAttribute>>::Failure(err);
             }
 
-            // Prepare query once, execute multiple times
-            QSqlQuery q(db);
-            q.prepare(R"(
-                INSERT INTO mwl_attributes (
-                    mwl_entry_id, dicom_tag_id, tag_value
-                ) VALUES (
-                    :mwl_entry_id, :dicom_tag_id, :tag_value
-                )
-            )");
+            // All attributes go out in as few multi-row INSERT statements as possible
+            BulkInsertWriter writer(lease, "mwl_attributes", { "mwl_entry_id", "dicom_tag_id", "tag_value" });
+            writer.setCollectGeneratedIds(true);
 
             for (const auto& attr : attributes) {
                 // Skip attributes without valid tag ID
@@ -678,28 +1263,34 @@ namespace Etrek::Dicom::Repository {
                     continue;
                 }
 
-                q.bindValue(":mwl_entry_id", mwlEntryId);
-                q.bindValue(":dicom_tag_id", attr.Tag.Id);
-                q.bindValue(":tag_value", attr.TagValue.isEmpty() ? QVariant(QVariant::String) : attr.TagValue);
-
-                if (!q.exec()) {
-                    const auto err = QString("Failed to insert MWL attribute (tag_id=%1): %2")
-                        .arg(attr.Tag.Id).arg(q.lastError().text());
-                    logger->LogError(err);
-                    db.close();
-                    QSqlDatabase::removeDatabase(cx);
-                    return Result<QVector<WorklistAttribute>>::Failure(err);
-                }
+                writer.addRow({ mwlEntryId, attr.Tag.Id,
+                    attr.TagValue.isEmpty() ? QVariant(QVariant::String) : QVariant(attr.TagValue) });
 
                 WorklistAttribute inserted = attr;
-                inserted.id = q.lastInsertId().toInt();
                 inserted.EntryId = mwlEntryId;
                 insertedAttributes.push_back(inserted);
             }
 
-            db.close();
+            if (!writer.flush()) {
+                const auto err = QString("Failed to insert MWL attributes (entry_id=%1): %2")
+                    .arg(mwlEntryId).arg(writer.lastError());
+                logger->LogError(err);
+                return Result<QVector<WorklistAttribute>>::Failure(err);
+            }
+
+            const auto ids = writer.generatedIds();
+            for (int i = 0; i < insertedAttributes.size() && i < ids.size(); ++i)
+                insertedAttributes[i].id = static_cast<int>(ids[i]);
+
+            // Worklist grid columns are materialized from the attributes
+            QString projectionError;
+            if (!WorklistDisplayProjection::refreshEntries(db, { mwlEntryId }, &projectionError)) {
+                const auto err = QString("Failed to refresh MWL display columns (entry_id=%1): %2")
+                    .arg(mwlEntryId).arg(projectionError);
+                logger->LogError(err);
+                return Result<QVector<WorklistAttribute>>::Failure(err);
+            }
         }
-        QSqlDatabase::removeDatabase(cx);
         return Result<QVector<WorklistAttribute>>::Success(insertedAttributes);
     }
 }
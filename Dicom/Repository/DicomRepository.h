@@ -8,10 +8,13 @@
 
 #include "Result.h"
 #include "DatabaseConnectionSetting.h"
+#include "JournalApplier.h"
 #include "TranslationProvider.h"
 #include "AppLogger.h"
 #include "Study.h"
 #include "Patient.h"
+#include "Series.h"
+#include "StudyHierarchy.h"
 #include "EntityStatus.h"
 #include "WorklistEntry.h"  // From Common/Include/Worklist/Data/Entity/
 #include "WorklistAttribute.h"  // From Common/Include/Worklist/Data/Entity/
@@ -38,9 +41,44 @@ namespace Etrek::Dicom::Repository {
         Etrek::Specification::Result<std::optional<Etrek::Dicom::Data::Entity::Patient>>
             findPatientByIdAndIssuer(const QString& patientId, const QString& issuerOfPatientId) const;
 
+        /**
+         * @brief Inserts the patient or, if (patient_id, issuer) exists, updates it, in one statement.
+         *
+         * Concurrent upserts of the same patient end with one row; @p patient's Id is set to it.
+         */
         Etrek::Specification::Result<Etrek::Dicom::Data::Entity::Patient>
             upsertPatient(Etrek::Dicom::Data::Entity::Patient& patient);
 
+        /**
+         * @brief Inserts the study or, if its Study Instance UID exists, updates it.
+         *
+         * @p study's PatientId must be set; its Id is set to the written row. Fails if the stored
+         * study belongs to another patient.
+         */
+        Etrek::Specification::Result<Etrek::Dicom::Data::Entity::Study>
+            upsertStudy(Etrek::Dicom::Data::Entity::Study& study);
+
+        /**
+         * @brief Inserts the series or, if its Series Instance UID exists, updates it.
+         *
+         * @p series's StudyId must be set; its Id is set to the written row. Fails if the stored
+         * series belongs to another study.
+         */
+        Etrek::Specification::Result<Etrek::Dicom::Data::Entity::Series>
+            upsertSeries(Etrek::Dicom::Data::Entity::Series& series);
+
+        /**
+         * @brief Upserts the patient, study and series of every hierarchy in a single transaction.
+         *
+         * Each row is one upsert statement, prepared once for the batch, with the ids of the rows
+         * above it filled in. Ids are set on @p hierarchies only once the transaction commits;
+         * one failed row rolls back the whole batch.
+         *
+         * @return Number of rows written (patients, studies and series).
+         */
+        Etrek::Specification::Result<int>
+            registerHierarchies(QVector<Etrek::Dicom::Data::Entity::StudyHierarchy>& hierarchies);
+
         // Status management methods
         Etrek::Specification::Result<Etrek::Dicom::Data::Entity::EntityStatus>
             insertEntityStatus(Etrek::Dicom::Data::Entity::EntityStatus& status);
@@ -58,6 +96,40 @@ namespace Etrek::Dicom::Repository {
         Etrek::Specification::Result<QVector<Etrek::Dicom::Data::Entity::EntityStatus>>
             getAssignedEntities(int userId, Etrek::Dicom::Data::Entity::WorkflowStatus status) const;
 
+        /**
+         * @brief Transitions many entities at once, e.g., all images, series and the study of an exam.
+         *
+         * Current statuses are read and locked in one query per chunk of ids and every transition
+         * is validated in memory with EntityStatus::IsTransitionAllowed. Then all history rows and
+         * current-status rows are written with multi-row statements in a single transaction.
+         * Entities already in the target status are skipped. One disallowed transition fails the
+         * whole batch and nothing is written.
+         *
+         * With @p journalKey the batch replays a WriteJournal record: the key is claimed in the
+         * same transaction (see JournalApplier::claimEntry()) and a batch whose key was claimed
+         * before writes nothing. @p outcome, when given, tells a claimed-before batch
+         * (AlreadyApplied) and a disallowed transition (Rejected) apart from a written one.
+         *
+         * @return Number of status history rows written.
+         */
+        Etrek::Specification::Result<int>
+            transitionStatuses(const QVector<Etrek::Dicom::Data::Entity::StatusTransitionSet>& sets,
+                               int transitionedBy = -1,
+                               const std::optional<Etrek::Core::Repository::JournalEntryKey>& journalKey = std::nullopt,
+                               Etrek::Core::Repository::JournalApplyOutcome* outcome = nullptr);
+
+        /**
+         * @brief Deletes at most @p maxRows of the oldest status history rows transitioned before
+         *        @p before, in one short transaction.
+         *
+         * Rows that are an entity's current status are kept however old they are. Call again
+         * until fewer than @p maxRows are reported to purge everything.
+         *
+         * @return Number of history rows deleted.
+         */
+        Etrek::Specification::Result<int>
+            purgeStatusHistory(const QDateTime& before, int maxRows);
+
         // Modality Worklist methods
         Etrek::Specification::Result<wle::WorklistEntry>
             insertWorklistEntry(wle::WorklistEntry& entry);
@@ -71,7 +143,13 @@ namespace Etrek::Dicom::Repository {
         ~DicomRepository();
 
     private:
-        QSqlDatabase createConnection(const QString& connectionName) const;
+        // Upserts on a leased connection; each returns the written row's id
+        Etrek::Specification::Result<int> upsertPatientRow(Etrek::Core::Repository::ConnectionLease& lease,
+                                                           const Etrek::Dicom::Data::Entity::Patient& patient) const;
+        Etrek::Specification::Result<int> upsertStudyRow(Etrek::Core::Repository::ConnectionLease& lease,
+                                                         const Etrek::Dicom::Data::Entity::Study& study) const;
+        Etrek::Specification::Result<int> upsertSeriesRow(Etrek::Core::Repository::ConnectionLease& lease,
+                                                          const Etrek::Dicom::Data::Entity::Series& series) const;
 
         std::shared_ptr<Etrek::Core::Data::Model::DatabaseConnectionSetting> m_connectionSetting;
         Etrek::Core::Globalization::TranslationProvider* translator = nullptr;
@@ -2,8 +2,9 @@
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QVariant>
-#include <QRandomGenerator>
 #include "AppLoggerFactory.h"
+#include "DatabaseConnectionPool.h"
+#include "QueryStatistics.h"
 
 namespace Etrek::Dicom::Repository {
 
@@ -13,6 +14,8 @@ namespace Etrek::Dicom::Repository {
     using Etrek::Core::Globalization::TranslationProvider;
     using Etrek::Core::Log::AppLoggerFactory;
     using Etrek::Core::Log::LoggerProvider;
+    using Etrek::Core::Repository::DatabaseConnectionPool;
+    using Etrek::Core::Repository::QueryStatistics;
 
     static inline QString kRepoName() { return "DicomTagRepository"; }
 
@@ -28,17 +31,6 @@ namespace Etrek::Dicom::Repository {
 
     DicomTagRepository::~DicomTagRepository() = default;
 
-    QSqlDatabase DicomTagRepository::createConnection(const QString& connectionName) const
-    {
-        QSqlDatabase db = QSqlDatabase::addDatabase("QMYSQL", connectionName);
-        db.setHostName(m_connectionSetting->getHostName());
-        db.setDatabaseName(m_connectionSetting->getDatabaseName());
-        db.setUserName(m_connectionSetting->getEtrekUserName());
-        db.setPassword(m_connectionSetting->getPassword());
-        db.setPort(m_connectionSetting->getPort());
-        return db;
-    }
-
     QString DicomTagRepository::makeTagKey(uint16_t group, uint16_t element)
     {
         return QString("%1,%2")
@@ -52,11 +44,11 @@ namespace Etrek::Dicom::Repository {
             return Result<bool>::Success(true);
         }
 
-        const QString cx = "dicom_tag_load_cache_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = QString("Failed to open database: %1").arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = QString("Failed to open database: %1").arg(lease.lastError());
                 logger->LogError(err);
                 return Result<bool>::Failure(err);
             }
@@ -70,11 +62,9 @@ namespace Etrek::Dicom::Repository {
                 ORDER BY name
             )");
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = QString("Failed to load DICOM tags: %1").arg(q.lastError().text());
                 logger->LogError(err);
-                db.close();
-                QSqlDatabase::removeDatabase(cx);
                 return Result<bool>::Failure(err);
             }
 
@@ -101,9 +91,7 @@ namespace Etrek::Dicom::Repository {
                 tagCache[tagKey] = tag;
             }
 
-            db.close();
         }
-        QSqlDatabase::removeDatabase(cx);
 
         cacheLoaded = true;
         logger->LogInfo(QString("Loaded %1 DICOM tags into cache").arg(keywordCache.size()));
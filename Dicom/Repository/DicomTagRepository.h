@@ -54,8 +54,6 @@ namespace Etrek::Dicom::Repository {
         ~DicomTagRepository();
 
     private:
-        QSqlDatabase createConnection(const QString& connectionName) const;
-
         /**
          * @brief Load all tags from database into cache
          * @return Result indicating success or failure
@@ -0,0 +1,73 @@
+#include "DicomWriteJournal.h"
+#include <QJsonArray>
+
+namespace Etrek::Dicom::Repository {
+
+    using Etrek::Specification::Result;
+    using Etrek::Dicom::Data::Entity::EntityStatus;
+    using Etrek::Dicom::Data::Entity::StatusTransitionSet;
+    using Etrek::Core::Repository::WriteJournal;
+    using Etrek::Core::Repository::JournalApplier;
+    using Etrek::Core::Repository::JournalEntryKey;
+    using Etrek::Core::Repository::JournalApplyOutcome;
+
+    DicomWriteJournal::DicomWriteJournal(std::shared_ptr<WriteJournal> journal)
+        : m_journal(std::move(journal))
+    {
+    }
+
+    Result<qint64> DicomWriteJournal::transitionStatuses(const QVector<StatusTransitionSet>& sets, int transitionedBy)
+    {
+        return m_journal->append(STATUS_TRANSITION_KIND, toPayload(sets, transitionedBy));
+    }
+
+    void DicomWriteJournal::registerHandlers(JournalApplier& applier, std::shared_ptr<DicomRepository> repository)
+    {
+        applier.registerHandler(STATUS_TRANSITION_KIND,
+            [repository](const JournalEntryKey& key, const QJsonObject& payload) {
+                JournalApplyOutcome outcome = JournalApplyOutcome::Applied;
+                auto written = repository->transitionStatuses(transitionSetsFromPayload(payload),
+                    payload.value("transitionedBy").toInt(-1), key, &outcome);
+                if (outcome == JournalApplyOutcome::Rejected)
+                    return Result<JournalApplyOutcome>::Success(outcome, written.message);
+                if (!written.isSuccess)
+                    return Result<JournalApplyOutcome>::Failure(written.message);
+                return Result<JournalApplyOutcome>::Success(outcome);
+            });
+    }
+
+    QJsonObject DicomWriteJournal::toPayload(const QVector<StatusTransitionSet>& sets, int transitionedBy)
+    {
+        QJsonArray jsonSets;
+        for (const auto& set : sets) {
+            QJsonArray ids;
+            for (int id : set.EntityIds)
+                ids.append(id);
+
+            jsonSets.append(QJsonObject{
+                { "type", EntityStatus::EntityTypeToString(set.Type) },
+                { "ids", ids },
+                { "status", EntityStatus::WorkflowStatusToString(set.NewStatus) },
+                { "reason", set.Reason } });
+        }
+        return QJsonObject{ { "sets", jsonSets }, { "transitionedBy", transitionedBy } };
+    }
+
+    QVector<StatusTransitionSet> DicomWriteJournal::transitionSetsFromPayload(const QJsonObject& payload)
+    {
+        QVector<StatusTransitionSet> sets;
+        for (const QJsonValue& value : payload.value("sets").toArray()) {
+            const QJsonObject jsonSet = value.toObject();
+
+            StatusTransitionSet set;
+            set.Type = EntityStatus::StringToEntityType(jsonSet.value("type").toString());
+            set.NewStatus = EntityStatus::StringToWorkflowStatus(jsonSet.value("status").toString());
+            set.Reason = jsonSet.value("reason").toString();
+            for (const QJsonValue& id : jsonSet.value("ids").toArray())
+                set.EntityIds.push_back(id.toInt());
+            sets.push_back(std::move(set));
+        }
+        return sets;
+    }
+
+} // namespace Etrek::Dicom::Repository
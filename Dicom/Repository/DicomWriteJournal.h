@@ -0,0 +1,54 @@
+#ifndef DICOMWRITEJOURNAL_H
+#define DICOMWRITEJOURNAL_H
+
+#include <QJsonObject>
+#include <QVector>
+#include <memory>
+
+#include "Result.h"
+#include "WriteJournal.h"
+#include "JournalApplier.h"
+#include "DicomRepository.h"
+#include "EntityStatus.h"
+
+namespace Etrek::Dicom::Repository {
+
+    /**
+     * @class DicomWriteJournal
+     * @brief Journals DicomRepository writes of the acquisition path instead of running them in line.
+     *
+     * Calls append a record to the WriteJournal and return without a database round trip. The
+     * handlers added by registerHandlers() replay the records through DicomRepository on the
+     * JournalApplier's thread.
+     */
+    class DicomWriteJournal
+    {
+    public:
+        static constexpr auto STATUS_TRANSITION_KIND = "dicom.status_transition";
+
+        explicit DicomWriteJournal(std::shared_ptr<Etrek::Core::Repository::WriteJournal> journal);
+
+        /**
+         * @brief Journals a DicomRepository::transitionStatuses() call.
+         * @return Result containing the sequence number of the record.
+         */
+        Etrek::Specification::Result<qint64>
+            transitionStatuses(const QVector<Etrek::Dicom::Data::Entity::StatusTransitionSet>& sets,
+                               int transitionedBy = -1);
+
+        /**
+         * @brief Registers the handlers that apply the records written by this class.
+         */
+        static void registerHandlers(Etrek::Core::Repository::JournalApplier& applier,
+                                     std::shared_ptr<DicomRepository> repository);
+
+        static QJsonObject toPayload(const QVector<Etrek::Dicom::Data::Entity::StatusTransitionSet>& sets, int transitionedBy);
+        static QVector<Etrek::Dicom::Data::Entity::StatusTransitionSet> transitionSetsFromPayload(const QJsonObject& payload);
+
+    private:
+        std::shared_ptr<Etrek::Core::Repository::WriteJournal> m_journal;
+    };
+
+} // namespace Etrek::Dicom::Repository
+
+#endif // DICOMWRITEJOURNAL_H
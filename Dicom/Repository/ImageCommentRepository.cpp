@@ -1,5 +1,7 @@
 #include "ImageCommentRepository.h"
 #include "AppLoggerFactory.h"
+#include "DatabaseConnectionPool.h"
+#include "QueryStatistics.h"
 #include "DatabaseConnectionSetting.h"
 #include "AppLogger.h"
 
@@ -12,6 +14,9 @@ namespace Etrek::Dicom::Repository {
     using Etrek::Core::Log::AppLogger;
     using Etrek::Core::Log::AppLoggerFactory;
     using Etrek::Core::Log::LoggerProvider;
+    using Etrek::Core::Repository::ConnectionLease;
+    using Etrek::Core::Repository::DatabaseConnectionPool;
+    using Etrek::Core::Repository::QueryStatistics;
 
     static inline QString kRepoName() { return "CommentRepository"; }
     static inline QString kTable() { return "image_comments"; }   // <- table name
@@ -25,19 +30,9 @@ namespace Etrek::Dicom::Repository {
     logger = factory.CreateLogger(kRepoName());
 }
 
-QSqlDatabase ImageCommentRepository::createConnection(const QString& connectionName) const {
-    QSqlDatabase db = QSqlDatabase::addDatabase("QMYSQL", connectionName);
-    db.setHostName(m_connectionSetting->getHostName());
-    db.setDatabaseName(m_connectionSetting->getDatabaseName());
-    db.setUserName(m_connectionSetting->getEtrekUserName());
-    db.setPassword(m_connectionSetting->getPassword());
-    db.setPort(m_connectionSetting->getPort());
-    return db;
-}
-
-static inline QString errOpen(const QSqlDatabase& db, TranslationProvider* tr) {
+static inline QString errOpen(const ConnectionLease& lease, TranslationProvider* tr) {
     // If you have translator keys like FAILED_TO_OPEN_DB_MSG, swap this to use them.
-    return QString("Failed to open database: %1").arg(db.lastError().text());
+    return QString("Failed to open database: %1").arg(lease.lastError());
 }
 
 static inline QString errExec(const QSqlQuery& q, TranslationProvider* tr) {
@@ -47,12 +42,12 @@ static inline QString errExec(const QSqlQuery& q, TranslationProvider* tr) {
 QVector<ImageComment> ImageCommentRepository::getAcceptedComments() const
 {
     QVector<ImageComment> out;
-    const QString cx = "comments_accepted_" + QString::number(QRandomGenerator::global()->generate());
 
     {
-        QSqlDatabase db = createConnection(cx);
-        if (!db.open()) {
-            const auto err = errOpen(db, translator);
+        auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+        QSqlDatabase& db = lease.database();
+        if (!db.isOpen()) {
+            const auto err = errOpen(lease, translator);
             logger->LogError(err);
             return out;
         }
@@ -65,7 +60,7 @@ QVector<ImageComment> ImageCommentRepository::getAcceptedComments() const
             ORDER BY id
         )").arg(kTable()));
 
-        if (!q.exec()) {
+        if (!QueryStatistics::exec(q)) {
             const auto err = errExec(q, translator);
             logger->LogError(err);
             return out;
@@ -82,19 +77,18 @@ QVector<ImageComment> ImageCommentRepository::getAcceptedComments() const
         }
     }
 
-    QSqlDatabase::removeDatabase(cx);
     return out;
 }
 
 QVector<ImageComment> ImageCommentRepository::getRejectComments() const
 {
     QVector<ImageComment> out;
-    const QString cx = "comments_reject_" + QString::number(QRandomGenerator::global()->generate());
 
     {
-        QSqlDatabase db = createConnection(cx);
-        if (!db.open()) {
-            const auto err = errOpen(db, translator);
+        auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+        QSqlDatabase& db = lease.database();
+        if (!db.isOpen()) {
+            const auto err = errOpen(lease, translator);
             logger->LogError(err);
             return out;
         }
@@ -107,7 +101,7 @@ QVector<ImageComment> ImageCommentRepository::getRejectComments() const
             ORDER BY id DESC
         )").arg(kTable()));
 
-        if (!q.exec()) {
+        if (!QueryStatistics::exec(q)) {
             const auto err = errExec(q, translator);
             logger->LogError(err);
             return out;
@@ -124,19 +118,18 @@ QVector<ImageComment> ImageCommentRepository::getRejectComments() const
         }
     }
 
-    QSqlDatabase::removeDatabase(cx);
     return out;
 }
 
 QVector<ImageComment> ImageCommentRepository::getAllComments() const
 {
     QVector<ImageComment> out;
-    const QString cx = "comments_reject_" + QString::number(QRandomGenerator::global()->generate());
 
     {
-        QSqlDatabase db = createConnection(cx);
-        if (!db.open()) {
-            const auto err = errOpen(db, translator);
+        auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+        QSqlDatabase& db = lease.database();
+        if (!db.isOpen()) {
+            const auto err = errOpen(lease, translator);
             logger->LogError(err);
             return out;
         }
@@ -148,7 +141,7 @@ QVector<ImageComment> ImageCommentRepository::getAllComments() const
             ORDER BY id DESC
         )").arg(kTable()));
 
-        if (!q.exec()) {
+        if (!QueryStatistics::exec(q)) {
             const auto err = errExec(q, translator);
             logger->LogError(err);
             return out;
@@ -165,19 +158,18 @@ QVector<ImageComment> ImageCommentRepository::getAllComments() const
         }
     }
 
-    QSqlDatabase::removeDatabase(cx);
     return out;
 }
 
 Result<ImageComment> ImageCommentRepository::addComment(const ImageComment& comment) const
 {
-    const QString cx = "comments_add_" + QString::number(QRandomGenerator::global()->generate());
     ImageComment inserted = comment;
 
     {
-        QSqlDatabase db = createConnection(cx);
-        if (!db.open()) {
-            const auto err = errOpen(db, translator);
+        auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+        QSqlDatabase& db = lease.database();
+        if (!db.isOpen()) {
+            const auto err = errOpen(lease, translator);
             logger->LogError(err);
             return Result<ImageComment>::Failure(err);
         }
@@ -197,7 +189,7 @@ Result<ImageComment> ImageCommentRepository::addComment(const ImageComment& comm
         q.addBindValue(comment.Comment);
         q.addBindValue(toRejectBool(comment.IsRejectComment)); // bind as bool/int
 
-        if (!q.exec()) {
+        if (!QueryStatistics::exec(q)) {
             const auto err = errExec(q, translator);
             logger->LogError(err);
             return Result<ImageComment>::Failure(err);
@@ -209,7 +201,6 @@ Result<ImageComment> ImageCommentRepository::addComment(const ImageComment& comm
         inserted.IsRejectComment = fromRejectBool(toRejectBool(comment.IsRejectComment));
     }
 
-    QSqlDatabase::removeDatabase(cx);
     return Result<ImageComment>::Success(inserted, "Inserted");
 }
 
@@ -219,12 +210,11 @@ Result<ImageComment> ImageCommentRepository::updateComment(const ImageComment& c
         return Result<ImageComment>::Failure("Invalid comment id.");
     }
 
-    const QString cx = "comments_update_" + QString::number(QRandomGenerator::global()->generate());
-
     {
-        QSqlDatabase db = createConnection(cx);
-        if (!db.open()) {
-            const auto err = errOpen(db, translator);
+        auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+        QSqlDatabase& db = lease.database();
+        if (!db.isOpen()) {
+            const auto err = errOpen(lease, translator);
             logger->LogError(err);
             return Result<ImageComment>::Failure(err);
         }
@@ -243,7 +233,7 @@ Result<ImageComment> ImageCommentRepository::updateComment(const ImageComment& c
         q.addBindValue(toRejectBool(comment.IsRejectComment));
         q.addBindValue(comment.Id);
 
-        if (!q.exec()) {
+        if (!QueryStatistics::exec(q)) {
             const auto err = errExec(q, translator);
             logger->LogError(err);
             return Result<ImageComment>::Failure(err);
@@ -254,7 +244,6 @@ Result<ImageComment> ImageCommentRepository::updateComment(const ImageComment& c
         }
     }
 
-    QSqlDatabase::removeDatabase(cx);
     return Result<ImageComment>::Success(comment, "Updated");
 }
 
@@ -264,12 +253,11 @@ Result<ImageComment> ImageCommentRepository::removeComment(const ImageComment& c
         return Result<ImageComment>::Failure("Invalid comment id.");
     }
 
-    const QString cx = "comments_delete_" + QString::number(QRandomGenerator::global()->generate());
-
     {
-        QSqlDatabase db = createConnection(cx);
-        if (!db.open()) {
-            const auto err = errOpen(db, translator);
+        auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+        QSqlDatabase& db = lease.database();
+        if (!db.isOpen()) {
+            const auto err = errOpen(lease, translator);
             logger->LogError(err);
             return Result<ImageComment>::Failure(err);
         }
@@ -281,7 +269,7 @@ Result<ImageComment> ImageCommentRepository::removeComment(const ImageComment& c
 
         q.addBindValue(comment.Id);
 
-        if (!q.exec()) {
+        if (!QueryStatistics::exec(q)) {
             const auto err = errExec(q, translator);
             logger->LogError(err);
             return Result<ImageComment>::Failure(err);
@@ -292,7 +280,6 @@ Result<ImageComment> ImageCommentRepository::removeComment(const ImageComment& c
         }
     }
 
-    QSqlDatabase::removeDatabase(cx);
     return Result<ImageComment>::Success(comment, "Deleted");
 }
 
@@ -34,7 +34,6 @@ namespace Etrek::Dicom::Repository {
 
     private:
         // Helpers
-        QSqlDatabase createConnection(const QString& connectionName) const;
         static bool toRejectBool(const QString& s);       // "true", "1", "y", "yes" => true
         static QString fromRejectBool(bool b);            // "true"/"false" (or "1"/"0" if you prefer)
 
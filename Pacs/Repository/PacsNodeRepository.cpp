@@ -1,5 +1,7 @@
 #include "PacsNodeRepository.h"
 #include "AppLoggerFactory.h"
+#include "DatabaseConnectionPool.h"
+#include "QueryStatistics.h"
 #include "AppLogger.h"
 
 #include <QVariant>
@@ -16,12 +18,15 @@ namespace Etrek::Pacs::Repository {
     using namespace Etrek::Pacs::Data::Entity;
     using namespace Etrek::Core::Globalization;
     using namespace Etrek::Core::Data::Model;
+    using Etrek::Core::Repository::ConnectionLease;
+    using Etrek::Core::Repository::DatabaseConnectionPool;
+    using Etrek::Core::Repository::QueryStatistics;
 
     static inline QString kRepoName() { return "PacsNodeRepository"; }
     static inline QString kTable() { return "pacs_nodes"; }
 
-    static inline QString errOpen(const QSqlDatabase& db, TranslationProvider* /*tr*/) {
-        return QString("Failed to open database: %1").arg(db.lastError().text());
+    static inline QString errOpen(const ConnectionLease& lease, TranslationProvider* /*tr*/) {
+        return QString("Failed to open database: %1").arg(lease.lastError());
     }
     static inline QString errExec(const QSqlQuery& q, TranslationProvider* /*tr*/) {
         return QString("Query failed: %1").arg(q.lastError().text());
@@ -35,17 +40,6 @@ namespace Etrek::Pacs::Repository {
         logger = factory.CreateLogger("PacsNodeRepository");
     }
 
-    QSqlDatabase PacsNodeRepository::createConnection(const QString& connectionName) const
-    {
-        QSqlDatabase db = QSqlDatabase::addDatabase("QMYSQL", connectionName);
-        db.setHostName(m_connectionSetting->getHostName());
-        db.setDatabaseName(m_connectionSetting->getDatabaseName());
-        db.setUserName(m_connectionSetting->getEtrekUserName());
-        db.setPassword(m_connectionSetting->getPassword());
-        db.setPort(m_connectionSetting->getPort());
-        return db;
-    }
-
     // --- Enum mapping helpers ---
     QString PacsNodeRepository::toEntityTypeString(PacsEntityType t)
     {
@@ -69,12 +63,12 @@ namespace Etrek::Pacs::Repository {
     QVector<PacsNode> PacsNodeRepository::getPacsNodes() const
     {
         QVector<PacsNode> out;
-        const QString cx = "pacs_nodes_all_" + QString::number(QRandomGenerator::global()->generate());
 
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = errOpen(db, translator);
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = errOpen(lease, translator);
                 logger->LogError(err);
                 return out;
             }
@@ -86,7 +80,7 @@ namespace Etrek::Pacs::Repository {
             ORDER BY id ASC
         )").arg(kTable()));
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = errExec(q, translator);
                 logger->LogError(err);
                 return out;
@@ -105,13 +99,11 @@ namespace Etrek::Pacs::Repository {
             }
         }
 
-        QSqlDatabase::removeDatabase(cx);
         return out;
     }
 
     Etrek::Specification::Result<PacsNode> PacsNodeRepository::addPacsNode(const PacsNode& node) const
     {
-        const QString cx = "pacs_nodes_add_" + QString::number(QRandomGenerator::global()->generate());
         PacsNode inserted = node;
 
         // Basic validations (tune as needed)
@@ -127,9 +119,10 @@ namespace Etrek::Pacs::Repository {
             return Etrek::Specification::Result<PacsNode>::Failure("CallingAET is required.");
 
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = errOpen(db, translator);
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = errOpen(lease, translator);
                 logger->LogError(err);
                 return Etrek::Specification::Result<PacsNode>::Failure(err);
             }
@@ -150,7 +143,7 @@ namespace Etrek::Pacs::Repository {
             q.addBindValue(node.CallingAet);
             q.addBindValue(false);                          // default flag (adjust if you add to entity)
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = errExec(q, translator);
                 logger->LogError(err);
                 return Etrek::Specification::Result<PacsNode>::Failure(err);
@@ -160,7 +153,6 @@ namespace Etrek::Pacs::Repository {
             if (newId.isValid()) inserted.Id = newId.toInt();
         }
 
-        QSqlDatabase::removeDatabase(cx);
         return Etrek::Specification::Result<PacsNode>::Success(inserted, "Inserted");
     }
 
@@ -180,12 +172,11 @@ namespace Etrek::Pacs::Repository {
         if (node.CallingAet.trimmed().isEmpty())
             return Etrek::Specification::Result<PacsNode>::Failure("CallingAET is required.");
 
-        const QString cx = "pacs_nodes_upd_" + QString::number(QRandomGenerator::global()->generate());
-
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = errOpen(db, translator);
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = errOpen(lease, translator);
                 logger->LogError(err);
                 return Etrek::Specification::Result<PacsNode>::Failure(err);
             }
@@ -210,7 +201,7 @@ namespace Etrek::Pacs::Repository {
             q.addBindValue(node.CallingAet);
             q.addBindValue(node.Id);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = errExec(q, translator);
                 logger->LogError(err);
                 return Etrek::Specification::Result<PacsNode>::Failure(err);
@@ -221,7 +212,6 @@ namespace Etrek::Pacs::Repository {
             }
         }
 
-        QSqlDatabase::removeDatabase(cx);
         return Etrek::Specification::Result<PacsNode>::Success(node, "Updated");
     }
 
@@ -230,13 +220,13 @@ namespace Etrek::Pacs::Repository {
         if (node.Id <= 0)
             return Etrek::Specification::Result<bool>::Failure("Invalid node Id.");
 
-        const QString cx = "pacs_nodes_del_" + QString::number(QRandomGenerator::global()->generate());
         bool deleted = false;
 
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = errOpen(db, translator);
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = errOpen(lease, translator);
                 logger->LogError(err);
                 return Etrek::Specification::Result<bool>::Failure(err);
             }
@@ -248,7 +238,7 @@ namespace Etrek::Pacs::Repository {
 
             q.addBindValue(node.Id);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = errExec(q, translator);
                 logger->LogError(err);
                 return Etrek::Specification::Result<bool>::Failure(err);
@@ -260,7 +250,6 @@ namespace Etrek::Pacs::Repository {
             }
         }
 
-        QSqlDatabase::removeDatabase(cx);
         return Etrek::Specification::Result<bool>::Success(true, "Deleted");
     }
 
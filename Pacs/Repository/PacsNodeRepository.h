@@ -32,8 +32,6 @@ namespace Etrek::Pacs::Repository {
 
     private:
         // Helpers
-        QSqlDatabase createConnection(const QString& connectionName) const;
-
         static QString toEntityTypeString(PacsEntityType t);  // "Archive"/"MPPS"
         static PacsEntityType parseEntityTypeString(const QString& s);
 
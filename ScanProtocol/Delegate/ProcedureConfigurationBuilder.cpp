@@ -18,11 +18,11 @@ namespace Etrek::ScanProtocol::Delegate
     {
         auto repo = std::make_shared<Etrek::ScanProtocol::Repository::ScanProtocolRepository>(params.dbConnection, nullptr);
 
-        auto views = repo->getAllViews();
-		auto procedures = repo->getAllProcedures();
+        // Procedures come with their views hydrated, loaded together in one pass
+        auto catalog = repo->loadCatalog();
         auto bodyParts = repo->getAllBodyParts();
         auto anatomicalRegions = repo->getAllAnatomicRegions();
-        auto widget = new ProcedureConfigurationWidget(procedures.value, bodyParts.value, anatomicalRegions.value, views.value, parentWidget);
+        auto widget = new ProcedureConfigurationWidget(catalog.value.Procedures, bodyParts.value, anatomicalRegions.value, catalog.value.Views, parentWidget);
         auto delegate = new ProcedureConfigurationDelegate(widget, parentDelegate);
 
         // If you need to attach other delegates:
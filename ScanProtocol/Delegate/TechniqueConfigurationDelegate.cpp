@@ -75,6 +75,9 @@ namespace Etrek::ScanProtocol::Delegate {
 
         // 6) refresh cache (avoid move-assign quirks)
         m_lastPersistedByKey = nowByKey; // or m_lastPersistedByKey.swap(nowByKey);
+
+        // 7) publish the edited catalog to the exam-time readers, loaded off the GUI thread
+        m_repo->refreshCatalogSnapshotInBackground();
         return ok;
     }
 
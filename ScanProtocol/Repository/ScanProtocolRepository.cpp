@@ -3,10 +3,13 @@
 #include <QSqlError>
 #include <QSqlQuery>
 #include <QSqlRecord>
+#include <QThreadPool>
 #include <QVariant>
-#include <QRandomGenerator>
+#include <algorithm>
 
 #include "AppLoggerFactory.h"
+#include "DatabaseConnectionPool.h"
+#include "QueryStatistics.h"
 #include "ScanProtocolUtil.h"
 #include "IWorklistRepository.h"
 #include "Result.h"
@@ -39,6 +42,78 @@ namespace Etrek::ScanProtocol::Repository
 	using Etrek::Core::Log::AppLogger;
 	using Etrek::Core::Globalization::TranslationProvider;
     using Etrek::Specification::Result;
+    using Etrek::Core::Repository::DatabaseConnectionPool;
+    using Etrek::Core::Repository::QueryStatistics;
+
+    // Shared by the single-entity readers and loadCatalog()
+    static const char* ALL_TECHNIQUE_PARAMETERS_SQL = R"(
+        SELECT
+            tp.id,
+            tp.body_part_id,
+            tp.size,
+            tp.technique_profile,
+            tp.kvp,
+            tp.ma,
+            tp.ms,
+            tp.fkvp,
+            tp.fma,
+            tp.focal_spot,
+            tp.sid_min,
+            tp.sid_max,
+            tp.grid_type,
+            tp.grid_ratio,
+            tp.grid_speed,
+            tp.exposure_style,
+            tp.aec_field,
+            tp.aec_density,
+
+            bp.name          AS bp_name,
+            bp.code_value    AS bp_code_value,
+            bp.coding_scheme AS bp_coding_scheme,
+            bp.description   AS bp_description,
+            bp.is_active     AS bp_is_active
+
+        FROM technique_parameters tp
+        LEFT JOIN body_parts bp ON bp.id = tp.body_part_id
+        ORDER BY tp.body_part_id, tp.size, tp.technique_profile, tp.id
+    )";
+
+    static const char* ALL_VIEWS_SQL = R"(
+        SELECT v.*,
+               bp.name          AS bp_name,
+               bp.code_value    AS bp_code_value,
+               bp.coding_scheme AS bp_coding_scheme,
+               bp.description   AS bp_description,
+               bp.is_active     AS bp_is_active
+        FROM views v
+        LEFT JOIN body_parts bp ON bp.id = v.body_part_id
+        ORDER BY v.body_part_id, v.name, v.id
+    )";
+
+    static const char* ALL_PROCEDURES_SQL = R"(
+        SELECT
+            p.*,
+
+            ar.id            AS ar_id,
+            ar.name          AS ar_name,
+            ar.code_value    AS ar_code_value,
+            ar.coding_scheme AS ar_coding_scheme,
+            ar.code_meaning  AS ar_code_meaning,
+            ar.description   AS ar_description,
+            ar.display_order AS ar_display_order,
+
+            bp.id            AS bp_id,
+            bp.name          AS bp_name,
+            bp.code_value    AS bp_code_value,
+            bp.coding_scheme AS bp_coding_scheme,
+            bp.description   AS bp_description,
+            bp.is_active     AS bp_is_active
+
+        FROM procedures p
+        LEFT JOIN anatomic_regions ar ON ar.id = p.anatomic_region_id
+        LEFT JOIN body_parts      bp ON bp.id = p.body_part_id
+        ORDER BY p.name, p.id
+    )";
 
     // ----------------------------- Local DB helpers ------------------------------
     // --- DB bind helpers ---
@@ -175,6 +250,44 @@ namespace Etrek::ScanProtocol::Repository
         return p;
     }
 
+    // --- Row mapper for technique parameters ---
+    inline Etrek::ScanProtocol::Data::Entity::TechniqueParameter mapTechniqueParameterRow(QSqlQuery& q)
+    {
+        using namespace Etrek::ScanProtocol::Data::Entity;
+        TechniqueParameter tp;
+        tp.Id = q.value("id").toInt();
+
+        tp.BodyPart.Id = q.value("body_part_id").toInt();
+        tp.BodyPart.Name = q.value("bp_name").toString();
+        tp.BodyPart.CodeValue = q.value("bp_code_value").toString();
+        tp.BodyPart.CodingSchema = q.value("bp_coding_scheme").toString();
+        tp.BodyPart.Description = q.value("bp_description").toString();
+        tp.BodyPart.IsActive = q.value("bp_is_active").toBool();
+
+        tp.Size = ScanProtocolUtil::parseSize(q.value("size").toString());
+        tp.Profile = ScanProtocolUtil::parseProfile(q.value("technique_profile").toString());
+
+        tp.Kvp = q.value("kvp").toInt();
+        tp.Ma = q.value("ma").toInt();
+        tp.Ms = q.value("ms").toInt();
+        tp.FKvp = q.value("fkvp").toInt();
+        tp.FMa = q.value("fma").toDouble();
+        tp.FocalSpotSize = q.value("focal_spot").isNull() ? 0 : q.value("focal_spot").toInt();
+        tp.SIDMin = q.value("sid_min").isNull() ? 0.0 : q.value("sid_min").toDouble();
+        tp.SIDMax = q.value("sid_max").isNull() ? 0.0 : q.value("sid_max").toDouble();
+
+        const auto gridStr = q.value("grid_type").toString();
+        if (gridStr.isEmpty()) tp.GridType.reset();
+        else tp.GridType = ScanProtocolUtil::parseGridType(gridStr);
+
+        tp.GridRatio = q.value("grid_ratio").toString();
+        tp.GridSpeed = q.value("grid_speed").toString();
+        tp.ExposureStyle = ScanProtocolUtil::parseExposureStyle(q.value("exposure_style").toString());
+        tp.AecFields = q.value("aec_field").toString();
+        tp.AecDensity = q.value("aec_density").isNull() ? 0 : q.value("aec_density").toInt();
+
+        return tp;
+    }
 
     // -------------------------------- Ctor / Dtor --------------------------------
 
@@ -182,6 +295,7 @@ namespace Etrek::ScanProtocol::Repository
         TranslationProvider* tr)
         : m_connectionSetting(connectionSetting)
         , translator(tr ? tr : &TranslationProvider::Instance())
+        , m_snapshots(ScanProtocolSnapshotStore::forDatabase(*connectionSetting))
     {
         AppLoggerFactory factory(LoggerProvider::Instance(), translator);
         logger = factory.CreateLogger(kRepoName());
@@ -191,27 +305,16 @@ namespace Etrek::ScanProtocol::Repository
 
     // ------------------------------- Connection ----------------------------------
 
-    QSqlDatabase ScanProtocolRepository::createConnection(const QString& connectionName) const
-    {
-        QSqlDatabase db = QSqlDatabase::addDatabase("QMYSQL", connectionName);
-        db.setHostName(m_connectionSetting->getHostName());
-        db.setDatabaseName(m_connectionSetting->getDatabaseName());
-        db.setUserName(m_connectionSetting->getEtrekUserName());
-        db.setPassword(m_connectionSetting->getPassword());
-        db.setPort(m_connectionSetting->getPort());
-        return db;
-    }
-
     // --------------------------------- Regions -----------------------------------
 
     Result<QVector<AnatomicRegion>> ScanProtocolRepository::getAllAnatomicRegions() const
     {
         QVector<AnatomicRegion> rows;
-        const QString cx = "anatomic_regions_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(err);
                 return Result<QVector<AnatomicRegion>>::Failure(err);
             }
@@ -225,10 +328,9 @@ namespace Etrek::ScanProtocol::Repository
             ORDER BY display_order, name
         )");
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
-                QSqlDatabase::removeDatabase(cx);
                 return Result<QVector<AnatomicRegion>>::Failure(err);
             }
 
@@ -246,7 +348,6 @@ namespace Etrek::ScanProtocol::Repository
                 rows.push_back(std::move(ar));
             }
         }
-        QSqlDatabase::removeDatabase(cx);
         return Result<QVector<AnatomicRegion>>::Success(rows);
     }
 
@@ -255,11 +356,11 @@ namespace Etrek::ScanProtocol::Repository
     Result<QVector<BodyPart>> ScanProtocolRepository::getAllBodyParts() const
     {
         QVector<BodyPart> rows;
-        const QString cx = "body_parts_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(err);
                 return Result<QVector<BodyPart>>::Failure(err);
             }
@@ -287,10 +388,9 @@ namespace Etrek::ScanProtocol::Repository
             ORDER BY ar.display_order, ar.name, bp.name
         )");
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
-                QSqlDatabase::removeDatabase(cx);
                 return Result<QVector<BodyPart>>::Failure(err);
             }
 
@@ -317,7 +417,6 @@ namespace Etrek::ScanProtocol::Repository
                 rows.push_back(std::move(bp));
             }
         }
-        QSqlDatabase::removeDatabase(cx);
         return Result<QVector<BodyPart>>::Success(rows);
     }
 
@@ -325,93 +424,31 @@ namespace Etrek::ScanProtocol::Repository
 
     Result<QVector<TechniqueParameter>> ScanProtocolRepository::getAllTechniqueParameters() const
     {
+        if (auto snapshot = currentSnapshot())
+            return Result<QVector<TechniqueParameter>>::Success(snapshot->catalog().TechniqueParameters);
+
         QVector<TechniqueParameter> rows;
-        const QString cx = "tech_params_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(err);
                 return Result<QVector<TechniqueParameter>>::Failure(err);
             }
 
             QSqlQuery q(db);
-            q.prepare(R"(
-            SELECT
-                tp.id,
-                tp.body_part_id,
-                tp.size,
-                tp.technique_profile,
-                tp.kvp,
-                tp.ma,
-                tp.ms,
-                tp.fkvp,
-                tp.fma,
-                tp.focal_spot,
-                tp.sid_min,
-                tp.sid_max,
-                tp.grid_type,
-                tp.grid_ratio,
-                tp.grid_speed,
-                tp.exposure_style,
-                tp.aec_field,
-                tp.aec_density,
-
-                bp.name          AS bp_name,
-                bp.code_value    AS bp_code_value,
-                bp.coding_scheme AS bp_coding_scheme,
-                bp.description   AS bp_description,
-                bp.is_active     AS bp_is_active
-
-            FROM technique_parameters tp
-            LEFT JOIN body_parts bp ON bp.id = tp.body_part_id
-            ORDER BY tp.body_part_id, tp.size, tp.technique_profile, tp.id
-        )");
+            q.prepare(ALL_TECHNIQUE_PARAMETERS_SQL);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
-                QSqlDatabase::removeDatabase(cx);
                 return Result<QVector<TechniqueParameter>>::Failure(err);
             }
 
-            while (q.next()) {
-                TechniqueParameter tp;
-                tp.Id = q.value("id").toInt();
-
-                tp.BodyPart.Id = q.value("body_part_id").toInt();
-                tp.BodyPart.Name = q.value("bp_name").toString();
-                tp.BodyPart.CodeValue = q.value("bp_code_value").toString();
-                tp.BodyPart.CodingSchema = q.value("bp_coding_scheme").toString();
-                tp.BodyPart.Description = q.value("bp_description").toString();
-                tp.BodyPart.IsActive = q.value("bp_is_active").toBool();
-
-                tp.Size = ScanProtocolUtil::parseSize(q.value("size").toString());
-                tp.Profile = ScanProtocolUtil::parseProfile(q.value("technique_profile").toString());
-
-                tp.Kvp = q.value("kvp").toInt();
-                tp.Ma = q.value("ma").toInt();
-                tp.Ms = q.value("ms").toInt();
-                tp.FKvp = q.value("fkvp").toInt();
-                tp.FMa = q.value("fma").toDouble();
-                tp.FocalSpotSize = q.value("focal_spot").isNull() ? 0 : q.value("focal_spot").toInt();
-                tp.SIDMin = q.value("sid_min").isNull() ? 0.0 : q.value("sid_min").toDouble();
-                tp.SIDMax = q.value("sid_max").isNull() ? 0.0 : q.value("sid_max").toDouble();
-
-                const auto gridStr = q.value("grid_type").toString();
-                if (gridStr.isEmpty()) tp.GridType.reset();
-                else tp.GridType = ScanProtocolUtil::parseGridType(gridStr);
-
-                tp.GridRatio = q.value("grid_ratio").toString();
-                tp.GridSpeed = q.value("grid_speed").toString();
-                tp.ExposureStyle = ScanProtocolUtil::parseExposureStyle(q.value("exposure_style").toString());
-                tp.AecFields = q.value("aec_field").toString();
-                tp.AecDensity = q.value("aec_density").isNull() ? 0 : q.value("aec_density").toInt();
-
-                rows.push_back(std::move(tp));
-            }
+            while (q.next())
+                rows.push_back(mapTechniqueParameterRow(q));
         }
-        QSqlDatabase::removeDatabase(cx);
         return Result<QVector<TechniqueParameter>>::Success(rows);
     }
 
@@ -423,11 +460,11 @@ namespace Etrek::ScanProtocol::Repository
 
     Result<void> ScanProtocolRepository::upsertTechniqueParameter(const TechniqueParameter& tp) const
     {
-        const QString cx = "tp_upsert_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open())
-                return Result<void>::Failure(translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text()));
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen())
+                return Result<void>::Failure(translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError()));
 
             QSqlQuery q(db);
             q.prepare(R"(
@@ -454,10 +491,9 @@ namespace Etrek::ScanProtocol::Repository
             q.addBindValue(sizeToDb(tp.Size));
             q.addBindValue(profToDb(tp.Profile));
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
-                QSqlDatabase::removeDatabase(cx);
                 return Result<void>::Failure(err);
             }
 
@@ -489,15 +525,14 @@ namespace Etrek::ScanProtocol::Repository
                 ins.addBindValue(tp.AecFields);
                 ins.addBindValue(tp.AecDensity);
 
-                if (!ins.exec()) {
+                if (!QueryStatistics::exec(ins)) {
                     const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(ins.lastError().text());
                     logger->LogError(err);
-                    QSqlDatabase::removeDatabase(cx);
                     return Result<void>::Failure(err);
                 }
             }
         }
-        QSqlDatabase::removeDatabase(cx);
+        m_snapshots->markChanged();
         return Result<void>::Success({});
     }
 
@@ -505,11 +540,11 @@ namespace Etrek::ScanProtocol::Repository
         BodySize size,
         TechniqueProfile profile) const
     {
-        const QString cx = "tp_delete_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open())
-                return Result<void>::Failure(translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text()));
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen())
+                return Result<void>::Failure(translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError()));
 
             QSqlQuery q(db);
             q.prepare(R"(DELETE FROM technique_parameters
@@ -518,14 +553,13 @@ namespace Etrek::ScanProtocol::Repository
             q.addBindValue(sizeToDb(size));
             q.addBindValue(profToDb(profile));
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
-                QSqlDatabase::removeDatabase(cx);
                 return Result<void>::Failure(err);
             }
         }
-        QSqlDatabase::removeDatabase(cx);
+        m_snapshots->markChanged();
         return Result<void>::Success({});
     }
 
@@ -533,51 +567,47 @@ namespace Etrek::ScanProtocol::Repository
 
     Result<QVector<View>> ScanProtocolRepository::getAllViews() const
     {
+        if (auto snapshot = currentSnapshot())
+            return Result<QVector<View>>::Success(snapshot->catalog().Views);
+
         QVector<View> rows;
-        const QString cx = "views_all_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(err);
                 return Result<QVector<View>>::Failure(err);
             }
 
             QSqlQuery q(db);
-            q.prepare(R"(
-            SELECT v.*,
-                   bp.name          AS bp_name,
-                   bp.code_value    AS bp_code_value,
-                   bp.coding_scheme AS bp_coding_scheme,
-                   bp.description   AS bp_description,
-                   bp.is_active     AS bp_is_active
-            FROM views v
-            LEFT JOIN body_parts bp ON bp.id = v.body_part_id
-            ORDER BY v.body_part_id, v.name, v.id
-        )");
+            q.prepare(ALL_VIEWS_SQL);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
-                QSqlDatabase::removeDatabase(cx);
                 return Result<QVector<View>>::Failure(err);
             }
 
             while (q.next())
                 rows.push_back(mapViewRow(q));
         }
-        QSqlDatabase::removeDatabase(cx);
         return Result<QVector<View>>::Success(rows);
     }
 
     Result<QVector<View>> ScanProtocolRepository::getViewsByBodyPart(int bodyPartId) const
     {
         QVector<View> rows;
-        const QString cx = "views_bp_" + QString::number(QRandomGenerator::global()->generate());
+        if (auto snapshot = currentSnapshot()) {
+            for (const View* view : snapshot->viewsForBodyPart(bodyPartId))
+                rows.push_back(*view);
+            return Result<QVector<View>>::Success(rows);
+        }
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(err);
                 return Result<QVector<View>>::Failure(err);
             }
@@ -597,27 +627,29 @@ namespace Etrek::ScanProtocol::Repository
         )");
             q.addBindValue(bodyPartId);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
-                QSqlDatabase::removeDatabase(cx);
                 return Result<QVector<View>>::Failure(err);
             }
 
             while (q.next())
                 rows.push_back(mapViewRow(q));
         }
-        QSqlDatabase::removeDatabase(cx);
         return Result<QVector<View>>::Success(rows);
     }
 
     Result<View> ScanProtocolRepository::getViewById(int id) const
     {
-        const QString cx = "view_id_" + QString::number(QRandomGenerator::global()->generate());
+        if (auto snapshot = currentSnapshot()) {
+            if (const View* view = snapshot->findView(id))
+                return Result<View>::Success(*view);
+        }
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(err);
                 return Result<View>::Failure(err);
             }
@@ -637,28 +669,26 @@ namespace Etrek::ScanProtocol::Repository
         )");
             q.addBindValue(id);
 
-            if (!q.exec() || !q.next()) {
+            if (!QueryStatistics::exec(q) || !q.next()) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(
                     q.lastError().text().isEmpty() ? "not found" : q.lastError().text());
                 logger->LogError(err);
-                QSqlDatabase::removeDatabase(cx);
                 return Result<View>::Failure(err);
             }
 
             View v = mapViewRow(q);
-            QSqlDatabase::removeDatabase(cx);
             return Result<View>::Success(v);
         }
     }
 
     Result<int> ScanProtocolRepository::createView(const View& v) const
     {
-        const QString cx = "view_ins_" + QString::number(QRandomGenerator::global()->generate());
         int newId = -1;
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open())
-                return Result<int>::Failure(translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text()));
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen())
+                return Result<int>::Failure(translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError()));
 
             QSqlQuery ins(db);
             ins.prepare(R"(
@@ -691,16 +721,15 @@ namespace Etrek::ScanProtocol::Repository
             ins.addBindValue(optStrToDb(v.PositionName));
             ins.addBindValue(boolToTiny(v.IsActive));
 
-            if (!ins.exec()) {
+            if (!QueryStatistics::exec(ins)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(ins.lastError().text());
                 logger->LogError(err);
-                QSqlDatabase::removeDatabase(cx);
                 return Result<int>::Failure(err);
             }
 
             newId = ins.lastInsertId().toInt();
         }
-        QSqlDatabase::removeDatabase(cx);
+        m_snapshots->markChanged();
         return Result<int>::Success(newId);
     }
 
@@ -709,11 +738,11 @@ namespace Etrek::ScanProtocol::Repository
         if (v.Id <= 0)
             return Result<void>::Failure("updateView requires valid v.Id");
 
-        const QString cx = "view_upd_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open())
-                return Result<void>::Failure(translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text()));
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen())
+                return Result<void>::Failure(translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError()));
 
             QSqlQuery q(db);
             q.prepare(R"(
@@ -758,24 +787,23 @@ namespace Etrek::ScanProtocol::Repository
             q.addBindValue(boolToTiny(v.IsActive));
             q.addBindValue(v.Id);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
-                QSqlDatabase::removeDatabase(cx);
                 return Result<void>::Failure(err);
             }
         }
-        QSqlDatabase::removeDatabase(cx);
+        m_snapshots->markChanged();
         return Result<void>::Success({});
     }
 
     Result<void> ScanProtocolRepository::deleteView(int viewId, bool hard) const
     {
-        const QString cx = QString("view_del_%1").arg(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open())
-                return Result<void>::Failure(translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text()));
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen())
+                return Result<void>::Failure(translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError()));
 
             QSqlQuery q(db);
             if (hard) {
@@ -787,14 +815,13 @@ namespace Etrek::ScanProtocol::Repository
                 q.addBindValue(viewId);
             }
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
-                QSqlDatabase::removeDatabase(cx);
                 return Result<void>::Failure(err);
             }
         }
-        QSqlDatabase::removeDatabase(cx);
+        m_snapshots->markChanged();
         return Result<void>::Success({});
     }
 
@@ -803,11 +830,13 @@ namespace Etrek::ScanProtocol::Repository
     Result<QVector<ViewTechnique>> ScanProtocolRepository::getViewTechniques(int viewId) const
     {
         QVector<ViewTechnique> rows;
-        const QString cx = "vt_all_" + QString::number(QRandomGenerator::global()->generate());
+        if (auto snapshot = currentSnapshot())
+            return Result<QVector<ViewTechnique>>::Success(snapshot->catalog().techniquesForView(viewId));
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(err);
                 return Result<QVector<ViewTechnique>>::Failure(err);
             }
@@ -821,10 +850,9 @@ namespace Etrek::ScanProtocol::Repository
         )");
             q.addBindValue(viewId);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
-                QSqlDatabase::removeDatabase(cx);
                 return Result<QVector<ViewTechnique>>::Failure(err);
             }
 
@@ -838,7 +866,6 @@ namespace Etrek::ScanProtocol::Repository
                 rows.push_back(std::move(vt));
             }
         }
-        QSqlDatabase::removeDatabase(cx);
         return Result<QVector<ViewTechnique>>::Success(rows);
     }
 
@@ -846,11 +873,11 @@ namespace Etrek::ScanProtocol::Repository
         int viewId, int techniqueParameterId, quint8 seq,
         TechniqueParameterRole role, bool isActive) const
     {
-        const QString cx = "vt_upsert_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open())
-                return Result<void>::Failure(translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text()));
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen())
+                return Result<void>::Failure(translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError()));
 
             // UPDATE by PK (view_id, seq)
             QSqlQuery upd(db);
@@ -865,10 +892,9 @@ namespace Etrek::ScanProtocol::Repository
             upd.addBindValue(viewId);
             upd.addBindValue(seq);
 
-            if (!upd.exec()) {
+            if (!QueryStatistics::exec(upd)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(upd.lastError().text());
                 logger->LogError(err);
-                QSqlDatabase::removeDatabase(cx);
                 return Result<void>::Failure(err);
             }
 
@@ -886,87 +912,83 @@ namespace Etrek::ScanProtocol::Repository
                 ins.addBindValue(ScanProtocolUtil::roleToDbString(role));
                 ins.addBindValue(boolToTiny(isActive));
 
-                if (!ins.exec()) {
+                if (!QueryStatistics::exec(ins)) {
                     const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(ins.lastError().text());
                     logger->LogError(err);
-                    QSqlDatabase::removeDatabase(cx);
                     return Result<void>::Failure(err);
                 }
             }
         }
-        QSqlDatabase::removeDatabase(cx);
+        m_snapshots->markChanged();
         return Result<void>::Success({});
     }
 
     Result<void> ScanProtocolRepository::deleteViewTechnique(int viewId, quint8 seq) const
     {
-        const QString cx = "vt_delpk_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open())
-                return Result<void>::Failure(translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text()));
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen())
+                return Result<void>::Failure(translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError()));
 
             QSqlQuery q(db);
             q.prepare(R"(DELETE FROM view_techniques WHERE view_id = ? AND seq = ?)");
             q.addBindValue(viewId);
             q.addBindValue(seq);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
-                QSqlDatabase::removeDatabase(cx);
                 return Result<void>::Failure(err);
             }
         }
-        QSqlDatabase::removeDatabase(cx);
+        m_snapshots->markChanged();
         return Result<void>::Success({});
     }
 
     Result<void> ScanProtocolRepository::deleteViewTechniquesByRole(
         int viewId, TechniqueParameterRole role) const
     {
-        const QString cx = "vt_delrole_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open())
-                return Result<void>::Failure(translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text()));
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen())
+                return Result<void>::Failure(translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError()));
 
             QSqlQuery q(db);
             q.prepare(R"(DELETE FROM view_techniques WHERE view_id = ? AND role = ?)");
             q.addBindValue(viewId);
             q.addBindValue(ScanProtocolUtil::roleToDbString(role));
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
-                QSqlDatabase::removeDatabase(cx);
                 return Result<void>::Failure(err);
             }
         }
-        QSqlDatabase::removeDatabase(cx);
+        m_snapshots->markChanged();
         return Result<void>::Success({});
     }
 
     Result<void> ScanProtocolRepository::clearViewTechniques(int viewId) const
     {
-        const QString cx = "vt_clear_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open())
-                return Result<void>::Failure(translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text()));
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen())
+                return Result<void>::Failure(translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError()));
 
             QSqlQuery q(db);
             q.prepare(R"(DELETE FROM view_techniques WHERE view_id = ?)");
             q.addBindValue(viewId);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
-                QSqlDatabase::removeDatabase(cx);
                 return Result<void>::Failure(err);
             }
         }
-        QSqlDatabase::removeDatabase(cx);
+        m_snapshots->markChanged();
         return Result<void>::Success({});
     }
 
@@ -974,62 +996,41 @@ namespace Etrek::ScanProtocol::Repository
     Result<QVector<Procedure>> ScanProtocolRepository::getAllProcedures() const
     {
         QVector<Procedure> rows;
-        const QString cx = "proc_all_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(err);
                 return Result<QVector<Procedure>>::Failure(err);
             }
 
             QSqlQuery q(db);
-            q.prepare(R"(
-            SELECT
-                p.*,
-
-                ar.id            AS ar_id,
-                ar.name          AS ar_name,
-                ar.code_value    AS ar_code_value,
-                ar.coding_scheme AS ar_coding_scheme,
-                ar.code_meaning  AS ar_code_meaning,
-                ar.description   AS ar_description,
-                ar.display_order AS ar_display_order,
+            q.prepare(ALL_PROCEDURES_SQL);
 
-                bp.id            AS bp_id,
-                bp.name          AS bp_name,
-                bp.code_value    AS bp_code_value,
-                bp.coding_scheme AS bp_coding_scheme,
-                bp.description   AS bp_description,
-                bp.is_active     AS bp_is_active
-
-            FROM procedures p
-            LEFT JOIN anatomic_regions ar ON ar.id = p.anatomic_region_id
-            LEFT JOIN body_parts      bp ON bp.id = p.body_part_id
-            ORDER BY p.name, p.id
-        )");
-
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
-                QSqlDatabase::removeDatabase(cx);
                 return Result<QVector<Procedure>>::Failure(err);
             }
 
             while (q.next())
                 rows.push_back(mapProcedureRow(q));
         }
-        QSqlDatabase::removeDatabase(cx);
         return Result<QVector<Procedure>>::Success(rows);
     }
 
     Result<Procedure> ScanProtocolRepository::getProcedureById(int id) const
     {
-        const QString cx = "proc_id_" + QString::number(QRandomGenerator::global()->generate());
+        if (auto snapshot = currentSnapshot()) {
+            if (const Procedure* procedure = snapshot->findProcedure(id))
+                return Result<Procedure>::Success(*procedure);
+        }
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(err);
                 return Result<Procedure>::Failure(err);
             }
@@ -1062,28 +1063,26 @@ namespace Etrek::ScanProtocol::Repository
         )");
             q.addBindValue(id);
 
-            if (!q.exec() || !q.next()) {
+            if (!QueryStatistics::exec(q) || !q.next()) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG)
                     .arg(q.lastError().text().isEmpty() ? "not found" : q.lastError().text());
                 logger->LogError(err);
-                QSqlDatabase::removeDatabase(cx);
                 return Result<Procedure>::Failure(err);
             }
 
             Procedure p = mapProcedureRow(q);
-            QSqlDatabase::removeDatabase(cx);
             return Result<Procedure>::Success(p);
         }
     }
 
     Result<int> ScanProtocolRepository::createProcedure(const Procedure& p) const
     {
-        const QString cx = "proc_ins_" + QString::number(QRandomGenerator::global()->generate());
         int newId = -1;
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open())
-                return Result<int>::Failure(translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text()));
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen())
+                return Result<int>::Failure(translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError()));
 
             QSqlQuery ins(db);
             ins.prepare(R"(
@@ -1107,16 +1106,15 @@ namespace Etrek::ScanProtocol::Repository
             ins.addBindValue(p.BodyPart.has_value() ? QVariant(p.BodyPart->Id) : QVariant(QVariant::Int));
             ins.addBindValue(boolToTiny(p.IsActive));
 
-            if (!ins.exec()) {
+            if (!QueryStatistics::exec(ins)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(ins.lastError().text());
                 logger->LogError(err);
-                QSqlDatabase::removeDatabase(cx);
                 return Result<int>::Failure(err);
             }
 
             newId = ins.lastInsertId().toInt();
         }
-        QSqlDatabase::removeDatabase(cx);
+        m_snapshots->markChanged();
         return Result<int>::Success(newId);
     }
 
@@ -1125,11 +1123,11 @@ namespace Etrek::ScanProtocol::Repository
         if (p.Id <= 0)
             return Result<void>::Failure("updateProcedure requires valid p.Id");
 
-        const QString cx = "proc_upd_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open())
-                return Result<void>::Failure(translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text()));
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen())
+                return Result<void>::Failure(translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError()));
 
             QSqlQuery q(db);
             q.prepare(R"(
@@ -1160,24 +1158,23 @@ namespace Etrek::ScanProtocol::Repository
             q.addBindValue(boolToTiny(p.IsActive));
             q.addBindValue(p.Id);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
-                QSqlDatabase::removeDatabase(cx);
                 return Result<void>::Failure(err);
             }
         }
-        QSqlDatabase::removeDatabase(cx);
+        m_snapshots->markChanged();
         return Result<void>::Success({});
     }
 
     Result<void> ScanProtocolRepository::deleteProcedure(int procedureId, bool hard) const
     {
-        const QString cx = "proc_del_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open())
-                return Result<void>::Failure(translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text()));
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen())
+                return Result<void>::Failure(translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError()));
 
             QSqlQuery q(db);
             if (hard) {
@@ -1190,25 +1187,24 @@ namespace Etrek::ScanProtocol::Repository
                 q.addBindValue(procedureId);
             }
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
-                QSqlDatabase::removeDatabase(cx);
                 return Result<void>::Failure(err);
             }
         }
-        QSqlDatabase::removeDatabase(cx);
+        m_snapshots->markChanged();
         return Result<void>::Success({});
     }
 
     Result<QVector<Procedure>> ScanProtocolRepository::getProceduresByRegion(int regionId) const
     {
         QVector<Procedure> rows;
-        const QString cx = "proc_by_region_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(err);
                 return Result<QVector<Procedure>>::Failure(err);
             }
@@ -1241,26 +1237,24 @@ namespace Etrek::ScanProtocol::Repository
         )");
             q.addBindValue(regionId);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
-                QSqlDatabase::removeDatabase(cx);
                 return Result<QVector<Procedure>>::Failure(err);
             }
             while (q.next()) rows.push_back(mapProcedureRow(q));
         }
-        QSqlDatabase::removeDatabase(cx);
         return Result<QVector<Procedure>>::Success(rows);
     }
 
     Result<QVector<Procedure>> ScanProtocolRepository::getProceduresByBodyPart(int bodyPartId) const
     {
         QVector<Procedure> rows;
-        const QString cx = "proc_by_bp_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(err);
                 return Result<QVector<Procedure>>::Failure(err);
             }
@@ -1293,26 +1287,24 @@ namespace Etrek::ScanProtocol::Repository
         )");
             q.addBindValue(bodyPartId);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
-                QSqlDatabase::removeDatabase(cx);
                 return Result<QVector<Procedure>>::Failure(err);
             }
             while (q.next()) rows.push_back(mapProcedureRow(q));
         }
-        QSqlDatabase::removeDatabase(cx);
         return Result<QVector<Procedure>>::Success(rows);
     }
 
     Result<QVector<ProcedureView>> ScanProtocolRepository::getProcedureViews(int procedureId) const
     {
         QVector<ProcedureView> rows;
-        const QString cx = "pv_all_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(err);
                 return Result<QVector<ProcedureView>>::Failure(err);
             }
@@ -1321,10 +1313,9 @@ namespace Etrek::ScanProtocol::Repository
             q.prepare(R"(SELECT procedure_id, view_id FROM procedure_views WHERE procedure_id = ? ORDER BY view_id)");
             q.addBindValue(procedureId);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
-                QSqlDatabase::removeDatabase(cx);
                 return Result<QVector<ProcedureView>>::Failure(err);
             }
 
@@ -1335,18 +1326,21 @@ namespace Etrek::ScanProtocol::Repository
                 rows.push_back(std::move(pv));
             }
         }
-        QSqlDatabase::removeDatabase(cx);
         return Result<QVector<ProcedureView>>::Success(rows);
     }
 
     Result<QVector<View>> ScanProtocolRepository::getViewsForProcedure(int procedureId) const
     {
         QVector<View> rows;
-        const QString cx = "pv_views_" + QString::number(QRandomGenerator::global()->generate());
+        if (auto snapshot = currentSnapshot()) {
+            if (const Procedure* procedure = snapshot->findProcedure(procedureId))
+                return Result<QVector<View>>::Success(procedure->Views);
+        }
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open()) {
-                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(err);
                 return Result<QVector<View>>::Failure(err);
             }
@@ -1367,27 +1361,25 @@ namespace Etrek::ScanProtocol::Repository
         )");
             q.addBindValue(procedureId);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
-                QSqlDatabase::removeDatabase(cx);
                 return Result<QVector<View>>::Failure(err);
             }
 
             while (q.next())
                 rows.push_back(mapViewRow(q));
         }
-        QSqlDatabase::removeDatabase(cx);
         return Result<QVector<View>>::Success(rows);
     }
 
     Result<void> ScanProtocolRepository::addProcedureView(int procedureId, int viewId) const
     {
-        const QString cx = "pv_add_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open())
-                return Result<void>::Failure(translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text()));
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen())
+                return Result<void>::Failure(translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError()));
 
             QSqlQuery q(db);
             // MySQL upsert; no-op if already exists (PK: procedure_id, view_id)
@@ -1399,65 +1391,224 @@ namespace Etrek::ScanProtocol::Repository
             q.addBindValue(procedureId);
             q.addBindValue(viewId);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
-                QSqlDatabase::removeDatabase(cx);
                 return Result<void>::Failure(err);
             }
         }
-        QSqlDatabase::removeDatabase(cx);
+        m_snapshots->markChanged();
         return Result<void>::Success({});
     }
 
     Result<void> ScanProtocolRepository::removeProcedureView(int procedureId, int viewId) const
     {
-        const QString cx = "pv_del_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open())
-                return Result<void>::Failure(translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text()));
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen())
+                return Result<void>::Failure(translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError()));
 
             QSqlQuery q(db);
             q.prepare(R"(DELETE FROM procedure_views WHERE procedure_id = ? AND view_id = ?)");
             q.addBindValue(procedureId);
             q.addBindValue(viewId);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
-                QSqlDatabase::removeDatabase(cx);
                 return Result<void>::Failure(err);
             }
         }
-        QSqlDatabase::removeDatabase(cx);
+        m_snapshots->markChanged();
         return Result<void>::Success({});
     }
 
     Result<void> ScanProtocolRepository::clearProcedureViews(int procedureId) const
     {
-        const QString cx = "pv_clear_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(cx);
-            if (!db.open())
-                return Result<void>::Failure(translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text()));
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen())
+                return Result<void>::Failure(translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError()));
 
             QSqlQuery q(db);
             q.prepare(R"(DELETE FROM procedure_views WHERE procedure_id = ?)");
             q.addBindValue(procedureId);
 
-            if (!q.exec()) {
+            if (!QueryStatistics::exec(q)) {
                 const auto err = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
                 logger->LogError(err);
-                QSqlDatabase::removeDatabase(cx);
                 return Result<void>::Failure(err);
             }
         }
-        QSqlDatabase::removeDatabase(cx);
+        m_snapshots->markChanged();
         return Result<void>::Success({});
     }
 
+    // --------------------------------- Catalog -----------------------------------
+
+    Result<ScanProtocolCatalog> ScanProtocolRepository::loadCatalog() const
+    {
+        ScanProtocolCatalog catalog;
+        {
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                const auto err = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
+                logger->LogError(err);
+                return Result<ScanProtocolCatalog>::Failure(err);
+            }
+
+            // One read transaction so all tables come from the same snapshot
+            lease.transaction();
 
+            QSqlQuery q(db);
+            q.setForwardOnly(true);
+            QString error;
+            auto run = [&](const char* sql) {
+                if (QueryStatistics::exec(q, sql))
+                    return true;
+                error = translator->getCriticalMessage(QUERY_FAILED_ERROR_MSG).arg(q.lastError().text());
+                logger->LogError(error);
+                lease.rollback();
+                return false;
+            };
+            auto failure = [&]() { return Result<ScanProtocolCatalog>::Failure(error); };
+
+            if (!run(ALL_VIEWS_SQL))
+                return failure();
+            while (q.next())
+                catalog.Views.push_back(mapViewRow(q));
+
+            if (!run(ALL_TECHNIQUE_PARAMETERS_SQL))
+                return failure();
+            while (q.next())
+                catalog.TechniqueParameters.push_back(mapTechniqueParameterRow(q));
+
+            if (!run(R"(
+                SELECT view_id, technique_parameter_id, seq, role, is_active
+                FROM view_techniques
+                ORDER BY view_id, seq
+            )"))
+                return failure();
+            while (q.next()) {
+                ViewTechnique vt;
+                vt.view_id = q.value(0).toInt();
+                vt.technique_parameter_id = q.value(1).toInt();
+                vt.seq = static_cast<quint8>(q.value(2).toUInt());
+                vt.role = ScanProtocolUtil::roleFromDbString(q.value(3).toString());
+                vt.IsActive = q.value(4).toBool();
+                catalog.ViewTechniques[vt.view_id].push_back(vt);
+            }
+
+            if (!run(R"(
+                SELECT id, position_name, description, create_date, update_date
+                FROM positioners
+                ORDER BY position_name
+            )"))
+                return failure();
+            while (q.next()) {
+                Positioner positioner;
+                positioner.Id = q.value(0).toInt();
+                positioner.PositionName = q.value(1).toString();
+                positioner.Description = q.value(2).toString();
+                positioner.CreateDate = q.value(3).toDateTime();
+                positioner.UpdateDate = q.value(4).toDateTime();
+                catalog.Positioners.push_back(std::move(positioner));
+            }
+
+            if (!run(R"(
+                SELECT id, positioner_id, role, motion_code, step_order
+                FROM positioner_steps
+                ORDER BY positioner_id, step_order, id
+            )"))
+                return failure();
+            while (q.next()) {
+                PositionerStep step;
+                step.Id = q.value(0).toInt();
+                step.PositionerId = q.value(1).toInt();
+                step.Role = q.value(2).toString();
+                step.MotionCode = q.value(3).toString();
+                step.StepOrder = q.value(4).toInt();
+                catalog.PositionerSteps[step.PositionerId].push_back(std::move(step));
+            }
 
+            if (!run(ALL_PROCEDURES_SQL))
+                return failure();
+            while (q.next())
+                catalog.Procedures.push_back(mapProcedureRow(q));
+
+            // Procedure -> view links, resolved against the views loaded above
+            QHash<int, QVector<int>> viewIdsByProcedure;
+            if (!run("SELECT procedure_id, view_id FROM procedure_views"))
+                return failure();
+            while (q.next())
+                viewIdsByProcedure[q.value(0).toInt()].push_back(q.value(1).toInt());
+
+            lease.commit();
+
+            catalog.reindex();
+
+            for (Procedure& procedure : catalog.Procedures) {
+                const QVector<int> viewIds = viewIdsByProcedure.value(procedure.Id);
+                procedure.Views.reserve(viewIds.size());
+                for (int viewId : viewIds) {
+                    if (const View* view = catalog.findView(viewId))
+                        procedure.Views.push_back(*view);
+                }
+                // Same order as getViewsForProcedure() (name under the case-insensitive collation, then id)
+                std::sort(procedure.Views.begin(), procedure.Views.end(), [](const View& a, const View& b) {
+                    const int byName = a.Name.compare(b.Name, Qt::CaseInsensitive);
+                    return byName != 0 ? byName < 0 : a.Id < b.Id;
+                });
+            }
+        }
+        return Result<ScanProtocolCatalog>::Success(catalog);
+    }
+
+    Result<std::shared_ptr<const ScanProtocolSnapshot>> ScanProtocolRepository::getCatalogSnapshot() const
+    {
+        auto snapshot = m_snapshots->snapshot();
+        if (snapshot && snapshot->version() == m_snapshots->version())
+            return Result<std::shared_ptr<const ScanProtocolSnapshot>>::Success(snapshot);
+
+        return refreshCatalogSnapshot();
+    }
+
+    void ScanProtocolRepository::refreshCatalogSnapshotInBackground() const
+    {
+        if (!m_snapshots->beginRefresh())
+            return;
+
+        // The load gets a repository of its own, so it does not depend on this one staying alive
+        auto setting = m_connectionSetting;
+        auto store = m_snapshots;
+        QThreadPool::globalInstance()->start([setting, store]() {
+            ScanProtocolRepository(setting).refreshCatalogSnapshot();
+            store->endRefresh();
+        });
+    }
+
+    std::shared_ptr<const ScanProtocolSnapshot> ScanProtocolRepository::currentSnapshot() const
+    {
+        // A stale snapshot is never served; the read goes to the database until a reload publishes
+        auto snapshot = m_snapshots->snapshot();
+        return snapshot && snapshot->version() == m_snapshots->version() ? snapshot : nullptr;
+    }
+
+    Result<std::shared_ptr<const ScanProtocolSnapshot>> ScanProtocolRepository::refreshCatalogSnapshot() const
+    {
+        // Read the version before loading; an edit during the load makes this snapshot stale
+        const quint64 version = m_snapshots->version();
+
+        auto catalog = loadCatalog();
+        if (!catalog.isSuccess)
+            return Result<std::shared_ptr<const ScanProtocolSnapshot>>::Failure(catalog.message);
+
+        auto snapshot = std::make_shared<const ScanProtocolSnapshot>(std::move(catalog.value), version);
+        m_snapshots->publish(snapshot);
+        return Result<std::shared_ptr<const ScanProtocolSnapshot>>::Success(snapshot);
+    }
 
 }
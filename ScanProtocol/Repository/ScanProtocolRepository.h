@@ -18,6 +18,8 @@
 
 #include "Procedure.h"
 #include "ProcedureView.h"
+#include "ScanProtocolCatalog.h"
+#include "ScanProtocolSnapshot.h"
 
 namespace Etrek::ScanProtocol::Repository {
 
@@ -78,17 +80,37 @@ namespace Etrek::ScanProtocol::Repository {
         Etrek::Specification::Result<void> removeProcedureView(int procedureId, int viewId) const;     // delete one row
         Etrek::Specification::Result<void> clearProcedureViews(int procedureId) const;                 // delete all rows
 
+        // ------------------------------- Catalog -------------------------------------
+        // Whole protocol tree (procedures -> views -> view techniques -> technique parameters,
+        // positioners -> steps) in a fixed number of set-based queries on one connection.
+        Etrek::Specification::Result<Etrek::ScanProtocol::Data::Entity::ScanProtocolCatalog> loadCatalog() const;
+
+        // Shared immutable snapshot of the catalog for hot read paths (exam workflow). Returns the
+        // published snapshot when it is current, otherwise loads and publishes a new one.
+        Etrek::Specification::Result<std::shared_ptr<const ScanProtocolSnapshot>> getCatalogSnapshot() const;
+
+        // Loads the catalog and swaps it in as the new snapshot version, on the calling thread.
+        // Every write method above marks the published snapshot stale.
+        Etrek::Specification::Result<std::shared_ptr<const ScanProtocolSnapshot>> refreshCatalogSnapshot() const;
+
+        // Same load on the global thread pool; does nothing while a load is running. Call once
+        // after a batch of edits made on the GUI thread.
+        void refreshCatalogSnapshotInBackground() const;
+
 
 
         ~ScanProtocolRepository();
 
     private:
-        QSqlDatabase createConnection(const QString& connectionName) const;
+        // The published snapshot if it is current, else nullptr. getAllViews(), getAllTechniqueParameters(),
+        // getViewById(), getViewsByBodyPart(), getViewTechniques(), getProcedureById() and
+        // getViewsForProcedure() read from it and only query the database without one.
+        std::shared_ptr<const ScanProtocolSnapshot> currentSnapshot() const;
 
-    private:
         std::shared_ptr<Etrek::Core::Data::Model::DatabaseConnectionSetting> m_connectionSetting;
         Etrek::Core::Globalization::TranslationProvider* translator;
         std::shared_ptr<Etrek::Core::Log::AppLogger> logger;
+        std::shared_ptr<ScanProtocolSnapshotStore> m_snapshots;
     };
 
 } // namespace Etrek::ScanProtocol::Repository
@@ -0,0 +1,105 @@
+#include "ScanProtocolSnapshot.h"
+#include "PerConnectionRegistry.h"
+
+namespace Etrek::ScanProtocol::Repository {
+
+    using Etrek::Core::Data::Model::DatabaseConnectionSetting;
+    using Etrek::Core::Repository::PerConnectionRegistry;
+    using namespace Etrek::ScanProtocol::Data::Entity;
+
+    // ------------------------------- Snapshot ------------------------------------
+
+    ScanProtocolSnapshot::ScanProtocolSnapshot(ScanProtocolCatalog catalog, quint64 version)
+        : m_catalog(std::move(catalog))
+        , m_version(version)
+    {
+        m_catalog.reindex();
+
+        m_procedureIndex.reserve(m_catalog.Procedures.size());
+        for (int i = 0; i < m_catalog.Procedures.size(); ++i)
+            m_procedureIndex.insert(m_catalog.Procedures[i].Id, i);
+
+        // Views are ordered by body part and name, so each list keeps the name order
+        for (int i = 0; i < m_catalog.Views.size(); ++i)
+            m_viewsByBodyPart[m_catalog.Views[i].BodyPart.Id].push_back(i);
+    }
+
+    const Procedure* ScanProtocolSnapshot::findProcedure(int procedureId) const
+    {
+        const auto it = m_procedureIndex.constFind(procedureId);
+        return it == m_procedureIndex.constEnd() ? nullptr : &m_catalog.Procedures[it.value()];
+    }
+
+    const View* ScanProtocolSnapshot::findView(int viewId) const
+    {
+        return m_catalog.findView(viewId);
+    }
+
+    QVector<const View*> ScanProtocolSnapshot::viewsForBodyPart(int bodyPartId) const
+    {
+        QVector<const View*> views;
+        const auto it = m_viewsByBodyPart.constFind(bodyPartId);
+        if (it == m_viewsByBodyPart.constEnd())
+            return views;
+
+        views.reserve(it.value().size());
+        for (int index : it.value())
+            views.push_back(&m_catalog.Views[index]);
+        return views;
+    }
+
+    const TechniqueParameter* ScanProtocolSnapshot::techniqueForView(int viewId, TechniqueParameterRole role) const
+    {
+        return m_catalog.techniqueForView(viewId, role);
+    }
+
+    // -------------------------------- Store --------------------------------------
+
+    std::shared_ptr<ScanProtocolSnapshotStore> ScanProtocolSnapshotStore::forDatabase(const DatabaseConnectionSetting& setting)
+    {
+        static PerConnectionRegistry<ScanProtocolSnapshotStore> registry;
+        return registry.instanceFor(setting, [] { return std::make_shared<ScanProtocolSnapshotStore>(); });
+    }
+
+    ScanProtocolSnapshotStore::ScanProtocolSnapshotStore() = default;
+
+    std::shared_ptr<const ScanProtocolSnapshot> ScanProtocolSnapshotStore::snapshot() const
+    {
+        return std::atomic_load(&m_snapshot);
+    }
+
+    quint64 ScanProtocolSnapshotStore::version() const
+    {
+        return m_version.load();
+    }
+
+    quint64 ScanProtocolSnapshotStore::markChanged()
+    {
+        return ++m_version;
+    }
+
+    bool ScanProtocolSnapshotStore::publish(std::shared_ptr<const ScanProtocolSnapshot> snapshot)
+    {
+        auto current = std::atomic_load(&m_snapshot);
+        for (;;) {
+            if (!snapshot || snapshot->version() != m_version.load())
+                return false;
+            if (current && current->version() >= snapshot->version())
+                return false;
+            if (std::atomic_compare_exchange_weak(&m_snapshot, &current, snapshot))
+                return true;
+        }
+    }
+
+    bool ScanProtocolSnapshotStore::beginRefresh()
+    {
+        bool expected = false;
+        return m_refreshing.compare_exchange_strong(expected, true);
+    }
+
+    void ScanProtocolSnapshotStore::endRefresh()
+    {
+        m_refreshing.store(false);
+    }
+
+} // namespace Etrek::ScanProtocol::Repository
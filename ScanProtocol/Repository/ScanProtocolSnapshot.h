@@ -0,0 +1,119 @@
+#ifndef SCANPROTOCOLSNAPSHOT_H
+#define SCANPROTOCOLSNAPSHOT_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include <memory>
+#include "DatabaseConnectionSetting.h"
+#include "ScanProtocolCatalog.h"
+
+namespace Etrek::ScanProtocol::Repository {
+
+    /**
+     * @class ScanProtocolSnapshot
+     * @brief Immutable scan protocol catalog at one version, with O(1) lookups.
+     *
+     * Built once from a loaded catalog and never modified afterwards, so any number of
+     * threads can read it without synchronization. Pointers returned by the lookups stay
+     * valid for as long as the snapshot is held.
+     */
+    class ScanProtocolSnapshot
+    {
+    public:
+        ScanProtocolSnapshot(Etrek::ScanProtocol::Data::Entity::ScanProtocolCatalog catalog, quint64 version);
+
+        ScanProtocolSnapshot(const ScanProtocolSnapshot&) = delete;
+        ScanProtocolSnapshot& operator=(const ScanProtocolSnapshot&) = delete;
+
+        /** @brief Edit version of the store the catalog was loaded at. */
+        quint64 version() const { return m_version; }
+
+        /** @brief The underlying catalog. */
+        const Etrek::ScanProtocol::Data::Entity::ScanProtocolCatalog& catalog() const { return m_catalog; }
+
+        /** @brief Returns the procedure with @p procedureId (views hydrated), or nullptr. */
+        const Etrek::ScanProtocol::Data::Entity::Procedure* findProcedure(int procedureId) const;
+
+        /** @brief Returns the view with @p viewId, or nullptr. */
+        const Etrek::ScanProtocol::Data::Entity::View* findView(int viewId) const;
+
+        /** @brief Returns the views of @p bodyPartId, ordered by name. */
+        QVector<const Etrek::ScanProtocol::Data::Entity::View*> viewsForBodyPart(int bodyPartId) const;
+
+        /** @brief Returns the technique parameter bound to @p viewId with @p role, or nullptr. */
+        const Etrek::ScanProtocol::Data::Entity::TechniqueParameter* techniqueForView(
+            int viewId, Etrek::ScanProtocol::TechniqueParameterRole role) const;
+
+    private:
+        Etrek::ScanProtocol::Data::Entity::ScanProtocolCatalog m_catalog;
+        quint64 m_version = 0;
+        QHash<int, int> m_procedureIndex;                 // procedure id -> index in Procedures
+        QHash<int, QVector<int>> m_viewsByBodyPart;       // body part id -> indexes in Views
+    };
+
+    /**
+     * @class ScanProtocolSnapshotStore
+     * @brief Process-wide holder of the current scan protocol snapshot, one per database.
+     *
+     * Readers take the current snapshot with a single atomic load and never block; a
+     * snapshot they hold stays valid even if it is replaced meanwhile.
+     *
+     * Every edit of the protocol tables bumps the store version. A snapshot is only
+     * published if it was loaded at the current version and is newer than the one it
+     * replaces, so a load racing with an edit can never put stale data back.
+     */
+    class ScanProtocolSnapshotStore
+    {
+    public:
+        /**
+         * @brief Returns the store shared by all repositories connected to the same database.
+         */
+        static std::shared_ptr<ScanProtocolSnapshotStore> forDatabase(const Etrek::Core::Data::Model::DatabaseConnectionSetting& setting);
+
+        ScanProtocolSnapshotStore();
+
+        ScanProtocolSnapshotStore(const ScanProtocolSnapshotStore&) = delete;
+        ScanProtocolSnapshotStore& operator=(const ScanProtocolSnapshotStore&) = delete;
+
+        /**
+         * @brief Returns the current snapshot, or nullptr before the first load. Lock-free.
+         */
+        std::shared_ptr<const ScanProtocolSnapshot> snapshot() const;
+
+        /**
+         * @brief Returns the current edit version; a snapshot with a lower version is stale.
+         */
+        quint64 version() const;
+
+        /**
+         * @brief Records that the protocol tables changed.
+         * @return The new version.
+         */
+        quint64 markChanged();
+
+        /**
+         * @brief Swaps in @p snapshot if it is current and newer than the published one.
+         * @return False if the snapshot was discarded.
+         */
+        bool publish(std::shared_ptr<const ScanProtocolSnapshot> snapshot);
+
+        /**
+         * @brief Claims the background reload of the snapshot.
+         * @return False if another reload is already running.
+         */
+        bool beginRefresh();
+
+        /** @brief Releases the claim taken by beginRefresh(). */
+        void endRefresh();
+
+    private:
+        std::shared_ptr<const ScanProtocolSnapshot> m_snapshot;
+        std::atomic<quint64> m_version{ 1 };
+        std::atomic<bool> m_refreshing{ false };
+    };
+
+} // namespace Etrek::ScanProtocol::Repository
+
+#endif // SCANPROTOCOLSNAPSHOT_H
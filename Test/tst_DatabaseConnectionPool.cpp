@@ -0,0 +1,79 @@
+#include <QObject>
+#include <QTest>
+#include <QThread>
+#include <QTemporaryDir>
+#include <QMetaObject>
+#include "DatabaseConnectionPool.h"
+#include "DatabaseConnectionSetting.h"
+
+using Etrek::Core::Repository::DatabaseConnectionPool;
+using Etrek::Core::Repository::ConnectionLease;
+using Etrek::Core::Data::Model::DatabaseConnectionSetting;
+using Etrek::Core::Data::Model::StorageBackend;
+
+// Checks slot accounting of the connection pool across threads on a SQLite file.
+class DatabaseConnectionPoolTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DatabaseConnectionPoolTest(QObject* parent = nullptr) : QObject(parent) {}
+
+private:
+    QTemporaryDir storeDir;
+    std::shared_ptr<DatabaseConnectionSetting> connectionSetting;
+    DatabaseConnectionPool::Options savedOptions;
+
+private slots:
+    void initTestCase() {
+        QVERIFY(storeDir.isValid());
+        connectionSetting = std::make_shared<DatabaseConnectionSetting>();
+        connectionSetting->setStorageBackend(StorageBackend::Sqlite);
+        connectionSetting->setDatabaseName(storeDir.filePath("pool.db"));
+
+        savedOptions = DatabaseConnectionPool::Instance().options();
+    }
+
+    void cleanupTestCase() {
+        DatabaseConnectionPool::Instance().setOptions(savedOptions);
+        DatabaseConnectionPool::Instance().shutdown();
+    }
+
+    void test_IdleConnectionOfOtherThreadIsReclaimed() {
+        auto options = savedOptions;
+        options.maxSize = 1;
+        options.acquireTimeoutMs = 500;
+        DatabaseConnectionPool::Instance().setOptions(options);
+
+        // The worker keeps running with its only connection idle in its bucket
+        QThread worker;
+        QObject context;
+        context.moveToThread(&worker);
+        worker.start();
+
+        bool workerAcquired = false;
+        QMetaObject::invokeMethod(&context, [this, &workerAcquired]() {
+            ConnectionLease lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+            workerAcquired = lease.isValid();
+        }, Qt::BlockingQueuedConnection);
+        QVERIFY(workerAcquired);
+
+        {
+            ConnectionLease lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+            QVERIFY2(lease.isValid(), qPrintable(lease.lastError()));
+        }
+
+        // The worker closes the connection it gave up and opens a new one
+        QMetaObject::invokeMethod(&context, [this, &workerAcquired]() {
+            ConnectionLease lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+            workerAcquired = lease.isValid();
+        }, Qt::BlockingQueuedConnection);
+        QVERIFY(workerAcquired);
+
+        worker.quit();
+        worker.wait();
+    }
+};
+
+QTEST_GUILESS_MAIN(DatabaseConnectionPoolTest)
+#include "tst_DatabaseConnectionPool.moc"
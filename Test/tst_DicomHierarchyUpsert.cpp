@@ -0,0 +1,268 @@
+#include <QObject>
+#include <QTest>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include "DatabaseConnectionPool.h"
+#include "DatabaseConnectionSetting.h"
+#include "DicomRepository.h"
+
+using Etrek::Core::Repository::DatabaseConnectionPool;
+using Etrek::Core::Data::Model::DatabaseConnectionSetting;
+using Etrek::Dicom::Repository::DicomRepository;
+using Etrek::Dicom::Data::Entity::Patient;
+using Etrek::Dicom::Data::Entity::Study;
+using Etrek::Dicom::Data::Entity::Series;
+using Etrek::Dicom::Data::Entity::StudyHierarchy;
+
+// Checks the patient, study and series upserts and the batched hierarchy
+// registration on MySQL. Scratch rows use the SCRATCH_PREFIX patient ids and UIDs and are
+// removed again in cleanup(). MySQL only: the SQLite store keeps no patients, studies or
+// series (see sqlite_store.sql); the DicomRepository statements it does run are covered on both
+// backends by tst_EntityStatusTransition and tst_WorklistRepository.
+class DicomHierarchyUpsertTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DicomHierarchyUpsertTest(QObject* parent = nullptr) : QObject(parent) {}
+
+private:
+    std::shared_ptr<DatabaseConnectionSetting> connectionSetting;
+    std::shared_ptr<DicomRepository> repository;
+
+    static constexpr const char* SCRATCH_PREFIX = "1.2.826.0.1.3680043.9.7777.19";
+
+    static QString scratch(const QString& suffix) {
+        return QString("%1.%2").arg(SCRATCH_PREFIX, suffix);
+    }
+
+    int count(const QString& table, const QString& where) {
+        auto lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+        QSqlQuery query(lease.database());
+        if (!query.exec(QString("SELECT COUNT(*) FROM %1 WHERE %2").arg(table, where)) || !query.next()) {
+            qWarning() << query.lastError().text();
+            return -1;
+        }
+        return query.value(0).toInt();
+    }
+
+    StudyHierarchy hierarchy(int index, int seriesCount) {
+        StudyHierarchy h;
+        h.PatientRecord.PatientId = scratch(QString("P%1").arg(index));
+        h.PatientRecord.PatientName = QString("Scratch^Patient%1").arg(index);
+        h.StudyRecord.StudyInstanceUID = scratch(QString("%1").arg(index));
+        h.StudyRecord.AccessionNumber = QString("ACC%1").arg(index);
+        for (int i = 0; i < seriesCount; ++i) {
+            Series series;
+            series.SeriesInstanceUID = scratch(QString("%1.%2").arg(index).arg(i + 1));
+            series.SeriesNumber = i + 1;
+            series.Modality = "DX";
+            h.SeriesRecords.push_back(series);
+        }
+        return h;
+    }
+
+private slots:
+    void initTestCase() {
+        connectionSetting = std::make_shared<DatabaseConnectionSetting>();
+        connectionSetting->setHostName("localhost");
+        connectionSetting->setDatabaseName("etrekdb");
+        connectionSetting->setEtrektUserName("root");
+        connectionSetting->setPassword("Trt123Tst!)");
+        connectionSetting->setPort(3306);
+        connectionSetting->setIsPasswordEncrypted(false);
+
+        repository = std::make_shared<DicomRepository>(connectionSetting);
+    }
+
+    void cleanup() {
+        auto lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+        QSqlQuery query(lease.database());
+        // series follow studies by ON DELETE CASCADE
+        query.exec(QString("DELETE FROM studies WHERE study_instance_uid LIKE '%1.%'").arg(SCRATCH_PREFIX));
+        query.exec(QString("DELETE FROM patients WHERE patient_id LIKE '%1.%'").arg(SCRATCH_PREFIX));
+    }
+
+    void test_UpsertPatientKeepsId() {
+        Patient patient;
+        patient.PatientId = scratch("P1");
+        patient.PatientName = "Scratch^First";
+        auto inserted = repository->upsertPatient(patient);
+        QVERIFY2(inserted.isSuccess, qPrintable(inserted.message));
+        const int id = patient.Id;
+        QVERIFY(id >= 0);
+
+        // No issuer: matched by the NULL-folding issuer key
+        Patient again;
+        again.PatientId = scratch("P1");
+        again.PatientName = "Scratch^Renamed";
+        auto updated = repository->upsertPatient(again);
+        QVERIFY2(updated.isSuccess, qPrintable(updated.message));
+        QCOMPARE(again.Id, id);
+
+        // Unchanged values still report the id
+        auto unchanged = repository->upsertPatient(again);
+        QVERIFY2(unchanged.isSuccess, qPrintable(unchanged.message));
+        QCOMPARE(again.Id, id);
+
+        auto found = repository->findPatientByIdAndIssuer(scratch("P1"), QString());
+        QVERIFY(found.isSuccess && found.value.has_value());
+        QCOMPARE(found.value->Id, id);
+        QCOMPARE(found.value->PatientName, QString("Scratch^Renamed"));
+
+        // Same patient id from another issuer is another patient
+        Patient otherIssuer;
+        otherIssuer.PatientId = scratch("P1");
+        otherIssuer.IssuerOfPatientId = "OTHER";
+        QVERIFY(repository->upsertPatient(otherIssuer).isSuccess);
+        QVERIFY(otherIssuer.Id != id);
+        QCOMPARE(count("patients", QString("patient_id = '%1'").arg(scratch("P1"))), 2);
+    }
+
+    void test_UpsertStudyAndSeriesKeepIds() {
+        Patient patient;
+        patient.PatientId = scratch("P2");
+        QVERIFY(repository->upsertPatient(patient).isSuccess);
+
+        Study study;
+        study.PatientId = patient.Id;
+        study.StudyInstanceUID = scratch("2");
+        QVERIFY(repository->upsertStudy(study).isSuccess);
+        const int studyId = study.Id;
+
+        study.Id = -1;
+        study.StudyDescription = "Chest PA";
+        auto updated = repository->upsertStudy(study);
+        QVERIFY2(updated.isSuccess, qPrintable(updated.message));
+        QCOMPARE(study.Id, studyId);
+
+        Series series;
+        series.StudyId = studyId;
+        series.SeriesInstanceUID = scratch("2.1");
+        QVERIFY(repository->upsertSeries(series).isSuccess);
+        const int seriesId = series.Id;
+        series.Id = -1;
+        series.ViewPosition = "PA";
+        QVERIFY(repository->upsertSeries(series).isSuccess);
+        QCOMPARE(series.Id, seriesId);
+
+        QCOMPARE(count("studies", QString("study_instance_uid = '%1'").arg(scratch("2"))), 1);
+        QCOMPARE(count("series", QString("series_instance_uid = '%1' AND view_position = 'PA'").arg(scratch("2.1"))), 1);
+
+        Study orphan;
+        orphan.StudyInstanceUID = scratch("2.99");
+        QVERIFY(!repository->upsertStudy(orphan).isSuccess);
+    }
+
+    void test_StudyDoesNotMoveToAnotherPatient() {
+        Patient owner, other;
+        owner.PatientId = scratch("P4");
+        other.PatientId = scratch("P5");
+        QVERIFY(repository->upsertPatient(owner).isSuccess);
+        QVERIFY(repository->upsertPatient(other).isSuccess);
+
+        Study study;
+        study.PatientId = owner.Id;
+        study.StudyInstanceUID = scratch("4");
+        QVERIFY(repository->upsertStudy(study).isSuccess);
+
+        Study moved = study;
+        moved.PatientId = other.Id;
+        QVERIFY(!repository->upsertStudy(moved).isSuccess);
+        QCOMPARE(count("studies", QString("study_instance_uid = '%1' AND patient_id = %2").arg(scratch("4")).arg(owner.Id)), 1);
+
+        Series series;
+        series.StudyId = study.Id;
+        series.SeriesInstanceUID = scratch("4.1");
+        QVERIFY(repository->upsertSeries(series).isSuccess);
+
+        Study otherStudy;
+        otherStudy.PatientId = other.Id;
+        otherStudy.StudyInstanceUID = scratch("5");
+        QVERIFY(repository->upsertStudy(otherStudy).isSuccess);
+        Series movedSeries = series;
+        movedSeries.StudyId = otherStudy.Id;
+        QVERIFY(!repository->upsertSeries(movedSeries).isSuccess);
+        QCOMPARE(count("series", QString("series_instance_uid = '%1' AND study_id = %2").arg(scratch("4.1")).arg(study.Id)), 1);
+    }
+
+    void test_ConcurrentUpsertsWriteOneRow() {
+        constexpr int THREADS = 8;
+        std::vector<int> ids(THREADS, -1);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; ++t) {
+            threads.emplace_back([this, &ids, t]() {
+                Patient patient;
+                patient.PatientId = scratch("P3");
+                patient.PatientName = QString("Scratch^Thread%1").arg(t);
+                if (repository->upsertPatient(patient).isSuccess)
+                    ids[t] = patient.Id;
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+
+        // InnoDB may pick a deadlock victim among upserts of one key; whoever succeeded got the same row
+        const int expected = *std::max_element(ids.begin(), ids.end());
+        QVERIFY(expected >= 0);
+        for (int id : ids)
+            QVERIFY(id == expected || id == -1);
+        QCOMPARE(count("patients", QString("patient_id = '%1'").arg(scratch("P3"))), 1);
+    }
+
+    void test_RegisterHierarchies() {
+        constexpr int HIERARCHIES = 20;
+        constexpr int SERIES_PER_STUDY = 3;
+
+        QVector<StudyHierarchy> hierarchies;
+        for (int i = 0; i < HIERARCHIES; ++i)
+            hierarchies.push_back(hierarchy(100 + i, SERIES_PER_STUDY));
+
+        QElapsedTimer timer;
+        timer.start();
+        auto registered = repository->registerHierarchies(hierarchies);
+        QVERIFY2(registered.isSuccess, qPrintable(registered.message));
+        qDebug().noquote() << QString("registered %1 hierarchies in %2 ms").arg(HIERARCHIES).arg(timer.elapsed());
+        QCOMPARE(registered.value, HIERARCHIES * (2 + SERIES_PER_STUDY));
+
+        for (const StudyHierarchy& h : hierarchies) {
+            QVERIFY(h.PatientRecord.IsValid());
+            QCOMPARE(h.StudyRecord.PatientId, h.PatientRecord.Id);
+            for (const Series& series : h.SeriesRecords)
+                QCOMPARE(series.StudyId, h.StudyRecord.Id);
+        }
+
+        // Registering again updates the same rows
+        QVector<StudyHierarchy> again;
+        for (int i = 0; i < HIERARCHIES; ++i)
+            again.push_back(hierarchy(100 + i, SERIES_PER_STUDY));
+        QVERIFY(repository->registerHierarchies(again).isSuccess);
+        for (int i = 0; i < HIERARCHIES; ++i) {
+            QCOMPARE(again[i].PatientRecord.Id, hierarchies[i].PatientRecord.Id);
+            QCOMPARE(again[i].StudyRecord.Id, hierarchies[i].StudyRecord.Id);
+            QCOMPARE(again[i].SeriesRecords.last().Id, hierarchies[i].SeriesRecords.last().Id);
+        }
+        QCOMPARE(count("series", QString("series_instance_uid LIKE '%1.%'").arg(SCRATCH_PREFIX)), HIERARCHIES * SERIES_PER_STUDY);
+    }
+
+    void test_FailedHierarchyRollsBackBatch() {
+        QVector<StudyHierarchy> hierarchies{ hierarchy(200, 1), hierarchy(201, 1) };
+        // Too long for series_instance_uid VARCHAR(64)
+        hierarchies[1].SeriesRecords[0].SeriesInstanceUID = scratch(QString(80, '9'));
+
+        auto registered = repository->registerHierarchies(hierarchies);
+        QVERIFY(!registered.isSuccess);
+        QVERIFY(!hierarchies[0].PatientRecord.IsValid());
+        QCOMPARE(count("studies", QString("study_instance_uid = '%1'").arg(scratch("200"))), 0);
+        QCOMPARE(count("patients", QString("patient_id = '%1'").arg(scratch("P200"))), 0);
+    }
+};
+
+QTEST_APPLESS_MAIN(DicomHierarchyUpsertTest)
+#include "tst_DicomHierarchyUpsert.moc"
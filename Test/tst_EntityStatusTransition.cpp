@@ -0,0 +1,182 @@
+#include <QObject>
+#include <QTest>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QTemporaryDir>
+#include "BulkInsertWriter.h"
+#include "DatabaseConnectionPool.h"
+#include "DatabaseSetupManager.h"
+#include "DatabaseConnectionSetting.h"
+#include "DicomRepository.h"
+
+using Etrek::Core::Repository::BulkInsertWriter;
+using Etrek::Core::Repository::DatabaseConnectionPool;
+using Etrek::Core::Repository::DatabaseSetupManager;
+using Etrek::Core::Data::Model::DatabaseConnectionSetting;
+using Etrek::Core::Data::Model::StorageBackend;
+using Etrek::Dicom::Repository::DicomRepository;
+using Etrek::Dicom::Data::Entity::EntityStatus;
+using Etrek::Dicom::Data::Entity::EntityType;
+using Etrek::Dicom::Data::Entity::WorkflowStatus;
+using Etrek::Dicom::Data::Entity::StatusTransitionSet;
+
+// Checks DicomRepository::transitionStatuses on a scratch exam: one study, a few series and
+// many images. entity_status has no foreign keys to the entity tables, so the scratch ids only
+// need to stay clear of real rows; they are removed again in cleanup(). Runs on MySQL and on a
+// fresh SQLite store.
+class EntityStatusTransitionTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit EntityStatusTransitionTest(QObject* parent = nullptr) : QObject(parent) {}
+
+private:
+    std::shared_ptr<DatabaseConnectionSetting> mysqlSetting;
+    std::shared_ptr<DatabaseConnectionSetting> sqliteSetting;
+    std::shared_ptr<DatabaseConnectionSetting> connectionSetting;  // backend of the current data row
+    std::unique_ptr<DicomRepository> repository;
+    QTemporaryDir storeDir;
+
+    static constexpr int SCRATCH_ID_BASE = 1900000000;
+    static constexpr int SERIES_COUNT = 4;
+    static constexpr int IMAGE_COUNT = 2000;
+
+    QVector<int> scratchIds(int count) const {
+        QVector<int> ids;
+        ids.reserve(count);
+        for (int i = 0; i < count; ++i)
+            ids.push_back(SCRATCH_ID_BASE + i);
+        return ids;
+    }
+
+    QVector<StatusTransitionSet> examTransition(WorkflowStatus status) const {
+        return {
+            { EntityType::IMAGE, scratchIds(IMAGE_COUNT), status, "exam transition test" },
+            { EntityType::SERIES, scratchIds(SERIES_COUNT), status, "exam transition test" },
+            { EntityType::STUDY, scratchIds(1), status, "exam transition test" },
+        };
+    }
+
+    int countRows(const QString& table) {
+        auto lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+        QSqlQuery query(lease.database());
+        if (!query.exec(QString("SELECT COUNT(*) FROM %1 WHERE entity_id >= %2").arg(table).arg(SCRATCH_ID_BASE)) || !query.next()) {
+            qWarning() << query.lastError().text();
+            return -1;
+        }
+        return query.value(0).toInt();
+    }
+
+private slots:
+    void initTestCase_data() {
+        QTest::addColumn<bool>("sqlite");
+        QTest::newRow("mysql") << false;
+        QTest::newRow("sqlite") << true;
+    }
+
+    void initTestCase() {
+        mysqlSetting = std::make_shared<DatabaseConnectionSetting>();
+        mysqlSetting->setHostName("localhost");
+        mysqlSetting->setDatabaseName("etrekdb");
+        mysqlSetting->setEtrektUserName("root");
+        mysqlSetting->setPassword("Trt123Tst!)");
+        mysqlSetting->setPort(3306);
+        mysqlSetting->setIsPasswordEncrypted(false);
+
+        QVERIFY(storeDir.isValid());
+        sqliteSetting = std::make_shared<DatabaseConnectionSetting>();
+        sqliteSetting->setStorageBackend(StorageBackend::Sqlite);
+        sqliteSetting->setDatabaseName(storeDir.filePath("etrek_store.db"));
+
+        auto setup = DatabaseSetupManager(sqliteSetting).initializeDatabase();
+        QVERIFY2(setup.isSuccess, qPrintable(setup.message));
+    }
+
+    void init() {
+        QFETCH_GLOBAL(bool, sqlite);
+        connectionSetting = sqlite ? sqliteSetting : mysqlSetting;
+        repository = std::make_unique<DicomRepository>(connectionSetting);
+    }
+
+    void cleanup() {
+        auto lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+        QSqlQuery query(lease.database());
+        // entity_current_status follows by ON DELETE CASCADE
+        query.exec(QString("DELETE FROM entity_status WHERE entity_id >= %1").arg(SCRATCH_ID_BASE));
+    }
+
+    void test_BatchWritesHistoryAndCurrentStatus() {
+        auto started = repository->transitionStatuses(examTransition(WorkflowStatus::IN_PROGRESS));
+        QVERIFY2(started.isSuccess, qPrintable(started.message));
+        QCOMPARE(started.value, IMAGE_COUNT + SERIES_COUNT + 1);
+
+        QElapsedTimer timer;
+        timer.start();
+        auto completed = repository->transitionStatuses(examTransition(WorkflowStatus::COMPLETED));
+        QVERIFY2(completed.isSuccess, qPrintable(completed.message));
+        qDebug().noquote() << QString("completed %1 entities in %2 ms").arg(completed.value).arg(timer.elapsed());
+
+        QCOMPARE(countRows("entity_status"), 2 * (IMAGE_COUNT + SERIES_COUNT + 1));
+        QCOMPARE(countRows("entity_current_status"), IMAGE_COUNT + SERIES_COUNT + 1);
+
+        auto study = repository->getCurrentStatus(EntityType::STUDY, SCRATCH_ID_BASE);
+        QVERIFY(study.isSuccess && study.value.has_value());
+        QCOMPARE(study.value->Status, WorkflowStatus::COMPLETED);
+        QCOMPARE(study.value->StatusReason, QString("exam transition test"));
+    }
+
+    void test_SameStatusIsSkipped() {
+        QVERIFY(repository->transitionStatuses(examTransition(WorkflowStatus::IN_PROGRESS)).isSuccess);
+
+        auto again = repository->transitionStatuses(examTransition(WorkflowStatus::IN_PROGRESS));
+        QVERIFY2(again.isSuccess, qPrintable(again.message));
+        QCOMPARE(again.value, 0);
+        QCOMPARE(countRows("entity_status"), IMAGE_COUNT + SERIES_COUNT + 1);
+    }
+
+    void test_DisallowedTransitionWritesNothing() {
+        QVERIFY(repository->transitionStatuses(examTransition(WorkflowStatus::IN_PROGRESS)).isSuccess);
+        QVERIFY(repository->transitionStatuses({ { EntityType::STUDY, scratchIds(1), WorkflowStatus::COMPLETED, {} } }).isSuccess);
+
+        // Images and series may go back to PENDING, the completed study may not; the whole batch fails
+        auto rejected = repository->transitionStatuses(examTransition(WorkflowStatus::PENDING));
+        QVERIFY(!rejected.isSuccess);
+
+        QCOMPARE(countRows("entity_status"), IMAGE_COUNT + SERIES_COUNT + 2);
+        auto image = repository->getCurrentStatus(EntityType::IMAGE, SCRATCH_ID_BASE);
+        QVERIFY(image.isSuccess && image.value.has_value());
+        QCOMPARE(image.value->Status, WorkflowStatus::IN_PROGRESS);
+    }
+
+    void test_OlderStatusDoesNotReplaceCurrent() {
+        const QVector<StatusTransitionSet> study{ { EntityType::STUDY, scratchIds(1), WorkflowStatus::IN_PROGRESS, {} } };
+        QVERIFY(repository->transitionStatuses(study).isSuccess);
+        QVERIFY(repository->transitionStatuses({ { EntityType::STUDY, scratchIds(1), WorkflowStatus::COMPLETED, {} } }).isSuccess);
+
+        auto lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+        QSqlQuery query(lease.database());
+        QVERIFY(query.exec(QString("SELECT MIN(id) FROM entity_status WHERE entity_type = 'STUDY' AND entity_id = %1").arg(SCRATCH_ID_BASE)));
+        QVERIFY(query.next());
+        const qint64 olderId = query.value(0).toLongLong();
+        query.finish();
+
+        // A writer that commits after the newer row, carrying the older one
+        BulkInsertWriter writer(lease, "entity_current_status",
+            { "entity_type", "entity_id", "status_id", "status", "priority", "assigned_to", "transitioned_at" });
+        writer.setUpdateOnDuplicate({ "status_id", "status", "priority", "assigned_to", "transitioned_at" }, "status_id");
+        writer.addRow({ "STUDY", SCRATCH_ID_BASE, olderId, "IN_PROGRESS", "NORMAL", QVariant(QVariant::Int), QDateTime::currentDateTime() });
+        QVERIFY2(writer.flush(), qPrintable(writer.lastError()));
+
+        auto current = repository->getCurrentStatus(EntityType::STUDY, SCRATCH_ID_BASE);
+        QVERIFY(current.isSuccess && current.value.has_value());
+        QCOMPARE(current.value->Status, WorkflowStatus::COMPLETED);
+        QVERIFY(current.value->Id > olderId);
+    }
+};
+
+QTEST_APPLESS_MAIN(EntityStatusTransitionTest)
+#include "tst_EntityStatusTransition.moc"
@@ -0,0 +1,220 @@
+#include <QObject>
+#include <QTest>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QTemporaryDir>
+#include "DatabaseConnectionPool.h"
+#include "DatabaseSetupManager.h"
+#include "DatabaseConnectionSetting.h"
+#include "LoggerProvider.h"
+#include "TranslationProvider.h"
+#include "WorklistRepository.h"
+#include "DicomRepository.h"
+
+using Etrek::Core::Repository::DatabaseConnectionPool;
+using Etrek::Core::Repository::DatabaseSetupManager;
+using Etrek::Core::Data::Model::DatabaseConnectionSetting;
+using Etrek::Core::Data::Model::StorageBackend;
+using Etrek::Core::Log::LoggerProvider;
+using Etrek::Core::Globalization::TranslationProvider;
+using Etrek::Worklist::Repository::WorklistRepository;
+using Etrek::Dicom::Repository::DicomRepository;
+using Etrek::Dicom::Data::Entity::EntityStatus;
+using Etrek::Dicom::Data::Entity::EntityType;
+using Etrek::Dicom::Data::Entity::WorkflowStatus;
+
+// Checks the chunked purges run by the maintenance scheduler on a fresh SQLite store, where
+// deleting by date cannot touch anyone else's rows.
+class MaintenancePurgeTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MaintenancePurgeTest(QObject* parent = nullptr) : QObject(parent) {}
+
+private:
+    std::shared_ptr<DatabaseConnectionSetting> connectionSetting;
+    QTemporaryDir storeDir;
+    QTemporaryDir logDir;
+
+    static constexpr int SCRATCH_TAG_ID = 990001;
+    static constexpr int OLD_ENTRIES = 250;
+    static constexpr int RECENT_ENTRIES = 5;
+    static constexpr int CHUNK_SIZE = 100;
+
+    int count(const QString& sql) {
+        auto lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+        QSqlQuery query(lease.database());
+        if (!query.exec(sql) || !query.next()) {
+            qWarning() << query.lastError().text();
+            return -1;
+        }
+        return query.value(0).toInt();
+    }
+
+    // Entries copied from MySQL have pending_sync 0; the others are not on MySQL yet
+    bool insertEntries(int entries, const QDateTime& createdAt, int pendingSync = 0) {
+        auto lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+        if (!lease.transaction())
+            return false;
+        for (int i = 0; i < entries; ++i) {
+            QSqlQuery& entry = lease.prepare("INSERT INTO mwl_entries (source, status, created_at, pending_sync) VALUES ('RIS', 'SCHEDULED', ?, ?)");
+            entry.addBindValue(createdAt.addSecs(i));
+            entry.addBindValue(pendingSync);
+            if (!entry.exec())
+                return false;
+            const QVariant entryId = entry.lastInsertId();
+
+            for (int tag = 0; tag < 2; ++tag) {
+                QSqlQuery& attribute = lease.prepare("INSERT INTO mwl_attributes (mwl_entry_id, dicom_tag_id, tag_value) VALUES (?, ?, ?)");
+                attribute.addBindValue(entryId);
+                attribute.addBindValue(SCRATCH_TAG_ID);
+                attribute.addBindValue(QString("value %1").arg(tag));
+                if (!attribute.exec())
+                    return false;
+            }
+        }
+        return lease.commit();
+    }
+
+private slots:
+    void initTestCase() {
+        QVERIFY(storeDir.isValid());
+        connectionSetting = std::make_shared<DatabaseConnectionSetting>();
+        connectionSetting->setStorageBackend(StorageBackend::Sqlite);
+        connectionSetting->setDatabaseName(storeDir.filePath("etrek_store.db"));
+
+        auto setup = DatabaseSetupManager(connectionSetting).initializeDatabase();
+        QVERIFY2(setup.isSuccess, qPrintable(setup.message));
+
+        auto lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+        QSqlQuery query(lease.database());
+        QVERIFY2(query.exec(QString("INSERT INTO dicom_tags (id, name, display_name, group_hex, element_hex, pgroup_hex, pelement_hex) "
+                                    "VALUES (%1, 'MaintenanceTestTag', 'Maintenance Test Tag', 0, 0, 0, 0)").arg(SCRATCH_TAG_ID)),
+                 qPrintable(query.lastError().text()));
+    }
+
+    void test_WorklistPurgeDeletesOldestInChunks() {
+        const QDateTime now = QDateTime::currentDateTime();
+        QVERIFY(insertEntries(OLD_ENTRIES, now.addDays(-40)));
+        QVERIFY(insertEntries(RECENT_ENTRIES, now.addDays(-1)));
+
+        WorklistRepository repository(connectionSetting);
+        const QDateTime cutoff = now.addDays(-30);
+
+        auto first = repository.purgeWorklistEntries(cutoff, CHUNK_SIZE);
+        QVERIFY2(first.isSuccess, qPrintable(first.message));
+        QCOMPARE(first.value, CHUNK_SIZE);
+        QCOMPARE(count("SELECT COUNT(*) FROM mwl_entries"), OLD_ENTRIES + RECENT_ENTRIES - CHUNK_SIZE);
+
+        QElapsedTimer timer;
+        timer.start();
+        int purged = first.value;
+        int chunks = 1;
+        for (;;) {
+            auto chunk = repository.purgeWorklistEntries(cutoff, CHUNK_SIZE);
+            QVERIFY2(chunk.isSuccess, qPrintable(chunk.message));
+            purged += chunk.value;
+            ++chunks;
+            if (chunk.value < CHUNK_SIZE)
+                break;
+        }
+        qDebug().noquote() << QString("purged %1 entries in %2 chunks, %3 ms").arg(purged).arg(chunks).arg(timer.elapsed());
+
+        QCOMPARE(purged, OLD_ENTRIES);
+        QCOMPARE(count("SELECT COUNT(*) FROM mwl_entries"), RECENT_ENTRIES);
+        QCOMPARE(count("SELECT COUNT(*) FROM mwl_attributes"), 2 * RECENT_ENTRIES);
+
+        // Nothing left to purge
+        auto empty = repository.purgeWorklistEntries(cutoff, CHUNK_SIZE);
+        QVERIFY(empty.isSuccess);
+        QCOMPARE(empty.value, 0);
+    }
+
+    void test_WorklistPurgeKeepsUnsyncedEntries() {
+        const QDateTime old = QDateTime::currentDateTime().addDays(-400);
+        QVERIFY(insertEntries(3, old, 1));
+        QVERIFY(insertEntries(2, old, 2));
+
+        WorklistRepository repository(connectionSetting);
+        auto purged = repository.purgeWorklistEntries(old.addDays(1), CHUNK_SIZE);
+        QVERIFY2(purged.isSuccess, qPrintable(purged.message));
+        QCOMPARE(purged.value, 0);
+        QCOMPARE(count("SELECT COUNT(*) FROM mwl_entries WHERE pending_sync <> 0"), 5);
+
+        auto lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+        QSqlQuery query(lease.database());
+        QVERIFY(query.exec("DELETE FROM mwl_entries WHERE pending_sync <> 0"));
+    }
+
+    void test_StatusHistoryPurgeKeepsCurrentStatus() {
+        constexpr int ENTITIES = 50;
+        const QDateTime now = QDateTime::currentDateTime();
+
+        DicomRepository repository(connectionSetting);
+        const WorkflowStatus steps[] = { WorkflowStatus::SCHEDULED, WorkflowStatus::IN_PROGRESS, WorkflowStatus::COMPLETED };
+        for (int entity = 1; entity <= ENTITIES; ++entity) {
+            for (int step = 0; step < 3; ++step) {
+                EntityStatus status;
+                status.Type = EntityType::STUDY;
+                status.EntityId = entity;
+                status.Status = steps[step];
+                status.TransitionedAt = now.addDays(-60 + 10 * step);
+                QVERIFY(repository.insertEntityStatus(status).isSuccess);
+            }
+        }
+
+        int purged = 0;
+        for (;;) {
+            auto chunk = repository.purgeStatusHistory(now.addDays(-30), 40);
+            QVERIFY2(chunk.isSuccess, qPrintable(chunk.message));
+            purged += chunk.value;
+            if (chunk.value < 40)
+                break;
+        }
+
+        // Two superseded rows per entity; the current one is kept although it is old as well
+        QCOMPARE(purged, 2 * ENTITIES);
+        QCOMPARE(count("SELECT COUNT(*) FROM entity_status"), ENTITIES);
+        QCOMPARE(count("SELECT COUNT(*) FROM entity_current_status"), ENTITIES);
+
+        auto current = repository.getCurrentStatus(EntityType::STUDY, 1);
+        QVERIFY(current.isSuccess && current.value.has_value());
+        QCOMPARE(current.value->Status, WorkflowStatus::COMPLETED);
+    }
+
+    void test_RotatedLogFilesAreDeleted() {
+        QVERIFY(logDir.isValid());
+        QVERIFY(LoggerProvider::Instance().InitializeFileLogger(logDir.path(), 1, 5, &TranslationProvider::Instance()).isSuccess);
+
+        const QDateTime now = QDateTime::currentDateTime();
+        const QStringList names = { "logs.log", "logs.1.log", "logs.2.log", "logs.3.log" };
+        for (int i = 0; i < names.size(); ++i) {
+            QFile file(logDir.filePath(names[i]));
+            QVERIFY(file.open(QIODevice::WriteOnly));
+            file.write("log line\n");
+            // The active file and logs.1.log are recent, the others are old
+            QVERIFY(file.setFileTime(i < 2 ? now : now.addDays(-100), QFileDevice::FileModificationTime));
+            file.close();
+        }
+        QFile oldActive(logDir.filePath("logs.log"));
+        QVERIFY(oldActive.open(QIODevice::Append));
+        QVERIFY(oldActive.setFileTime(now.addDays(-200), QFileDevice::FileModificationTime));
+        oldActive.close();
+
+        auto deleted = LoggerProvider::Instance().DeleteRotatedLogFiles(now.addDays(-90), 10);
+        QVERIFY(deleted.isSuccess);
+        QCOMPARE(deleted.value, 2);
+        QVERIFY(QFile::exists(logDir.filePath("logs.log")));
+        QVERIFY(QFile::exists(logDir.filePath("logs.1.log")));
+        QVERIFY(!QFile::exists(logDir.filePath("logs.2.log")));
+        QVERIFY(!QFile::exists(logDir.filePath("logs.3.log")));
+    }
+};
+
+QTEST_APPLESS_MAIN(MaintenancePurgeTest)
+#include "tst_MaintenancePurge.moc"
@@ -0,0 +1,211 @@
+#include <QObject>
+#include <QTest>
+#include <QDebug>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <algorithm>
+#include "DatabaseConnectionPool.h"
+#include "DatabaseConnectionSetting.h"
+#include "WorklistRepository.h"
+#include "WorklistEntry.h"
+#include "DicomTag.h"
+
+using Etrek::Core::Repository::DatabaseConnectionPool;
+using Etrek::Core::Data::Model::DatabaseConnectionSetting;
+using Etrek::Worklist::Repository::WorklistRepository;
+using namespace Etrek::Worklist::Data::Entity;
+
+// Checks how worklists received from several RIS connections are merged on MySQL: one row per
+// identity, attributed to the connection it came from first and cancelled by a reconcile only
+// once no connection returns it any more. Scratch entries are marked by the
+// SCRATCH_CONNECTION prefix of their source connection and removed again in cleanup().
+class MultiRisIngestTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MultiRisIngestTest(QObject* parent = nullptr) : QObject(parent) {}
+
+private:
+    std::shared_ptr<DatabaseConnectionSetting> connectionSetting;
+    std::shared_ptr<WorklistRepository> repository;
+    WorklistProfile profile;
+    QList<DicomTag> identifierTags;
+
+    static constexpr const char* SCRATCH_CONNECTION = "SCRATCH-RIS-22";
+
+    static QString connection(const QString& suffix) {
+        return QString("%1-%2").arg(SCRATCH_CONNECTION, suffix);
+    }
+
+    WorklistEntry entry(const QString& identity, const QString& sourceConnection) {
+        WorklistEntry e;
+        e.Profile = profile;
+        e.Source = Source::RIS;
+        e.SourceConnection = sourceConnection;
+        e.Status = ProcedureStepStatus::PENDING;
+        e.CreatedAt = QDateTime::currentDateTime();
+        for (const DicomTag& tag : identifierTags) {
+            WorklistAttribute attribute;
+            attribute.Tag = tag;
+            attribute.TagValue = QString("%1-%2").arg(identity).arg(tag.Id);
+            e.Attributes.append(attribute);
+        }
+        return e;
+    }
+
+    QStringList sourceConnections(const QString& where) {
+        auto lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+        QSqlQuery query(lease.database());
+        QStringList connections;
+        if (!query.exec(QString("SELECT source_connection FROM mwl_entries WHERE %1 ORDER BY source_connection").arg(where))) {
+            qWarning() << query.lastError().text();
+            return connections;
+        }
+        while (query.next())
+            connections << query.value(0).toString();
+        return connections;
+    }
+
+private slots:
+    void initTestCase() {
+        connectionSetting = std::make_shared<DatabaseConnectionSetting>();
+        connectionSetting->setHostName("localhost");
+        connectionSetting->setDatabaseName("etrekdb");
+        connectionSetting->setEtrektUserName("root");
+        connectionSetting->setPassword("Trt123Tst!)");
+        connectionSetting->setPort(3306);
+        connectionSetting->setIsPasswordEncrypted(false);
+
+        repository = std::make_shared<WorklistRepository>(connectionSetting);
+
+        auto profiles = repository->getProfiles();
+        QVERIFY(profiles.isSuccess && !profiles.value.isEmpty());
+        profile = profiles.value.first();
+
+        auto identifiers = repository->getActiveIdentifierTags(profile.Id);
+        QVERIFY(identifiers.isSuccess && !identifiers.value.isEmpty());
+        identifierTags = identifiers.value;
+    }
+
+    void cleanup() {
+        auto lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+        QSqlQuery query(lease.database());
+        // attributes and sources follow their entries by ON DELETE CASCADE
+        query.exec(QString("DELETE FROM mwl_entries WHERE source_connection LIKE '%1-%'").arg(SCRATCH_CONNECTION));
+    }
+
+    void test_EntryIsAttributedToItsConnection() {
+        auto ingested = repository->ingestWorklistEntries({ entry("A1", connection("A")), entry("A2", connection("A")) }, profile);
+        QVERIFY2(ingested.isSuccess, qPrintable(ingested.message));
+        QCOMPARE(ingested.value.Created, 2);
+
+        QCOMPARE(sourceConnections(QString("source_connection = '%1'").arg(connection("A"))).size(), 2);
+
+        auto page = repository->getWorklistDisplayPage(WorklistPageCursor(), 500);
+        QVERIFY(page.isSuccess);
+        int attributed = 0;
+        for (const WorklistDisplayRow& row : page.value.Rows)
+            if (ingested.value.CreatedIds.contains(row.EntryId) && row.SourceConnection == connection("A"))
+                ++attributed;
+        QCOMPARE(attributed, 2);
+    }
+
+    void test_SameIdentityFromTwoConnectionsIsStoredOnce() {
+        QVERIFY(repository->ingestWorklistEntries({ entry("M1", connection("A")) }, profile).isSuccess);
+
+        // The second RIS sends the same procedure and one of its own
+        auto second = repository->ingestWorklistEntries({ entry("M1", connection("B")), entry("M2", connection("B")) }, profile);
+        QVERIFY2(second.isSuccess, qPrintable(second.message));
+        QCOMPARE(second.value.Created, 1);
+        QCOMPARE(second.value.Unchanged, 1);
+
+        // The shared entry keeps the connection it came from first
+        QCOMPARE(sourceConnections(QString("source_connection LIKE '%1-%'").arg(SCRATCH_CONNECTION)),
+            QStringList({ connection("A"), connection("B") }));
+    }
+
+    void test_UpdateReportsStoredStatusAndSource() {
+        // A non-identifier tag can change without changing the identity
+        auto tags = repository->getTagsByProfile(profile.Id);
+        QVERIFY(tags.isSuccess);
+        DicomTag changing;
+        for (const DicomTag& tag : tags.value) {
+            if (tag.IsActive && !std::any_of(identifierTags.cbegin(), identifierTags.cend(),
+                    [&](const DicomTag& identifier) { return identifier.Id == tag.Id; })) {
+                changing = tag;
+                break;
+            }
+        }
+        if (changing.Id <= 0)
+            QSKIP("profile has no active non-identifier tag");
+
+        WorklistEntry first = entry("U1", connection("A"));
+        WorklistAttribute attribute;
+        attribute.Tag = changing;
+        attribute.TagValue = "before";
+        first.Attributes.append(attribute);
+        auto ingested = repository->ingestWorklistEntries({ first }, profile);
+        QVERIFY(ingested.isSuccess && ingested.value.CreatedIds.size() == 1);
+        const int id = ingested.value.CreatedIds.first();
+        QVERIFY(repository->updateWorklistStatus(id, ProcedureStepStatus::IN_PROGRESS).isSuccess);
+
+        QList<WorklistEntry> updates;
+        auto connectionHandle = connect(repository.get(), &WorklistRepository::worklistEntryUpdated,
+            [&updates](const WorklistEntry& updatedEntry) { updates.append(updatedEntry); });
+
+        WorklistEntry second = entry("U1", connection("B"));
+        attribute.TagValue = "after";
+        second.Attributes.append(attribute);
+        auto updated = repository->ingestWorklistEntries({ second }, profile);
+        disconnect(connectionHandle);
+        QVERIFY2(updated.isSuccess, qPrintable(updated.message));
+        QCOMPARE(updated.value.Updated, 1);
+
+        QCOMPARE(updates.size(), 1);
+        QCOMPARE(updates.first().Id, id);
+        QVERIFY(updates.first().Status == ProcedureStepStatus::IN_PROGRESS);
+        QVERIFY(updates.first().Source == Source::RIS);
+        QCOMPARE(updates.first().SourceConnection, connection("A"));
+
+        // Sent again unchanged, the entry is not updated
+        auto again = repository->ingestWorklistEntries({ second }, profile);
+        QVERIFY(again.isSuccess);
+        QCOMPARE(again.value.Unchanged, 1);
+    }
+
+    void test_CreatingStoredIdentityReturnsStoredEntry() {
+        auto ingested = repository->ingestWorklistEntries({ entry("C1", connection("A")) }, profile);
+        QVERIFY(ingested.isSuccess && ingested.value.CreatedIds.size() == 1);
+
+        // A local create of the same procedure resolves to the stored entry
+        WorklistEntry local = entry("C1", QString());
+        local.Source = Source::LOCAL;
+        auto created = repository->createWorklistEntry(local);
+        QVERIFY2(created.isSuccess, qPrintable(created.message));
+        QCOMPARE(created.value, ingested.value.CreatedIds.first());
+    }
+
+    void test_MergedEntryStaysWhileAnyConnectionReturnsIt() {
+        auto first = repository->ingestWorklistEntries({ entry("R1", connection("A")) }, profile);
+        QVERIFY(first.isSuccess && first.value.CreatedIds.size() == 1);
+        const int sharedId = first.value.CreatedIds.first();
+        QVERIFY(repository->ingestWorklistEntries({ entry("R1", connection("B")) }, profile).isSuccess);
+
+        // A's reconcile no longer returns it, B still does
+        auto afterA = repository->cancelUnseenRisEntries(profile.Id, connection("A"), {});
+        QVERIFY2(afterA.isSuccess, qPrintable(afterA.message));
+        QCOMPARE(afterA.value, 0);
+        QCOMPARE(sourceConnections(QString("id = %1 AND status = 'PENDING'").arg(sharedId)).size(), 1);
+
+        // Now B drops it too
+        auto afterB = repository->cancelUnseenRisEntries(profile.Id, connection("B"), {});
+        QVERIFY2(afterB.isSuccess, qPrintable(afterB.message));
+        QCOMPARE(afterB.value, 1);
+        QCOMPARE(sourceConnections(QString("id = %1 AND status = 'CANCELLED'").arg(sharedId)).size(), 1);
+    }
+};
+
+QTEST_APPLESS_MAIN(MultiRisIngestTest)
+#include "tst_MultiRisIngest.moc"
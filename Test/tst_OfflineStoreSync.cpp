@@ -0,0 +1,219 @@
+#include <QObject>
+#include <QTest>
+#include <QDebug>
+#include <QDateTime>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include "DatabaseConnectionPool.h"
+#include "DatabaseSetupManager.h"
+#include "DatabaseConnectionSetting.h"
+#include "OfflineStoreSync.h"
+#include "DicomRepository.h"
+
+using Etrek::Core::Repository::DatabaseConnectionPool;
+using Etrek::Core::Repository::DatabaseSetupManager;
+using Etrek::Core::Repository::OfflineStoreSync;
+using Etrek::Core::Data::Model::DatabaseConnectionSetting;
+using Etrek::Core::Data::Model::StorageBackend;
+using Etrek::Dicom::Repository::DicomRepository;
+using Etrek::Worklist::Data::Entity::WorklistEntry;
+using Etrek::Worklist::Data::Entity::WorklistAttribute;
+
+// Registers entries on a fresh SQLite offline store, as the registration dialog does while the
+// server is down, and checks that the sync sends them and their status changes to MySQL and
+// copies today's worklist back. Scratch entries carry a patient ID with SCRATCH_PREFIX and are
+// removed from MySQL again in cleanup().
+class OfflineStoreSyncTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit OfflineStoreSyncTest(QObject* parent = nullptr) : QObject(parent) {}
+
+private:
+    std::shared_ptr<DatabaseConnectionSetting> mysqlSetting;
+    std::shared_ptr<DatabaseConnectionSetting> storeSetting;
+    QTemporaryDir storeDir;
+
+    static constexpr auto SCRATCH_PREFIX = "OFFLINE-SYNC-TEST-";
+
+    QDateTime startOfToday() const {
+        return QDateTime(QDate::currentDate(), QTime(0, 0));
+    }
+
+    int tagId(std::shared_ptr<DatabaseConnectionSetting> setting, const QString& name) {
+        auto lease = DatabaseConnectionPool::Instance().acquire(setting);
+        QSqlQuery query(lease.database());
+        query.prepare("SELECT id FROM dicom_tags WHERE name = ?");
+        query.addBindValue(name);
+        if (!query.exec() || !query.next())
+            return -1;
+        return query.value(0).toInt();
+    }
+
+    // Registers an entry on the store through DicomRepository; returns its local id
+    int registerOffline(const QString& patientId) {
+        DicomRepository repository(storeSetting);
+
+        WorklistEntry entry;
+        entry.Source = Source::LOCAL;
+        entry.Status = ProcedureStepStatus::SCHEDULED;
+        entry.CreatedAt = QDateTime::currentDateTime();
+        auto inserted = repository.insertWorklistEntry(entry);
+        if (!inserted.isSuccess)
+            return -1;
+
+        WorklistAttribute name;
+        name.Tag.Id = tagId(storeSetting, "PatientName");
+        name.TagValue = "Offline^Patient";
+        WorklistAttribute id;
+        id.Tag.Id = tagId(storeSetting, "PatientID");
+        id.TagValue = patientId;
+
+        if (!repository.insertWorklistAttributes(entry.Id, { name, id }).isSuccess)
+            return -1;
+        return entry.Id;
+    }
+
+    // Returns the id and status of the entry with @p patientId, or an id of -1
+    QPair<int, QString> findEntry(std::shared_ptr<DatabaseConnectionSetting> setting, const QString& patientId) {
+        auto lease = DatabaseConnectionPool::Instance().acquire(setting);
+        QSqlQuery query(lease.database());
+        query.prepare("SELECT id, status FROM mwl_entries WHERE display_patient_id = ?");
+        query.addBindValue(patientId);
+        if (!query.exec() || !query.next())
+            return { -1, QString() };
+        return { query.value(0).toInt(), query.value(1).toString() };
+    }
+
+    int pendingSync(int entryId) {
+        auto lease = DatabaseConnectionPool::Instance().acquire(storeSetting);
+        QSqlQuery query(lease.database());
+        query.prepare("SELECT pending_sync FROM mwl_entries WHERE id = ?");
+        query.addBindValue(entryId);
+        if (!query.exec() || !query.next())
+            return -1;
+        return query.value(0).toInt();
+    }
+
+private slots:
+    void initTestCase() {
+        mysqlSetting = std::make_shared<DatabaseConnectionSetting>();
+        mysqlSetting->setHostName("localhost");
+        mysqlSetting->setDatabaseName("etrekdb");
+        mysqlSetting->setEtrektUserName("root");
+        mysqlSetting->setPassword("Trt123Tst!)");
+        mysqlSetting->setPort(3306);
+        mysqlSetting->setIsPasswordEncrypted(false);
+
+        QVERIFY(storeDir.isValid());
+        storeSetting = std::make_shared<DatabaseConnectionSetting>();
+        storeSetting->setStorageBackend(StorageBackend::Sqlite);
+        storeSetting->setDatabaseName(storeDir.filePath("etrek_offline.db"));
+
+        auto setup = DatabaseSetupManager(storeSetting).initializeDatabase();
+        QVERIFY2(setup.isSuccess, qPrintable(setup.message));
+    }
+
+    void cleanup() {
+        auto lease = DatabaseConnectionPool::Instance().acquire(mysqlSetting);
+        QSqlQuery query(lease.database());
+        // mwl_attributes follow by ON DELETE CASCADE
+        query.exec(QString("DELETE FROM mwl_entries WHERE display_patient_id LIKE '%1%'").arg(SCRATCH_PREFIX));
+    }
+
+    void test_OfflineEntryIsSentToServer() {
+        const QString patientId = QString("%1%2").arg(SCRATCH_PREFIX).arg(QDateTime::currentMSecsSinceEpoch());
+        const int localId = registerOffline(patientId);
+        QVERIFY(localId > 0);
+        QCOMPARE(pendingSync(localId), 1);
+
+        OfflineStoreSync sync(mysqlSetting, storeSetting);
+        auto report = sync.synchronize(startOfToday());
+        QVERIFY2(report.isSuccess, qPrintable(report.message));
+        QCOMPARE(report.value.EntriesPushed, 1);
+        qDebug().noquote() << QString("sync: %1 sent, %2 copied in %3 ms")
+            .arg(report.value.EntriesPushed).arg(report.value.EntriesMirrored).arg(report.value.ElapsedMs);
+
+        // On the server with its display columns, and back in the store under the server's id
+        const auto onServer = findEntry(mysqlSetting, patientId);
+        QVERIFY(onServer.first > 0);
+        QCOMPARE(onServer.second, QString("SCHEDULED"));
+
+        const auto inStore = findEntry(storeSetting, patientId);
+        QCOMPARE(inStore.first, onServer.first);
+        QCOMPARE(pendingSync(inStore.first), 0);
+
+        // Nothing left to send
+        auto again = sync.synchronize(startOfToday());
+        QVERIFY2(again.isSuccess, qPrintable(again.message));
+        QCOMPARE(again.value.EntriesPushed, 0);
+    }
+
+    void test_StatusChangeIsSentToServer() {
+        const QString patientId = QString("%1%2").arg(SCRATCH_PREFIX).arg(QDateTime::currentMSecsSinceEpoch());
+        QVERIFY(registerOffline(patientId) > 0);
+
+        OfflineStoreSync sync(mysqlSetting, storeSetting);
+        QVERIFY(sync.synchronize(startOfToday()).isSuccess);
+        const int entryId = findEntry(storeSetting, patientId).first;
+        QVERIFY(entryId > 0);
+
+        {
+            auto lease = DatabaseConnectionPool::Instance().acquire(storeSetting);
+            QSqlQuery update(lease.database());
+            update.prepare("UPDATE mwl_entries SET status = 'COMPLETED' WHERE id = ?");
+            update.addBindValue(entryId);
+            QVERIFY2(update.exec(), qPrintable(update.lastError().text()));
+        }
+        QCOMPARE(pendingSync(entryId), 2);
+
+        auto report = sync.synchronize(startOfToday());
+        QVERIFY2(report.isSuccess, qPrintable(report.message));
+        QCOMPARE(report.value.StatusesPushed, 1);
+        QCOMPARE(findEntry(mysqlSetting, patientId).second, QString("COMPLETED"));
+        QCOMPARE(pendingSync(entryId), 0);
+    }
+
+    void test_MirrorCopiesTodaysWorklist() {
+        const QString patientId = QString("%1%2").arg(SCRATCH_PREFIX).arg(QDateTime::currentMSecsSinceEpoch());
+
+        // Registered on the server while the store was not looking
+        DicomRepository serverRepository(mysqlSetting);
+        WorklistEntry entry;
+        entry.Source = Source::LOCAL;
+        entry.Status = ProcedureStepStatus::SCHEDULED;
+        entry.CreatedAt = QDateTime::currentDateTime();
+        QVERIFY(serverRepository.insertWorklistEntry(entry).isSuccess);
+        WorklistAttribute id;
+        id.Tag.Id = tagId(mysqlSetting, "PatientID");
+        id.TagValue = patientId;
+        QVERIFY(serverRepository.insertWorklistAttributes(entry.Id, { id }).isSuccess);
+
+        OfflineStoreSync sync(mysqlSetting, storeSetting);
+        auto report = sync.synchronize(startOfToday());
+        QVERIFY2(report.isSuccess, qPrintable(report.message));
+        QVERIFY(report.value.EntriesMirrored >= 1);
+
+        QCOMPARE(findEntry(storeSetting, patientId).first, entry.Id);
+        QCOMPARE(pendingSync(entry.Id), 0);
+    }
+
+    void test_StoreWithUsersIsOwnerOnly() {
+        OfflineStoreSync sync(mysqlSetting, storeSetting);
+        auto report = sync.synchronize(startOfToday());
+        QVERIFY2(report.isSuccess, qPrintable(report.message));
+
+        // The users carry their encrypted passwords
+        const auto permissions = QFile::permissions(storeSetting->getDatabaseName());
+        QVERIFY(permissions.testFlag(QFileDevice::ReadOwner));
+        QVERIFY(!permissions.testFlag(QFileDevice::ReadGroup));
+        QVERIFY(!permissions.testFlag(QFileDevice::ReadOther));
+    }
+};
+
+QTEST_APPLESS_MAIN(OfflineStoreSyncTest)
+#include "tst_OfflineStoreSync.moc"
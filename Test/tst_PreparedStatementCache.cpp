@@ -0,0 +1,71 @@
+#include <QObject>
+#include <QTest>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include "PreparedStatementCache.h"
+
+using Etrek::Core::Repository::PreparedStatementCache;
+
+// Checks statement reuse by PreparedStatementCache on an in-memory SQLite connection.
+class PreparedStatementCacheTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PreparedStatementCacheTest(QObject* parent = nullptr) : QObject(parent) {}
+
+private:
+    static constexpr auto CONNECTION_NAME = "prepared_statement_cache_test";
+    static constexpr auto SELECT_SQL = "SELECT id FROM items ORDER BY id";
+
+private slots:
+    void initTestCase() {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", CONNECTION_NAME);
+        db.setDatabaseName(":memory:");
+        QVERIFY2(db.open(), qPrintable(db.lastError().text()));
+
+        QSqlQuery query(db);
+        QVERIFY(query.exec("CREATE TABLE items (id INTEGER PRIMARY KEY)"));
+        QVERIFY(query.exec("INSERT INTO items (id) VALUES (1), (2), (3)"));
+    }
+
+    void cleanupTestCase() {
+        QSqlDatabase::database(CONNECTION_NAME, false).close();
+        QSqlDatabase::removeDatabase(CONNECTION_NAME);
+    }
+
+    void test_ReusesStatementAfterRelease() {
+        PreparedStatementCache cache(CONNECTION_NAME, 8);
+        QSqlQuery* first = cache.acquire(SELECT_SQL);
+        QVERIFY(first);
+        QVERIFY(first->exec());
+        while (first->next()) {}
+        cache.releasePinned();
+
+        QSqlQuery* second = cache.acquire(SELECT_SQL);
+        QCOMPARE(second, first);
+        QCOMPARE(cache.stats().hits, quint64(1));
+    }
+
+    void test_StatementBeingReadIsNotHandedOutAgain() {
+        PreparedStatementCache cache(CONNECTION_NAME, 8);
+        QSqlQuery* outer = cache.acquire(SELECT_SQL);
+        QVERIFY(outer);
+        QVERIFY(outer->exec());
+        QVERIFY(outer->next());
+
+        // Nested use of the same SQL while the outer rows are read
+        QCOMPARE(cache.acquire(SELECT_SQL), static_cast<QSqlQuery*>(nullptr));
+        QVERIFY(outer->isActive());
+        QVERIFY(outer->next());
+        QCOMPARE(outer->value(0).toInt(), 2);
+
+        // Read to the end, it is free again
+        while (outer->next()) {}
+        QCOMPARE(cache.acquire(SELECT_SQL), outer);
+    }
+};
+
+QTEST_APPLESS_MAIN(PreparedStatementCacheTest)
+#include "tst_PreparedStatementCache.moc"
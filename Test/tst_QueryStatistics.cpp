@@ -0,0 +1,112 @@
+#include <QObject>
+#include <QTest>
+#include <QDebug>
+#include <QTemporaryDir>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include "DatabaseConnectionPool.h"
+#include "DatabaseConnectionSetting.h"
+#include "QueryStatistics.h"
+
+using Etrek::Core::Repository::DatabaseConnectionPool;
+using Etrek::Core::Repository::QueryStatistics;
+using Etrek::Core::Repository::LatencyHistogram;
+using Etrek::Core::Data::Model::DatabaseConnectionSetting;
+using Etrek::Core::Data::Model::StorageBackend;
+
+// Checks statement fingerprints, the latency histogram and recording through
+// QueryStatistics::exec() on a scratch SQLite database.
+class QueryStatisticsTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit QueryStatisticsTest(QObject* parent = nullptr) : QObject(parent) {}
+
+private:
+    std::shared_ptr<DatabaseConnectionSetting> connectionSetting;
+    QTemporaryDir databaseDir;
+
+private slots:
+    void initTestCase() {
+        QVERIFY(databaseDir.isValid());
+        connectionSetting = std::make_shared<DatabaseConnectionSetting>();
+        connectionSetting->setStorageBackend(StorageBackend::Sqlite);
+        connectionSetting->setDatabaseName(databaseDir.filePath("statistics.db"));
+
+        auto lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+        QSqlQuery query(lease.database());
+        QVERIFY2(query.exec("CREATE TABLE samples (id INTEGER PRIMARY KEY, name TEXT)"), qPrintable(query.lastError().text()));
+    }
+
+    void init() {
+        QueryStatistics::Instance().reset();
+    }
+
+    void test_FingerprintFoldsLiteralsAndLists() {
+        QCOMPARE(QueryStatistics::fingerprint("SELECT *\n   FROM users WHERE id = 42 AND name = 'O''Brien'"),
+                 QString("SELECT * FROM users WHERE id = ? AND name = ?"));
+        QCOMPARE(QueryStatistics::fingerprint("SELECT id FROM t WHERE id IN (?,?, ?,?)"),
+                 QString("SELECT id FROM t WHERE id IN (?, ...)"));
+        QCOMPARE(QueryStatistics::fingerprint("INSERT INTO t (a, b) VALUES (?, ?), (?, ?), (?, ?)"),
+                 QString("INSERT INTO t (a, b) VALUES (?, ...), ..."));
+        // Digits inside identifiers stay
+        QCOMPARE(QueryStatistics::fingerprint("SELECT col2 FROM table_3 LIMIT 10"),
+                 QString("SELECT col2 FROM table_3 LIMIT ?"));
+    }
+
+    void test_HistogramQuantiles() {
+        LatencyHistogram histogram;
+        for (int i = 0; i < 90; ++i)
+            histogram.add(80 * 1000);           // 80 us, bucket <= 100 us
+        for (int i = 0; i < 10; ++i)
+            histogram.add(30 * 1000 * 1000);    // 30 ms, bucket <= 50 ms
+
+        QCOMPARE(histogram.count(), quint64(100));
+        QCOMPARE(histogram.quantileNs(0.50), qint64(100 * 1000));
+        QCOMPARE(histogram.quantileNs(0.95), qint64(30 * 1000 * 1000));   // capped at the maximum
+        QCOMPARE(histogram.maxNs(), qint64(30 * 1000 * 1000));
+    }
+
+    void test_ExecRecordsPerFingerprint() {
+        {
+            auto lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+            for (int i = 0; i < 5; ++i) {
+                QSqlQuery& insert = lease.prepare("INSERT INTO samples (name) VALUES (?)");
+                insert.addBindValue(QString("sample %1").arg(i));
+                QVERIFY(QueryStatistics::exec(insert));
+            }
+
+            // Same fingerprint for different literals
+            QSqlQuery select(lease.database());
+            QVERIFY(QueryStatistics::exec(select, "SELECT name FROM samples WHERE id = 1"));
+            QVERIFY(QueryStatistics::exec(select, "SELECT name FROM samples WHERE id = 2"));
+
+            QSqlQuery broken(lease.database());
+            QVERIFY(!QueryStatistics::exec(broken, "SELECT missing FROM samples"));
+        }
+
+        const auto statements = QueryStatistics::Instance().statements();
+        QCOMPARE(statements.size(), 3);
+
+        QHash<QString, quint64> executions;
+        for (const auto& statement : statements)
+            executions.insert(statement.Fingerprint, statement.Latency.count());
+        QCOMPARE(executions.value("INSERT INTO samples (name) VALUES (?)"), quint64(5));
+        QCOMPARE(executions.value("SELECT name FROM samples WHERE id = ?"), quint64(2));
+
+        for (const auto& statement : statements) {
+            if (statement.Fingerprint == "INSERT INTO samples (name) VALUES (?)")
+                QCOMPARE(statement.Rows, qint64(5));
+            if (statement.Fingerprint == "SELECT missing FROM samples")
+                QCOMPARE(statement.Failures, quint64(1));
+        }
+
+        QVERIFY(QueryStatistics::Instance().acquireWait().count() >= 1);
+        qDebug().noquote() << QueryStatistics::Instance().report();
+    }
+};
+
+QTEST_APPLESS_MAIN(QueryStatisticsTest)
+#include "tst_QueryStatistics.moc"
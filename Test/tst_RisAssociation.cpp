@@ -0,0 +1,133 @@
+#include <QObject>
+#include <QTest>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include "dcmtk/dcmdata/dcuid.h"
+#include "dcmtk/dcmnet/scp.h"
+#include "WorklistQueryService.h"
+#include "RisConnectionSetting.h"
+#include "WorklistPresentationContext.h"
+
+using namespace Etrek::Worklist::Connectivity;
+using Etrek::Core::Data::Model::RisConnectionSetting;
+using Etrek::Worklist::Data::Entity::WorklistPresentationContext;
+
+// Checks that WorklistQueryService can open, drop and re-open its RIS association, against an
+// in-process DcmSCP on a local port that answers C-ECHO and accepts the worklist C-FIND context.
+class RisAssociationTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RisAssociationTest(QObject* parent = nullptr) : QObject(parent) {}
+
+private:
+    class EchoScp : public DcmSCP
+    {
+    public:
+        std::atomic<bool> Stop{ false };
+        std::atomic<int> Associations{ 0 };
+
+    protected:
+        void notifyAssociationAcknowledge() override { ++Associations; }
+        OFBool stopAfterConnectionTimeout() override { return Stop.load(); }
+    };
+
+    static constexpr Uint16 SCP_PORT = 11199;
+    static constexpr const char* SCP_AE_TITLE = "ETREK_TEST_SCP";
+    static constexpr const char* TRANSFER_SYNTAX = UID_LittleEndianImplicitTransferSyntax;
+
+    std::unique_ptr<EchoScp> scp;
+    std::thread scpThread;
+    std::unique_ptr<WorklistQueryService> service;
+
+    static WorklistPresentationContext presentationContext() {
+        WorklistPresentationContext context;
+        context.Id = 1;
+        context.TransferSyntaxUid = TRANSFER_SYNTAX;
+        return context;
+    }
+
+private slots:
+    void initTestCase() {
+        scp = std::make_unique<EchoScp>();
+        scp->setPort(SCP_PORT);
+        scp->setAETitle(SCP_AE_TITLE);
+        scp->setConnectionBlockingMode(DUL_NOBLOCK);
+        scp->setConnectionTimeout(1);
+
+        OFList<OFString> transferSyntaxes;
+        transferSyntaxes.push_back(TRANSFER_SYNTAX);
+        QVERIFY(scp->addPresentationContext(UID_VerificationSOPClass, transferSyntaxes).good());
+        QVERIFY(scp->addPresentationContext(UID_FINDModalityWorklistInformationModel, transferSyntaxes).good());
+        scpThread = std::thread([this]() { scp->listen(); });
+
+        auto settings = std::make_shared<RisConnectionSetting>();
+        settings->setCallingAETitle("ETREK_TEST_SCU");
+        settings->setCalledAETitle(SCP_AE_TITLE);
+        settings->setHostIP("127.0.0.1");
+        settings->setPort(SCP_PORT);
+
+        service = std::make_unique<WorklistQueryService>();
+        service->setPresentationContext(presentationContext());
+        service->setSettings(settings);
+
+        // The SCP thread may not be listening yet
+        QTRY_VERIFY_WITH_TIMEOUT(service->prepareAssociation().isSuccess, 5000);
+        QVERIFY(service->associationState() == RisAssociationState::Connected);
+    }
+
+    void cleanupTestCase() {
+        service.reset();
+        scp->Stop = true;
+        if (scpThread.joinable())
+            scpThread.join();
+        scp.reset();
+    }
+
+    void test_ReusesOpenAssociation() {
+        const int before = scp->Associations.load();
+        QVERIFY(service->echoRis().isSuccess);
+        QVERIFY(service->echoRis().isSuccess);
+        QCOMPARE(scp->Associations.load(), before);
+    }
+
+    void test_ReopensAfterRelease() {
+        QVERIFY(service->echoRis().isSuccess);
+        const int before = scp->Associations.load();
+
+        QVERIFY(service->releaseAssociation().isSuccess);
+        QVERIFY(service->associationState() == RisAssociationState::Disconnected);
+
+        // A new association needs new association parameters
+        auto echo = service->echoRis();
+        QVERIFY2(echo.isSuccess, qPrintable(echo.message));
+        QCOMPARE(scp->Associations.load(), before + 1);
+        QVERIFY(service->associationState() == RisAssociationState::Connected);
+    }
+
+    void test_ReopensAfterPresentationContextChange() {
+        QVERIFY(service->echoRis().isSuccess);
+        const int before = scp->Associations.load();
+
+        // Drops the association; the contexts are added again and must reach the new one
+        service->setPresentationContext(presentationContext());
+        auto echo = service->echoRis();
+        QVERIFY2(echo.isSuccess, qPrintable(echo.message));
+        QCOMPARE(scp->Associations.load(), before + 1);
+    }
+
+    void test_PrepareReplacesOpenAssociation() {
+        const int before = scp->Associations.load();
+        for (int i = 0; i < 3; ++i) {
+            auto prepared = service->prepareAssociation();
+            QVERIFY2(prepared.isSuccess, qPrintable(prepared.message));
+        }
+        QVERIFY(service->echoRis().isSuccess);
+        QCOMPARE(scp->Associations.load(), before + 3);
+    }
+};
+
+QTEST_APPLESS_MAIN(RisAssociationTest)
+#include "tst_RisAssociation.moc"
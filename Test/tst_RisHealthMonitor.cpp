@@ -0,0 +1,110 @@
+#include <QObject>
+#include <QTest>
+#include "RisHealthMonitor.h"
+
+using namespace Etrek::Worklist::Connectivity;
+
+// Checks the state machine and latency statistics of RisHealthTracker and the echo failure
+// policy, without a RIS.
+class RisHealthMonitorTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RisHealthMonitorTest(QObject* parent = nullptr) : QObject(parent) {}
+
+private:
+    static RisHealthPolicy policy() {
+        RisHealthPolicy policy;
+        policy.DegradedLatencyMs = 100;
+        policy.DownAfterFailures = 3;
+        policy.LatencyWindow = 4;
+        return policy;
+    }
+
+private slots:
+    void test_StartsUnknownAndBecomesHealthy() {
+        RisHealthTracker tracker("SCRATCH-RIS", policy());
+        QVERIFY(tracker.snapshot().State == RisHealthState::Unknown);
+
+        QVERIFY(tracker.record(true, 20, QString(), QDateTime::currentDateTime()));
+        QVERIFY(tracker.snapshot().State == RisHealthState::Healthy);
+        QCOMPARE(tracker.snapshot().ConnectionName, QString("SCRATCH-RIS"));
+
+        // Same state again is not a change
+        QVERIFY(!tracker.record(true, 30, QString(), QDateTime::currentDateTime()));
+    }
+
+    void test_FailuresDegradeThenDown() {
+        RisHealthTracker tracker("SCRATCH-RIS", policy());
+        const QDateTime now = QDateTime::currentDateTime();
+        tracker.record(true, 20, QString(), now);
+
+        QVERIFY(tracker.record(false, 0, "timeout", now));
+        QVERIFY(tracker.snapshot().State == RisHealthState::Degraded);
+        QVERIFY(!tracker.record(false, 0, "timeout", now));
+        QVERIFY(tracker.record(false, 0, "refused", now));
+        QVERIFY(tracker.snapshot().State == RisHealthState::Down);
+        QCOMPARE(tracker.snapshot().ConsecutiveFailures, 3);
+        QCOMPARE(tracker.snapshot().LastError, QString("refused"));
+
+        QVERIFY(tracker.record(true, 20, QString(), now));
+        QVERIFY(tracker.snapshot().State == RisHealthState::Healthy);
+        QCOMPARE(tracker.snapshot().ConsecutiveFailures, 0);
+    }
+
+    void test_SlowEchoesDegrade() {
+        RisHealthTracker tracker("SCRATCH-RIS", policy());
+        const QDateTime now = QDateTime::currentDateTime();
+        tracker.record(true, 50, QString(), now);
+        tracker.record(true, 60, QString(), now);
+        QVERIFY(tracker.snapshot().State == RisHealthState::Healthy);
+
+        // Mean of 50, 60, 400 is above the limit
+        QVERIFY(tracker.record(true, 400, QString(), now));
+        QVERIFY(tracker.snapshot().State == RisHealthState::Degraded);
+    }
+
+    void test_LatencyStatsUseRollingWindow() {
+        RisHealthTracker tracker("SCRATCH-RIS", policy());
+        const QDateTime now = QDateTime::currentDateTime();
+        for (qint64 latency : { 1000, 10, 20, 30, 40 })
+            tracker.record(true, latency, QString(), now);
+
+        // The window holds the last four; 1000 has dropped out
+        const RisLatencyStats stats = tracker.snapshot().Latency;
+        QCOMPARE(stats.Samples, 4);
+        QCOMPARE(stats.LastMs, qint64(40));
+        QCOMPARE(stats.MinMs, qint64(10));
+        QCOMPARE(stats.MaxMs, qint64(40));
+        QCOMPARE(stats.MeanMs, 25.0);
+        QCOMPARE(stats.P95Ms, qint64(40));
+        QVERIFY(tracker.snapshot().State == RisHealthState::Healthy);
+    }
+
+    void test_EchoFailurePolicy() {
+        RisHealthPolicy policy;
+        policy.ContinueOnEchoFail = true;
+        QVERIFY(policy.allowsQuery(RisHealthState::Down));
+
+        policy.ContinueOnEchoFail = false;
+        QVERIFY(!policy.allowsQuery(RisHealthState::Down));
+        QVERIFY(policy.allowsQuery(RisHealthState::Degraded));
+        QVERIFY(policy.allowsQuery(RisHealthState::Unknown));
+    }
+
+    void test_MonitorPublishesUnknownForNewConnection() {
+        RisHealthMonitor monitor(policy());
+        monitor.addConnection("SCRATCH-RIS", nullptr);
+
+        QVERIFY(monitor.state("SCRATCH-RIS") == RisHealthState::Unknown);
+        QCOMPARE(monitor.snapshots().size(), 1);
+
+        // Nothing to probe without a query service
+        monitor.probeAll();
+        QVERIFY(monitor.state("SCRATCH-RIS") == RisHealthState::Unknown);
+    }
+};
+
+QTEST_APPLESS_MAIN(RisHealthMonitorTest)
+#include "tst_RisHealthMonitor.moc"
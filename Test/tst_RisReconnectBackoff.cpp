@@ -0,0 +1,70 @@
+#include <QObject>
+#include <QTest>
+#include "RisReconnectBackoff.h"
+
+using namespace Etrek::Worklist::Connectivity;
+
+// Checks the delays between failed RIS association attempts with a fixed random source.
+class RisReconnectBackoffTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RisReconnectBackoffTest(QObject* parent = nullptr) : QObject(parent) {}
+
+private:
+    static RisAssociationPolicy policy() {
+        RisAssociationPolicy policy;
+        policy.InitialBackoffMs = 1000;
+        policy.MaxBackoffMs = 10000;
+        policy.BackoffMultiplier = 2.0;
+        policy.Jitter = 0.2;
+        return policy;
+    }
+
+private slots:
+    void test_DelaysGrowUpToMaximum() {
+        // 0.5 is the middle of the jitter range, i.e. no jitter
+        RisReconnectBackoff backoff(policy(), []() { return 0.5; });
+
+        QCOMPARE(backoff.nextDelayMs(), 1000);
+        QCOMPARE(backoff.nextDelayMs(), 2000);
+        QCOMPARE(backoff.nextDelayMs(), 4000);
+        QCOMPARE(backoff.nextDelayMs(), 8000);
+        QCOMPARE(backoff.nextDelayMs(), 10000);
+        QCOMPARE(backoff.nextDelayMs(), 10000);
+        QCOMPARE(backoff.failures(), 6);
+    }
+
+    void test_JitterStaysWithinRange() {
+        RisReconnectBackoff low(policy(), []() { return 0.0; });
+        RisReconnectBackoff high(policy(), []() { return 0.999; });
+
+        QCOMPARE(low.nextDelayMs(), 800);
+        const int highDelay = high.nextDelayMs();
+        QVERIFY(highDelay > 1190 && highDelay <= 1200);
+
+        // Jitter never pushes a delay past the maximum
+        for (int i = 0; i < 10; ++i)
+            QVERIFY(high.nextDelayMs() <= 10000);
+    }
+
+    void test_ResetStartsOver() {
+        RisReconnectBackoff backoff(policy(), []() { return 0.5; });
+        backoff.nextDelayMs();
+        backoff.nextDelayMs();
+
+        backoff.reset();
+        QCOMPARE(backoff.failures(), 0);
+        QCOMPARE(backoff.nextDelayMs(), 1000);
+    }
+
+    void test_DefaultRandomSourceIsJittered() {
+        RisReconnectBackoff backoff(policy());
+        const int delay = backoff.nextDelayMs();
+        QVERIFY(delay >= 800 && delay <= 1200);
+    }
+};
+
+QTEST_APPLESS_MAIN(RisReconnectBackoffTest)
+#include "tst_RisReconnectBackoff.moc"
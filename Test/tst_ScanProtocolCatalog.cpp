@@ -0,0 +1,213 @@
+#include <QObject>
+#include <QTest>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include "DatabaseConnectionPool.h"
+#include "DatabaseConnectionSetting.h"
+#include "ScanProtocolRepository.h"
+
+using Etrek::Core::Repository::DatabaseConnectionPool;
+using Etrek::Core::Data::Model::DatabaseConnectionSetting;
+using Etrek::ScanProtocol::Repository::ScanProtocolRepository;
+using Etrek::ScanProtocol::Repository::ScanProtocolSnapshotStore;
+using Etrek::ScanProtocol::Data::Entity::Procedure;
+using Etrek::ScanProtocol::Data::Entity::ScanProtocolCatalog;
+
+// Compares building the protocol tree with the per-procedure readers (N+1 queries)
+// against ScanProtocolRepository::loadCatalog(), on a catalog grown with scratch rows.
+// The scratch rows are committed, because the loader reads on its own connection,
+// and removed again in cleanupTestCase. The readers only use the catalog snapshot in
+// test_ReadersUseCurrentSnapshot, which leaves it stale again for the benchmark.
+class ScanProtocolCatalogTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ScanProtocolCatalogTest(QObject* parent = nullptr) : QObject(parent) {}
+
+private:
+    std::shared_ptr<DatabaseConnectionSetting> connectionSetting;
+    std::unique_ptr<ScanProtocolRepository> repository;
+
+    static constexpr int SCRATCH_VIEWS = 5000;
+    static constexpr int SCRATCH_PROCEDURES = 500;
+    static constexpr const char* SCRATCH_MARK = "catalog benchmark";
+
+    bool exec(QSqlQuery& query, const QString& sql) {
+        if (query.exec(sql))
+            return true;
+        qWarning() << sql << query.lastError().text();
+        return false;
+    }
+
+    void removeScratchRows() {
+        auto lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+        QSqlQuery query(lease.database());
+        // procedure_views and view_techniques follow by ON DELETE CASCADE
+        exec(query, QString("DELETE FROM procedures WHERE code_meaning = '%1'").arg(SCRATCH_MARK));
+        exec(query, QString("DELETE FROM views WHERE description = '%1'").arg(SCRATCH_MARK));
+    }
+
+    // The protocol tree as the configuration pages assembled it before loadCatalog()
+    bool buildWithPerProcedureQueries(QVector<Procedure>& procedures) {
+        auto allProcedures = repository->getAllProcedures();
+        auto views = repository->getAllViews();
+        auto techniques = repository->getAllTechniqueParameters();
+        if (!allProcedures.isSuccess || !views.isSuccess || !techniques.isSuccess)
+            return false;
+
+        procedures = allProcedures.value;
+        for (Procedure& procedure : procedures) {
+            auto procedureViews = repository->getViewsForProcedure(procedure.Id);
+            if (!procedureViews.isSuccess)
+                return false;
+            procedure.Views = procedureViews.value;
+        }
+        return true;
+    }
+
+private slots:
+    void initTestCase() {
+        connectionSetting = std::make_shared<DatabaseConnectionSetting>();
+        connectionSetting->setHostName("localhost");
+        connectionSetting->setDatabaseName("etrekdb");
+        connectionSetting->setEtrektUserName("root");
+        connectionSetting->setPassword("Trt123Tst!)");
+        connectionSetting->setPort(3306);
+        connectionSetting->setIsPasswordEncrypted(false);
+
+        repository = std::make_unique<ScanProtocolRepository>(connectionSetting);
+
+        removeScratchRows();
+
+        auto lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+        QVERIFY(lease.isValid());
+        QSqlQuery query(lease.database());
+
+        QVERIFY(exec(query, "SET SESSION cte_max_recursion_depth = 100000"));
+        QVERIFY(exec(query, "SELECT MIN(id) FROM body_parts") && query.next());
+        const int bodyPartId = query.value(0).toInt();
+        QVERIFY(exec(query, QString("SELECT MIN(id) FROM technique_parameters WHERE body_part_id = %1").arg(bodyPartId)) && query.next());
+        const QVariant techniqueId = query.value(0);
+        QVERIFY(!techniqueId.isNull());
+
+        QVERIFY(lease.transaction());
+        QVERIFY(exec(query, QString(R"(
+            INSERT INTO views (name, description, body_part_id, projection_profile, is_active)
+            WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < %1)
+            SELECT CONCAT('bench-', i), '%2', %3, 'AP|PA', TRUE FROM n
+        )").arg(SCRATCH_VIEWS).arg(SCRATCH_MARK).arg(bodyPartId)));
+        QVERIFY(exec(query, QString(R"(
+            INSERT INTO view_techniques (view_id, technique_parameter_id, seq, role)
+            SELECT id, %1, 1, 'PRIMARY' FROM views WHERE description = '%2'
+        )").arg(techniqueId.toInt()).arg(SCRATCH_MARK)));
+        QVERIFY(exec(query, QString(R"(
+            INSERT INTO procedures (name, code_meaning, is_active)
+            WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < %1)
+            SELECT CONCAT('bench-procedure-', i), '%2', TRUE FROM n
+        )").arg(SCRATCH_PROCEDURES).arg(SCRATCH_MARK)));
+        QVERIFY(exec(query, QString(R"(
+            INSERT INTO procedure_views (procedure_id, view_id)
+            SELECT p.id, v.id
+            FROM procedures p
+            JOIN views v ON v.description = '%1' AND MOD(v.id, %2) = MOD(p.id, %2)
+            WHERE p.code_meaning = '%1'
+        )").arg(SCRATCH_MARK).arg(SCRATCH_PROCEDURES)));
+        QVERIFY(lease.commit());
+    }
+
+    void cleanupTestCase() {
+        removeScratchRows();
+    }
+
+    void test_CatalogMatchesPerProcedureReaders() {
+        QVector<Procedure> expected;
+        QVERIFY(buildWithPerProcedureQueries(expected));
+
+        auto catalog = repository->loadCatalog();
+        QVERIFY2(catalog.isSuccess, qPrintable(catalog.message));
+        QCOMPARE(catalog.value.Procedures.size(), expected.size());
+
+        for (int i = 0; i < expected.size(); ++i) {
+            const Procedure& loaded = catalog.value.Procedures[i];
+            QCOMPARE(loaded.Id, expected[i].Id);
+            QCOMPARE(loaded.Views.size(), expected[i].Views.size());
+            for (int v = 0; v < loaded.Views.size(); ++v)
+                QCOMPARE(loaded.Views[v].Id, expected[i].Views[v].Id);
+        }
+
+        for (const auto& view : catalog.value.Views) {
+            if (view.Description != SCRATCH_MARK)
+                continue;
+            QVERIFY(catalog.value.techniqueForView(view.Id, Etrek::ScanProtocol::TechniqueParameterRole::Primary) != nullptr);
+        }
+    }
+
+    void test_ReadersUseCurrentSnapshot() {
+        auto snapshot = repository->refreshCatalogSnapshot();
+        QVERIFY2(snapshot.isSuccess, qPrintable(snapshot.message));
+
+        // Rows written behind the repository's back are not seen while the snapshot is current
+        auto lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+        QSqlQuery query(lease.database());
+        QVERIFY(exec(query, QString("SELECT MIN(id) FROM procedures WHERE code_meaning = '%1'").arg(SCRATCH_MARK)) && query.next());
+        const int procedureId = query.value(0).toInt();
+        QVERIFY(exec(query, QString("DELETE FROM procedure_views WHERE procedure_id = %1").arg(procedureId)));
+
+        const Procedure* cached = snapshot.value->findProcedure(procedureId);
+        QVERIFY(cached && !cached->Views.isEmpty());
+        auto views = repository->getViewsForProcedure(procedureId);
+        QVERIFY(views.isSuccess);
+        QCOMPARE(views.value.size(), cached->Views.size());
+        auto procedure = repository->getProcedureById(procedureId);
+        QVERIFY(procedure.isSuccess);
+        QCOMPARE(procedure.value.Name, cached->Name);
+
+        // A stale snapshot is not served
+        ScanProtocolSnapshotStore::forDatabase(*connectionSetting)->markChanged();
+        views = repository->getViewsForProcedure(procedureId);
+        QVERIFY(views.isSuccess);
+        QVERIFY(views.value.isEmpty());
+    }
+
+    void benchmark_BuildProtocolTree_data() {
+        QTest::addColumn<bool>("catalog");
+        QTest::newRow("per-procedure queries") << false;
+        QTest::newRow("loadCatalog") << true;
+    }
+
+    void benchmark_BuildProtocolTree() {
+        QFETCH(bool, catalog);
+
+        QElapsedTimer timer;
+        qint64 elapsedNs = 0;
+        int iterations = 0;
+        int views = 0;
+
+        QBENCHMARK {
+            timer.start();
+            if (catalog) {
+                auto result = repository->loadCatalog();
+                QVERIFY(result.isSuccess);
+                views = result.value.Views.size();
+            } else {
+                QVector<Procedure> procedures;
+                QVERIFY(buildWithPerProcedureQueries(procedures));
+                views = 0;
+                for (const Procedure& procedure : procedures)
+                    views += procedure.Views.size();
+            }
+            elapsedNs += timer.nsecsElapsed();
+            ++iterations;
+        }
+
+        qDebug().noquote() << QString("%1: %2 views, %3 ms per build")
+            .arg(QTest::currentDataTag()).arg(views).arg(elapsedNs / 1e6 / qMax(iterations, 1), 0, 'f', 2);
+    }
+};
+
+QTEST_APPLESS_MAIN(ScanProtocolCatalogTest)
+#include "tst_ScanProtocolCatalog.moc"
@@ -0,0 +1,232 @@
+#include <QObject>
+#include <QTest>
+#include <QDebug>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QSqlError>
+#include "DatabaseConnectionPool.h"
+#include "SchemaMigrationRunner.h"
+#include "DatabaseConnectionSetting.h"
+
+using Etrek::Core::Repository::DatabaseConnectionPool;
+using Etrek::Core::Repository::ConnectionLease;
+using Etrek::Core::Repository::SchemaMigration;
+using Etrek::Core::Repository::SchemaMigrationRunner;
+using Etrek::Core::Data::Model::DatabaseConnectionSetting;
+
+// Checks the bookkeeping of the migration runner and measures the worklist queries the
+// migrations index, with the index ignored (before) and used (after).
+class SchemaMigrationRunnerTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SchemaMigrationRunnerTest(QObject* parent = nullptr) : QObject(parent) {}
+
+private:
+    std::shared_ptr<DatabaseConnectionSetting> connectionSetting;
+    QTemporaryDir scriptDir;
+
+    // Scratch versions far above the shipped ones; removed again in cleanupTestCase
+    static constexpr int SCRATCH_VERSION = 900001;
+
+    QString writeScript(const QString& name, const QByteArray& content) {
+        const QString path = scriptDir.filePath(name);
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            return QString();
+        file.write(content);
+        return path;
+    }
+
+    QString appliedChecksum(ConnectionLease& lease, int version) {
+        QSqlQuery query(lease.database());
+        query.prepare("SELECT checksum FROM schema_migrations WHERE version = ?");
+        query.addBindValue(version);
+        if (!query.exec() || !query.next())
+            return QString();
+        return query.value(0).toString();
+    }
+
+    // Prints the plan MySQL picks for the query, e.g. "ref idx_mwl_attributes_entry_tag rows=12"
+    void reportPlan(ConnectionLease& lease, const char* label, const QString& sql) {
+        QSqlQuery query(lease.database());
+        if (!query.exec("EXPLAIN " + sql)) {
+            qDebug() << label << query.lastError().text();
+            return;
+        }
+        while (query.next()) {
+            const QSqlRecord record = query.record();
+            qDebug().noquote() << QString("%1: table=%2 type=%3 key=%4 rows=%5 extra=%6")
+                .arg(label,
+                     record.value("table").toString(),
+                     record.value("type").toString(),
+                     record.value("key").toString(),
+                     record.value("rows").toString(),
+                     record.value("Extra").toString());
+        }
+    }
+
+private slots:
+    void initTestCase() {
+        connectionSetting = std::make_shared<DatabaseConnectionSetting>();
+        connectionSetting->setHostName("localhost");
+        connectionSetting->setDatabaseName("etrekdb");
+        connectionSetting->setEtrektUserName("root");
+        connectionSetting->setPassword("Trt123Tst!)");
+        connectionSetting->setPort(3306);
+        connectionSetting->setIsPasswordEncrypted(false);
+
+        QVERIFY(scriptDir.isValid());
+    }
+
+    void cleanupTestCase() {
+        auto lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+        QSqlQuery query(lease.database());
+        query.prepare("DELETE FROM schema_migrations WHERE version >= ?");
+        query.addBindValue(SCRATCH_VERSION);
+        query.exec();
+    }
+
+    void test_ShippedMigrationsAreOrdered() {
+        const QList<SchemaMigration> migrations = SchemaMigrationRunner::migrations();
+        QVERIFY(!migrations.isEmpty());
+        for (int i = 1; i < migrations.size(); ++i)
+            QVERIFY(migrations[i - 1].Version < migrations[i].Version);
+    }
+
+    void test_SecondRunAppliesNothing() {
+        auto lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+        QVERIFY(lease.isValid());
+
+        const QString script = writeScript("scratch.sql", "SELECT 1;\n");
+        QVERIFY(!script.isEmpty());
+        const QList<SchemaMigration> migrations = { { SCRATCH_VERSION, "scratch", script, QString() } };
+
+        SchemaMigrationRunner runner(lease.database());
+
+        auto first = runner.run(migrations);
+        QVERIFY2(first.isSuccess, qPrintable(first.message));
+        QCOMPARE(first.value, 1);
+        QCOMPARE(appliedChecksum(lease, SCRATCH_VERSION), SchemaMigrationRunner::checksumOf("SELECT 1;\n"));
+
+        auto second = runner.run(migrations);
+        QVERIFY2(second.isSuccess, qPrintable(second.message));
+        QCOMPARE(second.value, 0);
+    }
+
+    void test_PresentChangeIsBaselined() {
+        auto lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+        QVERIFY(lease.isValid());
+
+        // The script would fail if executed; the presence check must prevent that
+        const QString script = writeScript("baselined.sql", "THIS IS NOT SQL;\n");
+        const QList<SchemaMigration> migrations = {
+            { SCRATCH_VERSION + 1, "baselined", script, "SELECT COUNT(*) FROM information_schema.TABLES WHERE TABLE_SCHEMA = DATABASE() AND TABLE_NAME = 'mwl_entries'" }
+        };
+
+        SchemaMigrationRunner runner(lease.database());
+        auto result = runner.run(migrations);
+        QVERIFY2(result.isSuccess, qPrintable(result.message));
+        QCOMPARE(result.value, 0);
+        QVERIFY(!appliedChecksum(lease, SCRATCH_VERSION + 1).isEmpty());
+    }
+
+    void test_ChangedScriptIsNotRerun() {
+        auto lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+        QVERIFY(lease.isValid());
+
+        const QString script = writeScript("changed.sql", "SELECT 1;\n");
+        const QList<SchemaMigration> migrations = { { SCRATCH_VERSION + 2, "changed", script, QString() } };
+
+        SchemaMigrationRunner runner(lease.database());
+        QCOMPARE(runner.run(migrations).value, 1);
+
+        writeScript("changed.sql", "SELECT 2;\n");
+        auto rerun = runner.run(migrations);
+        QVERIFY2(rerun.isSuccess, qPrintable(rerun.message));
+        QCOMPARE(rerun.value, 0);
+        QCOMPARE(appliedChecksum(lease, SCRATCH_VERSION + 2), SchemaMigrationRunner::checksumOf("SELECT 1;\n"));
+    }
+
+    // Scripts that guard their DDL must run again where the change is already in place, as after
+    // an interrupted run: the backfill migrations without a presence query, and 0001.
+    void test_RepeatableMigrationsRunAgain() {
+        auto lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+        QVERIFY(lease.isValid());
+
+        QList<SchemaMigration> migrations;
+        for (const SchemaMigration& shipped : SchemaMigrationRunner::migrations()) {
+            const bool repeatable = shipped.PresenceQuery.isEmpty() || shipped.Version == 1;
+            if (!repeatable)
+                continue;
+            if (!QFile::exists(shipped.ScriptPath))
+                QSKIP("Migration scripts are not compiled into the test");
+            migrations.append({ SCRATCH_VERSION + 10 + shipped.Version, shipped.Name, shipped.ScriptPath, QString() });
+        }
+        QVERIFY(!migrations.isEmpty());
+
+        SchemaMigrationRunner runner(lease.database());
+        auto result = runner.run(migrations);
+        QVERIFY2(result.isSuccess, qPrintable(result.message));
+        QCOMPARE(result.value, migrations.size());
+    }
+
+    // Queries issued by WorklistRepository, with the index added by a migration ignored and used.
+    void benchmark_IndexedQueries_data() {
+        QTest::addColumn<QString>("sql");
+        QTest::addColumn<QString>("ignoredIndex");
+
+        const QString attributes = R"(
+            SELECT a.id, a.mwl_entry_id, a.dicom_tag_id, a.tag_value FROM mwl_attributes a %1
+            WHERE a.mwl_entry_id IN (SELECT id FROM (SELECT id FROM mwl_entries ORDER BY id DESC LIMIT 500) recent)
+        )";
+        const QString identifier = R"(
+            SELECT a.mwl_entry_id FROM mwl_attributes a %1
+            WHERE a.dicom_tag_id = (SELECT id FROM dicom_tags WHERE name = 'PatientID') AND a.tag_value = 'P-000001'
+        )";
+        const QString profileStatus = R"(
+            SELECT id FROM mwl_entries %1 WHERE profile_id = 1 AND status = 'PENDING'
+        )";
+        const QString sourcePage = R"(
+            SELECT id FROM mwl_entries %1 WHERE source = 'RIS' AND created_at >= NOW() - INTERVAL 7 DAY
+        )";
+        const QString keysetPage = R"(
+            SELECT id, display_patient_name FROM mwl_entries %1
+            ORDER BY created_at DESC, id DESC LIMIT 201
+        )";
+
+        auto addRows = [](const char* name, const QString& sql, const QString& index) {
+            QTest::newRow(qPrintable(QString("%1/before").arg(name))) << sql.arg(QString("IGNORE INDEX (%1)").arg(index)) << index;
+            QTest::newRow(qPrintable(QString("%1/after").arg(name))) << sql.arg(QString()) << index;
+        };
+
+        addRows("attributes-by-entry", attributes, "idx_mwl_attributes_entry_tag");
+        addRows("identifier-lookup", identifier, "idx_mwl_attributes_tag_value");
+        addRows("profile-status", profileStatus, "idx_mwl_entries_profile_status");
+        addRows("source-created-at", sourcePage, "idx_mwl_entries_source_created_at");
+        addRows("keyset-page", keysetPage, "idx_mwl_entries_created_at_id");
+    }
+
+    void benchmark_IndexedQueries() {
+        QFETCH(QString, sql);
+
+        auto lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+        QVERIFY(lease.isValid());
+
+        reportPlan(lease, QTest::currentDataTag(), sql);
+
+        QSqlQuery query(lease.database());
+        query.setForwardOnly(true);
+        QBENCHMARK {
+            QVERIFY2(query.exec(sql), qPrintable(query.lastError().text()));
+            while (query.next()) {}
+        }
+    }
+};
+
+QTEST_APPLESS_MAIN(SchemaMigrationRunnerTest)
+#include "tst_SchemaMigrationRunner.moc"
@@ -0,0 +1,78 @@
+#include <QObject>
+#include <QTest>
+#include "SqlScriptParser.h"
+
+using Etrek::Core::Repository::SqlScriptParser;
+
+// Statement splitting and INSERT inspection used by the setup script and the seed loader.
+class SqlScriptParserTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SqlScriptParserTest(QObject* parent = nullptr) : QObject(parent) {}
+
+private slots:
+    void test_SplitKeepsSemicolonsInsideStrings() {
+        const QString script = R"(
+            -- positioners; with a comment
+            INSERT INTO positioners (position_name, description)
+            VALUES ('Head AP', 'occiput to detector; CR; SID ~100 cm');
+            /* block; comment */
+            SELECT 'it''s; fine', "double; quoted", `odd;name`;
+        )";
+
+        const QStringList statements = SqlScriptParser::splitStatements(script);
+        QCOMPARE(statements.size(), 2);
+        QVERIFY(statements[0].endsWith("'occiput to detector; CR; SID ~100 cm')"));
+        QVERIFY(statements[1].startsWith("SELECT 'it''s; fine'"));
+        QVERIFY(!statements[0].contains("comment"));
+    }
+
+    void test_SplitHandlesBackslashEscapes() {
+        const QStringList statements = SqlScriptParser::splitStatements(
+            "CREATE TABLE t (f ENUM('STANDARD\\1,1','a\\';b'));SELECT 1");
+        QCOMPARE(statements.size(), 2);
+        QCOMPARE(statements[1], QString("SELECT 1"));
+    }
+
+    void test_SplitKeepsTriggerBodyTogether() {
+        const QStringList statements = SqlScriptParser::splitStatements(R"(
+            CREATE TRIGGER trg AFTER UPDATE OF status ON t
+            WHEN OLD.flag = 0
+            BEGIN
+                UPDATE t SET flag = 2 WHERE id = NEW.id;
+                UPDATE t SET updated = 1 WHERE id = NEW.id;
+            END;
+            SELECT 1;
+        )");
+        QCOMPARE(statements.size(), 2);
+        QVERIFY(statements[0].startsWith("CREATE TRIGGER trg"));
+        QVERIFY(statements[0].endsWith("END"));
+        QCOMPARE(statements[1], QString("SELECT 1"));
+    }
+
+    void test_InsertTable() {
+        QCOMPARE(SqlScriptParser::insertTable("INSERT INTO body_parts (name) VALUES ('HEAD')"), QString("body_parts"));
+        QCOMPARE(SqlScriptParser::insertTable("insert ignore into `views` SELECT 1"), QString("views"));
+        QVERIFY(SqlScriptParser::insertTable("CREATE TABLE views (id INT)").isEmpty());
+    }
+
+    void test_SplitValuesInsert() {
+        QString head;
+        QString rows;
+        QVERIFY(SqlScriptParser::splitValuesInsert(
+            "INSERT INTO views (name, body_part_id) VALUES ('AP', (SELECT id FROM body_parts WHERE name='HEAD')), ('PA', 2)",
+            &head, &rows));
+        QCOMPARE(head, QString("INSERT INTO views (name, body_part_id) VALUES"));
+        QCOMPARE(rows, QString("('AP', (SELECT id FROM body_parts WHERE name='HEAD')), ('PA', 2)"));
+
+        QVERIFY(!SqlScriptParser::splitValuesInsert(
+            "INSERT INTO mwl_profiles (name) VALUES ('DxWorklist') ON DUPLICATE KEY UPDATE name = name", &head, &rows));
+        QVERIFY(!SqlScriptParser::splitValuesInsert(
+            "INSERT INTO view_techniques (view_id, technique_parameter_id) SELECT v.id, t.id FROM views v, technique_parameters t", &head, &rows));
+    }
+};
+
+QTEST_APPLESS_MAIN(SqlScriptParserTest)
+#include "tst_SqlScriptParser.moc"
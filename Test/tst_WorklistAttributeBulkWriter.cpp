@@ -0,0 +1,183 @@
+#include <QObject>
+#include <QTest>
+#include <QDebug>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include "DatabaseConnectionPool.h"
+#include "DatabaseSetupManager.h"
+#include "BulkInsertWriter.h"
+#include "DatabaseConnectionSetting.h"
+
+using Etrek::Core::Repository::DatabaseConnectionPool;
+using Etrek::Core::Repository::DatabaseSetupManager;
+using Etrek::Core::Repository::ConnectionLease;
+using Etrek::Core::Repository::BulkInsertWriter;
+using Etrek::Core::Data::Model::DatabaseConnectionSetting;
+using Etrek::Core::Data::Model::StorageBackend;
+
+// Compares one INSERT per attribute with the multi-row writer on mwl_attributes, on MySQL and
+// on a fresh SQLite store. Every run happens inside a transaction that is rolled back, so the
+// database is left untouched.
+class WorklistAttributeBulkWriterTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit WorklistAttributeBulkWriterTest(QObject* parent = nullptr) : QObject(parent) {}
+
+private:
+    std::shared_ptr<DatabaseConnectionSetting> mysqlSetting;
+    std::shared_ptr<DatabaseConnectionSetting> sqliteSetting;
+    std::shared_ptr<DatabaseConnectionSetting> connectionSetting;  // backend of the current data row
+    QTemporaryDir storeDir;
+
+    // Creates a scratch worklist entry inside the current transaction
+    int insertScratchEntry(ConnectionLease& lease) {
+        QSqlQuery query(lease.database());
+        query.prepare(R"(
+            INSERT INTO mwl_entries (source, profile_id, status, created_at, updated_at)
+            VALUES ('LOCAL', 1, 'PENDING', :now, :now)
+        )");
+        query.bindValue(":now", QDateTime::currentDateTime());
+        if (!query.exec())
+            return -1;
+        return query.lastInsertId().toInt();
+    }
+
+    int firstTagId(ConnectionLease& lease) {
+        QSqlQuery query(lease.database());
+        if (!query.exec("SELECT MIN(id) FROM dicom_tags") || !query.next())
+            return -1;
+        return query.value(0).toInt();
+    }
+
+    void reportRowsPerSecond(const char* label, int rows, qint64 elapsedNs) {
+        const double seconds = qMax<qint64>(elapsedNs, 1) / 1e9;
+        qDebug().noquote() << QString("%1: %2 rows in %3 ms (%4 rows/sec)")
+            .arg(label).arg(rows).arg(elapsedNs / 1e6, 0, 'f', 2).arg(rows / seconds, 0, 'f', 0);
+    }
+
+private slots:
+    void initTestCase_data() {
+        QTest::addColumn<bool>("sqlite");
+        QTest::newRow("mysql") << false;
+        QTest::newRow("sqlite") << true;
+    }
+
+    void initTestCase() {
+        mysqlSetting = std::make_shared<DatabaseConnectionSetting>();
+        mysqlSetting->setHostName("localhost");
+        mysqlSetting->setDatabaseName("etrekdb");
+        mysqlSetting->setEtrektUserName("root");
+        mysqlSetting->setPassword("Trt123Tst!)");
+        mysqlSetting->setPort(3306);
+        mysqlSetting->setIsPasswordEncrypted(false);
+
+        QVERIFY(storeDir.isValid());
+        sqliteSetting = std::make_shared<DatabaseConnectionSetting>();
+        sqliteSetting->setStorageBackend(StorageBackend::Sqlite);
+        sqliteSetting->setDatabaseName(storeDir.filePath("etrek_store.db"));
+
+        auto setup = DatabaseSetupManager(sqliteSetting).initializeDatabase();
+        QVERIFY2(setup.isSuccess, qPrintable(setup.message));
+    }
+
+    void init() {
+        QFETCH_GLOBAL(bool, sqlite);
+        connectionSetting = sqlite ? sqliteSetting : mysqlSetting;
+    }
+
+    void cleanupTestCase() {}
+
+    void test_WriterInsertsAllRowsWithIds() {
+        auto lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+        QVERIFY(lease.isValid());
+        QVERIFY(lease.transaction());
+
+        const int entryId = insertScratchEntry(lease);
+        const int tagId = firstTagId(lease);
+        QVERIFY(entryId > 0);
+        QVERIFY(tagId > 0);
+
+        BulkInsertWriter writer(lease, "mwl_attributes", { "mwl_entry_id", "dicom_tag_id", "tag_value" });
+        writer.setCollectGeneratedIds(true);
+        for (int i = 0; i < 2000; ++i)
+            writer.addRow({ entryId, tagId, QString("value %1").arg(i) });
+
+        QVERIFY(writer.flush());
+        QCOMPARE(writer.rowsWritten(), 2000);
+        QCOMPARE(writer.generatedIds().size(), 2000);
+        QCOMPARE(writer.pendingRowCount(), 0);
+
+        QSqlQuery count(lease.database());
+        count.prepare("SELECT COUNT(*), MIN(id), MAX(id) FROM mwl_attributes WHERE mwl_entry_id = ?");
+        count.addBindValue(entryId);
+        QVERIFY(count.exec() && count.next());
+        QCOMPARE(count.value(0).toInt(), 2000);
+        QCOMPARE(count.value(1).toLongLong(), writer.generatedIds().first());
+        QCOMPARE(count.value(2).toLongLong(), writer.generatedIds().last());
+
+        lease.rollback();
+    }
+
+    void benchmark_AttributeInsert_data() {
+        QTest::addColumn<bool>("bulk");
+        QTest::addColumn<int>("rows");
+
+        for (int rows : { 100, 1000, 10000 }) {
+            QTest::newRow(qPrintable(QString("row-by-row/%1").arg(rows))) << false << rows;
+            QTest::newRow(qPrintable(QString("bulk/%1").arg(rows))) << true << rows;
+        }
+    }
+
+    void benchmark_AttributeInsert() {
+        QFETCH(bool, bulk);
+        QFETCH(int, rows);
+
+        auto lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+        QVERIFY(lease.isValid());
+        QVERIFY(lease.transaction());
+
+        const int entryId = insertScratchEntry(lease);
+        const int tagId = firstTagId(lease);
+        QVERIFY(entryId > 0);
+        QVERIFY(tagId > 0);
+
+        QElapsedTimer timer;
+        qint64 elapsedNs = 0;
+        int iterations = 0;
+
+        QBENCHMARK {
+            timer.start();
+            if (bulk) {
+                BulkInsertWriter writer(lease, "mwl_attributes", { "mwl_entry_id", "dicom_tag_id", "tag_value" });
+                for (int i = 0; i < rows; ++i)
+                    writer.addRow({ entryId, tagId, QString("value %1").arg(i) });
+                QVERIFY(writer.flush());
+            } else {
+                QSqlQuery& query = lease.prepare(R"(
+                    INSERT INTO mwl_attributes (mwl_entry_id, dicom_tag_id, tag_value)
+                    VALUES (:entryId, :tagId, :value)
+                )");
+                for (int i = 0; i < rows; ++i) {
+                    query.bindValue(":entryId", entryId);
+                    query.bindValue(":tagId", tagId);
+                    query.bindValue(":value", QString("value %1").arg(i));
+                    QVERIFY(query.exec());
+                }
+            }
+            elapsedNs += timer.nsecsElapsed();
+            ++iterations;
+        }
+
+        reportRowsPerSecond(QTest::currentDataTag(), rows * iterations, elapsedNs);
+        lease.rollback();
+    }
+};
+
+QTEST_APPLESS_MAIN(WorklistAttributeBulkWriterTest)
+#include "tst_WorklistAttributeBulkWriter.moc"
@@ -0,0 +1,78 @@
+#include <QObject>
+#include <QTest>
+#include "dcmtk/dcmdata/dcdeftag.h"
+#include "WorklistFindScu.h"
+
+using Etrek::Worklist::Connectivity::WorklistFindScu;
+
+// Feeds C-FIND responses to WorklistFindScu directly, without an association, to check
+// which responses reach the handler and how a cancelling handler ends the query.
+class StreamingFindScu : public WorklistFindScu
+{
+public:
+    OFBool receive(Uint16 status, bool withDataset) {
+        QRResponse response;
+        response.m_status = status;
+        if (withDataset) {
+            response.m_dataset = new DcmDataset();
+            response.m_dataset->putAndInsertString(DCM_PatientID, "SCRATCH");
+        }
+        OFBool waitForNextResponse = OFFalse;
+        handleFINDResponse(3, &response, waitForNextResponse);
+        return waitForNextResponse;
+    }
+};
+
+class WorklistFindScuTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit WorklistFindScuTest(QObject* parent = nullptr) : QObject(parent) {}
+
+private slots:
+    void test_PendingDatasetsReachHandler() {
+        StreamingFindScu scu;
+        int handled = 0;
+        scu.setResponseHandler([&handled](DcmDataset* dataset) {
+            OFString patientId;
+            if (dataset->findAndGetOFString(DCM_PatientID, patientId).good() && patientId == "SCRATCH")
+                ++handled;
+            return true;
+        });
+
+        QVERIFY(scu.receive(STATUS_FIND_Pending_MatchesAreContinuing, true));
+        QVERIFY(scu.receive(STATUS_FIND_Pending_WarningUnsupportedOptionalKeys, true));
+        QVERIFY(scu.receive(STATUS_FIND_Pending_MatchesAreContinuing, false));
+        QVERIFY(!scu.receive(STATUS_FIND_Success_MatchingIsComplete, false));
+
+        QCOMPARE(handled, 2);
+        QVERIFY(!scu.wasCancelled());
+    }
+
+    void test_HandlerCancelsQuery() {
+        StreamingFindScu scu;
+        int handled = 0;
+        scu.setResponseHandler([&handled](DcmDataset*) {
+            return ++handled < 3;
+        });
+
+        QVERIFY(scu.receive(STATUS_FIND_Pending_MatchesAreContinuing, true));
+        QVERIFY(scu.receive(STATUS_FIND_Pending_MatchesAreContinuing, true));
+
+        // Without an association the C-CANCEL cannot be sent, so the SCU stops waiting at once
+        QVERIFY(!scu.receive(STATUS_FIND_Pending_MatchesAreContinuing, true));
+        QVERIFY(scu.wasCancelled());
+
+        // Responses after the cancel are dropped
+        scu.receive(STATUS_FIND_Pending_MatchesAreContinuing, true);
+        QCOMPARE(handled, 3);
+
+        // A new handler starts a new query
+        scu.setResponseHandler([](DcmDataset*) { return true; });
+        QVERIFY(!scu.wasCancelled());
+    }
+};
+
+QTEST_APPLESS_MAIN(WorklistFindScuTest)
+#include "tst_WorklistFindScu.moc"
@@ -0,0 +1,146 @@
+#include <QObject>
+#include <QTest>
+#include "dcmtk/dcmdata/dcdeftag.h"
+#include "dcmtk/dcmdata/dcsequen.h"
+#include "WorklistQueryBuilder.h"
+#include "WorklistRefreshPlanner.h"
+
+using namespace Etrek::Worklist::Connectivity;
+using Etrek::Worklist::Data::Entity::DicomTag;
+
+// Checks the refresh windows of WorklistRefreshPlanner and the C-FIND identifier built from
+// them, without a RIS.
+class WorklistRefreshPlannerTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit WorklistRefreshPlannerTest(QObject* parent = nullptr) : QObject(parent) {}
+
+private:
+    static DicomTag tag(int id, const DcmTagKey& key, const DcmTagKey& parent = DcmTagKey(0x0000, 0x0000)) {
+        DicomTag tag;
+        tag.Id = id;
+        tag.GroupHex = key.getGroup();
+        tag.ElementHex = key.getElement();
+        tag.PgroupHex = parent.getGroup();
+        tag.PelementHex = parent.getElement();
+        tag.IsActive = true;
+        tag.IsRetired = false;
+        return tag;
+    }
+
+    static OFString spsValue(DcmDataset& query, const DcmTagKey& key) {
+        DcmItem* sps = nullptr;
+        OFString value;
+        if (query.findAndGetSequenceItem(DCM_ScheduledProcedureStepSequence, sps, 0).good() && sps)
+            sps->findAndGetOFString(key, value);
+        return value;
+    }
+
+private slots:
+    void test_FirstRefreshIsFullThenDelta() {
+        WorklistRefreshPolicy policy;
+        policy.LookaheadDays = 2;
+        policy.ReconcileIntervalMs = 60 * 60 * 1000;
+        WorklistRefreshPlanner planner(policy);
+        planner.setBaseKeys("MODALITY_AE", "DX", {});
+
+        const QDateTime start(QDate(2025, 3, 10), QTime(9, 0));
+        WorklistRefreshPlan plan = planner.next(start);
+        QVERIFY(plan.Kind == WorklistRefreshKind::Full);
+        QVERIFY(!plan.Keys.ScheduledFrom.isValid());
+        QVERIFY(!plan.Keys.ScheduledTo.isValid());
+        QCOMPARE(plan.Keys.ScheduledStationAETitle, QString("MODALITY_AE"));
+        QCOMPARE(plan.Keys.Modality, QString("DX"));
+        planner.recordSuccess(plan);
+
+        plan = planner.next(start.addSecs(5 * 60));
+        QVERIFY(plan.Kind == WorklistRefreshKind::Delta);
+        QCOMPARE(plan.Keys.ScheduledFrom, QDate(2025, 3, 10));
+        QCOMPARE(plan.Keys.ScheduledTo, QDate(2025, 3, 12));
+        planner.recordSuccess(plan);
+
+        plan = planner.next(start.addSecs(60 * 60));
+        QVERIFY(plan.Kind == WorklistRefreshKind::Full);
+    }
+
+    void test_FailedRefreshKeepsWindow() {
+        WorklistRefreshPlanner planner;
+        const QDateTime start(QDate(2025, 3, 10), QTime(23, 50));
+        planner.recordSuccess(planner.next(start));
+
+        // Not recorded: the next delta still starts on the day of the last success
+        planner.next(start.addSecs(20 * 60));
+        const WorklistRefreshPlan plan = planner.next(start.addSecs(25 * 60));
+        QVERIFY(plan.Kind == WorklistRefreshKind::Delta);
+        QCOMPARE(plan.Keys.ScheduledFrom, QDate(2025, 3, 10));
+
+        planner.reset();
+        QVERIFY(planner.next(start.addSecs(30 * 60)).Kind == WorklistRefreshKind::Full);
+    }
+
+    void test_PolicyFlagsDropKeys() {
+        WorklistRefreshPolicy policy;
+        policy.MatchStationAETitle = false;
+        policy.MatchModality = false;
+        WorklistRefreshPlanner planner(policy);
+        planner.setBaseKeys("MODALITY_AE", "DX", { { 7, "CHEST*" } });
+
+        const WorklistRefreshPlan plan = planner.next(QDateTime::currentDateTime());
+        QVERIFY(plan.Keys.ScheduledStationAETitle.isEmpty());
+        QVERIFY(plan.Keys.Modality.isEmpty());
+        QCOMPARE(plan.Keys.ConfiguredValues.value(7), QString("CHEST*"));
+    }
+
+    void test_DateRangeFormats() {
+        const QDate from(2025, 1, 1);
+        const QDate to(2025, 1, 7);
+        QCOMPARE(WorklistQueryBuilder::dateRange(from, to), QString("20250101-20250107"));
+        QCOMPARE(WorklistQueryBuilder::dateRange(from, QDate()), QString("20250101-"));
+        QCOMPARE(WorklistQueryBuilder::dateRange(QDate(), to), QString("-20250107"));
+        QCOMPARE(WorklistQueryBuilder::dateRange(from, from), QString("20250101"));
+        QVERIFY(WorklistQueryBuilder::dateRange(QDate(), QDate()).isEmpty());
+    }
+
+    void test_BuilderPutsKeysIntoScheduledStep() {
+        const QList<DicomTag> tags = {
+            tag(1, DCM_PatientName),
+            tag(2, DCM_RequestedProcedureDescription),
+            tag(3, DCM_ScheduledProcedureStepDescription, DCM_ScheduledProcedureStepSequence)
+        };
+
+        WorklistMatchingKeys keys;
+        keys.ScheduledStationAETitle = "MODALITY_AE";
+        keys.Modality = "DX";
+        keys.ScheduledFrom = QDate(2025, 3, 10);
+        keys.ScheduledTo = QDate(2025, 3, 12);
+        keys.ConfiguredValues.insert(2, "CHEST*");
+
+        auto query = WorklistQueryBuilder(tags).build(keys);
+
+        OFString value;
+        QVERIFY(query->tagExists(DCM_PatientName));
+        QVERIFY(query->findAndGetOFString(DCM_RequestedProcedureDescription, value).good());
+        QCOMPARE(QString(value.c_str()), QString("CHEST*"));
+
+        QCOMPARE(QString(spsValue(*query, DCM_ScheduledStationAETitle).c_str()), QString("MODALITY_AE"));
+        QCOMPARE(QString(spsValue(*query, DCM_Modality).c_str()), QString("DX"));
+        QCOMPARE(QString(spsValue(*query, DCM_ScheduledProcedureStepStartDate).c_str()), QString("20250310-20250312"));
+
+        // The profile's sequence tag and the matching keys share one item
+        DcmSequenceOfItems* sequence = nullptr;
+        QVERIFY(query->findAndGetSequence(DCM_ScheduledProcedureStepSequence, sequence).good());
+        QCOMPARE(static_cast<int>(sequence->card()), 1);
+        QVERIFY(sequence->getItem(0)->tagExists(DCM_ScheduledProcedureStepDescription));
+    }
+
+    void test_BuilderWithoutKeysMatchesEverything() {
+        auto query = WorklistQueryBuilder({ tag(1, DCM_PatientID) }).build();
+        QVERIFY(query->tagExists(DCM_PatientID));
+        QVERIFY(!query->tagExists(DCM_ScheduledProcedureStepSequence));
+    }
+};
+
+QTEST_APPLESS_MAIN(WorklistRefreshPlannerTest)
+#include "tst_WorklistRefreshPlanner.moc"
@@ -5,17 +5,35 @@
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QDateTime>
+#include <QHash>
 #include <QRandomGenerator>
-#include "WorklistRepository.h"
+#include <QTemporaryDir>
+#include <QTimeZone>
+#include <algorithm>
+#include "DatabaseConnectionPool.h"
+#include "DatabaseSetupManager.h"
 #include "DatabaseConnectionSetting.h"
+#include "WorklistRepository.h"
+#include "DicomRepository.h"
 #include "Result.h"
 #include "WorklistEntry.h"
 #include "DicomTag.h"
-#include <QTimeZone>
-
-using namespace Etrek::Repository;
-using namespace Etrek::Model;
 
+using Etrek::Core::Repository::DatabaseConnectionPool;
+using Etrek::Core::Repository::DatabaseSetupManager;
+using Etrek::Core::Data::Model::DatabaseConnectionSetting;
+using Etrek::Core::Data::Model::StorageBackend;
+using Etrek::Worklist::Repository::WorklistRepository;
+using Etrek::Dicom::Repository::DicomRepository;
+using Etrek::Worklist::Data::Entity::WorklistEntry;
+using Etrek::Worklist::Data::Entity::WorklistAttribute;
+using Etrek::Worklist::Data::Entity::WorklistPageCursor;
+using Etrek::Worklist::Data::Entity::DicomTag;
+
+// Checks the worklist reads and writes the application runs on both backends: entries are
+// registered as the registration dialog does or created as a RIS query does, then read,
+// updated and deleted through WorklistRepository. Runs on MySQL and on a fresh SQLite store. Scratch entries carry a
+// patient ID with SCRATCH_PREFIX and are removed again in cleanup().
 class WorklistRepositoryTest : public QObject
 {
     Q_OBJECT
@@ -24,57 +42,74 @@ public:
     explicit WorklistRepositoryTest(QObject* parent = nullptr) : QObject(parent) {}
 
 private:
-    std::shared_ptr<DatabaseConnectionSetting> connectionSetting;
+    std::shared_ptr<DatabaseConnectionSetting> mysqlSetting;
+    std::shared_ptr<DatabaseConnectionSetting> sqliteSetting;
+    std::shared_ptr<DatabaseConnectionSetting> connectionSetting;  // backend of the current data row
     std::unique_ptr<WorklistRepository> manager;
+    QTemporaryDir storeDir;
 
-    // Helper function to generate random date between years
-    QDateTime randomDateTimeBetween(int startYear, int endYear) {
-        QRandomGenerator *generator = QRandomGenerator::global();
-        int year = generator->bounded(startYear, endYear + 1);
-        int month = generator->bounded(1, 13);
-        int day = generator->bounded(1, QDate(year, month, 1).daysInMonth() + 1);
-        int hour = generator->bounded(0, 24);
-        int minute = generator->bounded(0, 60);
-        int second = generator->bounded(0, 60);
+    static constexpr auto SCRATCH_PREFIX = "WORKLIST-REPOSITORY-TEST-";
 
-        return QDateTime(QDate(year, month, day), QTime(hour, minute, second));
+    QString scratchPatientId() const {
+        return QString("%1%2").arg(SCRATCH_PREFIX).arg(QRandomGenerator::global()->bounded(1000000000));
     }
 
-    // Helper function to get tags by profile ID
-    Etrek::Specification::Result<QList<DicomTag>> getTags(int profileId) {
-        auto getTagsResult = manager->GetTagsByProfile(profileId);
-        if (!getTagsResult.isSuccess || getTagsResult.value.isEmpty()) {
-            return Etrek::Specification::Result<QList<DicomTag>>::Failure("Failed to fetch tags");
-        }
-        return getTagsResult;
+    int tagId(const QString& name) {
+        auto lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+        QSqlQuery query(lease.database());
+        query.prepare("SELECT id FROM dicom_tags WHERE name = ?");
+        query.addBindValue(name);
+        if (!query.exec() || !query.next())
+            return -1;
+        return query.value(0).toInt();
     }
 
-    // Helper function to create a worklist entry
-    WorklistEntry createWorklistEntry(const DicomTag& patientNameTag, const DicomTag& admissionIdTag) {
-        WorklistProfile profile;
-        profile.Id = 1;  // Assuming we have a profile with ID 1 in the database
-        profile.Name = "DxWorklist";
-
-        WorklistAttribute patientNameAttribute;
-        patientNameAttribute.Tag = patientNameTag;
-        patientNameAttribute.TagValue = "John Doe";
-
-        WorklistAttribute admissionIdAttribute;
-        admissionIdAttribute.Tag = admissionIdTag;
-        admissionIdAttribute.TagValue = "12345";
-
-        WorklistEntry worklist;
-        worklist.Source = Source::LOCAL;
-        worklist.Status = ProcedureStepStatus::SCHEDULED;
-        worklist.Profile = profile;
-        worklist.CreatedAt = QDateTime::currentDateTime();
-        worklist.UpdatedAt = QDateTime::currentDateTime();
-        worklist.Attributes.append(patientNameAttribute);
-        worklist.Attributes.append(admissionIdAttribute);
-
-        return worklist;
+    // Registers an entry through DicomRepository; returns its id, or -1
+    int registerEntry(const QString& patientId, const QDateTime& createdAt = QDateTime::currentDateTime()) {
+        DicomRepository repository(connectionSetting);
+
+        WorklistEntry entry;
+        entry.Source = Source::LOCAL;
+        entry.Status = ProcedureStepStatus::SCHEDULED;
+        entry.CreatedAt = createdAt;
+        if (!repository.insertWorklistEntry(entry).isSuccess)
+            return -1;
+
+        WorklistAttribute name;
+        name.Tag.Id = tagId("PatientName");
+        name.TagValue = "Scratch^Patient";
+        WorklistAttribute id;
+        id.Tag.Id = tagId("PatientID");
+        id.TagValue = patientId;
+
+        if (!repository.insertWorklistAttributes(entry.Id, { name, id }).isSuccess)
+            return -1;
+        return entry.Id;
     }
 
+    // Entry of profile 1 as a RIS query returns it; PatientID and AccessionNumber identify it
+    WorklistEntry profileEntry(const QString& patientId, const QString& accessionNumber, const QString& patientName) {
+        WorklistEntry entry;
+        entry.Profile.Id = 1;
+        entry.Source = Source::RIS;
+        entry.Status = ProcedureStepStatus::SCHEDULED;
+        entry.CreatedAt = QDateTime::currentDateTime();
+        entry.UpdatedAt = entry.CreatedAt;
+
+        const QHash<QString, QString> values = {
+            { "PatientName", patientName }, { "PatientID", patientId }, { "AccessionNumber", accessionNumber }
+        };
+        auto tagsResult = manager->getTagsByProfile(1);
+        for (const DicomTag& tag : tagsResult.value) {
+            if (!values.contains(tag.Name))
+                continue;
+            WorklistAttribute attribute;
+            attribute.Tag = tag;
+            attribute.TagValue = values.value(tag.Name);
+            entry.Attributes.append(attribute);
+        }
+        return entry;
+    }
 
     // Helper function for generating a random name for tags
     QString generateRandomTagName() {
@@ -82,118 +117,139 @@ private:
     }
 
 private slots:
+    void initTestCase_data() {
+        QTest::addColumn<bool>("sqlite");
+        QTest::newRow("mysql") << false;
+        QTest::newRow("sqlite") << true;
+    }
+
     void initTestCase() {
-        connectionSetting = std::make_shared<DatabaseConnectionSetting>();
-        connectionSetting->SetHostName("localhost");
-        connectionSetting->SetDatabaseName("etrekdb");
-        connectionSetting->SetEtrektUserName("root");
-        connectionSetting->SetPassword("Trt123Tst!)");
-        connectionSetting->SetPort(3306);
-        connectionSetting->SetIsPasswordEncrypted(false);
+        mysqlSetting = std::make_shared<DatabaseConnectionSetting>();
+        mysqlSetting->setHostName("localhost");
+        mysqlSetting->setDatabaseName("etrekdb");
+        mysqlSetting->setEtrektUserName("root");
+        mysqlSetting->setPassword("Trt123Tst!)");
+        mysqlSetting->setPort(3306);
+        mysqlSetting->setIsPasswordEncrypted(false);
+
+        QVERIFY(storeDir.isValid());
+        sqliteSetting = std::make_shared<DatabaseConnectionSetting>();
+        sqliteSetting->setStorageBackend(StorageBackend::Sqlite);
+        sqliteSetting->setDatabaseName(storeDir.filePath("etrek_store.db"));
+
+        auto setup = DatabaseSetupManager(sqliteSetting).initializeDatabase();
+        QVERIFY2(setup.isSuccess, qPrintable(setup.message));
+    }
 
+    void init() {
+        QFETCH_GLOBAL(bool, sqlite);
+        connectionSetting = sqlite ? sqliteSetting : mysqlSetting;
         manager = std::make_unique<WorklistRepository>(connectionSetting);
     }
 
-    void cleanupTestCase() {}
-
-    void test_CreateWorklist() {
-        auto getTagsResult = getTags(1);
-        QVERIFY(getTagsResult.isSuccess);
-
-        DicomTag patientNameTag = getTagsResult.value[0];  // Example, you can refine based on name
-        DicomTag admissionIdTag = getTagsResult.value[1];  // Example, you can refine based on name
-
-        // Create worklist entry
-        WorklistEntry worklist = createWorklistEntry(patientNameTag, admissionIdTag);
+    void cleanup() {
+        auto lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+        QSqlQuery query(lease.database());
+        // mwl_attributes follow by ON DELETE CASCADE
+        query.exec(QString("DELETE FROM mwl_entries WHERE display_patient_id LIKE '%1%'").arg(SCRATCH_PREFIX));
+    }
 
-        // Now, call the CreateWorklistEntry function
-        auto result = manager->CreateWorklistEntry(worklist);
+    void test_RegisteredEntryIsReadBack() {
+        const QString patientId = scratchPatientId();
+        const int entryId = registerEntry(patientId);
+        QVERIFY(entryId > 0);
+
+        auto fetchResult = manager->getWorklistEntryById(entryId);
+        QVERIFY2(fetchResult.isSuccess, qPrintable(fetchResult.message));
+        QCOMPARE(fetchResult.value.Status, ProcedureStepStatus::SCHEDULED);
+        QCOMPARE(fetchResult.value.Attributes.size(), 2);
+        QVERIFY(std::any_of(fetchResult.value.Attributes.begin(), fetchResult.value.Attributes.end(),
+                            [&patientId](const WorklistAttribute& a) { return a.Tag.Name == "PatientID" && a.TagValue == patientId; }));
+
+        // Newest first: an entry registered just now is on the first page
+        const QDateTime from = QDateTime::currentDateTime().addSecs(-60);
+        auto page = manager->getWorklistDisplayPage(WorklistPageCursor(), 50, &from);
+        QVERIFY2(page.isSuccess, qPrintable(page.message));
+        QVERIFY(std::any_of(page.value.Rows.begin(), page.value.Rows.end(),
+                            [entryId, &patientId](const auto& row) { return row.EntryId == entryId && row.PatientId == patientId; }));
+    }
 
-        // Assertions
-        QVERIFY(result.isSuccess);
+    void test_CreateWorklistEntry() {
+        const QString patientId = scratchPatientId();
+        auto result = manager->createWorklistEntry(profileEntry(patientId, "ACC-1", "Scratch^Patient"));
+        QVERIFY2(result.isSuccess, qPrintable(result.message));
         QVERIFY(result.value > 0);
+
+        auto fetchResult = manager->getWorklistEntryById(result.value);
+        QVERIFY2(fetchResult.isSuccess, qPrintable(fetchResult.message));
+        QCOMPARE(fetchResult.value.Attributes.size(), 3);
     }
 
-    void test_UpdateWorklistStatus() {
-        auto getTagsResult = getTags(1);
-        QVERIFY(getTagsResult.isSuccess);
+    void test_CreateWorklistEntry_DuplicateIdentity() {
+        const QString patientId = scratchPatientId();
+        auto first = manager->createWorklistEntry(profileEntry(patientId, "ACC-1", "Scratch^Patient"));
+        QVERIFY2(first.isSuccess, qPrintable(first.message));
 
-        DicomTag patientNameTag = getTagsResult.value[0];
-        DicomTag admissionIdTag = getTagsResult.value[1];
+        // Same identifiers, case and padding aside: resolves to the stored entry
+        auto duplicate = manager->createWorklistEntry(profileEntry(patientId.toLower() + "  ", "acc-1", "Other^Name"));
+        QVERIFY2(duplicate.isSuccess, qPrintable(duplicate.message));
+        QCOMPARE(duplicate.value, first.value);
 
-        WorklistEntry worklist = createWorklistEntry(patientNameTag, admissionIdTag);
+        // Another accession number is another entry
+        auto other = manager->createWorklistEntry(profileEntry(patientId, "ACC-2", "Scratch^Patient"));
+        QVERIFY2(other.isSuccess, qPrintable(other.message));
+        QVERIFY(other.value != first.value);
+    }
 
-        auto createResult = manager->CreateWorklistEntry(worklist);
-        QVERIFY(createResult.isSuccess);
+    void test_UpdateWorklistStatus() {
+        const int worklistId = registerEntry(scratchPatientId());
+        QVERIFY(worklistId > 0);
 
-        int worklistId = createResult.value;
         ProcedureStepStatus newStatus = ProcedureStepStatus::COMPLETED;
-        auto updateResult = manager->UpdateWorklistStatus(worklistId, newStatus);
-        QVERIFY(updateResult.isSuccess);
+        auto updateResult = manager->updateWorklistStatus(worklistId, newStatus);
+        QVERIFY2(updateResult.isSuccess, qPrintable(updateResult.message));
 
-        auto fetchResult = manager->GetWorklistEntryById(worklistId);
+        auto fetchResult = manager->getWorklistEntryById(worklistId);
         QVERIFY(fetchResult.isSuccess);
         QCOMPARE(fetchResult.value.Status, newStatus);
     }
 
     void test_DeleteWorklistEntries_ByDate() {
-        auto getTagsResult = getTags(1);
-        QVERIFY(getTagsResult.isSuccess);
-
-        DicomTag patientNameTag = getTagsResult.value[0];
-        DicomTag admissionIdTag = getTagsResult.value[1];
-
-        // Create a worklist entry with a specific CreatedAt date (1967-12-01)
-        // Create a QDateTime with a specific date and time
+        // Older than anything else in the database
         QDateTime createdAt(QDate(1967, 1, 12), QTime(12, 10, 1), QTimeZone("Europe/Istanbul"));
-        // Set the timezone for the QDateTime object (e.g., UTC)
-
-
-        WorklistEntry worklist = createWorklistEntry(patientNameTag, admissionIdTag);
-        worklist.CreatedAt = createdAt;
-
-        auto createResult = manager->CreateWorklistEntry(worklist);
-        QVERIFY(createResult.isSuccess);
+        const int entryId = registerEntry(scratchPatientId(), createdAt);
+        QVERIFY(entryId > 0);
 
-        //QDateTime deleteDate = QDateTime::currentDateTime();
-        auto deleteResult = manager->DeleteWorklistEntries(createdAt);
-        QVERIFY(deleteResult.isSuccess);
+        auto deleteResult = manager->deleteWorklistEntries(createdAt);
+        QVERIFY2(deleteResult.isSuccess, qPrintable(deleteResult.message));
 
-        auto fetchResult = manager->GetWorklistEntryById(createResult.value);
+        auto fetchResult = manager->getWorklistEntryById(entryId);
         QVERIFY(!fetchResult.isSuccess);  // Entry should be deleted
     }
 
     void test_DeleteWorklistEntries_ByIds() {
-        auto getTagsResult = getTags(1);
-        QVERIFY(getTagsResult.isSuccess);
+        const int entryId = registerEntry(scratchPatientId());
+        QVERIFY(entryId > 0);
 
-        DicomTag patientNameTag = getTagsResult.value[0];
-        DicomTag admissionIdTag = getTagsResult.value[1];
+        QList<int> entryIds = { entryId };
+        auto deleteResult = manager->deleteWorklistEntries(entryIds);
+        QVERIFY2(deleteResult.isSuccess, qPrintable(deleteResult.message));
 
-        WorklistEntry worklist = createWorklistEntry(patientNameTag, admissionIdTag);
-
-        auto createResult = manager->CreateWorklistEntry(worklist);
-        QVERIFY(createResult.isSuccess);
-
-        QList<int> entryIds = { createResult.value };
-        auto deleteResult = manager->DeleteWorklistEntries(entryIds);
-        QVERIFY(deleteResult.isSuccess);
-
-        auto fetchResult = manager->GetWorklistEntryById(createResult.value);
+        auto fetchResult = manager->getWorklistEntryById(entryId);
         QVERIFY(!fetchResult.isSuccess);  // Entry should be deleted
     }
 
     void test_AddDicomTag() {
         DicomTag tag;
         tag.Name = generateRandomTagName();
-        tag.DisplayName = "Display Name "+ tag.Name;
+        tag.DisplayName = "Display Name " + tag.Name;
         tag.GroupHex = 0x0008;
         tag.ElementHex = 0x0050;
         tag.IsActive = true;
         tag.IsRetired = false;
 
-        auto result = manager->AddDicomTag(tag);
-        QVERIFY(result.isSuccess);
+        auto result = manager->addDicomTag(tag);
+        QVERIFY2(result.isSuccess, qPrintable(result.message));
         QVERIFY(result.value > 0);
     }
 
@@ -206,14 +262,14 @@ private slots:
         tag.IsActive = true;
         tag.IsRetired = false;
 
-        auto addResult = manager->AddDicomTag(tag);
+        auto addResult = manager->addDicomTag(tag);
         QVERIFY(addResult.isSuccess);
 
         int tagId = addResult.value;
-        auto updateResult = manager->UpdateDicomTagActiveStatus(tagId, false);
-        QVERIFY(updateResult.isSuccess);
+        auto updateResult = manager->updateDicomTagActiveStatus(tagId, false);
+        QVERIFY2(updateResult.isSuccess, qPrintable(updateResult.message));
 
-        auto tagResult = manager->GetTagsByProfile(1);
+        auto tagResult = manager->getTagsByProfile(1);
         QVERIFY(tagResult.isSuccess);
         QVERIFY(std::none_of(tagResult.value.begin(), tagResult.value.end(),
                              [tagId](const DicomTag& t) { return t.Id == tagId && t.IsActive; }));
@@ -228,14 +284,14 @@ private slots:
         tag.IsActive = true;
         tag.IsRetired = false;
 
-        auto addResult = manager->AddDicomTag(tag);
+        auto addResult = manager->addDicomTag(tag);
         QVERIFY(addResult.isSuccess);
 
         int tagId = addResult.value;
-        auto updateResult = manager->UpdateDicomTagRetiredStatus(tagId, true);
-        QVERIFY(updateResult.isSuccess);
+        auto updateResult = manager->updateDicomTagRetiredStatus(tagId, true);
+        QVERIFY2(updateResult.isSuccess, qPrintable(updateResult.message));
 
-        auto tagResult = manager->GetTagsByProfile(1);
+        auto tagResult = manager->getTagsByProfile(1);
         QVERIFY(tagResult.isSuccess);
         QVERIFY(std::none_of(tagResult.value.begin(), tagResult.value.end(),
                              [tagId](const DicomTag& t) { return t.Id == tagId && t.IsRetired == false; }));
@@ -0,0 +1,312 @@
+#include <QObject>
+#include <QTest>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QTemporaryDir>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include "DatabaseConnectionPool.h"
+#include "DatabaseConnectionSetting.h"
+#include "WriteJournal.h"
+#include "JournalApplier.h"
+#include "DicomRepository.h"
+#include "DicomWriteJournal.h"
+
+using Etrek::Specification::Result;
+using Etrek::Core::Repository::DatabaseConnectionPool;
+using Etrek::Core::Repository::WriteJournal;
+using Etrek::Core::Repository::JournalApplier;
+using Etrek::Core::Repository::JournalEntryKey;
+using Etrek::Core::Repository::JournalApplyOutcome;
+using Etrek::Core::Data::Model::DatabaseConnectionSetting;
+using Etrek::Dicom::Repository::DicomRepository;
+using Etrek::Dicom::Repository::DicomWriteJournal;
+using Etrek::Dicom::Data::Entity::EntityType;
+using Etrek::Dicom::Data::Entity::WorkflowStatus;
+using Etrek::Dicom::Data::Entity::StatusTransitionSet;
+
+// Checks the write journal file format and replays journaled status transitions into MySQL.
+// An applier killed mid-stream is simulated by applying part of the journal and dropping the
+// applier before it writes its checkpoint, which is what a crash between the database commit
+// and the checkpoint leaves behind. The scratch image id stays clear of real rows (entity_status
+// has no foreign keys to the entity tables); its rows are removed again in cleanup().
+class WriteJournalTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit WriteJournalTest(QObject* parent = nullptr) : QObject(parent) {}
+
+private:
+    std::shared_ptr<DatabaseConnectionSetting> connectionSetting;
+    std::shared_ptr<DicomRepository> repository;
+    std::unique_ptr<QTemporaryDir> journalDir;
+    QStringList journalIds;
+
+    static constexpr int SCRATCH_IMAGE_ID = 1900500000;
+    static constexpr int RECORD_COUNT = 10;
+
+    QString journalPath() const {
+        return journalDir->filePath("write_journal.etj");
+    }
+
+    std::shared_ptr<WriteJournal> openJournal() {
+        auto journal = std::make_shared<WriteJournal>(journalPath());
+        if (!journal->open().isSuccess)
+            return nullptr;
+        if (!journalIds.contains(journal->journalId()))
+            journalIds << journal->journalId();
+        return journal;
+    }
+
+    // Moves the scratch image back and forth, so a record applied twice adds a history row
+    void journalTransitions(std::shared_ptr<WriteJournal> journal) {
+        DicomWriteJournal writer(journal);
+        for (int i = 0; i < RECORD_COUNT; ++i) {
+            const WorkflowStatus status = i % 2 == 0 ? WorkflowStatus::IN_PROGRESS : WorkflowStatus::PENDING;
+            QVERIFY(writer.transitionStatuses({ { EntityType::IMAGE, { SCRATCH_IMAGE_ID }, status, "journal test" } }).isSuccess);
+        }
+    }
+
+    int historyRows() {
+        auto lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+        QSqlQuery query(lease.database());
+        if (!query.exec(QString("SELECT COUNT(*) FROM entity_status WHERE entity_type = 'IMAGE' AND entity_id = %1").arg(SCRATCH_IMAGE_ID)) || !query.next()) {
+            qWarning() << query.lastError().text();
+            return -1;
+        }
+        return query.value(0).toInt();
+    }
+
+    int appliedEntries(const QString& journalId) {
+        auto lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+        QSqlQuery query(lease.database());
+        query.prepare("SELECT COUNT(*) FROM journal_applied_entries WHERE journal_id = ?");
+        query.addBindValue(journalId);
+        if (!query.exec() || !query.next())
+            return -1;
+        return query.value(0).toInt();
+    }
+
+private slots:
+    void initTestCase() {
+        connectionSetting = std::make_shared<DatabaseConnectionSetting>();
+        connectionSetting->setHostName("localhost");
+        connectionSetting->setDatabaseName("etrekdb");
+        connectionSetting->setEtrektUserName("root");
+        connectionSetting->setPassword("Trt123Tst!)");
+        connectionSetting->setPort(3306);
+        connectionSetting->setIsPasswordEncrypted(false);
+
+        repository = std::make_shared<DicomRepository>(connectionSetting);
+    }
+
+    void init() {
+        journalDir = std::make_unique<QTemporaryDir>();
+        QVERIFY(journalDir->isValid());
+    }
+
+    void cleanup() {
+        auto lease = DatabaseConnectionPool::Instance().acquire(connectionSetting);
+        QSqlQuery query(lease.database());
+        // entity_current_status follows by ON DELETE CASCADE
+        query.exec(QString("DELETE FROM entity_status WHERE entity_type = 'IMAGE' AND entity_id = %1").arg(SCRATCH_IMAGE_ID));
+        for (const QString& journalId : journalIds)
+            query.exec(QString("DELETE FROM journal_applied_entries WHERE journal_id = '%1'").arg(journalId));
+        journalIds.clear();
+    }
+
+    void test_TornTailIsDropped() {
+        {
+            auto journal = openJournal();
+            QVERIFY(journal);
+            for (int i = 0; i < 3; ++i)
+                QVERIFY(journal->append("test", QJsonObject{ { "value", i } }).isSuccess);
+        }
+
+        // A crash in the middle of the fourth append
+        QFile file(journalPath());
+        QVERIFY(file.open(QIODevice::Append));
+        file.write(QByteArray::fromHex("52454331000000ff00"));
+        file.close();
+
+        auto journal = openJournal();
+        QVERIFY(journal);
+        QCOMPARE(journal->lastSequence(), qint64(3));
+
+        auto records = journal->readAfter(0, 10);
+        QVERIFY2(records.isSuccess, qPrintable(records.message));
+        QCOMPARE(records.value.size(), 3);
+        QCOMPARE(records.value.last().Payload.value("value").toInt(), 2);
+
+        auto appended = journal->append("test", QJsonObject{ { "value", 3 } });
+        QVERIFY(appended.isSuccess);
+        QCOMPARE(appended.value, qint64(4));
+    }
+
+    void test_CompactionStartsNewJournalId() {
+        QString journalId;
+        {
+            auto journal = openJournal();
+            QVERIFY(journal);
+            journalId = journal->journalId();
+            QVERIFY(journal->append("test", QJsonObject()).isSuccess);
+            QVERIFY(journal->append("test", QJsonObject()).isSuccess);
+            QVERIFY(journal->markApplied(2).isSuccess);
+        }
+        QCOMPARE(QFileInfo(journalPath()).size(), qint64(24));
+
+        // Records after the compaction cannot collide with claims made under the old id,
+        // even without the checkpoint
+        auto journal = openJournal();
+        QVERIFY(journal);
+        QVERIFY(journal->journalId() != journalId);
+        QCOMPARE(journal->appliedSequence(), qint64(2));
+        QCOMPARE(journal->append("test", QJsonObject()).value, qint64(3));
+
+        journal->close();
+        QVERIFY(QFile::remove(journalPath() + ".checkpoint"));
+        auto withoutCheckpoint = openJournal();
+        QVERIFY(withoutCheckpoint);
+        QVERIFY(withoutCheckpoint->journalId() != journalId);
+        QCOMPARE(withoutCheckpoint->appliedSequence(), qint64(0));
+    }
+
+    void test_KilledApplierAppliesEachRecordOnce() {
+        QString journalId;
+        {
+            auto journal = openJournal();
+            QVERIFY(journal);
+            journalId = journal->journalId();
+
+            QElapsedTimer timer;
+            timer.start();
+            journalTransitions(journal);
+            qDebug().noquote() << QString("journaled %1 transitions in %2 us")
+                .arg(RECORD_COUNT).arg(timer.nsecsElapsed() / 1000);
+
+            JournalApplier applier(journal);
+            applier.setCheckpointInterval(100);
+            DicomWriteJournal::registerHandlers(applier, repository);
+
+            auto partial = applier.applyPending(6);
+            QVERIFY2(partial.isSuccess, qPrintable(partial.message));
+            QCOMPARE(partial.value, 6);
+            QCOMPARE(historyRows(), 6);
+            // Killed here: nothing was checkpointed
+        }
+
+        auto journal = openJournal();
+        QVERIFY(journal);
+        QCOMPARE(journal->journalId(), journalId);
+        QCOMPARE(journal->appliedSequence(), qint64(0));
+
+        JournalApplier applier(journal);
+        DicomWriteJournal::registerHandlers(applier, repository);
+        auto replayed = applier.applyPending();
+        QVERIFY2(replayed.isSuccess, qPrintable(replayed.message));
+        QCOMPARE(replayed.value, RECORD_COUNT);
+
+        QCOMPARE(historyRows(), RECORD_COUNT);
+        QCOMPARE(appliedEntries(journalId), RECORD_COUNT);
+        auto current = repository->getCurrentStatus(EntityType::IMAGE, SCRATCH_IMAGE_ID);
+        QVERIFY(current.isSuccess && current.value.has_value());
+        QCOMPARE(current.value->Status, WorkflowStatus::PENDING);
+
+        // Caught up: checkpointed and compacted
+        QCOMPARE(journal->appliedSequence(), qint64(RECORD_COUNT));
+        QCOMPARE(QFileInfo(journalPath()).size(), qint64(24));
+    }
+
+    void test_FailedRecordIsRetried() {
+        auto journal = openJournal();
+        QVERIFY(journal);
+        const QString journalId = journal->journalId();
+        journalTransitions(journal);
+
+        // The database goes away while the fourth record is applied
+        JournalApplier applier(journal);
+        bool failedOnce = false;
+        applier.registerHandler(DicomWriteJournal::STATUS_TRANSITION_KIND,
+            [this, &failedOnce](const JournalEntryKey& key, const QJsonObject& payload) {
+                if (key.Sequence == 4 && !failedOnce) {
+                    failedOnce = true;
+                    return Result<JournalApplyOutcome>::Failure("connection lost");
+                }
+                auto written = repository->transitionStatuses(DicomWriteJournal::transitionSetsFromPayload(payload),
+                    payload.value("transitionedBy").toInt(-1), key);
+                return written.isSuccess
+                    ? Result<JournalApplyOutcome>::Success(JournalApplyOutcome::Applied)
+                    : Result<JournalApplyOutcome>::Failure(written.message);
+            });
+
+        auto first = applier.applyPending();
+        QVERIFY(!first.isSuccess);
+        QCOMPARE(journal->appliedSequence(), qint64(3));
+        QCOMPARE(historyRows(), 3);
+
+        auto retried = applier.applyPending();
+        QVERIFY2(retried.isSuccess, qPrintable(retried.message));
+        QCOMPARE(retried.value, RECORD_COUNT - 3);
+        QCOMPARE(historyRows(), RECORD_COUNT);
+        QCOMPARE(appliedEntries(journalId), RECORD_COUNT);
+    }
+
+    void test_RejectedRecordIsSetAside() {
+        auto journal = openJournal();
+        QVERIFY(journal);
+        const QString journalId = journal->journalId();
+
+        // A disallowed transition and a kind nobody handles between two good records
+        DicomWriteJournal writer(journal);
+        QVERIFY(writer.transitionStatuses({ { EntityType::IMAGE, { SCRATCH_IMAGE_ID }, WorkflowStatus::IN_PROGRESS, "journal test" } }).isSuccess);
+        QVERIFY(writer.transitionStatuses({ { EntityType::IMAGE, { SCRATCH_IMAGE_ID }, WorkflowStatus::SCHEDULED, "journal test" } }).isSuccess);
+        QVERIFY(journal->append("test.unknown", QJsonObject()).isSuccess);
+        QVERIFY(writer.transitionStatuses({ { EntityType::IMAGE, { SCRATCH_IMAGE_ID }, WorkflowStatus::COMPLETED, "journal test" } }).isSuccess);
+
+        JournalApplier applier(journal);
+        DicomWriteJournal::registerHandlers(applier, repository);
+        auto result = applier.applyPending();
+        QVERIFY2(result.isSuccess, qPrintable(result.message));
+        QCOMPARE(result.value, 4);
+        QCOMPARE(journal->appliedSequence(), qint64(4));
+
+        QCOMPARE(historyRows(), 2);
+        QCOMPARE(appliedEntries(journalId), 2);
+        auto current = repository->getCurrentStatus(EntityType::IMAGE, SCRATCH_IMAGE_ID);
+        QVERIFY(current.isSuccess && current.value.has_value());
+        QCOMPARE(current.value->Status, WorkflowStatus::COMPLETED);
+
+        QFile rejected(journal->rejectedFilePath());
+        QVERIFY(rejected.open(QIODevice::ReadOnly));
+        const QList<QByteArray> lines = rejected.readAll().trimmed().split('\n');
+        QCOMPARE(lines.size(), 2);
+        QCOMPARE(QJsonDocument::fromJson(lines[0]).object().value("sequence").toInt(), 2);
+        QCOMPARE(QJsonDocument::fromJson(lines[1]).object().value("kind").toString(), QString("test.unknown"));
+    }
+
+    void test_ReplayedRecordCountsAsAlreadyApplied() {
+        auto journal = openJournal();
+        QVERIFY(journal);
+        journalTransitions(journal);
+
+        auto records = journal->readAfter(0, 1);
+        QVERIFY(records.isSuccess && records.value.size() == 1);
+        const JournalEntryKey key{ journal->journalId(), records.value.first().Sequence };
+        const auto sets = DicomWriteJournal::transitionSetsFromPayload(records.value.first().Payload);
+
+        JournalApplyOutcome outcome = JournalApplyOutcome::Rejected;
+        QVERIFY(repository->transitionStatuses(sets, -1, key, &outcome).isSuccess);
+        QVERIFY(outcome == JournalApplyOutcome::Applied);
+        QVERIFY(repository->transitionStatuses(sets, -1, key, &outcome).isSuccess);
+        QVERIFY(outcome == JournalApplyOutcome::AlreadyApplied);
+        QCOMPARE(historyRows(), 1);
+    }
+};
+
+QTEST_APPLESS_MAIN(WriteJournalTest)
+#include "tst_WriteJournal.moc"
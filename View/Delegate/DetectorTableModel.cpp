@@ -132,3 +132,18 @@ void DetectorTableModel::setDataSource(QVector<Detector>* data) {
 const QVector<Detector>* DetectorTableModel::dataSource() const {
     return m_data;
 }
+
+void DetectorTableModel::updateRow(const Detector& detector) {
+    if (!m_data) return;
+
+    for (int r = 0; r < m_data->size(); ++r) {
+        if ((*m_data)[r].Id != detector.Id) continue;
+        (*m_data)[r] = detector;
+        emit dataChanged(index(r, 0), index(r, columnCount() - 1));
+        return;
+    }
+
+    beginInsertRows({}, m_data->size(), m_data->size());
+    m_data->push_back(detector);
+    endInsertRows();
+}
@@ -41,6 +41,9 @@ namespace Etrek::Device::Data::Entity {
         void setDataSource(QVector<Detector>* data);
         const QVector<Detector>* dataSource() const;
 
+        // Replaces the row with the same Id (appends if new) and refreshes only that row
+        void updateRow(const Detector& detector);
+
     private:
         QVector<Detector>* m_data = nullptr; // shared with widget
     };
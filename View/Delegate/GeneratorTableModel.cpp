@@ -30,6 +30,24 @@ const QVector<Generator>& GeneratorTableModel::rows() const
     return m_rows;
 }
 
+void GeneratorTableModel::updateRow(const Generator& generator)
+{
+    Generator g = generator;
+    if (g.Output1 != 1 && g.Output1 != 2) g.Output1 = 1;
+    if (g.Output2 != 1 && g.Output2 != 2) g.Output2 = 2;
+
+    for (int r = 0; r < m_rows.size(); ++r) {
+        if (m_rows[r].Id != g.Id) continue;
+        m_rows[r] = g;
+        emit dataChanged(index(r, 0), index(r, ColCount - 1));
+        return;
+    }
+
+    beginInsertRows({}, m_rows.size(), m_rows.size());
+    m_rows.push_back(g);
+    endInsertRows();
+}
+
 int GeneratorTableModel::rowCount(const QModelIndex& parent) const
 {
     return parent.isValid() ? 0 : m_rows.size();
@@ -36,6 +36,9 @@ public:
     void setDataSource(const QVector<Etrek::Device::Data::Entity::Generator>& gens);
     const QVector<Etrek::Device::Data::Entity::Generator>& rows() const;
 
+    // Replaces the row with the same Id (appends if new) and refreshes only that row
+    void updateRow(const Etrek::Device::Data::Entity::Generator& generator);
+
     // QAbstractTableModel overrides
     int rowCount(const QModelIndex& parent = {}) const override;
     int columnCount(const QModelIndex& parent = {}) const override;
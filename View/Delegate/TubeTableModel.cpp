@@ -30,6 +30,22 @@ void TubeTableModel::setDataSource(const QVector<XRayTube>& tubes)
     endResetModel();
 }
 
+void TubeTableModel::updateRow(const XRayTube& tube)
+{
+    for (int r = 0; r < m_rows.size(); ++r) {
+        if (m_rows[r].Id != tube.Id) continue;
+        m_rows[r] = tube;
+        emit dataChanged(index(r, 0), index(r, ColCount - 1));
+        return;
+    }
+
+    beginInsertRows({}, m_rows.size(), m_rows.size());
+    m_rows.push_back(tube);
+    m_tubeOrder.push_back(0);
+    m_hasPosition.push_back(true);
+    endInsertRows();
+}
+
 int TubeTableModel::rowCount(const QModelIndex& parent) const
 {
     return parent.isValid() ? 0 : m_rows.size();
@@ -40,6 +40,10 @@ public:
     void setDataSource(const QVector<Etrek::Device::Data::Entity::XRayTube>& tubes);
     const QVector<Etrek::Device::Data::Entity::XRayTube>& rows() const { return m_rows; }
 
+    // Replaces the row with the same Id (appends if new) and refreshes only that row;
+    // the virtual TubeOrder of existing rows is kept
+    void updateRow(const Etrek::Device::Data::Entity::XRayTube& tube);
+
     // TubeOrder helpers
     int tubeOrder(int row) const;            // 0 = none, 1 = Tube 1, 2 = Tube 2
     bool setTubeOrder(int row, int v);       // enforces uniqueness
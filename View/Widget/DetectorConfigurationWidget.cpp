@@ -121,6 +121,7 @@ DetectorConfigurationWidget::DetectorConfigurationWidget(const QVector<Detector>
    // Create the model
     auto* baseModel = new DetectorTableModel(this);
     baseModel->setDataSource(&m_nodes);
+    m_model = baseModel;
 
     // Create proxy models for sorting and filtering
     auto* proxy = new QSortFilterProxyModel(this);
@@ -224,3 +225,14 @@ DetectorConfigurationWidget::~DetectorConfigurationWidget()
 {
     delete ui;
 }
+
+void DetectorConfigurationWidget::setDetectors(const QVector<Detector>& nodes)
+{
+    m_nodes = nodes;
+    m_model->setDataSource(&m_nodes);
+}
+
+void DetectorConfigurationWidget::onDetectorChanged(const Detector& detector)
+{
+    m_model->updateRow(detector);
+}
@@ -9,6 +9,10 @@ namespace Ui {
 class DetectorConfigurationWidget;
 }
 
+namespace Etrek::Device::Data::Entity {
+class DetectorTableModel;
+}
+
 class DetectorConfigurationWidget : public QWidget
 {
     Q_OBJECT
@@ -17,9 +21,17 @@ public:
     explicit DetectorConfigurationWidget(const QVector<Etrek::Device::Data::Entity::Detector>& nodes, QWidget *parent = nullptr);
     ~DetectorConfigurationWidget();
 
+    // Replaces the table (e.g., after the device registry reloaded)
+    void setDetectors(const QVector<Etrek::Device::Data::Entity::Detector>& nodes);
+
+public slots:
+    // Single-row refresh when the device registry reports a change
+    void onDetectorChanged(const Etrek::Device::Data::Entity::Detector& detector);
+
 private:
     Ui::DetectorConfigurationWidget *ui;
     QVector<Etrek::Device::Data::Entity::Detector> m_nodes;
+    Etrek::Device::Data::Entity::DetectorTableModel* m_model = nullptr;
 };
 
 #endif // DETECTORCONFIGURATIONWIDGET_H
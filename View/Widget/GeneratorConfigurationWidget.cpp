@@ -27,6 +27,7 @@ GeneratorConfigurationWidget::GeneratorConfigurationWidget(
     ui->setupUi(this);
     auto* model = new GeneratorTableModel(this);
     model->setDataSource(generators);
+    m_generatorModel = model;
 
     
       auto* view = ui->generatorTableView;
@@ -91,6 +92,7 @@ GeneratorConfigurationWidget::GeneratorConfigurationWidget(
 
       auto* tubeModel = new TubeTableModel(this);
       tubeModel->setDataSource(xRayTubes);                 // QVector<XRayTube>
+      m_tubeModel = tubeModel;
       auto* tubeView = ui->tubeTableView;
       tubeView->setModel(tubeModel);
 
@@ -163,3 +165,20 @@ GeneratorConfigurationWidget::~GeneratorConfigurationWidget()
 {
     delete ui;
 }
+
+void GeneratorConfigurationWidget::setDevices(const QVector<Generator>& generators, const QVector<XRayTube>& xRayTubes)
+{
+    allXRayTubes = xRayTubes;
+    m_generatorModel->setDataSource(generators);
+    m_tubeModel->setDataSource(xRayTubes);
+}
+
+void GeneratorConfigurationWidget::onGeneratorChanged(const Generator& generator)
+{
+    m_generatorModel->updateRow(generator);
+}
+
+void GeneratorConfigurationWidget::onXRayTubeChanged(const XRayTube& tube)
+{
+    m_tubeModel->updateRow(tube);
+}
@@ -17,6 +17,9 @@ namespace Ui {
     class GeneratorConfigurationWidget;
 }
 
+class GeneratorTableModel;
+class TubeTableModel;
+
 class GeneratorConfigurationWidget : public QWidget
 {
     Q_OBJECT
@@ -29,6 +32,14 @@ public:
     );
     ~GeneratorConfigurationWidget();
 
+    // Replaces both tables (e.g., after the device registry reloaded)
+    void setDevices(const QVector<Etrek::Device::Data::Entity::Generator>& generators,
+                    const QVector<Etrek::Device::Data::Entity::XRayTube>& xRayTubes);
+
+public slots:
+    // Single-row refresh when the device registry reports a change
+    void onGeneratorChanged(const Etrek::Device::Data::Entity::Generator& generator);
+    void onXRayTubeChanged(const Etrek::Device::Data::Entity::XRayTube& tube);
 
 private slots:
     //void onOutput1SelectionChanged(int index);
@@ -47,6 +58,8 @@ private:
     static constexpr int Tube2Id = 2;
 
     Ui::GeneratorConfigurationWidget* ui;
+    GeneratorTableModel* m_generatorModel = nullptr;
+    TubeTableModel* m_tubeModel = nullptr;
 	QVector<Etrek::Device::Data::Entity::XRayTube> allXRayTubes;  // Store all X-Ray tubes
     QVector<Etrek::Device::Data::Entity::Generator> allGenerators;  // Store all generators
 
@@ -1,6 +1,8 @@
 #include <QDebug>
 #include <QMetaObject>
+#include <QSet>
 #include <QTimer>
+#include <stdexcept>
 
 #include "ModalityWorklistManager.h"
 #include "RisConnectionSetting.h"
@@ -16,23 +18,44 @@ namespace Etrek::Worklist::Connectivity
     using namespace Etrek::Core::Data::Model;
     using namespace Etrek::Worklist::Repository;
     using namespace Etrek::Worklist::Data::Entity;
+    using Etrek::Specification::Result;
+
+    struct ModalityWorklistManager::RisChannel {
+        std::shared_ptr<RisConnectionSetting> Settings;
+        std::unique_ptr<WorklistQueryService> QueryService;
+        QThread* Thread = nullptr;
+        QTimer* FindTimer = nullptr;
+        bool Busy = false;  // A C-FIND is running; only touched on the manager thread
+        RisConnectionHealth Health;
+        WorklistRefreshPlanner Planner;  // Only touched on the manager thread
+    };
+
+    namespace {
+
+        QString connectionNameOf(const RisConnectionSetting& settings)
+        {
+            if (!settings.getConnectionName().isEmpty())
+                return settings.getConnectionName();
+            return QString("%1@%2:%3").arg(settings.getCalledAETitle(), settings.getHostIP()).arg(settings.getPort());
+        }
+
+    }
 
 
     ModalityWorklistManager::ModalityWorklistManager(std::shared_ptr<WorklistRepository> repository,
         std::shared_ptr<RisConnectionSetting> settings,
         QObject* parent)
+        : ModalityWorklistManager(repository, QVector<std::shared_ptr<RisConnectionSetting>>{ settings }, parent)
+    {
+    }
+
+    ModalityWorklistManager::ModalityWorklistManager(std::shared_ptr<WorklistRepository> repository,
+        const QVector<std::shared_ptr<RisConnectionSetting>>& settings,
+        QObject* parent)
         : QObject(parent),
         m_repository(repository),
-        settings(settings)
+        m_settings(settings)
     {
-        m_findTimer = new QTimer(this);
-        m_findTimer->setInterval(m_refreshPeriodMs);
-
-        m_echoTimer = new QTimer(this);
-        m_echoTimer->setInterval(30000);  // 30 seconds send ECHO message
-
-        m_findTimer = new QTimer(this);
-        m_findTimer->setInterval(m_refreshPeriodMs);
     }
 
     void ModalityWorklistManager::onAboutToCloseApplication()
@@ -47,31 +70,40 @@ namespace Etrek::Worklist::Connectivity
         qDebug() << "[INFO] ModalityWorklistManager destructor executed.";
 
         stopWorklistQueryFromRis();
+    }
 
-        if (m_queryThread) {
-            m_queryThread->deleteLater();
-            m_queryThread = nullptr;
-        }
+    void ModalityWorklistManager::setRefreshPolicy(const WorklistRefreshPolicy& policy)
+    {
+        m_refreshPolicy = policy;
+    }
+
+    void ModalityWorklistManager::setAssociationPolicy(const RisAssociationPolicy& policy)
+    {
+        m_associationPolicy = policy;
+    }
+
+    void ModalityWorklistManager::setHealthPolicy(const RisHealthPolicy& policy)
+    {
+        m_healthPolicy = policy;
     }
 
     void ModalityWorklistManager::setActiveProfile(const WorklistProfile& profile)
     {
         m_profile = profile;
 
-        prepareQueryService();  // Only sets up thread/service safely
+        prepareQueryServices();  // Only sets up threads/services safely
     }
 
     void ModalityWorklistManager::changeQueryRisServerPeriod(int period)
     {
         m_refreshPeriodMs = period;
-        if (m_findTimer) {
-            m_findTimer->setInterval(m_refreshPeriodMs);
-        }
+        for (const auto& channel : m_channels)
+            channel->FindTimer->setInterval(m_refreshPeriodMs);
     }
 
-    void ModalityWorklistManager::prepareQueryService()
+    void ModalityWorklistManager::prepareQueryServices()
     {
-        stopWorklistQueryFromRis();  // Clean previous threads & service
+        stopWorklistQueryFromRis();  // Clean previous threads & services
 
         if (m_profile.Id < 0) {
             auto result = m_repository->getProfiles();
@@ -87,129 +119,345 @@ namespace Etrek::Worklist::Connectivity
             return;
         }
 
-        m_queryService = std::make_unique<WorklistQueryService>();
-        m_queryService->setSettings(settings);
-        m_queryService->setPresentationContext(m_profile.Context);
-        m_queryService->setWorklistTags(tagResult.value);
-
-        m_queryThread = new QThread(this);
-        m_queryService->moveToThread(m_queryThread);
+        // Without configured values the query still runs, on the station, modality and date keys
+        QHash<int, QString> matchingValues;
+        auto matchingResult = m_repository->getMatchingValuesByProfile(m_profile.Id);
+        if (matchingResult.isSuccess)
+            matchingValues = matchingResult.value;
+        else
+            qDebug() << "[WARN] Failed to load matching values for profile:" << matchingResult.message;
+
+        const int generation = m_generation;
+        const WorklistProfile profile = m_profile;
+
+        for (const auto& settings : m_settings) {
+            if (!settings)
+                continue;
+
+            auto channel = std::make_unique<RisChannel>();
+            channel->Settings = settings;
+            channel->Health.ConnectionName = connectionNameOf(*settings);
+            channel->Planner = WorklistRefreshPlanner(m_refreshPolicy);
+            channel->Planner.setBaseKeys(settings->getCallingAETitle(), settings->getModality(), matchingValues);
+
+            // A connection with unusable settings is left out; the others still run
+            try {
+                channel->QueryService = std::make_unique<WorklistQueryService>();
+                channel->QueryService->setSettings(settings);
+                channel->QueryService->setPresentationContext(profile.Context);
+                channel->QueryService->setWorklistTags(tagResult.value);
+                channel->QueryService->setAssociationPolicy(m_associationPolicy);
+            }
+            catch (const std::exception& ex) {
+                qDebug() << "[ERROR] RIS connection" << channel->Health.ConnectionName << "skipped:" << ex.what();
+                continue;
+            }
 
-        // Connect the trigger only after thread is fully ready
-        connect(m_queryThread, &QThread::started, this, &ModalityWorklistManager::performWorklistQuery);
+            const int index = static_cast<int>(m_channels.size());
+
+            channel->FindTimer = new QTimer(this);
+            channel->FindTimer->setInterval(m_refreshPeriodMs);
+            connect(channel->FindTimer, &QTimer::timeout, this, [this, index]() { performWorklistQuery(index); });
+
+            channel->Thread = new QThread(this);
+            channel->QueryService->moveToThread(channel->Thread);
+
+            connect(channel->QueryService.get(), &WorklistQueryService::associationStateChanged, this,
+                [this, index, generation](RisAssociationState state, int retryInMs) {
+                    RisChannel* channel = channelAt(index, generation);
+                    if (!channel)
+                        return;
+                    channel->Health.AssociationState = state;
+                    channel->Health.RetryInMs = state == RisAssociationState::Backoff ? retryInMs : 0;
+                    emit associationStateChanged(channel->Health.ConnectionName, state, retryInMs);
+                }, Qt::QueuedConnection);
+
+            // Connect the trigger only after thread is fully ready
+            connect(channel->Thread, &QThread::started, this, [this, index, generation]() {
+                if (channelAt(index, generation))
+                    performWorklistQuery(index);
+                });
 
-        connect(this, &ModalityWorklistManager::QueryRequested, m_queryService.get(), [this]() {
-            const auto entries = m_queryService->getWorklistEntries();
-            QMetaObject::invokeMethod(this, "handleNewQueryResults", Qt::QueuedConnection,
-                Q_ARG(QList<WorklistEntry>, entries));
-            });
+            m_channels.push_back(std::move(channel));
+        }
 
+        for (const auto& channel : m_channels)
+            channel->Thread->start();
 
-        m_queryThread->start();
+        startHealthMonitor();
+    }
 
+    ModalityWorklistManager::RisChannel* ModalityWorklistManager::channelAt(int index, int generation) const
+    {
+        if (generation != m_generation || index < 0 || index >= static_cast<int>(m_channels.size()))
+            return nullptr;
+        return m_channels[index].get();
     }
 
     void ModalityWorklistManager::startWorklistQueryFromRis()
     {
-        if (!m_findTimer->isActive()) {
-            connect(m_findTimer, &QTimer::timeout, this, &ModalityWorklistManager::performWorklistQuery);
-            m_findTimer->start();
-        }
-        if (!m_echoTimer->isActive()) {
-            connect(m_echoTimer, &QTimer::timeout, this, [this]() {
-                if (!m_isFindRunning && m_queryService) {
-                    m_isFindRunning = true;  // 🔹 mark channel as busy
-                    qDebug() << "[INFO] Sending periodic C-ECHO...";
-                    m_queryService->echoRis();
-                    m_isFindRunning = false; // 🔹 release channel after echo is done
-                }
-                });
-            m_echoTimer->start();
+        for (const auto& channel : m_channels) {
+            if (!channel->FindTimer->isActive())
+                channel->FindTimer->start();
         }
-        qDebug() << "[INFO] RIS Query Timers started.";
+        if (m_echoTimer && !m_echoTimer->isActive())
+            m_echoTimer->start();
+        qDebug() << "[INFO] RIS Query Timers started for" << m_channels.size() << "connection(s).";
         // DO NOT trigger PerformWorklistQuery directly; wait for thread start signal
     }
 
     QList<WorklistEntry> ModalityWorklistManager::getEntities()
     {
-        if (m_queryService)
-            return m_queryService->getWorklistEntries();
-        return {};
+        QList<WorklistEntry> entries;
+        for (const auto& channel : m_channels) {
+            auto channelEntries = channel->QueryService->getWorklistEntries();
+            for (auto& entry : channelEntries)
+                entry.SourceConnection = channel->Health.ConnectionName;
+            entries.append(channelEntries);
+        }
+        return entries;
+    }
+
+    QVector<RisConnectionHealth> ModalityWorklistManager::connectionHealth() const
+    {
+        QVector<RisConnectionHealth> health;
+        health.reserve(static_cast<int>(m_channels.size()));
+        for (const auto& channel : m_channels)
+            health.append(channel->Health);
+        return health;
     }
 
     void ModalityWorklistManager::stopWorklistQueryFromRis()
     {
-        // Stop the periodic echo timer
-        if (m_echoTimer && m_echoTimer->isActive()) {
-            m_echoTimer->stop();
+        // Completions still queued from the old channels are dropped
+        ++m_generation;
+
+        // No echo is posted to a query service once the monitor thread has stopped
+        stopHealthMonitor();
+
+        for (const auto& channel : m_channels) {
+            // Stop the periodic timer
+            channel->FindTimer->stop();
+
+            // Gracefully stop the query thread; a running C-FIND stops after its current batch
+            if (channel->Thread->isRunning()) {
+                channel->Thread->requestInterruption();
+                channel->Thread->quit();
+                channel->Thread->wait();
+            }
+
+            // Reset the query service
+            channel->QueryService.reset();
+
+            delete channel->Thread; // Manually delete the thread object
+            delete channel->FindTimer;
+        }
+        m_channels.clear();
+
+        // Echo completions only reach the monitor from the query threads, which are gone now
+        delete m_healthMonitor;
+        m_healthMonitor = nullptr;
+        delete m_healthThread;
+        m_healthThread = nullptr;
+        delete m_echoTimer;
+        m_echoTimer = nullptr;
+    }
+
+    void ModalityWorklistManager::performWorklistQuery(int index)
+    {
+        RisChannel* channel = channelAt(index, m_generation);
+        if (!channel)
+            return;
+
+        if (channel->Busy) {
+            qDebug() << "[WARN] C-FIND skipped on" << channel->Health.ConnectionName << ": Previous request still running.";
+            return;
         }
 
-        // Stop the periodic find timer
-        if (m_findTimer && m_findTimer->isActive()) {
-            m_findTimer->stop();
+        if (!channel->Thread->isRunning()) {
+            qDebug() << "[WARN] QueryService or thread not ready.";
+            return;
         }
 
-        // Stop the query service if it's running
-        if (m_queryThread && m_queryThread->isRunning()) {
-            // Gracefully stop the query thread
-            m_queryThread->quit();
-            m_queryThread->wait();
+        if (m_healthMonitor && !m_healthPolicy.allowsQuery(m_healthMonitor->state(channel->Health.ConnectionName))) {
+            qDebug() << "[WARN] C-FIND skipped on" << channel->Health.ConnectionName << ": RIS is down and echo failures stop queries.";
+            return;
         }
 
-        // Reset the query service
-        m_queryService.reset();
+        const WorklistRefreshPlan plan = channel->Planner.next(QDateTime::currentDateTime());
+        const bool fullReconcile = plan.Kind == WorklistRefreshKind::Full;
+        qDebug() << "[INFO] Performing" << (fullReconcile ? "full" : "delta") << "RIS query on" << channel->Health.ConnectionName << "...";
+        channel->Busy = true;
+
+        // C-FIND and the database ingest both run on the query thread of the connection;
+        // only the completion is posted back. Each batch is ingested while the RIS is still
+        // sending the rest, and a stop request cancels the query.
+        const int generation = m_generation;
+        const WorklistProfile profile = m_profile;
+        const QString connectionName = channel->Health.ConnectionName;
+        WorklistQueryService* service = channel->QueryService.get();
+        QMetaObject::invokeMethod(service, [this, service, index, generation, profile, connectionName, plan, fullReconcile]() {
+            QSet<int> seenIds;
+            bool ingestFailed = false;
+            const auto result = service->streamWorklistEntries(plan.Keys, [&](const QList<WorklistEntry>& batch) {
+                auto ingest = handleNewQueryResults(batch, profile, connectionName);
+                if (!ingest.isSuccess) {
+                    ingestFailed = true;
+                }
+                else if (fullReconcile) {
+                    for (int id : ingest.value.CreatedIds) seenIds.insert(id);
+                    for (int id : ingest.value.UpdatedIds) seenIds.insert(id);
+                    for (int id : ingest.value.UnchangedIds) seenIds.insert(id);
+                }
+                return !QThread::currentThread()->isInterruptionRequested();
+                });
+
+            // Only a complete reconcile tells which pending entries the RIS no longer has
+            const bool completed = result.isSuccess && !ingestFailed && !QThread::currentThread()->isInterruptionRequested();
+            if (completed && fullReconcile) {
+                QMutexLocker locker(&m_ingestMutex);
+                auto cancelled = m_repository->cancelUnseenRisEntries(profile.Id, connectionName, seenIds);
+                if (!cancelled.isSuccess)
+                    qDebug() << "[ERROR] Failed to reconcile worklist of" << connectionName << ":" << cancelled.message;
+                else if (cancelled.value > 0)
+                    qDebug() << "[INFO]" << cancelled.value << "pending entries no longer on" << connectionName << "were cancelled.";
+            }
+
+            QMetaObject::invokeMethod(this, [this, index, generation, result, completed, plan]() {
+                RisChannel* channel = channelAt(index, generation);
+                if (!channel)
+                    return;
+                channel->Busy = false;
+                // A failed refresh keeps its window, so the next one covers the same days again
+                if (completed)
+                    channel->Planner.recordSuccess(plan);
+                recordQueryHealth(*channel, result.isSuccess, result.message);
+                if (result.isSuccess) {
+                    channel->Health.LastQueryEntries = result.value;
+                    emit worklistQueryFinished(channel->Health.ConnectionName, result.value);
+                }
+                }, Qt::QueuedConnection);
+            }, Qt::QueuedConnection);
+    }
+
+    void ModalityWorklistManager::startHealthMonitor()
+    {
+        if (m_channels.empty())
+            return;
+
+        const int generation = m_generation;
+        m_healthMonitor = new RisHealthMonitor(m_healthPolicy);
+        for (const auto& channel : m_channels)
+            m_healthMonitor->addConnection(channel->Health.ConnectionName, channel->QueryService.get());
+
+        m_healthThread = new QThread(this);
+        m_healthMonitor->moveToThread(m_healthThread);
+
+        connect(m_healthMonitor, &RisHealthMonitor::healthUpdated, this, [this, generation](const RisHealthSnapshot& snapshot) {
+            applyHealthSnapshot(snapshot, generation);
+            }, Qt::QueuedConnection);
+
+        // Echo timer stays on this thread; each tick is queued to the monitor
+        m_echoTimer = new QTimer(this);
+        m_echoTimer->setInterval(m_healthPolicy.EchoIntervalMs);
+        connect(m_echoTimer, &QTimer::timeout, m_healthMonitor, &RisHealthMonitor::probeAll);
+
+        m_healthThread->start();
+    }
+
+    void ModalityWorklistManager::stopHealthMonitor()
+    {
+        if (m_echoTimer)
+            m_echoTimer->stop();
 
-        // Clean up the query thread if it exists
-        if (m_queryThread) {
-            delete m_queryThread; // Manually delete the thread object
-            m_queryThread = nullptr;
+        if (m_healthThread && m_healthThread->isRunning()) {
+            m_healthThread->quit();
+            m_healthThread->wait();
         }
     }
 
-    void ModalityWorklistManager::performWorklistQuery()
+    void ModalityWorklistManager::applyHealthSnapshot(const RisHealthSnapshot& snapshot, int generation)
     {
-        if (m_isFindRunning) {
-            qDebug() << "[WARN] C-FIND skipped: Previous request still running.";
+        if (generation != m_generation)
+            return;
+
+        for (const auto& channel : m_channels) {
+            if (channel->Health.ConnectionName != snapshot.ConnectionName)
+                continue;
+
+            const RisHealthState previous = channel->Health.State;
+            channel->Health.State = snapshot.State;
+            channel->Health.EchoLatency = snapshot.Latency;
+            channel->Health.ConsecutiveEchoFailures = snapshot.ConsecutiveFailures;
+            if (snapshot.ConsecutiveFailures == 0)
+                channel->Health.LastSuccessAt = snapshot.LastEchoAt;
+            else {
+                channel->Health.LastError = snapshot.LastError;
+                qDebug() << "[WARN] RIS echo on" << snapshot.ConnectionName << "failed" << snapshot.ConsecutiveFailures << "time(s):" << snapshot.LastError;
+            }
+            updateHealthy(*channel);
+
+            if (snapshot.State != previous)
+                emit connectionStateChanged(snapshot.ConnectionName, snapshot.State);
             return;
         }
+    }
 
-        if (m_queryService && m_queryThread && m_queryThread->isRunning()) {
-            qDebug() << "[INFO] Performing RIS query...";
-            m_isFindRunning = true;
-            emit QueryRequested();
+    void ModalityWorklistManager::recordQueryHealth(RisChannel& channel, bool succeeded, const QString& error)
+    {
+        // Counted apart from the echoes, so a failing query never moves the echo state machine
+        RisConnectionHealth& health = channel.Health;
+        if (succeeded) {
+            health.ConsecutiveQueryFailures = 0;
+            health.LastSuccessAt = QDateTime::currentDateTime();
         }
         else {
-            qDebug() << "[WARN] QueryService or thread not ready.";
+            ++health.ConsecutiveQueryFailures;
+            health.LastError = error;
+            qDebug() << "[WARN] RIS query on" << health.ConnectionName << "failed" << health.ConsecutiveQueryFailures << "time(s):" << error;
         }
+        updateHealthy(channel);
+    }
+
+    void ModalityWorklistManager::updateHealthy(RisChannel& channel)
+    {
+        RisConnectionHealth& health = channel.Health;
+        const bool wasHealthy = health.Healthy;
+        health.Healthy = health.ConsecutiveEchoFailures == 0 && health.ConsecutiveQueryFailures == 0;
+
+        if (health.Healthy != wasHealthy)
+            emit connectionHealthChanged(health.ConnectionName, health.Healthy);
     }
 
-    void ModalityWorklistManager::handleNewQueryResults(const QList<WorklistEntry>& entries)
+    Result<WorklistIngestSummary> ModalityWorklistManager::handleNewQueryResults(const QList<WorklistEntry>& entries, const WorklistProfile& profile,
+        const QString& connectionName)
     {
-        m_isFindRunning = false;
+        if (entries.isEmpty())
+            return Result<WorklistIngestSummary>::Success(WorklistIngestSummary());
+
+        // New entries start as pending RIS entries; existing ones only get their
+        // attributes refreshed, their status and source are owned by the modality.
+        QList<WorklistEntry> remapedEntries;
+        remapedEntries.reserve(entries.size());
+        const QDateTime now = QDateTime::currentDateTime();
         for (const auto& entry : entries) {
-            auto existing = m_repository->getWorklistEntry(entry, m_profile);
-            if (!existing.isSuccess) {
-                WorklistEntry remapedEntry = entry;
-                remapedEntry.Profile = m_profile;
-                remapedEntry.Source = Source::RIS;
-                remapedEntry.Status = ProcedureStepStatus::PENDING;
-                remapedEntry.CreatedAt = QDateTime::currentDateTime();
-
-                m_repository->createWorklistEntry(remapedEntry);
-            }
-            else {
-                // TODO: this section is partially tested.
-                // It is commented out, the logic may need to be rivisited.
-                // WorklistEntry remapedEntry = entry;
-                // remapedEntry.Id = existing.value.Id;
-                // remapedEntry.Profile = existing.value.Profile;
-                // remapedEntry.Attributes = entry.Attributes; // always override the tag values with new items
-                // remapedEntry.Source = Source::RIS;  // TODO: check if always overrite the source to ris
-                // remapedEntry.Status = ProcedureStepStatus::PENDING; // TODO: check if status always should be pending
-                // remapedEntry.UpdatedAt = QDateTime::currentDateTime();
-                // m_repository->UpdateWorklistEntry(remapedEntry);
-            }
+            WorklistEntry remapedEntry = entry;
+            remapedEntry.Profile = profile;
+            remapedEntry.Source = Source::RIS;
+            remapedEntry.SourceConnection = connectionName;
+            remapedEntry.Status = ProcedureStepStatus::PENDING;
+            remapedEntry.CreatedAt = now;
+            remapedEntries.append(remapedEntry);
+        }
+
+        // Connections ingest one after the other, so the identity lookup of one ingest
+        // sees the entries created by the other and the same procedure is stored once.
+        QMutexLocker locker(&m_ingestMutex);
+        auto result = m_repository->ingestWorklistEntries(remapedEntries, profile);
+        if (!result.isSuccess) {
+            qDebug() << "[ERROR] Failed to store worklist query results from" << connectionName << ":" << result.message;
         }
+        return result;
     }
 
 }
@@ -3,11 +3,21 @@
 
 #include <QObject>
 #include <QList>
+#include <QVector>
 #include <QThread>
 #include <QTimer>
 #include <QElapsedTimer>
+#include <QDateTime>
+#include <QMutex>
+#include <memory>
+#include <vector>
 
+#include "Result.h"
 #include "WorklistProfile.h"
+#include "WorklistIngestSummary.h"
+#include "WorklistRefreshPlanner.h"
+#include "RisReconnectBackoff.h"
+#include "RisHealthMonitor.h"
 
 
 namespace Etrek::Worklist::Repository
@@ -30,6 +40,44 @@ namespace Etrek::Worklist::Connectivity
 
     class WorklistQueryService;
 
+    /**
+     * @brief Health of one RIS connection, as last seen by its C-ECHO and C-FIND.
+     */
+    struct RisConnectionHealth {
+        QString ConnectionName;
+        RisHealthState State = RisHealthState::Unknown;  ///< From the echoes of the health monitor
+        RisLatencyStats EchoLatency;
+        bool Healthy = true;            ///< False while the last echo or the last query failed
+        int ConsecutiveEchoFailures = 0;   ///< As counted by the health monitor, which alone drives State
+        int ConsecutiveQueryFailures = 0;  ///< Failed C-FINDs since the last successful one
+        QDateTime LastSuccessAt;
+        QString LastError;
+        int LastQueryEntries = 0;       ///< Entries delivered by the last successful C-FIND
+        RisAssociationState AssociationState = RisAssociationState::Disconnected;
+        int RetryInMs = 0;              ///< Delay before the next association attempt while in Backoff
+    };
+
+    /**
+     * @class ModalityWorklistManager
+     * @brief Queries one or more RIS connections and ingests their worklists.
+     *
+     * Every connection gets its own query service, association, thread, C-FIND and C-ECHO
+     * timers and health state, so a slow or unreachable RIS only delays its own results.
+     * The results of all connections go into the one worklist: ingests are serialized, and an
+     * entry received from two connections is matched on its identity fingerprint and stored
+     * once, attributed to the connection it was first received from.
+     *
+     * Refreshes are planned by a WorklistRefreshPlanner per connection: matching keys for the
+     * station AE title, modality and the profile's configured values, deltas over the scheduled
+     * dates since the last refresh, and a periodic full reconcile that cancels pending entries
+     * the RIS no longer returns.
+     *
+     * Each query service keeps its association open between refreshes; the periodic C-ECHO is
+     * its keep-alive. Association state changes are mirrored into connectionHealth().
+     *
+     * The echoes are sent by a RisHealthMonitor on its own thread. A connection the monitor
+     * reports Down is not queried unless the health policy continues on echo failure.
+     */
     class ModalityWorklistManager : public QObject
     {
         Q_OBJECT
@@ -39,37 +87,79 @@ namespace Etrek::Worklist::Connectivity
             std::shared_ptr<Etrek::Core::Data::Model::RisConnectionSetting> settings,
             QObject* parent = nullptr);
 
+        explicit ModalityWorklistManager(std::shared_ptr<Etrek::Worklist::Repository::WorklistRepository> repository,
+            const QVector<std::shared_ptr<Etrek::Core::Data::Model::RisConnectionSetting>>& settings,
+            QObject* parent = nullptr);
+
+        /**
+         * @brief Sets the query windows; applies from the next setActiveProfile().
+         */
+        void setRefreshPolicy(const WorklistRefreshPolicy& policy);
+
+        /**
+         * @brief Sets keep-alive and reconnect limits; applies from the next setActiveProfile().
+         */
+        void setAssociationPolicy(const RisAssociationPolicy& policy);
+
+        /**
+         * @brief Sets the echo period and health thresholds; applies from the next setActiveProfile().
+         */
+        void setHealthPolicy(const RisHealthPolicy& policy);
+
         void setActiveProfile(const Etrek::Worklist::Data::Entity::WorklistProfile& profile);
         void changeQueryRisServerPeriod(int period);
         void startWorklistQueryFromRis();
         void stopWorklistQueryFromRis();
+
+        /**
+         * @brief Queries every connection in turn, on the calling thread.
+         * @return The entries of all connections, each with its SourceConnection set; not de-duplicated.
+         */
         QList<Etrek::Worklist::Data::Entity::WorklistEntry> getEntities();
+
+        QVector<RisConnectionHealth> connectionHealth() const;
         ~ModalityWorklistManager();
 
     signals:
-        void QueryRequested();  // For cross-thread execution
+        void connectionHealthChanged(const QString& connectionName, bool healthy);
+        void connectionStateChanged(const QString& connectionName, Etrek::Worklist::Connectivity::RisHealthState state);
+        void worklistQueryFinished(const QString& connectionName, int entries);
+        void associationStateChanged(const QString& connectionName, Etrek::Worklist::Connectivity::RisAssociationState state, int retryInMs);
 
     public slots:
 
         void onAboutToCloseApplication();
 
-    private slots:
-        void handleNewQueryResults(const QList<Etrek::Worklist::Data::Entity::WorklistEntry>& entries);
-        void performWorklistQuery();  // Called when the thread is ready or timer ticks
-
     private:
-        void prepareQueryService();  // Sets up thread & service safely
+        struct RisChannel;
+
+        void prepareQueryServices();  // Sets up one thread & service per connection
+        RisChannel* channelAt(int index, int generation) const;
+        void performWorklistQuery(int index);  // Called when the channel thread is ready or its timer ticks
+        void startHealthMonitor();
+        void stopHealthMonitor();
+        void applyHealthSnapshot(const RisHealthSnapshot& snapshot, int generation);
+        void recordQueryHealth(RisChannel& channel, bool succeeded, const QString& error);
+        void updateHealthy(RisChannel& channel);
+        Etrek::Specification::Result<Etrek::Worklist::Data::Entity::WorklistIngestSummary> handleNewQueryResults(const QList<Etrek::Worklist::Data::Entity::WorklistEntry>& entries,
+            const Etrek::Worklist::Data::Entity::WorklistProfile& profile,
+            const QString& connectionName);  // Runs on the query thread of the connection
 
         std::shared_ptr<Etrek::Worklist::Repository::WorklistRepository> m_repository;
-        std::shared_ptr<Etrek::Core::Data::Model::RisConnectionSetting> settings;
+        QVector<std::shared_ptr<Etrek::Core::Data::Model::RisConnectionSetting>> m_settings;
 
-        std::unique_ptr<WorklistQueryService> m_queryService;
+        std::vector<std::unique_ptr<RisChannel>> m_channels;
+        int m_generation = 0;  // Bumped when the channels are rebuilt; stale completions are dropped
         Etrek::Worklist::Data::Entity::WorklistProfile m_profile;
+        WorklistRefreshPolicy m_refreshPolicy;
+        RisAssociationPolicy m_associationPolicy;
+        RisHealthPolicy m_healthPolicy;
 
-        QThread* m_queryThread = nullptr;
+        RisHealthMonitor* m_healthMonitor = nullptr;  // Lives on m_healthThread
+        QThread* m_healthThread = nullptr;
         QTimer* m_echoTimer = nullptr;
-        QTimer* m_findTimer = nullptr;
-        bool m_isFindRunning = false;
+
+        QMutex m_ingestMutex;  // One ingest at a time, so identical entries from two RIS are merged
         int m_refreshPeriodMs = 300000;  // Default 5 minutes
     };
 
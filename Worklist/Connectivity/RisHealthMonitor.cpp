@@ -0,0 +1,163 @@
+#include "RisHealthMonitor.h"
+#include <QElapsedTimer>
+#include <QMetaObject>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "WorklistQueryService.h"
+
+namespace Etrek::Worklist::Connectivity
+{
+    RisHealthTracker::RisHealthTracker(const QString& connectionName, const RisHealthPolicy& policy)
+        : m_policy(policy)
+    {
+        m_snapshot.ConnectionName = connectionName;
+    }
+
+    bool RisHealthTracker::record(bool succeeded, qint64 latencyMs, const QString& error, const QDateTime& at)
+    {
+        const RisHealthState previous = m_snapshot.State;
+        m_snapshot.LastEchoAt = at;
+
+        if (succeeded) {
+            m_snapshot.ConsecutiveFailures = 0;
+            m_latencies.push_back(latencyMs);
+            while (static_cast<int>(m_latencies.size()) > qMax(1, m_policy.LatencyWindow))
+                m_latencies.pop_front();
+            updateLatency();
+
+            m_snapshot.State = m_snapshot.Latency.MeanMs > m_policy.DegradedLatencyMs
+                ? RisHealthState::Degraded
+                : RisHealthState::Healthy;
+        }
+        else {
+            ++m_snapshot.ConsecutiveFailures;
+            m_snapshot.LastError = error;
+            m_snapshot.State = m_snapshot.ConsecutiveFailures >= m_policy.DownAfterFailures
+                ? RisHealthState::Down
+                : RisHealthState::Degraded;
+        }
+
+        return m_snapshot.State != previous;
+    }
+
+    const RisHealthSnapshot& RisHealthTracker::snapshot() const
+    {
+        return m_snapshot;
+    }
+
+    void RisHealthTracker::updateLatency()
+    {
+        RisLatencyStats& stats = m_snapshot.Latency;
+        std::vector<qint64> sorted(m_latencies.begin(), m_latencies.end());
+        std::sort(sorted.begin(), sorted.end());
+
+        qint64 total = 0;
+        for (qint64 latency : sorted)
+            total += latency;
+
+        const int count = static_cast<int>(sorted.size());
+        stats.Samples = count;
+        stats.LastMs = m_latencies.back();
+        stats.MinMs = sorted.front();
+        stats.MaxMs = sorted.back();
+        stats.MeanMs = static_cast<double>(total) / count;
+        // Nearest rank
+        const int rank = qMax(1, static_cast<int>(std::ceil(0.95 * count)));
+        stats.P95Ms = sorted[rank - 1];
+    }
+
+
+    RisHealthMonitor::RisHealthMonitor(const RisHealthPolicy& policy, QObject* parent)
+        : QObject(parent),
+        m_policy(policy)
+    {
+    }
+
+    void RisHealthMonitor::addConnection(const QString& connectionName, WorklistQueryService* service)
+    {
+        Probe probe;
+        probe.Service = service;
+        probe.Tracker = RisHealthTracker(connectionName, m_policy);
+        m_probes.insert(connectionName, probe);
+
+        QWriteLocker locker(&m_publishLock);
+        m_published.insert(connectionName, probe.Tracker.snapshot());
+    }
+
+    RisHealthSnapshot RisHealthMonitor::snapshot(const QString& connectionName) const
+    {
+        QReadLocker locker(&m_publishLock);
+        RisHealthSnapshot snapshot = m_published.value(connectionName);
+        snapshot.ConnectionName = connectionName;
+        return snapshot;
+    }
+
+    QVector<RisHealthSnapshot> RisHealthMonitor::snapshots() const
+    {
+        QReadLocker locker(&m_publishLock);
+        QVector<RisHealthSnapshot> snapshots;
+        snapshots.reserve(m_published.size());
+        for (const auto& snapshot : m_published)
+            snapshots.append(snapshot);
+        return snapshots;
+    }
+
+    RisHealthState RisHealthMonitor::state(const QString& connectionName) const
+    {
+        QReadLocker locker(&m_publishLock);
+        return m_published.value(connectionName).State;
+    }
+
+    const RisHealthPolicy& RisHealthMonitor::policy() const
+    {
+        return m_policy;
+    }
+
+    void RisHealthMonitor::probeAll()
+    {
+        // The owner stops the query service threads before it deletes the monitor,
+        // so a completion is never posted to a deleted monitor
+        for (auto it = m_probes.begin(); it != m_probes.end(); ++it) {
+            Probe& probe = it.value();
+            if (probe.InFlight || !probe.Service)
+                continue;
+
+            probe.InFlight = true;
+            const QString connectionName = it.key();
+            WorklistQueryService* service = probe.Service;
+            QMetaObject::invokeMethod(service, [this, service, connectionName]() {
+                QElapsedTimer timer;
+                timer.start();
+                const auto result = service->echoRis();
+                const qint64 latencyMs = timer.elapsed();
+
+                QMetaObject::invokeMethod(this, [this, connectionName, result, latencyMs]() {
+                    onEchoFinished(connectionName, result.isSuccess, latencyMs, result.isSuccess ? QString() : result.message);
+                    }, Qt::QueuedConnection);
+                }, Qt::QueuedConnection);
+        }
+    }
+
+    void RisHealthMonitor::onEchoFinished(const QString& connectionName, bool succeeded, qint64 latencyMs, const QString& error)
+    {
+        auto it = m_probes.find(connectionName);
+        if (it == m_probes.end())
+            return;
+
+        Probe& probe = it.value();
+        probe.InFlight = false;
+        const bool changed = probe.Tracker.record(succeeded, latencyMs, error, QDateTime::currentDateTime());
+        const RisHealthSnapshot snapshot = probe.Tracker.snapshot();
+
+        {
+            QWriteLocker locker(&m_publishLock);
+            m_published.insert(connectionName, snapshot);
+        }
+
+        emit healthUpdated(snapshot);
+        if (changed)
+            emit stateChanged(connectionName, snapshot.State);
+    }
+
+}
@@ -0,0 +1,144 @@
+#ifndef RISHEALTHMONITOR_H
+#define RISHEALTHMONITOR_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QMetaType>
+#include <QObject>
+#include <QReadWriteLock>
+#include <QString>
+#include <QVector>
+#include <deque>
+
+namespace Etrek::Worklist::Connectivity
+{
+    class WorklistQueryService;
+
+    enum class RisHealthState {
+        Unknown,    ///< No echo has completed yet
+        Healthy,    ///< Echoes succeed within the latency limit
+        Degraded,   ///< Echoes are slow, or fail but not yet DownAfterFailures times in a row
+        Down        ///< DownAfterFailures echoes in a row failed
+    };
+
+    /**
+     * @brief Echo latency over the last RisHealthPolicy::LatencyWindow successful echoes.
+     */
+    struct RisLatencyStats {
+        int Samples = 0;
+        qint64 LastMs = 0;
+        qint64 MinMs = 0;
+        qint64 MaxMs = 0;
+        double MeanMs = 0.0;
+        qint64 P95Ms = 0;
+    };
+
+    /**
+     * @brief Echo period and state thresholds of the RIS health monitor.
+     */
+    struct RisHealthPolicy {
+        int EchoIntervalMs = 30000;     ///< Also the keep-alive period of the RIS association
+        int DegradedLatencyMs = 2000;   ///< A rolling mean above this is Degraded
+        int DownAfterFailures = 3;
+        int LatencyWindow = 20;         ///< Echoes the latency statistics are computed over
+        bool ContinueOnEchoFail = true; ///< EnvironmentSetting::ContinueOnEchoFail
+
+        /**
+         * @brief Whether a worklist query is sent to a connection in @p state.
+         */
+        bool allowsQuery(RisHealthState state) const {
+            return ContinueOnEchoFail || state != RisHealthState::Down;
+        }
+    };
+
+    struct RisHealthSnapshot {
+        QString ConnectionName;
+        RisHealthState State = RisHealthState::Unknown;
+        int ConsecutiveFailures = 0;
+        QDateTime LastEchoAt;
+        QString LastError;
+        RisLatencyStats Latency;
+    };
+
+    /**
+     * @class RisHealthTracker
+     * @brief State machine of one connection, fed with echo results.
+     */
+    class RisHealthTracker
+    {
+    public:
+        explicit RisHealthTracker(const QString& connectionName = QString(), const RisHealthPolicy& policy = RisHealthPolicy());
+
+        /**
+         * @brief Records one echo.
+         * @return True if the state changed.
+         */
+        bool record(bool succeeded, qint64 latencyMs, const QString& error, const QDateTime& at);
+
+        const RisHealthSnapshot& snapshot() const;
+
+    private:
+        void updateLatency();
+
+        RisHealthPolicy m_policy;
+        RisHealthSnapshot m_snapshot;
+        std::deque<qint64> m_latencies;
+    };
+
+    /**
+     * @class RisHealthMonitor
+     * @brief Echoes every RIS connection off the GUI thread and publishes their health.
+     *
+     * The monitor lives on its own thread; probeAll() is driven by a timer of the owner. Each
+     * echo runs on the thread of its connection's query service, so it shares the connection's
+     * association and queues behind a running C-FIND instead of contending with it, and only
+     * the echo itself is timed. A connection whose previous echo has not returned is skipped.
+     *
+     * snapshot(), snapshots() and state() may be called from any thread; the signals are
+     * emitted on the monitor thread after every echo.
+     */
+    class RisHealthMonitor : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        explicit RisHealthMonitor(const RisHealthPolicy& policy = RisHealthPolicy(), QObject* parent = nullptr);
+
+        /**
+         * @brief Adds a connection to probe; call before the monitor is moved to its thread.
+         */
+        void addConnection(const QString& connectionName, WorklistQueryService* service);
+
+        RisHealthSnapshot snapshot(const QString& connectionName) const;
+        QVector<RisHealthSnapshot> snapshots() const;
+        RisHealthState state(const QString& connectionName) const;
+        const RisHealthPolicy& policy() const;
+
+    public slots:
+        void probeAll();
+
+    signals:
+        void healthUpdated(const Etrek::Worklist::Connectivity::RisHealthSnapshot& snapshot);
+        void stateChanged(const QString& connectionName, Etrek::Worklist::Connectivity::RisHealthState state);
+
+    private:
+        struct Probe {
+            WorklistQueryService* Service = nullptr;
+            RisHealthTracker Tracker;
+            bool InFlight = false;
+        };
+
+        void onEchoFinished(const QString& connectionName, bool succeeded, qint64 latencyMs, const QString& error);
+
+        RisHealthPolicy m_policy;
+        QHash<QString, Probe> m_probes;  // Only touched on the monitor thread once started
+
+        mutable QReadWriteLock m_publishLock;
+        QHash<QString, RisHealthSnapshot> m_published;
+    };
+
+}
+
+Q_DECLARE_METATYPE(Etrek::Worklist::Connectivity::RisHealthSnapshot)
+
+#endif // RISHEALTHMONITOR_H
@@ -0,0 +1,39 @@
+#include "RisReconnectBackoff.h"
+#include <QRandomGenerator>
+#include <cmath>
+
+namespace Etrek::Worklist::Connectivity
+{
+    RisReconnectBackoff::RisReconnectBackoff(const RisAssociationPolicy& policy, RandomSource random)
+        : m_policy(policy),
+        m_random(std::move(random))
+    {
+        if (!m_random)
+            m_random = []() { return QRandomGenerator::global()->generateDouble(); };
+    }
+
+    int RisReconnectBackoff::nextDelayMs()
+    {
+        ++m_failures;
+
+        const double maxDelay = qMax(0, m_policy.MaxBackoffMs);
+        const double growth = std::pow(qMax(1.0, m_policy.BackoffMultiplier), m_failures - 1);
+        const double delay = qMin(maxDelay, qMax(0, m_policy.InitialBackoffMs) * growth);
+
+        // Spread over [delay * (1 - jitter), delay * (1 + jitter)]
+        const double jitter = qBound(0.0, m_policy.Jitter, 1.0);
+        const double factor = 1.0 - jitter + 2.0 * jitter * m_random();
+        return static_cast<int>(qMin(maxDelay, delay * factor));
+    }
+
+    void RisReconnectBackoff::reset()
+    {
+        m_failures = 0;
+    }
+
+    int RisReconnectBackoff::failures() const
+    {
+        return m_failures;
+    }
+
+}
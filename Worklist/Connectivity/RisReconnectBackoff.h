@@ -0,0 +1,65 @@
+#ifndef RISRECONNECTBACKOFF_H
+#define RISRECONNECTBACKOFF_H
+
+#include <functional>
+#include <QtGlobal>
+
+namespace Etrek::Worklist::Connectivity
+{
+    /**
+     * @brief Lifecycle of the association a WorklistQueryService keeps with its RIS.
+     */
+    enum class RisAssociationState {
+        Disconnected,   ///< No association; the next query or echo opens one
+        Connecting,     ///< A-ASSOCIATE in progress
+        Connected,      ///< Open and reused by every query and echo
+        Backoff         ///< The last attempt failed; no new one before the retry delay has passed
+    };
+
+    /**
+     * @brief How a RIS association is kept open and re-opened.
+     */
+    struct RisAssociationPolicy {
+        int IdleTimeoutMs = 120000;         ///< An association unused this long is assumed dropped by the peer and re-opened
+        int ConnectTimeoutSec = 10;         ///< TCP connect timeout of an A-ASSOCIATE
+        int AcseTimeoutSec = 30;            ///< Timeout of the association negotiation
+        int InitialBackoffMs = 1000;        ///< Delay after the first failed attempt
+        int MaxBackoffMs = 5 * 60 * 1000;   ///< Upper bound of the delay
+        double BackoffMultiplier = 2.0;     ///< Growth of the delay per consecutive failure
+        double Jitter = 0.2;                ///< The delay varies by up to this fraction either way
+    };
+
+    /**
+     * @class RisReconnectBackoff
+     * @brief Jittered exponential delays between failed association attempts.
+     *
+     * The n-th consecutive failure waits InitialBackoffMs * BackoffMultiplier^(n-1), capped at
+     * MaxBackoffMs, then shifted by a random factor within +/- Jitter so that several
+     * modalities losing the same RIS do not all reconnect at once.
+     */
+    class RisReconnectBackoff
+    {
+    public:
+        /// Returns a value in [0, 1); defaults to QRandomGenerator::global().
+        using RandomSource = std::function<double()>;
+
+        explicit RisReconnectBackoff(const RisAssociationPolicy& policy = RisAssociationPolicy(), RandomSource random = RandomSource());
+
+        /**
+         * @brief Counts a failed attempt.
+         * @return The delay before the next attempt, in milliseconds.
+         */
+        int nextDelayMs();
+
+        void reset();
+        int failures() const;
+
+    private:
+        RisAssociationPolicy m_policy;
+        RandomSource m_random;
+        int m_failures = 0;
+    };
+
+}
+
+#endif // RISRECONNECTBACKOFF_H
@@ -0,0 +1,56 @@
+#include "WorklistFindScu.h"
+
+namespace Etrek::Worklist::Connectivity
+{
+    void WorklistFindScu::setResponseHandler(ResponseHandler handler)
+    {
+        m_handler = std::move(handler);
+        m_cancelled = false;
+        m_hasFinalStatus = false;
+        m_finalStatus = 0;
+    }
+
+    bool WorklistFindScu::wasCancelled() const
+    {
+        return m_cancelled;
+    }
+
+    bool WorklistFindScu::hasFinalStatus() const
+    {
+        return m_hasFinalStatus;
+    }
+
+    Uint16 WorklistFindScu::finalStatus() const
+    {
+        return m_finalStatus;
+    }
+
+    OFCondition WorklistFindScu::handleFINDResponse(const T_ASC_PresentationContextID presID,
+        QRResponse* response,
+        OFBool& waitForNextResponse)
+    {
+        // Logs the status and decides whether more responses follow
+        OFCondition cond = DcmSCU::handleFINDResponse(presID, response, waitForNextResponse);
+        if (cond.good() && !waitForNextResponse) {
+            m_hasFinalStatus = true;
+            m_finalStatus = response->m_status;
+        }
+        if (cond.bad() || !m_handler || m_cancelled)
+            return cond;
+
+        if (response->m_status != STATUS_FIND_Pending_MatchesAreContinuing
+            && response->m_status != STATUS_FIND_Pending_WarningUnsupportedOptionalKeys)
+            return cond;
+        if (!response->m_dataset)
+            return cond;
+
+        if (!m_handler(response->m_dataset)) {
+            m_cancelled = true;
+            // The SCP confirms the cancel with a final response, which ends the loop
+            if (sendCANCELRequest(presID).bad())
+                waitForNextResponse = OFFalse;
+        }
+        return cond;
+    }
+
+}
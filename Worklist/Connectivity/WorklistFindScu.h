@@ -0,0 +1,51 @@
+#ifndef WORKLISTFINDSCU_H
+#define WORKLISTFINDSCU_H
+
+#include <functional>
+#include "dcmtk/dcmnet/scu.h"
+
+namespace Etrek::Worklist::Connectivity
+{
+    /**
+     * @class WorklistFindScu
+     * @brief DcmSCU that hands every C-FIND response to a handler as it arrives.
+     *
+     * DcmSCU::sendFINDRequest() keeps all responses in a list until the query is complete.
+     * Called with a null response list, this SCU passes each pending dataset to the response
+     * handler instead, and the response is freed as soon as the handler returns. A handler
+     * that returns false cancels the query: a C-CANCEL is sent once and the remaining
+     * responses are read and dropped until the SCP ends the query.
+     *
+     * DcmSCU::sendFINDRequest() reports a good condition whatever status the final response
+     * carries; finalStatus() keeps it so the caller can tell a complete result set from a query
+     * the SCP ended with a failure.
+     */
+    class WorklistFindScu : public DcmSCU
+    {
+    public:
+        /// Receives the identifier of a pending response; the dataset is only valid during the call.
+        using ResponseHandler = std::function<bool(DcmDataset* dataset)>;
+
+        /// Also clears the cancel flag and the final status of the previous query.
+        void setResponseHandler(ResponseHandler handler);
+        bool wasCancelled() const;
+
+        /// Status of the final response of the last query; false if none was received.
+        bool hasFinalStatus() const;
+        Uint16 finalStatus() const;
+
+    protected:
+        OFCondition handleFINDResponse(const T_ASC_PresentationContextID presID,
+            QRResponse* response,
+            OFBool& waitForNextResponse) override;
+
+    private:
+        ResponseHandler m_handler;
+        bool m_cancelled = false;
+        bool m_hasFinalStatus = false;
+        Uint16 m_finalStatus = 0;
+    };
+
+}
+
+#endif // WORKLISTFINDSCU_H
@@ -0,0 +1,74 @@
+#include "WorklistQueryBuilder.h"
+#include <QMap>
+#include "dcmtk/dcmdata/dcdeftag.h"
+#include "dcmtk/dcmdata/dcsequen.h"
+#include "DcmtkQtUtils.h"
+
+namespace Etrek::Worklist::Connectivity
+{
+    using Etrek::Worklist::Data::Entity::DicomTag;
+
+    WorklistQueryBuilder::WorklistQueryBuilder(QList<DicomTag> returnKeys)
+        : m_returnKeys(std::move(returnKeys))
+    {
+    }
+
+    std::unique_ptr<DcmDataset> WorklistQueryBuilder::build(const WorklistMatchingKeys& keys) const
+    {
+        auto query = std::make_unique<DcmDataset>();
+        QMap<DcmTagKey, DcmItem*> sequenceMap;
+
+        // One item per sequence, created on first use
+        auto sequenceItem = [&query, &sequenceMap](const DcmTagKey& parentKey) {
+            if (!sequenceMap.contains(parentKey)) {
+                auto* sequence = new DcmSequenceOfItems(parentKey);
+                auto* item = new DcmItem();
+                sequence->insert(item);
+                query->insert(sequence);
+                sequenceMap[parentKey] = item;
+            }
+            return sequenceMap[parentKey];
+        };
+
+        for (const auto& tag : m_returnKeys) {
+            if (!tag.IsActive)
+                continue;
+
+            DcmTagKey tagKey(tag.GroupHex, tag.ElementHex);
+            const OFString value = QString_To_OFString(keys.ConfiguredValues.value(tag.Id));
+
+            // If tag has a parent sequence
+            if (tag.PgroupHex != 0x0000 || tag.PelementHex != 0x0000)
+                sequenceItem(DcmTagKey(tag.PgroupHex, tag.PelementHex))->putAndInsertOFStringArray(tagKey, value);
+            else
+                query->putAndInsertOFStringArray(tagKey, value);
+        }
+
+        const QString scheduledDates = dateRange(keys.ScheduledFrom, keys.ScheduledTo);
+        if (keys.ScheduledStationAETitle.isEmpty() && keys.Modality.isEmpty() && scheduledDates.isEmpty())
+            return query;
+
+        DcmItem* sps = sequenceItem(DCM_ScheduledProcedureStepSequence);
+        if (!keys.ScheduledStationAETitle.isEmpty())
+            sps->putAndInsertOFStringArray(DCM_ScheduledStationAETitle, QString_To_OFString(keys.ScheduledStationAETitle));
+        if (!keys.Modality.isEmpty())
+            sps->putAndInsertOFStringArray(DCM_Modality, QString_To_OFString(keys.Modality));
+        if (!scheduledDates.isEmpty())
+            sps->putAndInsertOFStringArray(DCM_ScheduledProcedureStepStartDate, QString_To_OFString(scheduledDates));
+
+        return query;
+    }
+
+    QString WorklistQueryBuilder::dateRange(const QDate& from, const QDate& to)
+    {
+        if (!from.isValid() && !to.isValid())
+            return QString();
+
+        const QString format = "yyyyMMdd";
+        if (from.isValid() && to.isValid() && from == to)
+            return from.toString(format);
+        return QString("%1-%2").arg(from.isValid() ? from.toString(format) : QString(),
+            to.isValid() ? to.toString(format) : QString());
+    }
+
+}
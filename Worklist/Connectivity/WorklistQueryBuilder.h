@@ -0,0 +1,56 @@
+#ifndef WORKLISTQUERYBUILDER_H
+#define WORKLISTQUERYBUILDER_H
+
+#include <QDate>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <memory>
+#include "dcmtk/dcmdata/dcdatset.h"
+#include "DicomTag.h"
+
+namespace Etrek::Worklist::Connectivity
+{
+    /**
+     * @brief Matching keys of a worklist C-FIND. Empty or invalid members match anything.
+     */
+    struct WorklistMatchingKeys {
+        QString ScheduledStationAETitle;        ///< Scheduled Station AE Title (0040,0001)
+        QString Modality;                       ///< Modality (0008,0060) of the scheduled procedure step
+        QDate ScheduledFrom;                    ///< First Scheduled Procedure Step Start Date (0040,0002)
+        QDate ScheduledTo;                      ///< Last Scheduled Procedure Step Start Date
+        QHash<int, QString> ConfiguredValues;   ///< Matching values of profile tags by dicom_tags.id
+    };
+
+    /**
+     * @class WorklistQueryBuilder
+     * @brief Builds the identifier of a worklist C-FIND from the profile tags and matching keys.
+     *
+     * Every active profile tag is a return key, with its configured matching value or empty for
+     * universal matching; tags with a parent sequence go into one item of that sequence. The
+     * station, modality and date keys are always put into the Scheduled Procedure Step Sequence
+     * and take precedence over a configured value of the same tag.
+     *
+     * The date range has day granularity: Scheduled Procedure Step Start Time is not sent, as
+     * not every SCP matches it together with the date as one date-time range.
+     */
+    class WorklistQueryBuilder
+    {
+    public:
+        explicit WorklistQueryBuilder(QList<Etrek::Worklist::Data::Entity::DicomTag> returnKeys);
+
+        std::unique_ptr<DcmDataset> build(const WorklistMatchingKeys& keys = WorklistMatchingKeys()) const;
+
+        /**
+         * @brief DICOM DA range matching value, e.g. "20250101-20250107", "20250101-" or "-20250107".
+         * @return Empty if neither date is valid.
+         */
+        static QString dateRange(const QDate& from, const QDate& to);
+
+    private:
+        QList<Etrek::Worklist::Data::Entity::DicomTag> m_returnKeys;
+    };
+
+}
+
+#endif // WORKLISTQUERYBUILDER_H
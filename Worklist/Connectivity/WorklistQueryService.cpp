@@ -1,4 +1,6 @@
 #include "WorklistQueryService.h"
+#include <QElapsedTimer>
+#include "dcmtk/dcmdata/dcuid.h"
 #include "AppLoggerFactory.h"
 #include "DcmtkQtUtils.h"
 #include "MessageKey.h"
@@ -25,7 +27,7 @@ namespace Etrek::Worklist::Connectivity
         logger = factory.CreateLogger("WorklistQueryService");
 
 
-        m_dcmScu = std::make_unique<DcmSCU>();
+        m_dcmScu = std::make_unique<WorklistFindScu>();
     }
 
     WorklistQueryService::WorklistQueryService(WorklistQueryService&& other) noexcept
@@ -35,14 +37,24 @@ namespace Etrek::Worklist::Connectivity
         m_presentationContext(other.m_presentationContext),
         m_dcmScu(std::move(other.m_dcmScu)),
         translator(other.translator),
-        logger(other.logger)
+        logger(other.logger),
+        m_associationPolicy(other.m_associationPolicy),
+        m_backoff(other.m_backoff),
+        m_associationState(other.m_associationState.load()),
+        m_lastActivity(other.m_lastActivity),
+        m_backoffTimer(other.m_backoffTimer),
+        m_retryAfterMs(other.m_retryAfterMs),
+        m_contextsReady(other.m_contextsReady),
+        m_echoPresentationId(other.m_echoPresentationId),
+        m_findPresentationId(other.m_findPresentationId)
     {
     }
 
     WorklistQueryService::~WorklistQueryService()
     {
         if (m_dcmScu) {
-            m_dcmScu->releaseAssociation();
+            if (m_dcmScu->isConnected())
+                m_dcmScu->releaseAssociation();
             m_dcmScu->freeNetwork();
         }
     }
@@ -59,63 +71,176 @@ namespace Etrek::Worklist::Connectivity
 
     void WorklistQueryService::setPresentationContext(const WorklistPresentationContext& context)
     {
+        QMutexLocker locker(&m_scuMutex);
         m_presentationContext = context;
+
+        // The open association was negotiated for the previous transfer syntax
+        m_contextsReady = false;
+        dropAssociation(false);
     }
 
     void WorklistQueryService::setSettings(std::shared_ptr<RisConnectionSetting> settings)
     {
+        QMutexLocker locker(&m_scuMutex);
         m_settings = settings;
+
+        // Peer changes apply from the next association, without waiting out a backoff of the old peer
+        dropAssociation(false);
+        m_backoff.reset();
+        m_retryAfterMs = 0;
+        setAssociationState(RisAssociationState::Disconnected);
         setupTheConnectionParameters();
     }
 
+    void WorklistQueryService::setAssociationPolicy(const RisAssociationPolicy& policy)
+    {
+        QMutexLocker locker(&m_scuMutex);
+        m_associationPolicy = policy;
+        m_backoff = RisReconnectBackoff(policy);
+    }
+
+    RisAssociationState WorklistQueryService::associationState() const
+    {
+        return m_associationState.load();
+    }
+
     Etrek::Specification::Result<QString> WorklistQueryService::prepareAssociation()
     {
-        //QMutexLocker locker(&m_scuMutex);
+        QMutexLocker locker(&m_scuMutex);
 
         if (!m_dcmScu) {
             return Etrek::Specification::Result<QString>::Failure("DICOM SCU not initialized.");
         }
 
-        // Release any existing association to start fresh
-        m_dcmScu->releaseAssociation();
+        dropAssociation(false);
+        return openAssociation();
+    }
 
-        // Now add contexts
-        auto addEcho = addPresentationContextForOperation("C-ECHO");
-        if (!addEcho.isSuccess)
-        {
-            QString message = "Failed to add C-ECHO context: " + addEcho.message;
-            qDebug() << message;
-            return Etrek::Specification::Result<QString>::Failure(addEcho.message);
-        }
-        auto addFind = addPresentationContextForOperation("C-FIND");
-        if (!addFind.isSuccess)
-        {
-            QString message = "Failed to add C-FIND context: " + addFind.message;
-            qDebug() << message;
-            return Etrek::Specification::Result<QString>::Failure(addFind.message);
+    Result<QString> WorklistQueryService::openAssociation()
+    {
+        setAssociationState(RisAssociationState::Connecting);
+
+        auto fail = [this](const Result<QString>& result) {
+            const int delay = m_backoff.nextDelayMs();
+            m_retryAfterMs = delay;
+            m_backoffTimer.start();
+            logger->LogWarning(translator->getWarningMessage(RIS_ASSOCIATION_BACKOFF_MSG).arg(m_backoff.failures()).arg(delay));
+            setAssociationState(RisAssociationState::Backoff, delay);
+            return result;
+        };
+
+        // Contexts are added once; the SCU keeps them across associations
+        if (!m_contextsReady) {
+            m_dcmScu->clearPresentationContexts();
+
+            auto addEcho = addPresentationContextForOperation("C-ECHO");
+            if (!addEcho.isSuccess) {
+                qDebug() << "Failed to add C-ECHO context: " + addEcho.message;
+                return fail(Result<QString>::Failure(addEcho.message));
+            }
+            auto addFind = addPresentationContextForOperation("C-FIND");
+            if (!addFind.isSuccess) {
+                qDebug() << "Failed to add C-FIND context: " + addFind.message;
+                return fail(Result<QString>::Failure(addFind.message));
+            }
+            m_contextsReady = true;
         }
+
+        // The association parameters are created by initNetwork() from the contexts above and
+        // freed with every release or abort, so each association needs its own call
         auto initNet = initNetwork();
         if (!initNet.isSuccess)
-            return initNet;
+            return fail(initNet);
+
+        // Without a bound an unreachable RIS would hold the query thread
+        m_dcmScu->setConnectionTimeout(m_associationPolicy.ConnectTimeoutSec);
+        m_dcmScu->setACSETimeout(static_cast<Uint32>(qMax(0, m_associationPolicy.AcseTimeoutSec)));
 
         auto negotiate = negotiateTheAssociation();
         if (!negotiate.isSuccess)
-            return negotiate;
+            return fail(negotiate);
 
-        auto echo = echoRis();
-        if (!echo.isSuccess)
-            return echo;
+        const OFString transferSyntax = QString_To_OFString(m_presentationContext.TransferSyntaxUid);
+        m_echoPresentationId = m_dcmScu->findPresentationContextID(UID_VerificationSOPClass, transferSyntax);
+        m_findPresentationId = m_dcmScu->findPresentationContextID(UID_FINDModalityWorklistInformationModel, transferSyntax);
+        if (m_findPresentationId == 0) {
+            QString error = translator->getErrorMessage(RIS_PRESENTATION_CONTEXT_REJECTED_MSG).arg("C-FIND");
+            logger->LogError(error);
+            m_dcmScu->releaseAssociation();
+            return fail(Result<QString>::Failure(error));
+        }
+
+        m_backoff.reset();
+        m_lastActivity.start();
+        setAssociationState(RisAssociationState::Connected);
+        return negotiate;
+    }
+
+    Result<bool> WorklistQueryService::ensureAssociation()
+    {
+        if (m_dcmScu->isConnected()) {
+            if (m_lastActivity.isValid() && m_lastActivity.elapsed() <= m_associationPolicy.IdleTimeoutMs)
+                return Result<bool>::Success(true);
 
-        auto message = translator->getInfoMessage(RIS_ASSOCIATION_NEGOTIATION_SUCCEED);
-        return Etrek::Specification::Result<QString>::Success(message);
+            // Most SCPs close an association idle for a while; sending on it would only fail
+            logger->LogDebug(translator->getDebugMessage(RIS_ASSOCIATION_IDLE_EXPIRED_MSG).arg(m_lastActivity.elapsed()));
+            dropAssociation(false);
+        }
+
+        if (m_associationState.load() == RisAssociationState::Backoff && m_backoffTimer.isValid()
+            && m_backoffTimer.elapsed() < m_retryAfterMs) {
+            const qint64 remaining = m_retryAfterMs - m_backoffTimer.elapsed();
+            return Result<bool>::Failure(translator->getErrorMessage(RIS_ASSOCIATION_WAITING_MSG).arg(remaining));
+        }
+
+        auto opened = openAssociation();
+        if (!opened.isSuccess)
+            return Result<bool>::Failure(opened.message);
+        return Result<bool>::Success(false);
+    }
+
+    void WorklistQueryService::dropAssociation(bool peerLost)
+    {
+        if (m_dcmScu && m_dcmScu->isConnected()) {
+            // A lost association is only torn down locally; a live one is released politely
+            if (peerLost)
+                m_dcmScu->closeAssociation(DCMSCU_PEER_ABORTED_ASSOCIATION);
+            else
+                m_dcmScu->releaseAssociation();
+        }
+        m_lastActivity.invalidate();
+
+        // A running backoff stays in force
+        if (m_associationState.load() != RisAssociationState::Backoff)
+            setAssociationState(RisAssociationState::Disconnected);
+    }
+
+    bool WorklistQueryService::isConnectionLoss(const OFCondition& cond) const
+    {
+        return cond == DUL_PEERABORTEDASSOCIATION || cond == DUL_PEERREQUESTEDRELEASE
+            || cond == DUL_NETWORKCLOSED || cond == DUL_READTIMEOUT
+            || cond == DIMSE_READPDVFAILED || cond == DIMSE_SENDFAILED
+            || !m_dcmScu->isConnected();
+    }
+
+    void WorklistQueryService::setAssociationState(RisAssociationState state, int retryInMs)
+    {
+        const RisAssociationState previous = m_associationState.exchange(state);
+        if (previous != state || state == RisAssociationState::Backoff)
+            emit associationStateChanged(state, retryInMs);
     }
 
     Etrek::Specification::Result<QString> WorklistQueryService::releaseAssociation()
     {
+        QMutexLocker locker(&m_scuMutex);
+
         if (!m_dcmScu)
             return Etrek::Specification::Result<QString>::Failure("DICOM SCU not initialized.");
 
-        OFCondition cond = m_dcmScu->releaseAssociation();
+        OFCondition cond = m_dcmScu->isConnected() ? m_dcmScu->releaseAssociation() : EC_Normal;
+        m_lastActivity.invalidate();
+        if (m_associationState.load() != RisAssociationState::Backoff)
+            setAssociationState(RisAssociationState::Disconnected);
         if (cond.bad()) {
             QString err = translator->getErrorMessage(RIS_RELEASE_CONNECTION_FAILED).arg(cond.text());
             logger->LogError(err);
@@ -127,62 +252,127 @@ namespace Etrek::Worklist::Connectivity
 
     QList<WorklistEntry> WorklistQueryService::getWorklistEntries()
     {
-        QMutexLocker locker(&m_scuMutex);
         QList<WorklistEntry> worklistEntries;
 
-        // Ensure association is ready and connected
-        if (!isConnected()) {
-            auto prepareResult = prepareAssociation();
-            if (!prepareResult.isSuccess) {
-                qDebug() << "PrepareAssociation failed:" << prepareResult.message;
-                return worklistEntries;
-            }
-        }
+        // Only the parsed entries are kept, not the response datasets
+        WorklistStreamOptions options;
+        options.BatchSize = 500;
+        auto result = streamWorklistEntries([&worklistEntries](const QList<WorklistEntry>& batch) {
+            worklistEntries.append(batch);
+            return true;
+            }, options);
 
-        // Build query dataset
-        std::unique_ptr<DcmDataset> query = createWorklistQuery(m_worklistTags);
+        if (!result.isSuccess)
+            qDebug() << "Error sending C-FIND request:" << result.message;
+
+        return worklistEntries;
+    }
+
+    Result<int> WorklistQueryService::streamWorklistEntries(const WorklistBatchConsumer& consumer, const WorklistStreamOptions& options)
+    {
+        return streamWorklistEntries(WorklistMatchingKeys(), consumer, options);
+    }
+
+    Result<int> WorklistQueryService::streamWorklistEntries(const WorklistMatchingKeys& keys, const WorklistBatchConsumer& consumer,
+        const WorklistStreamOptions& options)
+    {
+        QMutexLocker locker(&m_scuMutex);
 
         if (m_presentationContext.Id == -1) {
-            qDebug() << "Presentation context not set!";
-            return worklistEntries;
+            QString message = translator->getErrorMessage(RIS_PRESENTATION_CONTEXT_NOT_SET_MSG);
+            logger->LogError(message);
+            return Result<int>::Failure(message);
         }
 
-        // Use the known presentation number from added contexts (C-FIND is usually context id 3)
-        // This is a convention in DCMTK: presentation contexts get odd IDs starting from 1,
-        // so C-ECHO is 1, C-FIND is 3, etc.
-        const int presentationNumber = 3;
-
-        OFList<QRResponse*> responses;
-        OFCondition cond = m_dcmScu->sendFINDRequest(presentationNumber, query.get(), &responses);
-
-        if (cond.good()) {
-            for (auto rsp : responses) {
-                if (rsp->m_status == STATUS_Success || rsp->m_status == STATUS_Pending) {
-                    if (rsp->m_dataset) {
-
-                        // Convert full dataset to string for debugging
-                        //std::ostringstream stream;
-                        //rsp->m_dataset->print(stream, DCMTypes::PF_shortenLongTagValues | DCMTypes::PF_showTreeStructure);
-                        //QString datasetString = QString::fromStdString(stream.str());
-                        //logger->Log(datasetString,LogLevel::Info);
-
-                        // Set a breakpoint on this or inspect in logs
-                        //qDebug() << "Received DICOM dataset:\n" << datasetString;
-
-                        WorklistEntry entry = parseDatasetToWorklist(rsp->m_dataset, m_worklistTags);
-                        worklistEntries.append(entry);
-                    }
-                }
-                delete rsp;
+        auto association = ensureAssociation();
+        if (!association.isSuccess) {
+            qDebug() << "RIS association not available:" << association.message;
+            return Result<int>::Failure(association.message);
+        }
+
+        // Build query dataset
+        std::unique_ptr<DcmDataset> query = WorklistQueryBuilder(m_worklistTags).build(keys);
+
+        const int batchSize = qMax(1, options.BatchSize);
+        QList<WorklistEntry> batch;
+        batch.reserve(batchSize);
+        QElapsedTimer batchAge;
+        QElapsedTimer timer;
+        timer.start();
+        int delivered = 0;
+        int batches = 0;
+
+        auto deliver = [&]() {
+            if (batch.isEmpty())
+                return true;
+            emit worklistEntriesReceived(batch);
+            const bool proceed = consumer(batch);
+            delivered += batch.size();
+            ++batches;
+            batch.clear();
+            return proceed;
+        };
+
+        m_dcmScu->setResponseHandler([&](DcmDataset* dataset) {
+            if (batch.isEmpty())
+                batchAge.start();
+            batch.append(parseDatasetToWorklist(dataset, m_worklistTags));
+            if (batch.size() < batchSize && batchAge.elapsed() < options.MaxBatchDelayMs)
+                return true;
+            return deliver();
+            });
+
+        // No response list: every response is handed to the handler and freed right after
+        OFCondition cond = m_dcmScu->sendFINDRequest(m_findPresentationId, query.get(), nullptr);
+
+        // A reused association the peer dropped while unused fails before any response;
+        // the query is sent once more on a new one
+        if (cond.bad() && isConnectionLoss(cond) && association.value && delivered == 0 && batch.isEmpty()) {
+            logger->LogWarning(translator->getWarningMessage(RIS_ASSOCIATION_LOST_MSG).arg(cond.text()));
+            dropAssociation(true);
+            auto reopened = ensureAssociation();
+            if (!reopened.isSuccess) {
+                m_dcmScu->setResponseHandler(nullptr);
+                return Result<int>::Failure(reopened.message);
             }
+            cond = m_dcmScu->sendFINDRequest(m_findPresentationId, query.get(), nullptr);
         }
-        else {
+
+        const bool cancelled = m_dcmScu->wasCancelled();
+        const bool hasFinalStatus = m_dcmScu->hasFinalStatus();
+        const Uint16 finalStatus = m_dcmScu->finalStatus();
+        m_dcmScu->setResponseHandler(nullptr);
+
+        if (cond.bad()) {
+            if (isConnectionLoss(cond)) {
+                logger->LogWarning(translator->getWarningMessage(RIS_ASSOCIATION_LOST_MSG).arg(cond.text()));
+                dropAssociation(true);
+            }
             QString err = translator->getErrorMessage(RIS_C_FIND_FAILED).arg(cond.text());
             logger->LogError(err);
-            qDebug() << "Error sending C-FIND request:" << cond.text();
+            return Result<int>::Failure(err);
         }
+        m_lastActivity.start();
 
-        return worklistEntries;
+        if (cancelled) {
+            logger->LogInfo(translator->getInfoMessage(RIS_C_FIND_CANCELLED_MSG).arg(delivered));
+            return Result<int>::Success(delivered);
+        }
+
+        // Only a Success status means the SCP returned every match; a failure status after
+        // some responses leaves the result set incomplete
+        if (!hasFinalStatus || finalStatus != STATUS_Success) {
+            const QString statusText = hasFinalStatus ? QString("0x%1").arg(finalStatus, 4, 16, QChar('0')) : QString("none");
+            const QString status = translator->getErrorMessage(RIS_C_FIND_FINAL_STATUS_ERROR)
+                .arg(statusText).arg(delivered + batch.size());
+            QString err = translator->getErrorMessage(RIS_C_FIND_FAILED).arg(status);
+            logger->LogError(err);
+            return Result<int>::Failure(err);
+        }
+
+        deliver();
+        logger->LogDebug(translator->getDebugMessage(RIS_C_FIND_STREAMED_MSG).arg(delivered).arg(batches).arg(timer.elapsed()));
+        return Result<int>::Success(delivered);
     }
 
     QString dumpDataset(DcmDataset* dataset)
@@ -194,57 +384,45 @@ namespace Etrek::Worklist::Connectivity
 
     std::unique_ptr<DcmDataset> WorklistQueryService::createWorklistQuery(const QList<DicomTag>& queryTags) noexcept
     {
-        auto query = std::make_unique<DcmDataset>();
-        QMap<DcmTagKey, DcmItem*> sequenceMap;
-
-        for (const auto& tag : queryTags) {
-            if (!tag.IsActive)
-                continue;
-
-            DcmTagKey tagKey(tag.GroupHex, tag.ElementHex);
-
-            // If tag has a parent sequence
-            if (tag.PgroupHex != 0x0000 || tag.PelementHex != 0x0000) {
-                DcmTagKey parentKey(tag.PgroupHex, tag.PelementHex);
-
-                // If we don't yet have an item for this sequence, create and insert it
-                if (!sequenceMap.contains(parentKey)) {
-                    auto* sequence = new DcmSequenceOfItems(parentKey);
-                    auto* item = new DcmItem();
-                    sequence->insert(item);
-                    query->insert(sequence);
-                    sequenceMap[parentKey] = item;
-                }
-
-                // Insert tag into the corresponding sequence item
-                sequenceMap[parentKey]->putAndInsertString(tagKey, "");
-            }
-            else {
-                // Top-level tag
-                query->putAndInsertString(tagKey, "");
-            }
-        }
-
-        //QString queryText = dumpDataset(query.get());
-        //logger->Log(queryText,LogLevel::Debug);
-
-        return query;
+        // Universal matching on every tag
+        return WorklistQueryBuilder(queryTags).build();
     }
 
 
     Etrek::Specification::Result<QString> WorklistQueryService::echoRis()
     {
-        if (!isConnected()) {
-            setupTheConnectionParameters();
+        QMutexLocker locker(&m_scuMutex);
+
+        // The periodic echo is also the keep-alive of the association
+        auto association = ensureAssociation();
+        if (!association.isSuccess)
+            return Result<QString>::Failure(association.message);
+
+        auto echo = sendEcho();
+        if (!echo.isSuccess && association.value && !isConnected()) {
+            // Dropped by the peer while unused; one new association is tried at once
+            auto reopened = ensureAssociation();
+            if (!reopened.isSuccess)
+                return Result<QString>::Failure(reopened.message);
+            echo = sendEcho();
         }
+        return echo;
+    }
 
-        OFCondition cond = m_dcmScu->sendECHORequest(1);
+    Result<QString> WorklistQueryService::sendEcho()
+    {
+        OFCondition cond = m_dcmScu->sendECHORequest(m_echoPresentationId);
         if (cond.bad()) {
+            if (isConnectionLoss(cond)) {
+                logger->LogWarning(translator->getWarningMessage(RIS_ASSOCIATION_LOST_MSG).arg(cond.text()));
+                dropAssociation(true);
+            }
             QString err = translator->getErrorMessage(RIS_C_ECHO_FAILED).arg(cond.text());
             logger->LogError(err);
             return Etrek::Specification::Result<QString>::Failure(err);
         }
 
+        m_lastActivity.start();
         QString msg = translator->getInfoMessage(RIS_C_ECHO_SUCCEED);
         return Etrek::Specification::Result<QString>::Success(msg);
     }
@@ -368,11 +546,6 @@ namespace Etrek::Worklist::Connectivity
     }
 
 
-    void WorklistQueryService::reconnect()
-    {
-        releaseAssociation();
-        prepareAssociation();
-    }
 
 }
 
@@ -4,6 +4,9 @@
 #include <QVector>
 #include <QList>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <atomic>
+#include <functional>
 #include <memory>
 #include "RisConnectionSetting.h"
 #include "dcmtk/dcmdata/dcdatset.h"
@@ -14,12 +17,38 @@
 #include "DicomTag.h"
 #include "WorklistEntry.h"
 #include "WorklistPresentationContext.h"
+#include "WorklistFindScu.h"
+#include "WorklistQueryBuilder.h"
+#include "RisReconnectBackoff.h"
 #include <QMutex>
 
 namespace Etrek::Worklist::Connectivity 
 {
     class WorklistQueryServiceTest;
 
+    /**
+     * @brief Batching of a streamed C-FIND.
+     */
+    struct WorklistStreamOptions {
+        int BatchSize = 50;             ///< Entries per delivered batch; also the most entries held at once
+        int MaxBatchDelayMs = 500;      ///< A partial batch is delivered once its first entry is this old
+    };
+
+    /**
+     * @brief Receives one batch of a streamed C-FIND; returning false cancels the query.
+     */
+    using WorklistBatchConsumer = std::function<bool(const QList<Etrek::Worklist::Data::Entity::WorklistEntry>& batch)>;
+
+    /**
+     * @class WorklistQueryService
+     * @brief C-FIND and C-ECHO against one RIS over one long-lived association.
+     *
+     * The association is opened on first use and reused by every query and echo, so a periodic
+     * echo doubles as its keep-alive. It is re-opened when the peer aborts or releases it, or
+     * when it has been unused for longer than the policy's IdleTimeoutMs. After a failed
+     * attempt no new one is made before a jittered exponential delay has passed; calls in the
+     * meantime fail at once without touching the network.
+     */
     class WorklistQueryService : public QObject {
 
 
@@ -38,19 +67,54 @@ namespace Etrek::Worklist::Connectivity
         void setIdentifierTags(const QList<Etrek::Worklist::Data::Entity::DicomTag>& identifiers);
         void setPresentationContext(const Etrek::Worklist::Data::Entity::WorklistPresentationContext& context);
         void setSettings(std::shared_ptr<Etrek::Core::Data::Model::RisConnectionSetting> settings);
+        void setAssociationPolicy(const RisAssociationPolicy& policy);
+
+        RisAssociationState associationState() const;
 
-        // Explicitly prepare the DICOM association (add contexts + negotiate)
+        // Opens a new association now, replacing an open one and ignoring the backoff delay
         Etrek::Specification::Result<QString> prepareAssociation();
 
         // Release association explicitly
         Etrek::Specification::Result<QString> releaseAssociation();
 
         QList<Etrek::Worklist::Data::Entity::WorklistEntry> getWorklistEntries();
+
+        /**
+         * @brief Runs a C-FIND and hands the entries to @p consumer in batches while responses arrive.
+         *
+         * Each pending response is parsed as soon as it is read; at most one batch is held in
+         * memory. The consumer runs on the calling thread between two reads from the association,
+         * so a slow consumer holds back the SCP rather than letting responses pile up here.
+         * Returning false from the consumer sends a C-CANCEL and ends the stream.
+         *
+         * @return The number of entries delivered. Fails unless the SCP ends the query with a
+         *         Success status (or the consumer cancelled it); the batches delivered before
+         *         the failure have already been consumed.
+         */
+        Etrek::Specification::Result<int> streamWorklistEntries(const WorklistBatchConsumer& consumer,
+            const WorklistStreamOptions& options = WorklistStreamOptions());
+
+        /**
+         * @brief Streams a C-FIND restricted by @p keys; see the overload above.
+         */
+        Etrek::Specification::Result<int> streamWorklistEntries(const WorklistMatchingKeys& keys,
+            const WorklistBatchConsumer& consumer,
+            const WorklistStreamOptions& options = WorklistStreamOptions());
+
         Etrek::Specification::Result<QString> echoRis();
 
     signals:
+        /**
+         * @brief Emitted for every batch of a C-FIND, before it is handed to the consumer.
+         */
         void worklistEntriesReceived(const QList<Etrek::Worklist::Data::Entity::WorklistEntry>& worklistEntries);
 
+        /**
+         * @brief Emitted on the service thread whenever the association changes state.
+         * @param retryInMs Delay before the next attempt when @p state is Backoff, otherwise 0.
+         */
+        void associationStateChanged(Etrek::Worklist::Connectivity::RisAssociationState state, int retryInMs);
+
     private:
         std::unique_ptr<DcmDataset> createWorklistQuery(const QList<Etrek::Worklist::Data::Entity::DicomTag>& queryTags) noexcept;
 
@@ -58,6 +122,17 @@ namespace Etrek::Worklist::Connectivity
         Etrek::Specification::Result<QString> initNetwork();
         Etrek::Specification::Result<QString> negotiateTheAssociation();
 
+        /**
+         * @brief Returns an open association, opening one unless the backoff delay is running.
+         * @return True if an association that was already open is reused.
+         */
+        Etrek::Specification::Result<bool> ensureAssociation();
+        Etrek::Specification::Result<QString> openAssociation();
+        void dropAssociation(bool peerLost);
+        bool isConnectionLoss(const OFCondition& cond) const;
+        void setAssociationState(RisAssociationState state, int retryInMs = 0);
+        Etrek::Specification::Result<QString> sendEcho();
+
         // Adds a single presentation context (for echo or find)
         Etrek::Specification::Result<int> addPresentationContextForOperation(const QString& operation);
 
@@ -66,8 +141,6 @@ namespace Etrek::Worklist::Connectivity
 
         Etrek::Worklist::Data::Entity::WorklistEntry parseDatasetToWorklist(DcmDataset* dataset, const QVector<Etrek::Worklist::Data::Entity::DicomTag>& dicomTags);
 
-        void reconnect();
-
         // Members
         QList<Etrek::Worklist::Data::Entity::DicomTag> m_identifierTags;
         QList<Etrek::Worklist::Data::Entity::DicomTag> m_worklistTags;
@@ -75,8 +148,18 @@ namespace Etrek::Worklist::Connectivity
         Etrek::Worklist::Data::Entity::WorklistPresentationContext m_presentationContext;
         Etrek::Core::Globalization::TranslationProvider* translator;
         QMutex m_scuMutex;
-        std::unique_ptr<DcmSCU> m_dcmScu;
+        std::unique_ptr<WorklistFindScu> m_dcmScu;
         std::shared_ptr<Etrek::Core::Log::AppLogger> logger;
+
+        RisAssociationPolicy m_associationPolicy;
+        RisReconnectBackoff m_backoff;
+        std::atomic<RisAssociationState> m_associationState{ RisAssociationState::Disconnected };
+        QElapsedTimer m_lastActivity;       // Since the last exchange on the open association
+        QElapsedTimer m_backoffTimer;       // Since the last failed attempt
+        int m_retryAfterMs = 0;
+        bool m_contextsReady = false;       // Presentation contexts match the current settings
+        T_ASC_PresentationContextID m_echoPresentationId = 0;
+        T_ASC_PresentationContextID m_findPresentationId = 0;
     };
 
 }
@@ -0,0 +1,53 @@
+#include "WorklistRefreshPlanner.h"
+
+namespace Etrek::Worklist::Connectivity
+{
+    WorklistRefreshPlanner::WorklistRefreshPlanner(const WorklistRefreshPolicy& policy)
+        : m_policy(policy)
+    {
+    }
+
+    void WorklistRefreshPlanner::setBaseKeys(const QString& stationAETitle, const QString& modality, const QHash<int, QString>& configuredValues)
+    {
+        m_baseKeys = WorklistMatchingKeys();
+        if (m_policy.MatchStationAETitle)
+            m_baseKeys.ScheduledStationAETitle = stationAETitle;
+        if (m_policy.MatchModality)
+            m_baseKeys.Modality = modality;
+        m_baseKeys.ConfiguredValues = configuredValues;
+    }
+
+    WorklistRefreshPlan WorklistRefreshPlanner::next(const QDateTime& now) const
+    {
+        WorklistRefreshPlan plan;
+        plan.Keys = m_baseKeys;
+        plan.PlannedAt = now;
+
+        const bool reconcileDue = !m_lastSuccessAt.isValid() || !m_lastReconcileAt.isValid()
+            || m_lastReconcileAt.msecsTo(now) >= m_policy.ReconcileIntervalMs;
+        if (reconcileDue) {
+            plan.Kind = WorklistRefreshKind::Full;
+            return plan;
+        }
+
+        plan.Kind = WorklistRefreshKind::Delta;
+        plan.Keys.ScheduledFrom = m_lastSuccessAt.date();
+        plan.Keys.ScheduledTo = now.date().addDays(m_policy.LookaheadDays);
+        return plan;
+    }
+
+    void WorklistRefreshPlanner::recordSuccess(const WorklistRefreshPlan& plan)
+    {
+        // The planning time, not the completion: steps added while the query ran are inside the next window
+        m_lastSuccessAt = plan.PlannedAt;
+        if (plan.Kind == WorklistRefreshKind::Full)
+            m_lastReconcileAt = plan.PlannedAt;
+    }
+
+    void WorklistRefreshPlanner::reset()
+    {
+        m_lastSuccessAt = QDateTime();
+        m_lastReconcileAt = QDateTime();
+    }
+
+}
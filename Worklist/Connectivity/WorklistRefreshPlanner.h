@@ -0,0 +1,69 @@
+#ifndef WORKLISTREFRESHPLANNER_H
+#define WORKLISTREFRESHPLANNER_H
+
+#include <QDateTime>
+#include "WorklistQueryBuilder.h"
+
+namespace Etrek::Worklist::Connectivity
+{
+    /**
+     * @brief Query windows of the periodic worklist refresh.
+     */
+    struct WorklistRefreshPolicy {
+        int LookaheadDays = 2;                          ///< Delta queries reach this many days past today
+        qint64 ReconcileIntervalMs = 60 * 60 * 1000;    ///< Time between two full reconciles
+        bool MatchStationAETitle = true;                ///< Only steps scheduled on this station's AE title
+        bool MatchModality = true;                      ///< Only steps of the connection's modality
+    };
+
+    enum class WorklistRefreshKind {
+        Full,   ///< No date range; entries it does not return were removed on the RIS
+        Delta   ///< Only the days from the last successful refresh to the lookahead
+    };
+
+    struct WorklistRefreshPlan {
+        WorklistRefreshKind Kind = WorklistRefreshKind::Full;
+        WorklistMatchingKeys Keys;
+        QDateTime PlannedAt;
+    };
+
+    /**
+     * @class WorklistRefreshPlanner
+     * @brief Decides the matching keys of each worklist refresh of one RIS connection.
+     *
+     * The first refresh, and one every ReconcileIntervalMs after it, is a full reconcile over all
+     * scheduled dates. The refreshes in between are deltas from the day of the last successful
+     * refresh to LookaheadDays ahead, so days already fetched are not downloaded again. A step the
+     * RIS adds outside that window, or removes, is picked up by the next reconcile.
+     *
+     * A refresh only moves the window once recordSuccess() is called for it; a failed one is
+     * retried with the same start.
+     */
+    class WorklistRefreshPlanner
+    {
+    public:
+        explicit WorklistRefreshPlanner(const WorklistRefreshPolicy& policy = WorklistRefreshPolicy());
+
+        /**
+         * @brief Sets the keys every refresh matches on, before the policy flags are applied.
+         */
+        void setBaseKeys(const QString& stationAETitle, const QString& modality, const QHash<int, QString>& configuredValues);
+
+        WorklistRefreshPlan next(const QDateTime& now) const;
+        void recordSuccess(const WorklistRefreshPlan& plan);
+
+        /**
+         * @brief Forgets past refreshes; the next one is a full reconcile.
+         */
+        void reset();
+
+    private:
+        WorklistRefreshPolicy m_policy;
+        WorklistMatchingKeys m_baseKeys;
+        QDateTime m_lastSuccessAt;
+        QDateTime m_lastReconcileAt;
+    };
+
+}
+
+#endif // WORKLISTREFRESHPLANNER_H
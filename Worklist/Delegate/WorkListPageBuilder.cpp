@@ -20,6 +20,10 @@ namespace Etrek::Worklist::Delegate {
     {
         auto repository = std::make_shared<WorklistRepository>(params.dbConnection);
         auto scanRepository = std::make_shared<Etrek::ScanProtocol::Repository::ScanProtocolRepository>(params.dbConnection);
+        // Exam-time protocol reads are served from the catalog snapshot once it has loaded;
+        // the embedded store has no protocol tables, only the anatomy registration reads
+        if (!params.embeddedStore)
+            scanRepository->refreshCatalogSnapshotInBackground();
         auto dicomRepository = std::make_shared<Etrek::Dicom::Repository::DicomRepository>(params.dbConnection);
         auto dicomTagRepository = std::make_shared<Etrek::Dicom::Repository::DicomTagRepository>(params.dbConnection);
         std::shared_ptr<IWorklistRepository> irepository = std::static_pointer_cast<IWorklistRepository>(repository);
@@ -5,6 +5,7 @@
 #include <QDateTime>
 #include <QStandardItem>
 #include <QMessageBox>
+#include <QTimer>
 
 #include "WorkListPageDelegate.h"
 #include "WorklistRepository.h"
@@ -17,6 +18,11 @@ using namespace Etrek::Worklist::Repository;
 
 namespace Etrek::Worklist::Delegate
 {
+    namespace {
+        // Entries fetched per step when the worklist is filled progressively
+        constexpr int WORKLIST_PAGE_SIZE = 200;
+    }
+
     WorkListPageDelegate::WorkListPageDelegate(WorkListPage* ui,
         std::shared_ptr<WorklistRepository> repository,
         std::shared_ptr<Etrek::ScanProtocol::Repository::ScanProtocolRepository> scanRepository,
@@ -122,11 +128,31 @@ namespace Etrek::Worklist::Delegate
     }
 
     void WorkListPageDelegate::onClearFilters() {
+        // Start a new load; pages still queued from a previous one are dropped
+        ++loadGeneration;
+        pageCursor = ent::WorklistPageCursor();
+        resetWorklistModel();
+        loadNextWorklistPage(loadGeneration);
+    }
 
-         auto result = repository->getWorklistEntries(nullptr, nullptr);
-         if (result.isSuccess) {
-             loadWorklistData(result.value);
-         }
+    void WorkListPageDelegate::loadNextWorklistPage(quint64 generation) {
+        if (generation != loadGeneration)
+            return;
+
+        // Grid rows come from the display projection; attributes are not loaded
+        auto result = repository->getWorklistDisplayPage(pageCursor, WORKLIST_PAGE_SIZE);
+        if (!result.isSuccess)
+            return;
+
+        for (const auto& displayRow : result.value.Rows)
+            baseModel->appendRow(createRowForDisplay(displayRow));
+
+        if (!result.value.HasMore)
+            return;
+
+        // Yield to the event loop between pages so the table stays responsive while it fills
+        pageCursor = result.value.Next;
+        QTimer::singleShot(0, this, [this, generation]() { loadNextWorklistPage(generation); });
     }
 
     void WorkListPageDelegate::onSearchChanged() {
@@ -186,6 +212,14 @@ namespace Etrek::Worklist::Delegate
     }
 
     void WorkListPageDelegate::loadWorklistData(const QList<ent::WorklistEntry>& entries) {
+        resetWorklistModel();
+
+        // Populate rows
+        for (const auto& entry : entries)
+            baseModel->appendRow(createRowForEntry(entry));
+    }
+
+    void WorkListPageDelegate::resetWorklistModel() {
         baseModel->clear();
 
         // Fixed column headers for consistent worklist display
@@ -205,10 +239,6 @@ namespace Etrek::Worklist::Delegate
 
         // Set model to the view (ensure table is connected)
         ui->setProxyModel(proxyModel);
-
-        // Populate rows
-        for (const auto& entry : entries)
-            baseModel->appendRow(createRowForEntry(entry));
     }
 
     void WorkListPageDelegate::onEntryCreated(const ent::WorklistEntry& entry) {
@@ -302,32 +332,49 @@ namespace Etrek::Worklist::Delegate
         for (const auto& attr : entry.Attributes)
             tagMap[attr.Tag.Name] = attr.TagValue;
 
+        // Same mapping as the display projection maintained by the repositories
+        ent::WorklistDisplayRow displayRow;
+        displayRow.EntryId = entry.Id;
+        displayRow.Status = entry.Status;
+        displayRow.Source = entry.Source;
+        displayRow.CreatedAt = entry.CreatedAt;
+        displayRow.PatientName = tagMap.value("PatientName", "");
+        displayRow.PatientId = tagMap.value("PatientID", "");
+        displayRow.StudyName = tagMap.value("StudyDescription", "");
+        if (displayRow.StudyName.isEmpty()) displayRow.StudyName = tagMap.value("StudyID", "");
+        displayRow.PatientSex = tagMap.value("PatientSex", "");
+        displayRow.PatientBirthDate = tagMap.value("PatientBirthDate", "");
+        displayRow.AccessionNumber = tagMap.value("AccessionNumber", "");
+        displayRow.AdmissionId = tagMap.value("AdmissionID", "");
+
+        return createRowForDisplay(displayRow);
+    }
+
+    QList<QStandardItem*> WorkListPageDelegate::createRowForDisplay(const ent::WorklistDisplayRow& displayRow) const {
         // Helper lambda to create styled item
-        auto createItem = [&entry](const QString& text) -> QStandardItem* {
+        auto createItem = [&displayRow](const QString& text) -> QStandardItem* {
             QStandardItem* item = new QStandardItem(text);
             item->setData(QColor(208, 208, 208), Qt::ForegroundRole);
-            item->setData(entry.Id, Qt::UserRole);  // Store WorklistEntry ID for selection/updates
+            item->setData(displayRow.EntryId, Qt::UserRole);  // Store WorklistEntry ID for selection/updates
             return item;
         };
 
         QList<QStandardItem*> row;
 
         // Column 0: Patient Name (DICOM tag: PatientName)
-        row << createItem(tagMap.value("PatientName", ""));
+        row << createItem(displayRow.PatientName);
 
         // Column 1: Patient ID (DICOM tag: PatientID)
-        row << createItem(tagMap.value("PatientID", ""));
+        row << createItem(displayRow.PatientId);
 
         // Column 2: Study Name (DICOM tag: StudyDescription or StudyID as fallback)
-        QString studyName = tagMap.value("StudyDescription", "");
-        if (studyName.isEmpty()) studyName = tagMap.value("StudyID", "");
-        row << createItem(studyName);
+        row << createItem(displayRow.StudyName);
 
         // Column 3: Gender (DICOM tag: PatientSex)
-        row << createItem(tagMap.value("PatientSex", ""));
+        row << createItem(displayRow.PatientSex);
 
         // Column 4: Birth Date (DICOM tag: PatientBirthDate) - format as readable date
-        QString birthDate = tagMap.value("PatientBirthDate", "");
+        QString birthDate = displayRow.PatientBirthDate;
         if (!birthDate.isEmpty() && birthDate.length() == 8) {
             // Convert DICOM DA format (YYYYMMDD) to display format (YYYY-MM-DD)
             birthDate = QString("%1-%2-%3")
@@ -338,19 +385,19 @@ namespace Etrek::Worklist::Delegate
         row << createItem(birthDate);
 
         // Column 5: Accession Number (DICOM tag: AccessionNumber)
-        row << createItem(tagMap.value("AccessionNumber", ""));
+        row << createItem(displayRow.AccessionNumber);
 
         // Column 6: Admission ID (DICOM tag: AdmissionID)
-        row << createItem(tagMap.value("AdmissionID", ""));
+        row << createItem(displayRow.AdmissionId);
 
         // Column 7: Status (from WorklistEntry.Status enum)
-        row << createItem(ProcedureStepStatusToString(entry.Status));
+        row << createItem(ProcedureStepStatusToString(displayRow.Status));
 
         // Column 8: Source (from WorklistEntry.Source enum)
-        row << createItem(SourceToString(entry.Source));
+        row << createItem(SourceToString(displayRow.Source));
 
         // Column 9: Created At (from WorklistEntry.CreatedAt timestamp)
-        row << createItem(entry.CreatedAt.toString("yyyy-MM-dd HH:mm"));
+        row << createItem(displayRow.CreatedAt.toString("yyyy-MM-dd HH:mm"));
 
         return row;
     }
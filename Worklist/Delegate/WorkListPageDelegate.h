@@ -68,18 +68,23 @@ namespace Etrek::Worklist::Delegate {
         void applyFilters();
         void applySearch();
         void loadWorklistData(const QList<ent::WorklistEntry>& entries);
+        void loadNextWorklistPage(quint64 generation);
+        void resetWorklistModel();
         void onClearSearch();
 
 
         WorkListPage* ui;
         QList<ent::DicomTag> getDisplayTagList() const;
         QList<QStandardItem*> createRowForEntry(const ent::WorklistEntry& entry) const;
+        QList<QStandardItem*> createRowForDisplay(const ent::WorklistDisplayRow& displayRow) const;
         QPointer<QStandardItemModel> baseModel;
         QPointer<QSortFilterProxyModel> proxyModel;
         std::shared_ptr<repo::WorklistRepository> repository;
         std::shared_ptr<Etrek::ScanProtocol::Repository::ScanProtocolRepository> scanRepository;
         std::shared_ptr<Etrek::Dicom::Repository::DicomRepository> dicomRepository;
         std::shared_ptr<Etrek::Dicom::Repository::DicomTagRepository> dicomTagRepository;
+        ent::WorklistPageCursor pageCursor;
+        quint64 loadGeneration = 0;
 
         void apply() override;
         void accept() override;
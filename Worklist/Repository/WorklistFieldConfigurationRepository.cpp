@@ -3,6 +3,8 @@
 #include "WorklistFieldConfigurationRepository.h"
 #include "DatabaseConnectionSetting.h"
 #include "AppLoggerFactory.h"
+#include "DatabaseConnectionPool.h"
+#include "QueryStatistics.h"
 #include "MessageKey.h"
 
 
@@ -16,6 +18,8 @@ namespace Etrek::Worklist::Repository
 	using Etrek::Core::Log::LoggerProvider;
     using Etrek::Specification::Result;
 	using Etrek::Core::Data::Model::DatabaseConnectionSetting;
+    using Etrek::Core::Repository::DatabaseConnectionPool;
+    using Etrek::Core::Repository::QueryStatistics;
 
 
     WorklistFieldConfigurationRepository::WorklistFieldConfigurationRepository(std::shared_ptr<DatabaseConnectionSetting> connectionSetting)
@@ -26,26 +30,15 @@ namespace Etrek::Worklist::Repository
         logger = factory.CreateLogger("WorklistRepository");
     }
 
-    QSqlDatabase WorklistFieldConfigurationRepository::createConnection(const QString& connectionName) const {
-        QSqlDatabase db = QSqlDatabase::addDatabase("QMYSQL", connectionName);
-        db.setHostName(m_connectionSetting->getHostName());
-        db.setDatabaseName(m_connectionSetting->getDatabaseName());
-        db.setUserName(m_connectionSetting->getEtrekUserName());
-        db.setPassword(m_connectionSetting->getPassword());
-        db.setPort(m_connectionSetting->getPort());
-        return db;
-    }
-
     Result<QVector<WorklistFieldConfiguration>> WorklistFieldConfigurationRepository::getAll() const
     {
         QVector<WorklistFieldConfiguration> result;
 
-        QString connectionName = "worklist_field_configuration_get_all";
-		
         {
-			QSqlDatabase db = createConnection(connectionName);
-			if (!db.open()) {
-				QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+			auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+			QSqlDatabase& db = lease.database();
+			if (!db.isOpen()) {
+				QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
 				logger->LogError(error);
 				qDebug() << error;
                 return Result<QVector<WorklistFieldConfiguration>>::Failure(error); // Return empty vector on failure
@@ -53,7 +46,7 @@ namespace Etrek::Worklist::Repository
 
             QSqlQuery query(db);
             query.prepare("SELECT Id, field_name, is_enabled FROM worklist_field_configurations");
-            if (!query.exec()) {
+            if (!QueryStatistics::exec(query)) {
                 QString error = translator->getErrorMessage(MWL_FAILED_TO_RETRIEVE_IDENTIFIER_ERROR);
                 logger->LogError(error);
                 qDebug() << error;
@@ -75,12 +68,12 @@ namespace Etrek::Worklist::Repository
     Result<WorklistFieldConfiguration> WorklistFieldConfigurationRepository::getByFieldName(WorklistFieldName fieldName) const
     {
         WorklistFieldConfiguration config;
-        QString connectionName = "worklist_field_configuration_get_by_field_name";
 
         {
-            QSqlDatabase db = createConnection(connectionName);
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
 
-            if (!db.open()) {
+            if (!db.isOpen()) {
                 QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG);
                 logger->LogError(error);
                 qDebug() << error;
@@ -90,7 +83,7 @@ namespace Etrek::Worklist::Repository
             query.prepare("SELECT Id, field_name, is_enabled FROM worklist_field_configurations WHERE field_name = :field_name");
             query.bindValue(":field_name", WorklistFieldNameToString(fieldName));
 
-            if (!query.exec()) {
+            if (!QueryStatistics::exec(query)) {
                 QString error = translator->getErrorMessage(MWL_FAILED_TO_RETRIEVE_IDENTIFIER_ERROR);
                 logger->LogError(error);
                 qDebug() << error;
@@ -109,14 +102,14 @@ namespace Etrek::Worklist::Repository
     {
         WorklistFieldConfiguration config;
         bool result = false;
-        QString connectionName = "worklist_field_configuration_get_by_field_name";
         {
-            QSqlDatabase db = createConnection(connectionName);
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
             QSqlQuery query(db);
             query.prepare("UPDATE worklist_field_configurations SET is_enabled = :is_enabled WHERE field_name = :field_name");
             query.bindValue(":is_enabled", isEnabled);
             query.bindValue(":field_name", WorklistFieldNameToString(fieldName));
-            result = query.exec();
+            result = QueryStatistics::exec(query);
         }
         return Result<bool>::Success(result);
     }
@@ -28,8 +28,6 @@ namespace Etrek::Worklist::Repository
         Etrek::Specification::Result<bool> updateIsEnabled(WorklistFieldName fieldName, bool isEnabled);
 
     private:
-        QSqlDatabase createConnection(const QString& connectionName) const;
-
         std::shared_ptr<Etrek::Core::Data::Model::DatabaseConnectionSetting> m_connectionSetting;
         Etrek::Core::Globalization::TranslationProvider* translator;
         std::shared_ptr<Etrek::Core::Log::AppLogger> logger;
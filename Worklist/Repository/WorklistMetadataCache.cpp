@@ -0,0 +1,85 @@
+#include "WorklistMetadataCache.h"
+#include <algorithm>
+#include <atomic>
+#include "PerConnectionRegistry.h"
+
+namespace Etrek::Worklist::Repository {
+
+    using Etrek::Core::Data::Model::DatabaseConnectionSetting;
+    using Etrek::Core::Repository::PerConnectionRegistry;
+    using Etrek::Worklist::Data::Entity::DicomTag;
+
+    std::shared_ptr<WorklistMetadataCache> WorklistMetadataCache::forDatabase(const DatabaseConnectionSetting& setting)
+    {
+        static PerConnectionRegistry<WorklistMetadataCache> registry;
+        return registry.instanceFor(setting, [] { return std::make_shared<WorklistMetadataCache>(); });
+    }
+
+    WorklistMetadataCache::WorklistMetadataCache()
+        : m_snapshot(std::make_shared<const WorklistMetadataSnapshot>())
+    {
+    }
+
+    std::shared_ptr<const WorklistMetadataSnapshot> WorklistMetadataCache::snapshot() const
+    {
+        return std::atomic_load(&m_snapshot);
+    }
+
+    template <typename Mutation>
+    void WorklistMetadataCache::replace(Mutation mutate)
+    {
+        auto current = std::atomic_load(&m_snapshot);
+        for (;;) {
+            auto next = std::make_shared<WorklistMetadataSnapshot>(*current);
+            if (!mutate(*next))
+                return;
+            if (std::atomic_compare_exchange_weak(&m_snapshot, &current, std::shared_ptr<const WorklistMetadataSnapshot>(std::move(next))))
+                return;
+        }
+    }
+
+    bool WorklistMetadataCache::publish(int profileId, std::shared_ptr<const ProfileTagMetadata> metadata, quint64 loadedAtVersion)
+    {
+        bool stored = false;
+        replace([&](WorklistMetadataSnapshot& next) {
+            stored = next.Version == loadedAtVersion;
+            if (stored)
+                next.Profiles.insert(profileId, metadata);
+            return stored;
+        });
+        return stored;
+    }
+
+    void WorklistMetadataCache::invalidateProfile(int profileId)
+    {
+        replace([profileId](WorklistMetadataSnapshot& next) {
+            next.Profiles.remove(profileId);
+            ++next.Version;
+            return true;
+        });
+    }
+
+    void WorklistMetadataCache::invalidateTag(int tagId)
+    {
+        replace([tagId](WorklistMetadataSnapshot& next) {
+            for (auto it = next.Profiles.begin(); it != next.Profiles.end();) {
+                const auto& tags = it.value()->Tags;
+                const bool containsTag = std::any_of(tags.cbegin(), tags.cend(),
+                    [tagId](const DicomTag& tag) { return tag.Id == tagId; });
+                it = containsTag ? next.Profiles.erase(it) : std::next(it);
+            }
+            ++next.Version;
+            return true;
+        });
+    }
+
+    void WorklistMetadataCache::invalidateAll()
+    {
+        replace([](WorklistMetadataSnapshot& next) {
+            next.Profiles.clear();
+            ++next.Version;
+            return true;
+        });
+    }
+
+} // namespace Etrek::Worklist::Repository
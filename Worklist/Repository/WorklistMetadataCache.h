@@ -0,0 +1,92 @@
+#ifndef WORKLISTMETADATACACHE_H
+#define WORKLISTMETADATACACHE_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <memory>
+#include "DicomTag.h"
+#include "DatabaseConnectionSetting.h"
+
+namespace Etrek::Worklist::Repository {
+
+    /**
+     * @brief Tags of one worklist profile split by their profile_tag_association flags.
+     */
+    struct ProfileTagMetadata {
+        QList<Etrek::Worklist::Data::Entity::DicomTag> Tags;                  // All tags of the profile
+        QList<Etrek::Worklist::Data::Entity::DicomTag> Identifiers;           // is_identifier
+        QList<Etrek::Worklist::Data::Entity::DicomTag> ActiveIdentifiers;     // is_identifier and the tag is active
+        QList<Etrek::Worklist::Data::Entity::DicomTag> MandatoryIdentifiers;  // is_mandatory
+        QHash<int, QString> MatchingValues;                                   // matching_value by tag id, where set
+    };
+
+    /**
+     * @brief Immutable view of the cached profile metadata at one version.
+     */
+    struct WorklistMetadataSnapshot {
+        quint64 Version = 0;
+        QHash<int, std::shared_ptr<const ProfileTagMetadata>> Profiles;
+    };
+
+    /**
+     * @class WorklistMetadataCache
+     * @brief Process-wide cache of worklist profile tag metadata, one per database.
+     *
+     * Readers take the current snapshot with a single atomic load and never block; the
+     * snapshot they hold stays valid even if it is replaced meanwhile. Writers build a new
+     * snapshot and swap it in with compare-and-swap.
+     *
+     * Every invalidation bumps the version. A profile loaded from the database is only
+     * published if the version it was loaded at is still current, so a load racing with an
+     * update can never put stale metadata back into the cache.
+     */
+    class WorklistMetadataCache
+    {
+    public:
+        /**
+         * @brief Returns the cache shared by all repositories connected to the same database.
+         */
+        static std::shared_ptr<WorklistMetadataCache> forDatabase(const Etrek::Core::Data::Model::DatabaseConnectionSetting& setting);
+
+        WorklistMetadataCache();
+
+        WorklistMetadataCache(const WorklistMetadataCache&) = delete;
+        WorklistMetadataCache& operator=(const WorklistMetadataCache&) = delete;
+
+        /**
+         * @brief Returns the current snapshot. Lock-free.
+         */
+        std::shared_ptr<const WorklistMetadataSnapshot> snapshot() const;
+
+        /**
+         * @brief Adds the metadata of a profile loaded at @p loadedAtVersion.
+         * @return False if the cache was invalidated since, in which case nothing is stored.
+         */
+        bool publish(int profileId, std::shared_ptr<const ProfileTagMetadata> metadata, quint64 loadedAtVersion);
+
+        /**
+         * @brief Drops the metadata of one profile, e.g. after its identifier flags changed.
+         */
+        void invalidateProfile(int profileId);
+
+        /**
+         * @brief Drops the metadata of every cached profile that contains @p tagId.
+         */
+        void invalidateTag(int tagId);
+
+        /**
+         * @brief Drops all cached metadata.
+         */
+        void invalidateAll();
+
+    private:
+        template <typename Mutation>
+        void replace(Mutation mutate);
+
+        std::shared_ptr<const WorklistMetadataSnapshot> m_snapshot;
+    };
+
+} // namespace Etrek::Worklist::Repository
+
+#endif // WORKLISTMETADATACACHE_H
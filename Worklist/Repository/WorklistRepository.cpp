@@ -2,11 +2,19 @@
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QSqlError>
-#include <QRandomGenerator>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QSet>
+#include <QCryptographicHash>
+#include <algorithm>
 
 #include "WorklistEnum.h"
 #include "AppLoggerFactory.h"
+#include "DatabaseConnectionPool.h"
+#include "QueryStatistics.h"
+#include "BulkInsertWriter.h"
+#include "SqlDialect.h"
+#include "WorklistDisplayProjection.h"
 #include "MessageKey.h"
 #include "DatabaseConnectionSetting.h"
 #include "TranslationProvider.h"
@@ -23,9 +31,130 @@ namespace Etrek::Worklist::Repository {
 	using namespace Etrek::Core::Globalization;
     using namespace Etrek::Core::Log;
     using namespace Etrek::Specification;
+    using Etrek::Core::Repository::DatabaseConnectionPool;
+    using Etrek::Core::Repository::QueryStatistics;
+    using Etrek::Core::Repository::ConnectionLease;
+    using Etrek::Core::Repository::BulkInsertWriter;
+    using Etrek::Core::Repository::SqlDialect;
+
+    namespace {
+        // Ids per IN (...) list when resolving or loading entries in bulk.
+        constexpr int INGEST_BATCH_SIZE = 500;
+
+        // Page size used when a full range is read through the keyset reader.
+        constexpr int WORKLIST_PAGE_SIZE = 500;
+        // Upper bound for caller supplied page sizes; one page's ids go into a single IN (...) list.
+        constexpr int WORKLIST_MAX_PAGE_SIZE = INGEST_BATCH_SIZE;
+        // Entries per transaction when deleting by date.
+        constexpr int DELETE_CHUNK_SIZE = 200;
+
+        // Keep in sync with Script/Migration/0001_mwl_identity_fingerprint.sql:
+        // MySQL TRIM() only strips spaces and LOWER() folds case.
+        QString normalizeIdentifierValue(const QString& value)
+        {
+            int begin = 0;
+            int end = value.size();
+            while (begin < end && value.at(begin) == QLatin1Char(' '))
+                ++begin;
+            while (end > begin && value.at(end - 1) == QLatin1Char(' '))
+                --end;
+            return value.mid(begin, end - begin).toLower();
+        }
+
+        // SHA-256 of "tagId=value" pairs joined with '|' in tag id order; empty when there are no identifiers.
+        QString identityFingerprint(const QMap<int, QString>& identifierValues)
+        {
+            if (identifierValues.isEmpty())
+                return QString();
+
+            QStringList parts;
+            for (auto it = identifierValues.constBegin(); it != identifierValues.constEnd(); ++it)
+                parts << QString::number(it.key()) + QLatin1Char('=') + normalizeIdentifierValue(it.value());
+            return QString::fromLatin1(QCryptographicHash::hash(parts.join('|').toUtf8(), QCryptographicHash::Sha256).toHex());
+        }
+
+        QString identityFingerprint(const WorklistEntry& entry, const QSet<int>& identifierTagIds)
+        {
+            QMap<int, QString> identifierValues;
+            for (const WorklistAttribute& attr : entry.Attributes) {
+                if (attr.Tag.IsActive && identifierTagIds.contains(attr.Tag.Id))
+                    identifierValues[attr.Tag.Id] = attr.TagValue;
+            }
+            return identityFingerprint(identifierValues);
+        }
+
+        QVariant fingerprintValue(const QString& fingerprint)
+        {
+            return fingerprint.isEmpty() ? QVariant(QVariant::String) : QVariant(fingerprint);
+        }
+
+        // Identifier values of the entries a fingerprint refresh covers, in entry id order.
+        constexpr auto IDENTIFIER_VALUES_SQL = R"(
+            SELECT a.mwl_entry_id, me.profile_id, a.dicom_tag_id, a.tag_value
+            FROM mwl_attributes a
+            JOIN mwl_entries me ON me.id = a.mwl_entry_id
+            JOIN profile_tag_association pta ON pta.profile_id = me.profile_id AND pta.tag_id = a.dicom_tag_id AND pta.is_identifier = TRUE
+            JOIN dicom_tags t ON t.id = a.dicom_tag_id AND t.is_active = TRUE
+            WHERE (:allProfiles OR me.profile_id = :profileId)
+            ORDER BY a.mwl_entry_id
+        )";
+
+        QMap<int, QString> activeTagValues(const WorklistEntry& entry)
+        {
+            QMap<int, QString> values;
+            for (const WorklistAttribute& attr : entry.Attributes) {
+                if (attr.Tag.IsActive)
+                    values[attr.Tag.Id] = attr.TagValue;
+            }
+            return values;
+        }
+
+        // Date range, keyset condition on (created_at DESC, id DESC) and LIMIT for one page.
+        // Entries without created_at sort last. Every branch is a range on idx_mwl_entries_created_at_id,
+        // so no page scans the rows before it. One extra row tells whether another page follows.
+        QString keysetPageClause(const WorklistPageCursor& after, const QDateTime* from, const QDateTime* to)
+        {
+            QString sql;
+            if (from && from->isValid())
+                sql += " AND created_at >= :from ";
+            if (to && to->isValid())
+                sql += " AND created_at <= :to ";
+
+            if (!after.isStart()) {
+                if (after.CreatedAt.isValid())
+                    sql += " AND (created_at < :afterCreatedAt OR (created_at = :afterCreatedAt AND id < :afterId) OR created_at IS NULL) ";
+                else
+                    sql += " AND created_at IS NULL AND id < :afterId ";
+            }
+
+            sql += " ORDER BY created_at DESC, id DESC LIMIT :limit";
+            return sql;
+        }
+
+        void bindKeysetPage(QSqlQuery& query, const WorklistPageCursor& after, int pageSize, const QDateTime* from, const QDateTime* to)
+        {
+            if (from && from->isValid()) query.bindValue(":from", *from);
+            if (to && to->isValid()) query.bindValue(":to", *to);
+            if (!after.isStart()) {
+                if (after.CreatedAt.isValid()) query.bindValue(":afterCreatedAt", after.CreatedAt);
+                query.bindValue(":afterId", after.Id);
+            }
+            query.bindValue(":limit", pageSize + 1);
+        }
+
+        QString placeholderList(int count, const QString& item)
+        {
+            QStringList items;
+            items.reserve(count);
+            for (int i = 0; i < count; ++i)
+                items << item;
+            return items.join(",");
+        }
+    }
 
     WorklistRepository::WorklistRepository(std::shared_ptr<DatabaseConnectionSetting> connectionSetting, QObject* parent)
         : m_connectionSetting(connectionSetting), translator(nullptr), logger(nullptr)
+        , m_metadataCache(WorklistMetadataCache::forDatabase(*connectionSetting))
     {
 
         translator = &TranslationProvider::Instance();
@@ -33,33 +162,22 @@ namespace Etrek::Worklist::Repository {
         logger = factory.CreateLogger("WorklistRepository");
     }
 
-    QSqlDatabase WorklistRepository::createConnection(const QString& connectionName) const {
-        QSqlDatabase db = QSqlDatabase::addDatabase("QMYSQL", connectionName);
-        db.setHostName(m_connectionSetting->getHostName());
-        db.setDatabaseName(m_connectionSetting->getDatabaseName());
-        db.setUserName(m_connectionSetting->getEtrekUserName());
-        db.setPassword(m_connectionSetting->getPassword());
-        db.setPort(m_connectionSetting->getPort());
-        return db;
-    }
-
     Result<QList<WorklistProfile>> WorklistRepository::getProfiles() const {
         QList<WorklistProfile> profiles;
 
-        QString connName = "conn_get_profiles_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(connName);
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
 
-            if (!db.open()) {
-                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            if (!db.isOpen()) {
+                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(error);
                 qDebug()<<error;
                 return Result<QList<WorklistProfile>>::Failure(error);
             }
 
             // Fetch profiles along with associated presentation context and tags
-            QSqlQuery query(db);
-            query.prepare(R"(
+            QSqlQuery& query = lease.prepare(R"(
                 SELECT p.id AS profile_id, p.name AS profile_name,
                        pc.id AS context_id, pc.transfer_syntax_uid,
                        t.id AS tag_id, t.name AS tag_name  -- Added tag_id and tag_name
@@ -69,7 +187,7 @@ namespace Etrek::Worklist::Repository {
                 LEFT JOIN dicom_tags t ON pta.tag_id = t.id
             )");
 
-            if (!query.exec()) {
+            if (!QueryStatistics::exec(query)) {
                 QString error = translator->getErrorMessage(MWL_QUERY_FAILED_MSG).arg(query.lastError().text());
                 logger->LogError(error);
                 qDebug()<<error;
@@ -114,126 +232,54 @@ namespace Etrek::Worklist::Repository {
             // Now convert the map of profiles to a list
             profiles = profilesMap.values();
         }
-        QSqlDatabase::removeDatabase(connName); // ✅ SAFE — all references destroyed
         return Result<QList<WorklistProfile>>::Success(profiles);
     }
 
     Result<QList<DicomTag>> WorklistRepository::getTagsByProfile(int profileId) const {
-        QList<DicomTag> tags;
-        QString connName = "conn_get_tags_" + QString::number(QRandomGenerator::global()->generate());
-        {
-            QSqlDatabase db = createConnection(connName);
-
-            if (!db.open()) {
-                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
-                logger->LogError(error);
-                qDebug()<<error;
-                return Result<QList<DicomTag>>::Failure(error);
-            }
-
-            QSqlQuery query(db);
-            query.prepare(R"(
-                SELECT t.id, t.name, t.display_name, t.group_hex, t.element_hex, t.pgroup_hex, t.pelement_hex, t.is_active, t.is_retired
-                FROM dicom_tags t
-                JOIN profile_tag_association pta ON t.id = pta.tag_id
-                WHERE pta.profile_id = :profileId
-            )");
-            query.bindValue(":profileId", profileId);
-
-            if (!query.exec()) {
-                QString error = translator->getErrorMessage(MWL_QUERY_FAILED_MSG).arg(query.lastError().text());
-                logger->LogError(error);
-                qDebug()<<error;
-                return Result<QList<DicomTag>>::Failure(error);
-            }
+        auto metadataResult = profileMetadata(profileId);
+        if (!metadataResult.isSuccess) {
+            return Result<QList<DicomTag>>::Failure(metadataResult.message);
+        }
+        return Result<QList<DicomTag>>::Success(metadataResult.value->Tags);
+    }
 
-            while (query.next()) {
-                DicomTag tag;
-                tag.Id = query.value("id").toInt();
-                tag.Name = query.value("name").toString();
-                tag.DisplayName = query.value("display_name").toString();
-                tag.GroupHex = query.value("group_hex").toUInt();
-                tag.ElementHex = query.value("element_hex").toUInt();
-                tag.PgroupHex = query.value("pgroup_hex").toUInt();
-                tag.PelementHex = query.value("pelement_hex").toUInt();
-                tag.IsActive = query.value("is_active").toBool();
-                tag.IsRetired = query.value("is_retired").toBool();
-                tags.append(tag);
-            }
+    Result<QHash<int, QString>> WorklistRepository::getMatchingValuesByProfile(int profileId) const {
+        auto metadataResult = profileMetadata(profileId);
+        if (!metadataResult.isSuccess) {
+            return Result<QHash<int, QString>>::Failure(metadataResult.message);
         }
-        QSqlDatabase::removeDatabase(connName);
-        return Result<QList<DicomTag>>::Success(tags);
+        return Result<QHash<int, QString>>::Success(metadataResult.value->MatchingValues);
     }
 
     Result<QList<DicomTag>> WorklistRepository::getIdentifiersByProfile(int profileId) const {
-        QList<DicomTag> tags;
-        QString connName = "conn_get_tags_" + QString::number(QRandomGenerator::global()->generate());
-        {
-            QSqlDatabase db = createConnection(connName);
-
-            if (!db.open()) {
-                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
-                logger->LogError(error);
-                qDebug()<<error;
-                return Result<QList<DicomTag>>::Failure(error);
-            }
-
-            QSqlQuery query(db);
-            query.prepare(R"(
-                SELECT t.id, t.name, t.display_name, t.group_hex, t.element_hex, t.pgroup_hex, t.pelement_hex, t.is_active, t.is_retired
-                FROM dicom_tags t
-                JOIN profile_tag_association pta ON t.id = pta.tag_id
-                WHERE pta.profile_id = :profileId AND  pta.is_identifier =1
-            )");
-            query.bindValue(":profileId", profileId);
-
-            if (!query.exec()) {
-                QString error = translator->getErrorMessage(MWL_QUERY_FAILED_MSG).arg(query.lastError().text());
-                logger->LogError(error);
-                qDebug()<<error;
-                return Result<QList<DicomTag>>::Failure(error);
-            }
-
-            while (query.next()) {
-                DicomTag tag;
-                tag.Id = query.value("id").toInt();
-                tag.Name = query.value("name").toString();
-                tag.DisplayName = query.value("display_name").toString();
-                tag.GroupHex = query.value("group_hex").toUInt();
-                tag.ElementHex = query.value("element_hex").toUInt();
-                tag.PgroupHex = query.value("pgroup_hex").toUInt();
-                tag.PelementHex = query.value("pelement_hex").toUInt();
-                tag.IsActive = query.value("is_active").toBool();
-                tag.IsRetired = query.value("is_retired").toBool();
-                tags.append(tag);
-            }
+        auto metadataResult = profileMetadata(profileId);
+        if (!metadataResult.isSuccess) {
+            return Result<QList<DicomTag>>::Failure(metadataResult.message);
         }
-        QSqlDatabase::removeDatabase(connName);
-        return Result<QList<DicomTag>>::Success(tags);
+        return Result<QList<DicomTag>>::Success(metadataResult.value->Identifiers);
     }
 
     Result<WorklistEntry> WorklistRepository::getWorklistEntryById(int entryId) const {
-        QString connName = "conn_get_worklist_" + QString::number(QRandomGenerator::global()->generate());
         WorklistEntry entry;
         {
-            QSqlDatabase db = createConnection(connName);
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
 
-            if (!db.open()) {
-                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            if (!db.isOpen()) {
+                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(error);
                 qDebug()<<error;
                 return Result<WorklistEntry>::Failure(error);
             }
 
-            QSqlQuery query(db);
-            query.prepare(R"(
+            QSqlQuery& query = lease.prepare(R"(
                 SELECT id, source, profile_id, status, created_at, updated_at
                 FROM mwl_entries
                 WHERE id = :entryId
             )");
             query.bindValue(":entryId", entryId);
 
-            if (!query.exec() || !query.next()) {
+            if (!QueryStatistics::exec(query) || !query.next()) {
                 QString error = translator->getErrorMessage(MWL_ENTRY_NOT_FOUND_OR_QUERY_FAILED_MSG);
                 logger->LogError(error);
                 qDebug()<<error;
@@ -249,8 +295,7 @@ namespace Etrek::Worklist::Repository {
             entry.CreatedAt = query.value("created_at").toDateTime();
             entry.UpdatedAt = query.value("updated_at").toDateTime();
 
-            QSqlQuery attrQuery(db);
-            attrQuery.prepare(R"(
+            QSqlQuery& attrQuery = lease.prepare(R"(
                 SELECT wa.id, wa.tag_value, t.id AS tag_id, t.name, t.display_name, t.group_hex, t.element_hex, t.pgroup_hex, t.pelement_hex, t.is_active, t.is_retired
                 FROM mwl_attributes wa
                 JOIN dicom_tags t ON wa.dicom_tag_id = t.id
@@ -258,7 +303,7 @@ namespace Etrek::Worklist::Repository {
             )");
             attrQuery.bindValue(":entryId", entryId);
 
-            if (!attrQuery.exec()) {
+            if (!QueryStatistics::exec(attrQuery)) {
                 QString error = translator->getErrorMessage(MWL_FAILED_TO_LOAD_ATTRIBUTES_MSG);
                 logger->LogError(error);
                 qDebug()<<error;
@@ -283,96 +328,183 @@ namespace Etrek::Worklist::Repository {
             }
         }
 
-        QSqlDatabase::removeDatabase(connName);
         return Result<WorklistEntry>::Success(entry);
     }
 
     Result<QList<WorklistEntry>> WorklistRepository::getWorklistEntries(const QDateTime* from, const QDateTime* to) const {
         QList<WorklistEntry> entries;
-        const QString connName = "conn_get_entries_" + QString::number(QRandomGenerator::global()->generate());
+        WorklistPageCursor cursor;
+
+        // Read page by page so attribute lookups stay bounded however many entries match
+        do {
+            auto pageResult = getWorklistEntriesPage(cursor, WORKLIST_PAGE_SIZE, from, to);
+            if (!pageResult.isSuccess) {
+                return Result<QList<WorklistEntry>>::Failure(pageResult.message);
+            }
+
+            entries.append(pageResult.value.Entries);
+            if (!pageResult.value.HasMore)
+                break;
+            cursor = pageResult.value.Next;
+        } while (true);
+
+        return Result<QList<WorklistEntry>>::Success(entries);
+    }
+
+    Result<WorklistEntryPage> WorklistRepository::getWorklistEntriesPage(const WorklistPageCursor& after, int pageSize, const QDateTime* from, const QDateTime* to) const {
+        WorklistEntryPage page;
+        pageSize = qBound(1, pageSize, WORKLIST_MAX_PAGE_SIZE);
 
         {
-            // This block ensures everything is destroyed before removeDatabase
-            QSqlDatabase db = createConnection(connName);
-            if (!db.open()) {
-                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(error);
                 qDebug()<<error;
-                return Result<QList<WorklistEntry>>::Failure(error);
+                return Result<WorklistEntryPage>::Failure(error);
             }
 
             QString sql = R"(SELECT id, source, profile_id, status, created_at, updated_at FROM mwl_entries WHERE 1=1 )";
-
-            if (from && from->isValid()) {
-                sql += " AND created_at >= :from ";
-            }
-            if (to && to->isValid()) {
-                sql += " AND created_at <= :to ";
-            }
+            sql += keysetPageClause(after, from, to);
 
             QSqlQuery query(db);
             query.prepare(sql);
+            bindKeysetPage(query, after, pageSize, from, to);
 
-            if (from && from->isValid()) query.bindValue(":from", *from);
-            if (to && to->isValid()) query.bindValue(":to", *to);
-
-            if (!query.exec()) {
+            if (!QueryStatistics::exec(query)) {
                 QString error = translator->getErrorMessage(MWL_QUERY_FAILED_MSG).arg(query.lastError().text());
                 logger->LogError(error);
                 qDebug()<<error;
-                return Result<QList<WorklistEntry>>::Failure(error);
+                return Result<WorklistEntryPage>::Failure(error);
             }
 
             QList<int> entryIds;
             while (query.next()) {
+                if (page.Entries.size() == pageSize) {
+                    page.HasMore = true;
+                    break;
+                }
+
                 WorklistEntry entry;
                 entry.Id = query.value("id").toInt();
-                entry.Source = static_cast<Source>(query.value("source").toInt());
+                entry.Source = QStringToSource(query.value("source").toString());
                 entry.Profile.Id = query.value("profile_id").toInt();
-                entry.Status = static_cast<ProcedureStepStatus>(query.value("status").toInt());
+                entry.Status = QStringToStatus(query.value("status").toString());
                 entry.CreatedAt = query.value("created_at").toDateTime();
                 entry.UpdatedAt = query.value("updated_at").toDateTime();
 
-                entries.append(entry);
+                page.Entries.append(entry);
                 entryIds.append(entry.Id);
             }
 
+            if (!page.Entries.isEmpty()) {
+                page.Next.CreatedAt = page.Entries.last().CreatedAt;
+                page.Next.Id = page.Entries.last().Id;
+            } else {
+                page.Next = after;
+            }
+
             auto attributesMap = loadAttributesForEntries(entryIds, db);
 
-            for (auto& entry : entries) {
+            for (auto& entry : page.Entries) {
                 if (attributesMap.contains(entry.Id)) {
                     entry.Attributes = attributesMap[entry.Id];
                 }
             }
         }
 
-        QSqlDatabase::removeDatabase(connName);  // ✅ safe: all objects referencing the db are destroyed
+        return Result<WorklistEntryPage>::Success(page);
+    }
 
-        return Result<QList<WorklistEntry>>::Success(entries);
+    Result<WorklistDisplayPage> WorklistRepository::getWorklistDisplayPage(const WorklistPageCursor& after, int pageSize, const QDateTime* from, const QDateTime* to) const {
+        WorklistDisplayPage page;
+        pageSize = qBound(1, pageSize, WORKLIST_MAX_PAGE_SIZE);
+
+        {
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
+                logger->LogError(error);
+                qDebug()<<error;
+                return Result<WorklistDisplayPage>::Failure(error);
+            }
+
+            // The grid reads the materialized display columns only; no attribute join
+            QString sql = R"(
+                SELECT id, source, source_connection, status, created_at,
+                       display_patient_name, display_patient_id, display_study_name, display_patient_sex,
+                       display_birth_date, display_accession_number, display_admission_id
+                FROM mwl_entries WHERE 1=1 )";
+            sql += keysetPageClause(after, from, to);
+
+            QSqlQuery query(db);
+            query.setForwardOnly(true);
+            query.prepare(sql);
+            bindKeysetPage(query, after, pageSize, from, to);
+
+            if (!QueryStatistics::exec(query)) {
+                QString error = translator->getErrorMessage(MWL_QUERY_FAILED_MSG).arg(query.lastError().text());
+                logger->LogError(error);
+                qDebug()<<error;
+                return Result<WorklistDisplayPage>::Failure(error);
+            }
+
+            while (query.next()) {
+                if (page.Rows.size() == pageSize) {
+                    page.HasMore = true;
+                    break;
+                }
+
+                WorklistDisplayRow row;
+                row.EntryId = query.value("id").toInt();
+                row.Source = QStringToSource(query.value("source").toString());
+                row.SourceConnection = query.value("source_connection").toString();
+                row.Status = QStringToStatus(query.value("status").toString());
+                row.CreatedAt = query.value("created_at").toDateTime();
+                row.PatientName = query.value("display_patient_name").toString();
+                row.PatientId = query.value("display_patient_id").toString();
+                row.StudyName = query.value("display_study_name").toString();
+                row.PatientSex = query.value("display_patient_sex").toString();
+                row.PatientBirthDate = query.value("display_birth_date").toString();
+                row.AccessionNumber = query.value("display_accession_number").toString();
+                row.AdmissionId = query.value("display_admission_id").toString();
+                page.Rows.append(row);
+            }
+
+            if (!page.Rows.isEmpty()) {
+                page.Next.CreatedAt = page.Rows.last().CreatedAt;
+                page.Next.Id = page.Rows.last().EntryId;
+            } else {
+                page.Next = after;
+            }
+        }
+
+        return Result<WorklistDisplayPage>::Success(page);
     }
 
     Result<QList<WorklistEntry>> WorklistRepository::getWorklistEntries(Source source) const {
         QList<WorklistEntry> entries;
-        QString connName = "conn_get_entries_src_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(connName);
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
 
-            if (!db.open()) {
-                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            if (!db.isOpen()) {
+                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(error);
                 qDebug()<<error;
                 return Result<QList< WorklistEntry>>::Failure(error);
             }
 
-            QSqlQuery query(db);
-            query.prepare(R"(
+            QSqlQuery& query = lease.prepare(R"(
                 SELECT id, source, profile_id, status, created_at, updated_at
                 FROM mwl_entries
                 WHERE source = :source
             )");
             query.bindValue(":source", static_cast<int>(source));
 
-            if (!query.exec()) {
+            if (!QueryStatistics::exec(query)) {
                 QString error = translator->getErrorMessage(MWL_QUERY_FAILED_MSG).arg(query.lastError().text());
                 logger->LogError(error);
                 qDebug()<<error;
@@ -403,32 +535,30 @@ namespace Etrek::Worklist::Repository {
                 }
             }
         }
-        QSqlDatabase::removeDatabase(connName);
         return Result<QList< WorklistEntry>>::Success(entries);
     }
 
     Result<QList< WorklistEntry>> WorklistRepository::getWorklistEntries(ProcedureStepStatus status) const {
         QList< WorklistEntry> entries;
-        QString connName = "conn_get_entries_status_" + QString::number(QRandomGenerator::global()->generate());
         {
-            QSqlDatabase db = createConnection(connName);
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
 
-            if (!db.open()) {
-                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            if (!db.isOpen()) {
+                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(error);
                 qDebug()<<error;
                 return Result<QList< WorklistEntry>>::Failure(error);
             }
 
-            QSqlQuery query(db);
-            query.prepare(R"(
+            QSqlQuery& query = lease.prepare(R"(
                 SELECT id, source, profile_id, status, created_at, updated_at
                 FROM mwl_entries
                 WHERE status = :status
             )");
             query.bindValue(":status", static_cast<int>(status));
 
-            if (!query.exec()) {
+            if (!QueryStatistics::exec(query)) {
                 QString error = translator->getErrorMessage(MWL_QUERY_FAILED_MSG).arg(query.lastError().text());
                 logger->LogError(error);
                 qDebug()<<error;
@@ -460,90 +590,244 @@ namespace Etrek::Worklist::Repository {
         }
 
         }
-        QSqlDatabase::removeDatabase(connName);
         return Result<QList< WorklistEntry>>::Success(entries);
     }
 
     Result<bool> WorklistRepository::deleteWorklistEntries(const QDateTime& beforeDate) {
-        QString connName = "conn_delete_before_date_" + QString::number(QRandomGenerator::global()->generate());
+        // In chunks, so that no transaction holds mwl_entries and mwl_attributes for long
+        for (;;) {
+            auto purged = purgeWorklistEntries(beforeDate, DELETE_CHUNK_SIZE);
+            if (!purged.isSuccess)
+                return Result<bool>::Failure(purged.message);
+            if (purged.value < DELETE_CHUNK_SIZE)
+                break;
+        }
+        return Result<bool>::Success(true);
+    }
 
+    Result<int> WorklistRepository::purgeWorklistEntries(const QDateTime& beforeDate, int maxEntries) {
         QList<int> entryIds;
 
         {
-            QSqlDatabase db = createConnection(connName);
-
-            if (!db.open()) {
-                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
-                logger->LogError(error);
-                qDebug() << error;
-                return Result<bool>::Failure(error);
-            }
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
 
-            if (!db.transaction()) {
-                QString error = translator->getErrorMessage(MWL_FAILED_TO_START_TRANSACTION_MSG).arg(db.lastError().text());
+            if (!db.isOpen()) {
+                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(error);
                 qDebug() << error;
-                return Result<bool>::Failure(error);
+                return Result<int>::Failure(error);
             }
 
-            // Step 1: Collect IDs of entries to be deleted
-            QSqlQuery selectIds(db);
-            selectIds.prepare("SELECT id FROM mwl_entries WHERE created_at <= :beforeDate");
+            // Oldest first by the (created_at, id) index. A plain read: only the rows deleted
+            // below are locked, and only until the commit. On the offline store, entries not yet
+            // sent to the server are kept.
+            const QString unsynced = SqlDialect::of(db).isSqlite() ? QStringLiteral(" AND pending_sync = 0") : QString();
+            QSqlQuery& selectIds = lease.prepare("SELECT id FROM mwl_entries WHERE created_at <= :beforeDate" + unsynced
+                + " ORDER BY created_at, id LIMIT :limit");
             selectIds.bindValue(":beforeDate", beforeDate);
+            selectIds.bindValue(":limit", qMax(1, maxEntries));
 
-            if (!selectIds.exec()) {
+            if (!QueryStatistics::exec(selectIds)) {
                 QString error = translator->getErrorMessage(DB_FETCH_IDS_BEFORE_DELETE_FAILED_ERROR).arg(selectIds.lastError().text());
                 logger->LogError(error);
                 qDebug() << error;
-                return Result<bool>::Failure(error);
+                return Result<int>::Failure(error);
             }
 
             while (selectIds.next()) {
                 entryIds << selectIds.value(0).toInt();
             }
+            selectIds.finish();
+
+            if (entryIds.isEmpty())
+                return Result<int>::Success(0);
+
+            if (!lease.transaction()) {
+                QString error = translator->getErrorMessage(MWL_FAILED_TO_START_TRANSACTION_MSG).arg(db.lastError().text());
+                logger->LogError(error);
+                qDebug() << error;
+                return Result<int>::Failure(error);
+            }
+
+            QStringList placeholders;
+            for (int i = 0; i < entryIds.size(); ++i) {
+                placeholders << "?";
+            }
+            const QString inClause = placeholders.join(",");
 
-            // Step 2: Delete associated attributes
             QSqlQuery attrDelete(db);
-            attrDelete.prepare(R"(
-                DELETE wa FROM mwl_attributes wa
-                JOIN mwl_entries e ON wa.mwl_entry_id = e.id
-                WHERE e.created_at <= :beforeDate
-            )");
-            attrDelete.bindValue(":beforeDate", beforeDate);
+            attrDelete.prepare(QString("DELETE FROM mwl_attributes WHERE mwl_entry_id IN (%1)").arg(inClause));
+            for (int i = 0; i < entryIds.size(); ++i) {
+                attrDelete.bindValue(i, entryIds[i]);
+            }
 
-            if (!attrDelete.exec()) {
+            if (!QueryStatistics::exec(attrDelete)) {
                 QString error = translator->getErrorMessage(MWL_FAILED_TO_DELETE_ATTRIBUTES_MSG).arg(attrDelete.lastError().text());
                 logger->LogError(error);
                 qDebug() << error;
-                return Result<bool>::Failure(error);
+                lease.rollback();
+                return Result<int>::Failure(error);
             }
 
-            // Step 3: Delete the entries themselves
             QSqlQuery entryDelete(db);
-            entryDelete.prepare("DELETE FROM mwl_entries WHERE created_at <= :beforeDate");
-            entryDelete.bindValue(":beforeDate", beforeDate);
+            entryDelete.prepare(QString("DELETE FROM mwl_entries WHERE id IN (%1)").arg(inClause));
+            for (int i = 0; i < entryIds.size(); ++i) {
+                entryDelete.bindValue(i, entryIds[i]);
+            }
 
-            if (!entryDelete.exec()) {
+            if (!QueryStatistics::exec(entryDelete)) {
                 QString error = translator->getErrorMessage(MWL_FAILED_TO_DELETE_ENTRIES_MSG).arg(entryDelete.lastError().text());
                 logger->LogError(error);
                 qDebug() << error;
-                return Result<bool>::Failure(error);
+                lease.rollback();
+                return Result<int>::Failure(error);
             }
 
-            if (!db.commit()) {
+            if (!lease.commit()) {
                 QString error = translator->getErrorMessage(DB_COMMIT_TRANSACTION_FAILED_ERROR).arg(db.lastError().text());
                 logger->LogError(error);
                 qDebug() << error;
-                return Result<bool>::Failure(error);
+                lease.rollback();
+                return Result<int>::Failure(error);
             }
         }
 
-        // Step 4: Emit deleted signal for each ID
-        for (const int& id  : entryIds)
+        for (const int& id : entryIds)
             emit worklistEntryDeleted(id);
 
-        QSqlDatabase::removeDatabase(connName);
-        return Result<bool>::Success(true);
+        return Result<int>::Success(entryIds.size());
+    }
+
+    Result<int> WorklistRepository::cancelUnseenRisEntries(int profileId, const QString& sourceConnection, const QSet<int>& seenIds) {
+        QList<int> unseenIds;
+        QList<int> cancelledIds;
+        const QDateTime now = QDateTime::currentDateTime();
+
+        {
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+
+            if (!db.isOpen()) {
+                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
+                logger->LogError(error);
+                qDebug() << error;
+                return Result<int>::Failure(error);
+            }
+
+            // Only entries the modality has not picked up yet and this connection returned before.
+            // Entries without recorded sources fall back to the connection they were first received
+            // from; an empty connection name stands for entries stored before connections were recorded.
+            QSqlQuery& selectIds = lease.prepare(R"(
+                SELECT e.id FROM mwl_entries e
+                WHERE e.source = 'RIS' AND e.profile_id = :profileId AND e.status = 'PENDING'
+                  AND (EXISTS (SELECT 1 FROM mwl_entry_sources s
+                               WHERE s.mwl_entry_id = e.id AND s.connection_name = :sourceConnection)
+                       OR (NOT EXISTS (SELECT 1 FROM mwl_entry_sources s WHERE s.mwl_entry_id = e.id)
+                           AND COALESCE(e.source_connection, '') = :firstConnection))
+            )");
+            selectIds.bindValue(":profileId", profileId);
+            selectIds.bindValue(":sourceConnection", sourceConnection);
+            selectIds.bindValue(":firstConnection", sourceConnection);
+
+            if (!QueryStatistics::exec(selectIds)) {
+                QString error = translator->getErrorMessage(MWL_QUERY_FAILED_MSG).arg(selectIds.lastError().text());
+                logger->LogError(error);
+                qDebug() << error;
+                return Result<int>::Failure(error);
+            }
+
+            while (selectIds.next()) {
+                const int id = selectIds.value(0).toInt();
+                if (!seenIds.contains(id))
+                    unseenIds << id;
+            }
+            selectIds.finish();
+
+            if (unseenIds.isEmpty())
+                return Result<int>::Success(0);
+
+            if (!lease.transaction()) {
+                QString error = translator->getErrorMessage(MWL_FAILED_TO_START_TRANSACTION_MSG).arg(db.lastError().text());
+                logger->LogError(error);
+                qDebug() << error;
+                return Result<int>::Failure(error);
+            }
+
+            auto fail = [&](const QSqlQuery& query) {
+                lease.rollback();
+                QString error = translator->getErrorMessage(MWL_FAILED_TO_UPDATE_ENTRIES_MSG).arg(query.lastError().text());
+                logger->LogError(error);
+                qDebug() << error;
+                return Result<int>::Failure(error);
+            };
+
+            for (int offset = 0; offset < unseenIds.size(); offset += INGEST_BATCH_SIZE) {
+                const int count = qMin(INGEST_BATCH_SIZE, int(unseenIds.size()) - offset);
+                const QString idList = placeholderList(count, "?");
+
+                // This connection no longer returns them
+                QSqlQuery forgetQuery(db);
+                forgetQuery.prepare(QString("DELETE FROM mwl_entry_sources WHERE connection_name = ? AND mwl_entry_id IN (%1)").arg(idList));
+                forgetQuery.addBindValue(sourceConnection);
+                for (int i = 0; i < count; ++i)
+                    forgetQuery.addBindValue(unseenIds[offset + i]);
+                if (!QueryStatistics::exec(forgetQuery))
+                    return fail(forgetQuery);
+
+                // Entries merged from another connection that still returns them stay pending
+                QSqlQuery returnedQuery(db);
+                returnedQuery.prepare(QString("SELECT DISTINCT mwl_entry_id FROM mwl_entry_sources WHERE mwl_entry_id IN (%1)").arg(idList));
+                for (int i = 0; i < count; ++i)
+                    returnedQuery.addBindValue(unseenIds[offset + i]);
+                if (!QueryStatistics::exec(returnedQuery))
+                    return fail(returnedQuery);
+
+                QSet<int> stillReturned;
+                while (returnedQuery.next())
+                    stillReturned.insert(returnedQuery.value(0).toInt());
+
+                QList<int> chunk;
+                for (int i = 0; i < count; ++i) {
+                    if (!stillReturned.contains(unseenIds[offset + i]))
+                        chunk << unseenIds[offset + i];
+                }
+                if (chunk.isEmpty())
+                    continue;
+
+                // Re-checked, in case the modality started one of them meanwhile
+                QSqlQuery cancelQuery(db);
+                cancelQuery.prepare(QString("UPDATE mwl_entries SET status = 'CANCELLED', updated_at = ? WHERE status = 'PENDING' AND id IN (%1)")
+                    .arg(placeholderList(chunk.size(), "?")));
+                cancelQuery.addBindValue(now);
+                for (int id : chunk)
+                    cancelQuery.addBindValue(id);
+
+                if (!QueryStatistics::exec(cancelQuery))
+                    return fail(cancelQuery);
+                cancelledIds.append(chunk);
+            }
+
+            if (!lease.commit()) {
+                QString error = translator->getErrorMessage(DB_COMMIT_TRANSACTION_FAILED_ERROR).arg(db.lastError().text());
+                logger->LogError(error);
+                qDebug() << error;
+                lease.rollback();
+                return Result<int>::Failure(error);
+            }
+        }
+
+        for (const int id : cancelledIds) {
+            WorklistEntry entry;
+            entry.Id = id;
+            entry.Source = Source::RIS;
+            entry.SourceConnection = sourceConnection;
+            entry.Status = ProcedureStepStatus::CANCELLED;
+            entry.UpdatedAt = now;
+            emit worklistEntryUpdated(entry);
+        }
+
+        return Result<int>::Success(cancelledIds.size());
     }
 
 
@@ -553,19 +837,18 @@ namespace Etrek::Worklist::Repository {
             return Result<bool>::Success(true); // Nothing to delete
         }
 
-        QString connName = "conn_delete_entries_" + QString::number(QRandomGenerator::global()->generate());
-
         {
-            QSqlDatabase db = createConnection(connName);
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
 
-            if (!db.open()) {
-                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            if (!db.isOpen()) {
+                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(error);
                 qDebug()<<error;
                 return Result<bool>::Failure(error);
             }
 
-            if (!db.transaction()) {
+            if (!lease.transaction()) {
                 QString error = translator->getErrorMessage(MWL_FAILED_TO_START_TRANSACTION_MSG).arg(db.lastError().text());
                 logger->LogError(error);
                 qDebug()<<error;
@@ -588,7 +871,7 @@ namespace Etrek::Worklist::Repository {
                 attrDelete.bindValue(i, entryIds[i]);
             }
 
-            if (!attrDelete.exec()) {
+            if (!QueryStatistics::exec(attrDelete)) {
                 QString error = translator->getErrorMessage(MWL_FAILED_TO_DELETE_ATTRIBUTES_MSG).arg(attrDelete.lastError().text());
                 logger->LogError(error);
                 qDebug()<<error;
@@ -604,14 +887,14 @@ namespace Etrek::Worklist::Repository {
                 entryDelete.bindValue(i, entryIds[i]);
             }
 
-            if (!entryDelete.exec()) {
+            if (!QueryStatistics::exec(entryDelete)) {
                 QString error = translator->getErrorMessage(MWL_FAILED_TO_DELETE_ENTRIES_MSG).arg(entryDelete.lastError().text());
                 logger->LogError(error);
                 qDebug()<<error;
                 return Result<bool>::Failure(error);
             }
 
-            if (!db.commit()) {
+            if (!lease.commit()) {
                 QString error = translator->getErrorMessage(MWL_FAILED_TO_COMMIT_TRANSACTION_MSG).arg(db.lastError().text());
                 logger->LogError(error);
                 qDebug()<<error;
@@ -622,27 +905,24 @@ namespace Etrek::Worklist::Repository {
                 emit worklistEntryDeleted(id);
         }
 
-        QSqlDatabase::removeDatabase(connName);
         return Result<bool>::Success(true);
     }
 
     Result<int> WorklistRepository::addDicomTag(const  DicomTag& tag) {
         int newId = -1;
-        QString connName = "conn_add_dicom_tag_" + QString::number(QRandomGenerator::global()->generate());
 
         {
-            QSqlDatabase db = createConnection(connName);
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
 
-            if (!db.open()) {
-                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            if (!db.isOpen()) {
+                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(error);
                 qDebug()<<error;
                 return Result<int>::Failure(error);
             }
 
-            QSqlQuery query(db);
-
-            query.prepare(R"(
+            QSqlQuery& query = lease.prepare(R"(
                 INSERT INTO dicom_tags
                     (name, display_name, group_hex, element_hex, pgroup_hex, pelement_hex, is_active, is_retired)
                 VALUES
@@ -658,7 +938,7 @@ namespace Etrek::Worklist::Repository {
             query.bindValue(":isActive", tag.IsActive);
             query.bindValue(":isRetired", tag.IsRetired);
 
-            if (!query.exec()) {
+            if (!QueryStatistics::exec(query)) {
                 QString error = translator->getErrorMessage(MWL_FAILED_TO_INSERT_TAG_MSG).arg(query.lastError().text());
                 logger->LogError(error);
                 qDebug()<<error;
@@ -667,25 +947,24 @@ namespace Etrek::Worklist::Repository {
 
             newId = query.lastInsertId().toInt();
         }
-        QSqlDatabase::removeDatabase(connName);
+
+        m_metadataCache->invalidateTag(newId);
         return Result<int>::Success(newId);
     }
 
     Result<bool> WorklistRepository::updateDicomTagActiveStatus(int tagId, bool isActive) {
-        QString connName = "conn_update_active_" + QString::number(QRandomGenerator::global()->generate());
-
         {
-            QSqlDatabase db = createConnection(connName);
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
 
-            if (!db.open()) {
-                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            if (!db.isOpen()) {
+                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(error);
                 qDebug()<<error;
                 return Result<bool>::Failure(error);
             }
 
-            QSqlQuery query(db);
-            query.prepare(R"(
+            QSqlQuery& query = lease.prepare(R"(
                 UPDATE dicom_tags
                 SET is_active = :isActive
                 WHERE id = :tagId
@@ -694,34 +973,54 @@ namespace Etrek::Worklist::Repository {
             query.bindValue(":isActive", isActive);
             query.bindValue(":tagId", tagId);
 
-            if (!query.exec()) {
+            if (!QueryStatistics::exec(query)) {
                 QString error = translator->getErrorMessage(MWL_FAILED_TO_UPDATE_TAG_MSG).arg(query.lastError().text());
                 logger->LogError(error);
                 qDebug()<<error;
                 return Result<bool>::Failure(error);
             }
+
+            // Values of this tag appear in or disappear from the worklist grid
+            QString projectionError;
+            if (!WorklistDisplayProjection::refreshEntriesWithTag(db, tagId, &projectionError)) {
+                QString error = translator->getErrorMessage(MWL_FAILED_TO_UPDATE_ENTRIES_MSG).arg(projectionError);
+                logger->LogError(error);
+                qDebug()<<error;
+                return Result<bool>::Failure(error);
+            }
+        }
+
+        m_metadataCache->invalidateTag(tagId);
+
+        // The set of identifier tags changed for every profile using this tag as an identifier
+        auto profilesResult = profilesWithIdentifierTag(tagId);
+        if (!profilesResult.isSuccess) {
+            return Result<bool>::Failure(profilesResult.message);
+        }
+        for (int profileId : profilesResult.value) {
+            auto refreshResult = refreshIdentityFingerprints(profileId);
+            if (!refreshResult.isSuccess) {
+                return Result<bool>::Failure(refreshResult.message);
+            }
         }
 
-        QSqlDatabase::removeDatabase(connName);
         return Result<bool>::Success(true);
     }
 
     Result<bool> WorklistRepository::updateDicomTagRetiredStatus(int tagId, bool isRetired) {
 
-        QString connName = "conn_update_retired_" + QString::number(QRandomGenerator::global()->generate());
-
         {
-            QSqlDatabase db = createConnection(connName);
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
 
-            if (!db.open()) {
-                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            if (!db.isOpen()) {
+                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(error);
                 qDebug()<<error;
                 return Result<bool>::Failure(error);
             }
 
-            QSqlQuery query(db);
-            query.prepare(R"(
+            QSqlQuery& query = lease.prepare(R"(
                 UPDATE dicom_tags
                 SET is_retired = :isRetired
                 WHERE id = :tagId
@@ -730,7 +1029,7 @@ namespace Etrek::Worklist::Repository {
             query.bindValue(":isRetired", isRetired);
             query.bindValue(":tagId", tagId);
 
-            if (!query.exec()) {
+            if (!QueryStatistics::exec(query)) {
                 QString error = translator->getErrorMessage(MWL_FAILED_TO_UPDATE_TAG_MSG).arg(query.lastError().text());
                 logger->LogError(error);
                 qDebug()<<error;
@@ -738,29 +1037,27 @@ namespace Etrek::Worklist::Repository {
             }
         }
 
-        QSqlDatabase::removeDatabase(connName);
+        m_metadataCache->invalidateTag(tagId);
         return Result<bool>::Success(true);
     }
 
     Result<QString> WorklistRepository::updateWorklistStatus(int entryId, ProcedureStepStatus newStatus) {
-        QString connName = "conn_update_status_" + QString::number(QRandomGenerator::global()->generate());
-
         {
-            QSqlDatabase db = createConnection(connName);
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
 
-            if (!db.open()) {
-                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            if (!db.isOpen()) {
+                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(error);
                 qDebug()<<error;
                 return Result<QString>::Failure(error);
             }
 
-            QSqlQuery query(db);
-            query.prepare("UPDATE mwl_entries SET status = :status WHERE id = :id");
+            QSqlQuery& query = lease.prepare("UPDATE mwl_entries SET status = :status WHERE id = :id");
             query.bindValue(":status", ProcedureStepStatusToString(newStatus));
             query.bindValue(":id", entryId);
 
-            if (!query.exec()) {
+            if (!QueryStatistics::exec(query)) {
                 QString error = translator->getErrorMessage(MWL_FAILED_TO_UPDATE_ENTRIES_MSG).arg(query.lastError().text());
                 logger->LogError(error);
                 qDebug()<<error;
@@ -768,7 +1065,6 @@ namespace Etrek::Worklist::Repository {
             }
         }
 
-        QSqlDatabase::removeDatabase(connName);
         QString success = translator->getInfoMessage(MWL_ENTRY_UPDATE_SUCCEED_MSG);
         return Result<QString>::Success(success);
     }
@@ -776,98 +1072,118 @@ namespace Etrek::Worklist::Repository {
     Result<int> WorklistRepository::createWorklistEntry(const  WorklistEntry& entry) {
         int newId = -1;
          WorklistEntry result;
-        QString connName = "conn_create_worklist_" + QString::number(QRandomGenerator::global()->generate());
+
+        auto fingerprintResult = identityFingerprintFor(entry);
+        if (!fingerprintResult.isSuccess) {
+            return Result<int>::Failure(fingerprintResult.message);
+        }
 
         {
-            QSqlDatabase db = createConnection(connName);
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
 
-            if (!db.open()) {
-                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            if (!db.isOpen()) {
+                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(error);
                 qDebug()<<error;
                 return Result<int>::Failure(error);
             }
 
-            if (!db.transaction()) {
-                QString error = translator->getErrorMessage(MWL_FAILED_TO_START_TRANSACTION_MSG).arg(db.lastError().text());
-                logger->LogError(error);
+            // The identity is already stored: resolve to that entry instead of hitting the unique key
+            if (!fingerprintResult.value.isEmpty()) {
+                auto existingResult = findEntryByFingerprint(lease, entry.Profile.Id, fingerprintResult.value);
+                if (!existingResult.isSuccess) {
+                    return Result<int>::Failure(existingResult.message);
+                }
+                if (existingResult.value >= 0) {
+                    return Result<int>::Success(existingResult.value);
+                }
+            }
+
+            if (!lease.transaction()) {
+                QString error = translator->getErrorMessage(MWL_FAILED_TO_START_TRANSACTION_MSG).arg(db.lastError().text());
+                logger->LogError(error);
                 qDebug()<<error;
                 return Result<int>::Failure(error);
             }
 
             // Insert worklist entry
-            QSqlQuery query(db);
-            query.prepare(R"(
-                INSERT INTO mwl_entries (source, profile_id, status, created_at, updated_at)
-                VALUES (:source, :profileId, :status, :createdAt, :updatedAt)
+            QSqlQuery& query = lease.prepare(R"(
+                INSERT INTO mwl_entries (source, profile_id, status, identity_fingerprint, created_at, updated_at)
+                VALUES (:source, :profileId, :status, :fingerprint, :createdAt, :updatedAt)
             )");
             query.bindValue(":source", SourceToString(entry.Source));
             query.bindValue(":profileId", entry.Profile.Id);
             query.bindValue(":status", ProcedureStepStatusToString(entry.Status));
+            query.bindValue(":fingerprint", fingerprintValue(fingerprintResult.value));
             query.bindValue(":createdAt", entry.CreatedAt);
             query.bindValue(":updatedAt", entry.UpdatedAt);
 
-            if (!query.exec()) {
-                db.rollback();
-                QString error = translator->getErrorMessage(DB_INSERT_FAILED_ERROR).arg(query.lastError().text());
+            if (!QueryStatistics::exec(query)) {
+                const QString insertError = query.lastError().text();
+                lease.rollback();
+
+                // Another writer stored the same identity since the lookup above
+                if (!fingerprintResult.value.isEmpty()) {
+                    auto existingResult = findEntryByFingerprint(lease, entry.Profile.Id, fingerprintResult.value);
+                    if (existingResult.isSuccess && existingResult.value >= 0) {
+                        return Result<int>::Success(existingResult.value);
+                    }
+                }
+
+                QString error = translator->getErrorMessage(DB_INSERT_FAILED_ERROR).arg(insertError);
                 logger->LogError(error);
                 qDebug()<<error;
                 return Result<int>::Failure(error);
             }
 
             newId = query.lastInsertId().toInt();
+            result = entry;
+            result.Id = newId;
 
-            // Insert associated tags (only active ones)
-            QSqlQuery attrQuery(db);
-            attrQuery.prepare(R"(
-                INSERT INTO mwl_attributes (mwl_entry_id, dicom_tag_id, tag_value)
-                VALUES (:entryId, :tagId, :tagValue)
-            )");
-
-            for (const  WorklistAttribute& attr : entry.Attributes) {
-                if (attr.Tag.IsActive) {
-                    attrQuery.bindValue(":entryId", newId);
-                    attrQuery.bindValue(":tagId", attr.Tag.Id);
-                    attrQuery.bindValue(":tagValue", attr.TagValue);
+            // Insert associated tags (only active ones) in one multi-row statement
+            auto attributeResult = insertAttributes(lease, { result });
+            if (!attributeResult.isSuccess) {
+                lease.rollback();
+                return Result<int>::Failure(attributeResult.message);
+            }
 
-                    if (!attrQuery.exec()) {
-                        db.rollback();
-                        QString error = translator->getErrorMessage(DB_INSERT_ATTRIBUTE_FAILED_ERROR).arg(attrQuery.lastError().text());
-                        logger->LogError(error);
-                        qDebug()<<error;
-                        return Result<int>::Failure(error);
-                    }
-                }
+            auto projectionResult = refreshDisplayColumns(lease, { newId });
+            if (!projectionResult.isSuccess) {
+                lease.rollback();
+                return Result<int>::Failure(projectionResult.message);
             }
 
-            if (!db.commit()) {
-                db.rollback();            
+            if (!lease.commit()) {
+                lease.rollback();            
                 QString error = translator->getErrorMessage(MWL_FAILED_TO_COMMIT_TRANSACTION_MSG).arg(db.lastError().text());
                 logger->LogError(error);
                 qDebug()<<error;
                 return Result<int>::Failure(error);
             }
-            result = entry;
-            result.Id = newId;
         }
         emit worklistEntryCreated(static_cast<const  WorklistEntry&>(result));  // after commit
-        QSqlDatabase::removeDatabase(connName);
         return Result<int>::Success(newId);
     }
 
     Result<int> WorklistRepository::updateWorklistEntry(const  WorklistEntry& entry) {
-        QString connName = "conn_update_worklist_" + QString::number(QRandomGenerator::global()->generate());
+        auto fingerprintResult = identityFingerprintFor(entry);
+        if (!fingerprintResult.isSuccess) {
+            return Result<int>::Failure(fingerprintResult.message);
+        }
+
         {
-            QSqlDatabase db = createConnection(connName);
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
 
-            if (!db.open()) {
-                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            if (!db.isOpen()) {
+                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(error);
                 qDebug()<<error;
                 return Result<int>::Failure(error);
             }
 
-            if (!db.transaction()) {
+            if (!lease.transaction()) {
                 QString error = translator->getErrorMessage(MWL_FAILED_TO_START_TRANSACTION_MSG).arg(db.lastError().text());
                 logger->LogError(error);
                 qDebug()<<error;
@@ -875,75 +1191,251 @@ namespace Etrek::Worklist::Repository {
             }
 
             // Update worklist entry
-            QSqlQuery query(db);
-            query.prepare(R"(
+            QSqlQuery& query = lease.prepare(R"(
                 UPDATE mwl_entries
-                SET source = :source, profile_id = :profileId, status = :status, updated_at = :updatedAt
+                SET source = :source, profile_id = :profileId, status = :status, identity_fingerprint = :fingerprint, updated_at = :updatedAt
                 WHERE id = :id
             )");
             query.bindValue(":source", SourceToString(entry.Source));
             query.bindValue(":profileId", entry.Profile.Id);
             query.bindValue(":status", ProcedureStepStatusToString(entry.Status));
+            query.bindValue(":fingerprint", fingerprintValue(fingerprintResult.value));
             query.bindValue(":updatedAt", entry.UpdatedAt);
             query.bindValue(":id", entry.Id);
 
-            if (!query.exec()) {
-                db.rollback();
+            if (!QueryStatistics::exec(query)) {
+                lease.rollback();
                 QString error = translator->getErrorMessage(MWL_FAILED_TO_UPDATE_ENTRIES_MSG).arg(query.lastError().text());
                 logger->LogError(error);
                 qDebug()<<error;
                 return Result<int>::Failure(error);
             }
 
-            // Delete existing attributes
-            QSqlQuery deleteQuery(db);
-            deleteQuery.prepare("DELETE FROM mwl_attributes WHERE mwl_entry_id = :entryId");
-            deleteQuery.bindValue(":entryId", entry.Id);
+            // Only touch the attribute rows whose value changed, appeared or disappeared
+            auto attributeResult = upsertAttributes(lease, { entry });
+            if (!attributeResult.isSuccess) {
+                lease.rollback();
+                return Result<int>::Failure(attributeResult.message);
+            }
 
-            if (!deleteQuery.exec()) {
-                db.rollback();
-                QString error = translator->getErrorMessage(MWL_FAILED_TO_DELETE_ATTRIBUTES_MSG).arg(deleteQuery.lastError().text());
+            auto projectionResult = refreshDisplayColumns(lease, { entry.Id });
+            if (!projectionResult.isSuccess) {
+                lease.rollback();
+                return Result<int>::Failure(projectionResult.message);
+            }
+
+            if (!lease.commit()) {
+                lease.rollback();
+                QString error = translator->getErrorMessage(MWL_FAILED_TO_COMMIT_TRANSACTION_MSG).arg(db.lastError().text());
                 logger->LogError(error);
                 qDebug()<<error;
                 return Result<int>::Failure(error);
             }
 
-            // Re-insert only active tags
-            QSqlQuery attrQuery(db);
-            attrQuery.prepare(R"(
-                INSERT INTO mwl_attributes (mwl_entry_id, dicom_tag_id, tag_value)
-                VALUES (:entryId, :tagId, :tagValue)
-            )");
+        }
 
-            for (const  WorklistAttribute& attr : entry.Attributes) {
-                if (attr.Tag.IsActive) {
-                    attrQuery.bindValue(":entryId", entry.Id);
-                    attrQuery.bindValue(":tagId", attr.Tag.Id);
-                    attrQuery.bindValue(":tagValue", attr.TagValue);
+        return Result<int>::Success(entry.Id);
+    }
 
-                    if (!attrQuery.exec()) {
-                        db.rollback();
-                        QString error = translator->getErrorMessage(DB_INSERT_ATTRIBUTE_FAILED_ERROR).arg(attrQuery.lastError().text());
-                        logger->LogError(error);
-                        qDebug()<<error;
-                        return Result<int>::Failure(error);
-                    }
+    Result<WorklistIngestSummary> WorklistRepository::ingestWorklistEntries(const QList<WorklistEntry>& entries, const WorklistProfile& profile) {
+        WorklistIngestSummary summary;
+        summary.Received = entries.size();
+        if (entries.isEmpty()) {
+            return Result<WorklistIngestSummary>::Success(summary);
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+
+        auto activeTagsResult = getActiveIdentifierTags(profile.Id);
+        if (!activeTagsResult.isSuccess) {
+            QString error = translator->getErrorMessage(MWL_FAILED_TO_GET_ACTIVE_IDENTIFIERS_MSG).arg(activeTagsResult.message);
+            logger->LogError(error);
+            qDebug()<<error;
+            return Result<WorklistIngestSummary>::Failure(error);
+        }
+
+        QSet<int> identifierTagIds;
+        for (const DicomTag& tag : activeTagsResult.value)
+            identifierTagIds.insert(tag.Id);
+
+        // Collapse the batch on the identity fingerprint. Entries without identifiers are always new.
+        QList<WorklistEntry> candidates;
+        QList<QString> candidateFingerprints;
+        QHash<QString, int> fingerprintToCandidate;
+
+        for (const WorklistEntry& entry : entries) {
+            const QString fingerprint = identityFingerprint(entry, identifierTagIds);
+            if (!fingerprint.isEmpty()) {
+                auto found = fingerprintToCandidate.constFind(fingerprint);
+                if (found != fingerprintToCandidate.constEnd()) {
+                    candidates[found.value()] = entry;
+                    continue;
                 }
+                fingerprintToCandidate.insert(fingerprint, candidates.size());
             }
+            candidates.append(entry);
+            candidateFingerprints.append(fingerprint);
+        }
 
-            if (!db.commit()) {
-                db.rollback();
-                QString error = translator->getErrorMessage(MWL_FAILED_TO_COMMIT_TRANSACTION_MSG).arg(db.lastError().text());
+        QList<WorklistEntry> created;
+        QList<QString> createdFingerprints;
+        QList<WorklistEntry> updated;
+        QList<WorklistEntry> seen;  // Existing entries as this batch returned them, for their sources
+
+        {
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+
+            if (!db.isOpen()) {
+                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(error);
                 qDebug()<<error;
-                return Result<int>::Failure(error);
+                return Result<WorklistIngestSummary>::Failure(error);
+            }
+
+            auto existingResult = resolveExistingEntries(lease, profile.Id, fingerprintToCandidate.keys());
+            if (!existingResult.isSuccess) {
+                return Result<WorklistIngestSummary>::Failure(existingResult.message);
+            }
+
+            QList<int> existingIds;
+            for (const WorklistEntry& stored : existingResult.value)
+                existingIds.append(stored.Id);
+
+            auto storedResult = loadTagValuesForEntries(lease, existingIds);
+            if (!storedResult.isSuccess) {
+                return Result<WorklistIngestSummary>::Failure(storedResult.message);
+            }
+
+            const QDateTime now = QDateTime::currentDateTime();
+            for (int i = 0; i < candidates.size(); ++i) {
+                auto stored = existingResult.value.constFind(candidateFingerprints[i]);
+                if (candidateFingerprints[i].isEmpty() || stored == existingResult.value.constEnd()) {
+                    created.append(candidates[i]);
+                    createdFingerprints.append(candidateFingerprints[i]);
+                    continue;
+                }
+
+                const int existingId = stored.value().Id;
+                if (activeTagValues(candidates[i]) == storedResult.value.value(existingId)) {
+                    ++summary.Unchanged;
+                    summary.UnchangedIds.append(existingId);
+                    WorklistEntry entry = candidates[i];
+                    entry.Id = existingId;
+                    seen.append(entry);
+                    continue;
+                }
+
+                // The row keeps its stored status, source and connection; listeners get those
+                WorklistEntry entry = candidates[i];
+                entry.Id = existingId;
+                seen.append(entry);
+                entry.Source = stored.value().Source;
+                entry.SourceConnection = stored.value().SourceConnection;
+                entry.Status = stored.value().Status;
+                entry.CreatedAt = stored.value().CreatedAt;
+                entry.UpdatedAt = now;
+                updated.append(entry);
+            }
+
+            const bool hasSources = std::any_of(candidates.cbegin(), candidates.cend(),
+                [](const WorklistEntry& entry) { return !entry.SourceConnection.isEmpty(); });
+
+            if (!created.isEmpty() || !updated.isEmpty() || hasSources) {
+                if (!lease.transaction()) {
+                    QString error = translator->getErrorMessage(MWL_FAILED_TO_START_TRANSACTION_MSG).arg(db.lastError().text());
+                    logger->LogError(error);
+                    qDebug()<<error;
+                    return Result<WorklistIngestSummary>::Failure(error);
+                }
+
+                auto insertResult = insertEntryRows(lease, created, createdFingerprints);
+                if (!insertResult.isSuccess) {
+                    lease.rollback();
+                    return Result<WorklistIngestSummary>::Failure(insertResult.message);
+                }
+
+                for (int i = 0; i < created.size(); ++i)
+                    created[i].Id = insertResult.value[i];
+
+                auto attributeResult = insertAttributes(lease, created);
+                if (!attributeResult.isSuccess) {
+                    lease.rollback();
+                    return Result<WorklistIngestSummary>::Failure(attributeResult.message);
+                }
+
+                // Status and source of existing entries stay as they are.
+                for (int offset = 0; offset < updated.size(); offset += INGEST_BATCH_SIZE) {
+                    const int count = qMin(INGEST_BATCH_SIZE, int(updated.size()) - offset);
+
+                    QSqlQuery touchQuery(db);
+                    touchQuery.prepare(QString("UPDATE mwl_entries SET updated_at = ? WHERE id IN (%1)").arg(placeholderList(count, "?")));
+                    touchQuery.addBindValue(now);
+                    for (int i = 0; i < count; ++i)
+                        touchQuery.addBindValue(updated[offset + i].Id);
+
+                    if (!QueryStatistics::exec(touchQuery)) {
+                        lease.rollback();
+                        QString error = translator->getErrorMessage(MWL_FAILED_TO_UPDATE_ENTRIES_MSG).arg(touchQuery.lastError().text());
+                        logger->LogError(error);
+                        qDebug()<<error;
+                        return Result<WorklistIngestSummary>::Failure(error);
+                    }
+                }
+
+                auto upsertResult = upsertAttributes(lease, updated);
+                if (!upsertResult.isSuccess) {
+                    lease.rollback();
+                    return Result<WorklistIngestSummary>::Failure(upsertResult.message);
+                }
+
+                QList<int> touchedIds;
+                for (const WorklistEntry& entry : created)
+                    touchedIds.append(entry.Id);
+                for (const WorklistEntry& entry : updated)
+                    touchedIds.append(entry.Id);
+
+                auto projectionResult = refreshDisplayColumns(lease, touchedIds);
+                if (!projectionResult.isSuccess) {
+                    lease.rollback();
+                    return Result<WorklistIngestSummary>::Failure(projectionResult.message);
+                }
+
+                auto sourcesResult = recordEntrySources(lease, created + seen, now);
+                if (!sourcesResult.isSuccess) {
+                    lease.rollback();
+                    return Result<WorklistIngestSummary>::Failure(sourcesResult.message);
+                }
+
+                if (!lease.commit()) {
+                    lease.rollback();
+                    QString error = translator->getErrorMessage(MWL_FAILED_TO_COMMIT_TRANSACTION_MSG).arg(db.lastError().text());
+                    logger->LogError(error);
+                    qDebug()<<error;
+                    return Result<WorklistIngestSummary>::Failure(error);
+                }
             }
+        }
 
+        // after commit
+        for (const WorklistEntry& entry : created) {
+            summary.CreatedIds.append(entry.Id);
+            emit worklistEntryCreated(entry);
+        }
+        for (const WorklistEntry& entry : updated) {
+            summary.UpdatedIds.append(entry.Id);
+            emit worklistEntryUpdated(entry);
         }
 
-        QSqlDatabase::removeDatabase(connName);
+        summary.Created = created.size();
+        summary.Updated = updated.size();
+        summary.ElapsedMs = timer.elapsed();
 
-        return Result<int>::Success(entry.Id);
+        logger->LogInfo(translator->getInfoMessage(MWL_INGEST_COMPLETED_MSG)
+            .arg(summary.Received).arg(summary.Created).arg(summary.Updated).arg(summary.Unchanged).arg(summary.ElapsedMs));
+
+        return Result<WorklistIngestSummary>::Success(summary);
     }
 
     Result< WorklistEntry> WorklistRepository::getWorklistEntry(const  WorklistEntry& entry) const {
@@ -1045,80 +1537,55 @@ namespace Etrek::Worklist::Repository {
     }
 
     Result<QList<DicomTag>> WorklistRepository::getActiveIdentifierTags(int profileId) const {
-        QList<DicomTag> tags;
-        QString connName = "conn_get_active_ids_" + QString::number(QRandomGenerator::global()->generate());
+        auto metadataResult = profileMetadata(profileId);
+        if (!metadataResult.isSuccess) {
+            return Result<QList<DicomTag>>::Failure(metadataResult.message);
+        }
+        return Result<QList<DicomTag>>::Success(metadataResult.value->ActiveIdentifiers);
+    }
+
+    Result<QList<DicomTag>> WorklistRepository::getMandatoryIdentifierTags(int profileId) const {
+        auto metadataResult = profileMetadata(profileId);
+        if (!metadataResult.isSuccess) {
+            return Result<QList<DicomTag>>::Failure(metadataResult.message);
+        }
+        return Result<QList<DicomTag>>::Success(metadataResult.value->MandatoryIdentifiers);
+    }
+
+    Result<std::shared_ptr<const ProfileTagMetadata>> WorklistRepository::profileMetadata(int profileId) const {
+        const auto snapshot = m_metadataCache->snapshot();
+        if (auto cached = snapshot->Profiles.value(profileId)) {
+            return Result<std::shared_ptr<const ProfileTagMetadata>>::Success(cached);
+        }
 
+        auto metadata = std::make_shared<ProfileTagMetadata>();
         {
-            QSqlDatabase db = createConnection(connName);
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
 
-            if (!db.open()) {
-                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            if (!db.isOpen()) {
+                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(error);
                 qDebug()<<error;
-                return Result<QList<DicomTag>>::Failure(error);
+                return Result<std::shared_ptr<const ProfileTagMetadata>>::Failure(error);
             }
 
-            QSqlQuery query(db);
-            query.prepare(R"(
-                SELECT t.id, t.name, t.display_name, t.group_hex, t.element_hex, t.pgroup_hex, t.pelement_hex, t.is_active, t.is_retired
+            // One read per profile serves all four tag lists
+            QSqlQuery& query = lease.prepare(R"(
+                SELECT t.id, t.name, t.display_name, t.group_hex, t.element_hex, t.pgroup_hex, t.pelement_hex, t.is_active, t.is_retired,
+                       pta.is_identifier, pta.is_mandatory, pta.matching_value
                 FROM dicom_tags t
                 JOIN profile_tag_association pta ON t.id = pta.tag_id
-                WHERE pta.profile_id = :profileId AND t.is_active = TRUE AND pta.is_identifier = TRUE
-            )");
-            query.bindValue(":profileId", profileId);
-
-            if (!query.exec()) {
-                QString error = translator->getErrorMessage(MWL_QUERY_FAILED_MSG).arg(query.lastError().text());
-                logger->LogError(error);
-                qDebug()<<error;
-                return Result<QList<DicomTag>>::Failure(error);
-            }
-
-            while (query.next()) {
-            DicomTag tag;
-            tag.Id = query.value("id").toInt();
-            tag.Name = query.value("name").toString();
-            tag.DisplayName = query.value("display_name").toString();
-            tag.GroupHex = query.value("group_hex").toUInt();
-            tag.ElementHex = query.value("element_hex").toUInt();
-            tag.PgroupHex = query.value("pgroup_hex").toUInt();
-            tag.PelementHex = query.value("pelement_hex").toUInt();
-            tag.IsActive = query.value("is_active").toBool();
-            tag.IsRetired = query.value("is_retired").toBool();
-            tags.append(tag);
-            }
-        }
-
-        QSqlDatabase::removeDatabase(connName);
-        return Result<QList<DicomTag>>::Success(tags);
-    }
-
-    Result<QList<DicomTag>> WorklistRepository::getMandatoryIdentifierTags(int profileId) const {
-        QList<DicomTag> tags;
-        QString connName = "conn_get_mandatory_ids_" + QString::number(QRandomGenerator::global()->generate());
-        {
-            QSqlDatabase db = createConnection(connName);
-            if (!db.open()) {
-                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
-                logger->LogError(error);
-                qDebug()<<error;
-                return Result<QList<DicomTag>>::Failure(error);
-            }
-
-            QSqlQuery query(db);
-            query.prepare(R"(
-            SELECT t.id, t.name, t.display_name, t.group_hex, t.element_hex, t.pgroup_hex, t.pelement_hex, t.is_active, t.is_retired
-            FROM dicom_tags t
-            JOIN profile_tag_association pta ON t.id = pta.tag_id
-            WHERE pta.profile_id = :profileId AND pta.is_mandatory = TRUE
+                WHERE pta.profile_id = :profileId
+                ORDER BY t.id
             )");
             query.bindValue(":profileId", profileId);
 
-            if (!query.exec()) {
+            if (!QueryStatistics::exec(query)) {
                 QString error = translator->getErrorMessage(MWL_QUERY_FAILED_MSG).arg(query.lastError().text());
                 logger->LogError(error);
                 qDebug()<<error;
-                return Result<QList<DicomTag>>::Failure(error);
+                return Result<std::shared_ptr<const ProfileTagMetadata>>::Failure(error);
             }
 
             while (query.next()) {
@@ -1132,27 +1599,37 @@ namespace Etrek::Worklist::Repository {
                 tag.PelementHex = query.value("pelement_hex").toUInt();
                 tag.IsActive = query.value("is_active").toBool();
                 tag.IsRetired = query.value("is_retired").toBool();
-                tags.append(tag);
+
+                const bool isIdentifier = query.value("is_identifier").toBool();
+                metadata->Tags.append(tag);
+                if (isIdentifier)
+                    metadata->Identifiers.append(tag);
+                if (isIdentifier && tag.IsActive)
+                    metadata->ActiveIdentifiers.append(tag);
+                if (query.value("is_mandatory").toBool())
+                    metadata->MandatoryIdentifiers.append(tag);
+                if (!query.value("matching_value").isNull())
+                    metadata->MatchingValues.insert(tag.Id, query.value("matching_value").toString());
             }
         }
-        QSqlDatabase::removeDatabase(connName);
-        return Result<QList<DicomTag>>::Success(tags);
+
+        // Not stored if an update invalidated the cache while we were reading
+        m_metadataCache->publish(profileId, metadata, snapshot->Version);
+        return Result<std::shared_ptr<const ProfileTagMetadata>>::Success(metadata);
     }
 
     Result<bool> WorklistRepository::updateIdentifierFlags(int profileId, int tagId, bool isIdentifier, bool isMandatoryIdentifier) {
-        QString connName = "conn_update_flags_" + QString::number(QRandomGenerator::global()->generate());
-
         {
-                QSqlDatabase db = createConnection(connName);
-                if (!db.open()) {
-                    QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+                auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+                QSqlDatabase& db = lease.database();
+                if (!db.isOpen()) {
+                    QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                     logger->LogError(error);
                     qDebug()<<error;
                     return Result<bool>::Failure(error);
                 }
 
-                QSqlQuery query(db);
-                query.prepare(R"(
+                QSqlQuery& query = lease.prepare(R"(
                     UPDATE profile_tag_association
                     SET is_identifier = :isIdentifier,
                         is_mandatory = :isMandatoryIdentifier
@@ -1163,7 +1640,7 @@ namespace Etrek::Worklist::Repository {
                 query.bindValue(":profileId", profileId);
                 query.bindValue(":tagId", tagId);
 
-                if (!query.exec()) {
+                if (!QueryStatistics::exec(query)) {
                     QString error = translator->getErrorMessage(MWL_QUERY_FAILED_MSG).arg(query.lastError().text());
                     logger->LogError(error);
                     qDebug()<<error;
@@ -1171,92 +1648,212 @@ namespace Etrek::Worklist::Repository {
                 }
         }
 
-        QSqlDatabase::removeDatabase(connName);
+        m_metadataCache->invalidateProfile(profileId);
+
+        auto refreshResult = refreshIdentityFingerprints(profileId);
+        if (!refreshResult.isSuccess) {
+            return Result<bool>::Failure(refreshResult.message);
+        }
+
         return Result<bool>::Success(true);
     }
 
-    Result<int> WorklistRepository::findWorklistEntryByIdentifiers(int profileId, const QMap<int, QString>& tagIdToValue) const {
-        if (tagIdToValue.isEmpty()) {
-            QString error = translator->getErrorMessage(DB_NO_IDENTIFIERS_PROVIDED_ERROR);
+    Result<bool> WorklistRepository::refreshIdentityFingerprints(int profileId) {
+        {
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
+                logger->LogError(error);
+                qDebug()<<error;
+                return Result<bool>::Failure(error);
+            }
+
+            if (!lease.transaction()) {
+                QString error = translator->getErrorMessage(MWL_FAILED_TO_START_TRANSACTION_MSG).arg(db.lastError().text());
+                logger->LogError(error);
+                qDebug()<<error;
+                return Result<bool>::Failure(error);
+            }
+
+            // Fingerprints are computed here rather than in SQL so the refresh runs on both backends
+            QSqlQuery& valuesQuery = lease.prepare(IDENTIFIER_VALUES_SQL);
+            valuesQuery.bindValue(":allProfiles", profileId < 0);
+            valuesQuery.bindValue(":profileId", profileId);
+            if (!QueryStatistics::exec(valuesQuery)) {
+                lease.rollback();
+                QString error = translator->getErrorMessage(MWL_FAILED_TO_UPDATE_ENTRIES_MSG).arg(valuesQuery.lastError().text());
+                logger->LogError(error);
+                qDebug()<<error;
+                return Result<bool>::Failure(error);
+            }
+
+            // When entries share an identity, only the oldest one keeps the fingerprint so the unique index holds
+            QHash<QPair<int, QString>, int> keeperByIdentity;
+            auto keep = [&keeperByIdentity](int entryId, int entryProfileId, const QMap<int, QString>& values) {
+                const QString fingerprint = identityFingerprint(values);
+                if (fingerprint.isEmpty())
+                    return;
+                // Rows come in entry id order, so the first entry seen for an identity is the oldest
+                const auto identity = qMakePair(entryProfileId, fingerprint);
+                if (!keeperByIdentity.contains(identity))
+                    keeperByIdentity.insert(identity, entryId);
+            };
+
+            int currentEntryId = -1;
+            int currentProfileId = -1;
+            QMap<int, QString> currentValues;
+            while (valuesQuery.next()) {
+                const int entryId = valuesQuery.value(0).toInt();
+                if (entryId != currentEntryId) {
+                    if (currentEntryId >= 0)
+                        keep(currentEntryId, currentProfileId, currentValues);
+                    currentEntryId = entryId;
+                    currentProfileId = valuesQuery.value(1).toInt();
+                    currentValues.clear();
+                }
+                currentValues[valuesQuery.value(2).toInt()] = valuesQuery.value(3).toString();
+            }
+            if (currentEntryId >= 0)
+                keep(currentEntryId, currentProfileId, currentValues);
+            valuesQuery.finish();
+
+            QSqlQuery& clearQuery = lease.prepare(R"(
+                UPDATE mwl_entries
+                SET identity_fingerprint = NULL
+                WHERE (:allProfiles OR profile_id = :profileId)
+            )");
+            clearQuery.bindValue(":allProfiles", profileId < 0);
+            clearQuery.bindValue(":profileId", profileId);
+            if (!QueryStatistics::exec(clearQuery)) {
+                lease.rollback();
+                QString error = translator->getErrorMessage(MWL_FAILED_TO_UPDATE_ENTRIES_MSG).arg(clearQuery.lastError().text());
+                logger->LogError(error);
+                qDebug()<<error;
+                return Result<bool>::Failure(error);
+            }
+
+            QSqlQuery& fingerprintQuery = lease.prepare(R"(
+                UPDATE mwl_entries
+                SET identity_fingerprint = :fingerprint
+                WHERE id = :id
+            )");
+            for (auto it = keeperByIdentity.constBegin(); it != keeperByIdentity.constEnd(); ++it) {
+                fingerprintQuery.bindValue(":fingerprint", it.key().second);
+                fingerprintQuery.bindValue(":id", it.value());
+                if (!QueryStatistics::exec(fingerprintQuery)) {
+                    lease.rollback();
+                    QString error = translator->getErrorMessage(MWL_FAILED_TO_UPDATE_ENTRIES_MSG).arg(fingerprintQuery.lastError().text());
+                    logger->LogError(error);
+                    qDebug()<<error;
+                    return Result<bool>::Failure(error);
+                }
+            }
+
+            if (!lease.commit()) {
+                lease.rollback();
+                QString error = translator->getErrorMessage(MWL_FAILED_TO_COMMIT_TRANSACTION_MSG).arg(db.lastError().text());
+                logger->LogError(error);
+                qDebug()<<error;
+                return Result<bool>::Failure(error);
+            }
+        }
+
+        return Result<bool>::Success(true);
+    }
+
+    Result<int> WorklistRepository::findEntryByFingerprint(ConnectionLease& lease, int profileId, const QString& fingerprint) const {
+        QSqlQuery& query = lease.prepare("SELECT id FROM mwl_entries WHERE profile_id = :profileId AND identity_fingerprint = :fingerprint");
+        query.bindValue(":profileId", profileId);
+        query.bindValue(":fingerprint", fingerprint);
+
+        if (!QueryStatistics::exec(query)) {
+            QString error = translator->getErrorMessage(MWL_QUERY_FAILED_MSG).arg(query.lastError().text());
             logger->LogError(error);
             qDebug()<<error;
             return Result<int>::Failure(error);
         }
 
-        QString connName = "conn_find_entry_" + QString::number(QRandomGenerator::global()->generate());
+        const int id = query.next() ? query.value(0).toInt() : -1;
+        query.finish();
+        return Result<int>::Success(id);
+    }
 
+    Result<QList<int>> WorklistRepository::profilesWithIdentifierTag(int tagId) const {
+        QList<int> profileIds;
         {
-            QSqlDatabase db = createConnection(connName);
-            if (!db.open()) {
-                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(error);
                 qDebug()<<error;
-                return Result<int>::Failure(error);
+                return Result<QList<int>>::Failure(error);
             }
 
-            QString sql = R"(
-                SELECT e.id
-                FROM mwl_entries e
-                JOIN mwl_attributes a ON e.id = a.mwl_entry_id
-                WHERE e.profile_id = :profileId
-                  AND (
-            )";
-
-            // Dynamically build matching conditions
-            QStringList conditions;
-            int idx = 1;
-            for (auto it = tagIdToValue.constBegin(); it != tagIdToValue.constEnd(); ++it) {
-                conditions << QString("(a.dicom_tag_id = :tagId%1 AND LOWER(a.tag_value) = LOWER(:tagVal%1))").arg(idx);
-                ++idx;
-            }
-            sql += conditions.join(" OR ") + ") ";
-
-            // Group and count matches
-            sql += R"(
-                GROUP BY e.id
-                HAVING COUNT(DISTINCT a.dicom_tag_id) = :tagCount
-                LIMIT 1
-            )";
-
-            QSqlQuery query(db);
-            query.prepare(sql);
+            QSqlQuery& query = lease.prepare(R"(
+                SELECT DISTINCT profile_id FROM profile_tag_association
+                WHERE tag_id = :tagId AND is_identifier = TRUE
+            )");
+            query.bindValue(":tagId", tagId);
 
-            idx = 1;
-            for (auto it = tagIdToValue.constBegin(); it != tagIdToValue.constEnd(); ++it) {
-                query.bindValue(QString(":tagId%1").arg(idx), it.key());
-                query.bindValue(QString(":tagVal%1").arg(idx), it.value());
-                ++idx;
+            if (!QueryStatistics::exec(query)) {
+                QString error = translator->getErrorMessage(MWL_QUERY_FAILED_MSG).arg(query.lastError().text());
+                logger->LogError(error);
+                qDebug()<<error;
+                return Result<QList<int>>::Failure(error);
             }
-            query.bindValue(":profileId", profileId);
-            query.bindValue(":tagCount", tagIdToValue.size());
-
-            // for debug
 
-            // Reconstruct the query for debugging
-            // QString reconstructedQuery = sql;
-            // idx = 1;
-            // for (auto it = tagIdToValue.constBegin(); it != tagIdToValue.constEnd(); ++it) {
-            //     QString tagIdPlaceholder = QString(":tagId%1").arg(idx);
-            //     QString tagValPlaceholder = QString(":tagVal%1").arg(idx);
+            while (query.next())
+                profileIds << query.value(0).toInt();
+        }
+        return Result<QList<int>>::Success(profileIds);
+    }
 
-            //     reconstructedQuery.replace(tagIdPlaceholder, QString::number(it.key()));
+    Result<QString> WorklistRepository::identityFingerprintFor(const WorklistEntry& entry) const {
+        auto activeTagsResult = getActiveIdentifierTags(entry.Profile.Id);
+        if (!activeTagsResult.isSuccess) {
+            QString error = translator->getErrorMessage(MWL_FAILED_TO_GET_ACTIVE_IDENTIFIERS_MSG).arg(activeTagsResult.message);
+            logger->LogError(error);
+            qDebug()<<error;
+            return Result<QString>::Failure(error);
+        }
 
-            //     QString safeValue = it.value();
-            //     safeValue.replace("'", "''");  // SQL-safe
-            //     reconstructedQuery.replace(tagValPlaceholder, QString("'%1'").arg(safeValue));
+        QSet<int> identifierTagIds;
+        for (const DicomTag& tag : activeTagsResult.value)
+            identifierTagIds.insert(tag.Id);
 
-            //     ++idx;
-            // }
+        return Result<QString>::Success(identityFingerprint(entry, identifierTagIds));
+    }
 
-            // reconstructedQuery.replace(":profileId", QString::number(profileId));
-            // reconstructedQuery.replace(":tagCount", QString::number(tagIdToValue.size()));
+    Result<int> WorklistRepository::findWorklistEntryByIdentifiers(int profileId, const QMap<int, QString>& tagIdToValue) const {
+        if (tagIdToValue.isEmpty()) {
+            QString error = translator->getErrorMessage(DB_NO_IDENTIFIERS_PROVIDED_ERROR);
+            logger->LogError(error);
+            qDebug()<<error;
+            return Result<int>::Failure(error);
+        }
 
-            // // Log the final SQL
-            // qDebug() << "[DEBUG] Final Executed SQL:\n" << reconstructedQuery;
+        {
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
+            if (!db.isOpen()) {
+                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
+                logger->LogError(error);
+                qDebug()<<error;
+                return Result<int>::Failure(error);
+            }
 
-            // throw std::exception("break it here");
+            // Point lookup on the (profile_id, identity_fingerprint) unique index
+            QSqlQuery& query = lease.prepare(R"(
+                SELECT id
+                FROM mwl_entries
+                WHERE profile_id = :profileId AND identity_fingerprint = :fingerprint
+            )");
+            query.bindValue(":profileId", profileId);
+            query.bindValue(":fingerprint", identityFingerprint(tagIdToValue));
 
-            if (!query.exec()) {
+            if (!QueryStatistics::exec(query)) {
                 QString error = translator->getErrorMessage(MWL_QUERY_FAILED_MSG).arg(query.lastError().text());
                 logger->LogError(error);
                 qDebug()<<error;
@@ -1268,55 +1865,280 @@ namespace Etrek::Worklist::Repository {
             return Result<int>::Success(foundId);
             }
         }
-        QSqlDatabase::removeDatabase(connName);
         return Result<int>::Success(-1);  // not found
     }
 
-    QMap<int, QList<WorklistAttribute>> WorklistRepository::loadAttributesForEntries(const QList<int>& entryIds, QSqlDatabase& db) const {
-        QMap<int, QList<WorklistAttribute>> attributesMap;
-        if (entryIds.isEmpty()) return attributesMap;
+    Result<QHash<QString, WorklistEntry>> WorklistRepository::resolveExistingEntries(ConnectionLease& lease, int profileId, const QList<QString>& fingerprints) const {
+        QHash<QString, WorklistEntry> existing;
+
+        // Point lookups on the (profile_id, identity_fingerprint) unique index
+        for (int offset = 0; offset < fingerprints.size(); offset += INGEST_BATCH_SIZE) {
+            const int count = qMin(INGEST_BATCH_SIZE, int(fingerprints.size()) - offset);
+
+            QSqlQuery query(lease.database());
+            query.prepare(QString("SELECT id, identity_fingerprint, source, source_connection, status, created_at FROM mwl_entries WHERE profile_id = ? AND identity_fingerprint IN (%1)")
+                .arg(placeholderList(count, "?")));
+
+            query.addBindValue(profileId);
+            for (int i = 0; i < count; ++i)
+                query.addBindValue(fingerprints[offset + i]);
+
+            if (!QueryStatistics::exec(query)) {
+                QString error = translator->getErrorMessage(MWL_QUERY_FAILED_MSG).arg(query.lastError().text());
+                logger->LogError(error);
+                qDebug()<<error;
+                return Result<QHash<QString, WorklistEntry>>::Failure(error);
+            }
+
+            while (query.next()) {
+                WorklistEntry entry;
+                entry.Id = query.value("id").toInt();
+                entry.Profile.Id = profileId;
+                entry.Source = QStringToSource(query.value("source").toString());
+                entry.SourceConnection = query.value("source_connection").toString();
+                entry.Status = QStringToStatus(query.value("status").toString());
+                entry.CreatedAt = query.value("created_at").toDateTime();
+                existing.insert(query.value("identity_fingerprint").toString(), entry);
+            }
+        }
 
-        QStringList placeholders;
-        for (int i = 0; i < entryIds.size(); ++i) {
-            placeholders << "?";
+        return Result<QHash<QString, WorklistEntry>>::Success(existing);
+    }
+
+    Result<QHash<int, QMap<int, QString>>> WorklistRepository::loadTagValuesForEntries(ConnectionLease& lease, const QList<int>& entryIds) const {
+        QHash<int, QMap<int, QString>> values;
+
+        for (int offset = 0; offset < entryIds.size(); offset += INGEST_BATCH_SIZE) {
+            const int count = qMin(INGEST_BATCH_SIZE, int(entryIds.size()) - offset);
+
+            QSqlQuery query(lease.database());
+            // Only active tags, the same set activeTagValues() takes from an incoming entry
+            query.prepare(QString(R"(
+                SELECT a.mwl_entry_id, a.dicom_tag_id, a.tag_value
+                FROM mwl_attributes a
+                JOIN dicom_tags t ON t.id = a.dicom_tag_id AND t.is_active = TRUE
+                WHERE a.mwl_entry_id IN (%1)
+            )").arg(placeholderList(count, "?")));
+            for (int i = 0; i < count; ++i)
+                query.addBindValue(entryIds[offset + i]);
+
+            if (!QueryStatistics::exec(query)) {
+                QString error = translator->getErrorMessage(MWL_FAILED_TO_LOAD_ATTRIBUTES_MSG);
+                logger->LogError(error);
+                qDebug()<<error;
+                return Result<QHash<int, QMap<int, QString>>>::Failure(error);
+            }
+
+            while (query.next()) {
+                values[query.value(0).toInt()][query.value(1).toInt()] = query.value(2).toString();
+            }
         }
 
-        QString sql = QString(R"(
-            SELECT wa.id, wa.mwl_entry_id, wa.tag_value,
-                   t.id AS tag_id, t.name, t.display_name, t.group_hex, t.element_hex, t.pgroup_hex, t.pelement_hex, t.is_active, t.is_retired
-            FROM mwl_attributes wa
-            JOIN dicom_tags t ON wa.dicom_tag_id = t.id
-            WHERE wa.mwl_entry_id IN (%1) AND t.is_active = TRUE
-        )").arg(placeholders.join(","));
+        return Result<QHash<int, QMap<int, QString>>>::Success(values);
+    }
 
-        QSqlQuery query(db);
-        query.prepare(sql);
+    Result<QList<int>> WorklistRepository::insertEntryRows(ConnectionLease& lease, const QList<WorklistEntry>& entries, const QList<QString>& fingerprints) const {
+        BulkInsertWriter writer(lease, "mwl_entries",
+            { "source", "source_connection", "profile_id", "status", "identity_fingerprint", "created_at", "updated_at" });
+        writer.setCollectGeneratedIds(true);
 
-        for (int i = 0; i < entryIds.size(); ++i) {
-            query.bindValue(i, entryIds[i]);
+        for (int i = 0; i < entries.size(); ++i) {
+            const WorklistEntry& entry = entries[i];
+            const QVariant sourceConnection = entry.SourceConnection.isEmpty() ? QVariant(QVariant::String) : QVariant(entry.SourceConnection);
+            writer.addRow({ SourceToString(entry.Source), sourceConnection, entry.Profile.Id, ProcedureStepStatusToString(entry.Status),
+                fingerprintValue(fingerprints[i]), entry.CreatedAt, entry.UpdatedAt });
         }
 
-        if (!query.exec()) {
-            // Log or handle error, here we just return empty map
-            return attributesMap;
+        if (!writer.flush()) {
+            QString error = translator->getErrorMessage(DB_INSERT_FAILED_ERROR).arg(writer.lastError());
+            logger->LogError(error);
+            qDebug()<<error;
+            return Result<QList<int>>::Failure(error);
         }
 
-        while (query.next()) {
-            WorklistAttribute attr;
-            attr.id = query.value("id").toInt();
-            attr.EntryId = query.value("mwl_entry_id").toInt();
-            attr.Tag.Id = query.value("tag_id").toInt();
-            attr.Tag.Name = query.value("name").toString();
-            attr.Tag.DisplayName = query.value("display_name").toString();
-            attr.Tag.GroupHex = query.value("group_hex").toUInt();
-            attr.Tag.ElementHex = query.value("element_hex").toUInt();
-            attr.Tag.PgroupHex = query.value("pgroup_hex").toUInt();
-            attr.Tag.PelementHex = query.value("pelement_hex").toUInt();
-            attr.Tag.IsActive = query.value("is_active").toBool();
-            attr.Tag.IsRetired = query.value("is_retired").toBool();
-            attr.TagValue = query.value("tag_value").toString();
+        QList<int> ids;
+        for (qint64 id : writer.generatedIds())
+            ids.append(static_cast<int>(id));
+        return Result<QList<int>>::Success(ids);
+    }
 
-            attributesMap[attr.EntryId].append(attr);
+    Result<bool> WorklistRepository::insertAttributes(ConnectionLease& lease, const QList<WorklistEntry>& entries) const {
+        BulkInsertWriter writer(lease, "mwl_attributes", { "mwl_entry_id", "dicom_tag_id", "tag_value" });
+
+        for (const WorklistEntry& entry : entries) {
+            const auto values = activeTagValues(entry);
+            for (auto it = values.constBegin(); it != values.constEnd(); ++it)
+                writer.addRow({ entry.Id, it.key(), it.value() });
+        }
+
+        if (!writer.flush()) {
+            QString error = translator->getErrorMessage(DB_INSERT_ATTRIBUTE_FAILED_ERROR).arg(writer.lastError());
+            logger->LogError(error);
+            qDebug()<<error;
+            return Result<bool>::Failure(error);
+        }
+
+        return Result<bool>::Success(true);
+    }
+
+    Result<bool> WorklistRepository::recordEntrySources(ConnectionLease& lease, const QList<WorklistEntry>& entries, const QDateTime& seenAt) const {
+        BulkInsertWriter writer(lease, "mwl_entry_sources", { "mwl_entry_id", "connection_name", "last_seen_at" });
+        writer.setUpdateOnDuplicate({ "last_seen_at" });
+
+        for (const WorklistEntry& entry : entries) {
+            if (!entry.SourceConnection.isEmpty())
+                writer.addRow({ entry.Id, entry.SourceConnection, seenAt });
+        }
+
+        if (!writer.flush()) {
+            QString error = translator->getErrorMessage(DB_INSERT_FAILED_ERROR).arg(writer.lastError());
+            logger->LogError(error);
+            qDebug()<<error;
+            return Result<bool>::Failure(error);
+        }
+
+        return Result<bool>::Success(true);
+    }
+
+    Result<bool> WorklistRepository::upsertAttributes(ConnectionLease& lease, const QList<WorklistEntry>& entries) const {
+        if (entries.isEmpty()) {
+            return Result<bool>::Success(true);
+        }
+
+        // Current rows per entry and tag: (attribute row id, value)
+        QHash<int, QHash<int, QPair<int, QString>>> stored;
+        QList<int> obsoleteIds;
+
+        for (int offset = 0; offset < entries.size(); offset += INGEST_BATCH_SIZE) {
+            const int count = qMin(INGEST_BATCH_SIZE, int(entries.size()) - offset);
+
+            QSqlQuery query(lease.database());
+            query.prepare(QString("SELECT id, mwl_entry_id, dicom_tag_id, tag_value FROM mwl_attributes WHERE mwl_entry_id IN (%1)")
+                .arg(placeholderList(count, "?")));
+            for (int i = 0; i < count; ++i)
+                query.addBindValue(entries[offset + i].Id);
+
+            if (!QueryStatistics::exec(query)) {
+                QString error = translator->getErrorMessage(MWL_FAILED_TO_LOAD_ATTRIBUTES_MSG);
+                logger->LogError(error);
+                qDebug()<<error;
+                return Result<bool>::Failure(error);
+            }
+
+            while (query.next()) {
+                auto& rows = stored[query.value(1).toInt()];
+                const int tagId = query.value(2).toInt();
+                if (rows.contains(tagId))
+                    obsoleteIds.append(query.value(0).toInt());  // duplicate row for the same tag
+                else
+                    rows.insert(tagId, qMakePair(query.value(0).toInt(), query.value(3).toString()));
+            }
+        }
+
+        // Changed values overwrite their row by primary key, new tags get a fresh row.
+        BulkInsertWriter writer(lease, "mwl_attributes", { "id", "mwl_entry_id", "dicom_tag_id", "tag_value" });
+        writer.setUpdateOnDuplicate({ "tag_value" });
+
+        for (const WorklistEntry& entry : entries) {
+            const auto incoming = activeTagValues(entry);
+            const auto current = stored.value(entry.Id);
+
+            for (auto it = current.constBegin(); it != current.constEnd(); ++it) {
+                if (!incoming.contains(it.key()))
+                    obsoleteIds.append(it.value().first);
+            }
+
+            for (auto it = incoming.constBegin(); it != incoming.constEnd(); ++it) {
+                auto existing = current.constFind(it.key());
+                if (existing == current.constEnd())
+                    writer.addRow({ QVariant(QVariant::Int), entry.Id, it.key(), it.value() });
+                else if (existing.value().second != it.value())
+                    writer.addRow({ existing.value().first, entry.Id, it.key(), it.value() });
+            }
+        }
+
+        for (int offset = 0; offset < obsoleteIds.size(); offset += INGEST_BATCH_SIZE) {
+            const int count = qMin(INGEST_BATCH_SIZE, int(obsoleteIds.size()) - offset);
+
+            QSqlQuery deleteQuery(lease.database());
+            deleteQuery.prepare(QString("DELETE FROM mwl_attributes WHERE id IN (%1)").arg(placeholderList(count, "?")));
+            for (int i = 0; i < count; ++i)
+                deleteQuery.addBindValue(obsoleteIds[offset + i]);
+
+            if (!QueryStatistics::exec(deleteQuery)) {
+                QString error = translator->getErrorMessage(MWL_FAILED_TO_DELETE_ATTRIBUTES_MSG).arg(deleteQuery.lastError().text());
+                logger->LogError(error);
+                qDebug()<<error;
+                return Result<bool>::Failure(error);
+            }
+        }
+
+        if (!writer.flush()) {
+            QString error = translator->getErrorMessage(DB_INSERT_ATTRIBUTE_FAILED_ERROR).arg(writer.lastError());
+            logger->LogError(error);
+            qDebug()<<error;
+            return Result<bool>::Failure(error);
+        }
+
+        return Result<bool>::Success(true);
+    }
+
+    Result<bool> WorklistRepository::refreshDisplayColumns(ConnectionLease& lease, const QList<int>& entryIds) const {
+        QString projectionError;
+        if (!WorklistDisplayProjection::refreshEntries(lease.database(), entryIds, &projectionError)) {
+            QString error = translator->getErrorMessage(MWL_FAILED_TO_UPDATE_ENTRIES_MSG).arg(projectionError);
+            logger->LogError(error);
+            qDebug()<<error;
+            return Result<bool>::Failure(error);
+        }
+        return Result<bool>::Success(true);
+    }
+
+    QMap<int, QList<WorklistAttribute>> WorklistRepository::loadAttributesForEntries(const QList<int>& entryIds, QSqlDatabase& db) const {
+        QMap<int, QList<WorklistAttribute>> attributesMap;
+        if (entryIds.isEmpty()) return attributesMap;
+
+        // Bounded IN (...) lists; callers may pass any number of ids
+        for (int offset = 0; offset < entryIds.size(); offset += INGEST_BATCH_SIZE) {
+            const int count = qMin(INGEST_BATCH_SIZE, int(entryIds.size()) - offset);
+
+            QString sql = QString(R"(
+                SELECT wa.id, wa.mwl_entry_id, wa.tag_value,
+                       t.id AS tag_id, t.name, t.display_name, t.group_hex, t.element_hex, t.pgroup_hex, t.pelement_hex, t.is_active, t.is_retired
+                FROM mwl_attributes wa
+                JOIN dicom_tags t ON wa.dicom_tag_id = t.id
+                WHERE wa.mwl_entry_id IN (%1) AND t.is_active = TRUE
+            )").arg(placeholderList(count, "?"));
+
+            QSqlQuery query(db);
+            query.prepare(sql);
+
+            for (int i = 0; i < count; ++i) {
+                query.bindValue(i, entryIds[offset + i]);
+            }
+
+            if (!QueryStatistics::exec(query)) {
+                // Log or handle error, here we just return what was loaded so far
+                return attributesMap;
+            }
+
+            while (query.next()) {
+                WorklistAttribute attr;
+                attr.id = query.value("id").toInt();
+                attr.EntryId = query.value("mwl_entry_id").toInt();
+                attr.Tag.Id = query.value("tag_id").toInt();
+                attr.Tag.Name = query.value("name").toString();
+                attr.Tag.DisplayName = query.value("display_name").toString();
+                attr.Tag.GroupHex = query.value("group_hex").toUInt();
+                attr.Tag.ElementHex = query.value("element_hex").toUInt();
+                attr.Tag.PgroupHex = query.value("pgroup_hex").toUInt();
+                attr.Tag.PelementHex = query.value("pelement_hex").toUInt();
+                attr.Tag.IsActive = query.value("is_active").toBool();
+                attr.Tag.IsRetired = query.value("is_retired").toBool();
+                attr.TagValue = query.value("tag_value").toString();
+
+                attributesMap[attr.EntryId].append(attr);
+            }
         }
 
         return attributesMap;
@@ -1325,27 +2147,26 @@ namespace Etrek::Worklist::Repository {
     Result<WorklistEntry> WorklistRepository::getWorklistEntryDetails(int entryId) const {
 
         WorklistEntry entry;
-        QString connName = "conn_get_entry_details_" + QString::number(QRandomGenerator::global()->generate());
 
         {
-            QSqlDatabase db = createConnection(connName);
+            auto lease = DatabaseConnectionPool::Instance().acquire(m_connectionSetting);
+            QSqlDatabase& db = lease.database();
 
-            if (!db.open()) {
-                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(db.lastError().text());
+            if (!db.isOpen()) {
+                QString error = translator->getErrorMessage(FAILED_TO_OPEN_DB_MSG).arg(lease.lastError());
                 logger->LogError(error);
                 qDebug()<<error;
                 return Result<WorklistEntry>::Failure(error);
             }
 
-            QSqlQuery query(db);
-            query.prepare(R"(
+            QSqlQuery& query = lease.prepare(R"(
                 SELECT id, source, profile_id, status, created_at, updated_at
                 FROM mwl_entries
                 WHERE id = :entryId
             )");
             query.bindValue(":entryId", entryId);
 
-            if (!query.exec() || !query.next()) {
+            if (!QueryStatistics::exec(query) || !query.next()) {
                 QString error = translator->getErrorMessage(MWL_FAILED_TO_FIND_ENTRY_MSG).arg(query.lastError().text());
                 logger->LogError(error);
                 qDebug()<<error;
@@ -1360,8 +2181,7 @@ namespace Etrek::Worklist::Repository {
             entry.UpdatedAt = query.value("updated_at").toDateTime();
 
             // Fetch associated attributes (tags)
-            QSqlQuery attrQuery(db);
-            attrQuery.prepare(R"(
+            QSqlQuery& attrQuery = lease.prepare(R"(
                 SELECT wa.id, wa.tag_value, t.id AS tag_id, t.name, t.display_name, t.group_hex, t.element_hex, t.pgroup_hex, t.pelement_hex, t.is_active, t.is_retired
                 FROM mwl_attributes wa
                 JOIN dicom_tags t ON wa.dicom_tag_id = t.id
@@ -1369,7 +2189,7 @@ namespace Etrek::Worklist::Repository {
             )");
             attrQuery.bindValue(":entryId", entryId);
 
-            if (!attrQuery.exec()) {
+            if (!QueryStatistics::exec(attrQuery)) {
                 QString error = translator->getErrorMessage(MWL_FAILED_TO_LOAD_ATTRIBUTES_MSG);
                 logger->LogError(error);
                 qDebug()<<error;
@@ -1395,7 +2215,6 @@ namespace Etrek::Worklist::Repository {
             }
 
         }
-        QSqlDatabase::removeDatabase(connName);
         return Result<WorklistEntry>::Success(entry);
     }
 
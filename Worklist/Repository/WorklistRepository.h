@@ -2,6 +2,9 @@
 #define WORKLISTREPOSITORY_H
 
 #include <QList>
+#include <QHash>
+#include <QMap>
+#include <QSet>
 #include <memory>
 #include <QString>
 #include <QDateTime>
@@ -12,6 +15,11 @@
 #include "WorklistEntry.h"
 #include "WorklistAttribute.h"
 #include "WorklistProfile.h"
+#include "WorklistIngestSummary.h"
+#include "WorklistEntryPage.h"
+#include "WorklistDisplayRow.h"
+#include "DatabaseConnectionPool.h"
+#include "WorklistMetadataCache.h"
 #include "TranslationProvider.h"
 #include "AppLogger.h"
 #include "IWorklistRepository.h"
@@ -26,6 +34,10 @@ namespace Etrek::Worklist::Repository {
      * including CRUD operations for worklist entries, profiles, DICOM tags, and attributes.
      * It supports querying by profile, status, source, and time, and provides signals for entry changes.
      * Logging and translation support are integrated for error handling and diagnostics.
+     *
+     * Profile tag lookups (getTagsByProfile, getIdentifiersByProfile, getActiveIdentifierTags,
+     * getMandatoryIdentifierTags, getMatchingValuesByProfile) are served from a WorklistMetadataCache shared by all repositories
+     * on the same database. The tag and identifier flag updates of this class invalidate it.
      */
     class WorklistRepository final : public IWorklistRepository {
         Q_OBJECT
@@ -51,6 +63,13 @@ namespace Etrek::Worklist::Repository {
          */
         virtual Etrek::Specification::Result<QList<Etrek::Worklist::Data::Entity::DicomTag>> getTagsByProfile(int profileId) const;
 
+        /**
+         * @brief Retrieves the C-FIND matching values configured for the tags of a profile.
+         * @param profileId The profile ID.
+         * @return Result containing the matching value by tag ID; tags without one are left out.
+         */
+        Etrek::Specification::Result<QHash<int, QString>> getMatchingValuesByProfile(int profileId) const;
+
         /**
          * @brief Retrieves identifier tags for a profile.
          * @param profileId The profile ID.
@@ -73,6 +92,32 @@ namespace Etrek::Worklist::Repository {
          */
         Etrek::Specification::Result<QList<Etrek::Worklist::Data::Entity::WorklistEntry>> getWorklistEntries(const QDateTime* from, const QDateTime* to) const;
 
+        /**
+         * @brief Reads one page of worklist entries, newest first, with their attributes.
+         *
+         * Pages are addressed by the (created_at, id) of the last entry seen rather than an offset,
+         * so every page costs the same regardless of its position and memory stays bounded by @p pageSize.
+         * @param after Cursor returned as WorklistEntryPage::Next by the previous call; default for the first page.
+         * @param pageSize Maximum number of entries in the page (clamped to 1..500).
+         * @param from Start date/time (optional).
+         * @param to End date/time (optional).
+         * @return Result containing the page and the cursor for the next one.
+         */
+        Etrek::Specification::Result<Etrek::Worklist::Data::Entity::WorklistEntryPage> getWorklistEntriesPage(const Etrek::Worklist::Data::Entity::WorklistPageCursor& after, int pageSize, const QDateTime* from = nullptr, const QDateTime* to = nullptr) const;
+
+        /**
+         * @brief Reads one page of worklist grid rows, newest first.
+         *
+         * Rows come from the display columns materialized on mwl_entries, so no attributes are loaded.
+         * Paging works as in getWorklistEntriesPage().
+         * @param after Cursor returned as WorklistDisplayPage::Next by the previous call; default for the first page.
+         * @param pageSize Maximum number of rows in the page (clamped to 1..500).
+         * @param from Start date/time (optional).
+         * @param to End date/time (optional).
+         * @return Result containing the page and the cursor for the next one.
+         */
+        Etrek::Specification::Result<Etrek::Worklist::Data::Entity::WorklistDisplayPage> getWorklistDisplayPage(const Etrek::Worklist::Data::Entity::WorklistPageCursor& after, int pageSize, const QDateTime* from = nullptr, const QDateTime* to = nullptr) const;
+
         /**
          * @brief Retrieves worklist entries by source.
          * @param source The source (e.g., LOCAL, RIS).
@@ -96,12 +141,36 @@ namespace Etrek::Worklist::Repository {
         Etrek::Specification::Result<QString> updateWorklistStatus(int entryId, ProcedureStepStatus newStatus);
 
         /**
-         * @brief Deletes worklist entries before a specified date.
+         * @brief Deletes worklist entries before a specified date, in chunks of short transactions.
          * @param beforeDate The cutoff date.
          * @return Result indicating success or failure.
          */
         Etrek::Specification::Result<bool> deleteWorklistEntries(const QDateTime& beforeDate);
 
+        /**
+         * @brief Deletes at most @p maxEntries of the oldest worklist entries created before a date.
+         *
+         * The entries and their attributes are deleted in one short transaction; call again until
+         * fewer than @p maxEntries are reported to purge everything.
+         * @param beforeDate The cutoff date.
+         * @param maxEntries Maximum number of entries to delete.
+         * @return Result containing the number of entries deleted.
+         */
+        Etrek::Specification::Result<int> purgeWorklistEntries(const QDateTime& beforeDate, int maxEntries);
+
+        /**
+         * @brief Cancels the pending RIS entries of one connection that a full C-FIND no longer returned.
+         *
+         * Used by the periodic reconcile to catch procedure steps removed on the RIS. Entries whose
+         * status the modality already changed are left alone. The connection is removed from the
+         * sources of an unseen entry; an entry another connection still returns stays pending.
+         * @param profileId The profile the full query ran with.
+         * @param sourceConnection The connection queried; empty for entries without one.
+         * @param seenIds IDs of all entries the full query created, updated or found unchanged.
+         * @return Result containing the number of entries cancelled.
+         */
+        Etrek::Specification::Result<int> cancelUnseenRisEntries(int profileId, const QString& sourceConnection, const QSet<int>& seenIds);
+
         /**
          * @brief Deletes worklist entries by their IDs.
          * @param entryIds List of entry IDs to delete.
@@ -124,6 +193,16 @@ namespace Etrek::Worklist::Repository {
          */
         Etrek::Specification::Result<Etrek::Worklist::Data::Entity::WorklistEntry> getWorklistEntry(const Etrek::Worklist::Data::Entity::WorklistEntry& entry, const Etrek::Worklist::Data::Entity::WorklistProfile& profile) const;
 
+        /**
+         * @brief Recomputes the stored identity fingerprints from the entries' attributes.
+         *
+         * Needed whenever the set of active identifier tags changes. If several entries end up
+         * with the same identity only the oldest one keeps its fingerprint.
+         * @param profileId The profile ID, or -1 for all profiles.
+         * @return Result indicating success or failure.
+         */
+        Etrek::Specification::Result<bool> refreshIdentityFingerprints(int profileId);
+
         /**
          * @brief Finds a worklist entry by profile and tag values.
          * @param profileId The profile ID.
@@ -134,8 +213,11 @@ namespace Etrek::Worklist::Repository {
 
         /**
          * @brief Creates a new worklist entry.
+         *
+         * An entry whose identity is already stored for the profile is not created again; the
+         * ID of the stored entry is returned instead.
          * @param entry The WorklistEntry to create.
-         * @return Result containing the new entry ID.
+         * @return Result containing the new or existing entry ID.
          */
         virtual Etrek::Specification::Result<int> createWorklistEntry(const Etrek::Worklist::Data::Entity::WorklistEntry& entry);
 
@@ -146,6 +228,22 @@ namespace Etrek::Worklist::Repository {
          */
         virtual Etrek::Specification::Result<int> updateWorklistEntry(const Etrek::Worklist::Data::Entity::WorklistEntry& entry);
 
+        /**
+         * @brief Stores a whole batch of worklist entries received from a RIS in one pass.
+         *
+         * Existing entries are resolved with batched point lookups on their identity fingerprint
+         * instead of one query per entry. New entries are inserted and the
+         * attributes of changed entries are replaced inside one transaction using multi-row
+         * INSERT statements. Status and source of existing entries are left untouched.
+         * Entries of the batch sharing the same identifiers are collapsed, the last one wins.
+         *
+         * @note Uses a pooled connection of the calling thread and may be called from a worker thread.
+         * @param entries Entries as returned by the C-FIND query, already mapped to the profile.
+         * @param profile The profile the entries belong to.
+         * @return Result containing the counts and ids of created and updated entries.
+         */
+        Etrek::Specification::Result<Etrek::Worklist::Data::Entity::WorklistIngestSummary> ingestWorklistEntries(const QList<Etrek::Worklist::Data::Entity::WorklistEntry>& entries, const Etrek::Worklist::Data::Entity::WorklistProfile& profile);
+
         /**
          * @brief Adds a new DICOM tag.
          * @param tag The DicomTag to add.
@@ -218,6 +316,99 @@ namespace Etrek::Worklist::Repository {
         void worklistEntryDeleted(int entryId);
 
     private:
+        /**
+         * @brief Resolves the existing entries with the given identity fingerprints.
+         * @param lease The leased connection.
+         * @param profileId The profile ID.
+         * @param fingerprints Identity fingerprints to look up.
+         * @return Result containing a map of fingerprint to the stored entry's ID, source,
+         *         source connection, status and creation time; attributes are not loaded.
+         */
+        Etrek::Specification::Result<QHash<QString, Etrek::Worklist::Data::Entity::WorklistEntry>> resolveExistingEntries(Etrek::Core::Repository::ConnectionLease& lease, int profileId, const QList<QString>& fingerprints) const;
+
+        /**
+         * @brief Loads the stored values of active tags of the given entries.
+         * @param lease The leased connection.
+         * @param entryIds List of entry IDs.
+         * @return Result containing, per entry ID, a map of tag ID to value.
+         */
+        Etrek::Specification::Result<QHash<int, QMap<int, QString>>> loadTagValuesForEntries(Etrek::Core::Repository::ConnectionLease& lease, const QList<int>& entryIds) const;
+
+        /**
+         * @brief Looks up the stored entry of a profile with the given identity fingerprint.
+         * @param lease The leased connection.
+         * @param profileId The profile ID.
+         * @param fingerprint The identity fingerprint; must not be empty.
+         * @return Result containing the entry ID, or -1 if there is none.
+         */
+        Etrek::Specification::Result<int> findEntryByFingerprint(Etrek::Core::Repository::ConnectionLease& lease, int profileId, const QString& fingerprint) const;
+
+        /**
+         * @brief Lists the profiles that use a tag as an identifier.
+         * @param tagId The tag ID.
+         * @return Result containing the profile IDs.
+         */
+        Etrek::Specification::Result<QList<int>> profilesWithIdentifierTag(int tagId) const;
+
+        /**
+         * @brief Inserts new mwl_entries rows with multi-row INSERT statements via BulkInsertWriter.
+         * @param lease The leased connection, inside a transaction.
+         * @param entries The entries to insert.
+         * @param fingerprints Identity fingerprint of each entry; empty when it has no identifiers.
+         * @return Result containing the new entry IDs, in the order of @p entries.
+         */
+        Etrek::Specification::Result<QList<int>> insertEntryRows(Etrek::Core::Repository::ConnectionLease& lease, const QList<Etrek::Worklist::Data::Entity::WorklistEntry>& entries, const QList<QString>& fingerprints) const;
+
+        /**
+         * @brief Inserts the active attributes of the given entries with multi-row INSERT statements.
+         * @param lease The leased connection, inside a transaction.
+         * @param entries Entries with their IDs set.
+         * @return Result indicating success or failure.
+         */
+        Etrek::Specification::Result<bool> insertAttributes(Etrek::Core::Repository::ConnectionLease& lease, const QList<Etrek::Worklist::Data::Entity::WorklistEntry>& entries) const;
+
+        /**
+         * @brief Brings the stored attributes of existing entries in line with their active attributes.
+         *
+         * Unchanged rows are left alone, changed and new values are written in one multi-row
+         * upsert and rows for tags no longer present are deleted.
+         * @param lease The leased connection, inside a transaction.
+         * @param entries Entries with their IDs set.
+         * @return Result indicating success or failure.
+         */
+        Etrek::Specification::Result<bool> upsertAttributes(Etrek::Core::Repository::ConnectionLease& lease, const QList<Etrek::Worklist::Data::Entity::WorklistEntry>& entries) const;
+
+        /**
+         * @brief Records that each entry was returned by its SourceConnection.
+         * @param lease The leased connection, inside a transaction.
+         * @param entries Entries with their IDs set; those without a connection are ignored.
+         * @param seenAt Time of the ingest.
+         * @return Result indicating success or failure.
+         */
+        Etrek::Specification::Result<bool> recordEntrySources(Etrek::Core::Repository::ConnectionLease& lease, const QList<Etrek::Worklist::Data::Entity::WorklistEntry>& entries, const QDateTime& seenAt) const;
+
+        /**
+         * @brief Recomputes the worklist grid columns of the given entries from their attributes.
+         * @param lease The leased connection, inside the transaction that wrote the attributes.
+         * @param entryIds Entries to refresh.
+         * @return Result indicating success or failure.
+         */
+        Etrek::Specification::Result<bool> refreshDisplayColumns(Etrek::Core::Repository::ConnectionLease& lease, const QList<int>& entryIds) const;
+
+        /**
+         * @brief Computes the identity fingerprint of an entry from its profile's active identifier tags.
+         * @param entry The entry; its Profile.Id selects the identifier tags.
+         * @return Result containing the fingerprint, empty if the entry carries no identifier.
+         */
+        Etrek::Specification::Result<QString> identityFingerprintFor(const Etrek::Worklist::Data::Entity::WorklistEntry& entry) const;
+
+        /**
+         * @brief Returns the tag metadata of a profile from the shared cache, loading it on a miss.
+         * @param profileId The profile ID.
+         * @return Result containing the immutable metadata of the profile.
+         */
+        Etrek::Specification::Result<std::shared_ptr<const ProfileTagMetadata>> profileMetadata(int profileId) const;
+
         /**
          * @brief Loads attributes for the given entry IDs from the database.
          * @param entryIds List of entry IDs.
@@ -233,16 +424,10 @@ namespace Etrek::Worklist::Repository {
          */
         Etrek::Specification::Result<Etrek::Worklist::Data::Entity::WorklistEntry> getWorklistEntryDetails(int entryId) const;
 
-        /**
-         * @brief Creates a new database connection with the specified name.
-         * @param connectionName The name for the connection.
-         * @return The QSqlDatabase object.
-         */
-        QSqlDatabase createConnection(const QString& connectionName) const;
-
         std::shared_ptr<Etrek::Core::Data::Model::DatabaseConnectionSetting> m_connectionSetting;
         Etrek::Core::Globalization::TranslationProvider* translator;
         std::shared_ptr<Etrek::Core::Log::AppLogger> logger;
+        std::shared_ptr<WorklistMetadataCache> m_metadataCache;
     };
 
 } // namespace Etrek::Repository